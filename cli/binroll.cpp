@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sun Mar  4 21:17:35 PST 2018
-// Last Modified: Sun Mar  4 21:17:38 PST 2018
+// Last Modified: Sun Oct 18 17:52:03 PDT 2026 Stream output directly to cout
 // Filename:      binroll.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/cli/binroll.cpp
 // Syntax:        C++11
@@ -12,7 +12,31 @@
 
 #include "humlib.h"
 
-STREAM_INTERFACE(Tool_binroll)
+#include <iostream>
+
+using namespace std;
+using namespace hum;
+
+int main(int argc, char** argv) {
+	Tool_binroll interface;
+	if (!interface.process(argc, argv)) {
+		interface.getError(cerr);
+		return -1;
+	}
+
+	// Each roll is written to cout as soon as its file has been analyzed
+	// rather than being collected in the tool's text buffers.
+	HumdrumFileStream instream(static_cast<Options&>(interface));
+	bool status = interface.run(instream, cout);
+	if (interface.hasWarning()) {
+		interface.getWarning(cerr);
+	}
+	if (interface.hasError()) {
+		interface.getError(cerr);
+		return -1;
+	}
+	return !status;
+}
 
 
 
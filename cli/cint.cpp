@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sun Dec 26 17:03:54 PST 2010
-// Last Modified: Wed May 31 16:06:49 CEST 2017
+// Last Modified: Sun Oct 18 18:20:41 PDT 2026
 // Filename:      cint.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/cli/cint.cpp
 // Syntax:        C++11
@@ -13,7 +13,73 @@
 
 #include "humlib.h"
 
-STREAM_INTERFACE(Tool_cint)
+#include <iostream>
 
+using namespace std;
+using namespace hum;
+
+int main(int argc, char** argv) {
+	Tool_cint interface;
+	if (!interface.process(argc, argv)) {
+		interface.getError(cerr);
+		return -1;
+	}
+
+	if (interface.getBoolean("lookup")) {
+		// Searching a module index does not need any input data.
+		bool status = interface.lookupModuleIndex(cout);
+		if (interface.hasWarning()) {
+			interface.getWarning(cerr);
+		}
+		if (interface.hasError()) {
+			interface.getError(cerr);
+			return -1;
+		}
+		return !status;
+	}
+
+	interface.setHumdrumOutput(cout);
+	HumdrumFileStream instream(static_cast<Options&>(interface));
+	HumdrumFileSet infiles;
+	bool status = true;
+
+	if (interface.getBoolean("index")) {
+		// An index is created from all input files at once.
+		instream.read(infiles);
+		status = interface.run(infiles);
+		if (interface.hasWarning()) {
+			interface.getWarning(cerr);
+		}
+		if (interface.hasAnyText()) {
+			interface.getAllText(cout);
+		}
+		if (interface.hasError()) {
+			interface.getError(cerr);
+			return -1;
+		}
+		return !status;
+	}
+
+	while (instream.readSingleSegment(infiles)) {
+		status &= interface.run(infiles);
+		if (interface.hasWarning()) {
+			interface.getWarning(cerr);
+		}
+		if (interface.hasAnyText()) {
+			interface.getAllText(cout);
+		}
+		if (interface.hasError()) {
+			interface.getError(cerr);
+			return -1;
+		}
+		if (!interface.hasAnyText()) {
+			for (int i=0; i<infiles.getCount(); i++) {
+				cout << infiles[i];
+			}
+		}
+		interface.clearOutput();
+	}
+	return !status;
+}
 
 
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Tue Jun  6 15:47:45 CEST 2017
-// Last Modified: Tue Jun  6 15:47:48 CEST 2017
+// Last Modified: Sun Oct 18 19:41:26 PDT 2026
 // Filename:      esac2hum.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/cli/esac2hum.cpp
 // Syntax:        C++11
@@ -30,7 +30,10 @@ int main(int argc, char** argv) {
 	}
 	if (interface.hasWarning()) {
 		interface.getWarning(cerr);
-		return 0;
+	}
+	if (interface.hasFreeText()) {
+		// --report output
+		interface.getFreeText(cerr);
 	}
 	if (interface.hasError()) {
 		interface.getError(cerr);
@@ -0,0 +1,429 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 20:31:07 PDT 2026
+// Last Modified: Sun Oct 18 20:31:10 PDT 2026
+// Last Modified: Mon Oct 19 04:12:36 PDT 2026 Ignore SIGPIPE, back off accept()
+// Filename:      humserver.cpp
+// URL:           https://github.com/craigsapp/humlib/blob/master/cli/humserver.cpp
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab nowrap
+//
+// Description:   Server which keeps parsed Humdrum files in memory and
+//                runs tools on them for clients which connect through a
+//                Unix domain socket.  Files are only read and parsed
+//                the first time they are used (or again if a tool changes
+//                them), and several requests are processed at the same time.
+//
+// Server:        humserver [-s socket] [-n max-files] [-j threads] [-d dir]
+// Client:        humserver [-s socket] -q "myank -m 2-3" file1.krn file2.krn
+//
+// Request:       The first line is a tool command line (the tool name
+//                followed by its options), and each following line
+//                is the name of an input file (relative to the -d
+//                directory).  The request ends when the client closes
+//                its side of the connection.  The command "stats" returns
+//                information about the file cache.
+//
+// Response:      A line with the exit status (0 = success), the size of
+//                the output and the size of the error messages in bytes,
+//                followed by the output and then the error messages.
+//
+
+#include "humlib.h"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace hum;
+
+typedef function<bool(const string& command, HumdrumFileSet& infiles,
+		ostream& out, ostream& err)> ServerTool;
+
+// function declarations:
+int      runServer       (Options& options);
+int      runClient       (Options& options);
+void     processRequest  (int fd, HumScoreCache& cache, const string& directory);
+bool     runRequest      (const string& request, HumScoreCache& cache,
+                          const string& directory, ostream& out, ostream& err);
+bool     readAll         (int fd, string& data);
+bool     writeAll        (int fd, const string& data);
+int      openSocket      (const string& path, bool serverQ);
+
+template <class TOOL>
+bool     runTool         (const string& command, HumdrumFileSet& infiles,
+                          ostream& out, ostream& err);
+
+// Tools which can be run by the server:
+map<string, ServerTool> Tools = {
+	{ "cint",      runTool<Tool_cint>      },
+	{ "extractx",  runTool<Tool_extract>   },
+	{ "myank",     runTool<Tool_myank>     },
+	{ "msearch",   runTool<Tool_msearch>   },
+	{ "transpose", runTool<Tool_transpose> }
+};
+
+
+///////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char** argv) {
+	Options options;
+	options.define("s|socket=s:/tmp/humserver.sock", "Unix socket path");
+	options.define("n|max-files=i:10000", "maximum number of files to keep in memory");
+	options.define("j|threads=i:0", "number of requests to process at the same time");
+	options.define("d|directory=s:", "directory for relative input filenames");
+	options.define("q|query=s", "send a tool command to the server");
+	if (!options.process(argc, argv)) {
+		options.getParseError(cerr);
+		return -1;
+	}
+	if (options.getBoolean("query")) {
+		return runClient(options);
+	}
+	return runServer(options);
+}
+
+
+
+//////////////////////////////
+//
+// runServer -- Listen for requests on the socket.  Each thread accepts
+//     and processes one connection at a time.
+//
+
+int runServer(Options& options) {
+	string path = options.getString("socket");
+	int listenfd = openSocket(path, true);
+	if (listenfd < 0) {
+		return 1;
+	}
+	HumScoreCache cache(options.getInteger("max-files"));
+	string directory = options.getString("directory");
+	int threadcount = HumParallel::getThreadCount(options.getInteger("threads"));
+
+	// A client which disconnects before reading the whole response must
+	// not end the server (writeAll() then fails with EPIPE instead).
+	signal(SIGPIPE, SIG_IGN);
+
+	vector<thread> threads;
+	for (int i=0; i<threadcount; i++) {
+		threads.emplace_back([&]() {
+			int delay = 0;  // milliseconds to wait after accept() fails
+			while (true) {
+				int fd = accept(listenfd, NULL, NULL);
+				if (fd < 0) {
+					if ((errno == EINTR) || (errno == ECONNABORTED)) {
+						continue;
+					}
+					// Out of file descriptors or memory: wait for other
+					// connections to close rather than retrying at once.
+					delay = delay ? std::min(delay * 2, 1000) : 10;
+					cerr << "Error: accept failed: " << strerror(errno) << endl;
+					this_thread::sleep_for(chrono::milliseconds(delay));
+					continue;
+				}
+				delay = 0;
+				processRequest(fd, cache, directory);
+				close(fd);
+			}
+		});
+	}
+	for (int i=0; i<(int)threads.size(); i++) {
+		threads[i].join();
+	}
+	close(listenfd);
+	return 0;
+}
+
+
+
+//////////////////////////////
+//
+// runClient -- Send the -q command and the input filenames to the server
+//     and print the response.  Returns the status sent by the server.
+//
+
+int runClient(Options& options) {
+	int fd = openSocket(options.getString("socket"), false);
+	if (fd < 0) {
+		return 1;
+	}
+	string request = options.getString("query") + "\n";
+	for (int i=1; i<=options.getArgCount(); i++) {
+		request += options.getArg(i) + "\n";
+	}
+	if (!writeAll(fd, request)) {
+		cerr << "Error: cannot send request" << endl;
+		close(fd);
+		return 1;
+	}
+	shutdown(fd, SHUT_WR);
+	string response;
+	readAll(fd, response);
+	close(fd);
+
+	int status = 1;
+	size_t outsize = 0;
+	size_t errsize = 0;
+	auto loc = response.find('\n');
+	stringstream header(response.substr(0, loc));
+	if ((loc == string::npos) || !(header >> status >> outsize >> errsize) ||
+			(loc + 1 + outsize + errsize > response.size())) {
+		cerr << "Error: invalid response from server" << endl;
+		return 1;
+	}
+	cout << response.substr(loc + 1, outsize);
+	cerr << response.substr(loc + 1 + outsize, errsize);
+	return status;
+}
+
+
+
+//////////////////////////////
+//
+// processRequest -- Read a request from a connection and send back
+//     the response.
+//
+
+void processRequest(int fd, HumScoreCache& cache, const string& directory) {
+	string request;
+	stringstream out;
+	stringstream err;
+	bool status = false;
+	if (readAll(fd, request)) {
+		try {
+			status = runRequest(request, cache, directory, out, err);
+		} catch (const exception& e) {
+			err << "Error: " << e.what() << endl;
+			status = false;
+		}
+	} else {
+		err << "Error: cannot read request" << endl;
+	}
+	string output = out.str();
+	string errors = err.str();
+	stringstream header;
+	header << (status ? 0 : 1) << " " << output.size() << " "
+	       << errors.size() << "\n";
+	// A write error (such as EPIPE when the client has closed the
+	// connection) only ends this connection.
+	writeAll(fd, header.str() + output + errors);
+}
+
+
+
+//////////////////////////////
+//
+// runRequest -- Run a tool on the files of a request.  The files are
+//     locked in alphabetical order so that requests which use the same
+//     files cannot deadlock.
+//
+
+bool runRequest(const string& request, HumScoreCache& cache,
+		const string& directory, ostream& out, ostream& err) {
+	stringstream input(request);
+	string command;
+	getline(input, command);
+	vector<string> filenames;
+	string filename;
+	while (getline(input, filename)) {
+		if (!filename.empty() && (filename.back() == '\r')) {
+			filename.resize(filename.size() - 1);
+		}
+		if (filename.empty()) {
+			continue;
+		}
+		if (!directory.empty() && (filename[0] != '/')) {
+			filename = directory + "/" + filename;
+		}
+		filenames.push_back(filename);
+	}
+
+	vector<string> args = Options::tokenizeCommandLine(command);
+	if (args.empty()) {
+		err << "Error: empty command" << endl;
+		return false;
+	}
+	if (args[0] == "stats") {
+		cache.printStatistics(out);
+		return true;
+	}
+	auto tool = Tools.find(args[0]);
+	if (tool == Tools.end()) {
+		err << "Error: unknown tool: " << args[0] << endl;
+		return false;
+	}
+
+	map<string, shared_ptr<HumScoreEntry>> entries;
+	for (int i=0; i<(int)filenames.size(); i++) {
+		if (entries.find(filenames[i]) == entries.end()) {
+			entries[filenames[i]] = cache.getScore(filenames[i]);
+		}
+	}
+	vector<unique_lock<mutex>> locks;
+	for (auto& entry : entries) {
+		locks.emplace_back(entry.second->getMutex());
+		if (!entry.second->prepare()) {
+			err << "Error: cannot read file: " << entry.first << endl;
+			return false;
+		}
+	}
+
+	HumdrumFileSet infiles;
+	for (int i=0; i<(int)filenames.size(); i++) {
+		infiles.appendHumdrumPointer(&entries[filenames[i]]->getFile());
+	}
+	bool status = tool->second(command, infiles, out, err);
+	infiles.clearNoFree();
+	return status;
+}
+
+
+
+//////////////////////////////
+//
+// runTool -- Run a tool on a set of files in the same way as the
+//     command-line version of the tool (see SET_INTERFACE in HumTool.h).
+//
+
+template <class TOOL>
+bool runTool(const string& command, HumdrumFileSet& infiles, ostream& out,
+		ostream& err) {
+	TOOL tool;
+	if (!tool.process(command)) {
+		tool.getError(err);
+		return false;
+	}
+	bool status = tool.run(infiles);
+	if (tool.hasWarning()) {
+		tool.getWarning(err);
+	}
+	if (tool.hasAnyText()) {
+		tool.getAllText(out);
+	}
+	if (tool.hasError()) {
+		tool.getError(err);
+		return false;
+	}
+	if (!tool.hasAnyText()) {
+		for (int i=0; i<infiles.getCount(); i++) {
+			out << infiles[i];
+		}
+	}
+	return status;
+}
+
+
+
+//////////////////////////////
+//
+// readAll -- Read from a socket until the other side closes it.
+//
+
+bool readAll(int fd, string& data) {
+	data.clear();
+	char buffer[65536];
+	while (true) {
+		ssize_t count = read(fd, buffer, sizeof(buffer));
+		if (count < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return false;
+		}
+		if (count == 0) {
+			return true;
+		}
+		data.append(buffer, count);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// writeAll -- Write all of the data to a socket.  Returns false if the
+//     other side has closed the connection.
+//
+
+bool writeAll(int fd, const string& data) {
+#ifdef MSG_NOSIGNAL
+	int flags = MSG_NOSIGNAL;
+#else
+	int flags = 0;
+#endif
+	const char* ptr = data.data();
+	size_t size = data.size();
+	while (size > 0) {
+		ssize_t count = send(fd, ptr, size, flags);
+		if (count < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return false;
+		}
+		ptr += count;
+		size -= count;
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// openSocket -- Create a listening socket for the server (removing any
+//     old socket file), or connect to the server for a client.
+//
+
+int openSocket(const string& path, bool serverQ) {
+	struct sockaddr_un address;
+	if (path.size() >= sizeof(address.sun_path)) {
+		cerr << "Error: socket path is too long: " << path << endl;
+		return -1;
+	}
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0) {
+		cerr << "Error: cannot create socket" << endl;
+		return -1;
+	}
+	if (serverQ) {
+		unlink(path.c_str());
+		if ((::bind(fd, (struct sockaddr*)&address, sizeof(address)) < 0) ||
+				(listen(fd, 64) < 0)) {
+			cerr << "Error: cannot listen on socket: " << path << endl;
+			close(fd);
+			return -1;
+		}
+	} else {
+		if (connect(fd, (struct sockaddr*)&address, sizeof(address)) < 0) {
+			cerr << "Error: cannot connect to server at " << path << endl;
+			close(fd);
+			return -1;
+		}
+	}
+	return fd;
+}
+
+
+
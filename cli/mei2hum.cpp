@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Wed Sep 13 14:53:40 PDT 2017
-// Last Modified: Wed Sep 13 14:53:42 PDT 2017
+// Last Modified: Sun Oct 18 23:44:12 PDT 2026 Added multiple input files
 // Filename:      mei2hum.cpp
 // URL:           https://github.com/craigsapp/musicxml2hum/blob/master/src/mei2hum.cpp
 // Syntax:        C++11
@@ -23,27 +23,34 @@ int main(int argc, char** argv) {
 		converter.getError(cerr);
 		return -1;
 	}
-	// hum::Options options(converter.getOptionDefinitions());
-	// options.process(argc, argv);
 
-	pugi::xml_document infile;
-	string filename;
+	stringstream out;
+	bool status;
 	if (converter.getArgCount() == 0) {
-		filename = "<STDIN>";
+		pugi::xml_document infile;
 		infile.load(cin);
+		status = converter.convert(out, infile);
 	} else {
-		filename = converter.getArg(1);
-		infile.load_file(filename.c_str());
+		vector<string> filenames;
+		converter.getArgList(filenames);
+		status = converter.convertFiles(out, filenames);
 	}
-
-	//converter.setOptions(argc, argv);
-	stringstream out;
-	bool status = converter.convert(out, infile);
-	if (!status) {
-		cerr << "Error converting file: " << filename << endl;
+	if (converter.hasWarning()) {
+		converter.getWarning(cerr);
+	}
+	if (converter.hasFreeText()) {
+		// --report output
+		converter.getFreeText(cerr);
+	}
+	if (converter.hasError()) {
+		converter.getError(cerr);
+	} else if (!status) {
+		cerr << "Error converting file: <STDIN>" << endl;
 	}
 	cout << out.str();
 
-	return 0;
+	return status ? 0 : 1;
 }
 
+
+
@@ -1,18 +1,74 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Wed Nov 30 20:35:56 PST 2016
-// Last Modified: Fri Dec  2 03:44:55 PST 2016
+// Last Modified: Mon Oct 19 04:41:52 PDT 2026 Indexed measure ranges
 // Filename:      myank.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/cli/myank.cpp
 // Syntax:        C++11
 // vim:           ts=3 noexpandtab nowrap
 //
-// Description:   Add beams to Humdrum file(s).
+// Description:   Extract measures from Humdrum file(s).
 //
 
 #include "humlib.h"
 
-STREAM_INTERFACE(Tool_myank)
+#include <iostream>
+#include <sstream>
 
+using namespace std;
+using namespace hum;
+
+int main(int argc, char** argv) {
+	Tool_myank interface;
+	if (!interface.process(argc, argv)) {
+		interface.getError(cerr);
+		return -1;
+	}
+
+	HumdrumFileStream instream(static_cast<Options&>(interface));
+	bool status = true;
+
+	if (interface.isIndexable()) {
+		// A single range of measures is extracted from the text of each
+		// file without parsing the entire file.
+		stringstream contents;
+		HumdrumFile infile;
+		while (instream.getFileContents(contents, infile)) {
+			status &= interface.runString(contents.str(), cout);
+			if (interface.hasWarning()) {
+				interface.getWarning(cerr);
+			}
+			if (interface.hasError()) {
+				interface.getError(cerr);
+				return -1;
+			}
+			interface.clearOutput();
+		}
+		return !status;
+	}
+
+	interface.setHumdrumOutput(cout);
+	HumdrumFileSet infiles;
+	while (instream.readSingleSegment(infiles)) {
+		status &= interface.run(infiles);
+		if (interface.hasWarning()) {
+			interface.getWarning(cerr);
+		}
+		if (interface.hasAnyText()) {
+			interface.getAllText(cout);
+		}
+		if (interface.hasError()) {
+			interface.getError(cerr);
+			return -1;
+		}
+		if (!interface.hasAnyText()) {
+			for (int i=0; i<infiles.getCount(); i++) {
+				cout << infiles[i];
+			}
+		}
+		interface.clearOutput();
+	}
+	return !status;
+}
 
 
@@ -0,0 +1,40 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 21:40:12 PDT 2026
+// Last Modified: Sun Oct 18 21:40:15 PDT 2026
+// Filename:      notecols.cpp
+// URL:           https://github.com/craigsapp/humlib/blob/master/cli/notecols.cpp
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab nowrap
+//
+// Description:   Export note attacks as columns of binary data.
+//
+
+#include "humlib.h"
+
+#include <iostream>
+
+using namespace std;
+using namespace hum;
+
+int main(int argc, char** argv) {
+	Tool_notecols interface;
+	if (!interface.process(argc, argv)) {
+		interface.getError(cerr);
+		return -1;
+	}
+
+	// Input files are analyzed in parallel batches, and each batch is
+	// written to cout before the next batch is read.
+	HumdrumFileStream instream(static_cast<Options&>(interface));
+	bool status = interface.run(instream, cout);
+	if (interface.hasWarning()) {
+		interface.getWarning(cerr);
+	}
+	if (interface.hasError()) {
+		interface.getError(cerr);
+		return -1;
+	}
+	return !status;
+}
+
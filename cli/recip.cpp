@@ -12,7 +12,7 @@
 
 #include "humlib.h"
 
-STREAM_INTERFACE(Tool_recip)
+LINE_STREAM_INTERFACE(Tool_recip)
 
 
 
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sat Aug  8 12:24:49 PDT 2015
-// Last Modified: Sun Aug  9 21:03:12 PDT 2015
+// Last Modified: Sun Oct 18 21:02:15 PDT 2026 Batch kern pitch conversions
 // Filename:      Convert.h
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/Convert.h
 // Syntax:        C++11; humlib
@@ -52,41 +52,86 @@ class Convert {
 		static std::string  base40ToIntervalAbbr (int b40);
 		static int     kernToOctaveNumber   (const std::string& kerndata);
 		static int     kernToOctaveNumber   (HTp token)
-				{ return kernToOctaveNumber((std::string)*token); }
+				{ return kernToOctaveNumber(*token); }
 		static int     kernToAccidentalCount(const std::string& kerndata);
 		static int     kernToAccidentalCount(HTp token)
-				{ return kernToAccidentalCount((std::string)*token); }
+				{ return kernToAccidentalCount(*token); }
 		static int     kernToDiatonicPC     (const std::string& kerndata);
 		static int     kernToDiatonicPC     (HTp token)
-				{ return kernToDiatonicPC     ((std::string)*token); }
+				{ return kernToDiatonicPC     (*token); }
 		static char    kernToDiatonicUC     (const std::string& kerndata);
 		static int     kernToDiatonicUC     (HTp token)
-				{ return kernToDiatonicUC     ((std::string)*token); }
+				{ return kernToDiatonicUC     (*token); }
 		static char    kernToDiatonicLC     (const std::string& kerndata);
 		static int     kernToDiatonicLC     (HTp token)
-				{ return kernToDiatonicLC     ((std::string)*token); }
+				{ return kernToDiatonicLC     (*token); }
 		static int     kernToBase40PC       (const std::string& kerndata);
 		static int     kernToBase40PC       (HTp token)
-				{ return kernToBase40PC       ((std::string)*token); }
+				{ return kernToBase40PC       (*token); }
 		static int     kernToBase12PC       (const std::string& kerndata);
 		static int     kernToBase12PC       (HTp token)
-				{ return kernToBase12PC       ((std::string)*token); }
+				{ return kernToBase12PC       (*token); }
 		static int     kernToBase7PC        (const std::string& kerndata) {
 		                                     return kernToDiatonicPC(kerndata); }
 		static int     kernToBase7PC        (HTp token)
-				{ return kernToBase7PC        ((std::string)*token); }
+				{ return kernToBase7PC        (*token); }
 		static int     kernToBase40         (const std::string& kerndata);
 		static int     kernToBase40         (HTp token)
-				{ return kernToBase40         ((std::string)*token); }
+				{ return kernToBase40         (*token); }
 		static int     kernToBase12         (const std::string& kerndata);
 		static int     kernToBase12         (HTp token)
-				{ return kernToBase12         ((std::string)*token); }
+				{ return kernToBase12         (*token); }
 		static int     kernToBase7          (const std::string& kerndata);
 		static int     kernToBase7          (HTp token)
-				{ return kernToBase7          ((std::string)*token); }
+				{ return kernToBase7          (*token); }
 		static int     kernToMidiNoteNumber (const std::string& kerndata);
 		static int     kernToMidiNoteNumber(HTp token)
-				{ return kernToMidiNoteNumber((std::string)*token); }
+				{ return kernToMidiNoteNumber(*token); }
+		static void    kernToPitchParts     (const char* kerndata, size_t size,
+		                                     int& diatonic, int& accidental,
+		                                     int& octave);
+		static int     pitchPartsToBase40   (int diatonic, int accidental,
+		                                     int octave);
+		static int     pitchPartsToBase12   (int diatonic, int accidental,
+		                                     int octave);
+		static int     pitchPartsToBase7    (int diatonic, int octave);
+
+		// Batch pitch processing, defined in Convert-pitch.cpp
+		static void    kernToPitchNumbers   (const std::vector<std::string>& tokens,
+		                                     std::vector<int>* base40,
+		                                     std::vector<int>* base12 = NULL,
+		                                     std::vector<int>* base7 = NULL,
+		                                     std::vector<int>* midi = NULL);
+		static void    kernToPitchNumbers   (const std::vector<HTp>& tokens,
+		                                     std::vector<int>* base40,
+		                                     std::vector<int>* base12 = NULL,
+		                                     std::vector<int>* base7 = NULL,
+		                                     std::vector<int>* midi = NULL);
+		static void    kernToBase40         (const std::vector<std::string>& tokens,
+		                                     std::vector<int>& output)
+				{ kernToPitchNumbers(tokens, &output); }
+		static void    kernToBase40         (const std::vector<HTp>& tokens,
+		                                     std::vector<int>& output)
+				{ kernToPitchNumbers(tokens, &output); }
+		static void    kernToBase12         (const std::vector<std::string>& tokens,
+		                                     std::vector<int>& output)
+				{ kernToPitchNumbers(tokens, NULL, &output); }
+		static void    kernToBase7          (const std::vector<std::string>& tokens,
+		                                     std::vector<int>& output)
+				{ kernToPitchNumbers(tokens, NULL, NULL, &output); }
+		static void    kernToMidiNoteNumber (const std::vector<std::string>& tokens,
+		                                     std::vector<int>& output)
+				{ kernToPitchNumbers(tokens, NULL, NULL, NULL, &output); }
+		static void    kernToMidiNoteNumber (const std::vector<HTp>& tokens,
+		                                     std::vector<int>& output)
+				{ kernToPitchNumbers(tokens, NULL, NULL, NULL, &output); }
+		// private function for kernToPitchNumbers:
+		static void    storePitchNumbers    (int index, const char* kerndata,
+		                                     size_t size, std::vector<int>* base40,
+		                                     std::vector<int>* base12,
+		                                     std::vector<int>* base7,
+		                                     std::vector<int>* midi);
+
 		static std::string  kernToScientificPitch(const std::string& kerndata,
 		                                     std::string flat = "b",
 		                                     std::string sharp = "#",
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sun Oct 16 16:08:05 PDT 2016
-// Last Modified: Sun Oct 16 16:08:08 PDT 2016
+// Last Modified: Sun Oct 18 23:02:47 PDT 2026 Pooled allocation
 // Filename:      GridPart.h
 // URL:           https://github.com/craigsapp/hum2ly/blob/master/include/GridPart.h
 // Syntax:        C++11; humlib
@@ -19,6 +19,7 @@
 #define _GRIDPART_H
 
 #include "GridStaff.h"
+#include "HumPool.h"
 
 #include <iostream>
 #include <vector>
@@ -31,6 +32,11 @@ class GridPart : public std::vector<GridStaff*>, public GridSide {
 	public:
 		GridPart(void);
 		~GridPart();
+
+		static void* operator new(size_t size)
+		                    { return HumPool<GridPart>::allocate(size); }
+		static void  operator delete(void* ptr, size_t size)
+		                    { HumPool<GridPart>::release(ptr, size); }
 };
 
 std::ostream& operator<<(std::ostream& output, GridPart* part);
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sun Oct 16 16:08:05 PDT 2016
-// Last Modified: Sat Oct 21 21:59:45 PDT 2017
+// Last Modified: Sun Oct 18 23:02:47 PDT 2026 Pooled allocation
 // Filename:      GridSlice.h
 // URL:           https://github.com/craigsapp/hum2ly/blob/master/include/GridSlice.h
 // Syntax:        C++11; humlib
@@ -20,6 +20,7 @@
 #include "MxmlPart.h"
 #include "GridPart.h"
 #include "GridMeasure.h"
+#include "HumPool.h"
 
 #include <iostream>
 #include <list>
@@ -43,6 +44,11 @@ class GridSlice : public std::vector<GridPart*> {
 		          GridSlice* slice);
 		~GridSlice();
 
+		static void* operator new(size_t size)
+		                    { return HumPool<GridSlice>::allocate(size); }
+		static void  operator delete(void* ptr, size_t size)
+		                    { HumPool<GridSlice>::release(ptr, size); }
+
 		bool isNoteSlice(void)          { return m_type == SliceType::Notes;            }
 		bool isGraceSlice(void)         { return m_type == SliceType::GraceNotes;       }
 		bool isMeasureSlice(void)       { return m_type == SliceType::Measures;         }
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sun Oct 16 16:08:05 PDT 2016
-// Last Modified: Sun Oct 16 16:08:08 PDT 2016
+// Last Modified: Sun Oct 18 23:02:47 PDT 2026 Pooled allocation
 // Filename:      GridStaff.h
 // URL:           https://github.com/craigsapp/hum2ly/blob/master/include/GridStaff.h
 // Syntax:        C++11; humlib
@@ -20,6 +20,7 @@
 #include "GridCommon.h"
 #include "GridSide.h"
 #include "GridVoice.h"
+#include "HumPool.h"
 
 #include <iostream>
 #include <string>
@@ -35,6 +36,11 @@ class GridStaff : public std::vector<GridVoice*>, public GridSide {
 	public:
 		GridStaff(void);
 		~GridStaff();
+
+		static void* operator new(size_t size)
+		                    { return HumPool<GridStaff>::allocate(size); }
+		static void  operator delete(void* ptr, size_t size)
+		                    { HumPool<GridStaff>::release(ptr, size); }
 		GridVoice* setTokenLayer (int layerindex, HTp token, HumNum duration);
 		void setNullTokenLayer   (int layerindex, SliceType type, HumNum nextdur);
 		void appendTokenLayer    (int layerindex, HTp token, HumNum duration,
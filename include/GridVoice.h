@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Tue Oct 18 12:01:36 PDT 2016
-// Last Modified: Tue Oct 18 12:01:41 PDT 2016
+// Last Modified: Sun Oct 18 23:02:47 PDT 2026 Pooled allocation
 // Filename:      GridVoice.h
 // URL:           https://github.com/craigsapp/hum2ly/blob/master/include/GridVoice.h
 // Syntax:        C++11; humlib
@@ -19,6 +19,7 @@
 #define _GRIDVOICE_H
 
 #include "HumdrumToken.h"
+#include "HumPool.h"
 
 #include <iostream>
 #include <string>
@@ -37,6 +38,11 @@ class GridVoice {
 		GridVoice(const std::string& token, HumNum duration);
 		~GridVoice();
 
+		static void* operator new(size_t size)
+		                    { return HumPool<GridVoice>::allocate(size); }
+		static void  operator delete(void* ptr, size_t size)
+		                    { HumPool<GridVoice>::release(ptr, size); }
+
 		bool   isTransfered       (void);
 
 		HTp    getToken           (void) const;
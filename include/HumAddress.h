@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sat Aug  8 12:24:49 PDT 2015
-// Last Modified: Sun Aug  9 21:19:53 PDT 2015
+// Last Modified: Sun Oct 18 16:21:05 PDT 2026 Interned spine info
 // Filename:      HumAddress.h
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/HumAddress.h
 // Syntax:        C++11; humlib
@@ -13,7 +13,10 @@
 #ifndef _HUMADDRESS_H_INCLUDED
 #define _HUMADDRESS_H_INCLUDED
 
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace hum {
 
@@ -21,9 +24,18 @@ namespace hum {
 
 class HumdrumLine;
 class HumdrumToken;
+class HumdrumFileBase;
 
 class HumAddress {
 	public:
+		// Data type IDs which are the same in every file (see
+		// HumdrumFileBase::internDataType()).
+		enum DataTypeId {
+			DATATYPE_NONE = 0,
+			DATATYPE_KERN = 1,
+			DATATYPE_MENS = 2
+		};
+
 		                    HumAddress        (void);
 		                    HumAddress        (HumAddress& address);
 		                   ~HumAddress        ();
@@ -33,7 +45,9 @@ class HumAddress {
 		int                 getLineNumber     (void) const;
 		int                 getFieldIndex     (void) const;
 		const HumdrumToken& getDataType       (void) const;
+		int                 getDataTypeId     (void) const;
 		const std::string&  getSpineInfo      (void) const;
+		int                 getSpineInfoId    (void) const;
 		int                 getTrack          (void) const;
 		int                 getSubtrack       (void) const;
 		int                 getSubtrackCount  (void) const;
@@ -41,11 +55,16 @@ class HumAddress {
 		HumdrumLine*        getLine           (void) const;
 		HumdrumLine*        getOwner          (void) const { return getLine(); }
 		bool                hasOwner          (void) const;
+		static int          getTrackFromSpineInfo(const std::string& spineinfo);
 
 	protected:
+		HumdrumFileBase*    getOwnerFile      (void) const;
 		void                setOwner          (HumdrumLine* aLine);
 		void                setFieldIndex     (int fieldlindex);
 		void                setSpineInfo      (const std::string& spineinfo);
+		void                setSpineInfoId    (int id);
+		static int          internSpineInfo   (const std::string& spineinfo);
+		static const std::string& getInternedSpineInfo(int id);
 		void                setTrack          (int aTrack, int aSubtrack);
 		void                setTrack          (int aTrack);
 		void                setSubtrack       (int aSubtrack);
@@ -67,7 +86,12 @@ class HumAddress {
 		// But in this case there is a spine info simplification which will
 		// convert "(#)a (#)b" into "#" where # is the original spine number.
 		// Other more complicated mergers may be simplified in the future.
-		std::string m_spining;
+		// The spine info strings are stored once in a table in the owning
+		// HumdrumFile, and the address stores an index into that table.
+		// Addresses which are not owned by a file (such as copies of tokens)
+		// store a negative index into a table shared by all addresses, and
+		// -1 means that there is no spine info.
+		int m_spining;
 
 		// track: This is the track number of the spine.  It is the first
 		// number found in the spineinfo string.
@@ -90,9 +114,15 @@ class HumAddress {
 		// owner: This is the line which manages the given token.
 		HumdrumLine* m_owner;
 
+		// Table of spine info strings for addresses not owned by a file.
+		static std::mutex                           m_sharedmutex;
+		static std::unordered_map<std::string, int> m_sharedids;
+		static std::vector<const std::string*>      m_sharedinfo;
+
 	friend class HumdrumToken;
 	friend class HumdrumLine;
 	friend class HumdrumFile;
+	friend class HumdrumFileBase;
 };
 
 
@@ -0,0 +1,109 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 16:52:31 PDT 2026
+// Last Modified: Sun Oct 18 16:52:34 PDT 2026
+// Filename:      HumAnalysisColumn.h
+// URL:           https://github.com/craigsapp/humlib/blob/master/include/HumAnalysisColumn.h
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   Typed column of analysis results, with one value for
+//                each line of a Humdrum file.  Columns are stored in
+//                HumdrumFileContent and can be accessed directly by
+//                other code, written in bulk as CSV or binary data, or
+//                rendered as a Humdrum spine for text output.
+//
+
+#ifndef _HUMANALYSISCOLUMN_H_INCLUDED
+#define _HUMANALYSISCOLUMN_H_INCLUDED
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace hum {
+
+// START_MERGE
+
+class HumAnalysisColumn {
+	public:
+		enum ColumnType {
+			COLUMN_INT    = 0,
+			COLUMN_DOUBLE = 1,
+			COLUMN_STRING = 2
+		};
+
+		            HumAnalysisColumn  (void);
+		            HumAnalysisColumn  (const std::string& exinterp, int type,
+		                                int linecount);
+		           ~HumAnalysisColumn  ();
+
+		void        clear              (void);
+		void        setLineCount       (int linecount);
+		int         getLineCount       (void) const;
+		int         getType            (void) const;
+		const std::string& getExInterp (void) const;
+		void        setExInterp        (const std::string& exinterp);
+		std::string getName            (void) const;
+		void        setName            (const std::string& name);
+		int         getInsertTrack     (void) const;
+		void        setInsertTrack     (int track);
+
+		bool        isNull             (int lineindex) const;
+		void        setNull            (int lineindex);
+		void        setValue           (int lineindex, int value);
+		void        setValue           (int lineindex, double value);
+		void        setValue           (int lineindex, const std::string& value);
+		int         getInt             (int lineindex) const;
+		double      getDouble          (int lineindex) const;
+		const std::string& getString   (int lineindex) const;
+		std::string getText            (int lineindex) const;
+
+		void        setData            (const std::vector<int>& data,
+		                                const std::string& null = "");
+		void        setData            (const std::vector<double>& data,
+		                                const std::string& null = "");
+		void        setData            (const std::vector<std::string>& data,
+		                                const std::string& null = "");
+
+		std::ostream& writeBinary      (std::ostream& out) const;
+
+	protected:
+		void        checkNull          (int lineindex, const std::string& null);
+
+	private:
+		// m_exinterp: The exclusive interpretation to use when rendering
+		// the column as a spine.
+		std::string m_exinterp;
+
+		// m_name: The label of the column for CSV output.  This is the
+		// exclusive interpretation without "**" if not set explicitly.
+		std::string m_name;
+
+		// m_type: The data type of the column (see ColumnType).
+		int m_type;
+
+		// m_inserttrack: The track before which the column is inserted
+		// when rendered as a spine.  0 means append after the last spine,
+		// and -1 means prepend before the first spine.
+		int m_inserttrack;
+
+		// m_ints, m_doubles, m_strings: The column values, only one of
+		// which is used depending on m_type.
+		std::vector<int>         m_ints;
+		std::vector<double>      m_doubles;
+		std::vector<std::string> m_strings;
+
+		// m_null: True for lines which do not have a value.
+		std::vector<char> m_null;
+};
+
+
+// END_MERGE
+
+} // end namespace hum
+
+#endif /* _HUMANALYSISCOLUMN_H_INCLUDED */
+
+
+
@@ -1,7 +1,8 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sun Oct 16 16:08:05 PDT 2016
-// Last Modified: Sun Oct 16 16:08:08 PDT 2016
+// Last Modified: Sun Oct 18 23:41:05 PDT 2026 Added clear()
+// Last Modified: Mon Oct 19 06:31:05 PDT 2026 Added freePoolMemory()
 // Filename:      HumGrid.h
 // URL:           https://github.com/craigsapp/hum2ly/blob/master/include/HumGrid.h
 // Syntax:        C++11; humlib
@@ -27,6 +28,7 @@ class HumGrid : public std::vector<GridMeasure*> {
 	public:
 		HumGrid(void);
 		~HumGrid();
+		void clear                      (void);
 		void enableRecipSpine           (void);
 		bool transferTokens             (HumdrumFile& outfile, int startbarnum = 0);
 		int  getHarmonyCount            (int partindex);
@@ -47,6 +49,7 @@ class HumGrid : public std::vector<GridMeasure*> {
 		int  getPartCount               (void);
 		int  getStaffCount              (int partindex);
 		void deleteMeasure              (int index);
+		static bool freePoolMemory      (void);
 
 	protected:
 		void calculateGridDurations        (void);
@@ -0,0 +1,73 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 22:05:31 PDT 2026
+// Last Modified: Sun Oct 18 22:05:34 PDT 2026
+// Filename:      HumKeyFinder.h
+// URL:           https://github.com/craigsapp/humlib/blob/master/include/HumKeyFinder.h
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   Key finding by correlation of pitch-class histograms with
+//                major/minor key profiles, for single histograms or for
+//                sliding windows over a sequence of histograms.
+//
+
+#ifndef _HUMKEYFINDER_H_INCLUDED
+#define _HUMKEYFINDER_H_INCLUDED
+
+#include "HumdrumFile.h"
+
+#include <string>
+#include <vector>
+
+namespace hum {
+
+// START_MERGE
+
+class HumKeyFinder {
+	public:
+		              HumKeyFinder        (void);
+		             ~HumKeyFinder        ();
+
+		bool          setProfile          (const std::string& name);
+		void          setProfile          (const std::vector<double>& major,
+		                                   const std::vector<double>& minor);
+		void          setHistograms       (const std::vector<std::vector<double>>& segments);
+		int           getSegmentCount     (void) const;
+		void          getWindowHistogram  (int start, int length,
+		                                   std::vector<double>& histogram) const;
+		int           analyzeHistogram    (const std::vector<double>& histogram,
+		                                   std::vector<double>& correls) const;
+		int           analyzeWindow       (int start, int length,
+		                                   std::vector<double>& correls) const;
+		void          analyzeWindows      (int length, int hop, int count,
+		                                   std::vector<std::vector<double>>& output) const;
+
+		static void   getTrackHistograms  (HumdrumFile& infile, int segments,
+		                                   std::vector<std::vector<std::vector<double>>>& histograms);
+
+	protected:
+		static void   addToHistogram      (std::vector<std::vector<double>>& histogram,
+		                                   int pc, double start, double duration,
+		                                   double totalduration);
+
+	private:
+		// m_kernels: The major (0-11) and minor (12-23) key profiles for each
+		// tonic, shifted to a mean of zero and scaled to a length of one, so
+		// that the correlation with a histogram is a dot product.
+		double m_kernels[24][12];
+
+		// m_prefix: Running sums of the segment histograms: entries 12*i to
+		// 12*i+11 are the sums of segments 0 to i-1.
+		std::vector<double> m_prefix;
+};
+
+
+// END_MERGE
+
+} // end namespace hum
+
+#endif /* _HUMKEYFINDER_H_INCLUDED */
+
+
+
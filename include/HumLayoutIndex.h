@@ -0,0 +1,100 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Mon Oct 19 03:04:18 PDT 2026
+// Last Modified: Mon Oct 19 03:04:21 PDT 2026
+// Filename:      HumLayoutIndex.h
+// URL:           https://github.com/craigsapp/humlib/blob/master/include/HumLayoutIndex.h
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   Resolved layout parameters (!LO: parameters) which are
+//                linked to a token.  The linked parameter sets are read
+//                once in the order in which they apply to the token, and
+//                the result of each parameter query done in
+//                HumdrumToken::getLayoutParameter() and related functions
+//                is stored by category and key, so that queries do not
+//                have to search through the parameter sets again.
+//
+
+#ifndef _HUMLAYOUTINDEX_H_INCLUDED
+#define _HUMLAYOUTINDEX_H_INCLUDED
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace hum {
+
+// START_MERGE
+
+class HumParamSet;
+
+class HumLayoutIndex {
+	public:
+		              HumLayoutIndex     (void);
+		             ~HumLayoutIndex     ();
+
+		void          clear              (void);
+		void          addParameterSet    (HumParamSet& pset);
+
+		const std::string& getValue      (const std::string& category,
+		                                  const std::string& keyname,
+		                                  int subtokenindex = -1) const;
+		const std::string& getLastValue  (const std::string& category,
+		                                  const std::string& keyname) const;
+
+		int           getVersion         (void) const;
+		void          setVersion         (int version);
+
+	private:
+		struct Entry {
+			// first: The first value of the key in the parameter sets.
+			std::string first;
+
+			// last: The last value of the key in the parameter sets.
+			std::string last;
+
+			// notes: The value which applies to a note in a chord (by
+			// subtoken index) through an @n qualification.
+			std::unordered_map<int, std::string> notes;
+
+			// fallback: The value for notes which are not in the notes
+			// list (the first unqualified value of the key).
+			std::string fallback;
+
+			// doneQ: True if fallback has been set, so that later
+			// parameter sets do not apply to the key.
+			bool doneQ = false;
+		};
+
+		struct Category {
+			std::unordered_map<std::string, Entry> entries;
+
+			// history: The @n value in effect after each parameter set
+			// of the category.
+			std::vector<std::string> history;
+
+			// n: The current @n value.
+			std::string n;
+		};
+
+		void          addStep            (Entry& entry, const std::string& n,
+		                                  const std::string& value);
+
+		std::unordered_map<std::string, Category> m_categories;
+
+		// m_version: The layout parameter version of the owning file
+		// when the index was built (see
+		// HumdrumFileStructure::indexLayoutParameters()).
+		int m_version = -1;
+};
+
+
+// END_MERGE
+
+} // end namespace hum
+
+#endif /* _HUMLAYOUTINDEX_H_INCLUDED */
+
+
+
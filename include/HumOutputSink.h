@@ -0,0 +1,69 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 18:12:04 PDT 2026
+// Last Modified: Sun Oct 18 18:12:07 PDT 2026
+// Filename:      HumOutputSink.h
+// URL:           https://github.com/craigsapp/humlib/blob/master/include/HumOutputSink.h
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   Stream buffer which sends text directly to an output
+//                stream, a file descriptor or a caller-supplied writing
+//                function.  Used by HumTool so that Humdrum output does
+//                not have to be collected in memory before printing.
+//
+
+#ifndef _HUMOUTPUTSINK_H_INCLUDED
+#define _HUMOUTPUTSINK_H_INCLUDED
+
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <streambuf>
+#include <vector>
+
+namespace hum {
+
+// START_MERGE
+
+class HumOutputSink : public std::streambuf {
+	public:
+		typedef std::function<void(const char* data, size_t size)> Writer;
+
+		              HumOutputSink      (void);
+		             ~HumOutputSink      ();
+
+		void          setWriter          (const Writer& writer);
+		void          setStream          (std::ostream& out);
+		void          setFileDescriptor  (int fd);
+		void          clear              (void);
+		bool          isActive           (void) const;
+		bool          flush              (void);
+		size_t        getByteCount       (void) const;
+		void          resetByteCount     (void);
+
+	protected:
+		virtual int   overflow           (int ch);
+		virtual int   sync               (void);
+
+	private:
+		// m_writer: The function which receives the output text.
+		Writer m_writer;
+
+		// m_buffer: Storage for text before it is sent to the writer.
+		std::vector<char> m_buffer;
+
+		// m_bytes: The number of bytes sent to the writer since the last
+		// call to resetByteCount().
+		size_t m_bytes;
+};
+
+
+// END_MERGE
+
+} // end namespace hum
+
+#endif /* _HUMOUTPUTSINK_H_INCLUDED */
+
+
+
@@ -0,0 +1,40 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 11:02:17 PDT 2026
+// Last Modified: Sun Oct 18 11:02:20 PDT 2026
+// Filename:      HumParallel.h
+// URL:           https://github.com/craigsapp/humlib/blob/master/include/HumParallel.h
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   Run independent jobs (such as the files in a corpus) on
+//                multiple threads.  When compiled for a platform without
+//                thread support (JavaScript without pthreads), the jobs
+//                are run serially.
+//
+
+#ifndef _HUMPARALLEL_H_INCLUDED
+#define _HUMPARALLEL_H_INCLUDED
+
+#include <functional>
+
+namespace hum {
+
+// START_MERGE
+
+class HumParallel {
+	public:
+		static int   getThreadCount    (int requested = 0);
+		static void  run               (int jobcount, int threadcount,
+		                                const std::function<void(int)>& job);
+};
+
+
+// END_MERGE
+
+} // end namespace hum
+
+#endif /* _HUMPARALLEL_H_INCLUDED */
+
+
+
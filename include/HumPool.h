@@ -0,0 +1,321 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 23:02:44 PDT 2026
+// Last Modified: Mon Oct 19 06:31:05 PDT 2026
+// Filename:      HumPool.h
+// URL:           https://github.com/craigsapp/humlib/blob/master/include/HumPool.h
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   Fixed-size memory pool for classes which are allocated
+//                and deleted in large numbers (such as the GridSlice,
+//                GridPart, GridStaff and GridVoice objects created when
+//                converting scores with HumGrid).  Memory is taken from
+//                large chunks rather than allocated for each object.
+//                Only the allocation is pooled: the objects are still
+//                linked by pointers in the usual way.
+//                Usage: add these functions to the class definition:
+//                   static void* operator new(size_t size)
+//                         { return HumPool<ClassName>::allocate(size); }
+//                   static void operator delete(void* ptr, size_t size)
+//                         { HumPool<ClassName>::release(ptr, size); }
+//                The chunks are kept for reuse until HumPool<ClassName>::clear()
+//                is called while no objects of the class exist.
+//
+
+#ifndef _HUMPOOL_H_INCLUDED
+#define _HUMPOOL_H_INCLUDED
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace hum {
+
+// START_MERGE
+
+template <class TYPE>
+class HumPool {
+	public:
+		static void*  allocate     (size_t size);
+		static void   release      (void* ptr, size_t size);
+		static bool   clear        (void);
+		static long   getObjectCount (void);
+
+	private:
+		union Block {
+			Block* next;
+			alignas(TYPE) char storage[sizeof(TYPE)];
+		};
+
+		// FreeList: the blocks available to a thread.  When the thread
+		// ends, its blocks are returned to the shared list so that they
+		// can be used by other threads.  Lists from before the last
+		// clear() point into freed chunks, and are dropped.
+		struct FreeList {
+			Block* head = NULL;
+			int generation = 0;
+			~FreeList() {
+				if (generation == getGeneration()) {
+					giveBack(head);
+				}
+			}
+		};
+
+		static FreeList& getFreeList (void);
+		static std::mutex& getMutex  (void);
+		static Block*& getSharedList (void);
+		static std::vector<Block*>& getChunks (void);
+		static std::atomic<int>& getGeneration (void);
+		static std::atomic<long>& getCounter (void);
+		static Block* takeBlocks     (void);
+		static void   giveBack       (Block* list);
+
+		// m_chunksize: The number of blocks to allocate at a time.
+		static const int m_chunksize = 256;
+};
+
+
+
+//////////////////////////////
+//
+// HumPool::allocate -- Return memory for an object.  Requests for other
+//     sizes (from derived classes) are passed to the global allocator.
+//
+
+template <class TYPE>
+void* HumPool<TYPE>::allocate(size_t size) {
+	if (size != sizeof(TYPE)) {
+		return ::operator new(size);
+	}
+	getCounter().fetch_add(1, std::memory_order_relaxed);
+	FreeList& freelist = getFreeList();
+	if (freelist.generation != getGeneration()) {
+		freelist.head = NULL;
+		freelist.generation = getGeneration();
+	}
+	if (!freelist.head) {
+		freelist.head = takeBlocks();
+	}
+	Block* block = freelist.head;
+	freelist.head = block->next;
+	return block;
+}
+
+
+
+//////////////////////////////
+//
+// HumPool::release -- Return memory for an object to the free list of
+//     the current thread.  Chunks are kept for reuse until clear() is
+//     called.
+//
+
+template <class TYPE>
+void HumPool<TYPE>::release(void* ptr, size_t size) {
+	if (!ptr) {
+		return;
+	}
+	if (size != sizeof(TYPE)) {
+		::operator delete(ptr);
+		return;
+	}
+	getCounter().fetch_sub(1, std::memory_order_relaxed);
+	FreeList& freelist = getFreeList();
+	if (freelist.generation != getGeneration()) {
+		freelist.head = NULL;
+		freelist.generation = getGeneration();
+	}
+	Block* block = static_cast<Block*>(ptr);
+	block->next = freelist.head;
+	freelist.head = block;
+}
+
+
+
+//////////////////////////////
+//
+// HumPool::clear -- Free all chunks of the pool, such as after a large
+//     conversion in a long-running program.  Nothing is freed (and false
+//     is returned) if objects of the class still exist.  The pool must
+//     not be used by other threads while it is being cleared.
+//
+
+template <class TYPE>
+bool HumPool<TYPE>::clear(void) {
+	std::lock_guard<std::mutex> lock(getMutex());
+	if (getCounter() != 0) {
+		return false;
+	}
+	getGeneration()++;
+	std::vector<Block*>& chunks = getChunks();
+	for (int i=0; i<(int)chunks.size(); i++) {
+		::operator delete(chunks[i]);
+	}
+	chunks.clear();
+	chunks.shrink_to_fit();
+	getSharedList() = NULL;
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumPool::getObjectCount -- Return the number of objects which are
+//     currently allocated from the pool.
+//
+
+template <class TYPE>
+long HumPool<TYPE>::getObjectCount(void) {
+	return getCounter();
+}
+
+
+
+//////////////////////////////
+//
+// HumPool::takeBlocks -- Take the shared list of free blocks, or allocate
+//     a new chunk of blocks if the shared list is empty.
+//
+
+template <class TYPE>
+typename HumPool<TYPE>::Block* HumPool<TYPE>::takeBlocks(void) {
+	{
+		std::lock_guard<std::mutex> lock(getMutex());
+		Block*& shared = getSharedList();
+		if (shared) {
+			Block* output = shared;
+			shared = NULL;
+			return output;
+		}
+	}
+	Block* chunk = static_cast<Block*>(::operator new(sizeof(Block) * m_chunksize));
+	{
+		std::lock_guard<std::mutex> lock(getMutex());
+		getChunks().push_back(chunk);
+	}
+	for (int i=0; i<m_chunksize-1; i++) {
+		chunk[i].next = &chunk[i+1];
+	}
+	chunk[m_chunksize-1].next = NULL;
+	return chunk;
+}
+
+
+
+//////////////////////////////
+//
+// HumPool::giveBack -- Append a list of free blocks to the shared list.
+//
+
+template <class TYPE>
+void HumPool<TYPE>::giveBack(Block* list) {
+	if (!list) {
+		return;
+	}
+	Block* last = list;
+	while (last->next) {
+		last = last->next;
+	}
+	std::lock_guard<std::mutex> lock(getMutex());
+	Block*& shared = getSharedList();
+	last->next = shared;
+	shared = list;
+}
+
+
+
+//////////////////////////////
+//
+// HumPool::getFreeList -- The free blocks for the current thread.
+//
+
+template <class TYPE>
+typename HumPool<TYPE>::FreeList& HumPool<TYPE>::getFreeList(void) {
+	static thread_local FreeList freelist;
+	return freelist;
+}
+
+
+
+//////////////////////////////
+//
+// HumPool::getMutex -- Lock for the shared list.  The mutex and shared
+//     list are never deleted, since threads may return blocks to them
+//     during program exit.
+//
+
+template <class TYPE>
+std::mutex& HumPool<TYPE>::getMutex(void) {
+	static std::mutex* mutex = new std::mutex;
+	return *mutex;
+}
+
+
+
+//////////////////////////////
+//
+// HumPool::getSharedList -- Free blocks returned by threads which have
+//     ended.
+//
+
+template <class TYPE>
+typename HumPool<TYPE>::Block*& HumPool<TYPE>::getSharedList(void) {
+	static Block* shared = NULL;
+	return shared;
+}
+
+
+
+
+//////////////////////////////
+//
+// HumPool::getChunks -- The chunks allocated for the pool, which are
+//     freed by clear().
+//
+
+template <class TYPE>
+std::vector<typename HumPool<TYPE>::Block*>& HumPool<TYPE>::getChunks(void) {
+	static std::vector<Block*>* chunks = new std::vector<Block*>;
+	return *chunks;
+}
+
+
+
+//////////////////////////////
+//
+// HumPool::getGeneration -- Incremented by clear() so that the free lists
+//     of threads can tell that their blocks have been freed.
+//
+
+template <class TYPE>
+std::atomic<int>& HumPool<TYPE>::getGeneration(void) {
+	static std::atomic<int> generation(0);
+	return generation;
+}
+
+
+
+//////////////////////////////
+//
+// HumPool::getCounter -- The number of objects allocated from the pool.
+//
+
+template <class TYPE>
+std::atomic<long>& HumPool<TYPE>::getCounter(void) {
+	static std::atomic<long> counter(0);
+	return counter;
+}
+
+
+// END_MERGE
+
+} // end namespace hum
+
+#endif /* _HUMPOOL_H_INCLUDED */
+
+
+
@@ -2,6 +2,7 @@
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sat Dec  3 10:09:19 PST 2016
 // Last Modified: Sat Dec  3 10:09:23 PST 2016
+// Last Modified: Mon Oct 19 02:31:05 PDT 2026 Reuse compiled expressions
 // Filename:      HumRegex.h
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/HumRegex.h
 // Syntax:        C++11; humlib
@@ -111,6 +112,8 @@ class HumRegex {
 		                                const std::string& separator);
 
 	protected:
+		void        compileRegex       (const std::string& exp,
+		                                std::regex_constants::syntax_option_type flags);
 		std::regex_constants::syntax_option_type
 				getTemporaryRegexFlags(const std::string& sflags);
 		std::regex_constants::match_flag_type
@@ -127,6 +130,12 @@ class HumRegex {
 		// .flags()        == return syntax_option_type used to construct.
 		std::regex m_regex;
 
+		// m_expression: the expression and flags which were used to
+		// compile m_regex (if m_compiledQ is true).
+		std::string m_expression;
+		std::regex_constants::syntax_option_type m_expressionflags;
+		bool m_compiledQ = false;
+
 		// m_matches: stores the matches from a search:
 		//
 		// http://en.cppreference.com/w/cpp/regex/match_results
@@ -0,0 +1,127 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 20:14:52 PDT 2026
+// Last Modified: Sun Oct 18 20:14:55 PDT 2026
+// Last Modified: Mon Oct 19 04:20:48 PDT 2026 Reload files changed on disk
+// Filename:      HumScoreCache.h
+// URL:           https://github.com/craigsapp/humlib/blob/master/include/HumScoreCache.h
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   Keep parsed Humdrum files in memory so that repeated
+//                analyses of the same files (such as in a server process)
+//                do not have to read and parse the files each time.  The
+//                least-recently used files are removed when the cache is
+//                full.
+//
+
+#ifndef _HUMSCORECACHE_H_INCLUDED
+#define _HUMSCORECACHE_H_INCLUDED
+
+#include "HumdrumFile.h"
+
+#include <sys/stat.h>
+
+#include <cstddef>
+#include <ctime>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace hum {
+
+// START_MERGE
+
+class HumScoreEntry {
+	public:
+		              HumScoreEntry     (const std::string& filename);
+		             ~HumScoreEntry     ();
+
+		const std::string& getFilename  (void) const;
+		HumdrumFile&  getFile           (void);
+		std::mutex&   getMutex          (void);
+		bool          prepare           (void);
+		bool          isModified        (void);
+		bool          isChangedOnDisk   (void);
+		int           getParseCount     (void) const;
+
+	protected:
+		bool          load              (void);
+		size_t        getContentHash    (void);
+		bool          getFileStatus     (time_t& mtime, off_t& size);
+
+	private:
+		// m_filename: The file which is stored in the entry.
+		std::string m_filename;
+
+		// m_file: The parsed file.
+		HumdrumFile m_file;
+
+		// m_mutex: Lock which must be held while using m_file.
+		std::mutex m_mutex;
+
+		// m_loaded: True if the file was read successfully.
+		bool m_loaded = false;
+
+		// m_hash: Hash of the line contents after parsing, which is used
+		// to check if the file was changed by a tool.
+		size_t m_hash = 0;
+
+		// m_mtime, m_size: The modification time and size of the file
+		// when it was read, which are used to check if the file was
+		// changed on disk.
+		time_t m_mtime = 0;
+		off_t m_size = -1;
+
+		// m_parsecount: The number of times the file has been parsed.
+		int m_parsecount = 0;
+};
+
+
+class HumScoreCache {
+	public:
+		              HumScoreCache     (int maxfiles = 1000);
+		             ~HumScoreCache     ();
+
+		std::shared_ptr<HumScoreEntry> getScore(const std::string& filename);
+		void          clear             (void);
+		void          setMaxFiles       (int maxfiles);
+		int           getMaxFiles       (void);
+		int           getCount          (void);
+		std::ostream& printStatistics   (std::ostream& out);
+
+	protected:
+		void          trim              (void);
+
+	private:
+		typedef std::list<std::shared_ptr<HumScoreEntry>> EntryList;
+
+		// m_mutex: Lock for the list and index.
+		std::mutex m_mutex;
+
+		// m_maxfiles: The maximum number of files to keep in memory.
+		int m_maxfiles;
+
+		// m_entries: The stored files, with the most-recently used first.
+		EntryList m_entries;
+
+		// m_index: Mapping from a filename to its position in m_entries.
+		std::unordered_map<std::string, EntryList::iterator> m_index;
+
+		// m_hits, m_misses: Number of requests for files which were
+		// or were not already in the cache.
+		size_t m_hits = 0;
+		size_t m_misses = 0;
+};
+
+
+// END_MERGE
+
+} // end namespace hum
+
+#endif /* _HUMSCORECACHE_H_INCLUDED */
+
+
+
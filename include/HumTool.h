@@ -1,7 +1,8 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Mon Nov 28 08:55:15 PST 2016
-// Last Modified: Mon Nov 28 08:55:38 PST 2016
+// Last Modified: Mon Oct 19 00:05:12 PDT 2026 Parallel loading in SET_INTERFACE
+// Last Modified: Mon Oct 19 01:12:40 PDT 2026 Added LINE_STREAM_INTERFACE
 // Filename:      HumTool.h
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/HumTool.h
 // Syntax:        C++11; humlib
@@ -15,6 +16,8 @@
 
 #include "Options.h"
 #include "HumdrumFileSet.h"
+#include "HumdrumLineStream.h"
+#include "HumOutputSink.h"
 
 #include <sstream>
 #include <string>
@@ -39,6 +42,12 @@ class HumTool : public Options {
 		ostream&      getHumdrumText  (ostream& out);
 		void          suppressHumdrumFileOutput(void);
 
+		bool          setHumdrumOutput (std::ostream& out);
+		bool          setHumdrumOutput (int fd);
+		bool          setHumdrumOutput (const HumOutputSink::Writer& writer);
+		void          clearHumdrumOutput(void);
+		bool          isStreamingHumdrum(void);
+
 		bool          hasJsonText     (void);
 		std::string   getJsonText     (void);
 		ostream&      getJsonText     (ostream& out);
@@ -56,6 +65,7 @@ class HumTool : public Options {
 		ostream&      getError        (ostream& out);
 
 	protected:
+		HumOutputSink     m_humdrum_sink;  // direct output of Humdrum text.
 		std::stringstream m_humdrum_text;  // output text in Humdrum syntax.
 		std::stringstream m_json_text;     // output text in JSON syntax.
 		std::stringstream m_free_text;     // output for plain text content.
@@ -64,6 +74,11 @@ class HumTool : public Options {
 
 		bool m_suppress = false;
 
+		// m_buffer_humdrum: Set to true in tools which need to read back
+		// the contents of m_humdrum_text, so that it is never streamed
+		// directly to the output.
+		bool m_buffer_humdrum = false;
+
 };
 
 
@@ -71,6 +86,10 @@ class HumTool : public Options {
 //
 // common command-line Interfaces
 //
+// The stream and set interfaces send Humdrum text directly to standard
+// output while the tool is running (see HumTool::setHumdrumOutput()),
+// except for tools which must read back their own output.
+//
 
 //////////////////////////////
 //
@@ -127,6 +146,7 @@ int main(int argc, char** argv) {                                \
 		interface.getError(cerr);                                  \
 		return -1;                                                 \
 	}                                                             \
+	interface.setHumdrumOutput(cout);                             \
 	HumdrumFileStream instream(static_cast<Options&>(interface)); \
 	HumdrumFileSet infiles;                                       \
 	bool status = true;                                           \
@@ -170,6 +190,7 @@ int main(int argc, char** argv) {                                \
 		interface.getError(cerr);                                  \
 		return -1;                                                 \
 	}                                                             \
+	interface.setHumdrumOutput(cout);                             \
 	HumdrumFileStream instream(static_cast<Options&>(interface)); \
 	bool status = interface.run(instream);                        \
 	if (interface.hasWarning()) {                                 \
@@ -188,10 +209,74 @@ int main(int argc, char** argv) {                                \
 
 
 
+//////////////////////////////
+//
+// LINE_STREAM_INTERFACE -- Send a HumdrumLineStream to the filter so
+//    that it can process the input one line at a time, if the filter
+//    can do so with the given options.  Otherwise the input is read
+//    one segment at a time as in STREAM_INTERFACE.
+//
+// functions that the interface must implement:
+//  .isLineStreamable(void)
+//  .run(HumdrumLineStream& instream)
+//
+
+#define LINE_STREAM_INTERFACE(CLASS)                             \
+using namespace std;                                             \
+using namespace hum;                                             \
+int main(int argc, char** argv) {                                \
+	CLASS interface;                                              \
+	if (!interface.process(argc, argv)) {                         \
+		interface.getError(cerr);                                  \
+		return -1;                                                 \
+	}                                                             \
+	interface.setHumdrumOutput(cout);                             \
+	HumdrumLineStream instream(static_cast<Options&>(interface)); \
+	bool status = true;                                           \
+	if (interface.isLineStreamable()) {                           \
+		status = interface.run(instream);                          \
+		if (interface.hasWarning()) {                              \
+			interface.getWarning(cerr);                             \
+		}                                                          \
+		if (interface.hasAnyText()) {                              \
+		   interface.getAllText(cout);                             \
+		}                                                          \
+		if (interface.hasError()) {                                \
+			interface.getError(cerr);                               \
+			return -1;                                              \
+		}                                                          \
+		interface.clearOutput();                                   \
+		return !status;                                            \
+	}                                                             \
+	HumdrumFileSet infiles;                                       \
+	while (instream.readSingleSegment(infiles)) {                 \
+		status &= interface.run(infiles);                          \
+		if (interface.hasWarning()) {                              \
+			interface.getWarning(cerr);                             \
+		}                                                          \
+		if (interface.hasAnyText()) {                              \
+		   interface.getAllText(cout);                             \
+		}                                                          \
+		if (interface.hasError()) {                                \
+			interface.getError(cerr);                               \
+			return -1;                                              \
+		}                                                          \
+		if (!interface.hasAnyText()) {                             \
+			for (int i=0; i<infiles.getCount(); i++) {              \
+				cout << infiles[i];                                  \
+			}                                                       \
+		}                                                          \
+		interface.clearOutput();                                   \
+	}                                                             \
+	return !status;                                               \
+}
+
+
+
 //////////////////////////////
 //
 // SET_INTERFACE -- Use HumdrumFileSet (multiple file high-memory
-//    usage implementation).
+//    usage implementation).  The input files are parsed in parallel.
 //
 
 #define SET_INTERFACE(CLASS)                                     \
@@ -203,9 +288,10 @@ int main(int argc, char** argv) {                                \
 		interface.getError(cerr);                                  \
 		return -1;                                                 \
 	}                                                             \
+	interface.setHumdrumOutput(cout);                             \
 	HumdrumFileStream instream(static_cast<Options&>(interface)); \
 	HumdrumFileSet infiles;                                       \
-	instream.read(infiles);                                       \
+	infiles.readParallel(instream);                               \
 	bool status = interface.run(infiles);                         \
 	if (interface.hasWarning()) {                                 \
 		interface.getWarning(cerr);                                \
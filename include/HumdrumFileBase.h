@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sat Aug  8 12:24:49 PDT 2015
-// Last Modified: Thu Jun 13 08:38:17 CEST 2019
+// Last Modified: Mon Oct 19 01:12:40 PDT 2026
 // Filename:      HumdrumFileBase.h
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/HumdrumFileBase.h
 // Syntax:        C++11; humlib
@@ -21,6 +21,7 @@
 #include <iostream>
 #include <string>
 #include <sstream>
+#include <unordered_map>
 #include <vector>
 
 // USING_URI is defined if you want to be able to download Humdrum data
@@ -201,6 +202,16 @@ class HumdrumFileBase : public HumHash {
 		                                        const std::vector<std::string>& exinterps)
 		                    { return getSpineStartList(spinestarts, exinterps); }
 
+		// interned spine info and data type strings:
+		int           internSpineInfo          (const std::string& spineinfo);
+		const std::string& getSpineInfoString  (int id) const;
+		int           getSpineInfoTrack        (int id) const;
+		int           internDataType           (const std::string& datatype);
+		int           getDataTypeId            (const std::string& datatype) const;
+		const std::string& getDataTypeString   (int id) const;
+		int           getTrackDataTypeId       (int track) const;
+		void          updateTrackDataType      (HTp token);
+
 		int           getTrackEndCount         (int track) const;
 		HTp           getTrackEnd              (int track, int subtrack) const;
 		void          createLinesFromTokens    (void);
@@ -268,6 +279,9 @@ class HumdrumFileBase : public HumHash {
 		static void   readStringFromHttpUri     (std::stringstream& inputdata,
 		                                         const std::string& webaddress);
 
+		static std::string getMergedSpineInfo   (std::vector<std::string>& info,
+		                                         int starti, int extra);
+
 	protected:
 		static int    getChunk                  (int socket_id,
 		                                         std::stringstream& inputdata,
@@ -291,8 +305,8 @@ class HumdrumFileBase : public HumHash {
 		bool          adjustSpines              (HumdrumLine& line,
 		                                         std::vector<std::string>& datatype,
 		                                         std::vector<std::string>& sinfo);
-		std::string   getMergedSpineInfo        (std::vector<std::string>& info,
-		                                         int starti, int extra);
+		void          internSpineInfoList       (std::vector<int>& ids,
+		                                         std::vector<std::string>& sinfo);
 		bool          stitchLinesTogether       (HumdrumLine& previous,
 		                                         HumdrumLine& next);
 		void          addToTrackStarts          (HTp token);
@@ -333,6 +347,25 @@ class HumdrumFileBase : public HumHash {
 		// dimension is the list of terminators.
 		std::vector<std::vector<HTp> > m_trackends;
 
+		// m_trackdatatypes: the interned data type ID of the exclusive
+		// interpretation for each entry in m_trackstarts.
+		std::vector<int> m_trackdatatypes;
+
+		// m_spineinfos: table of the spine info strings of tokens in the
+		// file, which store an index into the table (see
+		// HumAddress::getSpineInfo()).  m_spineinfotracks is the track
+		// number of each string, and m_spineinfoids maps strings to their
+		// index in the table.
+		std::vector<std::string> m_spineinfos;
+		std::vector<int> m_spineinfotracks;
+		std::unordered_map<std::string, int> m_spineinfoids;
+
+		// m_datatypes: table of exclusive interpretation strings in the
+		// file.  The first entries are fixed (see HumAddress::DataTypeId),
+		// so that **kern and **mens have the same ID in every file.
+		std::vector<std::string> m_datatypes;
+		std::unordered_map<std::string, int> m_datatypeids;
+
 		// m_barlines: list of barlines in the data.  If the first measures is
 		// a pickup measure, then the first entry will not point to the first
 		// starting exclusive interpretation line rather than to a barline.
@@ -377,6 +410,17 @@ class HumdrumFileBase : public HumHash {
 		// file strands have been analyzed.
 		bool m_strands_analyzed = false;
 
+		// m_timeline_analyzed: Used to keep track of whether or not
+		// the tick-based timeline index has been created (see
+		// HumdrumFileStructure::analyzeTimeline()).
+		bool m_timeline_analyzed = false;
+
+		// m_contentcount: Incremented each time the lines of the file are
+		// cleared or replaced, so that analyses stored in derived classes
+		// can tell that they belong to the previous contents (see
+		// HumdrumFileContent::checkAnalysisColumns()).
+		int m_contentcount = 0;
+
 	public:
 		// Dummy functions to allow the HumdrumFile class's inheritance
 		// to be shifted between HumdrumFileContent (the top-level default),
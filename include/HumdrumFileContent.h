@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Mon Aug 17 02:39:28 PDT 2015
-// Last Modified: Mon Aug 17 02:39:32 PDT 2015
+// Last Modified: Sun Oct 18 17:05:41 PDT 2026 Added analysis columns
 // Filename:      HumdrumFileContent.h
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/HumdrumFileContent.h
 // Syntax:        C++11; humlib
@@ -14,6 +14,7 @@
 #ifndef _HUMDRUMFILECONTENT_H_INCLUDED
 #define _HUMDRUMFILECONTENT_H_INCLUDED
 
+#include "HumAnalysisColumn.h"
 #include "HumdrumFileStructure.h"
 
 #include <iostream>
@@ -58,31 +59,55 @@ class HumdrumFileContent : public HumdrumFileStructure {
 		                                   int track = 0);
 
 		template <class DATATYPE>
-		bool   prependDataSpine           (std::vector<DATATYPE> data,
+		bool   prependDataSpine           (const std::vector<DATATYPE>& data,
 		                                   const std::string& null = ".",
 		                                   const std::string& exinterp = "**data",
 		                                   bool recalcLine = true);
 
 		template <class DATATYPE>
-		bool   appendDataSpine            (std::vector<DATATYPE> data,
+		bool   appendDataSpine            (const std::vector<DATATYPE>& data,
 		                                   const std::string& null = ".",
 		                                   const std::string& exinterp = "**data",
 		                                   bool recalcLine = true);
 
 		template <class DATATYPE>
 		bool   insertDataSpineBefore      (int nexttrack,
-		                                   std::vector<DATATYPE> data,
+		                                   const std::vector<DATATYPE>& data,
 		                                   const std::string& null = ".",
 		                                   const std::string& exinterp = "**data",
 		                                   bool recalcLine = true);
 
 		template <class DATATYPE>
 		bool   insertDataSpineAfter       (int prevtrack,
-		                                   std::vector<DATATYPE> data,
+		                                   const std::vector<DATATYPE>& data,
 		                                   const std::string& null = ".",
 		                                   const std::string& exinterp = "**data",
 		                                   bool recalcLine = true);
 
+		// in HumdrumFileContent-analysis.cpp
+		HumAnalysisColumn& addAnalysisColumn (const std::string& exinterp,
+		                                   int type, int inserttrack = 0);
+		HumAnalysisColumn& addAnalysisColumn (const std::vector<int>& data,
+		                                   const std::string& null,
+		                                   const std::string& exinterp,
+		                                   int inserttrack = 0);
+		HumAnalysisColumn& addAnalysisColumn (const std::vector<double>& data,
+		                                   const std::string& null,
+		                                   const std::string& exinterp,
+		                                   int inserttrack = 0);
+		HumAnalysisColumn& addAnalysisColumn (const std::vector<std::string>& data,
+		                                   const std::string& null,
+		                                   const std::string& exinterp,
+		                                   int inserttrack = 0);
+		int    getAnalysisColumnCount     (void) const;
+		HumAnalysisColumn* getAnalysisColumn (int index);
+		HumAnalysisColumn* getAnalysisColumn (const std::string& name);
+		void   clearAnalysisColumns       (void);
+		bool   renderAnalysisColumns      (void);
+		std::ostream& printAnalysisCsv    (std::ostream& out,
+		                                   const std::string& separator = ",");
+		std::ostream& printAnalysisBinary (std::ostream& out);
+
 		// in HumdrumFileContent-ottava.cpp
 		void   analyzeOttavas             (void);
 
@@ -123,6 +148,22 @@ class HumdrumFileContent : public HumdrumFileStructure {
 		void    checkDataForCrossStaffStems(HTp token, std::string& above, std::string& below);
 		void    prepareStaffAboveNoteStems (HTp token);
 		void    prepareStaffBelowNoteStems (HTp token);
+		void    checkAnalysisColumns      (void);
+
+	private:
+		// m_analysis: Analysis results stored as typed columns with one
+		// value for each line of the file.  References returned by
+		// addAnalysisColumn() are valid until the next column is added.
+		std::vector<HumAnalysisColumn> m_analysis;
+
+		// m_analysisrendered: The number of analysis columns which have
+		// already been rendered as spines.
+		int m_analysisrendered = 0;
+
+		// m_analysiscontent: The content count of the file (see
+		// HumdrumFileBase::m_contentcount) for which the analysis
+		// columns were added.
+		int m_analysiscontent = 0;
 };
 
 
@@ -146,7 +187,7 @@ class HumdrumFileContent : public HumdrumFileStructure {
 //
 
 template <class DATATYPE>
-bool HumdrumFileContent::prependDataSpine(std::vector<DATATYPE> data,
+bool HumdrumFileContent::prependDataSpine(const std::vector<DATATYPE>& data,
 		const std::string& null, const std::string& exinterp, bool recalcLine) {
 
 	if ((int)data.size() != getLineCount()) {
@@ -220,7 +261,7 @@ bool HumdrumFileContent::prependDataSpine(std::vector<DATATYPE> data,
 //
 
 template <class DATATYPE>
-bool HumdrumFileContent::appendDataSpine(std::vector<DATATYPE> data,
+bool HumdrumFileContent::appendDataSpine(const std::vector<DATATYPE>& data,
 		const std::string& null, const std::string& exinterp, bool recalcLine) {
 
 	if ((int)data.size() != getLineCount()) {
@@ -300,7 +341,7 @@ bool HumdrumFileContent::appendDataSpine(std::vector<DATATYPE> data,
 
 template <class DATATYPE>
 bool HumdrumFileContent::insertDataSpineBefore(int nexttrack,
-		std::vector<DATATYPE> data, const std::string& null, const std::string& exinterp,
+		const std::vector<DATATYPE>& data, const std::string& null, const std::string& exinterp,
 		bool recalcLine) {
 
 	if ((int)data.size() != getLineCount()) {
@@ -395,7 +436,7 @@ bool HumdrumFileContent::insertDataSpineBefore(int nexttrack,
 
 template <class DATATYPE>
 bool HumdrumFileContent::insertDataSpineAfter(int prevtrack,
-		std::vector<DATATYPE> data, const std::string& null, const std::string& exinterp,
+		const std::vector<DATATYPE>& data, const std::string& null, const std::string& exinterp,
 		bool recalcLine) {
 
 	if ((int)data.size() != getLineCount()) {
@@ -3,6 +3,7 @@
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Fri Mar 29 14:49:35 PDT 2013
 // Last Modified: Sun Jul 28 20:07:50 CEST 2019 Converted to humlib
+// Last Modified: Mon Oct 19 00:05:12 PDT 2026 Added parallel reading
 // Filename:      HumdrumFileSet.h
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/HumdrumFileSet.h
 // Syntax:        C++11; humlib
@@ -54,6 +55,8 @@ class HumdrumFileSet {
       int                   read             (std::istream& inStream);
       int                   read             (Options& options);
       int                   read             (HumdrumFileStream& instream);
+      int                   readParallel     (HumdrumFileStream& instream,
+                                              int threads = 0);
 
       int                   readAppendFile   (const std::string& filename);
       int                   readAppendString (const std::string& contents);
@@ -61,6 +64,8 @@ class HumdrumFileSet {
       int                   readAppend       (std::istream& inStream);
       int                   readAppend       (Options& options);
       int                   readAppend       (HumdrumFileStream& instream);
+      int                   readAppendParallel(HumdrumFileStream& instream,
+                                              int threads = 0);
       int                   readAppendHumdrum(HumdrumFile& infile);
 		int                   appendHumdrumPointer(HumdrumFile* infile);
 
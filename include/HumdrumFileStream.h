@@ -3,6 +3,8 @@
 // Creation Date: Tue Dec 11 16:03:43 PST 2012
 // Last Modified: Fri Mar 11 21:25:24 PST 2016 Changed to STL
 // Last Modified: Fri Dec  2 19:26:01 PST 2016 Ported to humlib
+// Last Modified: Mon Oct 19 00:05:12 PDT 2026 Added getFileContents()
+// Last Modified: Mon Oct 19 05:10:31 PDT 2026 Shared segment reader
 // Filename:      HumdrumFileStream.h
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/HumdrumFileStream.h
 // Syntax:        C++11; humlib
@@ -50,11 +52,17 @@ class HumdrumFileStream {
 		int             eof                (void);
 
 		int             getFile            (HumdrumFile& infile);
+		int             getFileContents    (std::stringstream& contents,
+		                                    HumdrumFile& infile);
 		int             read               (HumdrumFile& infile);
 		int             read               (HumdrumFileSet& infiles);
 		int             readSingleSegment  (HumdrumFileSet& infiles);
 
 	protected:
+		bool            startSegment       (void);
+		bool            readSegmentLine    (std::string& text);
+		void            storeSegmentName   (const std::string& line);
+
 		std::stringstream m_stringbuffer;   // used to read files from a string
 		std::ifstream     m_instream;       // used to read from list of files
 		std::stringstream m_urlbuffer;      // used to read data over internet
@@ -66,6 +74,29 @@ class HumdrumFileStream {
 
 		std::vector<std::string>  m_universals;     // storage for universal comments
 
+		// Segment reading state (see startSegment() and readSegmentLine()):
+		std::istream* m_input = NULL;        // input of the current segment
+		bool m_dataFoundQ      = false;      // non-universal line found in segment
+		bool m_starstarFoundQ  = false;      // exclusive interpretation found
+		bool m_starminusFoundQ = false;      // spine terminator found
+		bool m_universalQ      = false;      // universal comment found in segment
+		bool m_addedFilenameQ  = false;      // filename added to the input list
+
+		// m_queue: Lines to return before reading more input: the
+		// universal comments (demoted to global comments) and the held
+		// exclusive interpretation line at the start of a segment.
+		std::vector<std::string> m_queue;
+		int m_queueindex = 0;
+
+		// m_heldline: exclusive interpretation line which started the
+		// current segment, stored until the universal comments are known.
+		std::string m_heldline;
+
+		// m_filename, m_segmentlevel: The name and !!!!SEGMENT level of
+		// the current segment.
+		std::string m_filename;
+		int m_segmentlevel = 0;
+
 		// Automatic URL downloading of data from internet in read():
 		void     fillUrlBuffer            (std::stringstream& uribuffer,
 		                                   const std::string& uriname);
@@ -1,7 +1,8 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Mon Aug 17 02:39:28 PDT 2015
-// Last Modified: Mon Aug 17 02:39:32 PDT 2015
+// Last Modified: Sun Oct 18 22:41:07 PDT 2026 Parallel track/strand analysis
+// Last Modified: Mon Oct 19 03:04:18 PDT 2026 Indexed layout parameters
 // Filename:      HumdrumFileStructure.h
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/HumdrumFileStructure.h
 // Syntax:        C++11; humlib
@@ -20,6 +21,7 @@
 #include <iostream>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "HumdrumFileBase.h"
@@ -112,11 +114,39 @@ class HumdrumFileStructure : public HumdrumFileBase {
 		bool          analyzeRhythmStructure       (void);
 		bool          analyzeStrands               (void);
 
+		// resolved layout parameters (see HumdrumToken::getLayoutParameter()):
+		void          indexLayoutParameters        (void);
+		int           getLayoutParameterVersion    (void) const;
+
+		// parallel analysis of independent tracks and strands:
+		void          setAnalysisThreadCount       (int count);
+		int           getAnalysisThreadCount       (void);
+
 		// signifier access
 		std::string   getKernLinkSignifier         (void);
 		std::string   getKernAboveSignifier        (void);
 		std::string   getKernBelowSignifier        (void);
 
+		// in HumdrumFileStructure-timeline.cpp
+		bool          analyzeTimeline              (void);
+		int           getLineTick                  (int lineindex);
+		int           getScoreTickDuration         (void);
+		int           timeToTick                   (HumNum time);
+		HumNum        tickToTime                   (int tick);
+		int           getDataLineAtTick            (int tick);
+		int           getDataLineAtTime            (HumNum time);
+		int           getBarlineTick               (int index);
+		int           getBarlineIndexAtTick        (int tick);
+		int           getBarlineIndexAtTime        (HumNum time);
+		void          getAttacksInTickRange        (std::vector<HTp>& attacks,
+		                                            int starttick, int endtick);
+		void          getAttacksInRange            (std::vector<HTp>& attacks,
+		                                            HumNum starttime, HumNum endtime);
+		void          getSoundingNotesAtTick       (std::vector<HTp>& notes,
+		                                            int tick, int track = 0);
+		void          getSoundingNotes             (std::vector<HTp>& notes,
+		                                            HumNum time, int track = 0);
+
 	protected:
 		bool          analyzeRhythm                (void);
 		bool          assignRhythmFromRecip        (HTp spinestart);
@@ -135,9 +165,12 @@ class HumdrumFileStructure : public HumdrumFileBase {
 		                                            HumNum linedur, int line);
 		bool          assignDurationsToTrack       (HTp starttoken,
 		                                            HumNum startdur);
+		bool          assignDurationsToTracks      (std::vector<HTp>& starts);
 		bool          prepareDurations             (HTp token, int state,
-		                                            HumNum startdur);
-		bool          setLineDurationFromStart     (HTp token, HumNum dursum);
+		                                            HumNum startdur,
+		                                            std::vector<std::pair<HTp, HumNum>>* linedurs = NULL);
+		bool          setLineDurationFromStart     (HTp token, HumNum dursum,
+		                                            std::vector<std::pair<HTp, HumNum>>* linedurs = NULL);
 		bool          analyzeRhythmOfFloatingSpine (HTp spinestart);
 		bool          analyzeNullLineRhythms       (void);
 		void          fillInNegativeStartTimes     (void);
@@ -153,6 +186,43 @@ class HumdrumFileStructure : public HumdrumFileBase {
 		                                            HTp starttok);
 		void          analyzeSignifiers            (void);
 		void          setLineRhythmAnalyzed        (void);
+		int           durationToTicks              (HumNum duration);
+		int           getAnalysisThreadCount       (int jobcount);
+		bool          hasCrossTrackLinks           (void);
+
+	private:
+
+		// m_analysisThreads: The number of threads to use for analyzing
+		// tracks and strands (0 = automatic, see getAnalysisThreadCount()).
+		int m_analysisThreads = 0;
+
+		// m_layoutVersion: Incremented by indexLayoutParameters() so that
+		// the layout parameter indexes of the tokens are rebuilt.
+		int m_layoutVersion = 0;
+
+		//
+		// Timeline index variables, filled by analyzeTimeline():
+		//
+
+		// m_lineticks: The starting time of each line in the file in
+		// ticks (see tpq()).
+		std::vector<int> m_lineticks;
+
+		// m_tldatalines: Line indexes of data lines which have a positive
+		// duration (excluding grace-note lines), in time order.
+		// m_tldataticks stores the tick position of each line for
+		// binary searches.
+		std::vector<int> m_tldatalines;
+		std::vector<int> m_tldataticks;
+
+		// m_tlattacks: All note attacks in **kern and **mens spines, sorted
+		// by start time (and then by line and field).  m_tlattackticks
+		// stores the starting tick of each attack for binary searches.
+		std::vector<HTp> m_tlattacks;
+		std::vector<int> m_tlattackticks;
+
+		// m_tlbarticks: The tick positions of the entries in m_barlines.
+		std::vector<int> m_tlbarticks;
 };
 
 
@@ -1,7 +1,8 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sat Aug  8 12:24:49 PDT 2015
-// Last Modified: Wed Aug 12 10:42:07 PDT 2015
+// Last Modified: Sun Oct 18 16:40:12 PDT 2026 Added dirty-text tracking
+// Last Modified: Mon Oct 19 00:41:30 PDT 2026 Precomputed line classes
 // Filename:      HumAddress.h
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/HumAddress.h
 // Syntax:        C++11; humlib
@@ -101,6 +102,9 @@ class HumdrumLine : public std::string, public HumHash {
 		HumdrumFile*  getOwner             (void);
 		void          setText              (const std::string& text);
 		std::string   getText              (void);
+		bool          isTextDirty          (void) const { return m_textdirty; }
+		void          markTextDirty        (void) { m_textdirty = true; }
+		void          updateText           (void);
 
 		HumNum      getDuration            (void);
 		HumNum      getDurationFromStart   (void);
@@ -154,6 +158,7 @@ class HumdrumLine : public std::string, public HumHash {
 		void     clear                  (void);
 		void     setOwner               (void* hfile);
 		int      createTokensFromLine   (void);
+		void     updateLineClass        (void);
 		void     setLayoutParameters    (void);
 		void     setParameters          (const std::string& pdata);
 		void     storeGlobalLinkedParameters(void);
@@ -177,11 +182,16 @@ class HumdrumLine : public std::string, public HumHash {
 		// on a line.  These are prepared automatically after reading in
 		// a full line of text (which is accessed throught the string parent
 		// class).  If the full line is changed, the tokens are not updated
-		// automatically -- use createTokensFromLine().  Likewise the full
-		// text line is not updated if any tokens are changed -- use
-		// createLineFromTokens() in that case.  The second case is more
-		// useful: you can read in a HumdrumFile, tweak the tokens, then
-		// reconstruct the full line and print out again.
+		// automatically -- use createTokensFromLine().  If tokens are
+		// changed with HumdrumToken::setText(), the line is marked as
+		// dirty and the full text line is regenerated when the line is
+		// printed or read with getText() (or use updateText() to update
+		// it immediately).  Reading the std::string parent class of a
+		// dirty line gives the old text, so use getText() for lines with
+		// spines whose tokens may have been changed.  Global lines have
+		// a single token and are updated immediately by setText().
+		// So you can read in a HumdrumFile, tweak the tokens, then print
+		// it out again.
 		// This variable is filled by HumdrumFile::read().
 		// The contents of this vector should be deleted when deconstructing
 		// a HumdrumLine object.
@@ -226,13 +236,38 @@ class HumdrumLine : public std::string, public HumHash {
 		// has been added to line.
 		bool m_rhythm_analyzed = false;
 
+		// m_textdirty: True if the tokens of the line have been changed
+		// since the line text was last generated.  Dirty lines are
+		// regenerated from the tokens when they are printed or read with
+		// getText(), so unchanged lines are printed directly from their
+		// original text.  Only lines with spines can be dirty.
+		bool m_textdirty = false;
+
+		// Line classes stored in m_class by updateLineClass():
+		enum {
+			LINE_DATA           = 0x01,  // not *, ! or = (and not empty)
+			LINE_INTERPRETATION = 0x02,  // starts with *
+			LINE_BARLINE        = 0x04,  // starts with =
+			LINE_COMMENT        = 0x08,  // starts with !
+			LINE_COMMENT_GLOBAL = 0x10,  // starts with !!
+			LINE_EXCLUSIVE      = 0x20,  // starts with **
+			LINE_MANIPULATOR    = 0x40,  // a token is a manipulator
+			LINE_ALL_NULL       = 0x80   // all tokens are null
+		};
+
+		// m_class: Bitmask of the line classes, calculated from the line
+		// text and the token classes when either of them is changed.
+		unsigned int m_class = 0;
+
 		// owner: This is the HumdrumFile which manages the given line.
 		void* m_owner;
 
+	friend class HumdrumToken;
 	friend class HumdrumFileBase;
 	friend class HumdrumFileStructure;
 	friend class HumdrumFileContent;
 	friend class HumdrumFile;
+	friend class HumdrumLineStream;
 };
 
 std::ostream& operator<< (std::ostream& out, HumdrumLine& line);
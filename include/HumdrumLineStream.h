@@ -0,0 +1,97 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Mon Oct 19 01:12:40 PDT 2026
+// Last Modified: Mon Oct 19 05:10:31 PDT 2026
+// Filename:      HumdrumLineStream.h
+// URL:           https://github.com/craigsapp/humlib/blob/master/include/HumdrumLineStream.h
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   Read Humdrum data one line at a time from the same input
+//                sources as HumdrumFileStream.  Each line is split into
+//                tokens which are given their spine info, track and
+//                subtrack while reading, with the spine state kept up to
+//                date through spine manipulators.  Only the current line
+//                is stored, so filters which do not need the rest of the
+//                file can process large concatenated inputs in constant
+//                memory.
+//
+
+#ifndef _HUMDRUMLINESTREAM_H_INCLUDED
+#define _HUMDRUMLINESTREAM_H_INCLUDED
+
+#include "HumdrumFileStream.h"
+#include "HumdrumLine.h"
+
+#include <functional>
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace hum {
+
+// START_MERGE
+
+class HumdrumLineStream : public HumdrumFileStream {
+	public:
+		                HumdrumLineStream  (void);
+		                HumdrumLineStream  (char** list);
+		                HumdrumLineStream  (const std::vector<std::string>& list);
+		                HumdrumLineStream  (Options& options);
+		                HumdrumLineStream  (const std::string& datastream);
+		               ~HumdrumLineStream  ();
+
+		HLp             getLine            (void);
+		bool            process            (const std::function<void(HumdrumLine&)>& event);
+
+		const std::string& getDataType     (int index) const;
+		int             getMaxTrack        (void) const;
+		const std::string& getFilename     (void) const;
+		int             getSegmentLevel    (void) const;
+
+		bool            hasError           (void) const;
+		const std::string& getError        (void) const;
+
+	protected:
+		bool            getText            (std::string& text);
+		void            resetSpines        (void);
+		bool            analyzeSpines      (void);
+		bool            adjustSpines       (void);
+		bool            setError           (const std::string& message);
+
+	private:
+		// m_line: The current line, which is reused for each line.
+		HumdrumLine m_line;
+
+		// m_lineindex: The index of the current line in its segment.
+		int m_lineindex = -1;
+
+		// m_doneQ: No more segments to read.
+		bool m_doneQ = false;
+
+		// Spine state for the current line: the exclusive interpretation,
+		// the spine info and its interned ID for each field.
+		std::vector<std::string> m_datatypes;
+		std::vector<std::string> m_spineinfo;
+		std::vector<int>         m_spineids;
+
+		// Spine state after the current line (if it is a manipulator).
+		std::vector<std::string> m_nexttypes;
+		std::vector<std::string> m_nextinfo;
+		bool m_adjustQ = false;
+
+		// m_maxtrack: The highest track number in the current segment.
+		int m_maxtrack = 0;
+
+		std::string m_error;
+};
+
+
+// END_MERGE
+
+} // end namespace hum
+
+#endif /* _HUMDRUMLINESTREAM_H_INCLUDED */
+
+
+
@@ -2,6 +2,8 @@
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sat Aug  8 12:24:49 PDT 2015
 // Last Modified: Thu Nov 24 08:31:41 PST 2016 Added null token resolving
+// Last Modified: Mon Oct 19 00:41:30 PDT 2026 Precomputed token classes
+// Last Modified: Mon Oct 19 03:04:18 PDT 2026 Indexed layout parameters
 // Filename:      HumdrumToken.h
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/HumdrumToken.h
 // Syntax:        C++11; humlib
@@ -23,6 +25,7 @@ class HumParamSet;
 #include "HumAddress.h"
 #include "HumHash.h"
 #include "HumParamSet.h"
+#include "HumLayoutIndex.h"
 
 namespace hum {
 
@@ -150,9 +153,11 @@ class HumdrumToken : public std::string, public HumHash {
 		int      getTokenNumber            (void) const;
 		const std::string& getDataType     (void) const;
 		bool     isDataType                (const std::string& dtype) const;
+		int      getDataTypeId             (void) const;
 		bool     isKern                    (void) const;
 		bool     isMens                    (void) const;
-		std::string   getSpineInfo         (void) const;
+		const std::string& getSpineInfo    (void) const;
+		int      getSpineInfoId            (void) const;
 		int      getTrack                  (void) const;
 		int      getSubtrack               (void) const;
 		bool     noteInLowerSubtrack       (void);
@@ -235,9 +240,11 @@ class HumdrumToken : public std::string, public HumHash {
 		void     setTrack                  (int aTrack);
 
 	protected:
+		void     updateTokenClass          (void);
 		void     setLineIndex              (int lineindex);
 		void     setFieldIndex             (int fieldlindex);
 		void     setSpineInfo              (const std::string& spineinfo);
+		void     setSpineInfoId            (int id);
 		void     setSubtrack               (int aSubtrack);
 		void     setSubtrackCount          (int count);
 		void     setPreviousToken          (HTp aToken);
@@ -262,8 +269,33 @@ class HumdrumToken : public std::string, public HumHash {
 		                                    const std::string& indent = "\t");
 		std::ostream&	printXmlLinkedParameters (std::ostream& out = std::cout, int level = 0,
 		                                    const std::string& indent = "\t");
+		HumLayoutIndex* getLayoutIndex     (void);
 
 	private:
+		// Token classes stored in m_class by updateTokenClass():
+		enum {
+			TOKEN_DATA           = 0x0001,  // not *, ! or = (and not empty)
+			TOKEN_INTERPRETATION = 0x0002,  // starts with *
+			TOKEN_BARLINE        = 0x0004,  // starts with =
+			TOKEN_COMMENT        = 0x0008,  // starts with !
+			TOKEN_COMMENT_GLOBAL = 0x0010,  // starts with !!
+			TOKEN_NULL           = 0x0020,  // ".", "*" or "!"
+			TOKEN_EXCLUSIVE      = 0x0040,  // starts with **
+			TOKEN_SPLIT          = 0x0080,  // *^
+			TOKEN_MERGE          = 0x0100,  // *v
+			TOKEN_EXCHANGE       = 0x0200,  // *x
+			TOKEN_ADD            = 0x0400,  // *+
+			TOKEN_TERMINATE      = 0x0800,  // *-
+			TOKEN_MANIPULATOR    = 0x1000   // exclusive interpretation or *^ *v *x *+ *-
+		};
+
+		// m_class: Bitmask of the token classes of the text, so that the
+		// is*() functions do not need to examine the text.  This is
+		// updated when the text is set with the constructors, operator=
+		// and setText() (but not if the text is changed with the
+		// std::string functions).
+		unsigned int m_class = 0;
+
 		// address: The address contains information about the location of
 		// the token on a HumdrumLine and in a HumdrumFile.
 		HumAddress m_address;
@@ -318,6 +350,10 @@ class HumdrumToken : public std::string, public HumHash {
 		// token.
 		HumParamSet* m_linkedParameter = NULL;
 
+		// m_layoutIndex: The resolved linked layout parameters (see
+		// getLayoutIndex()).
+		HumLayoutIndex* m_layoutIndex = NULL;
+
 		// m_rhythm_analyzed: Set to true when HumdrumFile assigned duration
 		bool m_rhythm_analyzed = false;
 
@@ -326,6 +362,7 @@ class HumdrumToken : public std::string, public HumHash {
 	friend class HumdrumFileStructure;
 	friend class HumdrumFileContent;
 	friend class HumdrumFile;
+	friend class HumdrumLineStream;
 };
 
 
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sat Aug  6 10:53:40 CEST 2016
-// Last Modified: Sun Sep 18 14:16:18 PDT 2016
+// Last Modified: Sun Oct 18 23:31:52 PDT 2026 Integer tick timeline
 // Filename:      MxmlEvent.cpp
 // URL:           https://github.com/craigsapp/musicxml2hum/blob/master/include/MxmlEvent.h
 // Syntax:        C++11; humlib
@@ -66,8 +66,10 @@ class MxmlEvent {
 		bool               parseEvent         (xml_node el, xml_node nextel,
 		                                       HumNum starttime);
 		bool               parseEvent         (xpath_node el, HumNum starttime);
-		void               setTickStart       (long value, long ticks);
-		void               setTickDur         (long value, long ticks);
+		void               setTickTimeline    (int tpq);
+		long               getTickStart       (void) const;
+		long               getTickDuration    (void) const;
+		static long        timeToTicks        (HumNum value, int tpq);
 		void               setStartTime       (HumNum value);
 		void               setDuration        (HumNum value);
 		void               setDurationByTicks (long value,
@@ -145,6 +147,8 @@ class MxmlEvent {
 	protected:
 		HumNum             m_starttime;  // start time in quarter notes of event
 		HumNum             m_duration;   // duration in quarter notes of event
+		long               m_tickstart = 0; // start time in part timeline ticks
+		long               m_tickdur = 0;   // duration in part timeline ticks
 		measure_event_type m_eventtype;  // enumeration type of event
 		xml_node           m_node;       // pointer to event in XML structure
 		MxmlMeasure*       m_owner;      // measure that contains this event
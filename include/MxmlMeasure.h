@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sat Aug  6 10:53:40 CEST 2016
-// Last Modified: Sun Sep 18 14:16:18 PDT 2016
+// Last Modified: Sun Oct 18 23:31:52 PDT 2026 Integer tick timeline
 // Filename:      MxmlMeasure.cpp
 // URL:           https://github.com/craigsapp/musicxml2hum/blob/master/include/MxmlMeasure.h
 // Syntax:        C++11; humlib
@@ -41,6 +41,7 @@ class SimultaneousEvents {
 		SimultaneousEvents(void) { }
 		~SimultaneousEvents() { }
 		HumNum starttime;              // start time of events
+		long tickstart = 0;            // start time in part timeline ticks
 		HumNum duration;               // duration to next non-zero duration
 		vector<MxmlEvent*> zerodur;    // zero-duration elements at this time
 		vector<MxmlEvent*> nonzerodur; // non-zero dur elements at this time
@@ -70,6 +71,10 @@ class MxmlMeasure {
 		void          attachLastEventToPrevious  (void);
 		void          calculateDuration  (void);
 		int           getEventCount      (void) const;
+		void          setTickTimeline    (int tpq);
+		long          getTickStart       (void) const;
+		long          getTickDuration    (void) const;
+		int           getTimelineTpq     (void) const;
 		vector<SimultaneousEvents>* getSortedEvents(void);
 		MxmlEvent*    getEvent           (int index) const;
 
@@ -100,6 +105,7 @@ class MxmlMeasure {
 		bool  isRepeatBoth(void)       { return m_style == MeasureStyle::RepeatBoth; }
 
 	private:
+		SimultaneousEvents* getSortedEventsAtTick (long tick);
 		void  receiveStaffNumberFromChild         (int staffnum, int voicenum);
 		void  receiveTimeSigDurFromChild          (HumNum duration);
 		void  receiveMeasureStyleFromChild        (MeasureStyle style);
@@ -118,6 +124,8 @@ class MxmlMeasure {
 	protected:
 		HumNum             m_starttime; // start time of measure in quarter notes
 		HumNum             m_duration;  // duration of measure in quarter notes
+		long               m_tickstart = 0; // start time in part timeline ticks
+		long               m_tickdur = 0;   // duration in part timeline ticks
 		HumNum             m_timesigdur; // duration of measure according to
 													// prevailing time signature.
 		MxmlPart*          m_owner;     // part which contains measure
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sat Aug  6 10:53:40 CEST 2016
-// Last Modified: Sun Sep 18 14:16:18 PDT 2016
+// Last Modified: Sun Oct 18 23:31:52 PDT 2026 Integer tick timeline
 // Filename:      MxmlPart.cpp
 // URL:           https://github.com/craigsapp/hum2ly/blob/master/include/MxmlPart.h
 // Syntax:        C++11; humlib
@@ -50,6 +50,9 @@ class MxmlPart {
 		int           setQTicks            (long value);
 	   MxmlMeasure*  getPreviousMeasure   (MxmlMeasure* measure) const;
 		HumNum        getDuration          (void) const;
+		int           getMinimumTimelineTpq(void) const;
+		int           getTimelineTpq       (void) const;
+		void          setTimelineTpq       (int tpq);
 		void          allocateSortedEvents (void);
 		void          setPartNumber        (int number);
 		int           getPartNumber        (void) const;
@@ -101,6 +104,10 @@ class MxmlPart {
 		string               m_caesura;
 		bool                 m_hasOrnaments = false;
 
+		// m_timelinetpq: ticks per quarter note for the integer timeline
+		// used to sort and align events (0 if not yet set).
+		int                  m_timelinetpq = 0;
+
 		// m_staffvoicehist: counts of staff and voice numbers.
 		// staff=0 is used for items such as measures.
 		// voice=0 is used for nonduration items such as harmony.
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sat Aug  8 12:24:49 PDT 2015
-// Last Modified: Thu Nov 24 08:31:41 PST 2016 Added null token resolving
+// Last Modified: Sun Oct 18 21:18:20 PDT 2026 Constructor with precalculated pitch
 // Filename:      HumdrumToken.h
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/HumdrumToken.h
 // Syntax:        C++11; humlib
@@ -34,6 +34,7 @@ class NoteGrid;
 class NoteCell {
 	public:
 		       NoteCell             (NoteGrid* owner, HTp token);
+		       NoteCell             (NoteGrid* owner, HTp token, int b40);
 		      ~NoteCell             (void) { clear();                    }
 
 		double getSgnDiatonicPitch  (void) { return m_b7;                }
@@ -86,6 +87,7 @@ class NoteCell {
 	protected:
 		void clear                  (void);
 		void calculateNumericPitches(void);
+		void setNumericPitches      (int b40);
 		void setVoiceIndex          (int index) { m_voice = index;           }
 		void setSliceIndex          (int index) { m_timeslice = index;       }
 		void setNextAttackIndex     (int index) { m_nextAttackIndex = index; }
@@ -3,6 +3,7 @@
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sun Apr  5 13:07:18 PDT 1998
 // Last Modified: Sat Mar  1 09:27:49 PST 2014 Implemented with STL.
+// Last Modified: Sun Oct 18 19:02:13 PDT 2026 Shared option definitions.
 // Filename:      Options.h
 // Web Address:   https://github.com/craigsapp/humlib/blob/master/include/Options.h
 // Documentation: http://sig.sapp.org/doc/classes/Options
@@ -17,8 +18,11 @@
 
 #include <vector>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <sstream>
+#include <unordered_map>
 
 using namespace std;
 
@@ -64,6 +68,52 @@ class Option_register {
 };
 
 
+//
+// Option_value -- The state of an option in an Options object.  Numeric
+// versions of the value are calculated when the option is set, so that
+// typed access does not have to parse the string each time.
+//
+
+class Option_value {
+	public:
+		string   text;               // modified option string
+		bool     modifiedQ = false;  // true if set on the command-line
+		int      intValue = 0;       // value of string as an integer
+		double   doubleValue = 0.0;  // value of string as a double
+
+		void     set                 (const string& aString);
+};
+
+
+//
+// Option_definitions -- A list of option definitions which is shared by
+// all Options objects which defined the same options in the same order
+// (such as all instances of a tool class).  Each list is never changed
+// after it is created: defining another option moves to a list which
+// contains one more option, created the first time that the option
+// is defined after the current list and then stored in m_next for reuse.
+//
+
+class Option_definitions {
+	public:
+		// m_registers: the definitions and default values of the options.
+		vector<Option_register> m_registers;
+
+		// m_defaults: the default values of the options.
+		vector<Option_value> m_defaults;
+
+		// m_names: mapping from option names/aliases to register index.
+		unordered_map<string, int> m_names;
+
+		// m_next: lists with one more definition, indexed by definition
+		// (and description) strings.
+		map<string, std::shared_ptr<Option_definitions>> m_next;
+
+		static std::shared_ptr<Option_definitions> getEmpty(void);
+		static mutex& getMutex(void);
+};
+
+
 class Options {
 	public:
 		                Options           (void);
@@ -84,16 +134,22 @@ class Options {
 		vector<string>& getArgList        (vector<string>& output);
 		vector<string>& getArgumentList   (vector<string>& output);
 		bool            getBoolean        (const string& optionName);
+		bool            getBoolean        (int index);
 		string          getCommand        (void);
 		string          getCommandLine    (void);
 		string          getDefinition     (const string& optionName);
 		double          getDouble         (const string& optionName);
+		double          getDouble         (int index);
 		char            getFlag           (void);
 		char            getChar           (const string& optionName);
 		float           getFloat          (const string& optionName);
 		int             getInt            (const string& optionName);
+		int             getInt            (int index);
 		int             getInteger        (const string& optionName);
+		int             getInteger        (int index);
 		string          getString         (const string& optionName);
+		string          getString         (int index);
+		int             getIndex          (const string& optionName);
 		char            getType           (const string& optionName);
 		int             optionsArg        (void);
 		ostream&        print             (ostream& out);
@@ -117,6 +173,8 @@ class Options {
 		void            setFlag           (char aFlag);
 		void            setModified       (const string& optionName,
 		                                   const string& optionValue);
+		void            setModified       (int index,
+		                                   const string& optionValue);
 		void            setOptions        (int argc, char** argv);
 		void            setOptions        (const vector<string>& argv);
 		void            setOptions        (const string& args);
@@ -139,16 +197,17 @@ class Options {
 		// are not options, or the command (argv[0]);
 		vector<string> m_arguments;
 
-		// m_optionRegister: store for the states/values of each option.
-		vector<Option_register*> m_optionRegister;
+		// m_definitions: the option definitions, shared with other
+		// Options objects that have the same definitions.
+		std::shared_ptr<Option_definitions> m_definitions;
+
+		// m_values: store for the states/values of each option.
+		vector<Option_value> m_values;
 
 		// m_optionFlag: the character which indicates an option.
 		// Generally a dash, but could be made a slash for Windows environments.
 		char m_optionFlag = '-';
 
-		// m_optionList:
-		map<string, int> m_optionList;
-
 		//
 		// boolern options for object:
 		//
@@ -172,6 +231,8 @@ class Options {
 		stringstream m_error;
 
 	private:
+		int     defineOption   (const string& aDefinition,
+		                        const string& aDescription);
 		int     getRegIndex    (const string& optionName);
 		bool    isOption       (const string& aString, int& argp);
 		int     storeOption    (int gargp, int& position, int& running);
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sat Aug  8 12:24:49 PDT 2015
-// Last Modified: Mon Aug 26 15:38:57 EDT 2019
+// Last Modified: Sun Oct 18 19:54:54 UTC 2026
 // Filename:      humlib.h
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/humlib.h
 // Syntax:        C++11
@@ -40,24 +40,44 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <stdarg.h>
 #include <string.h>
+#include <sys/stat.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cctype>
+#include <chrono>
+#include <cerrno>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <cstring>
+#include <exception>
 #include <fstream>
 #include <functional>
+#include <iomanip>
 #include <iostream>
+#include <limits>
 #include <list>
 #include <locale>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <regex>
 #include <set>
 #include <sstream>
+#include <streambuf>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
+#ifdef _WIN32
+	#include <io.h>
+#else
+	#include <unistd.h>
+#endif
+
 using std::cerr;
 using std::cin;
 using std::cout;
@@ -65,10 +85,14 @@ using std::endl;
 using std::ends;
 using std::ifstream;
 using std::invalid_argument;
+using std::ios;
 using std::istream;
 using std::istreambuf_iterator;
 using std::list;
+using std::lock_guard;
 using std::map;
+using std::mutex;
+using std::ofstream;
 using std::ostream;
 using std::pair;
 using std::regex;
@@ -76,6 +100,7 @@ using std::set;
 using std::string;
 using std::stringstream;
 using std::to_string;
+using std::unordered_map;
 using std::vector;
 
 #ifdef USING_URI
@@ -444,6 +469,8 @@ class HumRegex {
 		                                const std::string& separator);
 
 	protected:
+		void        compileRegex       (const std::string& exp,
+		                                std::regex_constants::syntax_option_type flags);
 		std::regex_constants::syntax_option_type
 				getTemporaryRegexFlags(const std::string& sflags);
 		std::regex_constants::match_flag_type
@@ -460,6 +487,12 @@ class HumRegex {
 		// .flags()        == return syntax_option_type used to construct.
 		std::regex m_regex;
 
+		// m_expression: the expression and flags which were used to
+		// compile m_regex (if m_compiledQ is true).
+		std::string m_expression;
+		std::regex_constants::syntax_option_type m_expressionflags;
+		bool m_compiledQ = false;
+
 		// m_matches: stores the matches from a search:
 		//
 		// http://en.cppreference.com/w/cpp/regex/match_results
@@ -515,6 +548,325 @@ class HumRegex {
 
 
 
+class HumParallel {
+	public:
+		static int   getThreadCount    (int requested = 0);
+		static void  run               (int jobcount, int threadcount,
+		                                const std::function<void(int)>& job);
+};
+
+
+
+template <class TYPE>
+class HumPool {
+	public:
+		static void*  allocate     (size_t size);
+		static void   release      (void* ptr, size_t size);
+		static bool   clear        (void);
+		static long   getObjectCount (void);
+
+	private:
+		union Block {
+			Block* next;
+			alignas(TYPE) char storage[sizeof(TYPE)];
+		};
+
+		// FreeList: the blocks available to a thread.  When the thread
+		// ends, its blocks are returned to the shared list so that they
+		// can be used by other threads.  Lists from before the last
+		// clear() point into freed chunks, and are dropped.
+		struct FreeList {
+			Block* head = NULL;
+			int generation = 0;
+			~FreeList() {
+				if (generation == getGeneration()) {
+					giveBack(head);
+				}
+			}
+		};
+
+		static FreeList& getFreeList (void);
+		static std::mutex& getMutex  (void);
+		static Block*& getSharedList (void);
+		static std::vector<Block*>& getChunks (void);
+		static std::atomic<int>& getGeneration (void);
+		static std::atomic<long>& getCounter (void);
+		static Block* takeBlocks     (void);
+		static void   giveBack       (Block* list);
+
+		// m_chunksize: The number of blocks to allocate at a time.
+		static const int m_chunksize = 256;
+};
+
+
+
+//////////////////////////////
+//
+// HumPool::allocate -- Return memory for an object.  Requests for other
+//     sizes (from derived classes) are passed to the global allocator.
+//
+
+template <class TYPE>
+void* HumPool<TYPE>::allocate(size_t size) {
+	if (size != sizeof(TYPE)) {
+		return ::operator new(size);
+	}
+	getCounter().fetch_add(1, std::memory_order_relaxed);
+	FreeList& freelist = getFreeList();
+	if (freelist.generation != getGeneration()) {
+		freelist.head = NULL;
+		freelist.generation = getGeneration();
+	}
+	if (!freelist.head) {
+		freelist.head = takeBlocks();
+	}
+	Block* block = freelist.head;
+	freelist.head = block->next;
+	return block;
+}
+
+
+
+//////////////////////////////
+//
+// HumPool::release -- Return memory for an object to the free list of
+//     the current thread.  Chunks are kept for reuse until clear() is
+//     called.
+//
+
+template <class TYPE>
+void HumPool<TYPE>::release(void* ptr, size_t size) {
+	if (!ptr) {
+		return;
+	}
+	if (size != sizeof(TYPE)) {
+		::operator delete(ptr);
+		return;
+	}
+	getCounter().fetch_sub(1, std::memory_order_relaxed);
+	FreeList& freelist = getFreeList();
+	if (freelist.generation != getGeneration()) {
+		freelist.head = NULL;
+		freelist.generation = getGeneration();
+	}
+	Block* block = static_cast<Block*>(ptr);
+	block->next = freelist.head;
+	freelist.head = block;
+}
+
+
+
+//////////////////////////////
+//
+// HumPool::clear -- Free all chunks of the pool, such as after a large
+//     conversion in a long-running program.  Nothing is freed (and false
+//     is returned) if objects of the class still exist.  The pool must
+//     not be used by other threads while it is being cleared.
+//
+
+template <class TYPE>
+bool HumPool<TYPE>::clear(void) {
+	std::lock_guard<std::mutex> lock(getMutex());
+	if (getCounter() != 0) {
+		return false;
+	}
+	getGeneration()++;
+	std::vector<Block*>& chunks = getChunks();
+	for (int i=0; i<(int)chunks.size(); i++) {
+		::operator delete(chunks[i]);
+	}
+	chunks.clear();
+	chunks.shrink_to_fit();
+	getSharedList() = NULL;
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumPool::getObjectCount -- Return the number of objects which are
+//     currently allocated from the pool.
+//
+
+template <class TYPE>
+long HumPool<TYPE>::getObjectCount(void) {
+	return getCounter();
+}
+
+
+
+//////////////////////////////
+//
+// HumPool::takeBlocks -- Take the shared list of free blocks, or allocate
+//     a new chunk of blocks if the shared list is empty.
+//
+
+template <class TYPE>
+typename HumPool<TYPE>::Block* HumPool<TYPE>::takeBlocks(void) {
+	{
+		std::lock_guard<std::mutex> lock(getMutex());
+		Block*& shared = getSharedList();
+		if (shared) {
+			Block* output = shared;
+			shared = NULL;
+			return output;
+		}
+	}
+	Block* chunk = static_cast<Block*>(::operator new(sizeof(Block) * m_chunksize));
+	{
+		std::lock_guard<std::mutex> lock(getMutex());
+		getChunks().push_back(chunk);
+	}
+	for (int i=0; i<m_chunksize-1; i++) {
+		chunk[i].next = &chunk[i+1];
+	}
+	chunk[m_chunksize-1].next = NULL;
+	return chunk;
+}
+
+
+
+//////////////////////////////
+//
+// HumPool::giveBack -- Append a list of free blocks to the shared list.
+//
+
+template <class TYPE>
+void HumPool<TYPE>::giveBack(Block* list) {
+	if (!list) {
+		return;
+	}
+	Block* last = list;
+	while (last->next) {
+		last = last->next;
+	}
+	std::lock_guard<std::mutex> lock(getMutex());
+	Block*& shared = getSharedList();
+	last->next = shared;
+	shared = list;
+}
+
+
+
+//////////////////////////////
+//
+// HumPool::getFreeList -- The free blocks for the current thread.
+//
+
+template <class TYPE>
+typename HumPool<TYPE>::FreeList& HumPool<TYPE>::getFreeList(void) {
+	static thread_local FreeList freelist;
+	return freelist;
+}
+
+
+
+//////////////////////////////
+//
+// HumPool::getMutex -- Lock for the shared list.  The mutex and shared
+//     list are never deleted, since threads may return blocks to them
+//     during program exit.
+//
+
+template <class TYPE>
+std::mutex& HumPool<TYPE>::getMutex(void) {
+	static std::mutex* mutex = new std::mutex;
+	return *mutex;
+}
+
+
+
+//////////////////////////////
+//
+// HumPool::getSharedList -- Free blocks returned by threads which have
+//     ended.
+//
+
+template <class TYPE>
+typename HumPool<TYPE>::Block*& HumPool<TYPE>::getSharedList(void) {
+	static Block* shared = NULL;
+	return shared;
+}
+
+
+
+
+//////////////////////////////
+//
+// HumPool::getChunks -- The chunks allocated for the pool, which are
+//     freed by clear().
+//
+
+template <class TYPE>
+std::vector<typename HumPool<TYPE>::Block*>& HumPool<TYPE>::getChunks(void) {
+	static std::vector<Block*>* chunks = new std::vector<Block*>;
+	return *chunks;
+}
+
+
+
+//////////////////////////////
+//
+// HumPool::getGeneration -- Incremented by clear() so that the free lists
+//     of threads can tell that their blocks have been freed.
+//
+
+template <class TYPE>
+std::atomic<int>& HumPool<TYPE>::getGeneration(void) {
+	static std::atomic<int> generation(0);
+	return generation;
+}
+
+
+
+//////////////////////////////
+//
+// HumPool::getCounter -- The number of objects allocated from the pool.
+//
+
+template <class TYPE>
+std::atomic<long>& HumPool<TYPE>::getCounter(void) {
+	static std::atomic<long> counter(0);
+	return counter;
+}
+
+
+
+class HumOutputSink : public std::streambuf {
+	public:
+		typedef std::function<void(const char* data, size_t size)> Writer;
+
+		              HumOutputSink      (void);
+		             ~HumOutputSink      ();
+
+		void          setWriter          (const Writer& writer);
+		void          setStream          (std::ostream& out);
+		void          setFileDescriptor  (int fd);
+		void          clear              (void);
+		bool          isActive           (void) const;
+		bool          flush              (void);
+		size_t        getByteCount       (void) const;
+		void          resetByteCount     (void);
+
+	protected:
+		virtual int   overflow           (int ch);
+		virtual int   sync               (void);
+
+	private:
+		// m_writer: The function which receives the output text.
+		Writer m_writer;
+
+		// m_buffer: Storage for text before it is sent to the writer.
+		std::vector<char> m_buffer;
+
+		// m_bytes: The number of bytes sent to the writer since the last
+		// call to resetByteCount().
+		size_t m_bytes;
+};
+
+
+
 enum signifier_type {
 	signifier_unknown,
 	signifier_link,
@@ -575,9 +927,18 @@ class HumSignifiers {
 
 class HumdrumLine;
 class HumdrumToken;
+class HumdrumFileBase;
 
 class HumAddress {
 	public:
+		// Data type IDs which are the same in every file (see
+		// HumdrumFileBase::internDataType()).
+		enum DataTypeId {
+			DATATYPE_NONE = 0,
+			DATATYPE_KERN = 1,
+			DATATYPE_MENS = 2
+		};
+
 		                    HumAddress        (void);
 		                    HumAddress        (HumAddress& address);
 		                   ~HumAddress        ();
@@ -587,7 +948,9 @@ class HumAddress {
 		int                 getLineNumber     (void) const;
 		int                 getFieldIndex     (void) const;
 		const HumdrumToken& getDataType       (void) const;
+		int                 getDataTypeId     (void) const;
 		const std::string&  getSpineInfo      (void) const;
+		int                 getSpineInfoId    (void) const;
 		int                 getTrack          (void) const;
 		int                 getSubtrack       (void) const;
 		int                 getSubtrackCount  (void) const;
@@ -595,11 +958,16 @@ class HumAddress {
 		HumdrumLine*        getLine           (void) const;
 		HumdrumLine*        getOwner          (void) const { return getLine(); }
 		bool                hasOwner          (void) const;
+		static int          getTrackFromSpineInfo(const std::string& spineinfo);
 
 	protected:
+		HumdrumFileBase*    getOwnerFile      (void) const;
 		void                setOwner          (HumdrumLine* aLine);
 		void                setFieldIndex     (int fieldlindex);
 		void                setSpineInfo      (const std::string& spineinfo);
+		void                setSpineInfoId    (int id);
+		static int          internSpineInfo   (const std::string& spineinfo);
+		static const std::string& getInternedSpineInfo(int id);
 		void                setTrack          (int aTrack, int aSubtrack);
 		void                setTrack          (int aTrack);
 		void                setSubtrack       (int aSubtrack);
@@ -621,7 +989,12 @@ class HumAddress {
 		// But in this case there is a spine info simplification which will
 		// convert "(#)a (#)b" into "#" where # is the original spine number.
 		// Other more complicated mergers may be simplified in the future.
-		std::string m_spining;
+		// The spine info strings are stored once in a table in the owning
+		// HumdrumFile, and the address stores an index into that table.
+		// Addresses which are not owned by a file (such as copies of tokens)
+		// store a negative index into a table shared by all addresses, and
+		// -1 means that there is no spine info.
+		int m_spining;
 
 		// track: This is the track number of the spine.  It is the first
 		// number found in the spineinfo string.
@@ -644,9 +1017,15 @@ class HumAddress {
 		// owner: This is the line which manages the given token.
 		HumdrumLine* m_owner;
 
+		// Table of spine info strings for addresses not owned by a file.
+		static std::mutex                           m_sharedmutex;
+		static std::unordered_map<std::string, int> m_sharedids;
+		static std::vector<const std::string*>      m_sharedinfo;
+
 	friend class HumdrumToken;
 	friend class HumdrumLine;
 	friend class HumdrumFile;
+	friend class HumdrumFileBase;
 };
 
 
@@ -690,6 +1069,145 @@ std::ostream& operator<<(std::ostream& out, HumParamSet& hps);
 
 
 
+class HumParamSet;
+
+class HumLayoutIndex {
+	public:
+		              HumLayoutIndex     (void);
+		             ~HumLayoutIndex     ();
+
+		void          clear              (void);
+		void          addParameterSet    (HumParamSet& pset);
+
+		const std::string& getValue      (const std::string& category,
+		                                  const std::string& keyname,
+		                                  int subtokenindex = -1) const;
+		const std::string& getLastValue  (const std::string& category,
+		                                  const std::string& keyname) const;
+
+		int           getVersion         (void) const;
+		void          setVersion         (int version);
+
+	private:
+		struct Entry {
+			// first: The first value of the key in the parameter sets.
+			std::string first;
+
+			// last: The last value of the key in the parameter sets.
+			std::string last;
+
+			// notes: The value which applies to a note in a chord (by
+			// subtoken index) through an @n qualification.
+			std::unordered_map<int, std::string> notes;
+
+			// fallback: The value for notes which are not in the notes
+			// list (the first unqualified value of the key).
+			std::string fallback;
+
+			// doneQ: True if fallback has been set, so that later
+			// parameter sets do not apply to the key.
+			bool doneQ = false;
+		};
+
+		struct Category {
+			std::unordered_map<std::string, Entry> entries;
+
+			// history: The @n value in effect after each parameter set
+			// of the category.
+			std::vector<std::string> history;
+
+			// n: The current @n value.
+			std::string n;
+		};
+
+		void          addStep            (Entry& entry, const std::string& n,
+		                                  const std::string& value);
+
+		std::unordered_map<std::string, Category> m_categories;
+
+		// m_version: The layout parameter version of the owning file
+		// when the index was built (see
+		// HumdrumFileStructure::indexLayoutParameters()).
+		int m_version = -1;
+};
+
+
+
+class HumAnalysisColumn {
+	public:
+		enum ColumnType {
+			COLUMN_INT    = 0,
+			COLUMN_DOUBLE = 1,
+			COLUMN_STRING = 2
+		};
+
+		            HumAnalysisColumn  (void);
+		            HumAnalysisColumn  (const std::string& exinterp, int type,
+		                                int linecount);
+		           ~HumAnalysisColumn  ();
+
+		void        clear              (void);
+		void        setLineCount       (int linecount);
+		int         getLineCount       (void) const;
+		int         getType            (void) const;
+		const std::string& getExInterp (void) const;
+		void        setExInterp        (const std::string& exinterp);
+		std::string getName            (void) const;
+		void        setName            (const std::string& name);
+		int         getInsertTrack     (void) const;
+		void        setInsertTrack     (int track);
+
+		bool        isNull             (int lineindex) const;
+		void        setNull            (int lineindex);
+		void        setValue           (int lineindex, int value);
+		void        setValue           (int lineindex, double value);
+		void        setValue           (int lineindex, const std::string& value);
+		int         getInt             (int lineindex) const;
+		double      getDouble          (int lineindex) const;
+		const std::string& getString   (int lineindex) const;
+		std::string getText            (int lineindex) const;
+
+		void        setData            (const std::vector<int>& data,
+		                                const std::string& null = "");
+		void        setData            (const std::vector<double>& data,
+		                                const std::string& null = "");
+		void        setData            (const std::vector<std::string>& data,
+		                                const std::string& null = "");
+
+		std::ostream& writeBinary      (std::ostream& out) const;
+
+	protected:
+		void        checkNull          (int lineindex, const std::string& null);
+
+	private:
+		// m_exinterp: The exclusive interpretation to use when rendering
+		// the column as a spine.
+		std::string m_exinterp;
+
+		// m_name: The label of the column for CSV output.  This is the
+		// exclusive interpretation without "**" if not set explicitly.
+		std::string m_name;
+
+		// m_type: The data type of the column (see ColumnType).
+		int m_type;
+
+		// m_inserttrack: The track before which the column is inserted
+		// when rendered as a spine.  0 means append after the last spine,
+		// and -1 means prepend before the first spine.
+		int m_inserttrack;
+
+		// m_ints, m_doubles, m_strings: The column values, only one of
+		// which is used depending on m_type.
+		std::vector<int>         m_ints;
+		std::vector<double>      m_doubles;
+		std::vector<std::string> m_strings;
+
+		// m_null: True for lines which do not have a value.
+		std::vector<char> m_null;
+};
+
+
+
 class _HumInstrument {
 	public:
 		_HumInstrument    (void) { humdrum = ""; name = ""; gm = 0; }
@@ -1041,6 +1559,9 @@ class HumdrumLine : public std::string, public HumHash {
 		HumdrumFile*  getOwner             (void);
 		void          setText              (const std::string& text);
 		std::string   getText              (void);
+		bool          isTextDirty          (void) const { return m_textdirty; }
+		void          markTextDirty        (void) { m_textdirty = true; }
+		void          updateText           (void);
 
 		HumNum      getDuration            (void);
 		HumNum      getDurationFromStart   (void);
@@ -1094,6 +1615,7 @@ class HumdrumLine : public std::string, public HumHash {
 		void     clear                  (void);
 		void     setOwner               (void* hfile);
 		int      createTokensFromLine   (void);
+		void     updateLineClass        (void);
 		void     setLayoutParameters    (void);
 		void     setParameters          (const std::string& pdata);
 		void     storeGlobalLinkedParameters(void);
@@ -1117,11 +1639,16 @@ class HumdrumLine : public std::string, public HumHash {
 		// on a line.  These are prepared automatically after reading in
 		// a full line of text (which is accessed throught the string parent
 		// class).  If the full line is changed, the tokens are not updated
-		// automatically -- use createTokensFromLine().  Likewise the full
-		// text line is not updated if any tokens are changed -- use
-		// createLineFromTokens() in that case.  The second case is more
-		// useful: you can read in a HumdrumFile, tweak the tokens, then
-		// reconstruct the full line and print out again.
+		// automatically -- use createTokensFromLine().  If tokens are
+		// changed with HumdrumToken::setText(), the line is marked as
+		// dirty and the full text line is regenerated when the line is
+		// printed or read with getText() (or use updateText() to update
+		// it immediately).  Reading the std::string parent class of a
+		// dirty line gives the old text, so use getText() for lines with
+		// spines whose tokens may have been changed.  Global lines have
+		// a single token and are updated immediately by setText().
+		// So you can read in a HumdrumFile, tweak the tokens, then print
+		// it out again.
 		// This variable is filled by HumdrumFile::read().
 		// The contents of this vector should be deleted when deconstructing
 		// a HumdrumLine object.
@@ -1166,13 +1693,38 @@ class HumdrumLine : public std::string, public HumHash {
 		// has been added to line.
 		bool m_rhythm_analyzed = false;
 
+		// m_textdirty: True if the tokens of the line have been changed
+		// since the line text was last generated.  Dirty lines are
+		// regenerated from the tokens when they are printed or read with
+		// getText(), so unchanged lines are printed directly from their
+		// original text.  Only lines with spines can be dirty.
+		bool m_textdirty = false;
+
+		// Line classes stored in m_class by updateLineClass():
+		enum {
+			LINE_DATA           = 0x01,  // not *, ! or = (and not empty)
+			LINE_INTERPRETATION = 0x02,  // starts with *
+			LINE_BARLINE        = 0x04,  // starts with =
+			LINE_COMMENT        = 0x08,  // starts with !
+			LINE_COMMENT_GLOBAL = 0x10,  // starts with !!
+			LINE_EXCLUSIVE      = 0x20,  // starts with **
+			LINE_MANIPULATOR    = 0x40,  // a token is a manipulator
+			LINE_ALL_NULL       = 0x80   // all tokens are null
+		};
+
+		// m_class: Bitmask of the line classes, calculated from the line
+		// text and the token classes when either of them is changed.
+		unsigned int m_class = 0;
+
 		// owner: This is the HumdrumFile which manages the given line.
 		void* m_owner;
 
+	friend class HumdrumToken;
 	friend class HumdrumFileBase;
 	friend class HumdrumFileStructure;
 	friend class HumdrumFileContent;
 	friend class HumdrumFile;
+	friend class HumdrumLineStream;
 };
 
 std::ostream& operator<< (std::ostream& out, HumdrumLine& line);
@@ -1302,9 +1854,11 @@ class HumdrumToken : public std::string, public HumHash {
 		int      getTokenNumber            (void) const;
 		const std::string& getDataType     (void) const;
 		bool     isDataType                (const std::string& dtype) const;
+		int      getDataTypeId             (void) const;
 		bool     isKern                    (void) const;
 		bool     isMens                    (void) const;
-		std::string   getSpineInfo         (void) const;
+		const std::string& getSpineInfo    (void) const;
+		int      getSpineInfoId            (void) const;
 		int      getTrack                  (void) const;
 		int      getSubtrack               (void) const;
 		bool     noteInLowerSubtrack       (void);
@@ -1387,9 +1941,11 @@ class HumdrumToken : public std::string, public HumHash {
 		void     setTrack                  (int aTrack);
 
 	protected:
+		void     updateTokenClass          (void);
 		void     setLineIndex              (int lineindex);
 		void     setFieldIndex             (int fieldlindex);
 		void     setSpineInfo              (const std::string& spineinfo);
+		void     setSpineInfoId            (int id);
 		void     setSubtrack               (int aSubtrack);
 		void     setSubtrackCount          (int count);
 		void     setPreviousToken          (HTp aToken);
@@ -1414,8 +1970,33 @@ class HumdrumToken : public std::string, public HumHash {
 		                                    const std::string& indent = "\t");
 		std::ostream&	printXmlLinkedParameters (std::ostream& out = std::cout, int level = 0,
 		                                    const std::string& indent = "\t");
+		HumLayoutIndex* getLayoutIndex     (void);
 
 	private:
+		// Token classes stored in m_class by updateTokenClass():
+		enum {
+			TOKEN_DATA           = 0x0001,  // not *, ! or = (and not empty)
+			TOKEN_INTERPRETATION = 0x0002,  // starts with *
+			TOKEN_BARLINE        = 0x0004,  // starts with =
+			TOKEN_COMMENT        = 0x0008,  // starts with !
+			TOKEN_COMMENT_GLOBAL = 0x0010,  // starts with !!
+			TOKEN_NULL           = 0x0020,  // ".", "*" or "!"
+			TOKEN_EXCLUSIVE      = 0x0040,  // starts with **
+			TOKEN_SPLIT          = 0x0080,  // *^
+			TOKEN_MERGE          = 0x0100,  // *v
+			TOKEN_EXCHANGE       = 0x0200,  // *x
+			TOKEN_ADD            = 0x0400,  // *+
+			TOKEN_TERMINATE      = 0x0800,  // *-
+			TOKEN_MANIPULATOR    = 0x1000   // exclusive interpretation or *^ *v *x *+ *-
+		};
+
+		// m_class: Bitmask of the token classes of the text, so that the
+		// is*() functions do not need to examine the text.  This is
+		// updated when the text is set with the constructors, operator=
+		// and setText() (but not if the text is changed with the
+		// std::string functions).
+		unsigned int m_class = 0;
+
 		// address: The address contains information about the location of
 		// the token on a HumdrumLine and in a HumdrumFile.
 		HumAddress m_address;
@@ -1470,6 +2051,10 @@ class HumdrumToken : public std::string, public HumHash {
 		// token.
 		HumParamSet* m_linkedParameter = NULL;
 
+		// m_layoutIndex: The resolved linked layout parameters (see
+		// getLayoutIndex()).
+		HumLayoutIndex* m_layoutIndex = NULL;
+
 		// m_rhythm_analyzed: Set to true when HumdrumFile assigned duration
 		bool m_rhythm_analyzed = false;
 
@@ -1478,6 +2063,7 @@ class HumdrumToken : public std::string, public HumHash {
 	friend class HumdrumFileStructure;
 	friend class HumdrumFileContent;
 	friend class HumdrumFile;
+	friend class HumdrumLineStream;
 };
 
 
@@ -1645,6 +2231,16 @@ class HumdrumFileBase : public HumHash {
 		                                        const std::vector<std::string>& exinterps)
 		                    { return getSpineStartList(spinestarts, exinterps); }
 
+		// interned spine info and data type strings:
+		int           internSpineInfo          (const std::string& spineinfo);
+		const std::string& getSpineInfoString  (int id) const;
+		int           getSpineInfoTrack        (int id) const;
+		int           internDataType           (const std::string& datatype);
+		int           getDataTypeId            (const std::string& datatype) const;
+		const std::string& getDataTypeString   (int id) const;
+		int           getTrackDataTypeId       (int track) const;
+		void          updateTrackDataType      (HTp token);
+
 		int           getTrackEndCount         (int track) const;
 		HTp           getTrackEnd              (int track, int subtrack) const;
 		void          createLinesFromTokens    (void);
@@ -1712,6 +2308,9 @@ class HumdrumFileBase : public HumHash {
 		static void   readStringFromHttpUri     (std::stringstream& inputdata,
 		                                         const std::string& webaddress);
 
+		static std::string getMergedSpineInfo   (std::vector<std::string>& info,
+		                                         int starti, int extra);
+
 	protected:
 		static int    getChunk                  (int socket_id,
 		                                         std::stringstream& inputdata,
@@ -1735,8 +2334,8 @@ class HumdrumFileBase : public HumHash {
 		bool          adjustSpines              (HumdrumLine& line,
 		                                         std::vector<std::string>& datatype,
 		                                         std::vector<std::string>& sinfo);
-		std::string   getMergedSpineInfo        (std::vector<std::string>& info,
-		                                         int starti, int extra);
+		void          internSpineInfoList       (std::vector<int>& ids,
+		                                         std::vector<std::string>& sinfo);
 		bool          stitchLinesTogether       (HumdrumLine& previous,
 		                                         HumdrumLine& next);
 		void          addToTrackStarts          (HTp token);
@@ -1777,6 +2376,25 @@ class HumdrumFileBase : public HumHash {
 		// dimension is the list of terminators.
 		std::vector<std::vector<HTp> > m_trackends;
 
+		// m_trackdatatypes: the interned data type ID of the exclusive
+		// interpretation for each entry in m_trackstarts.
+		std::vector<int> m_trackdatatypes;
+
+		// m_spineinfos: table of the spine info strings of tokens in the
+		// file, which store an index into the table (see
+		// HumAddress::getSpineInfo()).  m_spineinfotracks is the track
+		// number of each string, and m_spineinfoids maps strings to their
+		// index in the table.
+		std::vector<std::string> m_spineinfos;
+		std::vector<int> m_spineinfotracks;
+		std::unordered_map<std::string, int> m_spineinfoids;
+
+		// m_datatypes: table of exclusive interpretation strings in the
+		// file.  The first entries are fixed (see HumAddress::DataTypeId),
+		// so that **kern and **mens have the same ID in every file.
+		std::vector<std::string> m_datatypes;
+		std::unordered_map<std::string, int> m_datatypeids;
+
 		// m_barlines: list of barlines in the data.  If the first measures is
 		// a pickup measure, then the first entry will not point to the first
 		// starting exclusive interpretation line rather than to a barline.
@@ -1821,6 +2439,17 @@ class HumdrumFileBase : public HumHash {
 		// file strands have been analyzed.
 		bool m_strands_analyzed = false;
 
+		// m_timeline_analyzed: Used to keep track of whether or not
+		// the tick-based timeline index has been created (see
+		// HumdrumFileStructure::analyzeTimeline()).
+		bool m_timeline_analyzed = false;
+
+		// m_contentcount: Incremented each time the lines of the file are
+		// cleared or replaced, so that analyses stored in derived classes
+		// can tell that they belong to the previous contents (see
+		// HumdrumFileContent::checkAnalysisColumns()).
+		int m_contentcount = 0;
+
 	public:
 		// Dummy functions to allow the HumdrumFile class's inheritance
 		// to be shifted between HumdrumFileContent (the top-level default),
@@ -1937,11 +2566,39 @@ class HumdrumFileStructure : public HumdrumFileBase {
 		bool          analyzeRhythmStructure       (void);
 		bool          analyzeStrands               (void);
 
+		// resolved layout parameters (see HumdrumToken::getLayoutParameter()):
+		void          indexLayoutParameters        (void);
+		int           getLayoutParameterVersion    (void) const;
+
+		// parallel analysis of independent tracks and strands:
+		void          setAnalysisThreadCount       (int count);
+		int           getAnalysisThreadCount       (void);
+
 		// signifier access
 		std::string   getKernLinkSignifier         (void);
 		std::string   getKernAboveSignifier        (void);
 		std::string   getKernBelowSignifier        (void);
 
+		// in HumdrumFileStructure-timeline.cpp
+		bool          analyzeTimeline              (void);
+		int           getLineTick                  (int lineindex);
+		int           getScoreTickDuration         (void);
+		int           timeToTick                   (HumNum time);
+		HumNum        tickToTime                   (int tick);
+		int           getDataLineAtTick            (int tick);
+		int           getDataLineAtTime            (HumNum time);
+		int           getBarlineTick               (int index);
+		int           getBarlineIndexAtTick        (int tick);
+		int           getBarlineIndexAtTime        (HumNum time);
+		void          getAttacksInTickRange        (std::vector<HTp>& attacks,
+		                                            int starttick, int endtick);
+		void          getAttacksInRange            (std::vector<HTp>& attacks,
+		                                            HumNum starttime, HumNum endtime);
+		void          getSoundingNotesAtTick       (std::vector<HTp>& notes,
+		                                            int tick, int track = 0);
+		void          getSoundingNotes             (std::vector<HTp>& notes,
+		                                            HumNum time, int track = 0);
+
 	protected:
 		bool          analyzeRhythm                (void);
 		bool          assignRhythmFromRecip        (HTp spinestart);
@@ -1960,9 +2617,12 @@ class HumdrumFileStructure : public HumdrumFileBase {
 		                                            HumNum linedur, int line);
 		bool          assignDurationsToTrack       (HTp starttoken,
 		                                            HumNum startdur);
+		bool          assignDurationsToTracks      (std::vector<HTp>& starts);
 		bool          prepareDurations             (HTp token, int state,
-		                                            HumNum startdur);
-		bool          setLineDurationFromStart     (HTp token, HumNum dursum);
+		                                            HumNum startdur,
+		                                            std::vector<std::pair<HTp, HumNum>>* linedurs = NULL);
+		bool          setLineDurationFromStart     (HTp token, HumNum dursum,
+		                                            std::vector<std::pair<HTp, HumNum>>* linedurs = NULL);
 		bool          analyzeRhythmOfFloatingSpine (HTp spinestart);
 		bool          analyzeNullLineRhythms       (void);
 		void          fillInNegativeStartTimes     (void);
@@ -1978,6 +2638,43 @@ class HumdrumFileStructure : public HumdrumFileBase {
 		                                            HTp starttok);
 		void          analyzeSignifiers            (void);
 		void          setLineRhythmAnalyzed        (void);
+		int           durationToTicks              (HumNum duration);
+		int           getAnalysisThreadCount       (int jobcount);
+		bool          hasCrossTrackLinks           (void);
+
+	private:
+
+		// m_analysisThreads: The number of threads to use for analyzing
+		// tracks and strands (0 = automatic, see getAnalysisThreadCount()).
+		int m_analysisThreads = 0;
+
+		// m_layoutVersion: Incremented by indexLayoutParameters() so that
+		// the layout parameter indexes of the tokens are rebuilt.
+		int m_layoutVersion = 0;
+
+		//
+		// Timeline index variables, filled by analyzeTimeline():
+		//
+
+		// m_lineticks: The starting time of each line in the file in
+		// ticks (see tpq()).
+		std::vector<int> m_lineticks;
+
+		// m_tldatalines: Line indexes of data lines which have a positive
+		// duration (excluding grace-note lines), in time order.
+		// m_tldataticks stores the tick position of each line for
+		// binary searches.
+		std::vector<int> m_tldatalines;
+		std::vector<int> m_tldataticks;
+
+		// m_tlattacks: All note attacks in **kern and **mens spines, sorted
+		// by start time (and then by line and field).  m_tlattackticks
+		// stores the starting tick of each attack for binary searches.
+		std::vector<HTp> m_tlattacks;
+		std::vector<int> m_tlattackticks;
+
+		// m_tlbarticks: The tick positions of the entries in m_barlines.
+		std::vector<int> m_tlbarticks;
 };
 
 
@@ -2013,31 +2710,55 @@ class HumdrumFileContent : public HumdrumFileStructure {
 		                                   int track = 0);
 
 		template <class DATATYPE>
-		bool   prependDataSpine           (std::vector<DATATYPE> data,
+		bool   prependDataSpine           (const std::vector<DATATYPE>& data,
 		                                   const std::string& null = ".",
 		                                   const std::string& exinterp = "**data",
 		                                   bool recalcLine = true);
 
 		template <class DATATYPE>
-		bool   appendDataSpine            (std::vector<DATATYPE> data,
+		bool   appendDataSpine            (const std::vector<DATATYPE>& data,
 		                                   const std::string& null = ".",
 		                                   const std::string& exinterp = "**data",
 		                                   bool recalcLine = true);
 
 		template <class DATATYPE>
 		bool   insertDataSpineBefore      (int nexttrack,
-		                                   std::vector<DATATYPE> data,
+		                                   const std::vector<DATATYPE>& data,
 		                                   const std::string& null = ".",
 		                                   const std::string& exinterp = "**data",
 		                                   bool recalcLine = true);
 
 		template <class DATATYPE>
 		bool   insertDataSpineAfter       (int prevtrack,
-		                                   std::vector<DATATYPE> data,
+		                                   const std::vector<DATATYPE>& data,
 		                                   const std::string& null = ".",
 		                                   const std::string& exinterp = "**data",
 		                                   bool recalcLine = true);
 
+		// in HumdrumFileContent-analysis.cpp
+		HumAnalysisColumn& addAnalysisColumn (const std::string& exinterp,
+		                                   int type, int inserttrack = 0);
+		HumAnalysisColumn& addAnalysisColumn (const std::vector<int>& data,
+		                                   const std::string& null,
+		                                   const std::string& exinterp,
+		                                   int inserttrack = 0);
+		HumAnalysisColumn& addAnalysisColumn (const std::vector<double>& data,
+		                                   const std::string& null,
+		                                   const std::string& exinterp,
+		                                   int inserttrack = 0);
+		HumAnalysisColumn& addAnalysisColumn (const std::vector<std::string>& data,
+		                                   const std::string& null,
+		                                   const std::string& exinterp,
+		                                   int inserttrack = 0);
+		int    getAnalysisColumnCount     (void) const;
+		HumAnalysisColumn* getAnalysisColumn (int index);
+		HumAnalysisColumn* getAnalysisColumn (const std::string& name);
+		void   clearAnalysisColumns       (void);
+		bool   renderAnalysisColumns      (void);
+		std::ostream& printAnalysisCsv    (std::ostream& out,
+		                                   const std::string& separator = ",");
+		std::ostream& printAnalysisBinary (std::ostream& out);
+
 		// in HumdrumFileContent-ottava.cpp
 		void   analyzeOttavas             (void);
 
@@ -2078,6 +2799,22 @@ class HumdrumFileContent : public HumdrumFileStructure {
 		void    checkDataForCrossStaffStems(HTp token, std::string& above, std::string& below);
 		void    prepareStaffAboveNoteStems (HTp token);
 		void    prepareStaffBelowNoteStems (HTp token);
+		void    checkAnalysisColumns      (void);
+
+	private:
+		// m_analysis: Analysis results stored as typed columns with one
+		// value for each line of the file.  References returned by
+		// addAnalysisColumn() are valid until the next column is added.
+		std::vector<HumAnalysisColumn> m_analysis;
+
+		// m_analysisrendered: The number of analysis columns which have
+		// already been rendered as spines.
+		int m_analysisrendered = 0;
+
+		// m_analysiscontent: The content count of the file (see
+		// HumdrumFileBase::m_contentcount) for which the analysis
+		// columns were added.
+		int m_analysiscontent = 0;
 };
 
 
@@ -2101,7 +2838,7 @@ class HumdrumFileContent : public HumdrumFileStructure {
 //
 
 template <class DATATYPE>
-bool HumdrumFileContent::prependDataSpine(std::vector<DATATYPE> data,
+bool HumdrumFileContent::prependDataSpine(const std::vector<DATATYPE>& data,
 		const std::string& null, const std::string& exinterp, bool recalcLine) {
 
 	if ((int)data.size() != getLineCount()) {
@@ -2175,7 +2912,7 @@ bool HumdrumFileContent::prependDataSpine(std::vector<DATATYPE> data,
 //
 
 template <class DATATYPE>
-bool HumdrumFileContent::appendDataSpine(std::vector<DATATYPE> data,
+bool HumdrumFileContent::appendDataSpine(const std::vector<DATATYPE>& data,
 		const std::string& null, const std::string& exinterp, bool recalcLine) {
 
 	if ((int)data.size() != getLineCount()) {
@@ -2255,7 +2992,7 @@ bool HumdrumFileContent::appendDataSpine(std::vector<DATATYPE> data,
 
 template <class DATATYPE>
 bool HumdrumFileContent::insertDataSpineBefore(int nexttrack,
-		std::vector<DATATYPE> data, const std::string& null, const std::string& exinterp,
+		const std::vector<DATATYPE>& data, const std::string& null, const std::string& exinterp,
 		bool recalcLine) {
 
 	if ((int)data.size() != getLineCount()) {
@@ -2350,7 +3087,7 @@ bool HumdrumFileContent::insertDataSpineBefore(int nexttrack,
 
 template <class DATATYPE>
 bool HumdrumFileContent::insertDataSpineAfter(int prevtrack,
-		std::vector<DATATYPE> data, const std::string& null, const std::string& exinterp,
+		const std::vector<DATATYPE>& data, const std::string& null, const std::string& exinterp,
 		bool recalcLine) {
 
 	if ((int)data.size() != getLineCount()) {
@@ -2447,6 +3184,130 @@ class HumdrumFile : public HUMDRUMFILE_PARENT {
 
 
 
+class HumScoreEntry {
+	public:
+		              HumScoreEntry     (const std::string& filename);
+		             ~HumScoreEntry     ();
+
+		const std::string& getFilename  (void) const;
+		HumdrumFile&  getFile           (void);
+		std::mutex&   getMutex          (void);
+		bool          prepare           (void);
+		bool          isModified        (void);
+		bool          isChangedOnDisk   (void);
+		int           getParseCount     (void) const;
+
+	protected:
+		bool          load              (void);
+		size_t        getContentHash    (void);
+		bool          getFileStatus     (time_t& mtime, off_t& size);
+
+	private:
+		// m_filename: The file which is stored in the entry.
+		std::string m_filename;
+
+		// m_file: The parsed file.
+		HumdrumFile m_file;
+
+		// m_mutex: Lock which must be held while using m_file.
+		std::mutex m_mutex;
+
+		// m_loaded: True if the file was read successfully.
+		bool m_loaded = false;
+
+		// m_hash: Hash of the line contents after parsing, which is used
+		// to check if the file was changed by a tool.
+		size_t m_hash = 0;
+
+		// m_mtime, m_size: The modification time and size of the file
+		// when it was read, which are used to check if the file was
+		// changed on disk.
+		time_t m_mtime = 0;
+		off_t m_size = -1;
+
+		// m_parsecount: The number of times the file has been parsed.
+		int m_parsecount = 0;
+};
+
+
+class HumScoreCache {
+	public:
+		              HumScoreCache     (int maxfiles = 1000);
+		             ~HumScoreCache     ();
+
+		std::shared_ptr<HumScoreEntry> getScore(const std::string& filename);
+		void          clear             (void);
+		void          setMaxFiles       (int maxfiles);
+		int           getMaxFiles       (void);
+		int           getCount          (void);
+		std::ostream& printStatistics   (std::ostream& out);
+
+	protected:
+		void          trim              (void);
+
+	private:
+		typedef std::list<std::shared_ptr<HumScoreEntry>> EntryList;
+
+		// m_mutex: Lock for the list and index.
+		std::mutex m_mutex;
+
+		// m_maxfiles: The maximum number of files to keep in memory.
+		int m_maxfiles;
+
+		// m_entries: The stored files, with the most-recently used first.
+		EntryList m_entries;
+
+		// m_index: Mapping from a filename to its position in m_entries.
+		std::unordered_map<std::string, EntryList::iterator> m_index;
+
+		// m_hits, m_misses: Number of requests for files which were
+		// or were not already in the cache.
+		size_t m_hits = 0;
+		size_t m_misses = 0;
+};
+
+
+
+class HumKeyFinder {
+	public:
+		              HumKeyFinder        (void);
+		             ~HumKeyFinder        ();
+
+		bool          setProfile          (const std::string& name);
+		void          setProfile          (const std::vector<double>& major,
+		                                   const std::vector<double>& minor);
+		void          setHistograms       (const std::vector<std::vector<double>>& segments);
+		int           getSegmentCount     (void) const;
+		void          getWindowHistogram  (int start, int length,
+		                                   std::vector<double>& histogram) const;
+		int           analyzeHistogram    (const std::vector<double>& histogram,
+		                                   std::vector<double>& correls) const;
+		int           analyzeWindow       (int start, int length,
+		                                   std::vector<double>& correls) const;
+		void          analyzeWindows      (int length, int hop, int count,
+		                                   std::vector<std::vector<double>>& output) const;
+
+		static void   getTrackHistograms  (HumdrumFile& infile, int segments,
+		                                   std::vector<std::vector<std::vector<double>>>& histograms);
+
+	protected:
+		static void   addToHistogram      (std::vector<std::vector<double>>& histogram,
+		                                   int pc, double start, double duration,
+		                                   double totalduration);
+
+	private:
+		// m_kernels: The major (0-11) and minor (12-23) key profiles for each
+		// tonic, shifted to a mean of zero and scaled to a length of one, so
+		// that the correlation with a histogram is a dot product.
+		double m_kernels[24][12];
+
+		// m_prefix: Running sums of the segment histograms: entries 12*i to
+		// 12*i+11 are the sums of segments 0 to i-1.
+		std::vector<double> m_prefix;
+};
+
+
+
 #define GRIDREST NAN
 
 class NoteGrid;
@@ -2455,6 +3316,7 @@ class NoteGrid;
 class NoteCell {
 	public:
 		       NoteCell             (NoteGrid* owner, HTp token);
+		       NoteCell             (NoteGrid* owner, HTp token, int b40);
 		      ~NoteCell             (void) { clear();                    }
 
 		double getSgnDiatonicPitch  (void) { return m_b7;                }
@@ -2507,6 +3369,7 @@ class NoteCell {
 	protected:
 		void clear                  (void);
 		void calculateNumericPitches(void);
+		void setNumericPitches      (int b40);
 		void setVoiceIndex          (int index) { m_voice = index;           }
 		void setSliceIndex          (int index) { m_timeslice = index;       }
 		void setNextAttackIndex     (int index) { m_nextAttackIndex = index; }
@@ -2628,41 +3491,86 @@ class Convert {
 		static std::string  base40ToIntervalAbbr (int b40);
 		static int     kernToOctaveNumber   (const std::string& kerndata);
 		static int     kernToOctaveNumber   (HTp token)
-				{ return kernToOctaveNumber((std::string)*token); }
+				{ return kernToOctaveNumber(*token); }
 		static int     kernToAccidentalCount(const std::string& kerndata);
 		static int     kernToAccidentalCount(HTp token)
-				{ return kernToAccidentalCount((std::string)*token); }
+				{ return kernToAccidentalCount(*token); }
 		static int     kernToDiatonicPC     (const std::string& kerndata);
 		static int     kernToDiatonicPC     (HTp token)
-				{ return kernToDiatonicPC     ((std::string)*token); }
+				{ return kernToDiatonicPC     (*token); }
 		static char    kernToDiatonicUC     (const std::string& kerndata);
 		static int     kernToDiatonicUC     (HTp token)
-				{ return kernToDiatonicUC     ((std::string)*token); }
+				{ return kernToDiatonicUC     (*token); }
 		static char    kernToDiatonicLC     (const std::string& kerndata);
 		static int     kernToDiatonicLC     (HTp token)
-				{ return kernToDiatonicLC     ((std::string)*token); }
+				{ return kernToDiatonicLC     (*token); }
 		static int     kernToBase40PC       (const std::string& kerndata);
 		static int     kernToBase40PC       (HTp token)
-				{ return kernToBase40PC       ((std::string)*token); }
+				{ return kernToBase40PC       (*token); }
 		static int     kernToBase12PC       (const std::string& kerndata);
 		static int     kernToBase12PC       (HTp token)
-				{ return kernToBase12PC       ((std::string)*token); }
+				{ return kernToBase12PC       (*token); }
 		static int     kernToBase7PC        (const std::string& kerndata) {
 		                                     return kernToDiatonicPC(kerndata); }
 		static int     kernToBase7PC        (HTp token)
-				{ return kernToBase7PC        ((std::string)*token); }
+				{ return kernToBase7PC        (*token); }
 		static int     kernToBase40         (const std::string& kerndata);
 		static int     kernToBase40         (HTp token)
-				{ return kernToBase40         ((std::string)*token); }
+				{ return kernToBase40         (*token); }
 		static int     kernToBase12         (const std::string& kerndata);
 		static int     kernToBase12         (HTp token)
-				{ return kernToBase12         ((std::string)*token); }
+				{ return kernToBase12         (*token); }
 		static int     kernToBase7          (const std::string& kerndata);
 		static int     kernToBase7          (HTp token)
-				{ return kernToBase7          ((std::string)*token); }
+				{ return kernToBase7          (*token); }
 		static int     kernToMidiNoteNumber (const std::string& kerndata);
 		static int     kernToMidiNoteNumber(HTp token)
-				{ return kernToMidiNoteNumber((std::string)*token); }
+				{ return kernToMidiNoteNumber(*token); }
+		static void    kernToPitchParts     (const char* kerndata, size_t size,
+		                                     int& diatonic, int& accidental,
+		                                     int& octave);
+		static int     pitchPartsToBase40   (int diatonic, int accidental,
+		                                     int octave);
+		static int     pitchPartsToBase12   (int diatonic, int accidental,
+		                                     int octave);
+		static int     pitchPartsToBase7    (int diatonic, int octave);
+
+		// Batch pitch processing, defined in Convert-pitch.cpp
+		static void    kernToPitchNumbers   (const std::vector<std::string>& tokens,
+		                                     std::vector<int>* base40,
+		                                     std::vector<int>* base12 = NULL,
+		                                     std::vector<int>* base7 = NULL,
+		                                     std::vector<int>* midi = NULL);
+		static void    kernToPitchNumbers   (const std::vector<HTp>& tokens,
+		                                     std::vector<int>* base40,
+		                                     std::vector<int>* base12 = NULL,
+		                                     std::vector<int>* base7 = NULL,
+		                                     std::vector<int>* midi = NULL);
+		static void    kernToBase40         (const std::vector<std::string>& tokens,
+		                                     std::vector<int>& output)
+				{ kernToPitchNumbers(tokens, &output); }
+		static void    kernToBase40         (const std::vector<HTp>& tokens,
+		                                     std::vector<int>& output)
+				{ kernToPitchNumbers(tokens, &output); }
+		static void    kernToBase12         (const std::vector<std::string>& tokens,
+		                                     std::vector<int>& output)
+				{ kernToPitchNumbers(tokens, NULL, &output); }
+		static void    kernToBase7          (const std::vector<std::string>& tokens,
+		                                     std::vector<int>& output)
+				{ kernToPitchNumbers(tokens, NULL, NULL, &output); }
+		static void    kernToMidiNoteNumber (const std::vector<std::string>& tokens,
+		                                     std::vector<int>& output)
+				{ kernToPitchNumbers(tokens, NULL, NULL, NULL, &output); }
+		static void    kernToMidiNoteNumber (const std::vector<HTp>& tokens,
+		                                     std::vector<int>& output)
+				{ kernToPitchNumbers(tokens, NULL, NULL, NULL, &output); }
+		// private function for kernToPitchNumbers:
+		static void    storePitchNumbers    (int index, const char* kerndata,
+		                                     size_t size, std::vector<int>* base40,
+		                                     std::vector<int>* base12,
+		                                     std::vector<int>* base7,
+		                                     std::vector<int>* midi);
+
 		static std::string  kernToScientificPitch(const std::string& kerndata,
 		                                     std::string flat = "b",
 		                                     std::string sharp = "#",
@@ -2857,6 +3765,9 @@ class MxmlPart {
 		int           setQTicks            (long value);
 	   MxmlMeasure*  getPreviousMeasure   (MxmlMeasure* measure) const;
 		HumNum        getDuration          (void) const;
+		int           getMinimumTimelineTpq(void) const;
+		int           getTimelineTpq       (void) const;
+		void          setTimelineTpq       (int tpq);
 		void          allocateSortedEvents (void);
 		void          setPartNumber        (int number);
 		int           getPartNumber        (void) const;
@@ -2908,6 +3819,10 @@ class MxmlPart {
 		string               m_caesura;
 		bool                 m_hasOrnaments = false;
 
+		// m_timelinetpq: ticks per quarter note for the integer timeline
+		// used to sort and align events (0 if not yet set).
+		int                  m_timelinetpq = 0;
+
 		// m_staffvoicehist: counts of staff and voice numbers.
 		// staff=0 is used for items such as measures.
 		// voice=0 is used for nonduration items such as harmony.
@@ -2963,6 +3878,11 @@ class GridStaff : public std::vector<GridVoice*>, public GridSide {
 	public:
 		GridStaff(void);
 		~GridStaff();
+
+		static void* operator new(size_t size)
+		                    { return HumPool<GridStaff>::allocate(size); }
+		static void  operator delete(void* ptr, size_t size)
+		                    { HumPool<GridStaff>::release(ptr, size); }
 		GridVoice* setTokenLayer (int layerindex, HTp token, HumNum duration);
 		void setNullTokenLayer   (int layerindex, SliceType type, HumNum nextdur);
 		void appendTokenLayer    (int layerindex, HTp token, HumNum duration,
@@ -2979,6 +3899,11 @@ class GridPart : public std::vector<GridStaff*>, public GridSide {
 	public:
 		GridPart(void);
 		~GridPart();
+
+		static void* operator new(size_t size)
+		                    { return HumPool<GridPart>::allocate(size); }
+		static void  operator delete(void* ptr, size_t size)
+		                    { HumPool<GridPart>::release(ptr, size); }
 };
 
 std::ostream& operator<<(std::ostream& output, GridPart* part);
@@ -3083,6 +4008,11 @@ class GridSlice : public std::vector<GridPart*> {
 		          GridSlice* slice);
 		~GridSlice();
 
+		static void* operator new(size_t size)
+		                    { return HumPool<GridSlice>::allocate(size); }
+		static void  operator delete(void* ptr, size_t size)
+		                    { HumPool<GridSlice>::release(ptr, size); }
+
 		bool isNoteSlice(void)          { return m_type == SliceType::Notes;            }
 		bool isGraceSlice(void)         { return m_type == SliceType::GraceNotes;       }
 		bool isMeasureSlice(void)       { return m_type == SliceType::Measures;         }
@@ -3162,6 +4092,11 @@ class GridVoice {
 		GridVoice(const std::string& token, HumNum duration);
 		~GridVoice();
 
+		static void* operator new(size_t size)
+		                    { return HumPool<GridVoice>::allocate(size); }
+		static void  operator delete(void* ptr, size_t size)
+		                    { HumPool<GridVoice>::release(ptr, size); }
+
 		bool   isTransfered       (void);
 
 		HTp    getToken           (void) const;
@@ -3200,6 +4135,7 @@ class HumGrid : public std::vector<GridMeasure*> {
 	public:
 		HumGrid(void);
 		~HumGrid();
+		void clear                      (void);
 		void enableRecipSpine           (void);
 		bool transferTokens             (HumdrumFile& outfile, int startbarnum = 0);
 		int  getHarmonyCount            (int partindex);
@@ -3220,6 +4156,7 @@ class HumGrid : public std::vector<GridMeasure*> {
 		int  getPartCount               (void);
 		int  getStaffCount              (int partindex);
 		void deleteMeasure              (int index);
+		static bool freePoolMemory      (void);
 
 	protected:
 		void calculateGridDurations        (void);
@@ -3337,8 +4274,10 @@ class MxmlEvent {
 		bool               parseEvent         (xml_node el, xml_node nextel,
 		                                       HumNum starttime);
 		bool               parseEvent         (xpath_node el, HumNum starttime);
-		void               setTickStart       (long value, long ticks);
-		void               setTickDur         (long value, long ticks);
+		void               setTickTimeline    (int tpq);
+		long               getTickStart       (void) const;
+		long               getTickDuration    (void) const;
+		static long        timeToTicks        (HumNum value, int tpq);
 		void               setStartTime       (HumNum value);
 		void               setDuration        (HumNum value);
 		void               setDurationByTicks (long value,
@@ -3416,6 +4355,8 @@ class MxmlEvent {
 	protected:
 		HumNum             m_starttime;  // start time in quarter notes of event
 		HumNum             m_duration;   // duration in quarter notes of event
+		long               m_tickstart = 0; // start time in part timeline ticks
+		long               m_tickdur = 0;   // duration in part timeline ticks
 		measure_event_type m_eventtype;  // enumeration type of event
 		xml_node           m_node;       // pointer to event in XML structure
 		MxmlMeasure*       m_owner;      // measure that contains this event
@@ -3465,6 +4406,7 @@ class SimultaneousEvents {
 		SimultaneousEvents(void) { }
 		~SimultaneousEvents() { }
 		HumNum starttime;              // start time of events
+		long tickstart = 0;            // start time in part timeline ticks
 		HumNum duration;               // duration to next non-zero duration
 		vector<MxmlEvent*> zerodur;    // zero-duration elements at this time
 		vector<MxmlEvent*> nonzerodur; // non-zero dur elements at this time
@@ -3494,6 +4436,10 @@ class MxmlMeasure {
 		void          attachLastEventToPrevious  (void);
 		void          calculateDuration  (void);
 		int           getEventCount      (void) const;
+		void          setTickTimeline    (int tpq);
+		long          getTickStart       (void) const;
+		long          getTickDuration    (void) const;
+		int           getTimelineTpq     (void) const;
 		vector<SimultaneousEvents>* getSortedEvents(void);
 		MxmlEvent*    getEvent           (int index) const;
 
@@ -3524,6 +4470,7 @@ class MxmlMeasure {
 		bool  isRepeatBoth(void)       { return m_style == MeasureStyle::RepeatBoth; }
 
 	private:
+		SimultaneousEvents* getSortedEventsAtTick (long tick);
 		void  receiveStaffNumberFromChild         (int staffnum, int voicenum);
 		void  receiveTimeSigDurFromChild          (HumNum duration);
 		void  receiveMeasureStyleFromChild        (MeasureStyle style);
@@ -3542,6 +4489,8 @@ class MxmlMeasure {
 	protected:
 		HumNum             m_starttime; // start time of measure in quarter notes
 		HumNum             m_duration;  // duration of measure in quarter notes
+		long               m_tickstart = 0; // start time in part timeline ticks
+		long               m_tickdur = 0;   // duration in part timeline ticks
 		HumNum             m_timesigdur; // duration of measure according to
 													// prevailing time signature.
 		MxmlPart*          m_owner;     // part which contains measure
@@ -3596,6 +4545,52 @@ class Option_register {
 };
 
 
+//
+// Option_value -- The state of an option in an Options object.  Numeric
+// versions of the value are calculated when the option is set, so that
+// typed access does not have to parse the string each time.
+//
+
+class Option_value {
+	public:
+		string   text;               // modified option string
+		bool     modifiedQ = false;  // true if set on the command-line
+		int      intValue = 0;       // value of string as an integer
+		double   doubleValue = 0.0;  // value of string as a double
+
+		void     set                 (const string& aString);
+};
+
+
+//
+// Option_definitions -- A list of option definitions which is shared by
+// all Options objects which defined the same options in the same order
+// (such as all instances of a tool class).  Each list is never changed
+// after it is created: defining another option moves to a list which
+// contains one more option, created the first time that the option
+// is defined after the current list and then stored in m_next for reuse.
+//
+
+class Option_definitions {
+	public:
+		// m_registers: the definitions and default values of the options.
+		vector<Option_register> m_registers;
+
+		// m_defaults: the default values of the options.
+		vector<Option_value> m_defaults;
+
+		// m_names: mapping from option names/aliases to register index.
+		unordered_map<string, int> m_names;
+
+		// m_next: lists with one more definition, indexed by definition
+		// (and description) strings.
+		map<string, std::shared_ptr<Option_definitions>> m_next;
+
+		static std::shared_ptr<Option_definitions> getEmpty(void);
+		static mutex& getMutex(void);
+};
+
+
 class Options {
 	public:
 		                Options           (void);
@@ -3616,16 +4611,22 @@ class Options {
 		vector<string>& getArgList        (vector<string>& output);
 		vector<string>& getArgumentList   (vector<string>& output);
 		bool            getBoolean        (const string& optionName);
+		bool            getBoolean        (int index);
 		string          getCommand        (void);
 		string          getCommandLine    (void);
 		string          getDefinition     (const string& optionName);
 		double          getDouble         (const string& optionName);
+		double          getDouble         (int index);
 		char            getFlag           (void);
 		char            getChar           (const string& optionName);
 		float           getFloat          (const string& optionName);
 		int             getInt            (const string& optionName);
+		int             getInt            (int index);
 		int             getInteger        (const string& optionName);
+		int             getInteger        (int index);
 		string          getString         (const string& optionName);
+		string          getString         (int index);
+		int             getIndex          (const string& optionName);
 		char            getType           (const string& optionName);
 		int             optionsArg        (void);
 		ostream&        print             (ostream& out);
@@ -3649,6 +4650,8 @@ class Options {
 		void            setFlag           (char aFlag);
 		void            setModified       (const string& optionName,
 		                                   const string& optionValue);
+		void            setModified       (int index,
+		                                   const string& optionValue);
 		void            setOptions        (int argc, char** argv);
 		void            setOptions        (const vector<string>& argv);
 		void            setOptions        (const string& args);
@@ -3671,16 +4674,17 @@ class Options {
 		// are not options, or the command (argv[0]);
 		vector<string> m_arguments;
 
-		// m_optionRegister: store for the states/values of each option.
-		vector<Option_register*> m_optionRegister;
+		// m_definitions: the option definitions, shared with other
+		// Options objects that have the same definitions.
+		std::shared_ptr<Option_definitions> m_definitions;
+
+		// m_values: store for the states/values of each option.
+		vector<Option_value> m_values;
 
 		// m_optionFlag: the character which indicates an option.
 		// Generally a dash, but could be made a slash for Windows environments.
 		char m_optionFlag = '-';
 
-		// m_optionList:
-		map<string, int> m_optionList;
-
 		//
 		// boolern options for object:
 		//
@@ -3704,6 +4708,8 @@ class Options {
 		stringstream m_error;
 
 	private:
+		int     defineOption   (const string& aDefinition,
+		                        const string& aDescription);
 		int     getRegIndex    (const string& optionName);
 		bool    isOption       (const string& aString, int& argp);
 		int     storeOption    (int gargp, int& position, int& running);
@@ -3735,6 +4741,12 @@ class HumTool : public Options {
 		ostream&      getHumdrumText  (ostream& out);
 		void          suppressHumdrumFileOutput(void);
 
+		bool          setHumdrumOutput (std::ostream& out);
+		bool          setHumdrumOutput (int fd);
+		bool          setHumdrumOutput (const HumOutputSink::Writer& writer);
+		void          clearHumdrumOutput(void);
+		bool          isStreamingHumdrum(void);
+
 		bool          hasJsonText     (void);
 		std::string   getJsonText     (void);
 		ostream&      getJsonText     (ostream& out);
@@ -3752,6 +4764,7 @@ class HumTool : public Options {
 		ostream&      getError        (ostream& out);
 
 	protected:
+		HumOutputSink     m_humdrum_sink;  // direct output of Humdrum text.
 		std::stringstream m_humdrum_text;  // output text in Humdrum syntax.
 		std::stringstream m_json_text;     // output text in JSON syntax.
 		std::stringstream m_free_text;     // output for plain text content.
@@ -3760,6 +4773,11 @@ class HumTool : public Options {
 
 		bool m_suppress = false;
 
+		// m_buffer_humdrum: Set to true in tools which need to read back
+		// the contents of m_humdrum_text, so that it is never streamed
+		// directly to the output.
+		bool m_buffer_humdrum = false;
+
 };
 
 
@@ -3767,6 +4785,10 @@ class HumTool : public Options {
 //
 // common command-line Interfaces
 //
+// The stream and set interfaces send Humdrum text directly to standard
+// output while the tool is running (see HumTool::setHumdrumOutput()),
+// except for tools which must read back their own output.
+//
 
 //////////////////////////////
 //
@@ -3823,6 +4845,7 @@ int main(int argc, char** argv) {                                \
 		interface.getError(cerr);                                  \
 		return -1;                                                 \
 	}                                                             \
+	interface.setHumdrumOutput(cout);                             \
 	HumdrumFileStream instream(static_cast<Options&>(interface)); \
 	HumdrumFileSet infiles;                                       \
 	bool status = true;                                           \
@@ -3866,6 +4889,7 @@ int main(int argc, char** argv) {                                \
 		interface.getError(cerr);                                  \
 		return -1;                                                 \
 	}                                                             \
+	interface.setHumdrumOutput(cout);                             \
 	HumdrumFileStream instream(static_cast<Options&>(interface)); \
 	bool status = interface.run(instream);                        \
 	if (interface.hasWarning()) {                                 \
@@ -3884,10 +4908,74 @@ int main(int argc, char** argv) {                                \
 
 
 
+//////////////////////////////
+//
+// LINE_STREAM_INTERFACE -- Send a HumdrumLineStream to the filter so
+//    that it can process the input one line at a time, if the filter
+//    can do so with the given options.  Otherwise the input is read
+//    one segment at a time as in STREAM_INTERFACE.
+//
+// functions that the interface must implement:
+//  .isLineStreamable(void)
+//  .run(HumdrumLineStream& instream)
+//
+
+#define LINE_STREAM_INTERFACE(CLASS)                             \
+using namespace std;                                             \
+using namespace hum;                                             \
+int main(int argc, char** argv) {                                \
+	CLASS interface;                                              \
+	if (!interface.process(argc, argv)) {                         \
+		interface.getError(cerr);                                  \
+		return -1;                                                 \
+	}                                                             \
+	interface.setHumdrumOutput(cout);                             \
+	HumdrumLineStream instream(static_cast<Options&>(interface)); \
+	bool status = true;                                           \
+	if (interface.isLineStreamable()) {                           \
+		status = interface.run(instream);                          \
+		if (interface.hasWarning()) {                              \
+			interface.getWarning(cerr);                             \
+		}                                                          \
+		if (interface.hasAnyText()) {                              \
+		   interface.getAllText(cout);                             \
+		}                                                          \
+		if (interface.hasError()) {                                \
+			interface.getError(cerr);                               \
+			return -1;                                              \
+		}                                                          \
+		interface.clearOutput();                                   \
+		return !status;                                            \
+	}                                                             \
+	HumdrumFileSet infiles;                                       \
+	while (instream.readSingleSegment(infiles)) {                 \
+		status &= interface.run(infiles);                          \
+		if (interface.hasWarning()) {                              \
+			interface.getWarning(cerr);                             \
+		}                                                          \
+		if (interface.hasAnyText()) {                              \
+		   interface.getAllText(cout);                             \
+		}                                                          \
+		if (interface.hasError()) {                                \
+			interface.getError(cerr);                               \
+			return -1;                                              \
+		}                                                          \
+		if (!interface.hasAnyText()) {                             \
+			for (int i=0; i<infiles.getCount(); i++) {              \
+				cout << infiles[i];                                  \
+			}                                                       \
+		}                                                          \
+		interface.clearOutput();                                   \
+	}                                                             \
+	return !status;                                               \
+}
+
+
+
 //////////////////////////////
 //
 // SET_INTERFACE -- Use HumdrumFileSet (multiple file high-memory
-//    usage implementation).
+//    usage implementation).  The input files are parsed in parallel.
 //
 
 #define SET_INTERFACE(CLASS)                                     \
@@ -3899,9 +4987,10 @@ int main(int argc, char** argv) {                                \
 		interface.getError(cerr);                                  \
 		return -1;                                                 \
 	}                                                             \
+	interface.setHumdrumOutput(cout);                             \
 	HumdrumFileStream instream(static_cast<Options&>(interface)); \
 	HumdrumFileSet infiles;                                       \
-	instream.read(infiles);                                       \
+	infiles.readParallel(instream);                               \
 	bool status = interface.run(infiles);                         \
 	if (interface.hasWarning()) {                                 \
 		interface.getWarning(cerr);                                \
@@ -3943,11 +5032,17 @@ class HumdrumFileStream {
 		int             eof                (void);
 
 		int             getFile            (HumdrumFile& infile);
+		int             getFileContents    (std::stringstream& contents,
+		                                    HumdrumFile& infile);
 		int             read               (HumdrumFile& infile);
 		int             read               (HumdrumFileSet& infiles);
 		int             readSingleSegment  (HumdrumFileSet& infiles);
 
 	protected:
+		bool            startSegment       (void);
+		bool            readSegmentLine    (std::string& text);
+		void            storeSegmentName   (const std::string& line);
+
 		std::stringstream m_stringbuffer;   // used to read files from a string
 		std::ifstream     m_instream;       // used to read from list of files
 		std::stringstream m_urlbuffer;      // used to read data over internet
@@ -3959,6 +5054,29 @@ class HumdrumFileStream {
 
 		std::vector<std::string>  m_universals;     // storage for universal comments
 
+		// Segment reading state (see startSegment() and readSegmentLine()):
+		std::istream* m_input = NULL;        // input of the current segment
+		bool m_dataFoundQ      = false;      // non-universal line found in segment
+		bool m_starstarFoundQ  = false;      // exclusive interpretation found
+		bool m_starminusFoundQ = false;      // spine terminator found
+		bool m_universalQ      = false;      // universal comment found in segment
+		bool m_addedFilenameQ  = false;      // filename added to the input list
+
+		// m_queue: Lines to return before reading more input: the
+		// universal comments (demoted to global comments) and the held
+		// exclusive interpretation line at the start of a segment.
+		std::vector<std::string> m_queue;
+		int m_queueindex = 0;
+
+		// m_heldline: exclusive interpretation line which started the
+		// current segment, stored until the universal comments are known.
+		std::string m_heldline;
+
+		// m_filename, m_segmentlevel: The name and !!!!SEGMENT level of
+		// the current segment.
+		std::string m_filename;
+		int m_segmentlevel = 0;
+
 		// Automatic URL downloading of data from internet in read():
 		void     fillUrlBuffer            (std::stringstream& uribuffer,
 		                                   const std::string& uriname);
@@ -3993,6 +5111,8 @@ class HumdrumFileSet {
       int                   read             (std::istream& inStream);
       int                   read             (Options& options);
       int                   read             (HumdrumFileStream& instream);
+      int                   readParallel     (HumdrumFileStream& instream,
+                                              int threads = 0);
 
       int                   readAppendFile   (const std::string& filename);
       int                   readAppendString (const std::string& contents);
@@ -4000,6 +5120,8 @@ class HumdrumFileSet {
       int                   readAppend       (std::istream& inStream);
       int                   readAppend       (Options& options);
       int                   readAppend       (HumdrumFileStream& instream);
+      int                   readAppendParallel(HumdrumFileStream& instream,
+                                              int threads = 0);
       int                   readAppendHumdrum(HumdrumFile& infile);
 		int                   appendHumdrumPointer(HumdrumFile* infile);
 
@@ -4012,6 +5134,62 @@ class HumdrumFileSet {
 
 
 
+class HumdrumLineStream : public HumdrumFileStream {
+	public:
+		                HumdrumLineStream  (void);
+		                HumdrumLineStream  (char** list);
+		                HumdrumLineStream  (const std::vector<std::string>& list);
+		                HumdrumLineStream  (Options& options);
+		                HumdrumLineStream  (const std::string& datastream);
+		               ~HumdrumLineStream  ();
+
+		HLp             getLine            (void);
+		bool            process            (const std::function<void(HumdrumLine&)>& event);
+
+		const std::string& getDataType     (int index) const;
+		int             getMaxTrack        (void) const;
+		const std::string& getFilename     (void) const;
+		int             getSegmentLevel    (void) const;
+
+		bool            hasError           (void) const;
+		const std::string& getError        (void) const;
+
+	protected:
+		bool            getText            (std::string& text);
+		void            resetSpines        (void);
+		bool            analyzeSpines      (void);
+		bool            adjustSpines       (void);
+		bool            setError           (const std::string& message);
+
+	private:
+		// m_line: The current line, which is reused for each line.
+		HumdrumLine m_line;
+
+		// m_lineindex: The index of the current line in its segment.
+		int m_lineindex = -1;
+
+		// m_doneQ: No more segments to read.
+		bool m_doneQ = false;
+
+		// Spine state for the current line: the exclusive interpretation,
+		// the spine info and its interned ID for each field.
+		std::vector<std::string> m_datatypes;
+		std::vector<std::string> m_spineinfo;
+		std::vector<int>         m_spineids;
+
+		// Spine state after the current line (if it is a manipulator).
+		std::vector<std::string> m_nexttypes;
+		std::vector<std::string> m_nextinfo;
+		bool m_adjustQ = false;
+
+		// m_maxtrack: The highest track number in the current segment.
+		int m_maxtrack = 0;
+
+		std::string m_error;
+};
+
+
+
 
 class Tool_autobeam : public HumTool {
 	public:
@@ -4138,16 +5316,39 @@ class Tool_binroll : public HumTool {
 		bool     run               (HumdrumFile& infile);
 		bool     run               (const string& indata, ostream& out);
 		bool     run               (HumdrumFile& infile, ostream& out);
+		bool     run               (HumdrumFileStream& instream, ostream& out);
 
 	protected:
-		void     processFile       (HumdrumFile& infile);
-		void     processStrand     (vector<vector<char>>& roll, HTp starting,
-		                            HTp ending);
-		void     printAnalysis     (HumdrumFile& infile,
-		                            vector<vector<char>>& roll);
+		bool     initialize        (void);
+		void     processFile       (HumdrumFile& infile, ostream& out);
+		void     fillRoll          (HumdrumFile& infile);
+		void     processStrand     (HTp starting, HTp ending);
+		void     setCell           (int pitch, int index, int value);
+		int      getCell           (int pitch, int index) const;
+		void     printRoll         (ostream& out);
+		void     printRollData     (ostream& out);
+		void     printTextRoll     (ostream& out);
+		void     printBitplanes    (ostream& out);
+		void     printNpyRoll      (ostream& out);
+		void     printNpyHeader    (ostream& out, int64_t slicecount);
+		void     printComments     (HumdrumFile& infile, int startline,
+		                            int endline, ostream& out);
+		void     printAnalysis     (HumdrumFile& infile, ostream& out);
 
 	private:
 		HumNum    m_duration;
+		string    m_format;
+
+		// m_slicecount: The number of time slices in the current roll.
+		int       m_slicecount = 0;
+
+		// m_sounding, m_attacks: Bit-packed piano roll, with two 64-bit
+		// words (MIDI keys 0-63 and 64-127) for each time slice.  A cell
+		// with the m_attacks bit set is a note attack (2 in text output),
+		// and a cell with only the m_sounding bit set is a sustained note
+		// (1 in text output).
+		vector<uint64_t> m_sounding;
+		vector<uint64_t> m_attacks;
 
 };
 
@@ -4242,6 +5443,7 @@ class Tool_cint : public HumTool {
 		bool     run                    (HumdrumFile& infile);
 		bool     run                    (const string& indata, ostream& out);
 		bool     run                    (HumdrumFile& infile, ostream& out);
+		bool     lookupModuleIndex      (ostream& out);
 
 	protected:
 
@@ -4314,7 +5516,8 @@ class Tool_cint : public HumTool {
 		                                vector<vector<NoteNode> >& notes,
 		                                int n, int startline, int part1, int part2,
 		                                vector<vector<string> >& retrospective,
-		                                char& notemarker, int markstate = 0);
+		                                char& notemarker, int markstate = 0,
+		                                vector<int>* key = NULL);
 		int       printCombinationModulePrepare(ostream& out, const string& filename,
 		                                vector<vector<NoteNode> >& notes, int n,
 		                                int startline, int part1, int part2,
@@ -4332,6 +5535,25 @@ class Tool_cint : public HumTool {
 		int       getTriangleIndex(int number, int num1, int num2);
 		void      adjustKTracks        (vector<int>& ktracks, const string& koption);
 		int       getMeasure           (HumdrumFile& infile, int line);
+		int       getIntervalNumber    (NoteNode& note1, NoteNode& note2,
+		                                int type, int octaveadjust = 0);
+		void      addIntervalToKey     (vector<int>& key, NoteNode& note1,
+		                                NoteNode& note2, int type,
+		                                int octaveadjust = 0);
+		void      prepareNoteArray     (vector<vector<NoteNode> >& notes,
+		                                HumdrumFile& infile, vector<int>& ktracks,
+		                                vector<int>& reverselookup);
+		bool      buildModuleIndex     (HumdrumFileSet& infiles,
+		                                const string& filename);
+		void      extractModuleKeys    (vector<pair<vector<int>, string> >& entries,
+		                                HumdrumFile& infile,
+		                                vector<vector<NoteNode> >& notes,
+		                                int fileindex, int part1, int part2);
+		string    getModuleIndexSignature(void);
+		std::streamoff getModuleIndexOffset(istream& input, std::streamoff table,
+		                                std::streamoff record);
+		string    getModuleKeyString   (const vector<int>& key);
+		bool      parseModuleQuery     (vector<int>& key, const string& query);
 
 	private:
 
@@ -4376,11 +5598,17 @@ class Tool_cint : public HumTool {
 		int       uncrossQ     = 0;      // used with -c option
 		int       retroQ       = 0;      // used with --retro option
 		int       idQ          = 0;      // used with --id option
-		vector<string> Ids;              // used with --id option
 		char      NoteMarker   = '\0';   // used with -N option
 		string    SearchString;
 		string Spacer;
 
+		// Module index offset table (see buildModuleIndex()): each record
+		// is a zero-padded byte offset of m_offsetwidth digits and a
+		// newline, and the last line of the index is m_tablemarker
+		// followed by the offset of the table in the same format.
+		static const int m_offsetwidth = 20;
+		const string m_tablemarker = "!!!cint-table: ";
+
 };
 
 
@@ -4413,50 +5641,59 @@ class Tool_dissonant : public HumTool {
 		bool     run               (HumdrumFile& infile);
 		bool     run               (const string& indata, ostream& out);
 		bool     run               (HumdrumFile& infile, ostream& out);
+		bool     run               (HumdrumFileStream& instream);
+		bool     printCountAnalysisForFiles(HumdrumFileSet& infiles);
 
 	protected:
-		void    doAnalysis         (vector<vector<string> >& results,
+		bool    analyzeFiles       (HumdrumFileSet& infiles, bool countQ,
+		                            bool filenameQ);
+		void    doAnalysis         (vector<vector<int> >& results,
 		                            NoteGrid& grid,
 		                            vector<vector<NoteCell*> >& attacks,
 		                            bool debug);
-		void    doAnalysisForVoice (vector<vector<string> >& results,
+		void    doAnalysisForVoice (vector<vector<int> >& results,
 		                            NoteGrid& grid,
 		                            vector<NoteCell*>& attacks,
 		                            int vindex, bool debug);
-		void    findFakeSuspensions(vector<vector<string> >& results,
+		void    findFakeSuspensions(vector<vector<int> >& results,
 		                            NoteGrid& grid,
 		                            vector<NoteCell*>& attacks, int vindex);
-		void    findAppoggiaturas  (vector<vector<string> >& results,
+		void    findAppoggiaturas  (vector<vector<int> >& results,
 		                            NoteGrid& grid,
 		                            vector<NoteCell*>& attacks, int vindex);
-		void    findLs             (vector<vector<string> >& results,
+		void    findLs             (vector<vector<int> >& results,
 		                            NoteGrid& grid,
 		                            vector<NoteCell*>& attacks, int vindex);
-		void    findYs             (vector<vector<string> >& results,
+		void    findYs             (vector<vector<int> >& results,
 		                            NoteGrid& grid,
 		                            vector<NoteCell*>& attacks, int vindex);
-		void    findCadentialVoiceFunctions(vector<vector<string> >& results,
+		void    findCadentialVoiceFunctions(vector<vector<int> >& results,
 		                            NoteGrid& grid, vector<NoteCell*>& attacks,
 		                            vector<vector<string> >& voiceFuncs,
 		                            int vindex);
 
 		void    printColorLegend   (HumdrumFile& infile);
+		bool    printAnalysis      (HumdrumFile& infile,
+		                            vector<vector<string> >& data);
 		int     getNextPitchAttackIndex(NoteGrid& grid, int voicei,
 		                            int sliceindex);
 		void    fillLabels         (void);
 		void    fillLabels2        (void);
-		void    printCountAnalysis (vector<vector<string> >& data);
+		void    fillLabelCodes     (void);
+		void    getLabelStrings    (vector<vector<string> >& labels,
+		                            vector<vector<int> >& results);
+		void    printCountAnalysis (vector<vector<int> >& data);
 		void    suppressDissonances(HumdrumFile& infile, NoteGrid& grid,
 		                            vector<vector<NoteCell* > >& attacks,
-		                            vector<vector<string> >& results);
+		                            vector<vector<int> >& results);
 		void    suppressDissonancesInVoice(HumdrumFile& infile,
 		                            NoteGrid& grid, int vindex,
 		                            vector<NoteCell*>& attacks,
-		                            vector<string>& results);
+		                            vector<int>& results);
 		void    suppressSusOrnamentsInVoice(HumdrumFile& infile,
 		                            NoteGrid& grid, int vindex,
 		                            vector<NoteCell*>& attacks,
-		                            vector<string>& results);
+		                            vector<int>& results);
 		void    mergeWithPreviousNote(HumdrumFile& infile, int line, int field);
 		void    mergeWithNextNote(HumdrumFile& infile, int line, int field);
 		void    changeDurationOfNote(HTp note, HumNum dur);
@@ -4487,8 +5724,14 @@ class Tool_dissonant : public HumTool {
 		bool voiceFuncsQ = false;
 		bool m_voicenumQ = false;
 		bool m_selfnumQ = false;
+		bool m_countQ = false;       // print label counts without -c
+
+		vector<string> m_labels;     // label text for each dissonance type
+		vector<int>    m_labelcodes; // first dissonance type with the same label
 
-		vector<string> m_labels;
+		// labels for notes which are not dissonant:
+		const int NO_LABEL             = -1; // no label (empty string)
+		const int NULL_LABEL           = -2; // null token label (".")
 
 		// unaccdented non-harmonic tones:
 		const int PASSING_UP           =  0; // rising passing tone
@@ -4592,10 +5835,16 @@ class Tool_esac2hum : public HumTool {
 		void      checkOptions          (Options& opts, int argc, char** argv);
 		void      example               (void);
 		void      usage                 (const string& command);
-		void      convertEsacToHumdrum  (ostream& out, istream& input);
-		bool      getSong               (vector<string>& song, istream& infile,
-		                                int init);
-		void      convertSong           (vector<string>& song, ostream& out);
+		bool      convertEsacToHumdrum  (ostream& out, istream& input);
+		void      getSongs              (vector<vector<string>>& songs,
+		                                 vector<int>& songlines, istream& infile);
+		bool      convertSong           (vector<string>& song, ostream& out);
+		string    getSplitFilename      (int index);
+		void      printReport           (ostream& out,
+		                                 vector<vector<string>>& songs,
+		                                 vector<int>& songlines,
+		                                 vector<double>& times,
+		                                 vector<string>& errors);
 		bool      getKeyInfo            (vector<string>& song, string& key,
 		                                 double& mindur, int& tonic, string& meter,
 		                                 ostream& out);
@@ -4624,7 +5873,7 @@ class Tool_esac2hum : public HumTool {
 		void      getLyrics             (vector<string>& lyrics, const string& buffer);
 		void      cleanupLyrics         (vector<string>& lyrics);
 		bool      getFileContents       (vector<string>& array, const string& filename);
-		void      chopExtraInfo         (char* holdbuffer);
+		void      chopExtraInfo         (string& line);
 		void      printHumdrumHeaderInfo(ostream& out, vector<string>& song);
 		void      printHumdrumFooterInfo(ostream& out, vector<string>& song);
 
@@ -4633,13 +5882,15 @@ class Tool_esac2hum : public HumTool {
 		int            verboseQ = 0;      // used with -v option
 		int            splitQ = 0;        // used with -s option
 		int            firstfilenum = 1;  // used with -f option
+		int            threads = 1;       // used with -j option
+		int            reportQ = 0;       // used with --report option
 		vector<string> header;            // used with -h option
 		vector<string> trailer;           // used with -t option
 		string         fileextension;     // used with -x option
 		string         namebase;          // used with -s option
 
 		vector<int>    chartable;  // used printChars() & printSpecialChars()
-		int inputline = 0;
+		int inputline = 0;         // last input line of the current song
 
 };
 
@@ -4653,18 +5904,25 @@ class Tool_extract : public HumTool {
 		bool     run                    (HumdrumFile& infile);
 		bool     run                    (const string& indata, ostream& out);
 		bool     run                    (HumdrumFile& infile, ostream& out);
+		bool     run                    (HumdrumLineStream& instream);
+		bool     isLineStreamable       (void);
 
 	protected:
 
 		// auto transpose functions:
-		void     initialize             (HumdrumFile& infile);
+		void     initialize             (void);
 
 		// function declarations
 		void    processFile             (HumdrumFile& infile);
 		void    excludeFields           (HumdrumFile& infile, vector<int>& field,
 		                                 vector<int>& subfield, vector<int>& model);
+		void    excludeFields           (HumdrumLine& line, vector<int>& field,
+		                                 vector<int>& subfield, vector<int>& model);
 		void    extractFields           (HumdrumFile& infile, vector<int>& field,
 		                                 vector<int>& subfield, vector<int>& model);
+		void    extractFields           (HumdrumLine& line, int maxtrack,
+		                                 vector<int>& field, vector<int>& subfield,
+		                                 vector<int>& model);
 		void    extractTrace            (HumdrumFile& infile, const string& tracefile);
 		void    getInterpretationFields (vector<int>& field, vector<int>& subfield,
 		                                 vector<int>& model, HumdrumFile& infile,
@@ -4674,18 +5932,21 @@ class Tool_extract : public HumTool {
 		void    usage                   (const string& command);
 		void    fillFieldData           (vector<int>& field, vector<int>& subfield,
 		                                 vector<int>& model, string& fieldstring,
-		                                 HumdrumFile& infile);
+		                                 int maxtrack, HumdrumFile* infile);
 		void    processFieldEntry       (vector<int>& field, vector<int>& subfield,
 		                                 vector<int>& model, const string& astring,
-		                                 HumdrumFile& infile);
+		                                 int maxtrack, HumdrumFile* infile);
 		void    removeDollarsFromString (string& buffer, int maxtrack);
-		int     isInList                (int number, vector<int>& listofnum);
+		void    makeExcludeMap          (HumdrumLine& line, vector<int>& field);
+		bool    makeFieldMap            (HumdrumLine& line, vector<int>& field,
+		                                 vector<int>& subfield);
+		void    printFieldMap           (HumdrumLine& line);
 		void    getTraceData            (vector<int>& startline,
 		                                 vector<vector<int> >& fields,
 		                                 const string& tracefile, HumdrumFile& infile);
 		void    printTraceLine          (HumdrumFile& infile, int line,
 		                                 vector<int>& field);
-		void    dealWithSpineManipulators(HumdrumFile& infile, int line,
+		void    dealWithSpineManipulators(HumdrumLine& line, int maxtrack,
 		                                 vector<int>& field, vector<int>& subfield,
 		                                 vector<int>& model);
 		void    storeToken              (vector<string>& storage,
@@ -4763,6 +6024,12 @@ class Tool_extract : public HumTool {
 		int         emptyQ      = 0;       // used with --empty option
 		int         spineListQ  = 0;       // used with --spine option
 
+		// fieldmap: input fields to print for each output field on lines
+		// until the next spine manipulator (-1 for a blank spine).
+		vector<int> fieldmap;
+		int         fieldmapQ   = 0;       // fieldmap can be used for line
+		int         remapQ      = 1;       // calculate fieldmap for next line
+
 };
 
 
@@ -4909,6 +6176,8 @@ class NotePoint {
 		int         processed      = 0;      // has note been processed/matched
 		int         sourceindex    = -1;     // source file index for note
 		int         tpindex        = -1;     // timepoint index of note in source
+		long long   tick           = -1;     // start time of note in group ticks
+		long long   durticks       = -1;     // duration of note in group ticks
 		vector<int> matched;       // indexes to the location of the note in TimePoint list.
 		                           // the index indicate which score the match is related to,
 		                           // and a value of -1 means there is no equivalent timepoint.
@@ -4925,6 +6194,8 @@ class NotePoint {
 			processed = 0;
 			sourceindex = -1;
 			tpindex = -1;
+			tick = -1;
+			durticks = -1;
 			matched.clear();
 		}
 };
@@ -4941,21 +6212,32 @@ class Tool_humdiff : public HumTool {
 		bool     run                (HumdrumFile& infile1, HumdrumFile& infile2, ostream& out);
 		bool     run                (HumdrumFile& infile1, HumdrumFile& infile2);
 		void     processFile        (HumdrumFile& infile1, HumdrumFile& infile2);
+		void     processFileSet     (HumdrumFileSet& infiles);
 
-		void     compareFiles       (HumdrumFileSet& humset);
-		ostream& compareTimePoints  (ostream& out, vector<vector<TimePoint>>& timepoints, HumdrumFileSet& humset);
+	protected:
+		bool     prepareGroup       (vector<HumdrumFile*>& group);
+		bool     getTickScales      (vector<HumdrumFile*>& group,
+		                             vector<long long>& tickscales);
+		void     compareGroups      (vector<vector<HumdrumFile*>>& groups);
 		void     extractTimePoints  (vector<TimePoint>& points, HumdrumFile& infile);
 		ostream& printTimePoints    (ostream& out, vector<TimePoint>& timepoints);
-		void     compareLines       (HumNum minval, vector<int>& indexes, vector<vector<TimePoint>>& timepoints, HumdrumFileSet& humset);
-		void     getNoteList        (vector<NotePoint>& notelist, HumdrumFile& infile, int line, int measure, int sourceindex, int tpindex);
-		int      findNoteInList     (NotePoint& np, vector<NotePoint>& nps);
+		void     extractNotePoints  (vector<NotePoint>& notelist, HumdrumFile& infile,
+		                             int sourceindex, long long tickscale);
+		void     getNoteList        (vector<NotePoint>& notelist, HumdrumFile& infile,
+		                             int line, int measure, int sourceindex, int tpindex,
+		                             long long tickscale);
+		void     alignNotePoints    (vector<NotePoint>& reference, vector<NotePoint>& source,
+		                             vector<int>& matches, vector<int>& extras);
 		void     printNotePoints    (vector<NotePoint>& notelist);
+		void     printReport        (vector<HumdrumFile*>& group,
+		                             vector<NotePoint>& reference);
+		void     printDelta         (int groupindex, vector<HumdrumFile*>& group,
+		                             vector<vector<NotePoint>>& notes,
+		                             vector<vector<int>>& extras);
 		void     markNote           (NotePoint& np);
 
-
-int m_marked = 0;
-
-
+	private:
+		int      m_marked = 0;
 
 };
 
@@ -5145,6 +6427,7 @@ class Tool_mei2hum : public HumTool {
 		bool    convert              (ostream& out, xml_document& infile);
 		bool    convert              (ostream& out, const char* input);
 		bool    convert              (ostream& out, istream& input);
+		bool    convertFiles         (ostream& out, const vector<string>& filenames);
 
 		void    setOptions           (int argc, char** argv);
 		void    setOptions           (const vector<string>& argvlist);
@@ -5152,6 +6435,13 @@ class Tool_mei2hum : public HumTool {
 
 	protected:
 		void   initialize           (void);
+		void   clear                (void);
+		bool   loadFile             (xml_document& doc, vector<char>& buffer,
+		                             const string& filename);
+		string getOutputFilename    (const string& filename);
+		void   printReport          (ostream& out, const vector<string>& filenames,
+		                             vector<double>& times, vector<size_t>& sizes,
+		                             vector<string>& errors, double wallclock);
 		HumNum parseScore           (xml_node score, HumNum starttime);
 		void   getChildrenVector    (vector<xml_node>& children, xml_node parent);
 		void   parseScoreDef        (xml_node scoreDef, HumNum starttime);
@@ -5249,9 +6539,12 @@ class Tool_mei2hum : public HumTool {
 		bool           m_stemsQ = false;
 		bool           m_recipQ = false;
 		bool           m_placeQ = false;
+		int            m_threads = 1;       // used with -j option
+		string         m_outdir;            // used with --outdir option
+		bool           m_reportQ = false;   // used with --report option
 
 		mei_scoreDef   m_scoreDef;    // for keeping track of key/meter/clef etc.
-		int            m_staffcount;  // number of staves in score.
+		int            m_staffcount = 0;  // number of staves in score.
 		HumNum         m_tupletfactor = 1;
 		HumGrid        m_outdata;
 		int            m_currentLayer = 0;
@@ -5476,6 +6769,7 @@ class Tool_musicxml2hum : public HumTool {
 		void   printAttributes      (pugi::xml_node node);
 		bool   getPartInfo          (map<std::string, pugi::xml_node>& partinfo,
 		                             std::vector<std::string>& partids, pugi::xml_document& doc);
+		void   setTimelineTpq       (std::vector<MxmlPart>& partdata);
 		bool   stitchParts          (HumGrid& outdata,
 		                             std::vector<std::string>& partids,
 		                             map<std::string, pugi::xml_node>& partinfo,
@@ -5720,6 +7014,41 @@ class MeasureInfo {
 
 
 
+// MyankIndex -- Lightweight index of the barlines and clef/key/meter/tempo
+// interpretations in the text of a Humdrum score, used to extract a range
+// of measures without parsing and analyzing the entire score.  The index
+// stores offsets into the indexed text, so the text must remain unchanged
+// while the index is being used.
+
+class MyankIndex {
+	public:
+		              MyankIndex     (void) { clear(); }
+		void          clear          (void);
+		bool          build          (const string& data);
+		bool          isValid        (void) const { return m_valid; }
+		const string& getData        (void) const;
+		bool          hasMeasure     (int number) const;
+		bool          extract        (string& output, int startmeasure,
+		                              int endmeasure) const;
+
+	protected:
+		int           getStateType   (const string& token) const;
+		void          appendLine     (string& output, size_t offset) const;
+		size_t        getLineEnd     (size_t offset) const;
+
+	private:
+		const string*  m_data;         // indexed text
+		bool           m_valid;        // true if extraction is possible
+		vector<bool>   m_kern;         // true for **kern spines
+		size_t         m_headerend;    // offset of first numbered barline
+		size_t         m_tailstart;    // offset of line after last data/barline
+		vector<int>    m_barnum;       // numbered barlines, increasing
+		vector<size_t> m_baroffset;    // offsets of numbered barlines
+		vector<size_t> m_stateoffset;  // offsets of clef/key/meter/tempo lines
+};
+
+
+
 class Tool_myank : public HumTool {
 	public:
 		         Tool_myank            (void);
@@ -5729,6 +7058,9 @@ class Tool_myank : public HumTool {
 		bool     run                   (HumdrumFile& infile);
 		bool     run                   (const string& indata, ostream& out);
 		bool     run                   (HumdrumFile& infile, ostream& out);
+		bool     run                   (const MyankIndex& index, ostream& out);
+		bool     runString             (const string& data, ostream& out);
+		bool     isIndexable           (void);
 
 	protected:
 		void      initialize            (HumdrumFile& infile);
@@ -5774,6 +7106,7 @@ class Tool_myank : public HumTool {
 		int       getSectionCount      (HumdrumFile& infile);
 		void      getSectionString     (string& sstring, HumdrumFile& infile,
 		                                int sec);
+		bool      getSimpleMeasureRange(int& startmeasure, int& endmeasure);
 
 	private:
 		int    debugQ      = 0;             // used with --debug option
@@ -5798,6 +7131,66 @@ class Tool_myank : public HumTool {
 };
 
 
+class NoteColumns {
+	public:
+		void clear(void) {
+			onset.clear();
+			duration.clear();
+			midi.clear();
+			b40.clear();
+			track.clear();
+			layer.clear();
+			measure.clear();
+			metlev.clear();
+		}
+		int getRowCount(void) const { return (int)onset.size(); }
+
+		std::vector<double>  onset;    // quarter notes from start of score
+		std::vector<double>  duration; // quarter notes (including ties)
+		std::vector<int16_t> midi;     // MIDI note number (60 = middle C)
+		std::vector<int16_t> b40;      // base-40 pitch
+		std::vector<int16_t> track;    // spine number of the voice
+		std::vector<int16_t> layer;    // subspine (1 = primary layer)
+		std::vector<int32_t> measure;  // number of the previous barline
+		std::vector<float>   metlev;   // metric level (NAN if unknown)
+};
+
+
+class Tool_notecols : public HumTool {
+	public:
+		         Tool_notecols     (void);
+		        ~Tool_notecols     () {};
+
+		bool     run               (HumdrumFileSet& infiles);
+		bool     run               (HumdrumFile& infile);
+		bool     run               (const string& indata, ostream& out);
+		bool     run               (HumdrumFile& infile, ostream& out);
+		bool     run               (HumdrumFileStream& instream, ostream& out);
+
+	protected:
+		bool     initialize        (void);
+		bool     processFiles      (HumdrumFileSet& infiles, ostream& out);
+		bool     processContents   (vector<string>& contents,
+		                            vector<string>& filenames,
+		                            ostream& out);
+		void     printHeader       (ostream& out);
+		void     printBlock        (HumdrumFile& infile, ostream& out);
+		void     fillColumns       (HumdrumFile& infile, NoteColumns& columns);
+		void     printBinaryBlock  (const string& filename,
+		                            NoteColumns& columns, ostream& out);
+		void     printTextBlock    (const string& filename,
+		                            NoteColumns& columns, ostream& out);
+		void     appendLittleEndian(string& buffer, uint64_t value,
+		                            int bytecount);
+
+	private:
+		bool     m_textQ = false;      // used with -t option
+		bool     m_headerQ = false;    // true after header has been printed
+		int      m_threads = 1;        // used with -j option
+		int      m_batch = 64;         // used with -b option
+};
+
+
 
 
 class Tool_periodicity : public HumTool {
@@ -5870,12 +7263,14 @@ class Tool_pnum : public HumTool {
 		bool  run                     (HumdrumFile& infile);
 		bool  run                     (const string& indata, ostream& out);
 		bool  run                     (HumdrumFile& infile, ostream& out);
+		bool  run                     (HumdrumLineStream& instream);
+		bool  isLineStreamable        (void);
 
 	protected:
-		void  initialize              (HumdrumFile& infile);
+		void  initialize              (void);
 		void  processFile             (HumdrumFile& infile);
-		std::string convertSubtokenToBase(const std::string& text);
-		void  convertTokenToBase      (HTp token);
+		std::string convertSubtokenToBase(const std::string& text, int pitch);
+		void  convertTokensToBase     (std::vector<HTp>& tokens);
 
 	private:
 		int  m_base = 12;
@@ -5886,6 +7281,7 @@ class Tool_pnum : public HumTool {
 		bool m_attacksQ;
 		std::string m_rest;
 		bool m_restQ;
+		std::string m_exinterp;
 
 };
 
@@ -5900,12 +7296,19 @@ class Tool_recip : public HumTool {
 		bool  run                      (HumdrumFile& infile);
 		bool  run                      (const string& indata, ostream& out);
 		bool  run                      (HumdrumFile& infile, ostream& out);
+		bool  run                      (HumdrumLineStream& instream);
+		bool  isLineStreamable         (void);
 
 	protected:
-		void  initialize               (HumdrumFile& infile);
+		void  initialize               (void);
 		void  replaceKernWithRecip     (HumdrumFile& infile);
+		void  replaceKernWithRecip     (HumdrumLine& line, HumdrumLineStream& instream,
+		                                HumRegex& hre);
 		void  doCompositeAnalysis      (HumdrumFile& infile);
 		void  insertAnalysisSpines     (HumdrumFile& infile, HumdrumFile& cfile);
+		void  insertAnalysisSpines     (HumdrumLine& line, HumdrumLineStream& instream,
+		                                HumRegex& hre);
+		string getRecipText            (HTp token, HumRegex& hre);
 
 	private:
 		vector<HTp> m_kernspines;
@@ -6152,12 +7555,17 @@ class Tool_spinetrace : public HumTool {
 		bool  run                      (HumdrumFile& infile);
 		bool  run                      (const string& indata, ostream& out);
 		bool  run                      (HumdrumFile& infile, ostream& out);
+		bool  run                      (HumdrumLineStream& instream);
+		bool  isLineStreamable         (void);
 
 	protected:
-		void  initialize               (HumdrumFile& infile);
+		void  initialize               (void);
 		void  processFile              (HumdrumFile& infile);
+		void  processLine              (HumdrumLine& line);
 
 	private:
+		bool  m_appendQ  = false;
+		bool  m_prependQ = false;
 
 };
 
@@ -6172,6 +7580,8 @@ class Tool_tabber : public HumTool {
 		bool  run                      (HumdrumFile& infile);
 		bool  run                      (const string& indata, ostream& out);
 		bool  run                      (HumdrumFile& infile, ostream& out);
+		bool  run                      (HumdrumLineStream& instream);
+		bool  isLineStreamable         (void);
 
 	protected:
 		void  initialize               (HumdrumFile& infile);
@@ -6254,14 +7664,7 @@ class Tool_transpose : public HumTool {
 		void     printHumdrumDataRecord (HumdrumLine& record,
 		                                 vector<bool>& spineprocess);
 
-		double   pearsonCorrelation     (int size, double* x, double* y);
 		void     doAutoTransposeAnalysis(HumdrumFile& infile);
-		void     addToHistogramDouble   (vector<vector<double> >& histogram,
-		                                 int pc, double start, double dur,
-		                                 double tdur, int segments);
-		double   storeHistogramForTrack (vector<vector<double> >& histogram,
-		                                 HumdrumFile& infile, int track,
-		                                 int segments);
 		void     printHistograms        (int segments, vector<int> ktracks,
 		                                vector<vector<vector<double> > >&
 		                                 trackhist);
@@ -6270,28 +7673,8 @@ class Tool_transpose : public HumTool {
 		                                 int segments, vector<int>& ktracks,
 		                                 vector<vector<vector<double> > >&
 		                                 trackhist);
-		void     doTrackKeyAnalysis     (vector<vector<double> >& analysis,
-		                                 int level, int hop, int count,
-		                                 vector<vector<double> >& trackhist,
-		                                 vector<double>& majorweights,
-		                                 vector<double>& minorweights);
-		void     identifyKeyDouble      (vector<double>& correls,
-		                                 vector<double>& histogram,
-		                                 vector<double>& majorweights,
-		                                 vector<double>& minorweights);
-		void     fillWeightsWithKostkaPayne(vector<double>& maj,
-		                                 vector<double>& min);
 		void     printRawTrackAnalysis  (vector<vector<vector<double> > >&
 		                                 analysis, vector<int>& ktracks);
-		void     doSingleAnalysis       (vector<double>& analysis,
-		                                 int startindex, int length,
-		                                 vector<vector<double> >& trackhist,
-		                                 vector<double>& majorweights,
-		                                 vector<double>& minorweights);
-		void     identifyKey            (vector<double>& correls,
-		                                 vector<double>& histogram,
-		                                 vector<double>& majorweights,
-		                                 vector<double>& minorweights);
 		void     doTranspositionAnalysis(vector<vector<vector<double> > >&
 		                                 analysis);
 		int      calculateTranspositionFromKey(int targetkey,
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sun Mar  4 21:15:15 PST 2018
-// Last Modified: Sun Mar  4 21:15:19 PST 2018
+// Last Modified: Sun Oct 18 17:41:26 PDT 2026 Bit-packed roll and binary output
 // Filename:      tool-binroll.h
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/tool-binroll.h
 // Syntax:        C++11; humlib
@@ -16,6 +16,10 @@
 #include "HumTool.h"
 #include "HumNum.h"
 #include "HumdrumFile.h"
+#include "HumdrumFileStream.h"
+
+#include <cstdint>
+#include <iostream>
 
 namespace hum {
 
@@ -30,16 +34,39 @@ class Tool_binroll : public HumTool {
 		bool     run               (HumdrumFile& infile);
 		bool     run               (const string& indata, ostream& out);
 		bool     run               (HumdrumFile& infile, ostream& out);
+		bool     run               (HumdrumFileStream& instream, ostream& out);
 
 	protected:
-		void     processFile       (HumdrumFile& infile);
-		void     processStrand     (vector<vector<char>>& roll, HTp starting,
-		                            HTp ending);
-		void     printAnalysis     (HumdrumFile& infile,
-		                            vector<vector<char>>& roll);
+		bool     initialize        (void);
+		void     processFile       (HumdrumFile& infile, ostream& out);
+		void     fillRoll          (HumdrumFile& infile);
+		void     processStrand     (HTp starting, HTp ending);
+		void     setCell           (int pitch, int index, int value);
+		int      getCell           (int pitch, int index) const;
+		void     printRoll         (ostream& out);
+		void     printRollData     (ostream& out);
+		void     printTextRoll     (ostream& out);
+		void     printBitplanes    (ostream& out);
+		void     printNpyRoll      (ostream& out);
+		void     printNpyHeader    (ostream& out, int64_t slicecount);
+		void     printComments     (HumdrumFile& infile, int startline,
+		                            int endline, ostream& out);
+		void     printAnalysis     (HumdrumFile& infile, ostream& out);
 
 	private:
 		HumNum    m_duration;
+		string    m_format;
+
+		// m_slicecount: The number of time slices in the current roll.
+		int       m_slicecount = 0;
+
+		// m_sounding, m_attacks: Bit-packed piano roll, with two 64-bit
+		// words (MIDI keys 0-63 and 64-127) for each time slice.  A cell
+		// with the m_attacks bit set is a note attack (2 in text output),
+		// and a cell with only the m_sounding bit set is a sustained note
+		// (1 in text output).
+		vector<uint64_t> m_sounding;
+		vector<uint64_t> m_attacks;
 
 };
 
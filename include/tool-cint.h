@@ -21,6 +21,7 @@
 
 #include <vector>
 #include <string>
+#include <ostream>
 
 namespace hum {
 
@@ -67,6 +68,7 @@ class Tool_cint : public HumTool {
 		bool     run                    (HumdrumFile& infile);
 		bool     run                    (const string& indata, ostream& out);
 		bool     run                    (HumdrumFile& infile, ostream& out);
+		bool     lookupModuleIndex      (ostream& out);
 
 	protected:
 
@@ -139,7 +141,8 @@ class Tool_cint : public HumTool {
 		                                vector<vector<NoteNode> >& notes,
 		                                int n, int startline, int part1, int part2,
 		                                vector<vector<string> >& retrospective,
-		                                char& notemarker, int markstate = 0);
+		                                char& notemarker, int markstate = 0,
+		                                vector<int>* key = NULL);
 		int       printCombinationModulePrepare(ostream& out, const string& filename,
 		                                vector<vector<NoteNode> >& notes, int n,
 		                                int startline, int part1, int part2,
@@ -157,6 +160,25 @@ class Tool_cint : public HumTool {
 		int       getTriangleIndex(int number, int num1, int num2);
 		void      adjustKTracks        (vector<int>& ktracks, const string& koption);
 		int       getMeasure           (HumdrumFile& infile, int line);
+		int       getIntervalNumber    (NoteNode& note1, NoteNode& note2,
+		                                int type, int octaveadjust = 0);
+		void      addIntervalToKey     (vector<int>& key, NoteNode& note1,
+		                                NoteNode& note2, int type,
+		                                int octaveadjust = 0);
+		void      prepareNoteArray     (vector<vector<NoteNode> >& notes,
+		                                HumdrumFile& infile, vector<int>& ktracks,
+		                                vector<int>& reverselookup);
+		bool      buildModuleIndex     (HumdrumFileSet& infiles,
+		                                const string& filename);
+		void      extractModuleKeys    (vector<pair<vector<int>, string> >& entries,
+		                                HumdrumFile& infile,
+		                                vector<vector<NoteNode> >& notes,
+		                                int fileindex, int part1, int part2);
+		string    getModuleIndexSignature(void);
+		std::streamoff getModuleIndexOffset(istream& input, std::streamoff table,
+		                                std::streamoff record);
+		string    getModuleKeyString   (const vector<int>& key);
+		bool      parseModuleQuery     (vector<int>& key, const string& query);
 
 	private:
 
@@ -201,11 +223,17 @@ class Tool_cint : public HumTool {
 		int       uncrossQ     = 0;      // used with -c option
 		int       retroQ       = 0;      // used with --retro option
 		int       idQ          = 0;      // used with --id option
-		vector<string> Ids;              // used with --id option
 		char      NoteMarker   = '\0';   // used with -N option
 		string    SearchString;
 		string Spacer;
 
+		// Module index offset table (see buildModuleIndex()): each record
+		// is a zero-padded byte offset of m_offsetwidth digits and a
+		// newline, and the last line of the index is m_tablemarker
+		// followed by the offset of the table in the same format.
+		static const int m_offsetwidth = 20;
+		const string m_tablemarker = "!!!cint-table: ";
+
 };
 
 // END_MERGE
@@ -2,6 +2,7 @@
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Mon Nov 28 08:55:15 PST 2016
 // Last Modified: Mon Nov 28 08:55:38 PST 2016
+// Last Modified: Sun Oct 18 17:24:10 PDT 2026 Added printAnalysis()
 // Filename:      tool-dissonant.h
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/tool-dissonant.h
 // Syntax:        C++11; humlib
@@ -30,50 +31,59 @@ class Tool_dissonant : public HumTool {
 		bool     run               (HumdrumFile& infile);
 		bool     run               (const string& indata, ostream& out);
 		bool     run               (HumdrumFile& infile, ostream& out);
+		bool     run               (HumdrumFileStream& instream);
+		bool     printCountAnalysisForFiles(HumdrumFileSet& infiles);
 
 	protected:
-		void    doAnalysis         (vector<vector<string> >& results,
+		bool    analyzeFiles       (HumdrumFileSet& infiles, bool countQ,
+		                            bool filenameQ);
+		void    doAnalysis         (vector<vector<int> >& results,
 		                            NoteGrid& grid,
 		                            vector<vector<NoteCell*> >& attacks,
 		                            bool debug);
-		void    doAnalysisForVoice (vector<vector<string> >& results,
+		void    doAnalysisForVoice (vector<vector<int> >& results,
 		                            NoteGrid& grid,
 		                            vector<NoteCell*>& attacks,
 		                            int vindex, bool debug);
-		void    findFakeSuspensions(vector<vector<string> >& results,
+		void    findFakeSuspensions(vector<vector<int> >& results,
 		                            NoteGrid& grid,
 		                            vector<NoteCell*>& attacks, int vindex);
-		void    findAppoggiaturas  (vector<vector<string> >& results,
+		void    findAppoggiaturas  (vector<vector<int> >& results,
 		                            NoteGrid& grid,
 		                            vector<NoteCell*>& attacks, int vindex);
-		void    findLs             (vector<vector<string> >& results,
+		void    findLs             (vector<vector<int> >& results,
 		                            NoteGrid& grid,
 		                            vector<NoteCell*>& attacks, int vindex);
-		void    findYs             (vector<vector<string> >& results,
+		void    findYs             (vector<vector<int> >& results,
 		                            NoteGrid& grid,
 		                            vector<NoteCell*>& attacks, int vindex);
-		void    findCadentialVoiceFunctions(vector<vector<string> >& results,
+		void    findCadentialVoiceFunctions(vector<vector<int> >& results,
 		                            NoteGrid& grid, vector<NoteCell*>& attacks,
 		                            vector<vector<string> >& voiceFuncs,
 		                            int vindex);
 
 		void    printColorLegend   (HumdrumFile& infile);
+		bool    printAnalysis      (HumdrumFile& infile,
+		                            vector<vector<string> >& data);
 		int     getNextPitchAttackIndex(NoteGrid& grid, int voicei,
 		                            int sliceindex);
 		void    fillLabels         (void);
 		void    fillLabels2        (void);
-		void    printCountAnalysis (vector<vector<string> >& data);
+		void    fillLabelCodes     (void);
+		void    getLabelStrings    (vector<vector<string> >& labels,
+		                            vector<vector<int> >& results);
+		void    printCountAnalysis (vector<vector<int> >& data);
 		void    suppressDissonances(HumdrumFile& infile, NoteGrid& grid,
 		                            vector<vector<NoteCell* > >& attacks,
-		                            vector<vector<string> >& results);
+		                            vector<vector<int> >& results);
 		void    suppressDissonancesInVoice(HumdrumFile& infile,
 		                            NoteGrid& grid, int vindex,
 		                            vector<NoteCell*>& attacks,
-		                            vector<string>& results);
+		                            vector<int>& results);
 		void    suppressSusOrnamentsInVoice(HumdrumFile& infile,
 		                            NoteGrid& grid, int vindex,
 		                            vector<NoteCell*>& attacks,
-		                            vector<string>& results);
+		                            vector<int>& results);
 		void    mergeWithPreviousNote(HumdrumFile& infile, int line, int field);
 		void    mergeWithNextNote(HumdrumFile& infile, int line, int field);
 		void    changeDurationOfNote(HTp note, HumNum dur);
@@ -104,8 +114,14 @@ class Tool_dissonant : public HumTool {
 		bool voiceFuncsQ = false;
 		bool m_voicenumQ = false;
 		bool m_selfnumQ = false;
+		bool m_countQ = false;       // print label counts without -c
 
-		vector<string> m_labels;
+		vector<string> m_labels;     // label text for each dissonance type
+		vector<int>    m_labelcodes; // first dissonance type with the same label
+
+		// labels for notes which are not dissonant:
+		const int NO_LABEL             = -1; // no label (empty string)
+		const int NULL_LABEL           = -2; // null token label (".")
 
 		// unaccdented non-harmonic tones:
 		const int PASSING_UP           =  0; // rising passing tone
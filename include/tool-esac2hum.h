@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Tue Mar  5 21:32:27 PST 2002
-// Last Modified: Tue Jun  6 10:07:14 CEST 2017
+// Last Modified: Sun Oct 18 19:41:26 PDT 2026 Parallel song conversion
 // Filename:      tool-esac2hum.h
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/tool-esac2hum.h
 // Syntax:        C++11; humlib
@@ -63,10 +63,16 @@ class Tool_esac2hum : public HumTool {
 		void      checkOptions          (Options& opts, int argc, char** argv);
 		void      example               (void);
 		void      usage                 (const string& command);
-		void      convertEsacToHumdrum  (ostream& out, istream& input);
-		bool      getSong               (vector<string>& song, istream& infile,
-		                                int init);
-		void      convertSong           (vector<string>& song, ostream& out);
+		bool      convertEsacToHumdrum  (ostream& out, istream& input);
+		void      getSongs              (vector<vector<string>>& songs,
+		                                 vector<int>& songlines, istream& infile);
+		bool      convertSong           (vector<string>& song, ostream& out);
+		string    getSplitFilename      (int index);
+		void      printReport           (ostream& out,
+		                                 vector<vector<string>>& songs,
+		                                 vector<int>& songlines,
+		                                 vector<double>& times,
+		                                 vector<string>& errors);
 		bool      getKeyInfo            (vector<string>& song, string& key,
 		                                 double& mindur, int& tonic, string& meter,
 		                                 ostream& out);
@@ -95,7 +101,7 @@ class Tool_esac2hum : public HumTool {
 		void      getLyrics             (vector<string>& lyrics, const string& buffer);
 		void      cleanupLyrics         (vector<string>& lyrics);
 		bool      getFileContents       (vector<string>& array, const string& filename);
-		void      chopExtraInfo         (char* holdbuffer);
+		void      chopExtraInfo         (string& line);
 		void      printHumdrumHeaderInfo(ostream& out, vector<string>& song);
 		void      printHumdrumFooterInfo(ostream& out, vector<string>& song);
 
@@ -104,13 +110,15 @@ class Tool_esac2hum : public HumTool {
 		int            verboseQ = 0;      // used with -v option
 		int            splitQ = 0;        // used with -s option
 		int            firstfilenum = 1;  // used with -f option
+		int            threads = 1;       // used with -j option
+		int            reportQ = 0;       // used with --report option
 		vector<string> header;            // used with -h option
 		vector<string> trailer;           // used with -t option
 		string         fileextension;     // used with -x option
 		string         namebase;          // used with -s option
 
 		vector<int>    chartable;  // used printChars() & printSpecialChars()
-		int inputline = 0;
+		int inputline = 0;         // last input line of the current song
 
 };
 
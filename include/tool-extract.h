@@ -2,6 +2,8 @@
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Mon Dec  5 23:09:00 PST 2016
 // Last Modified: Mon Dec  5 23:09:08 PST 2016
+// Last Modified: Mon Oct 19 01:12:40 PDT 2026 Added line-at-a-time processing
+// Last Modified: Mon Oct 19 02:31:05 PDT 2026 Added field maps
 // Filename:      tool-extract.h
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/tool-extract.h
 // Syntax:        C++11; humlib
@@ -29,18 +31,25 @@ class Tool_extract : public HumTool {
 		bool     run                    (HumdrumFile& infile);
 		bool     run                    (const string& indata, ostream& out);
 		bool     run                    (HumdrumFile& infile, ostream& out);
+		bool     run                    (HumdrumLineStream& instream);
+		bool     isLineStreamable       (void);
 
 	protected:
 
 		// auto transpose functions:
-		void     initialize             (HumdrumFile& infile);
+		void     initialize             (void);
 
 		// function declarations
 		void    processFile             (HumdrumFile& infile);
 		void    excludeFields           (HumdrumFile& infile, vector<int>& field,
 		                                 vector<int>& subfield, vector<int>& model);
+		void    excludeFields           (HumdrumLine& line, vector<int>& field,
+		                                 vector<int>& subfield, vector<int>& model);
 		void    extractFields           (HumdrumFile& infile, vector<int>& field,
 		                                 vector<int>& subfield, vector<int>& model);
+		void    extractFields           (HumdrumLine& line, int maxtrack,
+		                                 vector<int>& field, vector<int>& subfield,
+		                                 vector<int>& model);
 		void    extractTrace            (HumdrumFile& infile, const string& tracefile);
 		void    getInterpretationFields (vector<int>& field, vector<int>& subfield,
 		                                 vector<int>& model, HumdrumFile& infile,
@@ -50,18 +59,21 @@ class Tool_extract : public HumTool {
 		void    usage                   (const string& command);
 		void    fillFieldData           (vector<int>& field, vector<int>& subfield,
 		                                 vector<int>& model, string& fieldstring,
-		                                 HumdrumFile& infile);
+		                                 int maxtrack, HumdrumFile* infile);
 		void    processFieldEntry       (vector<int>& field, vector<int>& subfield,
 		                                 vector<int>& model, const string& astring,
-		                                 HumdrumFile& infile);
+		                                 int maxtrack, HumdrumFile* infile);
 		void    removeDollarsFromString (string& buffer, int maxtrack);
-		int     isInList                (int number, vector<int>& listofnum);
+		void    makeExcludeMap          (HumdrumLine& line, vector<int>& field);
+		bool    makeFieldMap            (HumdrumLine& line, vector<int>& field,
+		                                 vector<int>& subfield);
+		void    printFieldMap           (HumdrumLine& line);
 		void    getTraceData            (vector<int>& startline,
 		                                 vector<vector<int> >& fields,
 		                                 const string& tracefile, HumdrumFile& infile);
 		void    printTraceLine          (HumdrumFile& infile, int line,
 		                                 vector<int>& field);
-		void    dealWithSpineManipulators(HumdrumFile& infile, int line,
+		void    dealWithSpineManipulators(HumdrumLine& line, int maxtrack,
 		                                 vector<int>& field, vector<int>& subfield,
 		                                 vector<int>& model);
 		void    storeToken              (vector<string>& storage,
@@ -139,6 +151,12 @@ class Tool_extract : public HumTool {
 		int         emptyQ      = 0;       // used with --empty option
 		int         spineListQ  = 0;       // used with --spine option
 
+		// fieldmap: input fields to print for each output field on lines
+		// until the next spine manipulator (-1 for a blank spine).
+		vector<int> fieldmap;
+		int         fieldmapQ   = 0;       // fieldmap can be used for line
+		int         remapQ      = 1;       // calculate fieldmap for next line
+
 };
 
 
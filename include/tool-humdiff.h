@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Mon Jul 29 11:38:01 CEST 2019
-// Last Modified: Sat Aug  3 17:48:04 EDT 2019
+// Last Modified: Mon Oct 19 05:41:12 PDT 2026
 // Filename:      tool-humdiff.h
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/tool-humdiff.h
 // Syntax:        C++11; humlib
@@ -67,6 +67,8 @@ class NotePoint {
 		int         processed      = 0;      // has note been processed/matched
 		int         sourceindex    = -1;     // source file index for note
 		int         tpindex        = -1;     // timepoint index of note in source
+		long long   tick           = -1;     // start time of note in group ticks
+		long long   durticks       = -1;     // duration of note in group ticks
 		vector<int> matched;       // indexes to the location of the note in TimePoint list.
 		                           // the index indicate which score the match is related to,
 		                           // and a value of -1 means there is no equivalent timepoint.
@@ -83,6 +85,8 @@ class NotePoint {
 			processed = 0;
 			sourceindex = -1;
 			tpindex = -1;
+			tick = -1;
+			durticks = -1;
 			matched.clear();
 		}
 };
@@ -99,21 +103,32 @@ class Tool_humdiff : public HumTool {
 		bool     run                (HumdrumFile& infile1, HumdrumFile& infile2, ostream& out);
 		bool     run                (HumdrumFile& infile1, HumdrumFile& infile2);
 		void     processFile        (HumdrumFile& infile1, HumdrumFile& infile2);
+		void     processFileSet     (HumdrumFileSet& infiles);
 
-		void     compareFiles       (HumdrumFileSet& humset);
-		ostream& compareTimePoints  (ostream& out, vector<vector<TimePoint>>& timepoints, HumdrumFileSet& humset);
+	protected:
+		bool     prepareGroup       (vector<HumdrumFile*>& group);
+		bool     getTickScales      (vector<HumdrumFile*>& group,
+		                             vector<long long>& tickscales);
+		void     compareGroups      (vector<vector<HumdrumFile*>>& groups);
 		void     extractTimePoints  (vector<TimePoint>& points, HumdrumFile& infile);
 		ostream& printTimePoints    (ostream& out, vector<TimePoint>& timepoints);
-		void     compareLines       (HumNum minval, vector<int>& indexes, vector<vector<TimePoint>>& timepoints, HumdrumFileSet& humset);
-		void     getNoteList        (vector<NotePoint>& notelist, HumdrumFile& infile, int line, int measure, int sourceindex, int tpindex);
-		int      findNoteInList     (NotePoint& np, vector<NotePoint>& nps);
+		void     extractNotePoints  (vector<NotePoint>& notelist, HumdrumFile& infile,
+		                             int sourceindex, long long tickscale);
+		void     getNoteList        (vector<NotePoint>& notelist, HumdrumFile& infile,
+		                             int line, int measure, int sourceindex, int tpindex,
+		                             long long tickscale);
+		void     alignNotePoints    (vector<NotePoint>& reference, vector<NotePoint>& source,
+		                             vector<int>& matches, vector<int>& extras);
 		void     printNotePoints    (vector<NotePoint>& notelist);
+		void     printReport        (vector<HumdrumFile*>& group,
+		                             vector<NotePoint>& reference);
+		void     printDelta         (int groupindex, vector<HumdrumFile*>& group,
+		                             vector<vector<NotePoint>>& notes,
+		                             vector<vector<int>>& extras);
 		void     markNote           (NotePoint& np);
 
-
-int m_marked = 0;
-
-
+	private:
+		int      m_marked = 0;
 
 };
 
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Wed Sep 13 14:55:58 PDT 2017
-// Last Modified: Thu Sep 21 14:04:12 PDT 2017
+// Last Modified: Sun Oct 18 23:44:12 PDT 2026 Added batch conversion
 // Filename:      tool-mei2hum.h
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/tool-mei2hum.h
 // Syntax:        C++11; humlib
@@ -133,6 +133,7 @@ class Tool_mei2hum : public HumTool {
 		bool    convert              (ostream& out, xml_document& infile);
 		bool    convert              (ostream& out, const char* input);
 		bool    convert              (ostream& out, istream& input);
+		bool    convertFiles         (ostream& out, const vector<string>& filenames);
 
 		void    setOptions           (int argc, char** argv);
 		void    setOptions           (const vector<string>& argvlist);
@@ -140,6 +141,13 @@ class Tool_mei2hum : public HumTool {
 
 	protected:
 		void   initialize           (void);
+		void   clear                (void);
+		bool   loadFile             (xml_document& doc, vector<char>& buffer,
+		                             const string& filename);
+		string getOutputFilename    (const string& filename);
+		void   printReport          (ostream& out, const vector<string>& filenames,
+		                             vector<double>& times, vector<size_t>& sizes,
+		                             vector<string>& errors, double wallclock);
 		HumNum parseScore           (xml_node score, HumNum starttime);
 		void   getChildrenVector    (vector<xml_node>& children, xml_node parent);
 		void   parseScoreDef        (xml_node scoreDef, HumNum starttime);
@@ -237,9 +245,12 @@ class Tool_mei2hum : public HumTool {
 		bool           m_stemsQ = false;
 		bool           m_recipQ = false;
 		bool           m_placeQ = false;
+		int            m_threads = 1;       // used with -j option
+		string         m_outdir;            // used with --outdir option
+		bool           m_reportQ = false;   // used with --report option
 
 		mei_scoreDef   m_scoreDef;    // for keeping track of key/meter/clef etc.
-		int            m_staffcount;  // number of staves in score.
+		int            m_staffcount = 0;  // number of staves in score.
 		HumNum         m_tupletfactor = 1;
 		HumGrid        m_outdata;
 		int            m_currentLayer = 0;
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sat Aug  6 10:53:40 CEST 2016
-// Last Modified: Wed Oct 26 18:25:45 PDT 2016 Renamed class
+// Last Modified: Sun Oct 18 23:31:52 PDT 2026 Integer tick timeline
 // Filename:      tool-musicxml2hum.h
 // URL:           https://github.com/craigsapp/musicxml2hum/blob/master/include/tool-musicxml2hum.h
 // Syntax:        C++11; humlib
@@ -64,6 +64,7 @@ class Tool_musicxml2hum : public HumTool {
 		void   printAttributes      (pugi::xml_node node);
 		bool   getPartInfo          (map<std::string, pugi::xml_node>& partinfo,
 		                             std::vector<std::string>& partids, pugi::xml_document& doc);
+		void   setTimelineTpq       (std::vector<MxmlPart>& partdata);
 		bool   stitchParts          (HumGrid& outdata,
 		                             std::vector<std::string>& partids,
 		                             map<std::string, pugi::xml_node>& partinfo,
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Wed Nov 30 20:36:38 PST 2016
-// Last Modified: Wed Nov 30 20:36:41 PST 2016
+// Last Modified: Sun Oct 18 15:02:17 PDT 2026 Added MyankIndex
 // Filename:      tool-myank.h
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/tool-myank.h
 // Syntax:        C++11; humlib
@@ -95,6 +95,41 @@ class MeasureInfo {
 
 
 
+// MyankIndex -- Lightweight index of the barlines and clef/key/meter/tempo
+// interpretations in the text of a Humdrum score, used to extract a range
+// of measures without parsing and analyzing the entire score.  The index
+// stores offsets into the indexed text, so the text must remain unchanged
+// while the index is being used.
+
+class MyankIndex {
+	public:
+		              MyankIndex     (void) { clear(); }
+		void          clear          (void);
+		bool          build          (const string& data);
+		bool          isValid        (void) const { return m_valid; }
+		const string& getData        (void) const;
+		bool          hasMeasure     (int number) const;
+		bool          extract        (string& output, int startmeasure,
+		                              int endmeasure) const;
+
+	protected:
+		int           getStateType   (const string& token) const;
+		void          appendLine     (string& output, size_t offset) const;
+		size_t        getLineEnd     (size_t offset) const;
+
+	private:
+		const string*  m_data;         // indexed text
+		bool           m_valid;        // true if extraction is possible
+		vector<bool>   m_kern;         // true for **kern spines
+		size_t         m_headerend;    // offset of first numbered barline
+		size_t         m_tailstart;    // offset of line after last data/barline
+		vector<int>    m_barnum;       // numbered barlines, increasing
+		vector<size_t> m_baroffset;    // offsets of numbered barlines
+		vector<size_t> m_stateoffset;  // offsets of clef/key/meter/tempo lines
+};
+
+
+
 class Tool_myank : public HumTool {
 	public:
 		         Tool_myank            (void);
@@ -104,6 +139,9 @@ class Tool_myank : public HumTool {
 		bool     run                   (HumdrumFile& infile);
 		bool     run                   (const string& indata, ostream& out);
 		bool     run                   (HumdrumFile& infile, ostream& out);
+		bool     run                   (const MyankIndex& index, ostream& out);
+		bool     runString             (const string& data, ostream& out);
+		bool     isIndexable           (void);
 
 	protected:
 		void      initialize            (HumdrumFile& infile);
@@ -149,6 +187,7 @@ class Tool_myank : public HumTool {
 		int       getSectionCount      (HumdrumFile& infile);
 		void      getSectionString     (string& sstring, HumdrumFile& infile,
 		                                int sec);
+		bool      getSimpleMeasureRange(int& startmeasure, int& endmeasure);
 
 	private:
 		int    debugQ      = 0;             // used with --debug option
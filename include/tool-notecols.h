@@ -0,0 +1,96 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 21:40:12 PDT 2026
+// Last Modified: Sun Oct 18 21:40:15 PDT 2026
+// Filename:      tool-notecols.h
+// URL:           https://github.com/craigsapp/humlib/blob/master/include/tool-notecols.h
+// Syntax:        C++11; humlib
+// vim:           ts=3 noexpandtab
+//
+// Description:   Export note attacks as columns of binary data.
+//
+
+#ifndef _TOOL_NOTECOLS_H
+#define _TOOL_NOTECOLS_H
+
+#include "HumTool.h"
+#include "HumdrumFile.h"
+#include "HumdrumFileSet.h"
+#include "HumdrumFileStream.h"
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace hum {
+
+// START_MERGE
+
+class NoteColumns {
+	public:
+		void clear(void) {
+			onset.clear();
+			duration.clear();
+			midi.clear();
+			b40.clear();
+			track.clear();
+			layer.clear();
+			measure.clear();
+			metlev.clear();
+		}
+		int getRowCount(void) const { return (int)onset.size(); }
+
+		std::vector<double>  onset;    // quarter notes from start of score
+		std::vector<double>  duration; // quarter notes (including ties)
+		std::vector<int16_t> midi;     // MIDI note number (60 = middle C)
+		std::vector<int16_t> b40;      // base-40 pitch
+		std::vector<int16_t> track;    // spine number of the voice
+		std::vector<int16_t> layer;    // subspine (1 = primary layer)
+		std::vector<int32_t> measure;  // number of the previous barline
+		std::vector<float>   metlev;   // metric level (NAN if unknown)
+};
+
+
+class Tool_notecols : public HumTool {
+	public:
+		         Tool_notecols     (void);
+		        ~Tool_notecols     () {};
+
+		bool     run               (HumdrumFileSet& infiles);
+		bool     run               (HumdrumFile& infile);
+		bool     run               (const string& indata, ostream& out);
+		bool     run               (HumdrumFile& infile, ostream& out);
+		bool     run               (HumdrumFileStream& instream, ostream& out);
+
+	protected:
+		bool     initialize        (void);
+		bool     processFiles      (HumdrumFileSet& infiles, ostream& out);
+		bool     processContents   (vector<string>& contents,
+		                            vector<string>& filenames,
+		                            ostream& out);
+		void     printHeader       (ostream& out);
+		void     printBlock        (HumdrumFile& infile, ostream& out);
+		void     fillColumns       (HumdrumFile& infile, NoteColumns& columns);
+		void     printBinaryBlock  (const string& filename,
+		                            NoteColumns& columns, ostream& out);
+		void     printTextBlock    (const string& filename,
+		                            NoteColumns& columns, ostream& out);
+		void     appendLittleEndian(string& buffer, uint64_t value,
+		                            int bytecount);
+
+	private:
+		bool     m_textQ = false;      // used with -t option
+		bool     m_headerQ = false;    // true after header has been printed
+		int      m_threads = 1;        // used with -j option
+		int      m_batch = 64;         // used with -b option
+};
+
+// END_MERGE
+
+} // end namespace hum
+
+#endif /* _TOOL_NOTECOLS_H */
+
+
+
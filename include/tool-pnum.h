@@ -1,7 +1,8 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Wed Apr 10 08:58:07 EDT 2019
-// Last Modified: Wed Apr 10 10:14:50 EDT 2019
+// Last Modified: Sun Oct 18 21:10:44 PDT 2026 Batch pitch conversion
+// Last Modified: Mon Oct 19 01:12:40 PDT 2026 Added line-at-a-time processing
 // Filename:      tool-pnum.h
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/tool-pnum.h
 // Syntax:        C++11; humlib
@@ -29,12 +30,14 @@ class Tool_pnum : public HumTool {
 		bool  run                     (HumdrumFile& infile);
 		bool  run                     (const string& indata, ostream& out);
 		bool  run                     (HumdrumFile& infile, ostream& out);
+		bool  run                     (HumdrumLineStream& instream);
+		bool  isLineStreamable        (void);
 
 	protected:
-		void  initialize              (HumdrumFile& infile);
+		void  initialize              (void);
 		void  processFile             (HumdrumFile& infile);
-		std::string convertSubtokenToBase(const std::string& text);
-		void  convertTokenToBase      (HTp token);
+		std::string convertSubtokenToBase(const std::string& text, int pitch);
+		void  convertTokensToBase     (std::vector<HTp>& tokens);
 
 	private:
 		int  m_base = 12;
@@ -45,6 +48,7 @@ class Tool_pnum : public HumTool {
 		bool m_attacksQ;
 		std::string m_rest;
 		bool m_restQ;
+		std::string m_exinterp;
 
 };
 
@@ -2,6 +2,7 @@
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Mon Nov 28 08:55:15 PST 2016
 // Last Modified: Mon Nov 28 08:55:38 PST 2016
+// Last Modified: Mon Oct 19 01:12:40 PDT 2026 Added line-at-a-time processing
 // Filename:      tool-recip.h
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/tool-recip.h
 // Syntax:        C++11; humlib
@@ -15,6 +16,7 @@
 
 #include "HumTool.h"
 #include "HumdrumFile.h"
+#include "HumRegex.h"
 
 namespace hum {
 
@@ -29,12 +31,19 @@ class Tool_recip : public HumTool {
 		bool  run                      (HumdrumFile& infile);
 		bool  run                      (const string& indata, ostream& out);
 		bool  run                      (HumdrumFile& infile, ostream& out);
+		bool  run                      (HumdrumLineStream& instream);
+		bool  isLineStreamable         (void);
 
 	protected:
-		void  initialize               (HumdrumFile& infile);
+		void  initialize               (void);
 		void  replaceKernWithRecip     (HumdrumFile& infile);
+		void  replaceKernWithRecip     (HumdrumLine& line, HumdrumLineStream& instream,
+		                                HumRegex& hre);
 		void  doCompositeAnalysis      (HumdrumFile& infile);
 		void  insertAnalysisSpines     (HumdrumFile& infile, HumdrumFile& cfile);
+		void  insertAnalysisSpines     (HumdrumLine& line, HumdrumLineStream& instream,
+		                                HumRegex& hre);
+		string getRecipText            (HTp token, HumRegex& hre);
 
 	private:
 		vector<HTp> m_kernspines;
@@ -2,6 +2,7 @@
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Mon Oct 16 21:44:03 PDT 2000
 // Last Modified: Fri Jun 14 11:45:17 CEST 2019 Updated for humlib.
+// Last Modified: Mon Oct 19 01:12:40 PDT 2026 Added line-at-a-time processing
 // Filename:      tool-spinetrace.h
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/tool-spinetrace.h
 // Syntax:        C++11; humlib
@@ -29,12 +30,17 @@ class Tool_spinetrace : public HumTool {
 		bool  run                      (HumdrumFile& infile);
 		bool  run                      (const string& indata, ostream& out);
 		bool  run                      (HumdrumFile& infile, ostream& out);
+		bool  run                      (HumdrumLineStream& instream);
+		bool  isLineStreamable         (void);
 
 	protected:
-		void  initialize               (HumdrumFile& infile);
+		void  initialize               (void);
 		void  processFile              (HumdrumFile& infile);
+		void  processLine              (HumdrumLine& line);
 
 	private:
+		bool  m_appendQ  = false;
+		bool  m_prependQ = false;
 
 };
 
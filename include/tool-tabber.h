@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Wed Jun 12 12:15:23 CEST 2019
-// Last Modified: Wed Jun 12 12:15:26 CEST 2019
+// Last Modified: Mon Oct 19 01:12:40 PDT 2026
 // Filename:      tool-tabber.h
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/tool-tabber.h
 // Syntax:        C++11; humlib
@@ -29,6 +29,8 @@ class Tool_tabber : public HumTool {
 		bool  run                      (HumdrumFile& infile);
 		bool  run                      (const string& indata, ostream& out);
 		bool  run                      (HumdrumFile& infile, ostream& out);
+		bool  run                      (HumdrumLineStream& instream);
+		bool  isLineStreamable         (void);
 
 	protected:
 		void  initialize               (HumdrumFile& infile);
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Mon Dec  5 23:09:00 PST 2016
-// Last Modified: Mon Dec  5 23:09:08 PST 2016
+// Last Modified: Sun Oct 18 22:20:47 PDT 2026 Use HumKeyFinder for --auto analysis
 // Filename:      tool-transpose.h
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/tool-transpose.h
 // Syntax:        C++11; humlib
@@ -59,14 +59,7 @@ class Tool_transpose : public HumTool {
 		void     printHumdrumDataRecord (HumdrumLine& record,
 		                                 vector<bool>& spineprocess);
 
-		double   pearsonCorrelation     (int size, double* x, double* y);
 		void     doAutoTransposeAnalysis(HumdrumFile& infile);
-		void     addToHistogramDouble   (vector<vector<double> >& histogram,
-		                                 int pc, double start, double dur,
-		                                 double tdur, int segments);
-		double   storeHistogramForTrack (vector<vector<double> >& histogram,
-		                                 HumdrumFile& infile, int track,
-		                                 int segments);
 		void     printHistograms        (int segments, vector<int> ktracks,
 		                                vector<vector<vector<double> > >&
 		                                 trackhist);
@@ -75,28 +68,8 @@ class Tool_transpose : public HumTool {
 		                                 int segments, vector<int>& ktracks,
 		                                 vector<vector<vector<double> > >&
 		                                 trackhist);
-		void     doTrackKeyAnalysis     (vector<vector<double> >& analysis,
-		                                 int level, int hop, int count,
-		                                 vector<vector<double> >& trackhist,
-		                                 vector<double>& majorweights,
-		                                 vector<double>& minorweights);
-		void     identifyKeyDouble      (vector<double>& correls,
-		                                 vector<double>& histogram,
-		                                 vector<double>& majorweights,
-		                                 vector<double>& minorweights);
-		void     fillWeightsWithKostkaPayne(vector<double>& maj,
-		                                 vector<double>& min);
 		void     printRawTrackAnalysis  (vector<vector<vector<double> > >&
 		                                 analysis, vector<int>& ktracks);
-		void     doSingleAnalysis       (vector<double>& analysis,
-		                                 int startindex, int length,
-		                                 vector<vector<double> >& trackhist,
-		                                 vector<double>& majorweights,
-		                                 vector<double>& minorweights);
-		void     identifyKey            (vector<double>& correls,
-		                                 vector<double>& histogram,
-		                                 vector<double>& majorweights,
-		                                 vector<double>& minorweights);
 		void     doTranspositionAnalysis(vector<vector<vector<double> > >&
 		                                 analysis);
 		int      calculateTranspositionFromKey(int targetkey,
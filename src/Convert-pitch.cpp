@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sat Aug  8 12:24:49 PDT 2015
-// Last Modified: Wed Aug 19 00:06:39 PDT 2015
+// Last Modified: Sun Oct 18 21:02:15 PDT 2026 Single-pass and batch kern pitch conversions
 // Filename:      Convert-pitch.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/Convert-pitch.cpp
 // Syntax:        C++11; humlib
@@ -233,12 +233,11 @@ int Convert::kernToBase40PC(const string& kerndata) {
 //
 
 int Convert::kernToBase40(const string& kerndata) {
-	int pc = Convert::kernToBase40PC(kerndata);
-	if (pc < 0) {
-		return pc;
-	}
-	int octave   = Convert::kernToOctaveNumber(kerndata);
-	return pc + 40 * octave;
+	int diatonic;
+	int accid;
+	int octave;
+	Convert::kernToPitchParts(kerndata.data(), kerndata.size(), diatonic, accid, octave);
+	return Convert::pitchPartsToBase40(diatonic, accid, octave);
 }
 
 
@@ -279,9 +278,11 @@ int Convert::kernToBase12PC(const string& kerndata) {
 //
 
 int Convert::kernToBase12(const string& kerndata) {
-	int pc = Convert::kernToBase12PC(kerndata);
-	int octave = Convert::kernToOctaveNumber(kerndata);
-	return pc + 12 * octave;
+	int diatonic;
+	int accid;
+	int octave;
+	Convert::kernToPitchParts(kerndata.data(), kerndata.size(), diatonic, accid, octave);
+	return Convert::pitchPartsToBase12(diatonic, accid, octave);
 }
 
 
@@ -475,9 +476,11 @@ int Convert::base40ToAccidental(int b40) {
 //
 
 int Convert::kernToMidiNoteNumber(const string& kerndata) {
-	int pc = Convert::kernToBase12PC(kerndata);
-	int octave = Convert::kernToOctaveNumber(kerndata);
-	return pc + 12 * (octave + 1);
+	int diatonic;
+	int accid;
+	int octave;
+	Convert::kernToPitchParts(kerndata.data(), kerndata.size(), diatonic, accid, octave);
+	return Convert::pitchPartsToBase12(diatonic, accid, octave) + 12;
 }
 
 
@@ -489,12 +492,211 @@ int Convert::kernToMidiNoteNumber(const string& kerndata) {
 //
 
 int Convert::kernToBase7(const string& kerndata) {
-	int diatonic = Convert::kernToDiatonicPC(kerndata);
+	int diatonic;
+	int accid;
+	int octave;
+	Convert::kernToPitchParts(kerndata.data(), kerndata.size(), diatonic, accid, octave);
+	return Convert::pitchPartsToBase7(diatonic, octave);
+}
+
+
+
+//////////////////////////////
+//
+// Convert::kernToPitchParts -- Extract the diatonic pitch class, accidental
+//    count and octave number from the first subtoken of a **kern token
+//    in a single pass.  The values are the same as those returned by
+//    kernToDiatonicPC(), kernToAccidentalCount() and kernToOctaveNumber().
+//
+
+void Convert::kernToPitchParts(const char* kerndata, size_t size,
+		int& diatonic, int& accidental, int& octave) {
+	// Character classes: the lower three bits store the diatonic pitch
+	// class plus one for the letters A-G and a-g.
+	enum {
+		PITCH_MASK = 0x07,
+		UPPER      = 0x08,
+		LOWER      = 0x10,
+		SHARP      = 0x20,
+		FLAT       = 0x40,
+		REST       = 0x80,
+		SPACE      = 0x100
+	};
+	struct CharTable {
+		unsigned short value[256];
+		CharTable(void) {
+			const char* letters = "CDEFGAB";
+			for (int i=0; i<256; i++) {
+				value[i] = 0;
+			}
+			for (int i=0; i<7; i++) {
+				value[(unsigned char)letters[i]] = UPPER | (i + 1);
+				value[(unsigned char)tolower(letters[i])] = LOWER | (i + 1);
+			}
+			value[(unsigned char)'#'] = SHARP;
+			value[(unsigned char)'-'] = FLAT;
+			value[(unsigned char)'r'] = REST;
+			value[(unsigned char)' '] = SPACE;
+		}
+	};
+	static const CharTable table;
+
+	diatonic = -2000;
+	accidental = 0;
+	int uc = 0;
+	int lc = 0;
+	bool restQ = false;
+	for (size_t i=0; i<size; i++) {
+		unsigned short cls = table.value[(unsigned char)kerndata[i]];
+		if (cls == 0) {
+			continue;
+		}
+		if (cls & SPACE) {
+			break;
+		}
+		if (cls & REST) {
+			restQ = true;
+			if (diatonic == -2000) {
+				diatonic = -1000;
+			}
+			continue;
+		}
+		accidental += (cls & SHARP) ? 1 : 0;
+		accidental -= (cls & FLAT) ? 1 : 0;
+		uc += (cls & UPPER) ? 1 : 0;
+		lc += (cls & LOWER) ? 1 : 0;
+		if ((diatonic == -2000) && (cls & PITCH_MASK)) {
+			diatonic = (cls & PITCH_MASK) - 1;
+		}
+	}
+
+	if (restQ || ((uc > 0) && (lc > 0))) {
+		octave = -1000;
+	} else if (uc > 0) {
+		octave = 4 - uc;
+	} else if (lc > 0) {
+		octave = 3 + lc;
+	} else {
+		octave = -1000;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// Convert::pitchPartsToBase40 -- Convert the output of kernToPitchParts()
+//    into a base-40 pitch (see kernToBase40()).
+//
+
+int Convert::pitchPartsToBase40(int diatonic, int accidental, int octave) {
 	if (diatonic < 0) {
 		return diatonic;
 	}
-	int octave = Convert::kernToOctaveNumber(kerndata);
-	return diatonic + 7 * octave;;
+	static const int pcs[7] = { 0, 6, 12, 17, 23, 29, 35 };
+	// +2 to make c-flat-flat bottom of octave.
+	return pcs[diatonic] + accidental + 2 + 40 * octave;
+}
+
+
+
+//////////////////////////////
+//
+// Convert::pitchPartsToBase12 -- Convert the output of kernToPitchParts()
+//    into a base-12 pitch (see kernToBase12()).
+//
+
+int Convert::pitchPartsToBase12(int diatonic, int accidental, int octave) {
+	static const int pcs[7] = { 0, 2, 4, 5, 7, 9, 11 };
+	int pc = diatonic < 0 ? diatonic : pcs[diatonic] + accidental;
+	return pc + 12 * octave;
+}
+
+
+
+//////////////////////////////
+//
+// Convert::pitchPartsToBase7 -- Convert the output of kernToPitchParts()
+//    into a base-7 pitch (see kernToBase7()).
+//
+
+int Convert::pitchPartsToBase7(int diatonic, int octave) {
+	if (diatonic < 0) {
+		return diatonic;
+	}
+	return diatonic + 7 * octave;
+}
+
+
+
+//////////////////////////////
+//
+// Convert::kernToPitchNumbers -- Convert a list of **kern tokens into
+//    base-40, base-12, base-7 and/or MIDI note numbers.  Each output
+//    list which is not NULL is resized to the number of tokens.  The
+//    values are the same as kernToBase40(), kernToBase12(), kernToBase7()
+//    and kernToMidiNoteNumber() for each token, but each token is only
+//    scanned once for all of the outputs.
+//
+
+void Convert::kernToPitchNumbers(const vector<string>& tokens,
+		vector<int>* base40, vector<int>* base12, vector<int>* base7,
+		vector<int>* midi) {
+	if (base40) { base40->resize(tokens.size()); }
+	if (base12) { base12->resize(tokens.size()); }
+	if (base7)  { base7->resize(tokens.size());  }
+	if (midi)   { midi->resize(tokens.size());   }
+	for (int i=0; i<(int)tokens.size(); i++) {
+		Convert::storePitchNumbers(i, tokens[i].data(), tokens[i].size(),
+				base40, base12, base7, midi);
+	}
+}
+
+
+void Convert::kernToPitchNumbers(const vector<HTp>& tokens,
+		vector<int>* base40, vector<int>* base12, vector<int>* base7,
+		vector<int>* midi) {
+	if (base40) { base40->resize(tokens.size()); }
+	if (base12) { base12->resize(tokens.size()); }
+	if (base7)  { base7->resize(tokens.size());  }
+	if (midi)   { midi->resize(tokens.size());   }
+	for (int i=0; i<(int)tokens.size(); i++) {
+		const string& text = *tokens[i];
+		Convert::storePitchNumbers(i, text.data(), text.size(),
+				base40, base12, base7, midi);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// Convert::storePitchNumbers -- Store the pitch numbers of one token
+//     for kernToPitchNumbers().
+//
+
+void Convert::storePitchNumbers(int index, const char* kerndata, size_t size,
+		vector<int>* base40, vector<int>* base12, vector<int>* base7,
+		vector<int>* midi) {
+	int diatonic;
+	int accid;
+	int octave;
+	Convert::kernToPitchParts(kerndata, size, diatonic, accid, octave);
+	if (base40) {
+		(*base40)[index] = Convert::pitchPartsToBase40(diatonic, accid, octave);
+	}
+	if (base12 || midi) {
+		int b12 = Convert::pitchPartsToBase12(diatonic, accid, octave);
+		if (base12) {
+			(*base12)[index] = b12;
+		}
+		if (midi) {
+			(*midi)[index] = b12 + 12;
+		}
+	}
+	if (base7) {
+		(*base7)[index] = Convert::pitchPartsToBase7(diatonic, octave);
+	}
 }
 
 
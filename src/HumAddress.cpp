@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sat Aug  8 12:24:49 PDT 2015
-// Last Modified: Sun Aug  9 21:03:12 PDT 2015
+// Last Modified: Sun Oct 18 16:21:05 PDT 2026 Interned spine info
 // Filename:      HumAddress.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/HumAddress.cpp
 // Syntax:        C++11; humlib
@@ -11,6 +11,7 @@
 //
 
 #include "HumAddress.h"
+#include "HumdrumFile.h"
 #include "HumdrumLine.h"
 
 using namespace std;
@@ -19,6 +20,10 @@ namespace hum {
 
 // START_MERGE
 
+mutex                     HumAddress::m_sharedmutex;
+unordered_map<string, int> HumAddress::m_sharedids;
+vector<const string*>     HumAddress::m_sharedinfo;
+
 
 //////////////////////////////
 //
@@ -30,6 +35,7 @@ HumAddress::HumAddress(void) {
 	m_subtrack      = -1;
 	m_subtrackcount = 0;
 	m_fieldindex    = -1;
+	m_spining       = -1;
 	m_owner         = NULL;
 }
 
@@ -39,8 +45,14 @@ HumAddress::HumAddress(HumAddress& address) {
 	m_track         = address.m_track;
 	m_subtrack      = address.m_subtrack;
 	m_subtrackcount = address.m_subtrackcount;
-	m_spining       = address.m_spining;
 	m_owner         = address.m_owner;
+	if (address.m_spining >= 0) {
+		// The copy may be given to a line in another file, so store
+		// the spine info in the shared table.
+		m_spining = internSpineInfo(address.getSpineInfo());
+	} else {
+		m_spining = address.m_spining;
+	}
 }
 
 
@@ -70,8 +82,12 @@ HumAddress& HumAddress::operator=(const HumAddress& address) {
 	m_track         = address.m_track;
 	m_subtrack      = address.m_subtrack;
 	m_subtrackcount = address.m_subtrackcount;
-	m_spining       = address.m_spining;
 	m_owner         = address.m_owner;
+	if (address.m_spining >= 0) {
+		m_spining = internSpineInfo(address.getSpineInfo());
+	} else {
+		m_spining = address.m_spining;
+	}
 	return *this;
 }
 
@@ -137,6 +153,25 @@ const HumdrumToken& HumAddress::getDataType(void) const {
 
 
 
+//////////////////////////////
+//
+// HumAddress::getDataTypeId -- Return the interned ID of the exclusive
+//    interpretation of the token's track in the owning file (see
+//    HumdrumFileBase::getTrackDataTypeId()).  **kern and **mens spines
+//    have the fixed IDs DATATYPE_KERN and DATATYPE_MENS.  Returns
+//    DATATYPE_NONE if the token is not owned by a file.
+//
+
+int HumAddress::getDataTypeId(void) const {
+	HumdrumFileBase* file = getOwnerFile();
+	if (file == NULL) {
+		return DATATYPE_NONE;
+	}
+	return file->getTrackDataTypeId(m_track);
+}
+
+
+
 //////////////////////////////
 //
 // HumAddress::getSpineInfo -- Return the spine information for the token
@@ -149,11 +184,63 @@ const HumdrumToken& HumAddress::getDataType(void) const {
 //
 
 const string& HumAddress::getSpineInfo(void) const {
+	static const string empty;
+	if (m_spining >= 0) {
+		HumdrumFileBase* file = getOwnerFile();
+		if (file == NULL) {
+			return empty;
+		}
+		return file->getSpineInfoString(m_spining);
+	} else if (m_spining == -1) {
+		return empty;
+	}
+	return getInternedSpineInfo(m_spining);
+}
+
+
+
+//////////////////////////////
+//
+// HumAddress::getSpineInfoId -- Return the ID of the spine info string.
+//     IDs which are zero or positive index the spine info table of the
+//     owning file, so tokens in the same file have the same spine info
+//     if their IDs are equal.  -1 means that there is no spine info.
+//
+
+int HumAddress::getSpineInfoId(void) const {
 	return m_spining;
 }
 
 
 
+//////////////////////////////
+//
+// HumAddress::getTrackFromSpineInfo -- Return the track number of a spine
+//     info string, which is the first number in the string.  Returns 0 if
+//     there is no number.
+//
+
+int HumAddress::getTrackFromSpineInfo(const string& spineinfo) {
+	int track = 0;
+	for (int j=0; j<(int)spineinfo.size(); j++) {
+		if (!isdigit(spineinfo[j])) {
+			continue;
+		}
+		track = spineinfo[j] - '0';
+		for (int k=j+1; k<(int)spineinfo.size(); k++) {
+			if (isdigit(spineinfo[k])) {
+				track = track * 10 + (spineinfo[k] - '0');
+			} else {
+				break;
+			}
+		}
+		break;
+	}
+	return track;
+}
+
+
+
 //////////////////////////////
 //
 // HumAddress::getTrack -- The track number of the given spine.  This is the
@@ -261,6 +348,21 @@ bool HumAddress::hasOwner(void) const {
 
 
 
+//////////////////////////////
+//
+// HumAddress::getOwnerFile -- Return the file which owns the line of the
+//    token, or NULL if there is none.
+//
+
+HumdrumFileBase* HumAddress::getOwnerFile(void) const {
+	if (m_owner == NULL) {
+		return NULL;
+	}
+	return m_owner->getOwner();
+}
+
+
+
 //////////////////////////////
 //
 // HumAddress::setFieldIndex -- Set the field index of associated token
@@ -284,7 +386,59 @@ void HumAddress::setFieldIndex(int index) {
 //
 
 void HumAddress::setSpineInfo(const string& spineinfo) {
-	m_spining = spineinfo;
+	HumdrumFileBase* file = getOwnerFile();
+	if (file == NULL) {
+		m_spining = internSpineInfo(spineinfo);
+	} else {
+		m_spining = file->internSpineInfo(spineinfo);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumAddress::setSpineInfoId -- Set the spine info from an ID in the
+//     spine info table of the owning file (see
+//     HumdrumFileBase::internSpineInfo()).
+//
+
+void HumAddress::setSpineInfoId(int id) {
+	m_spining = id;
+}
+
+
+
+//////////////////////////////
+//
+// HumAddress::internSpineInfo -- Store a spine info string in the table
+//     shared by addresses which are not owned by a file.  Returns the
+//     (negative) ID of the string.
+//
+
+int HumAddress::internSpineInfo(const string& spineinfo) {
+	lock_guard<mutex> lock(m_sharedmutex);
+	auto it = m_sharedids.find(spineinfo);
+	if (it != m_sharedids.end()) {
+		return it->second;
+	}
+	int id = -2 - (int)m_sharedinfo.size();
+	auto entry = m_sharedids.emplace(spineinfo, id).first;
+	m_sharedinfo.push_back(&entry->first);
+	return id;
+}
+
+
+
+//////////////////////////////
+//
+// HumAddress::getInternedSpineInfo -- Return the string for an ID in the
+//     shared spine info table.
+//
+
+const string& HumAddress::getInternedSpineInfo(int id) {
+	lock_guard<mutex> lock(m_sharedmutex);
+	return *m_sharedinfo.at(-2 - id);
 }
 
 
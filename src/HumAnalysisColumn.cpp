@@ -0,0 +1,455 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 16:52:31 PDT 2026
+// Last Modified: Sun Oct 18 16:52:34 PDT 2026
+// Filename:      HumAnalysisColumn.cpp
+// URL:           https://github.com/craigsapp/humlib/blob/master/src/HumAnalysisColumn.cpp
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   Typed column of analysis results, with one value for
+//                each line of a Humdrum file.
+//
+
+#include "HumAnalysisColumn.h"
+
+#include <cstdint>
+#include <sstream>
+
+using namespace std;
+
+namespace hum {
+
+// START_MERGE
+
+//////////////////////////////
+//
+// HumAnalysisColumn::HumAnalysisColumn -- Constructor.
+//
+
+HumAnalysisColumn::HumAnalysisColumn(void) {
+	m_type = COLUMN_STRING;
+	m_inserttrack = 0;
+}
+
+
+HumAnalysisColumn::HumAnalysisColumn(const string& exinterp, int type,
+		int linecount) {
+	m_type = type;
+	m_inserttrack = 0;
+	setExInterp(exinterp);
+	setLineCount(linecount);
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisColumn::~HumAnalysisColumn -- Deconstructor.
+//
+
+HumAnalysisColumn::~HumAnalysisColumn() {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisColumn::clear -- Set all values in the column to null.
+//
+
+void HumAnalysisColumn::clear(void) {
+	int linecount = getLineCount();
+	m_ints.clear();
+	m_doubles.clear();
+	m_strings.clear();
+	m_null.clear();
+	setLineCount(linecount);
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisColumn::setLineCount -- Set the number of lines in the
+//     column.  New lines are set to null.
+//
+
+void HumAnalysisColumn::setLineCount(int linecount) {
+	if (linecount < 0) {
+		linecount = 0;
+	}
+	switch (m_type) {
+		case COLUMN_INT:    m_ints.resize(linecount, 0);    break;
+		case COLUMN_DOUBLE: m_doubles.resize(linecount, 0); break;
+		default:            m_strings.resize(linecount);    break;
+	}
+	m_null.resize(linecount, 1);
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisColumn::getLineCount -- Return the number of lines in the
+//     column.
+//
+
+int HumAnalysisColumn::getLineCount(void) const {
+	return (int)m_null.size();
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisColumn::getType -- Return the data type of the column:
+//     COLUMN_INT, COLUMN_DOUBLE or COLUMN_STRING.
+//
+
+int HumAnalysisColumn::getType(void) const {
+	return m_type;
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisColumn::getExInterp -- Return the exclusive interpretation
+//     which is used when rendering the column as a spine.
+//
+
+const string& HumAnalysisColumn::getExInterp(void) const {
+	return m_exinterp;
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisColumn::setExInterp -- Set the exclusive interpretation of
+//     the column.  "**" will be added if not present, and "**data" is
+//     used for an empty string (similar to appendDataSpine()).
+//
+
+void HumAnalysisColumn::setExInterp(const string& exinterp) {
+	if (exinterp.compare(0, 2, "**") == 0) {
+		m_exinterp = exinterp;
+	} else if (exinterp.compare(0, 1, "*") == 0) {
+		m_exinterp = "*" + exinterp;
+	} else {
+		m_exinterp = "**" + exinterp;
+	}
+	if (m_exinterp.size() <= 2) {
+		m_exinterp += "data";
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisColumn::getName -- Return the label of the column.  This
+//     is the exclusive interpretation without "**" unless it has been
+//     set explicitly.
+//
+
+string HumAnalysisColumn::getName(void) const {
+	if (m_name.empty()) {
+		return m_exinterp.substr(2);
+	}
+	return m_name;
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisColumn::setName -- Set the label of the column.
+//
+
+void HumAnalysisColumn::setName(const string& name) {
+	m_name = name;
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisColumn::getInsertTrack -- Return the track before which
+//     the column will be rendered as a spine.  0 means after the last
+//     spine and -1 means before the first spine.
+//
+
+int HumAnalysisColumn::getInsertTrack(void) const {
+	return m_inserttrack;
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisColumn::setInsertTrack -- Set the track before which the
+//     column will be rendered as a spine.
+//
+
+void HumAnalysisColumn::setInsertTrack(int track) {
+	m_inserttrack = track;
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisColumn::isNull -- Return true if the line has no value.
+//
+
+bool HumAnalysisColumn::isNull(int lineindex) const {
+	return m_null.at(lineindex) != 0;
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisColumn::setNull -- Remove the value for a line.
+//
+
+void HumAnalysisColumn::setNull(int lineindex) {
+	m_null.at(lineindex) = 1;
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisColumn::setValue -- Set the value for a line.  The value
+//     is converted to the data type of the column if necessary.
+//
+
+void HumAnalysisColumn::setValue(int lineindex, int value) {
+	switch (m_type) {
+		case COLUMN_INT:    m_ints.at(lineindex) = value;              break;
+		case COLUMN_DOUBLE: m_doubles.at(lineindex) = value;           break;
+		default:            m_strings.at(lineindex) = to_string(value); break;
+	}
+	m_null.at(lineindex) = 0;
+}
+
+
+void HumAnalysisColumn::setValue(int lineindex, double value) {
+	switch (m_type) {
+		case COLUMN_INT:
+			m_ints.at(lineindex) = (int)value;
+			break;
+		case COLUMN_DOUBLE:
+			m_doubles.at(lineindex) = value;
+			break;
+		default:
+			{
+				stringstream ss;
+				ss << value;
+				m_strings.at(lineindex) = ss.str();
+			}
+			break;
+	}
+	m_null.at(lineindex) = 0;
+}
+
+
+void HumAnalysisColumn::setValue(int lineindex, const string& value) {
+	switch (m_type) {
+		case COLUMN_INT:    m_ints.at(lineindex) = stoi(value);    break;
+		case COLUMN_DOUBLE: m_doubles.at(lineindex) = stod(value); break;
+		default:            m_strings.at(lineindex) = value;       break;
+	}
+	m_null.at(lineindex) = 0;
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisColumn::getInt -- Return the value of a line in an integer
+//     column.  Returns 0 for null lines or other column types.
+//
+
+int HumAnalysisColumn::getInt(int lineindex) const {
+	if ((m_type != COLUMN_INT) || isNull(lineindex)) {
+		return 0;
+	}
+	return m_ints[lineindex];
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisColumn::getDouble -- Return the value of a line in a numeric
+//     column.  Returns 0.0 for null lines or string columns.
+//
+
+double HumAnalysisColumn::getDouble(int lineindex) const {
+	if (isNull(lineindex)) {
+		return 0.0;
+	}
+	switch (m_type) {
+		case COLUMN_INT:    return m_ints[lineindex];
+		case COLUMN_DOUBLE: return m_doubles[lineindex];
+	}
+	return 0.0;
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisColumn::getString -- Return the value of a line in a string
+//     column.  Returns an empty string for null lines or other column types.
+//
+
+const string& HumAnalysisColumn::getString(int lineindex) const {
+	static const string empty;
+	if ((m_type != COLUMN_STRING) || isNull(lineindex)) {
+		return empty;
+	}
+	return m_strings[lineindex];
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisColumn::getText -- Return the value of a line as text,
+//     formatted in the same way as when printing to an ostream.  Null
+//     lines return an empty string.
+//
+
+string HumAnalysisColumn::getText(int lineindex) const {
+	if (isNull(lineindex)) {
+		return "";
+	}
+	switch (m_type) {
+		case COLUMN_INT:
+			return to_string(m_ints[lineindex]);
+		case COLUMN_DOUBLE:
+			{
+				stringstream ss;
+				ss << m_doubles[lineindex];
+				return ss.str();
+			}
+	}
+	return m_strings[lineindex];
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisColumn::setData -- Store the values for all lines in the
+//     column.  Values which are equal to the null string when printed
+//     (or are empty strings) are stored as null, which is the same
+//     convention used by HumdrumFileContent::appendDataSpine().
+//
+
+void HumAnalysisColumn::setData(const vector<int>& data, const string& null) {
+	setLineCount((int)data.size());
+	for (int i=0; i<(int)data.size(); i++) {
+		setValue(i, data[i]);
+		checkNull(i, null);
+	}
+}
+
+
+void HumAnalysisColumn::setData(const vector<double>& data, const string& null) {
+	setLineCount((int)data.size());
+	for (int i=0; i<(int)data.size(); i++) {
+		setValue(i, data[i]);
+		checkNull(i, null);
+	}
+}
+
+
+void HumAnalysisColumn::setData(const vector<string>& data, const string& null) {
+	setLineCount((int)data.size());
+	for (int i=0; i<(int)data.size(); i++) {
+		if (data[i].empty() || (data[i] == null)) {
+			m_null[i] = 1;
+		} else {
+			setValue(i, data[i]);
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisColumn::checkNull -- Set a line to null if its printed value
+//     matches the null string.
+//
+
+void HumAnalysisColumn::checkNull(int lineindex, const string& null) {
+	if (null.empty()) {
+		return;
+	}
+	if (getText(lineindex) == null) {
+		m_null[lineindex] = 1;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisColumn::writeBinary -- Write the column in binary form.  All
+//     integers are 32-bit and all values are in the native byte order:
+//        type, insert track, name length, name characters,
+//        exinterp length, exinterp characters, line count,
+//        null flags (one byte per line),
+//        values: int32 or float64 for each line, or for string columns
+//        a length followed by the characters for each line.
+//
+
+ostream& HumAnalysisColumn::writeBinary(ostream& out) const {
+	auto writeInt = [&out](int32_t value) {
+		out.write((const char*)&value, sizeof(value));
+	};
+	auto writeString = [&](const string& value) {
+		writeInt((int32_t)value.size());
+		out.write(value.data(), value.size());
+	};
+
+	writeInt(m_type);
+	writeInt(m_inserttrack);
+	writeString(getName());
+	writeString(m_exinterp);
+	int linecount = getLineCount();
+	writeInt(linecount);
+	out.write(m_null.data(), m_null.size());
+	switch (m_type) {
+		case COLUMN_INT:
+			for (int i=0; i<linecount; i++) {
+				writeInt(m_ints[i]);
+			}
+			break;
+		case COLUMN_DOUBLE:
+			out.write((const char*)m_doubles.data(), linecount * sizeof(double));
+			break;
+		default:
+			for (int i=0; i<linecount; i++) {
+				writeString(m_strings[i]);
+			}
+			break;
+	}
+	return out;
+}
+
+
+// END_MERGE
+
+} // end namespace hum
+
+
+
@@ -1,7 +1,8 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sun Oct 16 16:08:05 PDT 2016
-// Last Modified: Tue Nov  8 19:59:10 PST 2016
+// Last Modified: Sun Oct 18 23:41:05 PDT 2026 Added clear()
+// Last Modified: Mon Oct 19 06:31:05 PDT 2026 Added freePoolMemory()
 // Filename:      HumGrid.cpp
 // URL:           https://github.com/craigsapp/hum2ly/blob/master/src/HumGrid.cpp
 // Syntax:        C++11; humlib
@@ -32,19 +33,7 @@ namespace hum {
 //
 
 HumGrid::HumGrid(void) {
-	// Limited to 100 parts:
-	m_verseCount.resize(100);
-	m_harmonyCount.resize(100);
-	m_dynamics.resize(100);
-	m_figured_bass.resize(100);
-	fill(m_dynamics.begin(), m_dynamics.end(), false);
-	fill(m_figured_bass.begin(), m_figured_bass.end(), false);
-	fill(m_harmonyCount.begin(), m_harmonyCount.end(), 0);
-
-	// default options
-	m_musicxmlbarlines = false;
-	m_recip = false;
-	m_pickup = false;
+	clear();
 }
 
 
@@ -64,6 +53,36 @@ HumGrid::~HumGrid(void) {
 
 
 
+//////////////////////////////
+//
+// HumGrid::clear -- Delete the measures and reset the part information
+//     and options, so that the grid can be reused for another score.
+//
+
+void HumGrid::clear(void) {
+	for (int i=0; i<(int)this->size(); i++) {
+		if (this->at(i)) {
+			delete this->at(i);
+		}
+	}
+	std::vector<GridMeasure*>::clear();
+	m_allslices.clear();
+
+	// Limited to 100 parts:
+	m_verseCount.assign(100, std::vector<int>());
+	m_harmonyCount.assign(100, 0);
+	m_dynamics.assign(100, false);
+	m_figured_bass.assign(100, false);
+	m_harmony.clear();
+
+	// default options
+	m_musicxmlbarlines = false;
+	m_recip = false;
+	m_pickup = false;
+}
+
+
+
 //////////////////////////////
 //
 // HumGrid::addMeasureToBack -- Allocate a GridMeasure at the end of the
@@ -2713,6 +2732,27 @@ void HumGrid::deleteMeasure(int index) {
 
 
 
+//////////////////////////////
+//
+// HumGrid::freePoolMemory -- Free the memory pools of the grid classes
+//     (see HumPool), such as after converting a large score in a
+//     long-running program.  This must only be called when no grids
+//     exist or are being created on other threads.  Returns false if
+//     some pool still had objects allocated from it, in which case that
+//     pool is kept.
+//
+
+bool HumGrid::freePoolMemory(void) {
+	bool status = true;
+	status &= HumPool<GridVoice>::clear();
+	status &= HumPool<GridStaff>::clear();
+	status &= HumPool<GridPart>::clear();
+	status &= HumPool<GridSlice>::clear();
+	return status;
+}
+
+
+
 //////////////////////////////
 //
 // operator<< -- Debugging printing of Humgrid Contents.
@@ -0,0 +1,362 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 22:05:31 PDT 2026
+// Last Modified: Sun Oct 18 22:05:34 PDT 2026
+// Filename:      HumKeyFinder.cpp
+// URL:           https://github.com/craigsapp/humlib/blob/master/src/HumKeyFinder.cpp
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   Key finding by correlation of pitch-class histograms with
+//                major/minor key profiles, for single histograms or for
+//                sliding windows over a sequence of histograms.
+//
+
+#include "HumKeyFinder.h"
+#include "Convert.h"
+
+#include <cmath>
+
+using namespace std;
+
+namespace hum {
+
+// START_MERGE
+
+//////////////////////////////
+//
+// HumKeyFinder::HumKeyFinder -- Constructor.  The Kostka-Payne
+//     profiles are used by default.
+//
+
+HumKeyFinder::HumKeyFinder(void) {
+	setProfile("kostka-payne");
+}
+
+
+
+//////////////////////////////
+//
+// HumKeyFinder::~HumKeyFinder -- Deconstructor.
+//
+
+HumKeyFinder::~HumKeyFinder() {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// HumKeyFinder::setProfile -- Select a set of key profiles by name:
+//     "kostka-payne" (David Temperley: Music and Probability 2006),
+//     "krumhansl-kessler" or "aarden-essen".  Returns false if the name
+//     is not known.
+//
+
+bool HumKeyFinder::setProfile(const string& name) {
+	if (name == "kostka-payne") {
+		setProfile(
+			{ 0.748, 0.060, 0.488, 0.082, 0.670, 0.460,
+			  0.096, 0.715, 0.104, 0.366, 0.057, 0.400 },
+			{ 0.712, 0.084, 0.474, 0.618, 0.049, 0.460,
+			  0.105, 0.747, 0.404, 0.067, 0.133, 0.330 });
+	} else if (name == "krumhansl-kessler") {
+		setProfile(
+			{ 6.35, 2.23, 3.48, 2.33, 4.38, 4.09,
+			  2.52, 5.19, 2.39, 3.66, 2.29, 2.88 },
+			{ 6.33, 2.68, 3.52, 5.38, 2.60, 3.53,
+			  2.54, 4.75, 3.98, 2.69, 3.34, 3.17 });
+	} else if (name == "aarden-essen") {
+		setProfile(
+			{ 17.7661, 0.145624, 14.9265, 0.160186, 19.8049, 11.3587,
+			  0.291248, 22.062, 0.145624, 8.15494, 0.232998, 4.95122 },
+			{ 18.2648, 0.737619, 14.0499, 16.8599, 0.702494, 14.4362,
+			  0.702494, 18.6161, 4.56621, 1.93186, 7.37619, 1.75623 });
+	} else {
+		return false;
+	}
+	return true;
+}
+
+
+//
+// Profiles are given for C major and C minor (index 0 = C, 1 = C#, etc.).
+//
+
+void HumKeyFinder::setProfile(const vector<double>& major,
+		const vector<double>& minor) {
+	for (int m=0; m<2; m++) {
+		const vector<double>& profile = m ? minor : major;
+		double mean = 0.0;
+		for (int i=0; i<12; i++) {
+			mean += profile.at(i);
+		}
+		mean /= 12.0;
+		double norm = 0.0;
+		for (int i=0; i<12; i++) {
+			norm += (profile[i] - mean) * (profile[i] - mean);
+		}
+		norm = sqrt(norm);
+		for (int tonic=0; tonic<12; tonic++) {
+			for (int i=0; i<12; i++) {
+				double value = profile[(i - tonic + 12) % 12] - mean;
+				m_kernels[m * 12 + tonic][i] = norm > 0.0 ? value / norm : 0.0;
+			}
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumKeyFinder::setHistograms -- Store a sequence of pitch-class
+//     histograms (such as one for each quarter note of a part) for use
+//     with analyzeWindow() and analyzeWindows().
+//
+
+void HumKeyFinder::setHistograms(const vector<vector<double>>& segments) {
+	m_prefix.assign((segments.size() + 1) * 12, 0.0);
+	for (int i=0; i<(int)segments.size(); i++) {
+		for (int k=0; k<12; k++) {
+			m_prefix[(i+1)*12 + k] = m_prefix[i*12 + k] + segments[i].at(k);
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumKeyFinder::getSegmentCount -- Return the number of histograms
+//     given to setHistograms().
+//
+
+int HumKeyFinder::getSegmentCount(void) const {
+	return m_prefix.empty() ? 0 : (int)m_prefix.size() / 12 - 1;
+}
+
+
+
+//////////////////////////////
+//
+// HumKeyFinder::getWindowHistogram -- Return the sum of the histograms
+//     for a range of segments.
+//
+
+void HumKeyFinder::getWindowHistogram(int start, int length,
+		vector<double>& histogram) const {
+	histogram.resize(12);
+	int count = getSegmentCount();
+	int end = start + length;
+	if (start < 0) {
+		start = 0;
+	}
+	if (end > count) {
+		end = count;
+	}
+	if (end <= start) {
+		fill(histogram.begin(), histogram.end(), 0.0);
+		return;
+	}
+	const double* first = &m_prefix[start * 12];
+	const double* last  = &m_prefix[end * 12];
+	for (int k=0; k<12; k++) {
+		histogram[k] = last[k] - first[k];
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumKeyFinder::analyzeHistogram -- Correlate a pitch-class histogram
+//     with the key profiles.  The output contains the 12 major key
+//     correlations (C, C#, ..., B), then the 12 minor key correlations,
+//     then the index of the best key (index 24) and the second best key
+//     (index 25), where minor keys are 12-23.  Returns the best key, or
+//     -1 if the histogram is empty (all values are set to -1 in that case).
+//
+
+int HumKeyFinder::analyzeHistogram(const vector<double>& histogram,
+		vector<double>& correls) const {
+	correls.resize(26);
+	double sum = 0.0;
+	double sumsq = 0.0;
+	for (int i=0; i<12; i++) {
+		sum += histogram[i];
+		sumsq += histogram[i] * histogram[i];
+	}
+	if (sum == 0.0) {
+		fill(correls.begin(), correls.end(), -1.0);
+		return -1;
+	}
+
+	// The kernels have a mean of zero, so the histogram does not need
+	// to be centered for the dot product.
+	double variance = sumsq - sum * sum / 12.0;
+	double scale = variance > 0.0 ? 1.0 / sqrt(variance) : 0.0;
+	for (int k=0; k<24; k++) {
+		const double* kernel = m_kernels[k];
+		double dot = 0.0;
+		for (int i=0; i<12; i++) {
+			dot += kernel[i] * histogram[i];
+		}
+		correls[k] = dot * scale;
+	}
+
+	int best = 0;
+	for (int k=1; k<24; k++) {
+		if (correls[k] > correls[best]) {
+			best = k;
+		}
+	}
+	int second = best == 0 ? 1 : 0;
+	for (int k=0; k<24; k++) {
+		if ((k != best) && (correls[k] > correls[second])) {
+			second = k;
+		}
+	}
+	correls[24] = best;
+	correls[25] = second;
+	return best;
+}
+
+
+
+//////////////////////////////
+//
+// HumKeyFinder::analyzeWindow -- Key analysis for the sum of the
+//     histograms in a range of segments.
+//
+
+int HumKeyFinder::analyzeWindow(int start, int length,
+		vector<double>& correls) const {
+	vector<double> histogram;
+	getWindowHistogram(start, length, histogram);
+	return analyzeHistogram(histogram, correls);
+}
+
+
+
+//////////////////////////////
+//
+// HumKeyFinder::analyzeWindows -- Key analyses for a sliding window of
+//     the given length which moves by hop segments.  At most count
+//     windows are analyzed (or all windows which fit into the segments
+//     if count is less than one).
+//
+
+void HumKeyFinder::analyzeWindows(int length, int hop, int count,
+		vector<vector<double>>& output) const {
+	output.clear();
+	if (hop < 1) {
+		hop = 1;
+	}
+	int segments = getSegmentCount();
+	vector<double> histogram;
+	for (int i=0; (count < 1) || (i < count); i++) {
+		int start = i * hop;
+		if (start + length > segments) {
+			break;
+		}
+		getWindowHistogram(start, length, histogram);
+		output.resize(output.size() + 1);
+		analyzeHistogram(histogram, output.back());
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumKeyFinder::getTrackHistograms -- Calculate pitch-class histograms
+//     weighted by duration for each **kern track in a file.  The score is
+//     divided into the given number of segments of equal duration.  The
+//     output is indexed by track number, and is empty for non-kern tracks.
+//
+
+void HumKeyFinder::getTrackHistograms(HumdrumFile& infile, int segments,
+		vector<vector<vector<double>>>& histograms) {
+	if (segments < 1) {
+		segments = 1;
+	}
+	histograms.clear();
+	histograms.resize(infile.getMaxTrack() + 1);
+	for (int t=1; t<=infile.getMaxTrack(); t++) {
+		if (infile.getTrackStart(t)->isKern()) {
+			histograms[t].assign(segments, vector<double>(12, 0.0));
+		}
+	}
+
+	double totalduration = infile.getScoreDuration().getFloat();
+	if (totalduration <= 0.0) {
+		return;
+	}
+	for (int i=0; i<infile.getLineCount(); i++) {
+		if (!infile[i].isData()) {
+			continue;
+		}
+		double start = infile[i].getDurationFromStart().getFloat();
+		for (int j=0; j<infile[i].getFieldCount(); j++) {
+			HTp token = infile.token(i, j);
+			if (!token->isKern() || token->isNull()) {
+				continue;
+			}
+			int scount = token->getSubtokenCount();
+			for (int k=0; k<scount; k++) {
+				string subtok = (scount == 1) ? (string)*token : token->getSubtoken(k);
+				int pitch = Convert::kernToMidiNoteNumber(subtok);
+				if (pitch < 0) {
+					continue;  // ignore rests or strange objects
+				}
+				double duration = Convert::recipToDuration(subtok).getFloat();
+				if (duration <= 0.0) {
+					continue;  // ignore grace notes and strange objects
+				}
+				addToHistogram(histograms[token->getTrack()], pitch % 12,
+						start, duration, totalduration);
+			}
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumKeyFinder::addToHistogram -- Add a note to the segments which it
+//     overlaps, weighted by the fraction of each segment it fills.
+//
+
+void HumKeyFinder::addToHistogram(vector<vector<double>>& histogram,
+		int pc, double start, double duration, double totalduration) {
+	int segments = (int)histogram.size();
+	double startseg = start / totalduration * segments;
+	int index = (int)startseg;
+	if (index >= segments) {
+		return;
+	}
+	double segdur = duration / totalduration * segments;
+	double startfrac = startseg - index;
+	if (segdur <= 1.0 - startfrac) {
+		histogram[index][pc] += segdur;
+		return;
+	}
+	histogram[index][pc] += 1.0 - startfrac;
+	segdur -= 1.0 - startfrac;
+	for (index++; (segdur > 0.0) && (index < segments); index++) {
+		double amount = segdur < 1.0 ? segdur : 1.0;
+		histogram[index][pc] += amount;
+		segdur -= amount;
+	}
+}
+
+
+// END_MERGE
+
+} // end namespace hum
+
+
+
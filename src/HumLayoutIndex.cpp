@@ -0,0 +1,229 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Mon Oct 19 03:04:18 PDT 2026
+// Last Modified: Mon Oct 19 03:04:21 PDT 2026
+// Filename:      HumLayoutIndex.cpp
+// URL:           https://github.com/craigsapp/humlib/blob/master/src/HumLayoutIndex.cpp
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   Resolved layout parameters (!LO: parameters) which are
+//                linked to a token.
+//
+
+#include "HumLayoutIndex.h"
+#include "HumParamSet.h"
+
+#include <stdexcept>
+
+using namespace std;
+
+namespace hum {
+
+// START_MERGE
+
+//////////////////////////////
+//
+// HumLayoutIndex::HumLayoutIndex -- Constructor.
+//
+
+HumLayoutIndex::HumLayoutIndex(void) {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// HumLayoutIndex::~HumLayoutIndex -- Deconstructor.
+//
+
+HumLayoutIndex::~HumLayoutIndex() {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// HumLayoutIndex::clear -- Remove all parameters from the index.
+//
+
+void HumLayoutIndex::clear(void) {
+	m_categories.clear();
+	m_version = -1;
+}
+
+
+
+//////////////////////////////
+//
+// HumLayoutIndex::addParameterSet -- Add the next parameter set which
+//     applies to the token.  Parameter sets must be added in the order
+//     of HumdrumToken::getLinkedParameter(index).  Sets which are not in
+//     the LO namespace are ignored.
+//
+
+void HumLayoutIndex::addParameterSet(HumParamSet& pset) {
+	if (pset.getNamespace1() != "LO") {
+		return;
+	}
+	Category& category = m_categories[pset.getNamespace2()];
+
+	// values: The last value of each key in the parameter set.
+	unordered_map<string, string> values;
+	for (int i=0; i<pset.getCount(); i++) {
+		const string& key = pset.getParameterName(i);
+		const string& value = pset.getParameterValue(i);
+		auto it = category.entries.find(key);
+		if (it == category.entries.end()) {
+			Entry& entry = category.entries[key];
+			entry.first = value;
+			// The key does not occur in the previous sets of the category:
+			for (int j=0; j<(int)category.history.size(); j++) {
+				addStep(entry, category.history[j], "");
+			}
+			entry.last = value;
+		} else {
+			it->second.last = value;
+		}
+		values[key] = value;
+		if (key == "n") {
+			category.n = value;
+		}
+	}
+
+	category.history.push_back(category.n);
+	for (auto& it : category.entries) {
+		auto found = values.find(it.first);
+		if (found == values.end()) {
+			addStep(it.second, category.n, "");
+		} else {
+			addStep(it.second, category.n, found->second);
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumLayoutIndex::addStep -- Add the value of a key in one parameter set
+//     to the note list of the key.  The value applies to the note given
+//     by the current @n value, or to all remaining notes if there is no
+//     @n value (if the value is not empty).  Values of earlier parameter
+//     sets have priority.  An @n value which is not a number does not
+//     apply to any note.
+//
+
+void HumLayoutIndex::addStep(Entry& entry, const string& n,
+		const string& value) {
+	if (entry.doneQ) {
+		return;
+	}
+	if (n.empty()) {
+		if (!value.empty()) {
+			entry.fallback = value;
+			entry.doneQ = true;
+		}
+		return;
+	}
+	// currently @n requires a single value (should allow a range or
+	// multiple values later).
+	int number;
+	try {
+		number = stoi(n);
+	} catch (std::invalid_argument&) {
+		return;
+	} catch (std::out_of_range&) {
+		return;
+	}
+	entry.notes.emplace(number - 1, value);
+}
+
+
+
+//////////////////////////////
+//
+// HumLayoutIndex::getValue -- Return the value of a layout parameter as
+//     in HumdrumToken::getLayoutParameter().  If subtokenindex is negative,
+//     the first value of the key is returned; otherwise the first value
+//     which applies to the given note in a chord.
+//
+
+const string& HumLayoutIndex::getValue(const string& category,
+		const string& keyname, int subtokenindex) const {
+	static const string empty;
+	auto cit = m_categories.find(category);
+	if (cit == m_categories.end()) {
+		return empty;
+	}
+	auto eit = cit->second.entries.find(keyname);
+	if (eit == cit->second.entries.end()) {
+		return empty;
+	}
+	const Entry& entry = eit->second;
+	if (subtokenindex < 0) {
+		return entry.first;
+	}
+	auto nit = entry.notes.find(subtokenindex);
+	if (nit != entry.notes.end()) {
+		return nit->second;
+	}
+	return entry.fallback;
+}
+
+
+
+//////////////////////////////
+//
+// HumLayoutIndex::getLastValue -- Return the last value of a key in the
+//     parameter sets of a category, or an empty string if the key is not
+//     found.
+//
+
+const string& HumLayoutIndex::getLastValue(const string& category,
+		const string& keyname) const {
+	static const string empty;
+	auto cit = m_categories.find(category);
+	if (cit == m_categories.end()) {
+		return empty;
+	}
+	auto eit = cit->second.entries.find(keyname);
+	if (eit == cit->second.entries.end()) {
+		return empty;
+	}
+	return eit->second.last;
+}
+
+
+
+//////////////////////////////
+//
+// HumLayoutIndex::getVersion -- Return the layout parameter version of
+//     the owning file when the index was built, or -1 if it has not
+//     been built.
+//
+
+int HumLayoutIndex::getVersion(void) const {
+	return m_version;
+}
+
+
+
+//////////////////////////////
+//
+// HumLayoutIndex::setVersion --
+//
+
+void HumLayoutIndex::setVersion(int version) {
+	m_version = version;
+}
+
+
+// END_MERGE
+
+} // end namespace hum
+
+
+
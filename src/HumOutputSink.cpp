@@ -0,0 +1,225 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 18:12:04 PDT 2026
+// Last Modified: Sun Oct 18 19:52:10 PDT 2026
+// Filename:      HumOutputSink.cpp
+// URL:           https://github.com/craigsapp/humlib/blob/master/src/HumOutputSink.cpp
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   Stream buffer which sends text directly to an output
+//                stream, a file descriptor or a caller-supplied writing
+//                function.
+//
+
+#include "HumOutputSink.h"
+
+#include <cerrno>
+
+#ifdef _WIN32
+	#include <io.h>
+#else
+	#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace hum {
+
+// START_MERGE
+
+//////////////////////////////
+//
+// HumOutputSink::HumOutputSink -- Constructor.  Text is collected
+//     in a 64 kB buffer before being sent to the writer.  The buffer is
+//     allocated when the first writer is set, since most tools never
+//     use the sink.
+//
+
+HumOutputSink::HumOutputSink(void) {
+	m_bytes = 0;
+}
+
+
+
+//////////////////////////////
+//
+// HumOutputSink::~HumOutputSink -- Deconstructor.  Any remaining
+//     text is sent to the writer.
+//
+
+HumOutputSink::~HumOutputSink() {
+	flush();
+}
+
+
+
+//////////////////////////////
+//
+// HumOutputSink::setWriter -- Send output to a function.  Any text
+//     for the previous writer is flushed first.
+//
+
+void HumOutputSink::setWriter(const Writer& writer) {
+	flush();
+	m_writer = writer;
+	if (m_buffer.empty()) {
+		m_buffer.resize(65536);
+		setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumOutputSink::setStream -- Send output to an ostream.  The stream
+//     must stay valid until the sink is cleared or destroyed.
+//
+
+void HumOutputSink::setStream(ostream& out) {
+	ostream* outp = &out;
+	setWriter([outp](const char* data, size_t size) {
+		outp->write(data, size);
+	});
+}
+
+
+
+//////////////////////////////
+//
+// HumOutputSink::setFileDescriptor -- Send output to an open file
+//     descriptor (such as 1 for standard output).  The file descriptor
+//     is not closed by the sink.
+//
+
+void HumOutputSink::setFileDescriptor(int fd) {
+	setWriter([fd](const char* data, size_t size) {
+		while (size > 0) {
+			#ifdef _WIN32
+				int count = _write(fd, data, (unsigned int)size);
+			#else
+				ssize_t count = ::write(fd, data, size);
+			#endif
+			if (count < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				return;
+			}
+			data += count;
+			size -= count;
+		}
+	});
+}
+
+
+
+//////////////////////////////
+//
+// HumOutputSink::clear -- Flush any remaining text and remove the writer.
+//
+
+void HumOutputSink::clear(void) {
+	flush();
+	m_writer = nullptr;
+}
+
+
+
+//////////////////////////////
+//
+// HumOutputSink::isActive -- Returns true if there is a writer.
+//
+
+bool HumOutputSink::isActive(void) const {
+	return (bool)m_writer;
+}
+
+
+
+//////////////////////////////
+//
+// HumOutputSink::flush -- Send any buffered text to the writer.
+//     Text written without a writer is discarded.  Returns false
+//     if there is no writer.
+//
+
+bool HumOutputSink::flush(void) {
+	size_t size = pptr() - pbase();
+	bool status = isActive();
+	if (size > 0) {
+		if (status) {
+			m_writer(pbase(), size);
+		}
+		m_bytes += size;
+		setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+	}
+	return status;
+}
+
+
+
+//////////////////////////////
+//
+// HumOutputSink::getByteCount -- Return the number of bytes written to
+//     the sink (including text which has not yet been flushed).
+//
+
+size_t HumOutputSink::getByteCount(void) const {
+	return m_bytes + (pptr() - pbase());
+}
+
+
+
+//////////////////////////////
+//
+// HumOutputSink::resetByteCount --
+//
+
+void HumOutputSink::resetByteCount(void) {
+	flush();
+	m_bytes = 0;
+}
+
+
+
+//////////////////////////////
+//
+// HumOutputSink::overflow -- Called when the buffer is full.
+//
+
+int HumOutputSink::overflow(int ch) {
+	flush();
+	if (m_buffer.empty()) {
+		// Text is discarded if a writer was never set.
+		return traits_type::not_eof(ch);
+	}
+	if (ch != traits_type::eof()) {
+		*pptr() = (char)ch;
+		pbump(1);
+	}
+	return traits_type::not_eof(ch);
+}
+
+
+
+//////////////////////////////
+//
+// HumOutputSink::sync -- Called when the ostream is flushed (such as
+//     by endl).  The text is kept in the buffer so that line-by-line
+//     output does not cause a write for each line: use flush() to send
+//     the text to the writer.
+//
+
+int HumOutputSink::sync(void) {
+	return 0;
+}
+
+
+// END_MERGE
+
+} // end namespace hum
+
+
+
@@ -0,0 +1,126 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 11:02:17 PDT 2026
+// Last Modified: Sun Oct 18 11:02:20 PDT 2026
+// Filename:      HumParallel.cpp
+// URL:           https://github.com/craigsapp/humlib/blob/master/src/HumParallel.cpp
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   Run independent jobs (such as the files in a corpus) on
+//                multiple threads.
+//
+
+#include "HumParallel.h"
+
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace hum {
+
+// START_MERGE
+
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+	#define HUMPARALLEL_SERIAL
+#endif
+
+
+//////////////////////////////
+//
+// HumParallel::getThreadCount -- Return the number of threads to use.
+//     If requested is positive, then that value will be returned;
+//     otherwise, the number of hardware threads is returned.
+//
+
+int HumParallel::getThreadCount(int requested) {
+#ifdef HUMPARALLEL_SERIAL
+	return 1;
+#else
+	if (requested > 0) {
+		return requested;
+	}
+	int count = (int)std::thread::hardware_concurrency();
+	return count > 0 ? count : 1;
+#endif
+}
+
+
+
+//////////////////////////////
+//
+// HumParallel::run -- Run job(i) for each i in the range [0, jobcount).
+//     Jobs are handed out to threadcount worker threads in increasing
+//     order, so each job must be independent of the others (store results
+//     into pre-sized vectors indexed by the job number).  If threadcount
+//     is zero, then the number of hardware threads will be used.  If a job
+//     throws an exception, the remaining jobs are skipped and the first
+//     exception is rethrown in the calling thread after all workers finish.
+//
+
+void HumParallel::run(int jobcount, int threadcount,
+		const std::function<void(int)>& job) {
+	if (jobcount <= 0) {
+		return;
+	}
+	threadcount = getThreadCount(threadcount);
+	if (threadcount > jobcount) {
+		threadcount = jobcount;
+	}
+	if (threadcount <= 1) {
+		for (int i=0; i<jobcount; i++) {
+			job(i);
+		}
+		return;
+	}
+
+#ifndef HUMPARALLEL_SERIAL
+	std::atomic<int> next(0);
+	std::atomic<bool> failed(false);
+	std::exception_ptr error = NULL;
+	std::mutex errormutex;
+
+	auto worker = [&](void) {
+		while (!failed) {
+			int index = next++;
+			if (index >= jobcount) {
+				break;
+			}
+			try {
+				job(index);
+			} catch (...) {
+				std::lock_guard<std::mutex> lock(errormutex);
+				if (!error) {
+					error = std::current_exception();
+				}
+				failed = true;
+			}
+		}
+	};
+
+	vector<std::thread> threads;
+	threads.reserve(threadcount - 1);
+	for (int i=1; i<threadcount; i++) {
+		threads.emplace_back(worker);
+	}
+	worker();
+	for (int i=0; i<(int)threads.size(); i++) {
+		threads[i].join();
+	}
+	if (error) {
+		std::rethrow_exception(error);
+	}
+#endif
+}
+
+
+// END_MERGE
+
+} // end namespace hum
+
+
+
@@ -1,6 +1,7 @@
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sat Dec  3 16:21:22 PST 2016
 // Last Modified: Tue Dec 13 03:09:32 PST 2016
+// Last Modified: Mon Oct 19 02:31:05 PDT 2026 Reuse compiled expressions
 // Filename:      HumRegex.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/HumRegex.cpp
 // Syntax:        C++11; humlib
@@ -48,7 +49,7 @@ HumRegex::HumRegex(const string& exp, const string& options) {
 		// explicitly set the default syntax
 		m_regexflags = std::regex_constants::ECMAScript;
 	}
-	m_regex = regex(exp, getTemporaryRegexFlags(options));
+	compileRegex(exp, getTemporaryRegexFlags(options));
 	m_searchflags = (std::regex_constants::match_flag_type)0;
 	m_searchflags = getTemporarySearchFlags(options);
 }
@@ -65,6 +66,27 @@ HumRegex::~HumRegex() {
 }
 
 
+//////////////////////////////
+//
+// HumRegex::compileRegex -- Set the regular expression to use for
+//     searching, matching or replacing.  The expression is compiled only
+//     if it or its flags are different from the previous expression, so
+//     that the same search can be repeated on many strings efficiently.
+//
+
+void HumRegex::compileRegex(const string& exp,
+		std::regex_constants::syntax_option_type flags) {
+	if (m_compiledQ && (flags == m_expressionflags) && (exp == m_expression)) {
+		return;
+	}
+	m_regex = regex(exp, flags);
+	m_expression = exp;
+	m_expressionflags = flags;
+	m_compiledQ = true;
+}
+
+
+
 ///////////////////////////////////////////////////////////////////////////
 //
 // option setting
@@ -150,7 +172,7 @@ void HumRegex::unsetGlobal(void) {
 //
 
 int HumRegex::search(const string& input, const string& exp) {
-	m_regex = regex(exp, m_regexflags);
+	compileRegex(exp, m_regexflags);
 	bool result = regex_search(input, m_matches, m_regex, m_searchflags);
 	if (!result) {
 		return 0;
@@ -165,7 +187,7 @@ int HumRegex::search(const string& input, const string& exp) {
 
 int HumRegex::search(const string& input, int startindex,
 		const string& exp) {
-	m_regex = regex(exp, m_regexflags);
+	compileRegex(exp, m_regexflags);
 	auto startit = input.begin() + startindex;
 	auto endit   = input.end();
 	bool result = regex_search(startit, endit, m_matches, m_regex, m_searchflags);
@@ -194,7 +216,7 @@ int HumRegex::search(string* input, int startindex, const string& exp) {
 
 int HumRegex::search(const string& input, const string& exp,
 		const string& options) {
-	m_regex = regex(exp, getTemporaryRegexFlags(options));
+	compileRegex(exp, getTemporaryRegexFlags(options));
 	bool result = regex_search(input, m_matches, m_regex, getTemporarySearchFlags(options));
 	if (!result) {
 		return 0;
@@ -208,7 +230,7 @@ int HumRegex::search(const string& input, const string& exp,
 
 int HumRegex::search(const string& input, int startindex, const string& exp,
 		const string& options) {
-	m_regex = regex(exp, getTemporaryRegexFlags(options));
+	compileRegex(exp, getTemporaryRegexFlags(options));
 	auto startit = input.begin() + startindex;
 	auto endit   = input.end();
 	bool result = regex_search(startit, endit, m_matches, m_regex, getTemporarySearchFlags(options));
@@ -373,14 +395,14 @@ int HumRegex::getMatchLength(int index) {
 //
 
 bool HumRegex::match(const string& input, const string& exp) {
-	m_regex = regex(exp, m_regexflags);
+	compileRegex(exp, m_regexflags);
 	return regex_match(input, m_regex, m_searchflags);
 }
 
 
 bool HumRegex::match(const string& input, const string& exp,
 		const string& options) {
-	m_regex = regex(exp, getTemporaryRegexFlags(options));
+	compileRegex(exp, getTemporaryRegexFlags(options));
 	return regex_match(input, m_regex, getTemporarySearchFlags(options));
 }
 
@@ -412,7 +434,7 @@ bool HumRegex::match(const string* input, const string& exp,
 
 string& HumRegex::replaceDestructive(string& input, const string& replacement,
 		const string& exp) {
-	m_regex = regex(exp, m_regexflags);
+	compileRegex(exp, m_regexflags);
 	input = regex_replace(input, m_regex, replacement, m_searchflags);
 	return input;
 }
@@ -429,7 +451,7 @@ string& HumRegex::replaceDestructive(string* input, const string& replacement,
 
 string& HumRegex::replaceDestructive(string& input, const string& replacement,
 		const string& exp, const string& options) {
-	m_regex = regex(exp, getTemporaryRegexFlags(options));
+	compileRegex(exp, getTemporaryRegexFlags(options));
 	input = regex_replace(input, m_regex, replacement, getTemporarySearchFlags(options));
 	return input;
 }
@@ -450,7 +472,7 @@ string& HumRegex::replaceDestructive (string* input, const string& replacement,
 
 string HumRegex::replaceCopy(const string& input, const string& replacement,
 		const string& exp) {
-	m_regex = regex(exp, m_regexflags);
+	compileRegex(exp, m_regexflags);
 	string output;
 	regex_replace(std::back_inserter(output), input.begin(),
 			input.end(), m_regex, replacement);
@@ -469,7 +491,7 @@ string HumRegex::replaceCopy(string* input, const string& replacement,
 
 string HumRegex::replaceCopy(const string& input, const string& exp,
 		const string& replacement, const string& options) {
-	m_regex = regex(exp, getTemporaryRegexFlags(options));
+	compileRegex(exp, getTemporaryRegexFlags(options));
 	string output;
 	regex_replace(std::back_inserter(output), input.begin(),
 			input.end(), m_regex, replacement, getTemporarySearchFlags(options));
@@ -0,0 +1,339 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 20:14:52 PDT 2026
+// Last Modified: Sun Oct 18 20:14:55 PDT 2026
+// Last Modified: Mon Oct 19 04:20:48 PDT 2026 Reload files changed on disk
+// Filename:      HumScoreCache.cpp
+// URL:           https://github.com/craigsapp/humlib/blob/master/src/HumScoreCache.cpp
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   Keep parsed Humdrum files in memory, removing the
+//                least-recently used files when the cache is full.
+//
+
+#include "HumScoreCache.h"
+
+#include <functional>
+
+using namespace std;
+
+namespace hum {
+
+// START_MERGE
+
+//////////////////////////////
+//
+// HumScoreEntry::HumScoreEntry -- Constructor.  The file is not read
+//     until prepare() is called.
+//
+
+HumScoreEntry::HumScoreEntry(const string& filename) {
+	m_filename = filename;
+}
+
+
+
+//////////////////////////////
+//
+// HumScoreEntry::~HumScoreEntry -- Deconstructor.
+//
+
+HumScoreEntry::~HumScoreEntry() {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// HumScoreEntry::getFilename --
+//
+
+const string& HumScoreEntry::getFilename(void) const {
+	return m_filename;
+}
+
+
+
+//////////////////////////////
+//
+// HumScoreEntry::getFile -- Return the parsed file.  The entry's mutex
+//     must be locked and prepare() called before using the file.
+//
+
+HumdrumFile& HumScoreEntry::getFile(void) {
+	return m_file;
+}
+
+
+
+//////////////////////////////
+//
+// HumScoreEntry::getMutex --
+//
+
+mutex& HumScoreEntry::getMutex(void) {
+	return m_mutex;
+}
+
+
+
+//////////////////////////////
+//
+// HumScoreEntry::prepare -- Get the file ready for use: read it the
+//     first time, or read it again if the previous user changed its
+//     contents or if the file was changed on disk.  Analyses which were
+//     done by previous users are kept if the file was not changed.
+//     Returns false if the file cannot be read.  The entry's mutex must
+//     be locked when calling this function.
+//
+
+bool HumScoreEntry::prepare(void) {
+	if (!m_loaded || isChangedOnDisk() || isModified()) {
+		return load();
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumScoreEntry::isModified -- Returns true if lines were added to or
+//     removed from the file, or if the text of any line was changed.
+//
+
+bool HumScoreEntry::isModified(void) {
+	return getContentHash() != m_hash;
+}
+
+
+
+//////////////////////////////
+//
+// HumScoreEntry::isChangedOnDisk -- Returns true if the modification time
+//     or size of the file is different from when it was read.
+//
+
+bool HumScoreEntry::isChangedOnDisk(void) {
+	time_t mtime;
+	off_t size;
+	if (!getFileStatus(mtime, size)) {
+		return true;
+	}
+	return (mtime != m_mtime) || (size != m_size);
+}
+
+
+
+//////////////////////////////
+//
+// HumScoreEntry::getFileStatus -- Get the modification time and size of
+//     the file.  Returns false if the file cannot be accessed.
+//
+
+bool HumScoreEntry::getFileStatus(time_t& mtime, off_t& size) {
+	struct stat info;
+	if (stat(m_filename.c_str(), &info) != 0) {
+		return false;
+	}
+	mtime = info.st_mtime;
+	size = info.st_size;
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumScoreEntry::getParseCount -- Return the number of times that the
+//     file has been read.
+//
+
+int HumScoreEntry::getParseCount(void) const {
+	return m_parsecount;
+}
+
+
+
+//////////////////////////////
+//
+// HumScoreEntry::load -- Read and parse the file.
+//
+
+bool HumScoreEntry::load(void) {
+	m_parsecount++;
+	// The status is read before the file so that a change while reading
+	// causes the file to be read again next time.
+	if (!getFileStatus(m_mtime, m_size)) {
+		m_mtime = 0;
+		m_size = -1;
+	}
+	m_loaded = m_file.read(m_filename);
+	m_hash = getContentHash();
+	return m_loaded;
+}
+
+
+
+//////////////////////////////
+//
+// HumScoreEntry::getContentHash -- Hash of the line count and the text
+//     of each line.  Lines which have tokens that were changed are
+//     regenerated before they are hashed.
+//
+
+size_t HumScoreEntry::getContentHash(void) {
+	std::hash<string> hasher;
+	size_t output = m_file.getLineCount();
+	for (int i=0; i<m_file.getLineCount(); i++) {
+		HumdrumLine& line = m_file[i];
+		line.updateText();
+		size_t value = hasher(static_cast<const string&>(line));
+		output ^= value + 0x9e3779b9 + (output << 6) + (output >> 2);
+	}
+	return output;
+}
+
+
+
+//////////////////////////////
+//
+// HumScoreCache::HumScoreCache -- Constructor.
+//
+
+HumScoreCache::HumScoreCache(int maxfiles) {
+	m_maxfiles = maxfiles;
+}
+
+
+
+//////////////////////////////
+//
+// HumScoreCache::~HumScoreCache -- Deconstructor.
+//
+
+HumScoreCache::~HumScoreCache() {
+	clear();
+}
+
+
+
+//////////////////////////////
+//
+// HumScoreCache::getScore -- Return the entry for a file, adding it to
+//     the cache if necessary.  Lock the mutex of the entry and call
+//     HumScoreEntry::prepare() before using the file.  Entries which
+//     are removed from the cache stay valid until they are no longer used.
+//
+
+std::shared_ptr<HumScoreEntry> HumScoreCache::getScore(const string& filename) {
+	lock_guard<mutex> lock(m_mutex);
+	auto it = m_index.find(filename);
+	if (it != m_index.end()) {
+		m_hits++;
+		m_entries.splice(m_entries.begin(), m_entries, it->second);
+		return m_entries.front();
+	}
+	m_misses++;
+	m_entries.push_front(std::make_shared<HumScoreEntry>(filename));
+	m_index[filename] = m_entries.begin();
+	trim();
+	return m_entries.front();
+}
+
+
+
+//////////////////////////////
+//
+// HumScoreCache::clear -- Remove all files from the cache.
+//
+
+void HumScoreCache::clear(void) {
+	lock_guard<mutex> lock(m_mutex);
+	m_entries.clear();
+	m_index.clear();
+}
+
+
+
+//////////////////////////////
+//
+// HumScoreCache::setMaxFiles -- Set the maximum number of files to
+//     store.  A value less than one means no limit.
+//
+
+void HumScoreCache::setMaxFiles(int maxfiles) {
+	lock_guard<mutex> lock(m_mutex);
+	m_maxfiles = maxfiles;
+	trim();
+}
+
+
+
+//////////////////////////////
+//
+// HumScoreCache::getMaxFiles --
+//
+
+int HumScoreCache::getMaxFiles(void) {
+	lock_guard<mutex> lock(m_mutex);
+	return m_maxfiles;
+}
+
+
+
+//////////////////////////////
+//
+// HumScoreCache::getCount -- Return the number of files in the cache.
+//
+
+int HumScoreCache::getCount(void) {
+	lock_guard<mutex> lock(m_mutex);
+	return (int)m_entries.size();
+}
+
+
+
+//////////////////////////////
+//
+// HumScoreCache::printStatistics -- Print the number of stored files
+//     and the number of cache hits and misses.
+//
+
+ostream& HumScoreCache::printStatistics(ostream& out) {
+	lock_guard<mutex> lock(m_mutex);
+	out << "files:\t"    << m_entries.size() << "\n";
+	out << "maxfiles:\t" << m_maxfiles       << "\n";
+	out << "hits:\t"     << m_hits           << "\n";
+	out << "misses:\t"   << m_misses         << "\n";
+	return out;
+}
+
+
+
+//////////////////////////////
+//
+// HumScoreCache::trim -- Remove the least-recently used files until the
+//     cache is not larger than the maximum size.  The mutex must be
+//     locked when calling this function.
+//
+
+void HumScoreCache::trim(void) {
+	if (m_maxfiles < 1) {
+		return;
+	}
+	while ((int)m_entries.size() > m_maxfiles) {
+		m_index.erase(m_entries.back()->getFilename());
+		m_entries.pop_back();
+	}
+}
+
+
+// END_MERGE
+
+} // end namespace hum
+
+
+
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Mon Nov 28 08:55:15 PST 2016
-// Last Modified: Tue Dec 20 22:33:15 PST 2016
+// Last Modified: Sun Oct 18 18:20:41 PDT 2026 Added output sink
 // Filename:      HumTool.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/HumTool.cpp
 // Syntax:        C++11; humlib
@@ -36,7 +36,7 @@ HumTool::HumTool(void) {
 //
 
 HumTool::~HumTool() {
-	// do nothing
+	clearHumdrumOutput();
 }
 
 
@@ -51,7 +51,7 @@ bool HumTool::hasAnyText(void) {
 	if (m_suppress) {
 		return true;
 	}
-	return ((!m_humdrum_text.str().empty())
+	return (hasHumdrumText()
 			|| (!m_free_text.str().empty())
 			|| (!m_json_text.str().empty()));
 }
@@ -65,6 +65,7 @@ bool HumTool::hasAnyText(void) {
 //
 
 string HumTool::getAllText(void) {
+	m_humdrum_sink.flush();
 	return  m_humdrum_text.str()
 	      + m_json_text.str()
 	      + m_free_text.str();
@@ -75,6 +76,7 @@ string HumTool::getAllText(void) {
 //
 
 ostream& HumTool::getAllText(ostream& out) {
+	m_humdrum_sink.flush();
 	out << m_humdrum_text.str();
 	out << m_json_text.str();
 	out << m_free_text.str();
@@ -94,6 +96,78 @@ void HumTool::suppressHumdrumFileOutput(void) {
 
 
 
+//////////////////////////////
+//
+// HumTool::setHumdrumOutput -- Send Humdrum text directly to an
+//    ostream, a file descriptor or a writing function while the tool
+//    is running, rather than storing it until getAllText() is called.
+//    JSON and free text are still stored, so they will be printed after
+//    the Humdrum text as when buffering.  The text is flushed when
+//    getAllText(), getHumdrumText() or clearOutput() is called.
+//    Returns false if the tool has to store its Humdrum output for
+//    further processing, in which case the output is buffered as usual.
+//
+
+bool HumTool::setHumdrumOutput(ostream& out) {
+	if (m_buffer_humdrum) {
+		return false;
+	}
+	m_humdrum_sink.setStream(out);
+	static_cast<ios&>(m_humdrum_text).rdbuf(&m_humdrum_sink);
+	return true;
+}
+
+
+bool HumTool::setHumdrumOutput(int fd) {
+	if (m_buffer_humdrum) {
+		return false;
+	}
+	m_humdrum_sink.setFileDescriptor(fd);
+	static_cast<ios&>(m_humdrum_text).rdbuf(&m_humdrum_sink);
+	return true;
+}
+
+
+bool HumTool::setHumdrumOutput(const HumOutputSink::Writer& writer) {
+	if (m_buffer_humdrum) {
+		return false;
+	}
+	m_humdrum_sink.setWriter(writer);
+	static_cast<ios&>(m_humdrum_text).rdbuf(&m_humdrum_sink);
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumTool::clearHumdrumOutput -- Flush any Humdrum text to the output
+//    set with setHumdrumOutput() and go back to storing Humdrum text.
+//
+
+void HumTool::clearHumdrumOutput(void) {
+	if (!isStreamingHumdrum()) {
+		return;
+	}
+	m_humdrum_sink.clear();
+	m_humdrum_sink.resetByteCount();
+	static_cast<ios&>(m_humdrum_text).rdbuf(m_humdrum_text.rdbuf());
+}
+
+
+
+//////////////////////////////
+//
+// HumTool::isStreamingHumdrum -- Returns true if Humdrum text is sent
+//    directly to the output.
+//
+
+bool HumTool::isStreamingHumdrum(void) {
+	return m_humdrum_sink.isActive();
+}
+
+
+
 //////////////////////////////
 //
 // HumTool::hasHumdrumText -- Returns true if the output contains
@@ -101,6 +175,9 @@ void HumTool::suppressHumdrumFileOutput(void) {
 //
 
 bool HumTool::hasHumdrumText(void) {
+	if (m_humdrum_sink.getByteCount() > 0) {
+		return true;
+	}
 	return m_humdrum_text.str().empty() ? false : true;
 }
 
@@ -109,10 +186,12 @@ bool HumTool::hasHumdrumText(void) {
 //////////////////////////////
 //
 // HumTool::getHumdrumText -- Get the text content which represents
-//     Humdrum syntax.
+//     Humdrum syntax.  Text which was sent directly to the output
+//     (see setHumdrumOutput()) is not included.
 //
 
 string HumTool::getHumdrumText(void) {
+	m_humdrum_sink.flush();
 	return m_humdrum_text.str();
 }
 
@@ -121,6 +200,7 @@ string HumTool::getHumdrumText(void) {
 //
 
 ostream& HumTool::getHumdrumText(ostream& out) {
+	m_humdrum_sink.flush();
 	out << m_humdrum_text.str();
 	return out;
 }
@@ -269,6 +349,7 @@ ostream& HumTool::getError(ostream& out) {
 //
 
 void HumTool::clearOutput(void) {
+	m_humdrum_sink.resetByteCount();
 	m_humdrum_text.str("");
 	m_json_text.str("");
 	m_free_text.str("");
@@ -1,7 +1,8 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sat Aug  8 12:24:49 PDT 2015
-// Last Modified: Fri Aug 14 21:57:09 PDT 2015
+// Last Modified: Sun Oct 18 16:21:05 PDT 2026 Interned spine info/data types
+// Last Modified: Sun Oct 18 16:40:12 PDT 2026 Print dirty lines from tokens
 // Filename:      HumdrumFileBase.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/HumdrumFileBase.cpp
 // Syntax:        C++11; humlib
@@ -71,6 +72,7 @@ HumdrumFileBase::HumdrumFileBase(HumdrumFileBase& infile) {
 	m_filename = infile.m_filename;
 	m_segmentlevel = infile.m_segmentlevel;
 	m_trackstarts.clear();
+	m_trackdatatypes.clear();
 	m_trackends.clear();
 	m_barlines.clear();
 	m_ticksperquarternote = infile.m_ticksperquarternote;
@@ -107,6 +109,7 @@ HumdrumFileBase& HumdrumFileBase::operator=(HumdrumFileBase& infile) {
 	m_filename = infile.m_filename;
 	m_segmentlevel = infile.m_segmentlevel;
 	m_trackstarts.clear();
+	m_trackdatatypes.clear();
 	m_trackends.clear();
 	m_barlines.clear();
 	m_ticksperquarternote = infile.m_ticksperquarternote;
@@ -116,6 +119,8 @@ HumdrumFileBase& HumdrumFileBase::operator=(HumdrumFileBase& infile) {
 	m_quietParse = infile.m_quietParse;
 	m_parseError = infile.m_parseError;
 	m_displayError = infile.m_displayError;
+	m_timeline_analyzed = false;
+	m_contentcount++;
 
 	m_lines.resize(infile.m_lines.size());
 	for (int i=0; i<(int)m_lines.size(); i++) {
@@ -157,7 +162,11 @@ void HumdrumFileBase::clear(void) {
 
 	// clear state variables which are now invalid:
 	m_trackstarts.clear();
+	m_trackdatatypes.clear();
 	m_trackends.clear();
+	m_spineinfos.clear();
+	m_spineinfotracks.clear();
+	m_spineinfoids.clear();
 	m_barlines.clear();
 	m_ticksperquarternote = -1;
 	m_idprefix.clear();
@@ -167,6 +176,8 @@ void HumdrumFileBase::clear(void) {
 	m_segmentlevel = 0;
 	m_structure_analyzed = false;
 	m_rhythm_analyzed = false;
+	m_timeline_analyzed = false;
+	m_contentcount++;
 }
 
 
@@ -1581,8 +1592,10 @@ bool HumdrumFileBase::stitchLinesTogether(HumdrumLine& previous,
 bool HumdrumFileBase::analyzeSpines(void) {
 	vector<string> datatype;
 	vector<string> sinfo;
+	vector<int> sinfoid;
 	vector<vector<HTp> > lastspine;
 	m_trackstarts.resize(0);
+	m_trackdatatypes.resize(0);
 	m_trackends.resize(0);
 	addToTrackStarts(NULL);
 
@@ -1610,7 +1623,10 @@ bool HumdrumFileBase::analyzeSpines(void) {
 				datatype[j] = m_lines[i]->getTokenString(j);
 				addToTrackStarts(m_lines[i]->token(j));
 				sinfo[j]    = to_string(j+1);
-				m_lines[i]->token(j)->setSpineInfo(sinfo[j]);
+			}
+			internSpineInfoList(sinfoid, sinfo);
+			for (j=0; j<m_lines[i]->getTokenCount(); j++) {
+				m_lines[i]->token(j)->setSpineInfoId(sinfoid[j]);
 				m_lines[i]->token(j)->setFieldIndex(j);
 				lastspine[j].push_back(m_lines[i]->token(j));
 			}
@@ -1628,13 +1644,14 @@ bool HumdrumFileBase::analyzeSpines(void) {
 			return setParseError(err);
 		}
 		for (j=0; j<m_lines[i]->getTokenCount(); j++) {
-			m_lines[i]->token(j)->setSpineInfo(sinfo[j]);
+			m_lines[i]->token(j)->setSpineInfoId(sinfoid[j]);
 			m_lines[i]->token(j)->setFieldIndex(j);
 		}
 		if (!m_lines[i]->isManipulator()) {
 			continue;
 		}
 		if (!adjustSpines(*m_lines[i], datatype, sinfo)) { return isValid(); }
+		internSpineInfoList(sinfoid, sinfo);
 	}
 	return isValid();
 }
@@ -1651,17 +1668,202 @@ bool HumdrumFileBase::analyzeSpines(void) {
 void HumdrumFileBase::addToTrackStarts(HTp token) {
 	if (token == NULL) {
 		m_trackstarts.push_back(NULL);
+		m_trackdatatypes.push_back(HumAddress::DATATYPE_NONE);
 		m_trackends.resize(m_trackends.size()+1);
 	} else if ((m_trackstarts.size() > 1) && (m_trackstarts.back() == NULL)) {
 		m_trackstarts.back() = token;
+		m_trackdatatypes.back() = internDataType(*token);
 	} else {
 		m_trackstarts.push_back(token);
+		m_trackdatatypes.push_back(internDataType(*token));
 		m_trackends.resize(m_trackends.size()+1);
 	}
 }
 
 
 
+//////////////////////////////
+//
+// HumdrumFileBase::internSpineInfo -- Return the index of a spine info
+//    string in the spine info table of the file, adding the string to
+//    the table if it is not already present.
+//
+
+int HumdrumFileBase::internSpineInfo(const string& spineinfo) {
+	auto it = m_spineinfoids.find(spineinfo);
+	if (it != m_spineinfoids.end()) {
+		return it->second;
+	}
+	int id = (int)m_spineinfos.size();
+	m_spineinfos.push_back(spineinfo);
+	m_spineinfotracks.push_back(HumAddress::getTrackFromSpineInfo(spineinfo));
+	m_spineinfoids[spineinfo] = id;
+	return id;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileBase::internSpineInfoList -- Intern a list of spine info
+//    strings (see internSpineInfo()).
+//
+
+void HumdrumFileBase::internSpineInfoList(vector<int>& ids,
+		vector<string>& sinfo) {
+	ids.resize(sinfo.size());
+	for (int i=0; i<(int)sinfo.size(); i++) {
+		ids[i] = internSpineInfo(sinfo[i]);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileBase::getSpineInfoString -- Return the spine info string for
+//    an index in the spine info table.
+//
+
+const string& HumdrumFileBase::getSpineInfoString(int id) const {
+	static const string empty;
+	if ((id < 0) || (id >= (int)m_spineinfos.size())) {
+		return empty;
+	}
+	return m_spineinfos[id];
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileBase::getSpineInfoTrack -- Return the track number of the
+//    spine info string for an index in the spine info table (the first
+//    number in the string).  Returns 0 for an invalid index.
+//
+
+int HumdrumFileBase::getSpineInfoTrack(int id) const {
+	if ((id < 0) || (id >= (int)m_spineinfotracks.size())) {
+		return 0;
+	}
+	return m_spineinfotracks[id];
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileBase::internDataType -- Return the ID of an exclusive
+//    interpretation string in the data type table of the file, adding the
+//    string to the table if it is not already present.
+//
+
+int HumdrumFileBase::internDataType(const string& datatype) {
+	if (m_datatypes.empty()) {
+		// Entries which are in the same order as HumAddress::DataTypeId:
+		m_datatypes.push_back("");
+		m_datatypes.push_back("**kern");
+		m_datatypes.push_back("**mens");
+		for (int i=0; i<(int)m_datatypes.size(); i++) {
+			m_datatypeids[m_datatypes[i]] = i;
+		}
+	}
+	auto it = m_datatypeids.find(datatype);
+	if (it != m_datatypeids.end()) {
+		return it->second;
+	}
+	int id = (int)m_datatypes.size();
+	m_datatypes.push_back(datatype);
+	m_datatypeids[datatype] = id;
+	return id;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileBase::getDataTypeId -- Return the ID of an exclusive
+//    interpretation in the file.  The leading "**" is optional.  Returns
+//    -1 if there is no spine with the data type in the file.  Use this
+//    function to look up a data type once before comparing it to the
+//    IDs of tokens with HumdrumToken::getDataTypeId().
+//
+
+int HumdrumFileBase::getDataTypeId(const string& datatype) const {
+	if (datatype.empty()) {
+		return HumAddress::DATATYPE_NONE;
+	}
+	string name;
+	if (datatype.compare(0, 2, "**") != 0) {
+		name = "**" + datatype;
+	}
+	const string& key = name.empty() ? datatype : name;
+	if (key == "**kern") {
+		return HumAddress::DATATYPE_KERN;
+	} else if (key == "**mens") {
+		return HumAddress::DATATYPE_MENS;
+	}
+	auto it = m_datatypeids.find(key);
+	if (it == m_datatypeids.end()) {
+		return -1;
+	}
+	return it->second;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileBase::getDataTypeString -- Return the exclusive interpretation
+//    string for a data type ID.
+//
+
+const string& HumdrumFileBase::getDataTypeString(int id) const {
+	static const string empty;
+	if ((id < 0) || (id >= (int)m_datatypes.size())) {
+		return empty;
+	}
+	return m_datatypes[id];
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileBase::getTrackDataTypeId -- Return the data type ID of the
+//    exclusive interpretation which starts the given track.  Returns
+//    HumAddress::DATATYPE_NONE for an invalid track.
+//
+
+int HumdrumFileBase::getTrackDataTypeId(int track) const {
+	if ((track <= 0) || (track >= (int)m_trackdatatypes.size())) {
+		return HumAddress::DATATYPE_NONE;
+	}
+	return m_trackdatatypes[track];
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileBase::updateTrackDataType -- Update the data type of a track
+//    after the text of its starting exclusive interpretation has been
+//    changed.  Nothing is done if the token does not start a track.
+//
+
+void HumdrumFileBase::updateTrackDataType(HTp token) {
+	int track = token->getTrack();
+	if ((track <= 0) || (track >= (int)m_trackstarts.size())) {
+		return;
+	}
+	if (m_trackstarts[track] != token) {
+		return;
+	}
+	m_trackdatatypes[track] = internDataType(*token);
+}
+
+
+
 //////////////////////////////
 //
 // HumdrumFileBase::adjustSpines -- adjust datatype and spineinfo values based
@@ -2250,10 +2452,9 @@ void HumdrumFileBase::fixMerges(int linei) {
 
 //////////////////////////////
 //
-// operator<< -- Default method of printing HumdrumFiles.  This printing method
-//    assumes that the HumdrumLine string is correct.  If a token is changed
-//    in the file, the HumdrumFileBase::createLinesFromTokens() before printing
-//    the contents of the line.
+// operator<< -- Default method of printing HumdrumFiles.  Lines which
+//    have tokens changed by HumdrumToken::setText() are regenerated from
+//    their tokens, and other lines are printed from their original text.
 //
 
 ostream& operator<<(ostream& out, HumdrumFileBase& infile) {
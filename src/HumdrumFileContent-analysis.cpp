@@ -0,0 +1,274 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 17:05:38 PDT 2026
+// Last Modified: Mon Oct 19 05:31:12 PDT 2026
+// Filename:      HumdrumFileContent-analysis.cpp
+// URL:           https://github.com/craigsapp/humlib/blob/master/src/HumdrumFileContent-analysis.cpp
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:
+//   Storage of analysis results as typed columns (one value for each line
+//   in the file).  Tools store their results in columns which can be read
+//   directly by other code, printed as CSV or binary data, or rendered
+//   as **data spines in the file when Humdrum text output is needed.
+//
+
+#include "HumdrumFileContent.h"
+
+#include <cstdint>
+
+using namespace std;
+
+namespace hum {
+
+// START_MERGE
+
+//////////////////////////////
+//
+// HumdrumFileContent::addAnalysisColumn -- Add an empty analysis column
+//     (or a column filled with the given data) to the file.  The
+//     inserttrack parameter controls where the column will be placed when
+//     it is rendered as a spine: 0 = after the last spine, -1 = before the
+//     first spine, otherwise before the given track.  Data values which
+//     are equal to the null string when printed, or are empty strings,
+//     are stored as null values.
+//
+
+HumAnalysisColumn& HumdrumFileContent::addAnalysisColumn(const string& exinterp,
+		int type, int inserttrack) {
+	checkAnalysisColumns();
+	m_analysis.emplace_back(exinterp, type, getLineCount());
+	m_analysis.back().setInsertTrack(inserttrack);
+	return m_analysis.back();
+}
+
+
+HumAnalysisColumn& HumdrumFileContent::addAnalysisColumn(const vector<int>& data,
+		const string& null, const string& exinterp, int inserttrack) {
+	HumAnalysisColumn& column = addAnalysisColumn(exinterp,
+			HumAnalysisColumn::COLUMN_INT, inserttrack);
+	column.setData(data, null);
+	return column;
+}
+
+
+HumAnalysisColumn& HumdrumFileContent::addAnalysisColumn(const vector<double>& data,
+		const string& null, const string& exinterp, int inserttrack) {
+	HumAnalysisColumn& column = addAnalysisColumn(exinterp,
+			HumAnalysisColumn::COLUMN_DOUBLE, inserttrack);
+	column.setData(data, null);
+	return column;
+}
+
+
+HumAnalysisColumn& HumdrumFileContent::addAnalysisColumn(const vector<string>& data,
+		const string& null, const string& exinterp, int inserttrack) {
+	HumAnalysisColumn& column = addAnalysisColumn(exinterp,
+			HumAnalysisColumn::COLUMN_STRING, inserttrack);
+	column.setData(data, null);
+	return column;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::getAnalysisColumnCount -- Return the number of
+//     analysis columns stored in the file.
+//
+
+int HumdrumFileContent::getAnalysisColumnCount(void) const {
+	if (m_analysiscontent != m_contentcount) {
+		// columns of the previous contents of the file
+		return 0;
+	}
+	return (int)m_analysis.size();
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::getAnalysisColumn -- Return an analysis column by
+//     index or by name (either the column name or its exclusive
+//     interpretation).  Returns NULL if the column does not exist.
+//
+
+HumAnalysisColumn* HumdrumFileContent::getAnalysisColumn(int index) {
+	checkAnalysisColumns();
+	if ((index < 0) || (index >= (int)m_analysis.size())) {
+		return NULL;
+	}
+	return &m_analysis[index];
+}
+
+
+HumAnalysisColumn* HumdrumFileContent::getAnalysisColumn(const string& name) {
+	checkAnalysisColumns();
+	for (int i=0; i<(int)m_analysis.size(); i++) {
+		if ((m_analysis[i].getName() == name) ||
+				(m_analysis[i].getExInterp() == name)) {
+			return &m_analysis[i];
+		}
+	}
+	return NULL;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::clearAnalysisColumns -- Remove all analysis columns.
+//     Spines which were already rendered from the columns are not removed.
+//
+
+void HumdrumFileContent::clearAnalysisColumns(void) {
+	m_analysis.clear();
+	m_analysisrendered = 0;
+	m_analysiscontent = m_contentcount;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::checkAnalysisColumns -- Remove the analysis columns
+//     if the file has been cleared, read again or assigned from another
+//     file since the columns were added.  HumdrumFileBase::clear() and
+//     the assignment operator are not virtual, so they increment the
+//     content count of the file, which is checked here before the columns
+//     are used.
+//
+
+void HumdrumFileContent::checkAnalysisColumns(void) {
+	if (m_analysiscontent != m_contentcount) {
+		clearAnalysisColumns();
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::renderAnalysisColumns -- Add a spine to the file
+//     for each analysis column which has not already been rendered.
+//     The columns are rendered in the order that they were added.
+//     The line count of the file must not change between adding a
+//     column and rendering it.  Returns false if any column could not
+//     be rendered.
+//
+
+bool HumdrumFileContent::renderAnalysisColumns(void) {
+	checkAnalysisColumns();
+	bool status = true;
+	int linecount = getLineCount();
+	vector<string> text;
+	for (int i=m_analysisrendered; i<(int)m_analysis.size(); i++) {
+		HumAnalysisColumn& column = m_analysis[i];
+		if (column.getLineCount() != linecount) {
+			status = false;
+			continue;
+		}
+		text.resize(linecount);
+		for (int j=0; j<linecount; j++) {
+			if (m_lines[j]->isData()) {
+				text[j] = column.getText(j);
+			} else {
+				text[j].clear();
+			}
+		}
+		int track = column.getInsertTrack();
+		if (track == 0) {
+			status &= appendDataSpine(text, "", column.getExInterp());
+		} else if (track < 0) {
+			status &= prependDataSpine(text, "", column.getExInterp());
+		} else {
+			status &= insertDataSpineBefore(track, text, "", column.getExInterp());
+		}
+	}
+	m_analysisrendered = (int)m_analysis.size();
+	return status;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::printAnalysisCsv -- Print the analysis columns
+//     as CSV data.  The first row contains the column names, and there is
+//     one row for each data line in the file.  The first column is the
+//     line index in the file.  Null values are printed as empty cells.
+//
+
+ostream& HumdrumFileContent::printAnalysisCsv(ostream& out,
+		const string& separator) {
+	checkAnalysisColumns();
+	auto printCell = [&](const string& value) {
+		if ((value.find(separator) == string::npos) &&
+				(value.find('"') == string::npos)) {
+			out << value;
+			return;
+		}
+		out << '"';
+		for (int i=0; i<(int)value.size(); i++) {
+			if (value[i] == '"') {
+				out << '"';
+			}
+			out << value[i];
+		}
+		out << '"';
+	};
+
+	out << "line";
+	for (int i=0; i<(int)m_analysis.size(); i++) {
+		out << separator;
+		printCell(m_analysis[i].getName());
+	}
+	out << '\n';
+	for (int i=0; i<getLineCount(); i++) {
+		if (!m_lines[i]->isData()) {
+			continue;
+		}
+		out << i;
+		for (int j=0; j<(int)m_analysis.size(); j++) {
+			out << separator;
+			if (i < m_analysis[j].getLineCount()) {
+				printCell(m_analysis[j].getText(i));
+			}
+		}
+		out << '\n';
+	}
+	return out;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::printAnalysisBinary -- Write the analysis columns
+//     in binary form: the characters "HUMACOL1", then the line count and
+//     column count of the file as 32-bit integers, followed by each
+//     column (see HumAnalysisColumn::writeBinary()).
+//
+
+ostream& HumdrumFileContent::printAnalysisBinary(ostream& out) {
+	checkAnalysisColumns();
+	out.write("HUMACOL1", 8);
+	int32_t value = getLineCount();
+	out.write((const char*)&value, sizeof(value));
+	value = (int32_t)m_analysis.size();
+	out.write((const char*)&value, sizeof(value));
+	for (int i=0; i<(int)m_analysis.size(); i++) {
+		m_analysis[i].writeBinary(out);
+	}
+	return out;
+}
+
+
+// END_MERGE
+
+} // end namespace hum
+
+
+
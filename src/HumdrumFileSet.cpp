@@ -2,6 +2,7 @@
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Fri Mar 29 15:14:19 PDT 2013
 // Last Modified: Sun Jul 28 20:18:00 CEST 2019 Convert to humlib.
+// Last Modified: Mon Oct 19 00:05:12 PDT 2026 Added parallel reading
 // Filename:      HumdrumFileSet.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/HumdrumFileSet.cpp
 // Syntax:        C++11; humlib
@@ -12,6 +13,7 @@
 
 #include "HumdrumFileSet.h"
 #include "HumdrumFileStream.h"
+#include "HumParallel.h"
 
 #include <fstream>
 #include <iostream>
@@ -161,6 +163,11 @@ int HumdrumFileSet::read(HumdrumFileStream& instream) {
 	return readAppend(instream);
 }
 
+int HumdrumFileSet::readParallel(HumdrumFileStream& instream, int threads) {
+	clear();
+	return readAppendParallel(instream, threads);
+}
+
 
 
 
@@ -221,6 +228,61 @@ int HumdrumFileSet::readAppendHumdrum(HumdrumFile& infile) {
 }
 
 
+
+//////////////////////////////
+//
+// HumdrumFileSet::readAppendParallel -- Add the files from the input
+//    stream to the end of the set, parsing several files at the same
+//    time.  The input stream is first split into the text of each file
+//    (which also adds the universal comments that apply to each file),
+//    and then the files are parsed on the given number of threads (0 =
+//    all cores).  The files are stored in their input order.  A file
+//    with a parse error is kept in the set, and its error message is
+//    printed after all files have been parsed (in the input order, so
+//    that messages for different files are not mixed together), and is
+//    available from HumdrumFile::getParseError().  Returns the total
+//    number of files in the set.
+//
+
+int HumdrumFileSet::readAppendParallel(HumdrumFileStream& instream,
+		int threads) {
+	vector<HumdrumFile*> files;
+	vector<string> contents;
+	stringstream buffer;
+	HumdrumFile* pfile = new HumdrumFile;
+	while (instream.getFileContents(buffer, *pfile)) {
+		files.push_back(pfile);
+		contents.push_back(buffer.str());
+		pfile = new HumdrumFile;
+	}
+	delete pfile;
+
+	HumParallel::run((int)files.size(), threads, [&](int i) {
+		HumdrumFile& infile = *files[i];
+		string filename = infile.getFilename();
+		stringstream input(contents[i]);
+		contents[i].clear();
+		infile.setQuietParsing();
+		// The files are already parsed in parallel, so do not also
+		// analyze the tracks of each file in parallel.
+		infile.setAnalysisThreadCount(1);
+		infile.readNoRhythm(input);
+		if (!filename.empty()) {
+			infile.setFilename(filename);
+		}
+	});
+
+	for (int i=0; i<(int)files.size(); i++) {
+		files[i]->setNoisyParsing();
+		files[i]->setAnalysisThreadCount(0);
+		files[i]->isValid();
+		m_data.push_back(files[i]);
+	}
+	return (int)m_data.size();
+}
+
+
+
 //////////////////////////////
 //
 // appendHumdrumPointer --  The infile will be deleted by the object
@@ -4,6 +4,8 @@
 // Last Modified: Tue Dec 11 16:09:38 PST 2012
 // Last Modified: Fri Mar 11 21:26:18 PST 2016 Changed to STL
 // Last Modified: Fri Dec  2 19:25:41 PST 2016 Moved to humlib
+// Last Modified: Mon Oct 19 00:05:12 PDT 2026 Added getFileContents()
+// Last Modified: Mon Oct 19 05:10:31 PDT 2026 Shared segment reader
 // Filename:      HumdrumFileStream.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/HumdrumFileStream.cpp
 // Syntax:        C++11; humlib
@@ -18,7 +20,6 @@
 #include "HumdrumFileSet.h"
 #include "HumRegex.h"
 
-#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <sstream>
@@ -74,6 +75,10 @@ void HumdrumFileStream::clear(void) {
 	m_filelist.resize(0);
 	m_universals.resize(0);
 	m_newfilebuffer.resize(0);
+	m_input = NULL;
+	m_queue.clear();
+	m_queueindex = 0;
+	m_heldline.clear();
 	// m_stringbuffer.clear(0);
 	m_stringbuffer.str("");
 }
@@ -212,300 +217,307 @@ int HumdrumFileStream::eof(void) {
 //
 
 int HumdrumFileStream::getFile(HumdrumFile& infile) {
-	infile.clear();
-	istream* newinput = NULL;
+	stringstream contents;
+	if (!getFileContents(contents, infile)) {
+		return 0;
+	}
+	string filename = infile.getFilename();
+	infile.readNoRhythm(contents);
+	if (!filename.empty()) {
+		infile.setFilename(filename);
+	}
+	return 1;
+}
 
-restarting:
 
-	newinput = NULL;
 
-	if (m_urlbuffer.eof()) {
-		// If the URL buffer is at its end, clear the buffer.
-		m_urlbuffer.str("");
-	}
+//////////////////////////////
+//
+// HumdrumFileStream::getFileContents -- Extract the text of the next
+//    file in the input stream (with the current universal comments
+//    converted into global comments) without parsing it, so that the
+//    text can be parsed later (such as in another thread).  The filename
+//    and segment level are stored in infile.  Returns false if there are
+//    no more files in the input stream.
+//
 
-	// Read HumdrumFile contents from:
-	// (1) Read from string buffer
-	// (2) Current ifstream if open
-	// (3) Next filename if ifstream is done
-	// (4) cin if no ifstream open and no filenames
-
-	// (1) Is there content in the string buffer?
-	if (!m_stringbuffer.str().empty()) {
-		newinput = &m_stringbuffer;
+int HumdrumFileStream::getFileContents(stringstream& contents,
+		HumdrumFile& infile) {
+	infile.clear();
+	contents.str("");
+	contents.clear();
+	string line;
+	while (true) {
+		if (!startSegment()) {
+			return 0;
+		}
+		while (readSegmentLine(line)) {
+			contents << line << "\n";
+		}
+		m_input = NULL;
+		if (m_dataFoundQ) {
+			break;
+		}
+		// never found anything for some strange reason.
+		if (!m_addedFilenameQ) {
+			return 0;
+		}
 	}
-
-	// (2) Is an ifstream open?
-	else if (m_instream.is_open() && !m_instream.eof()) {
-		newinput = &m_instream;
+	if (!m_filename.empty()) {
+		infile.setFilename(m_filename);
 	}
+	infile.setSegmentLevel(m_segmentlevel);
+	return 1;
+}
 
-	// (2b) Is the URL data buffer open?
-	else if (m_urlbuffer.str() != "") {
-		m_urlbuffer.clear();
-		newinput = &m_urlbuffer;
-	}
 
-	// (3) If ifstream is closed but there is a file to be processed,
-	// load it into the ifstream and start processing it immediately.
-	else if (((int)m_filelist.size() > 0) &&
-			(m_curfile < (int)m_filelist.size()-1)) {
-		m_curfile++;
-		if (m_instream.is_open()) {
-			m_instream.close();
-		}
-		if (strstr(m_filelist[m_curfile].c_str(), "://") != NULL) {
-			// The next file to read is a URL/URI, so buffer the
-			// data from the internet and start reading that instead
-			// of reading from a file on the hard disk.
-			fillUrlBuffer(m_urlbuffer, m_filelist[m_curfile].c_str());
-			infile.setFilename(m_filelist[m_curfile].c_str());
-			goto restarting;
-		}
-		m_instream.open(m_filelist[m_curfile].c_str());
-		infile.setFilename(m_filelist[m_curfile].c_str());
-		if (!m_instream.is_open()) {
-			// file does not exist or cannot be opened close
-			// the file and try luck with next file in the list
-			// (perhaps given an error or warning?).
-			infile.setFilename("");
-			m_instream.close();
-			goto restarting;
+
+//////////////////////////////
+//
+// HumdrumFileStream::startSegment -- Choose the input for the next
+//    segment and reset the segment reading state.  Read HumdrumFile
+//    contents from:
+//    (1) the string buffer,
+//    (2) the current ifstream if it is open (or the URL data buffer),
+//    (3) the next filename if the ifstream is done,
+//    (4) cin if no ifstream is open and there are no filenames.
+//    Returns false if there is no more input.
+//
+
+bool HumdrumFileStream::startSegment(void) {
+	m_filename.clear();
+	m_segmentlevel = 0;
+	istream* newinput = NULL;
+
+	while (true) {
+		newinput = NULL;
+		if (m_urlbuffer.eof()) {
+			// If the URL buffer is at its end, clear the buffer.
+			m_urlbuffer.str("");
 		}
-		newinput = &m_instream;
-	} else {
-		// no input fstream open and no list of files to process, so
-		// start (or continue) reading from standard input.
-		if (m_curfile < 0) {
+
+		if (!m_stringbuffer.str().empty()) {
+			newinput = &m_stringbuffer;
+		} else if (m_instream.is_open() && !m_instream.eof()) {
+			newinput = &m_instream;
+		} else if (m_urlbuffer.str() != "") {
+			m_urlbuffer.clear();
+			newinput = &m_urlbuffer;
+		} else if (((int)m_filelist.size() > 0) &&
+				(m_curfile < (int)m_filelist.size()-1)) {
+			m_curfile++;
+			if (m_instream.is_open()) {
+				m_instream.close();
+			}
+			m_filename = m_filelist[m_curfile];
+			if (m_filename.find("://") != string::npos) {
+				// The next file to read is a URL/URI, so buffer the
+				// data from the internet and start reading that instead
+				// of reading from a file on the hard disk.
+				fillUrlBuffer(m_urlbuffer, m_filename);
+				continue;
+			}
+			m_instream.open(m_filename.c_str());
+			if (!m_instream.is_open()) {
+				// file does not exist or cannot be opened close
+				// the file and try luck with next file in the list
+				m_filename.clear();
+				m_instream.close();
+				continue;
+			}
+			newinput = &m_instream;
+		} else if (m_curfile < 0) {
 			// but only read from cin if no files have previously been read
 			newinput = &cin;
 		}
-	}
 
-	// At this point the newinput istream is set to read from the given
-	// file or from standard input, so start reading Humdrum content.
-	// If there is "m_newfilebuffer" content, then set the filename of the
-	// HumdrumFile to that value.
-
-	if (m_newfilebuffer.size() > 0) {
-		// store the filename for the current HumdrumFile being read:
-		HumRegex hre;
-		if (hre.search(m_newfilebuffer,
-				R"(^!!!!SEGMENT\s*([+-]?\d+)?\s*:\s*(.*)\s*$)")) {
-			if (hre.getMatchLength(1) > 0) {
-				infile.setSegmentLevel(atoi(hre.getMatch(1).c_str()));
-			} else {
-				infile.setSegmentLevel(0);
+		// If there is "m_newfilebuffer" content, then it is the
+		// !!!!SEGMENT record of this segment, or the exclusive
+		// interpretation line which ended the previous segment of
+		// the current file.
+		if (m_newfilebuffer.size() > 0) {
+			if (m_newfilebuffer.compare(0, 11, "!!!!SEGMENT") == 0) {
+				storeSegmentName(m_newfilebuffer);
+			} else if ((m_curfile >= 0) && (m_curfile < (int)m_filelist.size())) {
+				m_filename = m_filelist[m_curfile];
 			}
-			infile.setFilename(hre.getMatch(2));
-		} else if ((m_curfile >=0) && (m_curfile < (int)m_filelist.size())
-				&& (m_filelist.size() > 0)) {
-			infile.setFilename(m_filelist[m_curfile].c_str());
-		} else {
-			// reading from standard input, but no name.
 		}
-	}
 
-	if (newinput == NULL) {
-		// something strange happened, or no more files to read.
-		return 0;
-	}
-
-	stringstream buffer;
-	int foundUniversalQ = 0;
-
-	// Start reading the input stream.  If !!!!SEGMENT: universal comment
-	// is found, then store that line in m_newfilebuffer and return the
-	// newly read HumdrumFile.  If other universal comments are found, then
-	// overwrite the old universal comments here.
-
-	int addedFilename = 0;
-	//int searchName = 0;
-	int dataFoundQ = 0;
-	int starstarFoundQ = 0;
-	int starminusFoundQ = 0;
-	if (m_newfilebuffer.size() < 4) {
-		//searchName = 1;
-	}
-	char templine[123123] = {0};
-
-	if (newinput->eof()) {
-		if (m_curfile < (int)m_filelist.size()-1) {
-			m_curfile++;
-			goto restarting;
+		if (newinput == NULL) {
+			// something strange happened, or no more files to read.
+			return false;
 		}
-		// input stream is close and there is no more files to process.
-		return 0;
+		if (newinput->eof()) {
+			if (m_curfile < (int)m_filelist.size()-1) {
+				m_curfile++;
+				continue;
+			}
+			// input stream is closed and there are no more files to process.
+			return false;
+		}
+		break;
 	}
 
-	istream& input = *newinput;
+	m_input           = newinput;
+	m_dataFoundQ      = false;
+	m_starstarFoundQ  = false;
+	m_starminusFoundQ = false;
+	m_universalQ      = false;
+	m_addedFilenameQ  = false;
+	m_heldline.clear();
+	m_queue.clear();
+	m_queueindex = 0;
 
 	// if the previous line from the last read starts with "**"
 	// then treat it as part of the current file.
-	if ((m_newfilebuffer.size() > 1) &&
-		 (strncmp(m_newfilebuffer.c_str(), "**", 2)) == 0) {
-		buffer << m_newfilebuffer << "\n";
-		m_newfilebuffer = "";
-		starstarFoundQ = 1;
+	if ((m_newfilebuffer.size() > 1) && (m_newfilebuffer.compare(0, 2, "**") == 0)) {
+		m_heldline = m_newfilebuffer;
+		m_newfilebuffer.clear();
+		m_starstarFoundQ = true;
 	}
+	return true;
+}
+
 
+
+//////////////////////////////
+//
+// HumdrumFileStream::readSegmentLine -- Read the next line of the
+//    segment started with startSegment().  Universal comments at the
+//    start of a segment are stored and returned (as global comments)
+//    before the first line of the segment.  Lines which are filenames
+//    are added to the list of input files.  Returns false at the end of
+//    the segment.
+//
+
+bool HumdrumFileStream::readSegmentLine(string& text) {
+	if (m_queueindex < (int)m_queue.size()) {
+		text = m_queue[m_queueindex++];
+		return true;
+	}
+	if (m_input == NULL) {
+		return false;
+	}
+	istream& input = *m_input;
+	string line;
 	while (!input.eof()) {
-		input.getline(templine, 123123, '\n');
-		if ((!dataFoundQ) &&
-				(strncmp(templine, "!!!!SEGMENT", strlen("!!!!SEGMENT")) == 0)) {
-			string tempstring;
-			tempstring = templine;
-			HumRegex hre;
-			if (hre.search(tempstring,
-					"^!!!!SEGMENT\\s*([+-]?\\d+)?\\s*:\\s*(.*)\\s*$")) {
-				if (hre.getMatchLength(1) > 0) {
-					infile.setSegmentLevel(atoi(hre.getMatch(1).c_str()));
-				} else {
-					infile.setSegmentLevel(0);
-				}
-				infile.setFilename(hre.getMatch(2));
-			}
+		getline(input, line);
+		bool segmentQ = line.compare(0, 11, "!!!!SEGMENT") == 0;
+		if ((!m_dataFoundQ) && segmentQ) {
+			// !!!!SEGMENT: came before any real data was read, so
+			// it is the name of the current segment.
+			storeSegmentName(line);
 		}
 
-		if (strncmp(templine, "**", 2) == 0) {
-			if (starstarFoundQ == 1) {
-				m_newfilebuffer = templine;
+		if (line.compare(0, 2, "**") == 0) {
+			if (m_starstarFoundQ) {
 				// already found a **, so this one is defined as a file
-				// segment.  Exit from the loop and process the previous
-				// content, waiting until the next read for to start with
+				// segment.  Wait until the next segment to start with
 				// this line.
-				break;
+				m_newfilebuffer = line;
+				return false;
 			}
-			starstarFoundQ = 1;
+			m_starstarFoundQ = true;
 		}
 
-		if (input.eof() && (strcmp(templine, "") == 0)) {
-			// No more data coming from current stream, so this is
-			// the end of the HumdrumFile.  Break from the while loop
-			// and then store the read contents of the stream in the
-			// HumdrumFile.
-			break;
+		if (input.eof() && line.empty()) {
+			// No more data coming from current stream.
+			return false;
 		}
-		// (1) Does the line start with "!!!!SEGMENT"?  If so, then
-		// this is either the name of the current or next file to process.
-		// (1a) this is the name of the current file to process if no
-		// data has yet been found,
-		// (1b) or a name is being actively searched for.
-		if (strncmp(templine, "!!!!SEGMENT", strlen("!!!!SEGMENT")) == 0) {
-			m_newfilebuffer = templine;
-			if (dataFoundQ) {
-				// this new filename is for the next chunk to process in the
-				// current file stream, not this one, so stop reading the
-				// HumdrumFile content and send what has already been read back
-				// out with new contents.
-			}  else {
-				// !!!!SEGMENT: came before any real data was read, so
-				// it is most likely the name of the current file
-				// (i.e., it comes at the start of the file stream and
-				// is the name of the first HumdrumFile in the stream).
-				HumRegex hre;
-				if (hre.search(m_newfilebuffer,
-						R"(^!!!!SEGMENT\s*([+-]?\d+)?\s:\s*(.*)\s*$)")) {
-					if (hre.getMatchLength(1) > 0) {
-						infile.setSegmentLevel(atoi(hre.getMatch(1).c_str()));
-					} else {
-						infile.setSegmentLevel(0);
-					}
-					infile.setFilename(hre.getMatch(2));
-				}
-			}
+
+		if (segmentQ) {
+			m_newfilebuffer = line;
 		}
-		int len = (int)strlen(templine);
-		if ((len > 4) && (strncmp(templine, "!!!!", 4) == 0) &&
-				(templine[4] != '!') && 
-				(dataFoundQ == 0) && 
-				(strncmp(templine, "!!!!filter:", strlen("!!!!filter:")) != 0) &&
-				(strncmp(templine, "!!!!SEGMENT:", strlen("!!!!SEGMENT:")) != 0)) {
-			// This is a universal comment.  Should it be appended
-			// to the list or should the current list be erased and
-			// this record placed into the first entry?
-			if (foundUniversalQ) {
-				// already found a previous universal, so append.
-				m_universals.push_back(templine);
-			} else {
-				// new universal comment, to delete all previous
-				// universal comments and store this one.
-				m_universals.reserve(1000);
-				m_universals.resize(1);
-				m_universals[0] = templine;
-				foundUniversalQ = 1;
+
+		if ((line.size() > 4) && (line.compare(0, 4, "!!!!") == 0) &&
+				(line[4] != '!') && !m_dataFoundQ &&
+				(line.compare(0, 11, "!!!!filter:") != 0) &&
+				(line.compare(0, 12, "!!!!SEGMENT:") != 0)) {
+			// Universal comment: replaces the universal comments from
+			// previous segments.
+			if (!m_universalQ) {
+				m_universals.clear();
+				m_universalQ = true;
 			}
+			m_universals.push_back(line);
 			continue;
 		}
 
-		if (strncmp(templine, "*-", 2) == 0) {
-			starminusFoundQ = 1;
+		if (line.compare(0, 2, "*-") == 0) {
+			m_starminusFoundQ = true;
 		}
 
 		// if before first ** in a data file or after *-, and the line
 		// does not start with '!' or '*', then assume that it is a file
-		// name which should be added to the file list to read.
-		if (((starminusFoundQ == 1) || (starstarFoundQ == 0))
-				&& (templine[0] != '*') && (templine[0] != '!')) {
-			if ((templine[0] != '\0') && (templine[0] != ' ')) {
-				// The file can only be added once in this manner
-				// so that infinite loops are prevented.
-				int found = 0;
-				for (int mm=0; mm<(int)m_filelist.size(); mm++) {
-					if (strcmp(m_filelist[mm].c_str(), templine) == 0) {
-						found = 1;
-					}
-				}
-				if (!found) {
-					m_filelist.push_back(templine);
-					addedFilename = 1;
+		// name which should be added to the file list to read.  The file
+		// can only be added once in this manner so that infinite loops
+		// are prevented.
+		if ((m_starminusFoundQ || !m_starstarFoundQ) && !line.empty() &&
+				(line[0] != '*') && (line[0] != '!') && (line[0] != ' ')) {
+			bool found = false;
+			for (int i=0; i<(int)m_filelist.size(); i++) {
+				if (m_filelist[i] == line) {
+					found = true;
+					break;
 				}
-				continue;
 			}
+			if (!found) {
+				m_filelist.push_back(line);
+				m_addedFilenameQ = true;
+			}
+			continue;
 		}
 
-		dataFoundQ = 1; // found something other than universal comments
-		// should empty lines be treated somewhat as universal comments?
-
-		// store the data line for later parsing into HumdrumFile record:
-		buffer << templine << "\n";
-	}
+		if (m_dataFoundQ) {
+			text = line;
+			return true;
+		}
 
-	if (dataFoundQ == 0) {
-		// never found anything for some strange reason.
-		if (addedFilename) {
-			goto restarting;
+		// First line of the segment: return the universal comments
+		// (demoted into global comments, except for !!!!filter:) and the
+		// held exclusive interpretation line first.
+		m_dataFoundQ = true;
+		m_queue.clear();
+		m_queueindex = 0;
+		for (int i=0; i<(int)m_universals.size(); i++) {
+			if (m_universals[i].compare(0, 11, "!!!!filter:") == 0) {
+				continue;
+			}
+			m_queue.push_back(m_universals[i].substr(1));
 		}
-		return 0;
+		if (!m_heldline.empty()) {
+			m_queue.push_back(m_heldline);
+			m_heldline.clear();
+		}
+		m_queue.push_back(line);
+		text = m_queue[m_queueindex++];
+		return true;
 	}
+	return false;
+}
 
-	// Arriving here means that reading of the data stream is complete.
-	// The string stream variable "buffer" contains the HumdrumFile
-	// content, so send it to the HumdrumFile variable.  Also, prepend
-	// Universal comments (demoted into Global comments) at the start
-	// of the data stream (maybe allow for postpending Universal comments
-	// in the future).
-	stringstream contents;
-	contents.str(""); // empty any contents in buffer
-	contents.clear(); // reset error flags in buffer
 
-	for (int i=0; i<(int)m_universals.size(); i++) {
-		// Convert universals reference records to globals, but do not demote !!!!filter:
-		if (m_universals[i].compare(0, 11, "!!!!filter:") == 0) {
-			continue;
+
+//////////////////////////////
+//
+// HumdrumFileStream::storeSegmentName -- Store the filename and level
+//    of a !!!!SEGMENT record for the current segment.
+//
+
+void HumdrumFileStream::storeSegmentName(const string& line) {
+	HumRegex hre;
+	if (hre.search(line, R"(^!!!!SEGMENT\s*([+-]?\d+)?\s*:\s*(.*)\s*$)")) {
+		if (hre.getMatchLength(1) > 0) {
+			m_segmentlevel = hre.getMatchInt(1);
+		} else {
+			m_segmentlevel = 0;
 		}
-		contents << &(m_universals[i][1]) << "\n";
+		m_filename = hre.getMatch(2);
 	}
-	contents << buffer.str();
-	string filename = infile.getFilename();
-	infile.readNoRhythm(contents);
-	if (!filename.empty()) {
-		infile.setFilename(filename);
-	}
-	return 1;
 }
 
 
+
 //////////////////////////////
 //
 // HumdrumFileStream::fillUrlBuffer --
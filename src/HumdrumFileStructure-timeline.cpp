@@ -0,0 +1,391 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 09:12:40 PDT 2026
+// Last Modified: Mon Oct 19 06:02:18 PDT 2026
+// Filename:      HumdrumFileStructure-timeline.cpp
+// URL:           https://github.com/craigsapp/humlib/blob/master/src/HumdrumFileStructure-timeline.cpp
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   Integer-tick timeline index for a Humdrum file.  Times
+//                are measured in ticks, where a quarter note is tpq()
+//                ticks long, so all positions in the score are integers.
+//                The index maps times to data lines, note attacks,
+//                barlines and sounding notes using binary searches
+//                rather than linear scans with HumNum comparisons.
+//
+
+#include "HumdrumFileStructure.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace hum {
+
+// START_MERGE
+
+//////////////////////////////
+//
+// HumdrumFileStructure::analyzeTimeline -- Create the tick-based timeline
+//     index for the file.  This is done automatically at the end of
+//     rhythm analysis, but can be called explicitly if the data has
+//     been altered.  The timeline query functions do not build the index
+//     themselves, so they return empty results for a file that has not
+//     been rhythm-analyzed.  Returns false if the rhythm of the file has
+//     not been analyzed.
+//
+
+bool HumdrumFileStructure::analyzeTimeline(void) {
+	m_timeline_analyzed = false;
+	m_lineticks.clear();
+	m_tldatalines.clear();
+	m_tldataticks.clear();
+	m_tlattacks.clear();
+	m_tlattackticks.clear();
+	m_tlbarticks.clear();
+	if (!isRhythmAnalyzed()) {
+		return false;
+	}
+
+	int lcount = getLineCount();
+	m_lineticks.resize(lcount);
+	for (int i=0; i<lcount; i++) {
+		m_lineticks[i] = durationToTicks(m_lines[i]->getDurationFromStart());
+	}
+
+	m_tldatalines.reserve(lcount);
+	m_tldataticks.reserve(lcount);
+	for (int i=0; i<lcount; i++) {
+		if (!m_lines[i]->isData()) {
+			continue;
+		}
+		if (m_lines[i]->getDuration().isPositive()) {
+			m_tldatalines.push_back(i);
+			m_tldataticks.push_back(m_lineticks[i]);
+		}
+		for (int j=0; j<m_lines[i]->getFieldCount(); j++) {
+			HTp token = m_lines[i]->token(j);
+			if (token->isNull()) {
+				continue;
+			}
+			if (!(token->isKern() || token->isMens())) {
+				continue;
+			}
+			if (!token->isNoteAttack()) {
+				continue;
+			}
+			m_tlattacks.push_back(token);
+			m_tlattackticks.push_back(m_lineticks[i]);
+		}
+	}
+
+	// Lines with negative start times (before fillInNegativeStartTimes)
+	// or zero-duration lines may be out of order, so make sure the search
+	// arrays are sorted by time.  A stable sort keeps the line/field order
+	// of simultaneous events.
+	if (!std::is_sorted(m_tldataticks.begin(), m_tldataticks.end())) {
+		vector<int> order(m_tldatalines.size());
+		for (int i=0; i<(int)order.size(); i++) {
+			order[i] = i;
+		}
+		std::stable_sort(order.begin(), order.end(),
+			[&](int a, int b) { return m_tldataticks[a] < m_tldataticks[b]; });
+		vector<int> lines(order.size());
+		vector<int> ticks(order.size());
+		for (int i=0; i<(int)order.size(); i++) {
+			lines[i] = m_tldatalines[order[i]];
+			ticks[i] = m_tldataticks[order[i]];
+		}
+		m_tldatalines.swap(lines);
+		m_tldataticks.swap(ticks);
+	}
+	if (!std::is_sorted(m_tlattackticks.begin(), m_tlattackticks.end())) {
+		vector<int> order(m_tlattacks.size());
+		for (int i=0; i<(int)order.size(); i++) {
+			order[i] = i;
+		}
+		std::stable_sort(order.begin(), order.end(),
+			[&](int a, int b) { return m_tlattackticks[a] < m_tlattackticks[b]; });
+		vector<HTp> attacks(order.size());
+		vector<int> ticks(order.size());
+		for (int i=0; i<(int)order.size(); i++) {
+			attacks[i] = m_tlattacks[order[i]];
+			ticks[i] = m_tlattackticks[order[i]];
+		}
+		m_tlattacks.swap(attacks);
+		m_tlattackticks.swap(ticks);
+	}
+
+	m_tlbarticks.resize(m_barlines.size());
+	for (int i=0; i<(int)m_barlines.size(); i++) {
+		m_tlbarticks[i] = m_lineticks[m_barlines[i]->getLineIndex()];
+	}
+
+	m_timeline_analyzed = true;
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileStructure::durationToTicks -- Convert a duration in quarter
+//     notes into ticks.  Durations which do not fall on a tick are
+//     rounded down.
+//
+
+int HumdrumFileStructure::durationToTicks(HumNum duration) {
+	HumNum value = duration * tpq();
+	int top = value.getNumerator();
+	int bot = value.getDenominator();
+	if (bot == 1) {
+		return top;
+	}
+	int output = top / bot;
+	if ((top < 0) && (top % bot != 0)) {
+		output--;
+	}
+	return output;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileStructure::timeToTick -- Convert a time in quarter notes
+//     from the start of the score into ticks.  Times between ticks are
+//     rounded down to the previous tick.
+//
+
+int HumdrumFileStructure::timeToTick(HumNum time) {
+	return durationToTicks(time);
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileStructure::tickToTime -- Convert a tick position into
+//     quarter notes from the start of the score.
+//
+
+HumNum HumdrumFileStructure::tickToTime(int tick) {
+	return HumNum(tick, tpq());
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileStructure::getLineTick -- Return the starting time of the
+//     line in ticks.  Returns -1 if the line index is invalid or the
+//     rhythm of the file has not been analyzed.
+//
+
+int HumdrumFileStructure::getLineTick(int lineindex) {
+	if (!m_timeline_analyzed) {
+		return -1;
+	}
+	if ((lineindex < 0) || (lineindex >= (int)m_lineticks.size())) {
+		return -1;
+	}
+	return m_lineticks[lineindex];
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileStructure::getScoreTickDuration -- Return the duration of
+//     the score in ticks.
+//
+
+int HumdrumFileStructure::getScoreTickDuration(void) {
+	if (!m_timeline_analyzed || m_lineticks.empty()) {
+		return 0;
+	}
+	return m_lineticks.back();
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileStructure::getDataLineAtTick -- Return the line index of
+//     the data line which is active at the given time: the last data line
+//     with a positive duration that starts at or before the tick.  Returns
+//     -1 if the time is before the first data line or after the end of
+//     the score.
+//
+
+int HumdrumFileStructure::getDataLineAtTick(int tick) {
+	if (!m_timeline_analyzed || m_tldataticks.empty()) {
+		return -1;
+	}
+	if (tick >= getScoreTickDuration()) {
+		return -1;
+	}
+	auto it = std::upper_bound(m_tldataticks.begin(), m_tldataticks.end(), tick);
+	if (it == m_tldataticks.begin()) {
+		return -1;
+	}
+	return m_tldatalines[(it - m_tldataticks.begin()) - 1];
+}
+
+
+int HumdrumFileStructure::getDataLineAtTime(HumNum time) {
+	return getDataLineAtTick(timeToTick(time));
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileStructure::getBarlineTick -- Return the tick position of the
+//     given barline (see getBarline()).  Negative indexes access from the
+//     end of the list.  Returns -1 for an invalid index.
+//
+
+int HumdrumFileStructure::getBarlineTick(int index) {
+	if (!m_timeline_analyzed) {
+		return -1;
+	}
+	if (index < 0) {
+		index += (int)m_tlbarticks.size();
+	}
+	if ((index < 0) || (index >= (int)m_tlbarticks.size())) {
+		return -1;
+	}
+	return m_tlbarticks[index];
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileStructure::getBarlineIndexAtTick -- Return the index of the
+//     barline which starts the measure containing the given time (see
+//     getBarline()).  Returns -1 if there are no barlines or the time is
+//     before the first barline.
+//
+
+int HumdrumFileStructure::getBarlineIndexAtTick(int tick) {
+	if (!m_timeline_analyzed) {
+		return -1;
+	}
+	auto it = std::upper_bound(m_tlbarticks.begin(), m_tlbarticks.end(), tick);
+	if (it == m_tlbarticks.begin()) {
+		return -1;
+	}
+	// If several barlines occur at the same time, the last one is returned.
+	return (int)(it - m_tlbarticks.begin()) - 1;
+}
+
+
+int HumdrumFileStructure::getBarlineIndexAtTime(HumNum time) {
+	return getBarlineIndexAtTick(timeToTick(time));
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileStructure::getAttacksInTickRange -- Return a list of the note
+//     attacks in **kern and **mens spines which start in the time range
+//     [starttick, endtick).  The notes are sorted by start time and then
+//     by line and field order.  Grace notes are included at the time of
+//     the note that they precede.
+//
+
+void HumdrumFileStructure::getAttacksInTickRange(vector<HTp>& attacks,
+		int starttick, int endtick) {
+	attacks.clear();
+	if (!m_timeline_analyzed || (endtick <= starttick)) {
+		return;
+	}
+	auto first = std::lower_bound(m_tlattackticks.begin(),
+			m_tlattackticks.end(), starttick);
+	auto last = std::lower_bound(first, m_tlattackticks.end(), endtick);
+	int i1 = (int)(first - m_tlattackticks.begin());
+	int i2 = (int)(last - m_tlattackticks.begin());
+	attacks.insert(attacks.end(), m_tlattacks.begin() + i1,
+			m_tlattacks.begin() + i2);
+}
+
+
+void HumdrumFileStructure::getAttacksInRange(vector<HTp>& attacks,
+		HumNum starttime, HumNum endtime) {
+	// Convert times into the first tick at or after each time, so that
+	// attacks at non-tick times are not included incorrectly.
+	int starttick = timeToTick(starttime);
+	if (tickToTime(starttick) < starttime) {
+		starttick++;
+	}
+	int endtick = timeToTick(endtime);
+	if (tickToTime(endtick) < endtime) {
+		endtick++;
+	}
+	getAttacksInTickRange(attacks, starttick, endtick);
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileStructure::getSoundingNotesAtTick -- Return a list of the
+//     **kern and **mens notes which are sounding at the given time, one
+//     for each voice (track/subtrack) which is not resting.  Notes
+//     which were attacked before the given time are included (the
+//     token containing the note is returned, which may be the
+//     secondary note of a tie).  If track is non-zero, then only notes
+//     from that track are returned.
+//
+
+void HumdrumFileStructure::getSoundingNotesAtTick(vector<HTp>& notes,
+		int tick, int track) {
+	notes.clear();
+	int line = getDataLineAtTick(tick);
+	if (line < 0) {
+		return;
+	}
+	HumdrumLine& hline = *m_lines[line];
+	for (int j=0; j<hline.getFieldCount(); j++) {
+		HTp token = hline.token(j);
+		if ((track > 0) && (token->getTrack() != track)) {
+			continue;
+		}
+		if (!(token->isKern() || token->isMens())) {
+			continue;
+		}
+		HTp note = token;
+		if (note->isNull()) {
+			note = note->resolveNull();
+			if ((note == NULL) || note->isNull()) {
+				continue;
+			}
+		}
+		if (note->isRest()) {
+			continue;
+		}
+		int starttick = m_lineticks[note->getLineIndex()];
+		int endtick = starttick + durationToTicks(note->getDuration());
+		if ((starttick <= tick) && (tick < endtick)) {
+			notes.push_back(note);
+		}
+	}
+}
+
+
+void HumdrumFileStructure::getSoundingNotes(vector<HTp>& notes,
+		HumNum time, int track) {
+	getSoundingNotesAtTick(notes, timeToTick(time), track);
+}
+
+
+// END_MERGE
+
+} // end namespace hum
+
+
+
@@ -1,7 +1,9 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Mon Aug 17 02:39:28 PDT 2015
-// Last Modified: Mon Aug 17 02:39:32 PDT 2015
+// Last Modified: Sun Oct 18 22:41:07 PDT 2026 Parallel track/strand analysis
+// Last Modified: Mon Oct 19 03:04:18 PDT 2026 Indexed layout parameters
+// Last Modified: Mon Oct 19 06:02:18 PDT 2026 Timeline built with rhythm
 // Filename:      HumdrumFileStructure.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/HumdrumFileStructure.cpp
 // Syntax:        C++11; humlib
@@ -16,6 +18,7 @@
 
 #include "HumdrumFileStructure.h"
 #include "Convert.h"
+#include "HumParallel.h"
 
 #include <string.h>
 
@@ -204,6 +207,7 @@ bool HumdrumFileStructure::analyzeStructure(void) {
 	}
 	if (!analyzeGlobalParameters() ) { return isValid(); }
 	if (!analyzeLocalParameters()  ) { return isValid(); }
+	indexLayoutParameters();
 	if (!analyzeTokenDurations()   ) { return isValid(); }
 	if (!analyzeTokenDurations()   ) { return isValid(); }
 	m_structure_analyzed = true;
@@ -227,6 +231,7 @@ bool HumdrumFileStructure::analyzeStructureNoRhythm(void) {
 	}
 	if (!analyzeGlobalParameters() ) { return isValid(); }
 	if (!analyzeLocalParameters()  ) { return isValid(); }
+	indexLayoutParameters();
 	if (!analyzeTokenDurations()   ) { return isValid(); }
 	analyzeSignifiers();
 	return isValid();
@@ -241,6 +246,7 @@ bool HumdrumFileStructure::analyzeStructureNoRhythm(void) {
 
 bool HumdrumFileStructure::analyzeRhythmStructure(void) {
 	m_rhythm_analyzed = true;
+	m_timeline_analyzed = false;
 	setLineRhythmAnalyzed();
 	if (!isStructureAnalyzed()) {
 		if (!analyzeStructureNoRhythm()) { return isValid(); }
@@ -253,6 +259,10 @@ bool HumdrumFileStructure::analyzeRhythmStructure(void) {
 		if (!analyzeRhythm()           ) { return isValid(); }
 		if (!analyzeDurationsOfNonRhythmicSpines()) { return isValid(); }
 	}
+	// Build the timeline index here rather than on the first query so
+	// that the timeline accessors only read data and can be called from
+	// several threads at once.
+	analyzeTimeline();
 	return isValid();
 }
 
@@ -598,6 +608,77 @@ void HumdrumFileStructure::setLineRhythmAnalyzed(void) {
 }
 
 
+
+//////////////////////////////
+//
+// HumdrumFileStructure::setAnalysisThreadCount -- Set the number of
+//     threads used to analyze independent tracks and strands when
+//     parsing the file.  A value of 1 disables parallel analysis (useful
+//     when files are already being parsed on separate threads).  The
+//     default value of 0 will use all hardware threads, but only for
+//     files which are large enough to benefit.
+//
+
+void HumdrumFileStructure::setAnalysisThreadCount(int count) {
+	m_analysisThreads = count < 0 ? 0 : count;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileStructure::getAnalysisThreadCount -- Return the number
+//     of threads to use for the given number of independent analysis jobs.
+//     For automatic thread counts, small files are analyzed serially since
+//     starting threads would take longer than the analysis.
+//
+
+int HumdrumFileStructure::getAnalysisThreadCount(void) {
+	return m_analysisThreads;
+}
+
+
+int HumdrumFileStructure::getAnalysisThreadCount(int jobcount) {
+	if (jobcount < 2) {
+		return 1;
+	}
+	if (m_analysisThreads > 0) {
+		return m_analysisThreads;
+	}
+	if ((long)getLineCount() * jobcount < 50000) {
+		return 1;
+	}
+	return HumParallel::getThreadCount(0);
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileStructure::hasCrossTrackLinks -- Returns true if any token
+//     links to a token in a different track (such as when spines of
+//     different tracks are merged).
+//
+
+bool HumdrumFileStructure::hasCrossTrackLinks(void) {
+	for (int i=0; i<getLineCount(); i++) {
+		if (!m_lines[i]->isManipulator()) {
+			continue;
+		}
+		for (int j=0; j<m_lines[i]->getTokenCount(); j++) {
+			HTp token = m_lines[i]->token(j);
+			for (int k=0; k<token->getNextTokenCount(); k++) {
+				if (token->getNextToken(k)->getTrack() != token->getTrack()) {
+					return true;
+				}
+			}
+		}
+	}
+	return false;
+}
+
+
+
 //////////////////////////////
 //
 // HumdrumFileStructure::analyzeRhythm -- Analyze the rhythmic structure
@@ -611,9 +692,9 @@ bool HumdrumFileStructure::analyzeRhythm(void) {
 	}
 	int startline = getTrackStart(1)->getLineIndex();
 	int testline;
-	HumNum zero(0);
 
 	int i;
+	vector<HTp> starts;
 	for (int i=1; i<=getMaxTrack(); i++) {
 		if (!getTrackStart(i)->hasRhythm()) {
 			// Can't analyze rhythm of spines that do not have rhythm.
@@ -621,9 +702,7 @@ bool HumdrumFileStructure::analyzeRhythm(void) {
 		}
 		testline = getTrackStart(i)->getLineIndex();
 		if (testline == startline) {
-			if (!assignDurationsToTrack(getTrackStart(i), zero)) {
-				return false;
-			}
+			starts.push_back(getTrackStart(i));
 		} else {
 			// Spine does not start at beginning of data, so
 			// the starting position of the spine has to be
@@ -633,6 +712,9 @@ bool HumdrumFileStructure::analyzeRhythm(void) {
 			continue;
 		}
 	}
+	if (!assignDurationsToTracks(starts)) {
+		return false;
+	}
 
 	// Go back and analyze spines that do not start at the
 	// beginning of the data stream.
@@ -784,11 +866,13 @@ bool HumdrumFileStructure::analyzeGlobalParameters(void) {
 //
 
 bool HumdrumFileStructure::analyzeLocalParameters(void) {
-	// analyze backward tokens:
+	// analyze backward tokens (strands do not share tokens, so they
+	// can be processed at the same time):
 
-	for (int i=0; i<getStrandCount(); i++) {
+	int count = getStrandCount();
+	HumParallel::run(count, getAnalysisThreadCount(count), [&](int i) {
 		processLocalParametersForStrand(i);
-	}
+	});
 
 //	for (int i=1; i<=getMaxTrack(); i++) {
 //		for (int j=0; j<getTrackEndCount(i); j++) {
@@ -804,6 +888,39 @@ bool HumdrumFileStructure::analyzeLocalParameters(void) {
 
 
 
+//////////////////////////////
+//
+// HumdrumFileStructure::indexLayoutParameters -- Resolve the linked
+//     layout parameters of each token into an index (see HumLayoutIndex),
+//     so that HumdrumToken::getLayoutParameter() and related functions
+//     do not need to search the parameters for each query.  This is done
+//     when the structure is analyzed; call it again after changing the
+//     text of layout parameters to rebuild the indexes.
+//
+
+void HumdrumFileStructure::indexLayoutParameters(void) {
+	m_layoutVersion++;
+	for (int i=0; i<getLineCount(); i++) {
+		for (int j=0; j<m_lines[i]->getFieldCount(); j++) {
+			m_lines[i]->token(j)->getLayoutIndex();
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileStructure::getLayoutParameterVersion -- Returns the number
+//     of times that the layout parameters have been indexed.
+//
+
+int HumdrumFileStructure::getLayoutParameterVersion(void) const {
+	return m_layoutVersion;
+}
+
+
+
 //////////////////////////////
 //
 // HumdrumFileStructure::analyzeDurationsOfNonRhythmicSpines -- Calculate the
@@ -970,15 +1087,57 @@ bool HumdrumFileStructure::assignDurationsToTrack(HTp starttoken,
 
 
 
+//////////////////////////////
+//
+// HumdrumFileStructure::assignDurationsToTracks -- Assign durations from
+//    start for a list of tracks which start at the beginning of the data.
+//    For large files, the tracks are analyzed at the same time, with the
+//    line durationFromStart values for each track stored in a separate list.
+//    These lists are then applied to the lines in track order, so the
+//    results (and any rhythm error message) are the same as when analyzing
+//    one track at a time.  Files with spines that merge across tracks are
+//    always analyzed serially since such tracks share tokens.
+//
+
+bool HumdrumFileStructure::assignDurationsToTracks(vector<HTp>& starts) {
+	HumNum zero(0);
+	int threads = getAnalysisThreadCount((int)starts.size());
+	if ((threads <= 1) || hasCrossTrackLinks()) {
+		for (int i=0; i<(int)starts.size(); i++) {
+			if (!assignDurationsToTrack(starts[i], zero)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	vector<vector<pair<HTp, HumNum>>> linedurs(starts.size());
+	HumParallel::run((int)starts.size(), threads, [&](int i) {
+		prepareDurations(starts[i], starts[i]->getState(), zero, &linedurs[i]);
+	});
+	for (int i=0; i<(int)linedurs.size(); i++) {
+		for (int j=0; j<(int)linedurs[i].size(); j++) {
+			if (!setLineDurationFromStart(linedurs[i][j].first, linedurs[i][j].second)) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+
+
 //////////////////////////////
 //
 // HumdrumFileStructure::prepareDurations -- Helper function for
 //     HumdrumFileStructure::assignDurationsToTrack() which does all of the
-//     work for assigning durationFromStart values.
+//     work for assigning durationFromStart values.  If linedurs is not
+//     NULL, then the line durations are stored in it rather than being
+//     assigned to the lines (see assignDurationsToTracks()).
 //
 
 bool HumdrumFileStructure::prepareDurations(HTp token, int state,
-		HumNum startdur) {
+		HumNum startdur, vector<pair<HTp, HumNum>>* linedurs) {
 	if (state != token->getState()) {
 		return isValid();
 	}
@@ -986,7 +1145,7 @@ bool HumdrumFileStructure::prepareDurations(HTp token, int state,
 	HumNum dursum = startdur;
 	token->incrementState();
 
-	if (!setLineDurationFromStart(token, dursum)) { return isValid(); }
+	if (!setLineDurationFromStart(token, dursum, linedurs)) { return isValid(); }
 	if (token->getDuration().isPositive()) {
 		dursum += token->getDuration();
 	}
@@ -1006,7 +1165,7 @@ bool HumdrumFileStructure::prepareDurations(HTp token, int state,
 			break;
 		}
 		token->incrementState();
-		if (!setLineDurationFromStart(token, dursum)) { return isValid(); }
+		if (!setLineDurationFromStart(token, dursum, linedurs)) { return isValid(); }
 		if (token->getDuration().isPositive()) {
 			dursum += token->getDuration();
 		}
@@ -1014,14 +1173,14 @@ bool HumdrumFileStructure::prepareDurations(HTp token, int state,
 	}
 
 	if ((tcount == 0) && (token->isTerminateInterpretation())) {
-		if (!setLineDurationFromStart(token, dursum)) { return isValid(); }
+		if (!setLineDurationFromStart(token, dursum, linedurs)) { return isValid(); }
 	}
 
 	// Process secondary tracks next:
 	int newstate = state;
 
 	for (int i=(int)reservoir.size()-1; i>=0; i--) {
-		prepareDurations(reservoir[i], newstate, startdurs[i]);
+		prepareDurations(reservoir[i], newstate, startdurs[i], linedurs);
 	}
 
 	return isValid();
@@ -1032,11 +1191,17 @@ bool HumdrumFileStructure::prepareDurations(HTp token, int state,
 //////////////////////////////
 //
 // HumdrumFileStructure::setLineDurationFromStart -- Set the duration of
-//      a line based on the analysis of tokens in the spine.
+//      a line based on the analysis of tokens in the spine.  If linedurs
+//      is not NULL, then store the token and duration in it for later
+//      processing instead.
 //
 
 bool HumdrumFileStructure::setLineDurationFromStart(HTp token,
-		HumNum dursum) {
+		HumNum dursum, vector<pair<HTp, HumNum>>* linedurs) {
+	if (linedurs) {
+		linedurs->emplace_back(token, dursum);
+		return true;
+	}
 	if ((!token->isTerminateInterpretation()) &&
 			token->getDuration().isNegative()) {
 		// undefined rhythm, so don't assign line duration information:
@@ -1411,16 +1576,15 @@ bool HumdrumFileStructure::analyzeStrands(void) {
 	int spines = getSpineCount();
 	m_strand1d.resize(0);
 	m_strand2d.resize(0);
+	m_strand2d.resize(spines);
 	int i, j;
-	for (i=0; i<spines; i++) {
-		HTp tok = getSpineStart(i);
-		m_strand2d.resize(m_strand2d.size()+1);
-		analyzeSpineStrands(m_strand2d.back(), tok);
-	}
-
-	for (i=0; i<(int)m_strand2d.size(); i++) {
+	HumParallel::run(spines, getAnalysisThreadCount(spines), [&](int i) {
+		analyzeSpineStrands(m_strand2d[i], getSpineStart(i));
 		std::sort(m_strand2d[i].begin(), m_strand2d[i].end(),
 				sortTokenPairsByLineIndex);
+	});
+
+	for (i=0; i<(int)m_strand2d.size(); i++) {
 		for (j=0; j<(int)m_strand2d[i].size(); j++) {
 			m_strand1d.push_back(m_strand2d[i][j]);
 		}
@@ -2,6 +2,9 @@
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sat Aug  8 12:24:49 PDT 2015
 // Last Modified: Fri Oct 14 11:41:22 PDT 2016 Added insertion functionality
+// Last Modified: Sun Oct 18 16:18:52 PDT 2026 Use interned spine info for tracks
+// Last Modified: Sun Oct 18 16:40:12 PDT 2026 Regenerate dirty lines on output
+// Last Modified: Mon Oct 19 00:41:30 PDT 2026 Precomputed line classes
 // Filename:      HumdrumLine.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/HumdrumLine.cpp
 // Syntax:        C++11; humlib
@@ -76,6 +79,8 @@ HumdrumLine::HumdrumLine(HumdrumLine& line)  : string((string)line) {
 	for (int i=0; i<(int)m_tabs.size(); i++) {
 		m_tabs.at(i) = line.m_tabs.at(i);
 	}
+	m_textdirty = line.m_textdirty;
+	m_class = line.m_class;
 	m_owner = NULL;
 }
 
@@ -94,6 +99,8 @@ HumdrumLine::HumdrumLine(HumdrumLine& line, void* owner) : string((string)line)
 	for (int i=0; i<(int)m_tabs.size(); i++) {
 		m_tabs.at(i) = line.m_tabs.at(i);
 	}
+	m_textdirty = line.m_textdirty;
+	m_class = line.m_class;
 	m_owner = owner;
 }
 
@@ -118,6 +125,8 @@ HumdrumLine& HumdrumLine::operator=(HumdrumLine& line) {
 	for (int i=0; i<(int)m_tabs.size(); i++) {
 		m_tabs.at(i) = line.m_tabs.at(i);
 	}
+	m_textdirty = line.m_textdirty;
+	m_class = line.m_class;
 	m_owner = NULL;
 	return *this;
 }
@@ -197,34 +206,56 @@ void HumdrumLine::setLineFromCsv(const string& csv, const string& separator) {
 	}
 	string& value = *this;
 	value = output;
+	updateLineClass();
 }
 
 
 
 //////////////////////////////
 //
-// HumdrumLine::setText -- Get the textual content of the line.  Note that
-//    you may need to run HumdrumLine::createLineFromTokens() if the tokens
-//    of the line have changed.
+// HumdrumLine::setText -- Set the textual content of the line.  Note that
+//    you will need to run HumdrumLine::createTokensFromLine() to update
+//    the tokens of the line.
 //
 
 void HumdrumLine::setText(const string& text) {
 	string::assign(text);
+	m_textdirty = false;
+	updateLineClass();
 }
 
 
 
 //////////////////////////////
 //
-// HumdrumLine::getText --
+// HumdrumLine::getText -- Return the textual content of the line.  The
+//    text is regenerated from the tokens if any of them have been changed.
+//    Use this function (or updateText()) rather than reading the line
+//    through its std::string interface if the tokens of a line with
+//    spines may have been changed.
 //
 
 string HumdrumLine::getText(void) {
+	updateText();
 	return string(*this);
 }
 
 
 
+//////////////////////////////
+//
+// HumdrumLine::updateText -- Regenerate the line text from the tokens
+//    if the tokens have been changed since the text was last created.
+//
+
+void HumdrumLine::updateText(void) {
+	if (m_textdirty) {
+		createLineFromTokens();
+	}
+}
+
+
+
 //////////////////////////////
 //
 // HumdrumLine::clear -- Remove stored tokens.
@@ -240,6 +271,7 @@ void HumdrumLine::clear(void) {
 	m_tokens.clear();
 	m_tabs.clear();
 	m_rhythm_analyzed = false;
+	updateLineClass();
 }
 
 
@@ -257,7 +289,7 @@ bool HumdrumLine::equalChar(int index, char ch) const {
 	if (index < 0) {
 		return false;
 	}
-	if (((string)(*this))[index] == ch) {
+	if ((*this)[index] == ch) {
 		return true;
 	} else {
 		return false;
@@ -278,7 +310,7 @@ bool HumdrumLine::isKernBoundaryStart(void) const {
 		return false;
 	}
 	for (int i=0; i<getFieldCount(); i++) {
-		if (!token(i)->isDataType("**kern")) {
+		if (!token(i)->isKern()) {
 			continue;
 		}
 		if (token(i)->isNull()) {
@@ -304,7 +336,7 @@ bool HumdrumLine::isKernBoundaryEnd(void) const {
 	}
 	HTp ntok;
 	for (int i=0; i<getFieldCount(); i++) {
-		if (!token(i)->isDataType("**kern")) {
+		if (!token(i)->isKern()) {
 			continue;
 		}
 		ntok = token(i)->getNextToken();
@@ -333,7 +365,7 @@ bool HumdrumLine::isKernBoundaryEnd(void) const {
 //
 
 bool HumdrumLine::isComment(void) const {
-	return equalChar(0, '!');
+	return m_class & LINE_COMMENT;
 }
 
 
@@ -344,7 +376,7 @@ bool HumdrumLine::isComment(void) const {
 //
 
 bool HumdrumLine::isCommentLocal(void) const {
-	return equalChar(0, '!') && !equalChar(1, '!');
+	return (m_class & (LINE_COMMENT | LINE_COMMENT_GLOBAL)) == LINE_COMMENT;
 }
 
 
@@ -355,7 +387,7 @@ bool HumdrumLine::isCommentLocal(void) const {
 //
 
 bool HumdrumLine::isCommentGlobal(void) const {
-	return equalChar(0, '!') && equalChar(1, '!');
+	return m_class & LINE_COMMENT_GLOBAL;
 }
 
 
@@ -640,7 +672,7 @@ string HumdrumLine::getUniversalReferenceValue(void) const {
 //
 
 bool HumdrumLine::isExclusive(void) const {
-	return equalChar(1, '*') && equalChar(0, '*');
+	return m_class & LINE_EXCLUSIVE;
 }
 
 
@@ -672,7 +704,7 @@ bool HumdrumLine::isTerminator(void) const {
 //
 
 bool HumdrumLine::isInterp(void) const {
-	return equalChar(0, '*');
+	return m_class & LINE_INTERPRETATION;
 }
 
 
@@ -683,7 +715,7 @@ bool HumdrumLine::isInterp(void) const {
 //
 
 bool HumdrumLine::isBarline(void) const {
-	return equalChar(0, '=');
+	return m_class & LINE_BARLINE;
 }
 
 
@@ -694,11 +726,7 @@ bool HumdrumLine::isBarline(void) const {
 //
 
 bool HumdrumLine::isData(void) const {
-	if (isComment() || isInterp() || isBarline() || isEmpty()) {
-		return false;
-	} else {
-		return true;
-	}
+	return m_class & LINE_DATA;
 }
 
 
@@ -711,15 +739,7 @@ bool HumdrumLine::isData(void) const {
 //
 
 bool HumdrumLine::isAllNull(void) const {
-	if (!hasSpines()) {
-		return false;
-	}
-	for (int i=0; i<getTokenCount(); i++) {
-		if (!token(i)->isNull()) {
-			return false;
-		}
-	}
-	return true;
+	return (m_class & LINE_ALL_NULL) && hasSpines();
 }
 
 
@@ -1099,12 +1119,64 @@ bool HumdrumLine::isGlobal(void) const {
 //
 
 bool HumdrumLine::isManipulator(void) const {
+	return m_class & LINE_MANIPULATOR;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumLine::updateLineClass -- Store the classes of the line for the
+//   is*() functions.  The text classes (data, interpretation, comment,
+//   etc.) come from the first characters of the line text, and the
+//   manipulator and null classes come from the token classes.  This is
+//   called whenever the line text or the list of tokens is changed, and
+//   by HumdrumToken::setText() when the class of a token changes.
+//
+
+void HumdrumLine::updateLineClass(void) {
+	m_class = 0;
+	if (!empty()) {
+		char firstchar = (*this)[0];
+		char secondchar = size() > 1 ? (*this)[1] : '\0';
+		switch (firstchar) {
+			case '*':
+				m_class |= LINE_INTERPRETATION;
+				if (secondchar == '*') {
+					m_class |= LINE_EXCLUSIVE;
+				}
+				break;
+			case '!':
+				m_class |= LINE_COMMENT;
+				if (secondchar == '!') {
+					m_class |= LINE_COMMENT_GLOBAL;
+				}
+				break;
+			case '=':
+				m_class |= LINE_BARLINE;
+				break;
+			default:
+				m_class |= LINE_DATA;
+		}
+	}
+
+	// A line without tokens counts as all-null, so that isAllNull() is
+	// true for a spined line which has not been tokenized.
+	bool allnull = true;
 	for (int i=0; i<(int)m_tokens.size(); i++) {
+		if (!m_tokens[i]) {
+			continue;
+		}
 		if (m_tokens[i]->isManipulator()) {
-			return true;
+			m_class |= LINE_MANIPULATOR;
+		}
+		if (!m_tokens[i]->isNull()) {
+			allnull = false;
 		}
 	}
-	return false;
+	if (allnull) {
+		m_class |= LINE_ALL_NULL;
+	}
 }
 
 
@@ -1178,6 +1250,7 @@ int HumdrumLine::createTokensFromLine(void) {
 	}
 	m_tokens.clear();
 	m_tabs.clear();
+	m_textdirty = false;
 	HTp token;
 	char ch = 0;
 	char lastch = 0;
@@ -1223,6 +1296,7 @@ int HumdrumLine::createTokensFromLine(void) {
 		m_tabs.push_back(0);
 		tstring.clear();
 	}
+	updateLineClass();
 
 	return (int)m_tokens.size();
 }
@@ -1232,15 +1306,18 @@ int HumdrumLine::createTokensFromLine(void) {
 //////////////////////////////
 //
 // HumdrumLine::createLineFromTokens --  Re-generate a HumdrumLine string from
-//    individual tokens on the line.  This function will be necessary to
-//    run before printing a HumdrumFile if you have changed any tokens on the
-//    line.  Otherwise, changes in the tokens will not be passed on to the
-///   printing of the line.
+//    individual tokens on the line.  Lines are regenerated automatically
+//    when printed or read with getText() if tokens were changed with
+//    HumdrumToken::setText() or the token list of the line was altered
+//    (global lines are regenerated immediately by setText()).  This
+//    function is still needed if tokens were altered through the
+//    std::string interface.
 //
 
 void HumdrumLine::createLineFromTokens(void) {
 	string& iline = *this;
 	iline = "";
+	m_textdirty = false;
 	// needed for empty lines for some reason:
 	if (m_tokens.size()) {
 		if (m_tokens.back() == NULL) {
@@ -1263,6 +1340,7 @@ void HumdrumLine::createLineFromTokens(void) {
 			}
 		}
 	}
+	updateLineClass();
 }
 
 
@@ -1278,6 +1356,7 @@ void HumdrumLine::createLineFromTokens(void) {
 
 void HumdrumLine::removeExtraTabs(void) {
 	fill(m_tabs.begin(), m_tabs.end(), 0);
+	m_textdirty = true;
 }
 
 
@@ -1297,6 +1376,7 @@ void HumdrumLine::addExtraTabs(vector<int>& trackWidths) {
 	}
 
 	fill(m_tabs.begin(), m_tabs.end(), 1);
+	m_textdirty = true;
 	vector<int> local(trackWidths.size(), 0);
 
 	int lasttrack = 0;
@@ -1439,27 +1519,18 @@ bool HumdrumLine::analyzeTracks(string& err) {
 		return !err.size();
 	}
 
-	string info;
+	HumdrumFileBase* owner = (HumdrumFileBase*)m_owner;
 	int track;
 	int maxtrack = 0;
-	int i, j, k;
+	int i;
 
 	for (i=0; i<(int)m_tokens.size(); i++) {
-		info = m_tokens[i]->getSpineInfo();
-		track = 0;
-		for (j=0; j<(int)info.size(); j++) {
-			if (!isdigit(info[j])) {
-				continue;
-			}
-			track = info[j] - '0';
-			for (k=j+1; k<(int)info.size(); k++) {
-				if (isdigit(info[k])) {
-					track = track * 10 + (info[k] - '0');
-				} else {
-					break;
-				}
-			}
-			break;
+		int id = m_tokens[i]->getSpineInfoId();
+		if (owner && (id >= 0)) {
+			// The track number of interned spine info is already known.
+			track = owner->getSpineInfoTrack(id);
+		} else {
+			track = HumAddress::getTrackFromSpineInfo(m_tokens[i]->getSpineInfo());
 		}
 		if (maxtrack < track) {
 			maxtrack = track;
@@ -1934,6 +2005,8 @@ void HumdrumLine::appendToken(HTp token, int tabcount) {
 	// deletion will be handled by class.
 	m_tokens.push_back(token);
 	m_tabs.push_back(tabcount);
+	m_textdirty = true;
+	updateLineClass();
 }
 
 
@@ -1941,6 +2014,8 @@ void HumdrumLine::appendToken(const HumdrumToken& token, int tabcount) {
 	HTp newtok = new HumdrumToken(token);
 	m_tokens.push_back(newtok);
 	m_tabs.push_back(tabcount);
+	m_textdirty = true;
+	updateLineClass();
 }
 
 
@@ -1948,6 +2023,8 @@ void HumdrumLine::appendToken(const string& token, int tabcount) {
 	HTp newtok = new HumdrumToken(token);
 	m_tokens.push_back(newtok);
 	m_tabs.push_back(tabcount);
+	m_textdirty = true;
+	updateLineClass();
 }
 
 
@@ -1955,6 +2032,8 @@ void HumdrumLine::appendToken(const char* token, int tabcount) {
 	HTp newtok = new HumdrumToken(token);
 	m_tokens.push_back(newtok);
 	m_tabs.push_back(tabcount);
+	m_textdirty = true;
+	updateLineClass();
 }
 
 
@@ -1990,6 +2069,8 @@ void HumdrumLine::insertToken(int index, HTp token, int tabcount) {
 	// already belongs to another HumdrumLine or HumdrumFile.
 	m_tokens.insert(m_tokens.begin() + index, token);
 	m_tabs.insert(m_tabs.begin() + index, tabcount);
+	m_textdirty = true;
+	updateLineClass();
 }
 
 
@@ -1997,6 +2078,8 @@ void HumdrumLine::insertToken(int index, const HumdrumToken& token, int tabcount
 	HTp newtok = new HumdrumToken(token);
 	m_tokens.insert(m_tokens.begin() + index, newtok);
 	m_tabs.insert(m_tabs.begin() + index, tabcount);
+	m_textdirty = true;
+	updateLineClass();
 }
 
 
@@ -2004,6 +2087,8 @@ void HumdrumLine::insertToken(int index, const string& token, int tabcount) {
 	HTp newtok = new HumdrumToken(token);
 	m_tokens.insert(m_tokens.begin() + index, newtok);
 	m_tabs.insert(m_tabs.begin() + index, tabcount);
+	m_textdirty = true;
+	updateLineClass();
 }
 
 
@@ -2011,6 +2096,8 @@ void HumdrumLine::insertToken(int index, const char* token, int tabcount) {
 	HTp newtok = new HumdrumToken(token);
 	m_tokens.insert(m_tokens.begin() + index, newtok);
 	m_tabs.insert(m_tabs.begin() + index, tabcount);
+	m_textdirty = true;
+	updateLineClass();
 }
 
 
@@ -2059,11 +2146,13 @@ void HumdrumLine::storeGlobalLinkedParameters(void) {
 //
 
 ostream& operator<<(ostream& out, HumdrumLine& line) {
+	line.updateText();
 	out << (string)line;
 	return out;
 }
 
 ostream& operator<< (ostream& out, HumdrumLine* line) {
+	line->updateText();
 	out << (string)(*line);
 	return out;
 }
@@ -0,0 +1,413 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Mon Oct 19 01:12:40 PDT 2026
+// Last Modified: Mon Oct 19 05:10:31 PDT 2026
+// Filename:      HumdrumLineStream.cpp
+// URL:           https://github.com/craigsapp/humlib/blob/master/src/HumdrumLineStream.cpp
+// Syntax:        C++11; humlib
+// vim:           syntax=cpp ts=3 noexpandtab nowrap
+//
+// Description:   Read Humdrum data one line at a time from the same input
+//                sources as HumdrumFileStream.  Each line is split into
+//                tokens which are given their spine info, track and
+//                subtrack while reading, with the spine state kept up to
+//                date through spine manipulators.  Only the current line
+//                is stored, so filters which do not need the rest of the
+//                file can process large concatenated inputs in constant
+//                memory.
+//
+
+#include "HumdrumLineStream.h"
+#include "HumdrumFileBase.h"
+
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+
+namespace hum {
+
+// START_MERGE
+
+
+//////////////////////////////
+//
+// HumdrumLineStream::HumdrumLineStream -- Constructor.  The input
+//    sources are the same as for HumdrumFileStream.
+//
+
+HumdrumLineStream::HumdrumLineStream(void) : HumdrumFileStream() {
+	// do nothing
+}
+
+HumdrumLineStream::HumdrumLineStream(char** list) : HumdrumFileStream(list) {
+	// do nothing
+}
+
+HumdrumLineStream::HumdrumLineStream(const vector<string>& list) :
+		HumdrumFileStream(list) {
+	// do nothing
+}
+
+HumdrumLineStream::HumdrumLineStream(Options& options) :
+		HumdrumFileStream(options) {
+	// do nothing
+}
+
+HumdrumLineStream::HumdrumLineStream(const string& datastream) :
+		HumdrumFileStream(datastream) {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumLineStream::~HumdrumLineStream -- Deconstructor.
+//
+
+HumdrumLineStream::~HumdrumLineStream() {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumLineStream::getLine -- Read the next line of the input.  The
+//    line and its tokens are only valid until the next call to getLine(),
+//    and the line index is the index of the line in its segment (file).
+//    Returns NULL if there are no more lines to read, or if the spine
+//    structure of the input is invalid (see getError()).
+//
+
+HLp HumdrumLineStream::getLine(void) {
+	if (hasError()) {
+		return NULL;
+	}
+	string text;
+	if (!getText(text)) {
+		return NULL;
+	}
+	if ((!text.empty()) && (text.back() == 0x0d)) {
+		text.resize(text.size() - 1);
+	}
+	m_line.setText(text);
+	m_line.createTokensFromLine();
+	m_line.setLineIndex(++m_lineindex);
+	if (!analyzeSpines()) {
+		return NULL;
+	}
+	return &m_line;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumLineStream::process -- Send each line of the input to a
+//    function.  Returns false if the input could not be parsed.
+//
+
+bool HumdrumLineStream::process(const std::function<void(HumdrumLine&)>& event) {
+	HLp line;
+	while ((line = getLine())) {
+		event(*line);
+	}
+	return !hasError();
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumLineStream::getDataType -- Return the exclusive interpretation
+//    for a field on the current line.  Tokens read by the stream do not
+//    belong to a HumdrumFile, so use this function rather than
+//    HumdrumToken::getDataType() or HumdrumToken::isKern().
+//
+
+const string& HumdrumLineStream::getDataType(int index) const {
+	static const string empty;
+	if ((index < 0) || (index >= (int)m_datatypes.size())) {
+		return empty;
+	}
+	return m_datatypes[index];
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumLineStream::getMaxTrack -- Return the highest track number
+//    found so far in the current segment.
+//
+
+int HumdrumLineStream::getMaxTrack(void) const {
+	return m_maxtrack;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumLineStream::getFilename -- Return the filename of the current
+//    segment (from the input file list or a !!!!SEGMENT: record).
+//
+
+const string& HumdrumLineStream::getFilename(void) const {
+	return m_filename;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumLineStream::getSegmentLevel -- Return the level given in the
+//    !!!!SEGMENT record of the current segment.
+//
+
+int HumdrumLineStream::getSegmentLevel(void) const {
+	return m_segmentlevel;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumLineStream::hasError -- Returns true if the spine structure of
+//    the input was invalid.
+//
+
+bool HumdrumLineStream::hasError(void) const {
+	return !m_error.empty();
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumLineStream::getError -- Return the description of the spine
+//    structure error.
+//
+
+const string& HumdrumLineStream::getError(void) const {
+	return m_error;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumLineStream::setError -- Store a parsing error.  Always returns
+//    false.
+//
+
+bool HumdrumLineStream::setError(const string& message) {
+	stringstream err;
+	err << "Error on line " << (m_lineindex + 1);
+	if (!m_filename.empty()) {
+		err << " of " << m_filename;
+	}
+	err << ":" << endl;
+	err << "   " << message << endl;
+	err << "   LINE: " << m_line << endl;
+	m_error = err.str();
+	return false;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumLineStream::getText -- Get the text of the next line.  The
+//    input is divided into segments by the same reader as
+//    HumdrumFileStream::getFileContents(), so the lines are the same as
+//    the lines of the files read by HumdrumFileStream::getFile().
+//
+
+bool HumdrumLineStream::getText(string& text) {
+	while (true) {
+		if (m_doneQ) {
+			return false;
+		}
+		if (m_input == NULL) {
+			if (!startSegment()) {
+				m_doneQ = true;
+				return false;
+			}
+			resetSpines();
+		}
+		if (readSegmentLine(text)) {
+			return true;
+		}
+		m_input = NULL;
+		if (!m_dataFoundQ) {
+			// Nothing found in the segment.
+			if (m_addedFilenameQ) {
+				continue;
+			}
+			m_doneQ = true;
+			return false;
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumLineStream::resetSpines -- Clear the spine state at the start
+//    of a segment.
+//
+
+void HumdrumLineStream::resetSpines(void) {
+	m_datatypes.clear();
+	m_spineinfo.clear();
+	m_spineids.clear();
+	m_nexttypes.clear();
+	m_nextinfo.clear();
+	m_adjustQ = false;
+	m_maxtrack = 0;
+	m_lineindex = -1;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumLineStream::analyzeSpines -- Set the spine info, track and
+//    subtrack of the tokens on the current line (see
+//    HumdrumFileBase::analyzeSpines()).  The spine info strings are
+//    only interned when the spine structure changes.
+//
+
+bool HumdrumLineStream::analyzeSpines(void) {
+	if (!m_line.hasSpines()) {
+		m_line.token(0)->setFieldIndex(0);
+		return true;
+	}
+
+	if (m_adjustQ) {
+		m_datatypes.swap(m_nexttypes);
+		m_spineinfo.swap(m_nextinfo);
+		m_spineids.clear();
+		m_adjustQ = false;
+	}
+
+	int count = m_line.getTokenCount();
+	bool initQ = false;
+	if (m_datatypes.empty()) {
+		if (!m_line.isExclusive()) {
+			return setError("Data found before exclusive interpretation");
+		}
+		initQ = true;
+		m_maxtrack = count;
+		m_datatypes.resize(count);
+		m_spineinfo.resize(count);
+		for (int j=0; j<count; j++) {
+			m_datatypes[j] = *m_line.token(j);
+			m_spineinfo[j] = to_string(j+1);
+		}
+	}
+
+	if ((int)m_datatypes.size() != count) {
+		return setError("Expected " + to_string(m_datatypes.size())
+				+ " fields, but found " + to_string(count));
+	}
+
+	bool internQ = m_spineids.empty();
+	if (internQ) {
+		m_spineids.resize(count);
+	}
+	for (int j=0; j<count; j++) {
+		HTp token = m_line.token(j);
+		if (internQ) {
+			token->setSpineInfo(m_spineinfo[j]);
+			m_spineids[j] = token->getSpineInfoId();
+		} else {
+			token->setSpineInfoId(m_spineids[j]);
+		}
+		token->setFieldIndex(j);
+		if ((!initQ) && (token->compare(0, 2, "**") == 0)) {
+			if (!m_datatypes[j].empty()) {
+				return setError("Exclusive interpretation with no preparation");
+			}
+			m_datatypes[j] = *token;
+		}
+	}
+
+	string err;
+	if (!m_line.analyzeTracks(err)) {
+		return setError(err);
+	}
+
+	if ((!initQ) && m_line.isManipulator()) {
+		return adjustSpines();
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumLineStream::adjustSpines -- Calculate the spine state after a
+//    manipulator line (see HumdrumFileBase::adjustSpines()).
+//
+
+bool HumdrumLineStream::adjustSpines(void) {
+	m_nexttypes.clear();
+	m_nextinfo.clear();
+	int count = m_line.getTokenCount();
+	for (int i=0; i<count; i++) {
+		HTp token = m_line.token(i);
+		if (token->isSplitInterpretation()) {
+			m_nexttypes.push_back(m_datatypes[i]);
+			m_nexttypes.push_back(m_datatypes[i]);
+			m_nextinfo.push_back('(' + m_spineinfo[i] + ")a");
+			m_nextinfo.push_back('(' + m_spineinfo[i] + ")b");
+		} else if (token->isMergeInterpretation()) {
+			int mergecount = 0;
+			for (int j=i+1; j<count; j++) {
+				if (!m_line.token(j)->isMergeInterpretation()) {
+					break;
+				}
+				mergecount++;
+			}
+			m_nexttypes.push_back(m_datatypes[i]);
+			m_nextinfo.push_back(HumdrumFileBase::getMergedSpineInfo(m_spineinfo,
+					i, mergecount));
+			i += mergecount;
+		} else if (token->isAddInterpretation()) {
+			m_nexttypes.push_back(m_datatypes[i]);
+			m_nexttypes.push_back("");
+			m_nextinfo.push_back(m_spineinfo[i]);
+			m_nextinfo.push_back(to_string(++m_maxtrack));
+		} else if (token->isExchangeInterpretation()) {
+			if (i >= count - 1) {
+				return setError("Exchange manipulator in last field");
+			}
+			m_nexttypes.push_back(m_datatypes[i+1]);
+			m_nexttypes.push_back(m_datatypes[i]);
+			m_nextinfo.push_back(m_spineinfo[i+1]);
+			m_nextinfo.push_back(m_spineinfo[i]);
+			i++;
+		} else if (token->isTerminateInterpretation()) {
+			// spine ends
+		} else {
+			m_nexttypes.push_back(m_datatypes[i]);
+			m_nextinfo.push_back(m_spineinfo[i]);
+		}
+	}
+	m_adjustQ = true;
+	return true;
+}
+
+
+// END_MERGE
+
+} // end namespace hum
+
+
+
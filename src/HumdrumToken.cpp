@@ -1,7 +1,10 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sat Aug  8 12:24:49 PDT 2015
-// Last Modified: Sun Aug  9 21:03:12 PDT 2015
+// Last Modified: Sun Oct 18 16:21:05 PDT 2026 Interned data types
+// Last Modified: Sun Oct 18 16:40:12 PDT 2026 Mark owner line dirty in setText
+// Last Modified: Mon Oct 19 00:41:30 PDT 2026 Precomputed token classes
+// Last Modified: Mon Oct 19 03:04:18 PDT 2026 Indexed layout parameters
 // Filename:      HumdrumToken.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/HumdrumToken.cpp
 // Syntax:        C++11; humlib
@@ -51,6 +54,7 @@ HumdrumToken::HumdrumToken(void) : string() {
 	setPrefix("!");
 	m_strand = -1;
 	m_nullresolve = NULL;
+	updateTokenClass();
 }
 
 
@@ -59,6 +63,7 @@ HumdrumToken::HumdrumToken(const string& aString) : string(aString) {
 	setPrefix("!");
 	m_strand = -1;
 	m_nullresolve = NULL;
+	updateTokenClass();
 }
 
 
@@ -67,6 +72,7 @@ HumdrumToken::HumdrumToken(const char* aString) : string(aString) {
 	setPrefix("!");
 	m_strand = -1;
 	m_nullresolve = NULL;
+	updateTokenClass();
 }
 
 
@@ -83,6 +89,7 @@ HumdrumToken::HumdrumToken(const HumdrumToken& token) :
 	m_strand          = -1;
 	m_nullresolve     = NULL;
 	setPrefix(token.getPrefix());
+	updateTokenClass();
 }
 
 
@@ -99,6 +106,7 @@ HumdrumToken::HumdrumToken(HumdrumToken* token) :
 	m_strand          = -1;
 	m_nullresolve     = NULL;
 	setPrefix(token->getPrefix());
+	updateTokenClass();
 }
 
 
@@ -116,6 +124,7 @@ HumdrumToken::HumdrumToken(const HumdrumToken& token, HumdrumLine* owner) :
 	m_strand          = -1;
 	m_nullresolve     = NULL;
 	setPrefix(token.getPrefix());
+	updateTokenClass();
 }
 
 
@@ -132,6 +141,7 @@ HumdrumToken::HumdrumToken(HumdrumToken* token, HumdrumLine* owner) :
 	m_strand          = -1;
 	m_nullresolve     = NULL;
 	setPrefix(token->getPrefix());
+	updateTokenClass();
 }
 
 
@@ -159,6 +169,7 @@ HumdrumToken& HumdrumToken::operator=(HumdrumToken& token) {
 	m_strand          = -1;
 	m_nullresolve     = NULL;
 	setPrefix(token.getPrefix());
+	updateTokenClass();
 
 	return *this;
 }
@@ -177,6 +188,7 @@ HumdrumToken& HumdrumToken::operator=(const string& token) {
 	m_strand          = -1;
 	m_nullresolve     = NULL;
 	setPrefix("!");
+	updateTokenClass();
 
 	return *this;
 }
@@ -195,6 +207,7 @@ HumdrumToken& HumdrumToken::operator=(const char* token) {
 	m_strand          = -1;
 	m_nullresolve     = NULL;
 	setPrefix("!");
+	updateTokenClass();
 
 	return *this;
 }
@@ -211,6 +224,10 @@ HumdrumToken::~HumdrumToken() {
 		delete m_linkedParameter;
 		m_linkedParameter = NULL;
 	}
+	if (m_layoutIndex) {
+		delete m_layoutIndex;
+		m_layoutIndex = NULL;
+	}
 }
 
 
@@ -321,7 +338,7 @@ HumdrumToken* HumdrumToken::getNextNonNullDataToken(int index) {
 //
 
 HumNum HumdrumToken::getSlurDuration(HumNum scale) {
-	if (!isDataType("**kern")) {
+	if (!isKern()) {
 		return 0;
 	}
 	if (isDefined("auto", "slurDuration")) {
@@ -367,6 +384,21 @@ bool HumdrumToken::isDataType(const string& dtype) const {
 
 
 
+//////////////////////////////
+//
+// HumdrumToken::getDataTypeId -- Returns the ID of the exclusive
+//   interpretation of the token in the owning file.  This can be compared
+//   to HumdrumFile::getDataTypeId() for a data type rather than comparing
+//   strings with isDataType().
+// @SEEALSO: isDataType
+//
+
+int HumdrumToken::getDataTypeId(void) const {
+	return m_address.getDataTypeId();
+}
+
+
+
 //////////////////////////////
 //
 // HumdrumToken::isKern -- Returns true if the data type of the token
@@ -375,7 +407,7 @@ bool HumdrumToken::isDataType(const string& dtype) const {
 //
 
 bool HumdrumToken::isKern(void) const {
-	return isDataType("**kern");
+	return m_address.getDataTypeId() == HumAddress::DATATYPE_KERN;
 }
 
 
@@ -388,7 +420,7 @@ bool HumdrumToken::isKern(void) const {
 //
 
 bool HumdrumToken::isMens(void) const {
-	return isDataType("**mens");
+	return m_address.getDataTypeId() == HumAddress::DATATYPE_MENS;
 }
 
 
@@ -405,6 +437,19 @@ void HumdrumToken::setSpineInfo(const string& spineinfo) {
 
 
 
+//////////////////////////////
+//
+// HumdrumToken::setSpineInfoId -- Sets the spine manipulation history
+//     from an ID in the spine info table of the owning file.
+// @SEEALTO: getSpineInfoId
+//
+
+void HumdrumToken::setSpineInfoId(int id) {
+	m_address.setSpineInfoId(id);
+}
+
+
+
 //////////////////////////////
 //
 // HumdrumToken::getSpineInfo -- Returns the spine split/merge history
@@ -412,12 +457,26 @@ void HumdrumToken::setSpineInfo(const string& spineinfo) {
 // @SEEALTO: setSpineInfo
 //
 
-string HumdrumToken::getSpineInfo(void) const {
+const string& HumdrumToken::getSpineInfo(void) const {
 	return m_address.getSpineInfo();
 }
 
 
 
+//////////////////////////////
+//
+// HumdrumToken::getSpineInfoId -- Returns the ID of the spine info string
+//    in the owning file.  Tokens in the same file have the same spine info
+//    when their IDs are the same.
+// @SEEALTO: getSpineInfo
+//
+
+int HumdrumToken::getSpineInfoId(void) const {
+	return m_address.getSpineInfoId();
+}
+
+
+
 //////////////////////////////
 //
 // HumdrumToken::getLineIndex -- Returns the line index of the owning
@@ -767,13 +826,7 @@ bool HumdrumToken::analyzeDuration(void) {
 //
 
 bool HumdrumToken::isManipulator(void) const {
-	if (isSplitInterpretation())     { return true; }
-	if (isMergeInterpretation())     { return true; }
-	if (isExchangeInterpretation())  { return true; }
-	if (isAddInterpretation())       { return true; }
-	if (isTerminateInterpretation()) { return true; }
-	if (isExclusiveInterpretation()) { return true; }
-	return false;
+	return m_class & TOKEN_MANIPULATOR;
 }
 
 
@@ -1175,7 +1228,7 @@ bool HumdrumToken::isNoteAttack(void) {
 //
 
 bool HumdrumToken::isInvisible(void) {
-	if (!isDataType("**kern")) {
+	if (!isKern()) {
 			return false;
 	}
 	if (isBarline()) {
@@ -1199,7 +1252,7 @@ bool HumdrumToken::isInvisible(void) {
 //
 
 bool HumdrumToken::isGrace(void) {
-	if (!isDataType("**kern")) {
+	if (!isKern()) {
 			return false;
 	}
 	if (!isData()) {
@@ -1219,7 +1272,7 @@ bool HumdrumToken::isGrace(void) {
 //
 
 bool HumdrumToken::isClef(void) {
-	if (!(isDataType("**kern") || isDataType("**mens"))) {
+	if (!(isKern() || isMens())) {
 			return false;
 	}
 	if (!isInterpretation()) {
@@ -1346,7 +1399,7 @@ bool HumdrumToken::isMensurationSymbol(void) {
 //
 
 bool HumdrumToken::hasSlurStart(void) {
-	if (isDataType("**kern")) {
+	if (isKern()) {
 		if (Convert::hasKernSlurStart((string)(*this))) {
 			return true;
 		}
@@ -1363,7 +1416,7 @@ bool HumdrumToken::hasSlurStart(void) {
 //
 
 bool HumdrumToken::hasSlurEnd(void) {
-	if (isDataType("**kern")) {
+	if (isKern()) {
 		if (Convert::hasKernSlurEnd((string)(*this))) {
 			return true;
 		}
@@ -1545,7 +1598,7 @@ bool HumdrumToken::hasObliquaLigatureEnd(void) {
 //
 
 bool HumdrumToken::isSecondaryTiedNote(void) {
-	if (isDataType("**kern")) {
+	if (isKern()) {
 		if (Convert::isKernSecondaryTiedNote((string)(*this))) {
 			return true;
 		}
@@ -1562,14 +1615,7 @@ bool HumdrumToken::isSecondaryTiedNote(void) {
 //
 
 bool HumdrumToken::isBarline(void) const {
-	if (size() == 0) {
-		return false;
-	}
-	if ((*this)[0] == '=') {
-		return true;
-	} else {
-		return false;
-	}
+	return m_class & TOKEN_BARLINE;
 }
 
 
@@ -1581,18 +1627,7 @@ bool HumdrumToken::isBarline(void) const {
 //
 
 bool HumdrumToken::isCommentGlobal(void) const {
-	if (size() == 0) {
-		return false;
-	}
-	if ((*this)[0] == '!') {
-		if (size() > 1) {
-			if ((*this)[1] == '!') {
-				// global comment
-				return true;
-			}
-		}
-	}
-	return false;
+	return m_class & TOKEN_COMMENT_GLOBAL;
 }
 
 
@@ -1604,20 +1639,7 @@ bool HumdrumToken::isCommentGlobal(void) const {
 //
 
 bool HumdrumToken::isCommentLocal(void) const {
-	if (size() == 0) {
-		return false;
-	}
-	if ((*this)[0] == '!') {
-		if (size() > 1) {
-			if ((*this)[1] == '!') {
-				// global comment
-				return false;
-			}
-		}
-		return true;
-	} else {
-		return false;
-	}
+	return (m_class & (TOKEN_COMMENT | TOKEN_COMMENT_GLOBAL)) == TOKEN_COMMENT;
 }
 
 
@@ -1628,14 +1650,7 @@ bool HumdrumToken::isCommentLocal(void) const {
 //
 
 bool HumdrumToken::isComment(void) const {
-	if (size() == 0) {
-		return false;
-	}
-	if ((*this)[0] == '!') {
-		return true;
-	} else {
-		return false;
-	}
+	return m_class & TOKEN_COMMENT;
 }
 
 
@@ -1649,14 +1664,7 @@ bool HumdrumToken::isComment(void) const {
 //
 
 bool HumdrumToken::isData(void) const {
-	if (size() == 0) {
-		return false;
-	}
-	int firstchar = (*this)[0];
-	if ((firstchar == '*') || (firstchar == '!') || (firstchar == '=')) {
-		return false;
-	}
-	return true;
+	return m_class & TOKEN_DATA;
 }
 
 
@@ -1667,14 +1675,7 @@ bool HumdrumToken::isData(void) const {
 //
 
 bool HumdrumToken::isInterpretation(void) const {
-	if (size() == 0) {
-		return false;
-	}
-	int firstchar = (*this)[0];
-	if (firstchar == '*') {
-		return true;
-	}
-	return false;
+	return m_class & TOKEN_INTERPRETATION;
 }
 
 
@@ -1686,7 +1687,7 @@ bool HumdrumToken::isInterpretation(void) const {
 //
 
 bool HumdrumToken::isNonNullData(void) const {
-	return isData() && !isNull();
+	return (m_class & (TOKEN_DATA | TOKEN_NULL)) == TOKEN_DATA;
 }
 
 
@@ -1698,7 +1699,7 @@ bool HumdrumToken::isNonNullData(void) const {
 //
 
 bool HumdrumToken::isNullData(void) const {
-	return isData() && isNull();
+	return (m_class & (TOKEN_DATA | TOKEN_NULL)) == (TOKEN_DATA | TOKEN_NULL);
 }
 
 
@@ -1741,8 +1742,7 @@ bool HumdrumToken::isChord(const string& separator) {
 //
 
 bool HumdrumToken::isExclusiveInterpretation(void) const {
-	const string& tok = (string)(*this);
-	return tok.substr(0, 2) == "**";
+	return m_class & TOKEN_EXCLUSIVE;
 }
 
 
@@ -1753,7 +1753,7 @@ bool HumdrumToken::isExclusiveInterpretation(void) const {
 //
 
 bool HumdrumToken::isSplitInterpretation(void) const {
-	return ((string)(*this)) == SPLIT_TOKEN;
+	return m_class & TOKEN_SPLIT;
 }
 
 
@@ -1764,7 +1764,7 @@ bool HumdrumToken::isSplitInterpretation(void) const {
 //
 
 bool HumdrumToken::isMergeInterpretation(void) const {
-	return ((string)(*this)) == MERGE_TOKEN;
+	return m_class & TOKEN_MERGE;
 }
 
 
@@ -1775,7 +1775,7 @@ bool HumdrumToken::isMergeInterpretation(void) const {
 //
 
 bool HumdrumToken::isExchangeInterpretation(void) const {
-	return ((string)(*this)) == EXCHANGE_TOKEN;
+	return m_class & TOKEN_EXCHANGE;
 }
 
 
@@ -1786,7 +1786,7 @@ bool HumdrumToken::isExchangeInterpretation(void) const {
 //
 
 bool HumdrumToken::isTerminateInterpretation(void) const {
-	return ((string)(*this)) == TERMINATE_TOKEN;
+	return m_class & TOKEN_TERMINATE;
 }
 
 
@@ -1797,7 +1797,7 @@ bool HumdrumToken::isTerminateInterpretation(void) const {
 //
 
 bool HumdrumToken::isAddInterpretation(void) const {
-	return ((string)(*this)) == ADD_TOKEN;
+	return m_class & TOKEN_ADD;
 }
 
 
@@ -1810,11 +1810,61 @@ bool HumdrumToken::isAddInterpretation(void) const {
 //
 
 bool HumdrumToken::isNull(void) const {
-	const string& tok = (string)(*this);
-	if (tok == NULL_DATA)           { return true; }
-	if (tok == NULL_INTERPRETATION) { return true; }
-	if (tok == NULL_COMMENT_LOCAL)  { return true; }
-	return false;
+	return m_class & TOKEN_NULL;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumToken::updateTokenClass -- Store the classes of the token text
+//   (data, interpretation, null, manipulator, etc.) for the is*()
+//   functions.  Only the first two characters and the length of the text
+//   are needed to identify the classes.
+//
+
+void HumdrumToken::updateTokenClass(void) {
+	m_class = 0;
+	int length = (int)size();
+	if (length == 0) {
+		return;
+	}
+	char firstchar = (*this)[0];
+	char secondchar = length > 1 ? (*this)[1] : '\0';
+	switch (firstchar) {
+		case '*':
+			m_class |= TOKEN_INTERPRETATION;
+			if (length == 1) {
+				m_class |= TOKEN_NULL;
+			} else if (secondchar == '*') {
+				m_class |= TOKEN_EXCLUSIVE | TOKEN_MANIPULATOR;
+			} else if (length == 2) {
+				switch (secondchar) {
+					case '^': m_class |= TOKEN_SPLIT     | TOKEN_MANIPULATOR; break;
+					case 'v': m_class |= TOKEN_MERGE     | TOKEN_MANIPULATOR; break;
+					case 'x': m_class |= TOKEN_EXCHANGE  | TOKEN_MANIPULATOR; break;
+					case '+': m_class |= TOKEN_ADD       | TOKEN_MANIPULATOR; break;
+					case '-': m_class |= TOKEN_TERMINATE | TOKEN_MANIPULATOR; break;
+				}
+			}
+			break;
+		case '!':
+			m_class |= TOKEN_COMMENT;
+			if (secondchar == '!') {
+				m_class |= TOKEN_COMMENT_GLOBAL;
+			} else if (length == 1) {
+				m_class |= TOKEN_NULL;
+			}
+			break;
+		case '=':
+			m_class |= TOKEN_BARLINE;
+			break;
+		default:
+			m_class |= TOKEN_DATA;
+			if ((length == 1) && (firstchar == '.')) {
+				m_class |= TOKEN_NULL;
+			}
+	}
 }
 
 
@@ -2049,7 +2099,33 @@ void HumdrumToken::setParameters(const string& pdata, HumdrumToken* ptok) {
 //
 
 void HumdrumToken::setText(const string& text) {
+	bool exinterp = (this->compare(0, 2, "**") == 0);
+	unsigned int oldclass = m_class;
 	string::assign(text);
+	updateTokenClass();
+	HumdrumLine* line = getOwner();
+	if (!line) {
+		return;
+	}
+	if (line->hasSpines()) {
+		// The line text will be regenerated from the tokens when printed.
+		line->markTextDirty();
+	} else {
+		// Global lines have a single token, so update the line text now,
+		// so that reference records can be read from the line string.
+		line->createLineFromTokens();
+	}
+	if (m_class != oldclass) {
+		line->updateLineClass();
+	}
+	if (exinterp || (this->compare(0, 2, "**") == 0)) {
+		// Keep the data type of the track up to date if the token
+		// starts a track.
+		HumdrumFile* file = line->getOwner();
+		if (file) {
+			file->updateTrackDataType(this);
+		}
+	}
 }
 
 
@@ -2077,6 +2153,10 @@ int HumdrumToken::addLinkedParameter(HTp token) {
 		}
 	}
 
+	if (m_layoutIndex) {
+		m_layoutIndex->clear();
+	}
+
 	if (m_linkedParameters.empty()) {
 		m_linkedParameters.push_back(token);
 	} else {
@@ -2153,6 +2233,45 @@ void HumdrumToken::storeLinkedParameters(void) {
 
 
 
+//////////////////////////////
+//
+// HumdrumToken::getLayoutIndex -- Return the index of the linked layout
+//     parameters, or NULL if there are no linked parameters.  The index
+//     is built when it is first needed, and rebuilt if a parameter has
+//     been linked since then, or if the layout parameters of the owning
+//     file have been indexed again (see
+//     HumdrumFileStructure::indexLayoutParameters()).
+//
+
+HumLayoutIndex* HumdrumToken::getLayoutIndex(void) {
+	if (m_linkedParameters.empty()) {
+		return NULL;
+	}
+	int version = 0;
+	HumdrumLine* line = getOwner();
+	if (line && line->getOwner()) {
+		version = line->getOwner()->getLayoutParameterVersion();
+	}
+	if (m_layoutIndex && (m_layoutIndex->getVersion() == version)) {
+		return m_layoutIndex;
+	}
+	if (m_layoutIndex) {
+		m_layoutIndex->clear();
+	} else {
+		m_layoutIndex = new HumLayoutIndex;
+	}
+	for (int i=0; i<(int)m_linkedParameters.size(); i++) {
+		HumParamSet* hps = getLinkedParameter(i);
+		if (hps) {
+			m_layoutIndex->addParameterSet(*hps);
+		}
+	}
+	m_layoutIndex->setVersion(version);
+	return m_layoutIndex;
+}
+
+
+
 //////////////////////////////
 //
 // HumdrumToken::makeForwardLink -- Line a following spine token to this one.
@@ -2250,70 +2369,12 @@ std::string HumdrumToken::getLayoutParameter(const std::string& category,
 		}
 	}
 
-	std::string output;
-	int lcount = this->getLinkedParameterCount();
-	if (lcount == 0) {
-		return output;
-	}
-
-	std::string nparam;
-	for (int p = 0; p < this->getLinkedParameterCount(); ++p) {
-		hum::HumParamSet *hps = this->getLinkedParameter(p);
-		if (hps == NULL) {
-			continue;
-		}
-		if (hps->getNamespace1() != "LO") {
-			continue;
-		}
-		if (hps->getNamespace2() != category) {
-			continue;
-		}
-
-		output = "";
-		for (int q = 0; q < hps->getCount(); ++q) {
-			string key = hps->getParameterName(q);
-			if (key == keyname) {
-				output = hps->getParameterValue(q);
-				if (subtokenindex < 0) {
-					return output;
-				}
-			}
-			if (key == "n") {
-				nparam = hps->getParameterValue(q);
-			}
-		}
-		if (nparam.empty()) {
-			// No subtoken selection for this parameter,
-			// so return if not empty:
-			if (!output.empty()) {
-				return output;
-			}
-		} else if (subtokenindex < 0) {
-			// No subtoken selection so return output if not empty
-			if (!output.empty()) {
-				return output;
-			}
-		} else {
-			// There is a subtoken selection number, so
-			// return output if n matches it (minus one)
-
-			// currently @n requires a single value
-			// (should allow a range or multiple values
-			// later).  Also not checking validity of
-			// string first (needs to start with a digit);
-
-			int n = stoi(nparam);
-			if (n == subtokenindex + 1) {
-				return output;
-			} else {
-				// not the output that is required,
-				// so suppress for end of loop:
-				output = "";
-			}
-		}
+	// Then the linked parameters (see HumLayoutIndex::getValue()):
+	HumLayoutIndex* index = getLayoutIndex();
+	if (!index) {
+		return "";
 	}
-
-	return output;
+	return index->getValue(category, keyname, subtokenindex);
 }
 
 
@@ -2341,33 +2402,12 @@ std::string HumdrumToken::getSlurLayoutParameter(const std::string& keyname,
 		}
 	}
 
-	int lcount = this->getLinkedParameterCount();
-	if (lcount == 0) {
+	HumLayoutIndex* index = getLayoutIndex();
+	if (!index) {
 		return output;
 	}
-
-	std::string sparam;
-	for (int p = 0; p < this->getLinkedParameterCount(); ++p) {
-		hum::HumParamSet *hps = this->getLinkedParameter(p);
-		if (hps == NULL) {
-			continue;
-		}
-		if (hps->getNamespace1() != "LO") {
-			continue;
-		}
-		if (hps->getNamespace2() != category) {
-			continue;
-		}
-		for (int q = 0; q < hps->getCount(); ++q) {
-			string key = hps->getParameterName(q);
-			if (key == "s") {
-				sparam = hps->getParameterValue(q);
-			}
-			if (key == keyname) {
-				output = hps->getParameterValue(q);
-			}
-		}
-	}
+	const std::string& sparam = index->getLastValue(category, "s");
+	output = index->getLastValue(category, keyname);
 	if (subtokenindex < 0) {
 		// do not filter by s parameter
 		return output;
@@ -2408,34 +2448,12 @@ std::string HumdrumToken::getLayoutParameterChord(const std::string& category,
 		}
 	}
 
-	std::string output;
-	int lcount = this->getLinkedParameterCount();
-	if (lcount == 0) {
-		return output;
-	}
-
-	std::string nparam;
-	for (int p = 0; p < this->getLinkedParameterCount(); ++p) {
-		hum::HumParamSet *hps = this->getLinkedParameter(p);
-		if (hps == NULL) {
-			continue;
-		}
-		if (hps->getNamespace1() != "LO") {
-			continue;
-		}
-		if (hps->getNamespace2() != category) {
-			continue;
-		}
-		for (int q = 0; q < hps->getCount(); ++q) {
-			string key = hps->getParameterName(q);
-			if (key == "n") {
-				nparam = hps->getParameterValue(q);
-			}
-			if (key == keyname) {
-				output = hps->getParameterValue(q);
-			}
-		}
+	HumLayoutIndex* index = getLayoutIndex();
+	if (!index) {
+		return "";
 	}
+	const std::string& nparam = index->getLastValue(category, "n");
+	const std::string& output = index->getLastValue(category, keyname);
 
 	if (!nparam.empty()) {
 		// parameter is qualified by a note number, so does not apply to whole token
@@ -2469,34 +2487,12 @@ std::string HumdrumToken::getLayoutParameterNote(const std::string& category,
 		}
 	}
 
-	std::string output;
-	int lcount = this->getLinkedParameterCount();
-	if (lcount == 0) {
-		return output;
-	}
-
-	std::string nparam;
-	for (int p = 0; p < this->getLinkedParameterCount(); ++p) {
-		hum::HumParamSet *hps = this->getLinkedParameter(p);
-		if (hps == NULL) {
-			continue;
-		}
-		if (hps->getNamespace1() != "LO") {
-			continue;
-		}
-		if (hps->getNamespace2() != category) {
-			continue;
-		}
-		for (int q = 0; q < hps->getCount(); ++q) {
-			string key = hps->getParameterName(q);
-			if (key == "n") {
-				nparam = hps->getParameterValue(q);
-			}
-			if (key == keyname) {
-				output = hps->getParameterValue(q);
-			}
-		}
+	HumLayoutIndex* index = getLayoutIndex();
+	if (!index) {
+		return "";
 	}
+	const std::string& nparam = index->getLastValue(category, "n");
+	const std::string& output = index->getLastValue(category, keyname);
 
 	if (!nparam.empty()) {
 		// a number number is specified from the parameter(s)
@@ -2576,7 +2572,7 @@ int  HumdrumToken::getStrandIndex(void) const {
 //
 
 int HumdrumToken::getSlurStartElisionLevel(int index) const {
-	if (isDataType("**kern") || isDataType("**mens")) {
+	if (isKern() || isMens()) {
 		return Convert::getKernSlurStartElisionLevel((string)(*this), index);
 	} else {
 		return -1;
@@ -2594,7 +2590,7 @@ int HumdrumToken::getSlurStartElisionLevel(int index) const {
 //
 
 int HumdrumToken::getSlurEndElisionLevel(int index) const {
-	if (isDataType("**kern") || isDataType("**mens")) {
+	if (isKern() || isMens()) {
 		return Convert::getKernSlurEndElisionLevel((string)(*this), index);
 	} else {
 		return -1;
@@ -2815,7 +2811,7 @@ ostream& HumdrumToken::printXmlBaseInfo(ostream& out, int level,
 	out << "</tokenType>\n";
 
 	// <tokenFunction>
-	if (isDataType("**kern")) {
+	if (isKern()) {
 		if (isNote()) {
 			out << Convert::repeatString(indent, level) << "<tokenFunction>";
 			out << "note" << "</tokenFunction>\n";
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sat Aug  6 10:53:40 CEST 2016
-// Last Modified: Sun Sep 18 14:16:18 PDT 2016
+// Last Modified: Sun Oct 18 23:31:52 PDT 2026 Integer tick timeline
 // Filename:      musicxml2hum.cpp
 // URL:           https://github.com/craigsapp/hum2ly/blob/master/src/MxmlEvent.cpp
 // Syntax:        C++11; humlib
@@ -152,6 +152,62 @@ void MxmlEvent::setDuration(HumNum value) {
 
 
 
+//////////////////////////////
+//
+// MxmlEvent::setTickTimeline -- Store the start time and duration of
+//    the event as integer ticks, where tpq is the number of ticks per
+//    quarter note for the timeline of the part (see
+//    MxmlPart::setTimelineTpq()).
+//
+
+void MxmlEvent::setTickTimeline(int tpq) {
+	m_tickstart = timeToTicks(m_starttime, tpq);
+	m_tickdur   = timeToTicks(m_duration, tpq);
+}
+
+
+
+//////////////////////////////
+//
+// MxmlEvent::getTickStart -- Return the start time of the event in
+//    ticks of the part timeline.
+//
+
+long MxmlEvent::getTickStart(void) const {
+	return m_tickstart;
+}
+
+
+
+//////////////////////////////
+//
+// MxmlEvent::getTickDuration -- Return the duration of the event in
+//    ticks of the part timeline.
+//
+
+long MxmlEvent::getTickDuration(void) const {
+	return m_tickdur;
+}
+
+
+
+//////////////////////////////
+//
+// MxmlEvent::timeToTicks -- Convert a time in quarter notes into ticks,
+//    where tpq is the number of ticks per quarter note (which should be
+//    a multiple of the denominator of the time).
+//
+
+long MxmlEvent::timeToTicks(HumNum value, int tpq) {
+	int denominator = value.getDenominator();
+	if (tpq % denominator == 0) {
+		return (long)value.getNumerator() * (tpq / denominator);
+	}
+	return (long)value.getNumerator() * tpq / denominator;
+}
+
+
+
 //////////////////////////////
 //
 // MxmlEvent::getStartTime -- Return the start time of the event in terms
@@ -159,7 +159,8 @@ bool MxmlMeasure::parseMeasure(xml_node mel) {
    // musicxml2hum_interface::insertMeasure(), specifically:
 	// musicxml2hum_interface::checkForDummyRests().
 
-	sortEvents();
+	// Events are sorted after the tick timeline of the part is known
+	// (see getSortedEvents()).
 
 	return output;
 }
@@ -202,6 +203,9 @@ void MxmlMeasure::addDummyRest(void) {
    m_events.push_back(event);
    MxmlMeasure* measure = this;
    event->makeDummyRest(measure, starttime, measuredur);
+	if (getTimelineTpq() > 0) {
+		event->setTickTimeline(getTimelineTpq());
+	}
 }
 
 
@@ -211,6 +215,9 @@ void MxmlMeasure::addDummyRest(HumNum starttime, HumNum duration,
 	m_events.push_back(event);
    MxmlMeasure* measure = this;
    event->makeDummyRest(measure, starttime, duration, staffindex, voiceindex);
+	if (getTimelineTpq() > 0) {
+		event->setTickTimeline(getTimelineTpq());
+	}
 }
 
 
@@ -510,15 +517,76 @@ int MxmlMeasure::getEventCount(void) const {
 
 //////////////////////////////
 //
-// MxmlMeasure::getSortedEvents --
+// MxmlMeasure::getSortedEvents -- Return the events grouped by start
+//    time.  The tick timeline of the part is created if needed.
 //
 
 vector<SimultaneousEvents>* MxmlMeasure::getSortedEvents(void) {
+	if (m_owner && (m_owner->getTimelineTpq() <= 0)) {
+		m_owner->setTimelineTpq(m_owner->getMinimumTimelineTpq());
+	}
 	return &m_sortedevents;
 }
 
 
 
+//////////////////////////////
+//
+// MxmlMeasure::setTickTimeline -- Convert the start times and durations
+//    of the measure and its events into integer ticks, where tpq is the
+//    number of ticks per quarter note, and then sort the events.
+//
+
+void MxmlMeasure::setTickTimeline(int tpq) {
+	m_tickstart = MxmlEvent::timeToTicks(m_starttime, tpq);
+	m_tickdur   = MxmlEvent::timeToTicks(m_duration, tpq);
+	for (int i=0; i<(int)m_events.size(); i++) {
+		m_events[i]->setTickTimeline(tpq);
+	}
+	sortEvents();
+}
+
+
+
+//////////////////////////////
+//
+// MxmlMeasure::getTickStart -- Return the start time of the measure in
+//    ticks of the part timeline.
+//
+
+long MxmlMeasure::getTickStart(void) const {
+	return m_tickstart;
+}
+
+
+
+//////////////////////////////
+//
+// MxmlMeasure::getTickDuration -- Return the duration of the measure in
+//    ticks of the part timeline.
+//
+
+long MxmlMeasure::getTickDuration(void) const {
+	return m_tickdur;
+}
+
+
+
+//////////////////////////////
+//
+// MxmlMeasure::getTimelineTpq -- Return the ticks per quarter note of
+//    the part timeline, or 0 if the timeline has not been set.
+//
+
+int MxmlMeasure::getTimelineTpq(void) const {
+	if (m_owner) {
+		return m_owner->getTimelineTpq();
+	}
+	return 0;
+}
+
+
+
 //////////////////////////////
 //
 // MxmlMeasure::getEvent --
@@ -618,37 +686,35 @@ int MxmlMeasure::getStaffIndex(int voicenum) {
 //////////////////////////////
 //
 // MxmlMeasure::sortEvents -- Sorts events for the measure into
-//   time order.  They are split into zero-duration evnets and
-//   non-zero events.  mevent_floating type are placed into the
-//   non-zero events eventhough they have zero duration (this is
-//   for harmony not attached to a note attack, and will be
-//   eventually including basso continuo figuration having the
+//   time order (by tick times on the part timeline).  They are split
+//   into zero-duration evnets and non-zero events.  mevent_floating
+//   type are placed into the non-zero events eventhough they have zero
+//   duration (this is for harmony not attached to a note attack, and
+//   will be eventually including basso continuo figuration having the
 //   same situation).
 //
 
 void MxmlMeasure::sortEvents(void) {
 	int i;
-	set<HumNum> times;
-
+	vector<long> ticks(m_events.size());
 	for (i=0; i<(int)m_events.size(); i++) {
-		times.insert(m_events[i]->getStartTime());
+		ticks[i] = m_events[i]->getTickStart();
 	}
+	std::sort(ticks.begin(), ticks.end());
+	ticks.erase(std::unique(ticks.begin(), ticks.end()), ticks.end());
 
-	m_sortedevents.resize(times.size());
-	int counter = 0;
-
-	for (HumNum val : times) {
-		m_sortedevents[counter++].starttime = val;
-	}
-
-	// setup sorted access:
-	map<HumNum, SimultaneousEvents*> mapping;
+	m_sortedevents.clear();
+	m_sortedevents.resize(ticks.size());
 	for (i=0; i<(int)m_sortedevents.size(); i++) {
-		mapping[m_sortedevents[i].starttime] = &m_sortedevents[i];
+		m_sortedevents[i].tickstart = ticks[i];
+	}
+	SimultaneousEvents* now;
+	for (i=0; i<(int)m_events.size(); i++) {
+		now = getSortedEventsAtTick(m_events[i]->getTickStart());
+		now->starttime = m_events[i]->getStartTime();
 	}
 
-	HumNum duration;
-	HumNum starttime;
+	long duration;
 	for (i=0; i<(int)m_events.size(); i++) {
 
 		// skip storing certain types of events:
@@ -656,7 +722,7 @@ void MxmlMeasure::sortEvents(void) {
 			case mevent_backup:
 				continue;
 			case mevent_forward:
-            if (m_events[i]->getDuration() == this->getDuration()) {
+            if (m_events[i]->getTickDuration() == this->getTickDuration()) {
                  // forward elements are encoded as whole-measure rests
                  // if they fill the duration of a measure
             } else if (m_events[i]->getVoiceIndex() < 0) {
@@ -668,14 +734,14 @@ void MxmlMeasure::sortEvents(void) {
 				break;
 		}
 
-		starttime = m_events[i]->getStartTime();
-		duration  = m_events[i]->getDuration();
+		now = getSortedEventsAtTick(m_events[i]->getTickStart());
+		duration = m_events[i]->getTickDuration();
 		if (m_events[i]->isFloating()) {
-			mapping[starttime]->nonzerodur.push_back(m_events[i]);
+			now->nonzerodur.push_back(m_events[i]);
 		} else if (duration == 0) {
-			mapping[starttime]->zerodur.push_back(m_events[i]);
+			now->zerodur.push_back(m_events[i]);
 		} else {
-			mapping[starttime]->nonzerodur.push_back(m_events[i]);
+			now->nonzerodur.push_back(m_events[i]);
 		}
 	}
 
@@ -721,6 +787,28 @@ void MxmlMeasure::sortEvents(void) {
 
 
 
+//////////////////////////////
+//
+// MxmlMeasure::getSortedEventsAtTick -- Return the sorted-event entry
+//    for the given tick time (binary search of m_sortedevents).
+//
+
+SimultaneousEvents* MxmlMeasure::getSortedEventsAtTick(long tick) {
+	int low = 0;
+	int high = (int)m_sortedevents.size() - 1;
+	while (low < high) {
+		int mid = (low + high) / 2;
+		if (m_sortedevents[mid].tickstart < tick) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+	return &m_sortedevents[low];
+}
+
+
+
 //////////////////////////////
 //
 // MxmlMeasure::receiveStaffNumberFromChild -- Receive a staff number
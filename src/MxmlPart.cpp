@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sat Aug  6 10:53:40 CEST 2016
-// Last Modified: Sun Sep 18 14:16:18 PDT 2016
+// Last Modified: Sun Oct 18 23:31:52 PDT 2026 Integer tick timeline
 // Filename:      MxmlPart.cpp
 // URL:           https://github.com/craigsapp/musicxml2hum/blob/master/src/MxmlPart.cpp
 // Syntax:        C++11; humlib
@@ -14,6 +14,8 @@
 //    http://usermanuals.musicxml.com/MusicXML/Content/EL-MusicXML-part.htm
 //
 
+#include "Convert.h"
+#include "MxmlEvent.h"
 #include "MxmlMeasure.h"
 #include "MxmlPart.h"
 
@@ -26,6 +28,7 @@
 #include <iostream>
 #include <vector>
 #include <map>
+#include <set>
 
 using namespace pugi;
 using namespace std;
@@ -224,6 +227,72 @@ HumNum MxmlPart::getDuration(void) const {
 
 
 
+//////////////////////////////
+//
+// MxmlPart::getMinimumTimelineTpq -- Return the smallest number of ticks
+//     per quarter note which can represent the start times and durations
+//     of all measures and events in the part as integers.  This is the
+//     least common multiple of the <divisions> values in the part, unless
+//     durations were corrected to values which are not on that grid.
+//
+
+int MxmlPart::getMinimumTimelineTpq(void) const {
+	set<int> denominators;
+	for (int i=0; i<(int)m_measures.size(); i++) {
+		MxmlMeasure* measure = m_measures[i];
+		denominators.insert(measure->getStartTime().getDenominator());
+		denominators.insert(measure->getDuration().getDenominator());
+		denominators.insert(measure->getTimeSigDur().getDenominator());
+		vector<MxmlEvent*>& events = measure->getEventList();
+		for (int j=0; j<(int)events.size(); j++) {
+			denominators.insert(events[j]->getStartTime().getDenominator());
+			denominators.insert(events[j]->getDuration().getDenominator());
+		}
+	}
+	denominators.erase(1);
+	if (denominators.empty()) {
+		return 1;
+	}
+	vector<int> numbers(denominators.begin(), denominators.end());
+	return Convert::getLcm(numbers);
+}
+
+
+
+//////////////////////////////
+//
+// MxmlPart::getTimelineTpq -- Return the number of ticks per quarter
+//     note of the integer timeline for the part, or 0 if it has not
+//     been set.
+//
+
+int MxmlPart::getTimelineTpq(void) const {
+	return m_timelinetpq;
+}
+
+
+
+//////////////////////////////
+//
+// MxmlPart::setTimelineTpq -- Assign integer tick times to all measures
+//     and events in the part, and sort the events in each measure by tick
+//     time.  Parts which will be aligned with each other should use the
+//     same tpq (the least common multiple of getMinimumTimelineTpq() for
+//     each part).
+//
+
+void MxmlPart::setTimelineTpq(int tpq) {
+	if (tpq < 1) {
+		tpq = 1;
+	}
+	m_timelinetpq = tpq;
+	for (int i=0; i<(int)m_measures.size(); i++) {
+		m_measures[i]->setTickTimeline(tpq);
+	}
+}
+
+
+
 //////////////////////////////
 //
 // MxmlPart::setPartNumber -- Set the part number for the part.  Typically
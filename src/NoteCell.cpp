@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Fri Nov 25 19:41:43 PST 2016
-// Last Modified: Fri Nov 25 19:41:49 PST 2016
+// Last Modified: Sun Oct 18 21:18:20 PDT 2026 Constructor with precalculated pitch
 // Filename:      NoteCell.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/NoteCell.cpp
 // Syntax:        C++11; humlib
@@ -34,6 +34,19 @@ NoteCell::NoteCell(NoteGrid* owner, HTp token) {
 }
 
 
+//
+// b40 is the base-40 pitch of the token (or of the note which a null
+//     token refers to), such as from Convert::kernToBase40().
+//
+
+NoteCell::NoteCell(NoteGrid* owner, HTp token, int b40) {
+	clear();
+	m_owner = owner;
+	m_token = token;
+	setNumericPitches(b40);
+}
+
+
 
 //////////////////////////////
 //
@@ -70,13 +83,27 @@ void NoteCell::calculateNumericPitches(void) {
 		m_accidental = NAN;
 		return;
 	}
+	int b40 = 0;
+	if (!m_token->isRest()) {
+		b40 = Convert::kernToBase40(m_token->resolveNull());
+	}
+	setNumericPitches(b40);
+}
+
+
+
+//////////////////////////////
+//
+// NoteCell::setNumericPitches -- Fills in b7, b12, and b40 variables
+//    from the base-40 pitch of the (resolved) token.
+//
 
+void NoteCell::setNumericPitches(int b40) {
 	bool sustain = m_token->isNull() || m_token->isSecondaryTiedNote();
 	if (m_token->isRest()) {
 		m_b40 = NAN;
 	} else {
-		m_b40 = Convert::kernToBase40(m_token->resolveNull());
-		m_b40 = (sustain ? -m_b40 : m_b40);
+		m_b40 = (sustain ? -b40 : b40);
 	}
 
 	// convert to base-7 (diatonic pitch numbers)
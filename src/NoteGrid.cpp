@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Fri Nov 25 19:41:43 PST 2016
-// Last Modified: Fri Nov 25 19:41:49 PST 2016
+// Last Modified: Sun Oct 18 21:18:20 PDT 2026 Batch pitch conversion
 // Filename:      NoteGrid.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/NoteGrid.cpp
 // Syntax:        C++11; humlib
@@ -13,6 +13,7 @@
 
 #include "NoteGrid.h"
 #include "HumRegex.h"
+#include "Convert.h"
 
 using namespace std;
 
@@ -128,6 +129,8 @@ bool NoteGrid::load(HumdrumFile& infile) {
 	int attack = 0;
 	int track, lasttrack;
 	vector<HTp> current;
+	vector<HTp> resolved;
+	vector<int> b40s;
 	HumRegex hre;
 	for (int i=0; i<infile.getLineCount(); i++) {
 		if (infile[i].isInterpretation()) {
@@ -158,7 +161,7 @@ bool NoteGrid::load(HumdrumFile& infile) {
 		for (int j=0; j<infile[i].getFieldCount(); j++) {
 			lasttrack = track;
 			track = infile.token(i, j)->getTrack();
-			if (!infile[i].token(j)->isDataType("**kern")) {
+			if (!infile[i].token(j)->isKern()) {
 				continue;
 			}
 			if (track == lasttrack) {
@@ -176,8 +179,13 @@ bool NoteGrid::load(HumdrumFile& infile) {
 			     << " compared to " << kernspines.size() << endl;
 			return false;
 		}
+		resolved.resize(current.size());
 		for (int j=0; j<(int)current.size(); j++) {
-			NoteCell* cell = new NoteCell(this, current[j]);
+			resolved[j] = current[j]->resolveNull();
+		}
+		Convert::kernToBase40(resolved, b40s);
+		for (int j=0; j<(int)current.size(); j++) {
+			NoteCell* cell = new NoteCell(this, current[j], b40s[j]);
 			track = current[j]->getTrack();
 			cell->setVoiceIndex(j);
 			cell->setSliceIndex((int)grid[j].size());
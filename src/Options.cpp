@@ -3,6 +3,7 @@
 // Creation Date: Sun Apr  5 13:07:18 PDT 1998
 // Last Modified: Sat Mar  1 09:31:01 PST 2014 Implemented with STL.
 // Last Modified: Thu Dec 15 09:06:52 PST 2016 Adjusted internal storage.
+// Last Modified: Sun Oct 18 19:02:13 PDT 2026 Shared option definitions.
 // Filename:      Options.cpp
 // Web Address:   https://github.com/craigsapp/humlib/blob/master/include/Options.h
 // vim:           syntax=cpp ts=3 noexpandtab nowrap
@@ -292,6 +293,59 @@ ostream& Option_register::print(ostream& out) {
 
 
 
+///////////////////////////////////////////////////////////////////////////
+//
+// Option_value class function definitions.
+//
+
+//////////////////////////////
+//
+// Option_value::set -- Set the option string and the numeric
+//     versions of it.  Integers can be in hexadecimal, decimal, and
+//     octal written in standard C syntax.
+//
+
+void Option_value::set(const string& aString) {
+	text = aString;
+	modifiedQ = true;
+	intValue = (int)strtol(aString.c_str(), (char**)NULL, 0);
+	doubleValue = strtod(aString.c_str(), (char**)NULL);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////
+//
+// Option_definitions class function definitions.
+//
+
+//////////////////////////////
+//
+// Option_definitions::getEmpty -- Return the list with no definitions,
+//     which is the starting point for all Options objects.
+//
+
+std::shared_ptr<Option_definitions> Option_definitions::getEmpty(void) {
+	static std::shared_ptr<Option_definitions> empty =
+			std::make_shared<Option_definitions>();
+	return empty;
+}
+
+
+
+//////////////////////////////
+//
+// Option_definitions::getMutex -- Lock for accessing m_next in any list,
+//     since tools can be created in multiple threads.
+//
+
+mutex& Option_definitions::getMutex(void) {
+	static mutex definitionMutex;
+	return definitionMutex;
+}
+
+
+
 ///////////////////////////////////////////////////////////////////////////
 //
 // Options class function definitions.
@@ -303,11 +357,12 @@ ostream& Option_register::print(ostream& out) {
 //
 
 Options::Options(void) {
-	// do nothing
+	m_definitions = Option_definitions::getEmpty();
 }
 
 
 Options::Options(int argc, char** argv) {
+	m_definitions = Option_definitions::getEmpty();
 	setOptions(argc, argv);
 }
 
@@ -316,16 +371,12 @@ Options::Options(const Options& options) {
 	m_argv = options.m_argv;
 	m_arguments = options.m_arguments;
 	m_optionFlag = options.m_optionFlag;
-	m_optionList = options.m_optionList;
 	m_options_error_checkQ = options.m_options_error_checkQ;
 	m_processedQ = options.m_processedQ;
 	m_suppressQ = options.m_suppressQ;
 	m_optionsArgQ = options.m_optionsArgQ;
-	for (int i=0; i<(int)options.m_optionRegister.size(); i++) {
-		Option_register* orr = new Option_register(*options.m_optionRegister[i]);
-		m_optionRegister.push_back(orr);
-	}
-
+	m_definitions = options.m_definitions;
+	m_values = options.m_values;
 }
 
 
@@ -353,22 +404,12 @@ Options& Options::operator=(const Options& options) {
 	m_argv = options.m_argv;
 	m_arguments = options.m_arguments;
 	m_optionFlag = options.m_optionFlag;
-	m_optionList = options.m_optionList;
 	m_options_error_checkQ = options.m_options_error_checkQ;
 	m_processedQ = options.m_processedQ;
 	m_suppressQ = options.m_suppressQ;
 	m_optionsArgQ = options.m_optionsArgQ;
-
-	for (int i=0; i<(int)m_optionRegister.size(); i++) {
-		delete m_optionRegister[i];
-		m_optionRegister[i] = NULL;
-	}
-	m_optionRegister.clear();
-
-	for (int i=0; i<(int)options.m_optionRegister.size(); i++) {
-		Option_register* orr = new Option_register(*options.m_optionRegister[i]);
-		m_optionRegister.push_back(orr);
-	}
+	m_definitions = options.m_definitions;
+	m_values = options.m_values;
 
 	m_error.str("");
 	return *this;
@@ -409,9 +450,48 @@ const vector<string>& Options::argv(void) const {
 // option-type :: single charater indicating the option data type.
 // option-default :: default value for option if no given on the command-line.
 //
+// The definitions are shared between all Options objects which define
+// the same options in the same order, so the definition strings only
+// need to be parsed the first time that a tool class is instantiated.
+// The return value is the index of the option, which can be used to
+// access the option value without looking up the option name.
+//
 
 int Options::define(const string& aDefinition) {
-	Option_register* definitionEntry = NULL;
+	return defineOption(aDefinition, "");
+}
+
+
+int Options::define(const string& aDefinition, const string& aDescription) {
+	return defineOption(aDefinition, aDescription);
+}
+
+
+
+//////////////////////////////
+//
+// Options::defineOption -- Add an option definition to the shared list
+//     of definitions, or move to an existing list which already has
+//     the definition added.
+//
+
+int Options::defineOption(const string& aDefinition,
+		const string& aDescription) {
+	string key = aDefinition;
+	key += '\n';
+	key += aDescription;
+
+	int definitionIndex = (int)m_values.size();
+
+	{
+		lock_guard<mutex> lock(Option_definitions::getMutex());
+		auto it = m_definitions->m_next.find(key);
+		if (it != m_definitions->m_next.end()) {
+			m_definitions = it->second;
+			m_values.push_back(m_definitions->m_defaults.back());
+			return definitionIndex;
+		}
+	}
 
 	// Error if definition string doesn't contain an equals sign
 	auto location = aDefinition.find("=");
@@ -453,10 +533,20 @@ int Options::define(const string& aDefinition) {
 		return -1;
 	}
 
-	// Set up space for a option entry in the registry
-	definitionEntry = new Option_register(aDefinition, otype[0], ovalue);
-
-	int definitionIndex = (int)m_optionRegister.size();
+	// Set up a new list of definitions containing the option
+	std::shared_ptr<Option_definitions> definitions =
+			std::make_shared<Option_definitions>();
+	definitions->m_registers = m_definitions->m_registers;
+	definitions->m_defaults = m_definitions->m_defaults;
+	definitions->m_names = m_definitions->m_names;
+
+	definitions->m_registers.emplace_back(aDefinition, otype[0], ovalue);
+	definitions->m_registers.back().setDescription(aDescription);
+	Option_value value;
+	value.set(ovalue);
+	value.text.clear();
+	value.modifiedQ = false;
+	definitions->m_defaults.push_back(value);
 
 	// Store option aliases
 	string optionName;
@@ -465,15 +555,16 @@ int Options::define(const string& aDefinition) {
 		if (::isspace(aliases[i])) {
 			continue;
 		} else if (aliases[i] == '|') {
-			if (isDefined(optionName)) {
+			auto it = definitions->m_names.find(optionName);
+			if (it != definitions->m_names.end()) {
 				m_error << "Option \"" << optionName << "\" from definition:" << endl;
 				m_error << "\t" << aDefinition << endl;
 				m_error << "is already defined in: " << endl;
-				m_error << "\t" << getDefinition(optionName) << endl;
+				m_error << "\t" << definitions->m_registers[it->second].getDefinition() << endl;
 				return -1;
 			}
 			if (optionName.size() > 0) {
-				m_optionList[optionName] = definitionIndex;
+				definitions->m_names[optionName] = definitionIndex;
 			}
 			optionName.clear();
 		} else {
@@ -481,21 +572,19 @@ int Options::define(const string& aDefinition) {
 		}
 	}
 
-	// Store definition in registry and return its indexed location.
-	// This location will be used to link option aliases to the main
-	// command name.
-	m_optionRegister.push_back(definitionEntry);
+	// Store the new list so that it can be reused by other objects.
+	// If another thread added the same definition in the meantime,
+	// use its list instead.
+	{
+		lock_guard<mutex> lock(Option_definitions::getMutex());
+		auto result = m_definitions->m_next.emplace(key, definitions);
+		m_definitions = result.first->second;
+	}
+	m_values.push_back(m_definitions->m_defaults.back());
 	return definitionIndex;
 }
 
 
-int Options::define(const string& aDefinition, const string& aDescription) {
-	int index = define(aDefinition);
-	m_optionRegister[index]->setDescription(aDescription);
-	return index;
-}
-
-
 
 //////////////////////////////
 //
@@ -503,7 +592,7 @@ int Options::define(const string& aDefinition, const string& aDescription) {
 //
 
 int Options::isDefined(const string& name) {
-	if (m_optionList.find(name) == m_optionList.end()) {
+	if (m_definitions->m_names.find(name) == m_definitions->m_names.end()) {
 		return 0;
 	} else {
 		return 1;
@@ -586,11 +675,15 @@ vector<string>& Options::getArgumentList(vector<string>& output) {
 //
 
 bool Options::getBoolean(const string& optionName) {
-	int index = getRegIndex(optionName);
-	if (index < 0) {
+	return getBoolean(getRegIndex(optionName));
+}
+
+
+bool Options::getBoolean(int index) {
+	if ((index < 0) || (index >= (int)m_values.size())) {
 		return 0;
 	}
-	return m_optionRegister[index]->isModified();
+	return m_values[index].modifiedQ;
 }
 
 
@@ -640,11 +733,11 @@ string Options::getCommandLine(void) {
 //
 
 string Options::getDefinition(const string& optionName) {
-	auto it = m_optionList.find(optionName);
-	if (it == m_optionList.end()) {
+	auto it = m_definitions->m_names.find(optionName);
+	if (it == m_definitions->m_names.end()) {
 		return "";
 	} else {
-		return m_optionRegister[it->second]->getDefinition();
+		return m_definitions->m_registers[it->second].getDefinition();
 	}
 }
 
@@ -658,7 +751,15 @@ string Options::getDefinition(const string& optionName) {
 //
 
 double Options::getDouble(const string& optionName) {
-	return strtod(getString(optionName).c_str(), (char**)NULL);
+	return getDouble(getRegIndex(optionName));
+}
+
+
+double Options::getDouble(int index) {
+	if ((index < 0) || (index >= (int)m_values.size())) {
+		return 0.0;
+	}
+	return m_values[index].doubleValue;
 }
 
 
@@ -695,7 +796,15 @@ float Options::getFloat(const string& optionName) {
 //
 
 int Options::getInt(const string& optionName) {
-	return (int)strtol(getString(optionName).c_str(), (char**)NULL, 0);
+	return getInt(getRegIndex(optionName));
+}
+
+
+int Options::getInt(int index) {
+	if ((index < 0) || (index >= (int)m_values.size())) {
+		return 0;
+	}
+	return m_values[index].intValue;
 }
 
 int Options::getInteger(const string& optionName) {
@@ -703,6 +812,11 @@ int Options::getInteger(const string& optionName) {
 }
 
 
+int Options::getInteger(int index) {
+	return getInt(index);
+}
+
+
 
 //////////////////////////////
 //
@@ -710,16 +824,38 @@ int Options::getInteger(const string& optionName) {
 //
 
 string Options::getString(const string& optionName) {
-	int index = getRegIndex(optionName);
-	if (index < 0) {
+	return getString(getRegIndex(optionName));
+}
+
+
+string Options::getString(int index) {
+	if ((index < 0) || (index >= (int)m_values.size())) {
 		return "UNKNOWN OPTION";
+	} else if (m_values[index].modifiedQ) {
+		return m_values[index].text;
 	} else {
-		return m_optionRegister[index]->getOption();
+		return m_definitions->m_registers[index].getDefault();
 	}
 }
 
 
 
+//////////////////////////////
+//
+// Options::getIndex -- Return the index of an option (the same value
+//     which is returned by define()), or -1 if the option is not defined.
+//
+
+int Options::getIndex(const string& optionName) {
+	auto it = m_definitions->m_names.find(optionName);
+	if (it == m_definitions->m_names.end()) {
+		return -1;
+	}
+	return it->second;
+}
+
+
+
 //////////////////////////////
 //
 // Options::optionsArg -- Return true if --options is present
@@ -738,9 +874,10 @@ int Options::optionsArg(void) {
 //
 
 ostream& Options::print(ostream& out) {
-	for (unsigned int i=0; i<m_optionRegister.size(); i++) {
-		out << m_optionRegister[i]->getDefinition() << "\t"
-			  << m_optionRegister[i]->getDescription() << endl;
+	vector<Option_register>& registers = m_definitions->m_registers;
+	for (unsigned int i=0; i<registers.size(); i++) {
+		out << registers[i].getDefinition() << "\t"
+			  << registers[i].getDescription() << endl;
 	}
 	return out;
 }
@@ -756,11 +893,8 @@ void Options::reset(void) {
 	m_argv.clear();
 	m_arguments.clear();
 
-	for (int i=0; i<(int)m_optionRegister.size(); i++) {
-		delete m_optionRegister[i];
-		m_optionRegister[i] = NULL;
-	}
-	m_optionRegister.clear();
+	m_definitions = Option_definitions::getEmpty();
+	m_values.clear();
 }
 
 
@@ -796,12 +930,15 @@ void Options::setFlag(char aFlag) {
 //
 
 void Options::setModified(const string& optionName, const string& aString) {
-	int index = getRegIndex(optionName);
-	if (index < 0) {
+	setModified(getRegIndex(optionName), aString);
+}
+
+
+void Options::setModified(int index, const string& aString) {
+	if ((index < 0) || (index >= (int)m_values.size())) {
 		return;
 	}
-
-	m_optionRegister[getRegIndex(optionName)]->setModified(aString);
+	m_values[index].set(aString);
 }
 
 
@@ -960,7 +1097,7 @@ char Options::getType(const string& optionName) {
 	if (index < 0) {
 		return -1;
 	} else {
-		return m_optionRegister[getRegIndex(optionName)]->getType();
+		return m_definitions->m_registers[index].getType();
 	}
 }
 
@@ -1086,8 +1223,8 @@ int Options::getRegIndex(const string& optionName) {
 		return -1;
 	}
 
-	auto it = m_optionList.find(optionName);
-	if (it == m_optionList.end()) {
+	auto it = m_definitions->m_names.find(optionName);
+	if (it == m_definitions->m_names.end()) {
 		if (m_options_error_checkQ) {
 			m_error << "Error: unknown option \"" << optionName << "\"." << endl;
 			print(cout);
@@ -1238,7 +1375,9 @@ int Options::storeOption(int index, int& position, int& running) {
 //
 
 ostream& Options::printOptionList(ostream& out) {
-	for (auto it = m_optionList.begin(); it != m_optionList.end(); it++) {
+	map<string, int> names(m_definitions->m_names.begin(),
+			m_definitions->m_names.end());
+	for (auto it = names.begin(); it != names.end(); it++) {
 		out << it->first << "\t" << it->second << endl;
 	}
 	return out;
@@ -1252,9 +1391,11 @@ ostream& Options::printOptionList(ostream& out) {
 //
 
 ostream& Options::printOptionListBooleanState(ostream& out) {
-	for (auto it = m_optionList.begin(); it != m_optionList.end(); it++) {
+	map<string, int> names(m_definitions->m_names.begin(),
+			m_definitions->m_names.end());
+	for (auto it = names.begin(); it != names.end(); it++) {
 		out << it->first << "\t"
-			 << m_optionRegister[it->second]->isModified() << endl;
+			 << m_values[it->second].modifiedQ << endl;
 	}
 	return out;
 }
@@ -1267,8 +1408,12 @@ ostream& Options::printOptionListBooleanState(ostream& out) {
 //
 
 ostream& Options::printRegister(ostream& out) {
-	for (auto it = m_optionRegister.begin(); it != m_optionRegister.end(); it++) {
-		(*it)->print(out);
+	for (int i=0; i<(int)m_values.size(); i++) {
+		Option_register reg = m_definitions->m_registers[i];
+		if (m_values[i].modifiedQ) {
+			reg.setModified(m_values[i].text);
+		}
+		reg.print(out);
 	}
 	return out;
 }
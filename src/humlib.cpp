@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sat Aug  8 12:24:49 PDT 2015
-// Last Modified: Mon Aug 26 15:38:57 EDT 2019
+// Last Modified: Sun Oct 18 19:54:54 UTC 2026
 // Filename:      /include/humlib.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/humlib.cpp
 // Syntax:        C++11
@@ -1430,12 +1430,11 @@ int Convert::kernToBase40PC(const string& kerndata) {
 //
 
 int Convert::kernToBase40(const string& kerndata) {
-	int pc = Convert::kernToBase40PC(kerndata);
-	if (pc < 0) {
-		return pc;
-	}
-	int octave   = Convert::kernToOctaveNumber(kerndata);
-	return pc + 40 * octave;
+	int diatonic;
+	int accid;
+	int octave;
+	Convert::kernToPitchParts(kerndata.data(), kerndata.size(), diatonic, accid, octave);
+	return Convert::pitchPartsToBase40(diatonic, accid, octave);
 }
 
 
@@ -1476,9 +1475,11 @@ int Convert::kernToBase12PC(const string& kerndata) {
 //
 
 int Convert::kernToBase12(const string& kerndata) {
-	int pc = Convert::kernToBase12PC(kerndata);
-	int octave = Convert::kernToOctaveNumber(kerndata);
-	return pc + 12 * octave;
+	int diatonic;
+	int accid;
+	int octave;
+	Convert::kernToPitchParts(kerndata.data(), kerndata.size(), diatonic, accid, octave);
+	return Convert::pitchPartsToBase12(diatonic, accid, octave);
 }
 
 
@@ -1672,9 +1673,11 @@ int Convert::base40ToAccidental(int b40) {
 //
 
 int Convert::kernToMidiNoteNumber(const string& kerndata) {
-	int pc = Convert::kernToBase12PC(kerndata);
-	int octave = Convert::kernToOctaveNumber(kerndata);
-	return pc + 12 * (octave + 1);
+	int diatonic;
+	int accid;
+	int octave;
+	Convert::kernToPitchParts(kerndata.data(), kerndata.size(), diatonic, accid, octave);
+	return Convert::pitchPartsToBase12(diatonic, accid, octave) + 12;
 }
 
 
@@ -1686,12 +1689,211 @@ int Convert::kernToMidiNoteNumber(const string& kerndata) {
 //
 
 int Convert::kernToBase7(const string& kerndata) {
-	int diatonic = Convert::kernToDiatonicPC(kerndata);
+	int diatonic;
+	int accid;
+	int octave;
+	Convert::kernToPitchParts(kerndata.data(), kerndata.size(), diatonic, accid, octave);
+	return Convert::pitchPartsToBase7(diatonic, octave);
+}
+
+
+
+//////////////////////////////
+//
+// Convert::kernToPitchParts -- Extract the diatonic pitch class, accidental
+//    count and octave number from the first subtoken of a **kern token
+//    in a single pass.  The values are the same as those returned by
+//    kernToDiatonicPC(), kernToAccidentalCount() and kernToOctaveNumber().
+//
+
+void Convert::kernToPitchParts(const char* kerndata, size_t size,
+		int& diatonic, int& accidental, int& octave) {
+	// Character classes: the lower three bits store the diatonic pitch
+	// class plus one for the letters A-G and a-g.
+	enum {
+		PITCH_MASK = 0x07,
+		UPPER      = 0x08,
+		LOWER      = 0x10,
+		SHARP      = 0x20,
+		FLAT       = 0x40,
+		REST       = 0x80,
+		SPACE      = 0x100
+	};
+	struct CharTable {
+		unsigned short value[256];
+		CharTable(void) {
+			const char* letters = "CDEFGAB";
+			for (int i=0; i<256; i++) {
+				value[i] = 0;
+			}
+			for (int i=0; i<7; i++) {
+				value[(unsigned char)letters[i]] = UPPER | (i + 1);
+				value[(unsigned char)tolower(letters[i])] = LOWER | (i + 1);
+			}
+			value[(unsigned char)'#'] = SHARP;
+			value[(unsigned char)'-'] = FLAT;
+			value[(unsigned char)'r'] = REST;
+			value[(unsigned char)' '] = SPACE;
+		}
+	};
+	static const CharTable table;
+
+	diatonic = -2000;
+	accidental = 0;
+	int uc = 0;
+	int lc = 0;
+	bool restQ = false;
+	for (size_t i=0; i<size; i++) {
+		unsigned short cls = table.value[(unsigned char)kerndata[i]];
+		if (cls == 0) {
+			continue;
+		}
+		if (cls & SPACE) {
+			break;
+		}
+		if (cls & REST) {
+			restQ = true;
+			if (diatonic == -2000) {
+				diatonic = -1000;
+			}
+			continue;
+		}
+		accidental += (cls & SHARP) ? 1 : 0;
+		accidental -= (cls & FLAT) ? 1 : 0;
+		uc += (cls & UPPER) ? 1 : 0;
+		lc += (cls & LOWER) ? 1 : 0;
+		if ((diatonic == -2000) && (cls & PITCH_MASK)) {
+			diatonic = (cls & PITCH_MASK) - 1;
+		}
+	}
+
+	if (restQ || ((uc > 0) && (lc > 0))) {
+		octave = -1000;
+	} else if (uc > 0) {
+		octave = 4 - uc;
+	} else if (lc > 0) {
+		octave = 3 + lc;
+	} else {
+		octave = -1000;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// Convert::pitchPartsToBase40 -- Convert the output of kernToPitchParts()
+//    into a base-40 pitch (see kernToBase40()).
+//
+
+int Convert::pitchPartsToBase40(int diatonic, int accidental, int octave) {
 	if (diatonic < 0) {
 		return diatonic;
 	}
-	int octave = Convert::kernToOctaveNumber(kerndata);
-	return diatonic + 7 * octave;;
+	static const int pcs[7] = { 0, 6, 12, 17, 23, 29, 35 };
+	// +2 to make c-flat-flat bottom of octave.
+	return pcs[diatonic] + accidental + 2 + 40 * octave;
+}
+
+
+
+//////////////////////////////
+//
+// Convert::pitchPartsToBase12 -- Convert the output of kernToPitchParts()
+//    into a base-12 pitch (see kernToBase12()).
+//
+
+int Convert::pitchPartsToBase12(int diatonic, int accidental, int octave) {
+	static const int pcs[7] = { 0, 2, 4, 5, 7, 9, 11 };
+	int pc = diatonic < 0 ? diatonic : pcs[diatonic] + accidental;
+	return pc + 12 * octave;
+}
+
+
+
+//////////////////////////////
+//
+// Convert::pitchPartsToBase7 -- Convert the output of kernToPitchParts()
+//    into a base-7 pitch (see kernToBase7()).
+//
+
+int Convert::pitchPartsToBase7(int diatonic, int octave) {
+	if (diatonic < 0) {
+		return diatonic;
+	}
+	return diatonic + 7 * octave;
+}
+
+
+
+//////////////////////////////
+//
+// Convert::kernToPitchNumbers -- Convert a list of **kern tokens into
+//    base-40, base-12, base-7 and/or MIDI note numbers.  Each output
+//    list which is not NULL is resized to the number of tokens.  The
+//    values are the same as kernToBase40(), kernToBase12(), kernToBase7()
+//    and kernToMidiNoteNumber() for each token, but each token is only
+//    scanned once for all of the outputs.
+//
+
+void Convert::kernToPitchNumbers(const vector<string>& tokens,
+		vector<int>* base40, vector<int>* base12, vector<int>* base7,
+		vector<int>* midi) {
+	if (base40) { base40->resize(tokens.size()); }
+	if (base12) { base12->resize(tokens.size()); }
+	if (base7)  { base7->resize(tokens.size());  }
+	if (midi)   { midi->resize(tokens.size());   }
+	for (int i=0; i<(int)tokens.size(); i++) {
+		Convert::storePitchNumbers(i, tokens[i].data(), tokens[i].size(),
+				base40, base12, base7, midi);
+	}
+}
+
+
+void Convert::kernToPitchNumbers(const vector<HTp>& tokens,
+		vector<int>* base40, vector<int>* base12, vector<int>* base7,
+		vector<int>* midi) {
+	if (base40) { base40->resize(tokens.size()); }
+	if (base12) { base12->resize(tokens.size()); }
+	if (base7)  { base7->resize(tokens.size());  }
+	if (midi)   { midi->resize(tokens.size());   }
+	for (int i=0; i<(int)tokens.size(); i++) {
+		const string& text = *tokens[i];
+		Convert::storePitchNumbers(i, text.data(), text.size(),
+				base40, base12, base7, midi);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// Convert::storePitchNumbers -- Store the pitch numbers of one token
+//     for kernToPitchNumbers().
+//
+
+void Convert::storePitchNumbers(int index, const char* kerndata, size_t size,
+		vector<int>* base40, vector<int>* base12, vector<int>* base7,
+		vector<int>* midi) {
+	int diatonic;
+	int accid;
+	int octave;
+	Convert::kernToPitchParts(kerndata, size, diatonic, accid, octave);
+	if (base40) {
+		(*base40)[index] = Convert::pitchPartsToBase40(diatonic, accid, octave);
+	}
+	if (base12 || midi) {
+		int b12 = Convert::pitchPartsToBase12(diatonic, accid, octave);
+		if (base12) {
+			(*base12)[index] = b12;
+		}
+		if (midi) {
+			(*midi)[index] = b12 + 12;
+		}
+	}
+	if (base7) {
+		(*base7)[index] = Convert::pitchPartsToBase7(diatonic, octave);
+	}
 }
 
 
@@ -6032,6 +6234,10 @@ ostream& operator<<(ostream& output, GridVoice& voice) {
 
 
 
+mutex                     HumAddress::m_sharedmutex;
+unordered_map<string, int> HumAddress::m_sharedids;
+vector<const string*>     HumAddress::m_sharedinfo;
+
 
 //////////////////////////////
 //
@@ -6043,6 +6249,7 @@ HumAddress::HumAddress(void) {
 	m_subtrack      = -1;
 	m_subtrackcount = 0;
 	m_fieldindex    = -1;
+	m_spining       = -1;
 	m_owner         = NULL;
 }
 
@@ -6052,8 +6259,14 @@ HumAddress::HumAddress(HumAddress& address) {
 	m_track         = address.m_track;
 	m_subtrack      = address.m_subtrack;
 	m_subtrackcount = address.m_subtrackcount;
-	m_spining       = address.m_spining;
 	m_owner         = address.m_owner;
+	if (address.m_spining >= 0) {
+		// The copy may be given to a line in another file, so store
+		// the spine info in the shared table.
+		m_spining = internSpineInfo(address.getSpineInfo());
+	} else {
+		m_spining = address.m_spining;
+	}
 }
 
 
@@ -6083,8 +6296,12 @@ HumAddress& HumAddress::operator=(const HumAddress& address) {
 	m_track         = address.m_track;
 	m_subtrack      = address.m_subtrack;
 	m_subtrackcount = address.m_subtrackcount;
-	m_spining       = address.m_spining;
 	m_owner         = address.m_owner;
+	if (address.m_spining >= 0) {
+		m_spining = internSpineInfo(address.getSpineInfo());
+	} else {
+		m_spining = address.m_spining;
+	}
 	return *this;
 }
 
@@ -6150,6 +6367,25 @@ const HumdrumToken& HumAddress::getDataType(void) const {
 
 
 
+//////////////////////////////
+//
+// HumAddress::getDataTypeId -- Return the interned ID of the exclusive
+//    interpretation of the token's track in the owning file (see
+//    HumdrumFileBase::getTrackDataTypeId()).  **kern and **mens spines
+//    have the fixed IDs DATATYPE_KERN and DATATYPE_MENS.  Returns
+//    DATATYPE_NONE if the token is not owned by a file.
+//
+
+int HumAddress::getDataTypeId(void) const {
+	HumdrumFileBase* file = getOwnerFile();
+	if (file == NULL) {
+		return DATATYPE_NONE;
+	}
+	return file->getTrackDataTypeId(m_track);
+}
+
+
+
 //////////////////////////////
 //
 // HumAddress::getSpineInfo -- Return the spine information for the token
@@ -6162,11 +6398,63 @@ const HumdrumToken& HumAddress::getDataType(void) const {
 //
 
 const string& HumAddress::getSpineInfo(void) const {
+	static const string empty;
+	if (m_spining >= 0) {
+		HumdrumFileBase* file = getOwnerFile();
+		if (file == NULL) {
+			return empty;
+		}
+		return file->getSpineInfoString(m_spining);
+	} else if (m_spining == -1) {
+		return empty;
+	}
+	return getInternedSpineInfo(m_spining);
+}
+
+
+
+//////////////////////////////
+//
+// HumAddress::getSpineInfoId -- Return the ID of the spine info string.
+//     IDs which are zero or positive index the spine info table of the
+//     owning file, so tokens in the same file have the same spine info
+//     if their IDs are equal.  -1 means that there is no spine info.
+//
+
+int HumAddress::getSpineInfoId(void) const {
 	return m_spining;
 }
 
 
 
+//////////////////////////////
+//
+// HumAddress::getTrackFromSpineInfo -- Return the track number of a spine
+//     info string, which is the first number in the string.  Returns 0 if
+//     there is no number.
+//
+
+int HumAddress::getTrackFromSpineInfo(const string& spineinfo) {
+	int track = 0;
+	for (int j=0; j<(int)spineinfo.size(); j++) {
+		if (!isdigit(spineinfo[j])) {
+			continue;
+		}
+		track = spineinfo[j] - '0';
+		for (int k=j+1; k<(int)spineinfo.size(); k++) {
+			if (isdigit(spineinfo[k])) {
+				track = track * 10 + (spineinfo[k] - '0');
+			} else {
+				break;
+			}
+		}
+		break;
+	}
+	return track;
+}
+
+
+
 //////////////////////////////
 //
 // HumAddress::getTrack -- The track number of the given spine.  This is the
@@ -6274,6 +6562,21 @@ bool HumAddress::hasOwner(void) const {
 
 
 
+//////////////////////////////
+//
+// HumAddress::getOwnerFile -- Return the file which owns the line of the
+//    token, or NULL if there is none.
+//
+
+HumdrumFileBase* HumAddress::getOwnerFile(void) const {
+	if (m_owner == NULL) {
+		return NULL;
+	}
+	return m_owner->getOwner();
+}
+
+
+
 //////////////////////////////
 //
 // HumAddress::setFieldIndex -- Set the field index of associated token
@@ -6297,7 +6600,59 @@ void HumAddress::setFieldIndex(int index) {
 //
 
 void HumAddress::setSpineInfo(const string& spineinfo) {
-	m_spining = spineinfo;
+	HumdrumFileBase* file = getOwnerFile();
+	if (file == NULL) {
+		m_spining = internSpineInfo(spineinfo);
+	} else {
+		m_spining = file->internSpineInfo(spineinfo);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumAddress::setSpineInfoId -- Set the spine info from an ID in the
+//     spine info table of the owning file (see
+//     HumdrumFileBase::internSpineInfo()).
+//
+
+void HumAddress::setSpineInfoId(int id) {
+	m_spining = id;
+}
+
+
+
+//////////////////////////////
+//
+// HumAddress::internSpineInfo -- Store a spine info string in the table
+//     shared by addresses which are not owned by a file.  Returns the
+//     (negative) ID of the string.
+//
+
+int HumAddress::internSpineInfo(const string& spineinfo) {
+	lock_guard<mutex> lock(m_sharedmutex);
+	auto it = m_sharedids.find(spineinfo);
+	if (it != m_sharedids.end()) {
+		return it->second;
+	}
+	int id = -2 - (int)m_sharedinfo.size();
+	auto entry = m_sharedids.emplace(spineinfo, id).first;
+	m_sharedinfo.push_back(&entry->first);
+	return id;
+}
+
+
+
+//////////////////////////////
+//
+// HumAddress::getInternedSpineInfo -- Return the string for an ID in the
+//     shared spine info table.
+//
+
+const string& HumAddress::getInternedSpineInfo(int id) {
+	lock_guard<mutex> lock(m_sharedmutex);
+	return *m_sharedinfo.at(-2 - id);
 }
 
 
@@ -6364,25 +6719,439 @@ void HumAddress::setSubtrackCount(int count) {
 
 
 
+//////////////////////////////
+//
+// HumAnalysisColumn::HumAnalysisColumn -- Constructor.
+//
+
+HumAnalysisColumn::HumAnalysisColumn(void) {
+	m_type = COLUMN_STRING;
+	m_inserttrack = 0;
+}
+
+
+HumAnalysisColumn::HumAnalysisColumn(const string& exinterp, int type,
+		int linecount) {
+	m_type = type;
+	m_inserttrack = 0;
+	setExInterp(exinterp);
+	setLineCount(linecount);
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisColumn::~HumAnalysisColumn -- Deconstructor.
+//
+
+HumAnalysisColumn::~HumAnalysisColumn() {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisColumn::clear -- Set all values in the column to null.
+//
+
+void HumAnalysisColumn::clear(void) {
+	int linecount = getLineCount();
+	m_ints.clear();
+	m_doubles.clear();
+	m_strings.clear();
+	m_null.clear();
+	setLineCount(linecount);
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisColumn::setLineCount -- Set the number of lines in the
+//     column.  New lines are set to null.
+//
+
+void HumAnalysisColumn::setLineCount(int linecount) {
+	if (linecount < 0) {
+		linecount = 0;
+	}
+	switch (m_type) {
+		case COLUMN_INT:    m_ints.resize(linecount, 0);    break;
+		case COLUMN_DOUBLE: m_doubles.resize(linecount, 0); break;
+		default:            m_strings.resize(linecount);    break;
+	}
+	m_null.resize(linecount, 1);
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisColumn::getLineCount -- Return the number of lines in the
+//     column.
+//
+
+int HumAnalysisColumn::getLineCount(void) const {
+	return (int)m_null.size();
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisColumn::getType -- Return the data type of the column:
+//     COLUMN_INT, COLUMN_DOUBLE or COLUMN_STRING.
+//
+
+int HumAnalysisColumn::getType(void) const {
+	return m_type;
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisColumn::getExInterp -- Return the exclusive interpretation
+//     which is used when rendering the column as a spine.
+//
+
+const string& HumAnalysisColumn::getExInterp(void) const {
+	return m_exinterp;
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisColumn::setExInterp -- Set the exclusive interpretation of
+//     the column.  "**" will be added if not present, and "**data" is
+//     used for an empty string (similar to appendDataSpine()).
+//
+
+void HumAnalysisColumn::setExInterp(const string& exinterp) {
+	if (exinterp.compare(0, 2, "**") == 0) {
+		m_exinterp = exinterp;
+	} else if (exinterp.compare(0, 1, "*") == 0) {
+		m_exinterp = "*" + exinterp;
+	} else {
+		m_exinterp = "**" + exinterp;
+	}
+	if (m_exinterp.size() <= 2) {
+		m_exinterp += "data";
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisColumn::getName -- Return the label of the column.  This
+//     is the exclusive interpretation without "**" unless it has been
+//     set explicitly.
+//
+
+string HumAnalysisColumn::getName(void) const {
+	if (m_name.empty()) {
+		return m_exinterp.substr(2);
+	}
+	return m_name;
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisColumn::setName -- Set the label of the column.
+//
+
+void HumAnalysisColumn::setName(const string& name) {
+	m_name = name;
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisColumn::getInsertTrack -- Return the track before which
+//     the column will be rendered as a spine.  0 means after the last
+//     spine and -1 means before the first spine.
+//
+
+int HumAnalysisColumn::getInsertTrack(void) const {
+	return m_inserttrack;
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisColumn::setInsertTrack -- Set the track before which the
+//     column will be rendered as a spine.
+//
+
+void HumAnalysisColumn::setInsertTrack(int track) {
+	m_inserttrack = track;
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisColumn::isNull -- Return true if the line has no value.
+//
+
+bool HumAnalysisColumn::isNull(int lineindex) const {
+	return m_null.at(lineindex) != 0;
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisColumn::setNull -- Remove the value for a line.
+//
+
+void HumAnalysisColumn::setNull(int lineindex) {
+	m_null.at(lineindex) = 1;
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisColumn::setValue -- Set the value for a line.  The value
+//     is converted to the data type of the column if necessary.
+//
+
+void HumAnalysisColumn::setValue(int lineindex, int value) {
+	switch (m_type) {
+		case COLUMN_INT:    m_ints.at(lineindex) = value;              break;
+		case COLUMN_DOUBLE: m_doubles.at(lineindex) = value;           break;
+		default:            m_strings.at(lineindex) = to_string(value); break;
+	}
+	m_null.at(lineindex) = 0;
+}
+
+
+void HumAnalysisColumn::setValue(int lineindex, double value) {
+	switch (m_type) {
+		case COLUMN_INT:
+			m_ints.at(lineindex) = (int)value;
+			break;
+		case COLUMN_DOUBLE:
+			m_doubles.at(lineindex) = value;
+			break;
+		default:
+			{
+				stringstream ss;
+				ss << value;
+				m_strings.at(lineindex) = ss.str();
+			}
+			break;
+	}
+	m_null.at(lineindex) = 0;
+}
+
+
+void HumAnalysisColumn::setValue(int lineindex, const string& value) {
+	switch (m_type) {
+		case COLUMN_INT:    m_ints.at(lineindex) = stoi(value);    break;
+		case COLUMN_DOUBLE: m_doubles.at(lineindex) = stod(value); break;
+		default:            m_strings.at(lineindex) = value;       break;
+	}
+	m_null.at(lineindex) = 0;
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisColumn::getInt -- Return the value of a line in an integer
+//     column.  Returns 0 for null lines or other column types.
+//
+
+int HumAnalysisColumn::getInt(int lineindex) const {
+	if ((m_type != COLUMN_INT) || isNull(lineindex)) {
+		return 0;
+	}
+	return m_ints[lineindex];
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisColumn::getDouble -- Return the value of a line in a numeric
+//     column.  Returns 0.0 for null lines or string columns.
+//
+
+double HumAnalysisColumn::getDouble(int lineindex) const {
+	if (isNull(lineindex)) {
+		return 0.0;
+	}
+	switch (m_type) {
+		case COLUMN_INT:    return m_ints[lineindex];
+		case COLUMN_DOUBLE: return m_doubles[lineindex];
+	}
+	return 0.0;
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisColumn::getString -- Return the value of a line in a string
+//     column.  Returns an empty string for null lines or other column types.
+//
+
+const string& HumAnalysisColumn::getString(int lineindex) const {
+	static const string empty;
+	if ((m_type != COLUMN_STRING) || isNull(lineindex)) {
+		return empty;
+	}
+	return m_strings[lineindex];
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisColumn::getText -- Return the value of a line as text,
+//     formatted in the same way as when printing to an ostream.  Null
+//     lines return an empty string.
+//
+
+string HumAnalysisColumn::getText(int lineindex) const {
+	if (isNull(lineindex)) {
+		return "";
+	}
+	switch (m_type) {
+		case COLUMN_INT:
+			return to_string(m_ints[lineindex]);
+		case COLUMN_DOUBLE:
+			{
+				stringstream ss;
+				ss << m_doubles[lineindex];
+				return ss.str();
+			}
+	}
+	return m_strings[lineindex];
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisColumn::setData -- Store the values for all lines in the
+//     column.  Values which are equal to the null string when printed
+//     (or are empty strings) are stored as null, which is the same
+//     convention used by HumdrumFileContent::appendDataSpine().
+//
+
+void HumAnalysisColumn::setData(const vector<int>& data, const string& null) {
+	setLineCount((int)data.size());
+	for (int i=0; i<(int)data.size(); i++) {
+		setValue(i, data[i]);
+		checkNull(i, null);
+	}
+}
+
+
+void HumAnalysisColumn::setData(const vector<double>& data, const string& null) {
+	setLineCount((int)data.size());
+	for (int i=0; i<(int)data.size(); i++) {
+		setValue(i, data[i]);
+		checkNull(i, null);
+	}
+}
+
+
+void HumAnalysisColumn::setData(const vector<string>& data, const string& null) {
+	setLineCount((int)data.size());
+	for (int i=0; i<(int)data.size(); i++) {
+		if (data[i].empty() || (data[i] == null)) {
+			m_null[i] = 1;
+		} else {
+			setValue(i, data[i]);
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisColumn::checkNull -- Set a line to null if its printed value
+//     matches the null string.
+//
+
+void HumAnalysisColumn::checkNull(int lineindex, const string& null) {
+	if (null.empty()) {
+		return;
+	}
+	if (getText(lineindex) == null) {
+		m_null[lineindex] = 1;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumAnalysisColumn::writeBinary -- Write the column in binary form.  All
+//     integers are 32-bit and all values are in the native byte order:
+//        type, insert track, name length, name characters,
+//        exinterp length, exinterp characters, line count,
+//        null flags (one byte per line),
+//        values: int32 or float64 for each line, or for string columns
+//        a length followed by the characters for each line.
+//
+
+ostream& HumAnalysisColumn::writeBinary(ostream& out) const {
+	auto writeInt = [&out](int32_t value) {
+		out.write((const char*)&value, sizeof(value));
+	};
+	auto writeString = [&](const string& value) {
+		writeInt((int32_t)value.size());
+		out.write(value.data(), value.size());
+	};
+
+	writeInt(m_type);
+	writeInt(m_inserttrack);
+	writeString(getName());
+	writeString(m_exinterp);
+	int linecount = getLineCount();
+	writeInt(linecount);
+	out.write(m_null.data(), m_null.size());
+	switch (m_type) {
+		case COLUMN_INT:
+			for (int i=0; i<linecount; i++) {
+				writeInt(m_ints[i]);
+			}
+			break;
+		case COLUMN_DOUBLE:
+			out.write((const char*)m_doubles.data(), linecount * sizeof(double));
+			break;
+		default:
+			for (int i=0; i<linecount; i++) {
+				writeString(m_strings[i]);
+			}
+			break;
+	}
+	return out;
+}
+
+
+
 //////////////////////////////
 //
 // HumGrid::HumGrid -- Constructor.
 //
 
 HumGrid::HumGrid(void) {
-	// Limited to 100 parts:
-	m_verseCount.resize(100);
-	m_harmonyCount.resize(100);
-	m_dynamics.resize(100);
-	m_figured_bass.resize(100);
-	fill(m_dynamics.begin(), m_dynamics.end(), false);
-	fill(m_figured_bass.begin(), m_figured_bass.end(), false);
-	fill(m_harmonyCount.begin(), m_harmonyCount.end(), 0);
-
-	// default options
-	m_musicxmlbarlines = false;
-	m_recip = false;
-	m_pickup = false;
+	clear();
 }
 
 
@@ -6402,6 +7171,36 @@ HumGrid::~HumGrid(void) {
 
 
 
+//////////////////////////////
+//
+// HumGrid::clear -- Delete the measures and reset the part information
+//     and options, so that the grid can be reused for another score.
+//
+
+void HumGrid::clear(void) {
+	for (int i=0; i<(int)this->size(); i++) {
+		if (this->at(i)) {
+			delete this->at(i);
+		}
+	}
+	std::vector<GridMeasure*>::clear();
+	m_allslices.clear();
+
+	// Limited to 100 parts:
+	m_verseCount.assign(100, std::vector<int>());
+	m_harmonyCount.assign(100, 0);
+	m_dynamics.assign(100, false);
+	m_figured_bass.assign(100, false);
+	m_harmony.clear();
+
+	// default options
+	m_musicxmlbarlines = false;
+	m_recip = false;
+	m_pickup = false;
+}
+
+
+
 //////////////////////////////
 //
 // HumGrid::addMeasureToBack -- Allocate a GridMeasure at the end of the
@@ -9051,6 +9850,27 @@ void HumGrid::deleteMeasure(int index) {
 
 
 
+//////////////////////////////
+//
+// HumGrid::freePoolMemory -- Free the memory pools of the grid classes
+//     (see HumPool), such as after converting a large score in a
+//     long-running program.  This must only be called when no grids
+//     exist or are being created on other threads.  Returns false if
+//     some pool still had objects allocated from it, in which case that
+//     pool is kept.
+//
+
+bool HumGrid::freePoolMemory(void) {
+	bool status = true;
+	status &= HumPool<GridVoice>::clear();
+	status &= HumPool<GridStaff>::clear();
+	status &= HumPool<GridPart>::clear();
+	status &= HumPool<GridSlice>::clear();
+	return status;
+}
+
+
+
 //////////////////////////////
 //
 // operator<< -- Debugging printing of Humgrid Contents.
@@ -10717,6 +11537,538 @@ void HumInstrument::sortData(void) {
 
 
 
+//////////////////////////////
+//
+// HumKeyFinder::HumKeyFinder -- Constructor.  The Kostka-Payne
+//     profiles are used by default.
+//
+
+HumKeyFinder::HumKeyFinder(void) {
+	setProfile("kostka-payne");
+}
+
+
+
+//////////////////////////////
+//
+// HumKeyFinder::~HumKeyFinder -- Deconstructor.
+//
+
+HumKeyFinder::~HumKeyFinder() {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// HumKeyFinder::setProfile -- Select a set of key profiles by name:
+//     "kostka-payne" (David Temperley: Music and Probability 2006),
+//     "krumhansl-kessler" or "aarden-essen".  Returns false if the name
+//     is not known.
+//
+
+bool HumKeyFinder::setProfile(const string& name) {
+	if (name == "kostka-payne") {
+		setProfile(
+			{ 0.748, 0.060, 0.488, 0.082, 0.670, 0.460,
+			  0.096, 0.715, 0.104, 0.366, 0.057, 0.400 },
+			{ 0.712, 0.084, 0.474, 0.618, 0.049, 0.460,
+			  0.105, 0.747, 0.404, 0.067, 0.133, 0.330 });
+	} else if (name == "krumhansl-kessler") {
+		setProfile(
+			{ 6.35, 2.23, 3.48, 2.33, 4.38, 4.09,
+			  2.52, 5.19, 2.39, 3.66, 2.29, 2.88 },
+			{ 6.33, 2.68, 3.52, 5.38, 2.60, 3.53,
+			  2.54, 4.75, 3.98, 2.69, 3.34, 3.17 });
+	} else if (name == "aarden-essen") {
+		setProfile(
+			{ 17.7661, 0.145624, 14.9265, 0.160186, 19.8049, 11.3587,
+			  0.291248, 22.062, 0.145624, 8.15494, 0.232998, 4.95122 },
+			{ 18.2648, 0.737619, 14.0499, 16.8599, 0.702494, 14.4362,
+			  0.702494, 18.6161, 4.56621, 1.93186, 7.37619, 1.75623 });
+	} else {
+		return false;
+	}
+	return true;
+}
+
+
+//
+// Profiles are given for C major and C minor (index 0 = C, 1 = C#, etc.).
+//
+
+void HumKeyFinder::setProfile(const vector<double>& major,
+		const vector<double>& minor) {
+	for (int m=0; m<2; m++) {
+		const vector<double>& profile = m ? minor : major;
+		double mean = 0.0;
+		for (int i=0; i<12; i++) {
+			mean += profile.at(i);
+		}
+		mean /= 12.0;
+		double norm = 0.0;
+		for (int i=0; i<12; i++) {
+			norm += (profile[i] - mean) * (profile[i] - mean);
+		}
+		norm = sqrt(norm);
+		for (int tonic=0; tonic<12; tonic++) {
+			for (int i=0; i<12; i++) {
+				double value = profile[(i - tonic + 12) % 12] - mean;
+				m_kernels[m * 12 + tonic][i] = norm > 0.0 ? value / norm : 0.0;
+			}
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumKeyFinder::setHistograms -- Store a sequence of pitch-class
+//     histograms (such as one for each quarter note of a part) for use
+//     with analyzeWindow() and analyzeWindows().
+//
+
+void HumKeyFinder::setHistograms(const vector<vector<double>>& segments) {
+	m_prefix.assign((segments.size() + 1) * 12, 0.0);
+	for (int i=0; i<(int)segments.size(); i++) {
+		for (int k=0; k<12; k++) {
+			m_prefix[(i+1)*12 + k] = m_prefix[i*12 + k] + segments[i].at(k);
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumKeyFinder::getSegmentCount -- Return the number of histograms
+//     given to setHistograms().
+//
+
+int HumKeyFinder::getSegmentCount(void) const {
+	return m_prefix.empty() ? 0 : (int)m_prefix.size() / 12 - 1;
+}
+
+
+
+//////////////////////////////
+//
+// HumKeyFinder::getWindowHistogram -- Return the sum of the histograms
+//     for a range of segments.
+//
+
+void HumKeyFinder::getWindowHistogram(int start, int length,
+		vector<double>& histogram) const {
+	histogram.resize(12);
+	int count = getSegmentCount();
+	int end = start + length;
+	if (start < 0) {
+		start = 0;
+	}
+	if (end > count) {
+		end = count;
+	}
+	if (end <= start) {
+		fill(histogram.begin(), histogram.end(), 0.0);
+		return;
+	}
+	const double* first = &m_prefix[start * 12];
+	const double* last  = &m_prefix[end * 12];
+	for (int k=0; k<12; k++) {
+		histogram[k] = last[k] - first[k];
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumKeyFinder::analyzeHistogram -- Correlate a pitch-class histogram
+//     with the key profiles.  The output contains the 12 major key
+//     correlations (C, C#, ..., B), then the 12 minor key correlations,
+//     then the index of the best key (index 24) and the second best key
+//     (index 25), where minor keys are 12-23.  Returns the best key, or
+//     -1 if the histogram is empty (all values are set to -1 in that case).
+//
+
+int HumKeyFinder::analyzeHistogram(const vector<double>& histogram,
+		vector<double>& correls) const {
+	correls.resize(26);
+	double sum = 0.0;
+	double sumsq = 0.0;
+	for (int i=0; i<12; i++) {
+		sum += histogram[i];
+		sumsq += histogram[i] * histogram[i];
+	}
+	if (sum == 0.0) {
+		fill(correls.begin(), correls.end(), -1.0);
+		return -1;
+	}
+
+	// The kernels have a mean of zero, so the histogram does not need
+	// to be centered for the dot product.
+	double variance = sumsq - sum * sum / 12.0;
+	double scale = variance > 0.0 ? 1.0 / sqrt(variance) : 0.0;
+	for (int k=0; k<24; k++) {
+		const double* kernel = m_kernels[k];
+		double dot = 0.0;
+		for (int i=0; i<12; i++) {
+			dot += kernel[i] * histogram[i];
+		}
+		correls[k] = dot * scale;
+	}
+
+	int best = 0;
+	for (int k=1; k<24; k++) {
+		if (correls[k] > correls[best]) {
+			best = k;
+		}
+	}
+	int second = best == 0 ? 1 : 0;
+	for (int k=0; k<24; k++) {
+		if ((k != best) && (correls[k] > correls[second])) {
+			second = k;
+		}
+	}
+	correls[24] = best;
+	correls[25] = second;
+	return best;
+}
+
+
+
+//////////////////////////////
+//
+// HumKeyFinder::analyzeWindow -- Key analysis for the sum of the
+//     histograms in a range of segments.
+//
+
+int HumKeyFinder::analyzeWindow(int start, int length,
+		vector<double>& correls) const {
+	vector<double> histogram;
+	getWindowHistogram(start, length, histogram);
+	return analyzeHistogram(histogram, correls);
+}
+
+
+
+//////////////////////////////
+//
+// HumKeyFinder::analyzeWindows -- Key analyses for a sliding window of
+//     the given length which moves by hop segments.  At most count
+//     windows are analyzed (or all windows which fit into the segments
+//     if count is less than one).
+//
+
+void HumKeyFinder::analyzeWindows(int length, int hop, int count,
+		vector<vector<double>>& output) const {
+	output.clear();
+	if (hop < 1) {
+		hop = 1;
+	}
+	int segments = getSegmentCount();
+	vector<double> histogram;
+	for (int i=0; (count < 1) || (i < count); i++) {
+		int start = i * hop;
+		if (start + length > segments) {
+			break;
+		}
+		getWindowHistogram(start, length, histogram);
+		output.resize(output.size() + 1);
+		analyzeHistogram(histogram, output.back());
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumKeyFinder::getTrackHistograms -- Calculate pitch-class histograms
+//     weighted by duration for each **kern track in a file.  The score is
+//     divided into the given number of segments of equal duration.  The
+//     output is indexed by track number, and is empty for non-kern tracks.
+//
+
+void HumKeyFinder::getTrackHistograms(HumdrumFile& infile, int segments,
+		vector<vector<vector<double>>>& histograms) {
+	if (segments < 1) {
+		segments = 1;
+	}
+	histograms.clear();
+	histograms.resize(infile.getMaxTrack() + 1);
+	for (int t=1; t<=infile.getMaxTrack(); t++) {
+		if (infile.getTrackStart(t)->isKern()) {
+			histograms[t].assign(segments, vector<double>(12, 0.0));
+		}
+	}
+
+	double totalduration = infile.getScoreDuration().getFloat();
+	if (totalduration <= 0.0) {
+		return;
+	}
+	for (int i=0; i<infile.getLineCount(); i++) {
+		if (!infile[i].isData()) {
+			continue;
+		}
+		double start = infile[i].getDurationFromStart().getFloat();
+		for (int j=0; j<infile[i].getFieldCount(); j++) {
+			HTp token = infile.token(i, j);
+			if (!token->isKern() || token->isNull()) {
+				continue;
+			}
+			int scount = token->getSubtokenCount();
+			for (int k=0; k<scount; k++) {
+				string subtok = (scount == 1) ? (string)*token : token->getSubtoken(k);
+				int pitch = Convert::kernToMidiNoteNumber(subtok);
+				if (pitch < 0) {
+					continue;  // ignore rests or strange objects
+				}
+				double duration = Convert::recipToDuration(subtok).getFloat();
+				if (duration <= 0.0) {
+					continue;  // ignore grace notes and strange objects
+				}
+				addToHistogram(histograms[token->getTrack()], pitch % 12,
+						start, duration, totalduration);
+			}
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumKeyFinder::addToHistogram -- Add a note to the segments which it
+//     overlaps, weighted by the fraction of each segment it fills.
+//
+
+void HumKeyFinder::addToHistogram(vector<vector<double>>& histogram,
+		int pc, double start, double duration, double totalduration) {
+	int segments = (int)histogram.size();
+	double startseg = start / totalduration * segments;
+	int index = (int)startseg;
+	if (index >= segments) {
+		return;
+	}
+	double segdur = duration / totalduration * segments;
+	double startfrac = startseg - index;
+	if (segdur <= 1.0 - startfrac) {
+		histogram[index][pc] += segdur;
+		return;
+	}
+	histogram[index][pc] += 1.0 - startfrac;
+	segdur -= 1.0 - startfrac;
+	for (index++; (segdur > 0.0) && (index < segments); index++) {
+		double amount = segdur < 1.0 ? segdur : 1.0;
+		histogram[index][pc] += amount;
+		segdur -= amount;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumLayoutIndex::HumLayoutIndex -- Constructor.
+//
+
+HumLayoutIndex::HumLayoutIndex(void) {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// HumLayoutIndex::~HumLayoutIndex -- Deconstructor.
+//
+
+HumLayoutIndex::~HumLayoutIndex() {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// HumLayoutIndex::clear -- Remove all parameters from the index.
+//
+
+void HumLayoutIndex::clear(void) {
+	m_categories.clear();
+	m_version = -1;
+}
+
+
+
+//////////////////////////////
+//
+// HumLayoutIndex::addParameterSet -- Add the next parameter set which
+//     applies to the token.  Parameter sets must be added in the order
+//     of HumdrumToken::getLinkedParameter(index).  Sets which are not in
+//     the LO namespace are ignored.
+//
+
+void HumLayoutIndex::addParameterSet(HumParamSet& pset) {
+	if (pset.getNamespace1() != "LO") {
+		return;
+	}
+	Category& category = m_categories[pset.getNamespace2()];
+
+	// values: The last value of each key in the parameter set.
+	unordered_map<string, string> values;
+	for (int i=0; i<pset.getCount(); i++) {
+		const string& key = pset.getParameterName(i);
+		const string& value = pset.getParameterValue(i);
+		auto it = category.entries.find(key);
+		if (it == category.entries.end()) {
+			Entry& entry = category.entries[key];
+			entry.first = value;
+			// The key does not occur in the previous sets of the category:
+			for (int j=0; j<(int)category.history.size(); j++) {
+				addStep(entry, category.history[j], "");
+			}
+			entry.last = value;
+		} else {
+			it->second.last = value;
+		}
+		values[key] = value;
+		if (key == "n") {
+			category.n = value;
+		}
+	}
+
+	category.history.push_back(category.n);
+	for (auto& it : category.entries) {
+		auto found = values.find(it.first);
+		if (found == values.end()) {
+			addStep(it.second, category.n, "");
+		} else {
+			addStep(it.second, category.n, found->second);
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumLayoutIndex::addStep -- Add the value of a key in one parameter set
+//     to the note list of the key.  The value applies to the note given
+//     by the current @n value, or to all remaining notes if there is no
+//     @n value (if the value is not empty).  Values of earlier parameter
+//     sets have priority.  An @n value which is not a number does not
+//     apply to any note.
+//
+
+void HumLayoutIndex::addStep(Entry& entry, const string& n,
+		const string& value) {
+	if (entry.doneQ) {
+		return;
+	}
+	if (n.empty()) {
+		if (!value.empty()) {
+			entry.fallback = value;
+			entry.doneQ = true;
+		}
+		return;
+	}
+	// currently @n requires a single value (should allow a range or
+	// multiple values later).
+	int number;
+	try {
+		number = stoi(n);
+	} catch (std::invalid_argument&) {
+		return;
+	} catch (std::out_of_range&) {
+		return;
+	}
+	entry.notes.emplace(number - 1, value);
+}
+
+
+
+//////////////////////////////
+//
+// HumLayoutIndex::getValue -- Return the value of a layout parameter as
+//     in HumdrumToken::getLayoutParameter().  If subtokenindex is negative,
+//     the first value of the key is returned; otherwise the first value
+//     which applies to the given note in a chord.
+//
+
+const string& HumLayoutIndex::getValue(const string& category,
+		const string& keyname, int subtokenindex) const {
+	static const string empty;
+	auto cit = m_categories.find(category);
+	if (cit == m_categories.end()) {
+		return empty;
+	}
+	auto eit = cit->second.entries.find(keyname);
+	if (eit == cit->second.entries.end()) {
+		return empty;
+	}
+	const Entry& entry = eit->second;
+	if (subtokenindex < 0) {
+		return entry.first;
+	}
+	auto nit = entry.notes.find(subtokenindex);
+	if (nit != entry.notes.end()) {
+		return nit->second;
+	}
+	return entry.fallback;
+}
+
+
+
+//////////////////////////////
+//
+// HumLayoutIndex::getLastValue -- Return the last value of a key in the
+//     parameter sets of a category, or an empty string if the key is not
+//     found.
+//
+
+const string& HumLayoutIndex::getLastValue(const string& category,
+		const string& keyname) const {
+	static const string empty;
+	auto cit = m_categories.find(category);
+	if (cit == m_categories.end()) {
+		return empty;
+	}
+	auto eit = cit->second.entries.find(keyname);
+	if (eit == cit->second.entries.end()) {
+		return empty;
+	}
+	return eit->second.last;
+}
+
+
+
+//////////////////////////////
+//
+// HumLayoutIndex::getVersion -- Return the layout parameter version of
+//     the owning file when the index was built, or -1 if it has not
+//     been built.
+//
+
+int HumLayoutIndex::getVersion(void) const {
+	return m_version;
+}
+
+
+
+//////////////////////////////
+//
+// HumLayoutIndex::setVersion --
+//
+
+void HumLayoutIndex::setVersion(int version) {
+	m_version = version;
+}
+
+
+
 //////////////////////////////
 //
 // HumNum::HumNum -- HumNum Constructor.  Set the default value
@@ -11562,6 +12914,290 @@ ostream& operator<<(ostream& out, const HumNum& number) {
 
 
 
+//////////////////////////////
+//
+// HumOutputSink::HumOutputSink -- Constructor.  Text is collected
+//     in a 64 kB buffer before being sent to the writer.  The buffer is
+//     allocated when the first writer is set, since most tools never
+//     use the sink.
+//
+
+HumOutputSink::HumOutputSink(void) {
+	m_bytes = 0;
+}
+
+
+
+//////////////////////////////
+//
+// HumOutputSink::~HumOutputSink -- Deconstructor.  Any remaining
+//     text is sent to the writer.
+//
+
+HumOutputSink::~HumOutputSink() {
+	flush();
+}
+
+
+
+//////////////////////////////
+//
+// HumOutputSink::setWriter -- Send output to a function.  Any text
+//     for the previous writer is flushed first.
+//
+
+void HumOutputSink::setWriter(const Writer& writer) {
+	flush();
+	m_writer = writer;
+	if (m_buffer.empty()) {
+		m_buffer.resize(65536);
+		setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumOutputSink::setStream -- Send output to an ostream.  The stream
+//     must stay valid until the sink is cleared or destroyed.
+//
+
+void HumOutputSink::setStream(ostream& out) {
+	ostream* outp = &out;
+	setWriter([outp](const char* data, size_t size) {
+		outp->write(data, size);
+	});
+}
+
+
+
+//////////////////////////////
+//
+// HumOutputSink::setFileDescriptor -- Send output to an open file
+//     descriptor (such as 1 for standard output).  The file descriptor
+//     is not closed by the sink.
+//
+
+void HumOutputSink::setFileDescriptor(int fd) {
+	setWriter([fd](const char* data, size_t size) {
+		while (size > 0) {
+			#ifdef _WIN32
+				int count = _write(fd, data, (unsigned int)size);
+			#else
+				ssize_t count = ::write(fd, data, size);
+			#endif
+			if (count < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				return;
+			}
+			data += count;
+			size -= count;
+		}
+	});
+}
+
+
+
+//////////////////////////////
+//
+// HumOutputSink::clear -- Flush any remaining text and remove the writer.
+//
+
+void HumOutputSink::clear(void) {
+	flush();
+	m_writer = nullptr;
+}
+
+
+
+//////////////////////////////
+//
+// HumOutputSink::isActive -- Returns true if there is a writer.
+//
+
+bool HumOutputSink::isActive(void) const {
+	return (bool)m_writer;
+}
+
+
+
+//////////////////////////////
+//
+// HumOutputSink::flush -- Send any buffered text to the writer.
+//     Text written without a writer is discarded.  Returns false
+//     if there is no writer.
+//
+
+bool HumOutputSink::flush(void) {
+	size_t size = pptr() - pbase();
+	bool status = isActive();
+	if (size > 0) {
+		if (status) {
+			m_writer(pbase(), size);
+		}
+		m_bytes += size;
+		setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+	}
+	return status;
+}
+
+
+
+//////////////////////////////
+//
+// HumOutputSink::getByteCount -- Return the number of bytes written to
+//     the sink (including text which has not yet been flushed).
+//
+
+size_t HumOutputSink::getByteCount(void) const {
+	return m_bytes + (pptr() - pbase());
+}
+
+
+
+//////////////////////////////
+//
+// HumOutputSink::resetByteCount --
+//
+
+void HumOutputSink::resetByteCount(void) {
+	flush();
+	m_bytes = 0;
+}
+
+
+
+//////////////////////////////
+//
+// HumOutputSink::overflow -- Called when the buffer is full.
+//
+
+int HumOutputSink::overflow(int ch) {
+	flush();
+	if (m_buffer.empty()) {
+		// Text is discarded if a writer was never set.
+		return traits_type::not_eof(ch);
+	}
+	if (ch != traits_type::eof()) {
+		*pptr() = (char)ch;
+		pbump(1);
+	}
+	return traits_type::not_eof(ch);
+}
+
+
+
+//////////////////////////////
+//
+// HumOutputSink::sync -- Called when the ostream is flushed (such as
+//     by endl).  The text is kept in the buffer so that line-by-line
+//     output does not cause a write for each line: use flush() to send
+//     the text to the writer.
+//
+
+int HumOutputSink::sync(void) {
+	return 0;
+}
+
+
+
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+	#define HUMPARALLEL_SERIAL
+#endif
+
+
+//////////////////////////////
+//
+// HumParallel::getThreadCount -- Return the number of threads to use.
+//     If requested is positive, then that value will be returned;
+//     otherwise, the number of hardware threads is returned.
+//
+
+int HumParallel::getThreadCount(int requested) {
+#ifdef HUMPARALLEL_SERIAL
+	return 1;
+#else
+	if (requested > 0) {
+		return requested;
+	}
+	int count = (int)std::thread::hardware_concurrency();
+	return count > 0 ? count : 1;
+#endif
+}
+
+
+
+//////////////////////////////
+//
+// HumParallel::run -- Run job(i) for each i in the range [0, jobcount).
+//     Jobs are handed out to threadcount worker threads in increasing
+//     order, so each job must be independent of the others (store results
+//     into pre-sized vectors indexed by the job number).  If threadcount
+//     is zero, then the number of hardware threads will be used.  If a job
+//     throws an exception, the remaining jobs are skipped and the first
+//     exception is rethrown in the calling thread after all workers finish.
+//
+
+void HumParallel::run(int jobcount, int threadcount,
+		const std::function<void(int)>& job) {
+	if (jobcount <= 0) {
+		return;
+	}
+	threadcount = getThreadCount(threadcount);
+	if (threadcount > jobcount) {
+		threadcount = jobcount;
+	}
+	if (threadcount <= 1) {
+		for (int i=0; i<jobcount; i++) {
+			job(i);
+		}
+		return;
+	}
+
+#ifndef HUMPARALLEL_SERIAL
+	std::atomic<int> next(0);
+	std::atomic<bool> failed(false);
+	std::exception_ptr error = NULL;
+	std::mutex errormutex;
+
+	auto worker = [&](void) {
+		while (!failed) {
+			int index = next++;
+			if (index >= jobcount) {
+				break;
+			}
+			try {
+				job(index);
+			} catch (...) {
+				std::lock_guard<std::mutex> lock(errormutex);
+				if (!error) {
+					error = std::current_exception();
+				}
+				failed = true;
+			}
+		}
+	};
+
+	vector<std::thread> threads;
+	threads.reserve(threadcount - 1);
+	for (int i=1; i<threadcount; i++) {
+		threads.emplace_back(worker);
+	}
+	worker();
+	for (int i=0; i<(int)threads.size(); i++) {
+		threads[i].join();
+	}
+	if (error) {
+		std::rethrow_exception(error);
+	}
+#endif
+}
+
+
+
 
 //////////////////////////////
 //
@@ -11881,7 +13517,7 @@ HumRegex::HumRegex(const string& exp, const string& options) {
 		// explicitly set the default syntax
 		m_regexflags = std::regex_constants::ECMAScript;
 	}
-	m_regex = regex(exp, getTemporaryRegexFlags(options));
+	compileRegex(exp, getTemporaryRegexFlags(options));
 	m_searchflags = (std::regex_constants::match_flag_type)0;
 	m_searchflags = getTemporarySearchFlags(options);
 }
@@ -11898,6 +13534,27 @@ HumRegex::~HumRegex() {
 }
 
 
+//////////////////////////////
+//
+// HumRegex::compileRegex -- Set the regular expression to use for
+//     searching, matching or replacing.  The expression is compiled only
+//     if it or its flags are different from the previous expression, so
+//     that the same search can be repeated on many strings efficiently.
+//
+
+void HumRegex::compileRegex(const string& exp,
+		std::regex_constants::syntax_option_type flags) {
+	if (m_compiledQ && (flags == m_expressionflags) && (exp == m_expression)) {
+		return;
+	}
+	m_regex = regex(exp, flags);
+	m_expression = exp;
+	m_expressionflags = flags;
+	m_compiledQ = true;
+}
+
+
+
 ///////////////////////////////////////////////////////////////////////////
 //
 // option setting
@@ -11983,7 +13640,7 @@ void HumRegex::unsetGlobal(void) {
 //
 
 int HumRegex::search(const string& input, const string& exp) {
-	m_regex = regex(exp, m_regexflags);
+	compileRegex(exp, m_regexflags);
 	bool result = regex_search(input, m_matches, m_regex, m_searchflags);
 	if (!result) {
 		return 0;
@@ -11998,7 +13655,7 @@ int HumRegex::search(const string& input, const string& exp) {
 
 int HumRegex::search(const string& input, int startindex,
 		const string& exp) {
-	m_regex = regex(exp, m_regexflags);
+	compileRegex(exp, m_regexflags);
 	auto startit = input.begin() + startindex;
 	auto endit   = input.end();
 	bool result = regex_search(startit, endit, m_matches, m_regex, m_searchflags);
@@ -12027,7 +13684,7 @@ int HumRegex::search(string* input, int startindex, const string& exp) {
 
 int HumRegex::search(const string& input, const string& exp,
 		const string& options) {
-	m_regex = regex(exp, getTemporaryRegexFlags(options));
+	compileRegex(exp, getTemporaryRegexFlags(options));
 	bool result = regex_search(input, m_matches, m_regex, getTemporarySearchFlags(options));
 	if (!result) {
 		return 0;
@@ -12041,7 +13698,7 @@ int HumRegex::search(const string& input, const string& exp,
 
 int HumRegex::search(const string& input, int startindex, const string& exp,
 		const string& options) {
-	m_regex = regex(exp, getTemporaryRegexFlags(options));
+	compileRegex(exp, getTemporaryRegexFlags(options));
 	auto startit = input.begin() + startindex;
 	auto endit   = input.end();
 	bool result = regex_search(startit, endit, m_matches, m_regex, getTemporarySearchFlags(options));
@@ -12206,14 +13863,14 @@ int HumRegex::getMatchLength(int index) {
 //
 
 bool HumRegex::match(const string& input, const string& exp) {
-	m_regex = regex(exp, m_regexflags);
+	compileRegex(exp, m_regexflags);
 	return regex_match(input, m_regex, m_searchflags);
 }
 
 
 bool HumRegex::match(const string& input, const string& exp,
 		const string& options) {
-	m_regex = regex(exp, getTemporaryRegexFlags(options));
+	compileRegex(exp, getTemporaryRegexFlags(options));
 	return regex_match(input, m_regex, getTemporarySearchFlags(options));
 }
 
@@ -12245,7 +13902,7 @@ bool HumRegex::match(const string* input, const string& exp,
 
 string& HumRegex::replaceDestructive(string& input, const string& replacement,
 		const string& exp) {
-	m_regex = regex(exp, m_regexflags);
+	compileRegex(exp, m_regexflags);
 	input = regex_replace(input, m_regex, replacement, m_searchflags);
 	return input;
 }
@@ -12262,7 +13919,7 @@ string& HumRegex::replaceDestructive(string* input, const string& replacement,
 
 string& HumRegex::replaceDestructive(string& input, const string& replacement,
 		const string& exp, const string& options) {
-	m_regex = regex(exp, getTemporaryRegexFlags(options));
+	compileRegex(exp, getTemporaryRegexFlags(options));
 	input = regex_replace(input, m_regex, replacement, getTemporarySearchFlags(options));
 	return input;
 }
@@ -12283,7 +13940,7 @@ string& HumRegex::replaceDestructive (string* input, const string& replacement,
 
 string HumRegex::replaceCopy(const string& input, const string& replacement,
 		const string& exp) {
-	m_regex = regex(exp, m_regexflags);
+	compileRegex(exp, m_regexflags);
 	string output;
 	regex_replace(std::back_inserter(output), input.begin(),
 			input.end(), m_regex, replacement);
@@ -12302,7 +13959,7 @@ string HumRegex::replaceCopy(string* input, const string& replacement,
 
 string HumRegex::replaceCopy(const string& input, const string& exp,
 		const string& replacement, const string& options) {
-	m_regex = regex(exp, getTemporaryRegexFlags(options));
+	compileRegex(exp, getTemporaryRegexFlags(options));
 	string output;
 	regex_replace(std::back_inserter(output), input.begin(),
 			input.end(), m_regex, replacement, getTemporarySearchFlags(options));
@@ -12434,6 +14091,316 @@ std::regex_constants::match_flag_type HumRegex::getTemporarySearchFlags(
 }
 
 
+//////////////////////////////
+//
+// HumScoreEntry::HumScoreEntry -- Constructor.  The file is not read
+//     until prepare() is called.
+//
+
+HumScoreEntry::HumScoreEntry(const string& filename) {
+	m_filename = filename;
+}
+
+
+
+//////////////////////////////
+//
+// HumScoreEntry::~HumScoreEntry -- Deconstructor.
+//
+
+HumScoreEntry::~HumScoreEntry() {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// HumScoreEntry::getFilename --
+//
+
+const string& HumScoreEntry::getFilename(void) const {
+	return m_filename;
+}
+
+
+
+//////////////////////////////
+//
+// HumScoreEntry::getFile -- Return the parsed file.  The entry's mutex
+//     must be locked and prepare() called before using the file.
+//
+
+HumdrumFile& HumScoreEntry::getFile(void) {
+	return m_file;
+}
+
+
+
+//////////////////////////////
+//
+// HumScoreEntry::getMutex --
+//
+
+mutex& HumScoreEntry::getMutex(void) {
+	return m_mutex;
+}
+
+
+
+//////////////////////////////
+//
+// HumScoreEntry::prepare -- Get the file ready for use: read it the
+//     first time, or read it again if the previous user changed its
+//     contents or if the file was changed on disk.  Analyses which were
+//     done by previous users are kept if the file was not changed.
+//     Returns false if the file cannot be read.  The entry's mutex must
+//     be locked when calling this function.
+//
+
+bool HumScoreEntry::prepare(void) {
+	if (!m_loaded || isChangedOnDisk() || isModified()) {
+		return load();
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumScoreEntry::isModified -- Returns true if lines were added to or
+//     removed from the file, or if the text of any line was changed.
+//
+
+bool HumScoreEntry::isModified(void) {
+	return getContentHash() != m_hash;
+}
+
+
+
+//////////////////////////////
+//
+// HumScoreEntry::isChangedOnDisk -- Returns true if the modification time
+//     or size of the file is different from when it was read.
+//
+
+bool HumScoreEntry::isChangedOnDisk(void) {
+	time_t mtime;
+	off_t size;
+	if (!getFileStatus(mtime, size)) {
+		return true;
+	}
+	return (mtime != m_mtime) || (size != m_size);
+}
+
+
+
+//////////////////////////////
+//
+// HumScoreEntry::getFileStatus -- Get the modification time and size of
+//     the file.  Returns false if the file cannot be accessed.
+//
+
+bool HumScoreEntry::getFileStatus(time_t& mtime, off_t& size) {
+	struct stat info;
+	if (stat(m_filename.c_str(), &info) != 0) {
+		return false;
+	}
+	mtime = info.st_mtime;
+	size = info.st_size;
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumScoreEntry::getParseCount -- Return the number of times that the
+//     file has been read.
+//
+
+int HumScoreEntry::getParseCount(void) const {
+	return m_parsecount;
+}
+
+
+
+//////////////////////////////
+//
+// HumScoreEntry::load -- Read and parse the file.
+//
+
+bool HumScoreEntry::load(void) {
+	m_parsecount++;
+	// The status is read before the file so that a change while reading
+	// causes the file to be read again next time.
+	if (!getFileStatus(m_mtime, m_size)) {
+		m_mtime = 0;
+		m_size = -1;
+	}
+	m_loaded = m_file.read(m_filename);
+	m_hash = getContentHash();
+	return m_loaded;
+}
+
+
+
+//////////////////////////////
+//
+// HumScoreEntry::getContentHash -- Hash of the line count and the text
+//     of each line.  Lines which have tokens that were changed are
+//     regenerated before they are hashed.
+//
+
+size_t HumScoreEntry::getContentHash(void) {
+	std::hash<string> hasher;
+	size_t output = m_file.getLineCount();
+	for (int i=0; i<m_file.getLineCount(); i++) {
+		HumdrumLine& line = m_file[i];
+		line.updateText();
+		size_t value = hasher(static_cast<const string&>(line));
+		output ^= value + 0x9e3779b9 + (output << 6) + (output >> 2);
+	}
+	return output;
+}
+
+
+
+//////////////////////////////
+//
+// HumScoreCache::HumScoreCache -- Constructor.
+//
+
+HumScoreCache::HumScoreCache(int maxfiles) {
+	m_maxfiles = maxfiles;
+}
+
+
+
+//////////////////////////////
+//
+// HumScoreCache::~HumScoreCache -- Deconstructor.
+//
+
+HumScoreCache::~HumScoreCache() {
+	clear();
+}
+
+
+
+//////////////////////////////
+//
+// HumScoreCache::getScore -- Return the entry for a file, adding it to
+//     the cache if necessary.  Lock the mutex of the entry and call
+//     HumScoreEntry::prepare() before using the file.  Entries which
+//     are removed from the cache stay valid until they are no longer used.
+//
+
+std::shared_ptr<HumScoreEntry> HumScoreCache::getScore(const string& filename) {
+	lock_guard<mutex> lock(m_mutex);
+	auto it = m_index.find(filename);
+	if (it != m_index.end()) {
+		m_hits++;
+		m_entries.splice(m_entries.begin(), m_entries, it->second);
+		return m_entries.front();
+	}
+	m_misses++;
+	m_entries.push_front(std::make_shared<HumScoreEntry>(filename));
+	m_index[filename] = m_entries.begin();
+	trim();
+	return m_entries.front();
+}
+
+
+
+//////////////////////////////
+//
+// HumScoreCache::clear -- Remove all files from the cache.
+//
+
+void HumScoreCache::clear(void) {
+	lock_guard<mutex> lock(m_mutex);
+	m_entries.clear();
+	m_index.clear();
+}
+
+
+
+//////////////////////////////
+//
+// HumScoreCache::setMaxFiles -- Set the maximum number of files to
+//     store.  A value less than one means no limit.
+//
+
+void HumScoreCache::setMaxFiles(int maxfiles) {
+	lock_guard<mutex> lock(m_mutex);
+	m_maxfiles = maxfiles;
+	trim();
+}
+
+
+
+//////////////////////////////
+//
+// HumScoreCache::getMaxFiles --
+//
+
+int HumScoreCache::getMaxFiles(void) {
+	lock_guard<mutex> lock(m_mutex);
+	return m_maxfiles;
+}
+
+
+
+//////////////////////////////
+//
+// HumScoreCache::getCount -- Return the number of files in the cache.
+//
+
+int HumScoreCache::getCount(void) {
+	lock_guard<mutex> lock(m_mutex);
+	return (int)m_entries.size();
+}
+
+
+
+//////////////////////////////
+//
+// HumScoreCache::printStatistics -- Print the number of stored files
+//     and the number of cache hits and misses.
+//
+
+ostream& HumScoreCache::printStatistics(ostream& out) {
+	lock_guard<mutex> lock(m_mutex);
+	out << "files:\t"    << m_entries.size() << "\n";
+	out << "maxfiles:\t" << m_maxfiles       << "\n";
+	out << "hits:\t"     << m_hits           << "\n";
+	out << "misses:\t"   << m_misses         << "\n";
+	return out;
+}
+
+
+
+//////////////////////////////
+//
+// HumScoreCache::trim -- Remove the least-recently used files until the
+//     cache is not larger than the maximum size.  The mutex must be
+//     locked when calling this function.
+//
+
+void HumScoreCache::trim(void) {
+	if (m_maxfiles < 1) {
+		return;
+	}
+	while ((int)m_entries.size() > m_maxfiles) {
+		m_index.erase(m_entries.back()->getFilename());
+		m_entries.pop_back();
+	}
+}
+
+
+
 
 //////////////////////////////
 //
@@ -12774,7 +14741,7 @@ HumTool::HumTool(void) {
 //
 
 HumTool::~HumTool() {
-	// do nothing
+	clearHumdrumOutput();
 }
 
 
@@ -12789,7 +14756,7 @@ bool HumTool::hasAnyText(void) {
 	if (m_suppress) {
 		return true;
 	}
-	return ((!m_humdrum_text.str().empty())
+	return (hasHumdrumText()
 			|| (!m_free_text.str().empty())
 			|| (!m_json_text.str().empty()));
 }
@@ -12803,6 +14770,7 @@ bool HumTool::hasAnyText(void) {
 //
 
 string HumTool::getAllText(void) {
+	m_humdrum_sink.flush();
 	return  m_humdrum_text.str()
 	      + m_json_text.str()
 	      + m_free_text.str();
@@ -12813,6 +14781,7 @@ string HumTool::getAllText(void) {
 //
 
 ostream& HumTool::getAllText(ostream& out) {
+	m_humdrum_sink.flush();
 	out << m_humdrum_text.str();
 	out << m_json_text.str();
 	out << m_free_text.str();
@@ -12832,6 +14801,78 @@ void HumTool::suppressHumdrumFileOutput(void) {
 
 
 
+//////////////////////////////
+//
+// HumTool::setHumdrumOutput -- Send Humdrum text directly to an
+//    ostream, a file descriptor or a writing function while the tool
+//    is running, rather than storing it until getAllText() is called.
+//    JSON and free text are still stored, so they will be printed after
+//    the Humdrum text as when buffering.  The text is flushed when
+//    getAllText(), getHumdrumText() or clearOutput() is called.
+//    Returns false if the tool has to store its Humdrum output for
+//    further processing, in which case the output is buffered as usual.
+//
+
+bool HumTool::setHumdrumOutput(ostream& out) {
+	if (m_buffer_humdrum) {
+		return false;
+	}
+	m_humdrum_sink.setStream(out);
+	static_cast<ios&>(m_humdrum_text).rdbuf(&m_humdrum_sink);
+	return true;
+}
+
+
+bool HumTool::setHumdrumOutput(int fd) {
+	if (m_buffer_humdrum) {
+		return false;
+	}
+	m_humdrum_sink.setFileDescriptor(fd);
+	static_cast<ios&>(m_humdrum_text).rdbuf(&m_humdrum_sink);
+	return true;
+}
+
+
+bool HumTool::setHumdrumOutput(const HumOutputSink::Writer& writer) {
+	if (m_buffer_humdrum) {
+		return false;
+	}
+	m_humdrum_sink.setWriter(writer);
+	static_cast<ios&>(m_humdrum_text).rdbuf(&m_humdrum_sink);
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumTool::clearHumdrumOutput -- Flush any Humdrum text to the output
+//    set with setHumdrumOutput() and go back to storing Humdrum text.
+//
+
+void HumTool::clearHumdrumOutput(void) {
+	if (!isStreamingHumdrum()) {
+		return;
+	}
+	m_humdrum_sink.clear();
+	m_humdrum_sink.resetByteCount();
+	static_cast<ios&>(m_humdrum_text).rdbuf(m_humdrum_text.rdbuf());
+}
+
+
+
+//////////////////////////////
+//
+// HumTool::isStreamingHumdrum -- Returns true if Humdrum text is sent
+//    directly to the output.
+//
+
+bool HumTool::isStreamingHumdrum(void) {
+	return m_humdrum_sink.isActive();
+}
+
+
+
 //////////////////////////////
 //
 // HumTool::hasHumdrumText -- Returns true if the output contains
@@ -12839,6 +14880,9 @@ void HumTool::suppressHumdrumFileOutput(void) {
 //
 
 bool HumTool::hasHumdrumText(void) {
+	if (m_humdrum_sink.getByteCount() > 0) {
+		return true;
+	}
 	return m_humdrum_text.str().empty() ? false : true;
 }
 
@@ -12847,10 +14891,12 @@ bool HumTool::hasHumdrumText(void) {
 //////////////////////////////
 //
 // HumTool::getHumdrumText -- Get the text content which represents
-//     Humdrum syntax.
+//     Humdrum syntax.  Text which was sent directly to the output
+//     (see setHumdrumOutput()) is not included.
 //
 
 string HumTool::getHumdrumText(void) {
+	m_humdrum_sink.flush();
 	return m_humdrum_text.str();
 }
 
@@ -12859,6 +14905,7 @@ string HumTool::getHumdrumText(void) {
 //
 
 ostream& HumTool::getHumdrumText(ostream& out) {
+	m_humdrum_sink.flush();
 	out << m_humdrum_text.str();
 	return out;
 }
@@ -13007,6 +15054,7 @@ ostream& HumTool::getError(ostream& out) {
 //
 
 void HumTool::clearOutput(void) {
+	m_humdrum_sink.resetByteCount();
 	m_humdrum_text.str("");
 	m_json_text.str("");
 	m_free_text.str("");
@@ -13621,6 +15669,7 @@ HumdrumFileBase::HumdrumFileBase(HumdrumFileBase& infile) {
 	m_filename = infile.m_filename;
 	m_segmentlevel = infile.m_segmentlevel;
 	m_trackstarts.clear();
+	m_trackdatatypes.clear();
 	m_trackends.clear();
 	m_barlines.clear();
 	m_ticksperquarternote = infile.m_ticksperquarternote;
@@ -13657,6 +15706,7 @@ HumdrumFileBase& HumdrumFileBase::operator=(HumdrumFileBase& infile) {
 	m_filename = infile.m_filename;
 	m_segmentlevel = infile.m_segmentlevel;
 	m_trackstarts.clear();
+	m_trackdatatypes.clear();
 	m_trackends.clear();
 	m_barlines.clear();
 	m_ticksperquarternote = infile.m_ticksperquarternote;
@@ -13666,6 +15716,8 @@ HumdrumFileBase& HumdrumFileBase::operator=(HumdrumFileBase& infile) {
 	m_quietParse = infile.m_quietParse;
 	m_parseError = infile.m_parseError;
 	m_displayError = infile.m_displayError;
+	m_timeline_analyzed = false;
+	m_contentcount++;
 
 	m_lines.resize(infile.m_lines.size());
 	for (int i=0; i<(int)m_lines.size(); i++) {
@@ -13707,7 +15759,11 @@ void HumdrumFileBase::clear(void) {
 
 	// clear state variables which are now invalid:
 	m_trackstarts.clear();
+	m_trackdatatypes.clear();
 	m_trackends.clear();
+	m_spineinfos.clear();
+	m_spineinfotracks.clear();
+	m_spineinfoids.clear();
 	m_barlines.clear();
 	m_ticksperquarternote = -1;
 	m_idprefix.clear();
@@ -13717,6 +15773,8 @@ void HumdrumFileBase::clear(void) {
 	m_segmentlevel = 0;
 	m_structure_analyzed = false;
 	m_rhythm_analyzed = false;
+	m_timeline_analyzed = false;
+	m_contentcount++;
 }
 
 
@@ -15131,8 +17189,10 @@ bool HumdrumFileBase::stitchLinesTogether(HumdrumLine& previous,
 bool HumdrumFileBase::analyzeSpines(void) {
 	vector<string> datatype;
 	vector<string> sinfo;
+	vector<int> sinfoid;
 	vector<vector<HTp> > lastspine;
 	m_trackstarts.resize(0);
+	m_trackdatatypes.resize(0);
 	m_trackends.resize(0);
 	addToTrackStarts(NULL);
 
@@ -15160,7 +17220,10 @@ bool HumdrumFileBase::analyzeSpines(void) {
 				datatype[j] = m_lines[i]->getTokenString(j);
 				addToTrackStarts(m_lines[i]->token(j));
 				sinfo[j]    = to_string(j+1);
-				m_lines[i]->token(j)->setSpineInfo(sinfo[j]);
+			}
+			internSpineInfoList(sinfoid, sinfo);
+			for (j=0; j<m_lines[i]->getTokenCount(); j++) {
+				m_lines[i]->token(j)->setSpineInfoId(sinfoid[j]);
 				m_lines[i]->token(j)->setFieldIndex(j);
 				lastspine[j].push_back(m_lines[i]->token(j));
 			}
@@ -15178,13 +17241,14 @@ bool HumdrumFileBase::analyzeSpines(void) {
 			return setParseError(err);
 		}
 		for (j=0; j<m_lines[i]->getTokenCount(); j++) {
-			m_lines[i]->token(j)->setSpineInfo(sinfo[j]);
+			m_lines[i]->token(j)->setSpineInfoId(sinfoid[j]);
 			m_lines[i]->token(j)->setFieldIndex(j);
 		}
 		if (!m_lines[i]->isManipulator()) {
 			continue;
 		}
 		if (!adjustSpines(*m_lines[i], datatype, sinfo)) { return isValid(); }
+		internSpineInfoList(sinfoid, sinfo);
 	}
 	return isValid();
 }
@@ -15201,17 +17265,202 @@ bool HumdrumFileBase::analyzeSpines(void) {
 void HumdrumFileBase::addToTrackStarts(HTp token) {
 	if (token == NULL) {
 		m_trackstarts.push_back(NULL);
+		m_trackdatatypes.push_back(HumAddress::DATATYPE_NONE);
 		m_trackends.resize(m_trackends.size()+1);
 	} else if ((m_trackstarts.size() > 1) && (m_trackstarts.back() == NULL)) {
 		m_trackstarts.back() = token;
+		m_trackdatatypes.back() = internDataType(*token);
 	} else {
 		m_trackstarts.push_back(token);
+		m_trackdatatypes.push_back(internDataType(*token));
 		m_trackends.resize(m_trackends.size()+1);
 	}
 }
 
 
 
+//////////////////////////////
+//
+// HumdrumFileBase::internSpineInfo -- Return the index of a spine info
+//    string in the spine info table of the file, adding the string to
+//    the table if it is not already present.
+//
+
+int HumdrumFileBase::internSpineInfo(const string& spineinfo) {
+	auto it = m_spineinfoids.find(spineinfo);
+	if (it != m_spineinfoids.end()) {
+		return it->second;
+	}
+	int id = (int)m_spineinfos.size();
+	m_spineinfos.push_back(spineinfo);
+	m_spineinfotracks.push_back(HumAddress::getTrackFromSpineInfo(spineinfo));
+	m_spineinfoids[spineinfo] = id;
+	return id;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileBase::internSpineInfoList -- Intern a list of spine info
+//    strings (see internSpineInfo()).
+//
+
+void HumdrumFileBase::internSpineInfoList(vector<int>& ids,
+		vector<string>& sinfo) {
+	ids.resize(sinfo.size());
+	for (int i=0; i<(int)sinfo.size(); i++) {
+		ids[i] = internSpineInfo(sinfo[i]);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileBase::getSpineInfoString -- Return the spine info string for
+//    an index in the spine info table.
+//
+
+const string& HumdrumFileBase::getSpineInfoString(int id) const {
+	static const string empty;
+	if ((id < 0) || (id >= (int)m_spineinfos.size())) {
+		return empty;
+	}
+	return m_spineinfos[id];
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileBase::getSpineInfoTrack -- Return the track number of the
+//    spine info string for an index in the spine info table (the first
+//    number in the string).  Returns 0 for an invalid index.
+//
+
+int HumdrumFileBase::getSpineInfoTrack(int id) const {
+	if ((id < 0) || (id >= (int)m_spineinfotracks.size())) {
+		return 0;
+	}
+	return m_spineinfotracks[id];
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileBase::internDataType -- Return the ID of an exclusive
+//    interpretation string in the data type table of the file, adding the
+//    string to the table if it is not already present.
+//
+
+int HumdrumFileBase::internDataType(const string& datatype) {
+	if (m_datatypes.empty()) {
+		// Entries which are in the same order as HumAddress::DataTypeId:
+		m_datatypes.push_back("");
+		m_datatypes.push_back("**kern");
+		m_datatypes.push_back("**mens");
+		for (int i=0; i<(int)m_datatypes.size(); i++) {
+			m_datatypeids[m_datatypes[i]] = i;
+		}
+	}
+	auto it = m_datatypeids.find(datatype);
+	if (it != m_datatypeids.end()) {
+		return it->second;
+	}
+	int id = (int)m_datatypes.size();
+	m_datatypes.push_back(datatype);
+	m_datatypeids[datatype] = id;
+	return id;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileBase::getDataTypeId -- Return the ID of an exclusive
+//    interpretation in the file.  The leading "**" is optional.  Returns
+//    -1 if there is no spine with the data type in the file.  Use this
+//    function to look up a data type once before comparing it to the
+//    IDs of tokens with HumdrumToken::getDataTypeId().
+//
+
+int HumdrumFileBase::getDataTypeId(const string& datatype) const {
+	if (datatype.empty()) {
+		return HumAddress::DATATYPE_NONE;
+	}
+	string name;
+	if (datatype.compare(0, 2, "**") != 0) {
+		name = "**" + datatype;
+	}
+	const string& key = name.empty() ? datatype : name;
+	if (key == "**kern") {
+		return HumAddress::DATATYPE_KERN;
+	} else if (key == "**mens") {
+		return HumAddress::DATATYPE_MENS;
+	}
+	auto it = m_datatypeids.find(key);
+	if (it == m_datatypeids.end()) {
+		return -1;
+	}
+	return it->second;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileBase::getDataTypeString -- Return the exclusive interpretation
+//    string for a data type ID.
+//
+
+const string& HumdrumFileBase::getDataTypeString(int id) const {
+	static const string empty;
+	if ((id < 0) || (id >= (int)m_datatypes.size())) {
+		return empty;
+	}
+	return m_datatypes[id];
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileBase::getTrackDataTypeId -- Return the data type ID of the
+//    exclusive interpretation which starts the given track.  Returns
+//    HumAddress::DATATYPE_NONE for an invalid track.
+//
+
+int HumdrumFileBase::getTrackDataTypeId(int track) const {
+	if ((track <= 0) || (track >= (int)m_trackdatatypes.size())) {
+		return HumAddress::DATATYPE_NONE;
+	}
+	return m_trackdatatypes[track];
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileBase::updateTrackDataType -- Update the data type of a track
+//    after the text of its starting exclusive interpretation has been
+//    changed.  Nothing is done if the token does not start a track.
+//
+
+void HumdrumFileBase::updateTrackDataType(HTp token) {
+	int track = token->getTrack();
+	if ((track <= 0) || (track >= (int)m_trackstarts.size())) {
+		return;
+	}
+	if (m_trackstarts[track] != token) {
+		return;
+	}
+	m_trackdatatypes[track] = internDataType(*token);
+}
+
+
+
 //////////////////////////////
 //
 // HumdrumFileBase::adjustSpines -- adjust datatype and spineinfo values based
@@ -15800,10 +18049,9 @@ void HumdrumFileBase::fixMerges(int linei) {
 
 //////////////////////////////
 //
-// operator<< -- Default method of printing HumdrumFiles.  This printing method
-//    assumes that the HumdrumLine string is correct.  If a token is changed
-//    in the file, the HumdrumFileBase::createLinesFromTokens() before printing
-//    the contents of the line.
+// operator<< -- Default method of printing HumdrumFiles.  Lines which
+//    have tokens changed by HumdrumToken::setText() are regenerated from
+//    their tokens, and other lines are printed from their original text.
 //
 
 ostream& operator<<(ostream& out, HumdrumFileBase& infile) {
@@ -16364,6 +18612,249 @@ void HumdrumFileContent::resetDiatonicStatesWithKeySignature(vector<int>&
 
 
 
+//////////////////////////////
+//
+// HumdrumFileContent::addAnalysisColumn -- Add an empty analysis column
+//     (or a column filled with the given data) to the file.  The
+//     inserttrack parameter controls where the column will be placed when
+//     it is rendered as a spine: 0 = after the last spine, -1 = before the
+//     first spine, otherwise before the given track.  Data values which
+//     are equal to the null string when printed, or are empty strings,
+//     are stored as null values.
+//
+
+HumAnalysisColumn& HumdrumFileContent::addAnalysisColumn(const string& exinterp,
+		int type, int inserttrack) {
+	checkAnalysisColumns();
+	m_analysis.emplace_back(exinterp, type, getLineCount());
+	m_analysis.back().setInsertTrack(inserttrack);
+	return m_analysis.back();
+}
+
+
+HumAnalysisColumn& HumdrumFileContent::addAnalysisColumn(const vector<int>& data,
+		const string& null, const string& exinterp, int inserttrack) {
+	HumAnalysisColumn& column = addAnalysisColumn(exinterp,
+			HumAnalysisColumn::COLUMN_INT, inserttrack);
+	column.setData(data, null);
+	return column;
+}
+
+
+HumAnalysisColumn& HumdrumFileContent::addAnalysisColumn(const vector<double>& data,
+		const string& null, const string& exinterp, int inserttrack) {
+	HumAnalysisColumn& column = addAnalysisColumn(exinterp,
+			HumAnalysisColumn::COLUMN_DOUBLE, inserttrack);
+	column.setData(data, null);
+	return column;
+}
+
+
+HumAnalysisColumn& HumdrumFileContent::addAnalysisColumn(const vector<string>& data,
+		const string& null, const string& exinterp, int inserttrack) {
+	HumAnalysisColumn& column = addAnalysisColumn(exinterp,
+			HumAnalysisColumn::COLUMN_STRING, inserttrack);
+	column.setData(data, null);
+	return column;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::getAnalysisColumnCount -- Return the number of
+//     analysis columns stored in the file.
+//
+
+int HumdrumFileContent::getAnalysisColumnCount(void) const {
+	if (m_analysiscontent != m_contentcount) {
+		// columns of the previous contents of the file
+		return 0;
+	}
+	return (int)m_analysis.size();
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::getAnalysisColumn -- Return an analysis column by
+//     index or by name (either the column name or its exclusive
+//     interpretation).  Returns NULL if the column does not exist.
+//
+
+HumAnalysisColumn* HumdrumFileContent::getAnalysisColumn(int index) {
+	checkAnalysisColumns();
+	if ((index < 0) || (index >= (int)m_analysis.size())) {
+		return NULL;
+	}
+	return &m_analysis[index];
+}
+
+
+HumAnalysisColumn* HumdrumFileContent::getAnalysisColumn(const string& name) {
+	checkAnalysisColumns();
+	for (int i=0; i<(int)m_analysis.size(); i++) {
+		if ((m_analysis[i].getName() == name) ||
+				(m_analysis[i].getExInterp() == name)) {
+			return &m_analysis[i];
+		}
+	}
+	return NULL;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::clearAnalysisColumns -- Remove all analysis columns.
+//     Spines which were already rendered from the columns are not removed.
+//
+
+void HumdrumFileContent::clearAnalysisColumns(void) {
+	m_analysis.clear();
+	m_analysisrendered = 0;
+	m_analysiscontent = m_contentcount;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::checkAnalysisColumns -- Remove the analysis columns
+//     if the file has been cleared, read again or assigned from another
+//     file since the columns were added.  HumdrumFileBase::clear() and
+//     the assignment operator are not virtual, so they increment the
+//     content count of the file, which is checked here before the columns
+//     are used.
+//
+
+void HumdrumFileContent::checkAnalysisColumns(void) {
+	if (m_analysiscontent != m_contentcount) {
+		clearAnalysisColumns();
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::renderAnalysisColumns -- Add a spine to the file
+//     for each analysis column which has not already been rendered.
+//     The columns are rendered in the order that they were added.
+//     The line count of the file must not change between adding a
+//     column and rendering it.  Returns false if any column could not
+//     be rendered.
+//
+
+bool HumdrumFileContent::renderAnalysisColumns(void) {
+	checkAnalysisColumns();
+	bool status = true;
+	int linecount = getLineCount();
+	vector<string> text;
+	for (int i=m_analysisrendered; i<(int)m_analysis.size(); i++) {
+		HumAnalysisColumn& column = m_analysis[i];
+		if (column.getLineCount() != linecount) {
+			status = false;
+			continue;
+		}
+		text.resize(linecount);
+		for (int j=0; j<linecount; j++) {
+			if (m_lines[j]->isData()) {
+				text[j] = column.getText(j);
+			} else {
+				text[j].clear();
+			}
+		}
+		int track = column.getInsertTrack();
+		if (track == 0) {
+			status &= appendDataSpine(text, "", column.getExInterp());
+		} else if (track < 0) {
+			status &= prependDataSpine(text, "", column.getExInterp());
+		} else {
+			status &= insertDataSpineBefore(track, text, "", column.getExInterp());
+		}
+	}
+	m_analysisrendered = (int)m_analysis.size();
+	return status;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::printAnalysisCsv -- Print the analysis columns
+//     as CSV data.  The first row contains the column names, and there is
+//     one row for each data line in the file.  The first column is the
+//     line index in the file.  Null values are printed as empty cells.
+//
+
+ostream& HumdrumFileContent::printAnalysisCsv(ostream& out,
+		const string& separator) {
+	checkAnalysisColumns();
+	auto printCell = [&](const string& value) {
+		if ((value.find(separator) == string::npos) &&
+				(value.find('"') == string::npos)) {
+			out << value;
+			return;
+		}
+		out << '"';
+		for (int i=0; i<(int)value.size(); i++) {
+			if (value[i] == '"') {
+				out << '"';
+			}
+			out << value[i];
+		}
+		out << '"';
+	};
+
+	out << "line";
+	for (int i=0; i<(int)m_analysis.size(); i++) {
+		out << separator;
+		printCell(m_analysis[i].getName());
+	}
+	out << '\n';
+	for (int i=0; i<getLineCount(); i++) {
+		if (!m_lines[i]->isData()) {
+			continue;
+		}
+		out << i;
+		for (int j=0; j<(int)m_analysis.size(); j++) {
+			out << separator;
+			if (i < m_analysis[j].getLineCount()) {
+				printCell(m_analysis[j].getText(i));
+			}
+		}
+		out << '\n';
+	}
+	return out;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileContent::printAnalysisBinary -- Write the analysis columns
+//     in binary form: the characters "HUMACOL1", then the line count and
+//     column count of the file as 32-bit integers, followed by each
+//     column (see HumAnalysisColumn::writeBinary()).
+//
+
+ostream& HumdrumFileContent::printAnalysisBinary(ostream& out) {
+	checkAnalysisColumns();
+	out.write("HUMACOL1", 8);
+	int32_t value = getLineCount();
+	out.write((const char*)&value, sizeof(value));
+	value = (int32_t)m_analysis.size();
+	out.write((const char*)&value, sizeof(value));
+	for (int i=0; i<(int)m_analysis.size(); i++) {
+		m_analysis[i].writeBinary(out);
+	}
+	return out;
+}
+
+
+
 //////////////////////////////
 //
 // HumdrumFileStructure::getMetricLevels -- Each line in the output
@@ -18657,6 +21148,11 @@ int HumdrumFileSet::read(HumdrumFileStream& instream) {
 	return readAppend(instream);
 }
 
+int HumdrumFileSet::readParallel(HumdrumFileStream& instream, int threads) {
+	clear();
+	return readAppendParallel(instream, threads);
+}
+
 
 
 
@@ -18717,6 +21213,61 @@ int HumdrumFileSet::readAppendHumdrum(HumdrumFile& infile) {
 }
 
 
+
+//////////////////////////////
+//
+// HumdrumFileSet::readAppendParallel -- Add the files from the input
+//    stream to the end of the set, parsing several files at the same
+//    time.  The input stream is first split into the text of each file
+//    (which also adds the universal comments that apply to each file),
+//    and then the files are parsed on the given number of threads (0 =
+//    all cores).  The files are stored in their input order.  A file
+//    with a parse error is kept in the set, and its error message is
+//    printed after all files have been parsed (in the input order, so
+//    that messages for different files are not mixed together), and is
+//    available from HumdrumFile::getParseError().  Returns the total
+//    number of files in the set.
+//
+
+int HumdrumFileSet::readAppendParallel(HumdrumFileStream& instream,
+		int threads) {
+	vector<HumdrumFile*> files;
+	vector<string> contents;
+	stringstream buffer;
+	HumdrumFile* pfile = new HumdrumFile;
+	while (instream.getFileContents(buffer, *pfile)) {
+		files.push_back(pfile);
+		contents.push_back(buffer.str());
+		pfile = new HumdrumFile;
+	}
+	delete pfile;
+
+	HumParallel::run((int)files.size(), threads, [&](int i) {
+		HumdrumFile& infile = *files[i];
+		string filename = infile.getFilename();
+		stringstream input(contents[i]);
+		contents[i].clear();
+		infile.setQuietParsing();
+		// The files are already parsed in parallel, so do not also
+		// analyze the tracks of each file in parallel.
+		infile.setAnalysisThreadCount(1);
+		infile.readNoRhythm(input);
+		if (!filename.empty()) {
+			infile.setFilename(filename);
+		}
+	});
+
+	for (int i=0; i<(int)files.size(); i++) {
+		files[i]->setNoisyParsing();
+		files[i]->setAnalysisThreadCount(0);
+		files[i]->isValid();
+		m_data.push_back(files[i]);
+	}
+	return (int)m_data.size();
+}
+
+
+
 //////////////////////////////
 //
 // appendHumdrumPointer --  The infile will be deleted by the object
@@ -18882,6 +21433,10 @@ void HumdrumFileStream::clear(void) {
 	m_filelist.resize(0);
 	m_universals.resize(0);
 	m_newfilebuffer.resize(0);
+	m_input = NULL;
+	m_queue.clear();
+	m_queueindex = 0;
+	m_heldline.clear();
 	// m_stringbuffer.clear(0);
 	m_stringbuffer.str("");
 }
@@ -19020,300 +21575,307 @@ int HumdrumFileStream::eof(void) {
 //
 
 int HumdrumFileStream::getFile(HumdrumFile& infile) {
-	infile.clear();
-	istream* newinput = NULL;
+	stringstream contents;
+	if (!getFileContents(contents, infile)) {
+		return 0;
+	}
+	string filename = infile.getFilename();
+	infile.readNoRhythm(contents);
+	if (!filename.empty()) {
+		infile.setFilename(filename);
+	}
+	return 1;
+}
+
 
-restarting:
 
-	newinput = NULL;
+//////////////////////////////
+//
+// HumdrumFileStream::getFileContents -- Extract the text of the next
+//    file in the input stream (with the current universal comments
+//    converted into global comments) without parsing it, so that the
+//    text can be parsed later (such as in another thread).  The filename
+//    and segment level are stored in infile.  Returns false if there are
+//    no more files in the input stream.
+//
 
-	if (m_urlbuffer.eof()) {
-		// If the URL buffer is at its end, clear the buffer.
-		m_urlbuffer.str("");
+int HumdrumFileStream::getFileContents(stringstream& contents,
+		HumdrumFile& infile) {
+	infile.clear();
+	contents.str("");
+	contents.clear();
+	string line;
+	while (true) {
+		if (!startSegment()) {
+			return 0;
+		}
+		while (readSegmentLine(line)) {
+			contents << line << "\n";
+		}
+		m_input = NULL;
+		if (m_dataFoundQ) {
+			break;
+		}
+		// never found anything for some strange reason.
+		if (!m_addedFilenameQ) {
+			return 0;
+		}
+	}
+	if (!m_filename.empty()) {
+		infile.setFilename(m_filename);
 	}
+	infile.setSegmentLevel(m_segmentlevel);
+	return 1;
+}
 
-	// Read HumdrumFile contents from:
-	// (1) Read from string buffer
-	// (2) Current ifstream if open
-	// (3) Next filename if ifstream is done
-	// (4) cin if no ifstream open and no filenames
 
-	// (1) Is there content in the string buffer?
-	if (!m_stringbuffer.str().empty()) {
-		newinput = &m_stringbuffer;
-	}
 
-	// (2) Is an ifstream open?
-	else if (m_instream.is_open() && !m_instream.eof()) {
-		newinput = &m_instream;
-	}
+//////////////////////////////
+//
+// HumdrumFileStream::startSegment -- Choose the input for the next
+//    segment and reset the segment reading state.  Read HumdrumFile
+//    contents from:
+//    (1) the string buffer,
+//    (2) the current ifstream if it is open (or the URL data buffer),
+//    (3) the next filename if the ifstream is done,
+//    (4) cin if no ifstream is open and there are no filenames.
+//    Returns false if there is no more input.
+//
 
-	// (2b) Is the URL data buffer open?
-	else if (m_urlbuffer.str() != "") {
-		m_urlbuffer.clear();
-		newinput = &m_urlbuffer;
-	}
+bool HumdrumFileStream::startSegment(void) {
+	m_filename.clear();
+	m_segmentlevel = 0;
+	istream* newinput = NULL;
 
-	// (3) If ifstream is closed but there is a file to be processed,
-	// load it into the ifstream and start processing it immediately.
-	else if (((int)m_filelist.size() > 0) &&
-			(m_curfile < (int)m_filelist.size()-1)) {
-		m_curfile++;
-		if (m_instream.is_open()) {
-			m_instream.close();
-		}
-		if (strstr(m_filelist[m_curfile].c_str(), "://") != NULL) {
-			// The next file to read is a URL/URI, so buffer the
-			// data from the internet and start reading that instead
-			// of reading from a file on the hard disk.
-			fillUrlBuffer(m_urlbuffer, m_filelist[m_curfile].c_str());
-			infile.setFilename(m_filelist[m_curfile].c_str());
-			goto restarting;
-		}
-		m_instream.open(m_filelist[m_curfile].c_str());
-		infile.setFilename(m_filelist[m_curfile].c_str());
-		if (!m_instream.is_open()) {
-			// file does not exist or cannot be opened close
-			// the file and try luck with next file in the list
-			// (perhaps given an error or warning?).
-			infile.setFilename("");
-			m_instream.close();
-			goto restarting;
-		}
-		newinput = &m_instream;
-	} else {
-		// no input fstream open and no list of files to process, so
-		// start (or continue) reading from standard input.
-		if (m_curfile < 0) {
+	while (true) {
+		newinput = NULL;
+		if (m_urlbuffer.eof()) {
+			// If the URL buffer is at its end, clear the buffer.
+			m_urlbuffer.str("");
+		}
+
+		if (!m_stringbuffer.str().empty()) {
+			newinput = &m_stringbuffer;
+		} else if (m_instream.is_open() && !m_instream.eof()) {
+			newinput = &m_instream;
+		} else if (m_urlbuffer.str() != "") {
+			m_urlbuffer.clear();
+			newinput = &m_urlbuffer;
+		} else if (((int)m_filelist.size() > 0) &&
+				(m_curfile < (int)m_filelist.size()-1)) {
+			m_curfile++;
+			if (m_instream.is_open()) {
+				m_instream.close();
+			}
+			m_filename = m_filelist[m_curfile];
+			if (m_filename.find("://") != string::npos) {
+				// The next file to read is a URL/URI, so buffer the
+				// data from the internet and start reading that instead
+				// of reading from a file on the hard disk.
+				fillUrlBuffer(m_urlbuffer, m_filename);
+				continue;
+			}
+			m_instream.open(m_filename.c_str());
+			if (!m_instream.is_open()) {
+				// file does not exist or cannot be opened close
+				// the file and try luck with next file in the list
+				m_filename.clear();
+				m_instream.close();
+				continue;
+			}
+			newinput = &m_instream;
+		} else if (m_curfile < 0) {
 			// but only read from cin if no files have previously been read
 			newinput = &cin;
 		}
-	}
 
-	// At this point the newinput istream is set to read from the given
-	// file or from standard input, so start reading Humdrum content.
-	// If there is "m_newfilebuffer" content, then set the filename of the
-	// HumdrumFile to that value.
+		// If there is "m_newfilebuffer" content, then it is the
+		// !!!!SEGMENT record of this segment, or the exclusive
+		// interpretation line which ended the previous segment of
+		// the current file.
+		if (m_newfilebuffer.size() > 0) {
+			if (m_newfilebuffer.compare(0, 11, "!!!!SEGMENT") == 0) {
+				storeSegmentName(m_newfilebuffer);
+			} else if ((m_curfile >= 0) && (m_curfile < (int)m_filelist.size())) {
+				m_filename = m_filelist[m_curfile];
+			}
+		}
 
-	if (m_newfilebuffer.size() > 0) {
-		// store the filename for the current HumdrumFile being read:
-		HumRegex hre;
-		if (hre.search(m_newfilebuffer,
-				R"(^!!!!SEGMENT\s*([+-]?\d+)?\s*:\s*(.*)\s*$)")) {
-			if (hre.getMatchLength(1) > 0) {
-				infile.setSegmentLevel(atoi(hre.getMatch(1).c_str()));
-			} else {
-				infile.setSegmentLevel(0);
+		if (newinput == NULL) {
+			// something strange happened, or no more files to read.
+			return false;
+		}
+		if (newinput->eof()) {
+			if (m_curfile < (int)m_filelist.size()-1) {
+				m_curfile++;
+				continue;
 			}
-			infile.setFilename(hre.getMatch(2));
-		} else if ((m_curfile >=0) && (m_curfile < (int)m_filelist.size())
-				&& (m_filelist.size() > 0)) {
-			infile.setFilename(m_filelist[m_curfile].c_str());
-		} else {
-			// reading from standard input, but no name.
+			// input stream is closed and there are no more files to process.
+			return false;
 		}
+		break;
 	}
 
-	if (newinput == NULL) {
-		// something strange happened, or no more files to read.
-		return 0;
+	m_input           = newinput;
+	m_dataFoundQ      = false;
+	m_starstarFoundQ  = false;
+	m_starminusFoundQ = false;
+	m_universalQ      = false;
+	m_addedFilenameQ  = false;
+	m_heldline.clear();
+	m_queue.clear();
+	m_queueindex = 0;
+
+	// if the previous line from the last read starts with "**"
+	// then treat it as part of the current file.
+	if ((m_newfilebuffer.size() > 1) && (m_newfilebuffer.compare(0, 2, "**") == 0)) {
+		m_heldline = m_newfilebuffer;
+		m_newfilebuffer.clear();
+		m_starstarFoundQ = true;
 	}
+	return true;
+}
 
-	stringstream buffer;
-	int foundUniversalQ = 0;
 
-	// Start reading the input stream.  If !!!!SEGMENT: universal comment
-	// is found, then store that line in m_newfilebuffer and return the
-	// newly read HumdrumFile.  If other universal comments are found, then
-	// overwrite the old universal comments here.
 
-	int addedFilename = 0;
-	//int searchName = 0;
-	int dataFoundQ = 0;
-	int starstarFoundQ = 0;
-	int starminusFoundQ = 0;
-	if (m_newfilebuffer.size() < 4) {
-		//searchName = 1;
-	}
-	char templine[123123] = {0};
+//////////////////////////////
+//
+// HumdrumFileStream::readSegmentLine -- Read the next line of the
+//    segment started with startSegment().  Universal comments at the
+//    start of a segment are stored and returned (as global comments)
+//    before the first line of the segment.  Lines which are filenames
+//    are added to the list of input files.  Returns false at the end of
+//    the segment.
+//
 
-	if (newinput->eof()) {
-		if (m_curfile < (int)m_filelist.size()-1) {
-			m_curfile++;
-			goto restarting;
-		}
-		// input stream is close and there is no more files to process.
-		return 0;
+bool HumdrumFileStream::readSegmentLine(string& text) {
+	if (m_queueindex < (int)m_queue.size()) {
+		text = m_queue[m_queueindex++];
+		return true;
 	}
-
-	istream& input = *newinput;
-
-	// if the previous line from the last read starts with "**"
-	// then treat it as part of the current file.
-	if ((m_newfilebuffer.size() > 1) &&
-		 (strncmp(m_newfilebuffer.c_str(), "**", 2)) == 0) {
-		buffer << m_newfilebuffer << "\n";
-		m_newfilebuffer = "";
-		starstarFoundQ = 1;
+	if (m_input == NULL) {
+		return false;
 	}
-
+	istream& input = *m_input;
+	string line;
 	while (!input.eof()) {
-		input.getline(templine, 123123, '\n');
-		if ((!dataFoundQ) &&
-				(strncmp(templine, "!!!!SEGMENT", strlen("!!!!SEGMENT")) == 0)) {
-			string tempstring;
-			tempstring = templine;
-			HumRegex hre;
-			if (hre.search(tempstring,
-					"^!!!!SEGMENT\\s*([+-]?\\d+)?\\s*:\\s*(.*)\\s*$")) {
-				if (hre.getMatchLength(1) > 0) {
-					infile.setSegmentLevel(atoi(hre.getMatch(1).c_str()));
-				} else {
-					infile.setSegmentLevel(0);
-				}
-				infile.setFilename(hre.getMatch(2));
-			}
+		getline(input, line);
+		bool segmentQ = line.compare(0, 11, "!!!!SEGMENT") == 0;
+		if ((!m_dataFoundQ) && segmentQ) {
+			// !!!!SEGMENT: came before any real data was read, so
+			// it is the name of the current segment.
+			storeSegmentName(line);
 		}
 
-		if (strncmp(templine, "**", 2) == 0) {
-			if (starstarFoundQ == 1) {
-				m_newfilebuffer = templine;
+		if (line.compare(0, 2, "**") == 0) {
+			if (m_starstarFoundQ) {
 				// already found a **, so this one is defined as a file
-				// segment.  Exit from the loop and process the previous
-				// content, waiting until the next read for to start with
+				// segment.  Wait until the next segment to start with
 				// this line.
-				break;
+				m_newfilebuffer = line;
+				return false;
 			}
-			starstarFoundQ = 1;
+			m_starstarFoundQ = true;
 		}
 
-		if (input.eof() && (strcmp(templine, "") == 0)) {
-			// No more data coming from current stream, so this is
-			// the end of the HumdrumFile.  Break from the while loop
-			// and then store the read contents of the stream in the
-			// HumdrumFile.
-			break;
+		if (input.eof() && line.empty()) {
+			// No more data coming from current stream.
+			return false;
 		}
-		// (1) Does the line start with "!!!!SEGMENT"?  If so, then
-		// this is either the name of the current or next file to process.
-		// (1a) this is the name of the current file to process if no
-		// data has yet been found,
-		// (1b) or a name is being actively searched for.
-		if (strncmp(templine, "!!!!SEGMENT", strlen("!!!!SEGMENT")) == 0) {
-			m_newfilebuffer = templine;
-			if (dataFoundQ) {
-				// this new filename is for the next chunk to process in the
-				// current file stream, not this one, so stop reading the
-				// HumdrumFile content and send what has already been read back
-				// out with new contents.
-			}  else {
-				// !!!!SEGMENT: came before any real data was read, so
-				// it is most likely the name of the current file
-				// (i.e., it comes at the start of the file stream and
-				// is the name of the first HumdrumFile in the stream).
-				HumRegex hre;
-				if (hre.search(m_newfilebuffer,
-						R"(^!!!!SEGMENT\s*([+-]?\d+)?\s:\s*(.*)\s*$)")) {
-					if (hre.getMatchLength(1) > 0) {
-						infile.setSegmentLevel(atoi(hre.getMatch(1).c_str()));
-					} else {
-						infile.setSegmentLevel(0);
-					}
-					infile.setFilename(hre.getMatch(2));
-				}
-			}
-		}
-		int len = (int)strlen(templine);
-		if ((len > 4) && (strncmp(templine, "!!!!", 4) == 0) &&
-				(templine[4] != '!') && 
-				(dataFoundQ == 0) && 
-				(strncmp(templine, "!!!!filter:", strlen("!!!!filter:")) != 0) &&
-				(strncmp(templine, "!!!!SEGMENT:", strlen("!!!!SEGMENT:")) != 0)) {
-			// This is a universal comment.  Should it be appended
-			// to the list or should the current list be erased and
-			// this record placed into the first entry?
-			if (foundUniversalQ) {
-				// already found a previous universal, so append.
-				m_universals.push_back(templine);
-			} else {
-				// new universal comment, to delete all previous
-				// universal comments and store this one.
-				m_universals.reserve(1000);
-				m_universals.resize(1);
-				m_universals[0] = templine;
-				foundUniversalQ = 1;
+
+		if (segmentQ) {
+			m_newfilebuffer = line;
+		}
+
+		if ((line.size() > 4) && (line.compare(0, 4, "!!!!") == 0) &&
+				(line[4] != '!') && !m_dataFoundQ &&
+				(line.compare(0, 11, "!!!!filter:") != 0) &&
+				(line.compare(0, 12, "!!!!SEGMENT:") != 0)) {
+			// Universal comment: replaces the universal comments from
+			// previous segments.
+			if (!m_universalQ) {
+				m_universals.clear();
+				m_universalQ = true;
 			}
+			m_universals.push_back(line);
 			continue;
 		}
 
-		if (strncmp(templine, "*-", 2) == 0) {
-			starminusFoundQ = 1;
+		if (line.compare(0, 2, "*-") == 0) {
+			m_starminusFoundQ = true;
 		}
 
 		// if before first ** in a data file or after *-, and the line
 		// does not start with '!' or '*', then assume that it is a file
-		// name which should be added to the file list to read.
-		if (((starminusFoundQ == 1) || (starstarFoundQ == 0))
-				&& (templine[0] != '*') && (templine[0] != '!')) {
-			if ((templine[0] != '\0') && (templine[0] != ' ')) {
-				// The file can only be added once in this manner
-				// so that infinite loops are prevented.
-				int found = 0;
-				for (int mm=0; mm<(int)m_filelist.size(); mm++) {
-					if (strcmp(m_filelist[mm].c_str(), templine) == 0) {
-						found = 1;
-					}
-				}
-				if (!found) {
-					m_filelist.push_back(templine);
-					addedFilename = 1;
+		// name which should be added to the file list to read.  The file
+		// can only be added once in this manner so that infinite loops
+		// are prevented.
+		if ((m_starminusFoundQ || !m_starstarFoundQ) && !line.empty() &&
+				(line[0] != '*') && (line[0] != '!') && (line[0] != ' ')) {
+			bool found = false;
+			for (int i=0; i<(int)m_filelist.size(); i++) {
+				if (m_filelist[i] == line) {
+					found = true;
+					break;
 				}
-				continue;
 			}
+			if (!found) {
+				m_filelist.push_back(line);
+				m_addedFilenameQ = true;
+			}
+			continue;
 		}
 
-		dataFoundQ = 1; // found something other than universal comments
-		// should empty lines be treated somewhat as universal comments?
-
-		// store the data line for later parsing into HumdrumFile record:
-		buffer << templine << "\n";
-	}
+		if (m_dataFoundQ) {
+			text = line;
+			return true;
+		}
 
-	if (dataFoundQ == 0) {
-		// never found anything for some strange reason.
-		if (addedFilename) {
-			goto restarting;
+		// First line of the segment: return the universal comments
+		// (demoted into global comments, except for !!!!filter:) and the
+		// held exclusive interpretation line first.
+		m_dataFoundQ = true;
+		m_queue.clear();
+		m_queueindex = 0;
+		for (int i=0; i<(int)m_universals.size(); i++) {
+			if (m_universals[i].compare(0, 11, "!!!!filter:") == 0) {
+				continue;
+			}
+			m_queue.push_back(m_universals[i].substr(1));
 		}
-		return 0;
+		if (!m_heldline.empty()) {
+			m_queue.push_back(m_heldline);
+			m_heldline.clear();
+		}
+		m_queue.push_back(line);
+		text = m_queue[m_queueindex++];
+		return true;
 	}
+	return false;
+}
 
-	// Arriving here means that reading of the data stream is complete.
-	// The string stream variable "buffer" contains the HumdrumFile
-	// content, so send it to the HumdrumFile variable.  Also, prepend
-	// Universal comments (demoted into Global comments) at the start
-	// of the data stream (maybe allow for postpending Universal comments
-	// in the future).
-	stringstream contents;
-	contents.str(""); // empty any contents in buffer
-	contents.clear(); // reset error flags in buffer
 
-	for (int i=0; i<(int)m_universals.size(); i++) {
-		// Convert universals reference records to globals, but do not demote !!!!filter:
-		if (m_universals[i].compare(0, 11, "!!!!filter:") == 0) {
-			continue;
+
+//////////////////////////////
+//
+// HumdrumFileStream::storeSegmentName -- Store the filename and level
+//    of a !!!!SEGMENT record for the current segment.
+//
+
+void HumdrumFileStream::storeSegmentName(const string& line) {
+	HumRegex hre;
+	if (hre.search(line, R"(^!!!!SEGMENT\s*([+-]?\d+)?\s*:\s*(.*)\s*$)")) {
+		if (hre.getMatchLength(1) > 0) {
+			m_segmentlevel = hre.getMatchInt(1);
+		} else {
+			m_segmentlevel = 0;
 		}
-		contents << &(m_universals[i][1]) << "\n";
+		m_filename = hre.getMatch(2);
 	}
-	contents << buffer.str();
-	string filename = infile.getFilename();
-	infile.readNoRhythm(contents);
-	if (!filename.empty()) {
-		infile.setFilename(filename);
-	}
-	return 1;
 }
 
 
+
 //////////////////////////////
 //
 // HumdrumFileStream::fillUrlBuffer --
@@ -19333,6 +21895,365 @@ void HumdrumFileStream::fillUrlBuffer(stringstream& uribuffer,
 
 
 
+//////////////////////////////
+//
+// HumdrumFileStructure::analyzeTimeline -- Create the tick-based timeline
+//     index for the file.  This is done automatically at the end of
+//     rhythm analysis, but can be called explicitly if the data has
+//     been altered.  The timeline query functions do not build the index
+//     themselves, so they return empty results for a file that has not
+//     been rhythm-analyzed.  Returns false if the rhythm of the file has
+//     not been analyzed.
+//
+
+bool HumdrumFileStructure::analyzeTimeline(void) {
+	m_timeline_analyzed = false;
+	m_lineticks.clear();
+	m_tldatalines.clear();
+	m_tldataticks.clear();
+	m_tlattacks.clear();
+	m_tlattackticks.clear();
+	m_tlbarticks.clear();
+	if (!isRhythmAnalyzed()) {
+		return false;
+	}
+
+	int lcount = getLineCount();
+	m_lineticks.resize(lcount);
+	for (int i=0; i<lcount; i++) {
+		m_lineticks[i] = durationToTicks(m_lines[i]->getDurationFromStart());
+	}
+
+	m_tldatalines.reserve(lcount);
+	m_tldataticks.reserve(lcount);
+	for (int i=0; i<lcount; i++) {
+		if (!m_lines[i]->isData()) {
+			continue;
+		}
+		if (m_lines[i]->getDuration().isPositive()) {
+			m_tldatalines.push_back(i);
+			m_tldataticks.push_back(m_lineticks[i]);
+		}
+		for (int j=0; j<m_lines[i]->getFieldCount(); j++) {
+			HTp token = m_lines[i]->token(j);
+			if (token->isNull()) {
+				continue;
+			}
+			if (!(token->isKern() || token->isMens())) {
+				continue;
+			}
+			if (!token->isNoteAttack()) {
+				continue;
+			}
+			m_tlattacks.push_back(token);
+			m_tlattackticks.push_back(m_lineticks[i]);
+		}
+	}
+
+	// Lines with negative start times (before fillInNegativeStartTimes)
+	// or zero-duration lines may be out of order, so make sure the search
+	// arrays are sorted by time.  A stable sort keeps the line/field order
+	// of simultaneous events.
+	if (!std::is_sorted(m_tldataticks.begin(), m_tldataticks.end())) {
+		vector<int> order(m_tldatalines.size());
+		for (int i=0; i<(int)order.size(); i++) {
+			order[i] = i;
+		}
+		std::stable_sort(order.begin(), order.end(),
+			[&](int a, int b) { return m_tldataticks[a] < m_tldataticks[b]; });
+		vector<int> lines(order.size());
+		vector<int> ticks(order.size());
+		for (int i=0; i<(int)order.size(); i++) {
+			lines[i] = m_tldatalines[order[i]];
+			ticks[i] = m_tldataticks[order[i]];
+		}
+		m_tldatalines.swap(lines);
+		m_tldataticks.swap(ticks);
+	}
+	if (!std::is_sorted(m_tlattackticks.begin(), m_tlattackticks.end())) {
+		vector<int> order(m_tlattacks.size());
+		for (int i=0; i<(int)order.size(); i++) {
+			order[i] = i;
+		}
+		std::stable_sort(order.begin(), order.end(),
+			[&](int a, int b) { return m_tlattackticks[a] < m_tlattackticks[b]; });
+		vector<HTp> attacks(order.size());
+		vector<int> ticks(order.size());
+		for (int i=0; i<(int)order.size(); i++) {
+			attacks[i] = m_tlattacks[order[i]];
+			ticks[i] = m_tlattackticks[order[i]];
+		}
+		m_tlattacks.swap(attacks);
+		m_tlattackticks.swap(ticks);
+	}
+
+	m_tlbarticks.resize(m_barlines.size());
+	for (int i=0; i<(int)m_barlines.size(); i++) {
+		m_tlbarticks[i] = m_lineticks[m_barlines[i]->getLineIndex()];
+	}
+
+	m_timeline_analyzed = true;
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileStructure::durationToTicks -- Convert a duration in quarter
+//     notes into ticks.  Durations which do not fall on a tick are
+//     rounded down.
+//
+
+int HumdrumFileStructure::durationToTicks(HumNum duration) {
+	HumNum value = duration * tpq();
+	int top = value.getNumerator();
+	int bot = value.getDenominator();
+	if (bot == 1) {
+		return top;
+	}
+	int output = top / bot;
+	if ((top < 0) && (top % bot != 0)) {
+		output--;
+	}
+	return output;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileStructure::timeToTick -- Convert a time in quarter notes
+//     from the start of the score into ticks.  Times between ticks are
+//     rounded down to the previous tick.
+//
+
+int HumdrumFileStructure::timeToTick(HumNum time) {
+	return durationToTicks(time);
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileStructure::tickToTime -- Convert a tick position into
+//     quarter notes from the start of the score.
+//
+
+HumNum HumdrumFileStructure::tickToTime(int tick) {
+	return HumNum(tick, tpq());
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileStructure::getLineTick -- Return the starting time of the
+//     line in ticks.  Returns -1 if the line index is invalid or the
+//     rhythm of the file has not been analyzed.
+//
+
+int HumdrumFileStructure::getLineTick(int lineindex) {
+	if (!m_timeline_analyzed) {
+		return -1;
+	}
+	if ((lineindex < 0) || (lineindex >= (int)m_lineticks.size())) {
+		return -1;
+	}
+	return m_lineticks[lineindex];
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileStructure::getScoreTickDuration -- Return the duration of
+//     the score in ticks.
+//
+
+int HumdrumFileStructure::getScoreTickDuration(void) {
+	if (!m_timeline_analyzed || m_lineticks.empty()) {
+		return 0;
+	}
+	return m_lineticks.back();
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileStructure::getDataLineAtTick -- Return the line index of
+//     the data line which is active at the given time: the last data line
+//     with a positive duration that starts at or before the tick.  Returns
+//     -1 if the time is before the first data line or after the end of
+//     the score.
+//
+
+int HumdrumFileStructure::getDataLineAtTick(int tick) {
+	if (!m_timeline_analyzed || m_tldataticks.empty()) {
+		return -1;
+	}
+	if (tick >= getScoreTickDuration()) {
+		return -1;
+	}
+	auto it = std::upper_bound(m_tldataticks.begin(), m_tldataticks.end(), tick);
+	if (it == m_tldataticks.begin()) {
+		return -1;
+	}
+	return m_tldatalines[(it - m_tldataticks.begin()) - 1];
+}
+
+
+int HumdrumFileStructure::getDataLineAtTime(HumNum time) {
+	return getDataLineAtTick(timeToTick(time));
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileStructure::getBarlineTick -- Return the tick position of the
+//     given barline (see getBarline()).  Negative indexes access from the
+//     end of the list.  Returns -1 for an invalid index.
+//
+
+int HumdrumFileStructure::getBarlineTick(int index) {
+	if (!m_timeline_analyzed) {
+		return -1;
+	}
+	if (index < 0) {
+		index += (int)m_tlbarticks.size();
+	}
+	if ((index < 0) || (index >= (int)m_tlbarticks.size())) {
+		return -1;
+	}
+	return m_tlbarticks[index];
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileStructure::getBarlineIndexAtTick -- Return the index of the
+//     barline which starts the measure containing the given time (see
+//     getBarline()).  Returns -1 if there are no barlines or the time is
+//     before the first barline.
+//
+
+int HumdrumFileStructure::getBarlineIndexAtTick(int tick) {
+	if (!m_timeline_analyzed) {
+		return -1;
+	}
+	auto it = std::upper_bound(m_tlbarticks.begin(), m_tlbarticks.end(), tick);
+	if (it == m_tlbarticks.begin()) {
+		return -1;
+	}
+	// If several barlines occur at the same time, the last one is returned.
+	return (int)(it - m_tlbarticks.begin()) - 1;
+}
+
+
+int HumdrumFileStructure::getBarlineIndexAtTime(HumNum time) {
+	return getBarlineIndexAtTick(timeToTick(time));
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileStructure::getAttacksInTickRange -- Return a list of the note
+//     attacks in **kern and **mens spines which start in the time range
+//     [starttick, endtick).  The notes are sorted by start time and then
+//     by line and field order.  Grace notes are included at the time of
+//     the note that they precede.
+//
+
+void HumdrumFileStructure::getAttacksInTickRange(vector<HTp>& attacks,
+		int starttick, int endtick) {
+	attacks.clear();
+	if (!m_timeline_analyzed || (endtick <= starttick)) {
+		return;
+	}
+	auto first = std::lower_bound(m_tlattackticks.begin(),
+			m_tlattackticks.end(), starttick);
+	auto last = std::lower_bound(first, m_tlattackticks.end(), endtick);
+	int i1 = (int)(first - m_tlattackticks.begin());
+	int i2 = (int)(last - m_tlattackticks.begin());
+	attacks.insert(attacks.end(), m_tlattacks.begin() + i1,
+			m_tlattacks.begin() + i2);
+}
+
+
+void HumdrumFileStructure::getAttacksInRange(vector<HTp>& attacks,
+		HumNum starttime, HumNum endtime) {
+	// Convert times into the first tick at or after each time, so that
+	// attacks at non-tick times are not included incorrectly.
+	int starttick = timeToTick(starttime);
+	if (tickToTime(starttick) < starttime) {
+		starttick++;
+	}
+	int endtick = timeToTick(endtime);
+	if (tickToTime(endtick) < endtime) {
+		endtick++;
+	}
+	getAttacksInTickRange(attacks, starttick, endtick);
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileStructure::getSoundingNotesAtTick -- Return a list of the
+//     **kern and **mens notes which are sounding at the given time, one
+//     for each voice (track/subtrack) which is not resting.  Notes
+//     which were attacked before the given time are included (the
+//     token containing the note is returned, which may be the
+//     secondary note of a tie).  If track is non-zero, then only notes
+//     from that track are returned.
+//
+
+void HumdrumFileStructure::getSoundingNotesAtTick(vector<HTp>& notes,
+		int tick, int track) {
+	notes.clear();
+	int line = getDataLineAtTick(tick);
+	if (line < 0) {
+		return;
+	}
+	HumdrumLine& hline = *m_lines[line];
+	for (int j=0; j<hline.getFieldCount(); j++) {
+		HTp token = hline.token(j);
+		if ((track > 0) && (token->getTrack() != track)) {
+			continue;
+		}
+		if (!(token->isKern() || token->isMens())) {
+			continue;
+		}
+		HTp note = token;
+		if (note->isNull()) {
+			note = note->resolveNull();
+			if ((note == NULL) || note->isNull()) {
+				continue;
+			}
+		}
+		if (note->isRest()) {
+			continue;
+		}
+		int starttick = m_lineticks[note->getLineIndex()];
+		int endtick = starttick + durationToTicks(note->getDuration());
+		if ((starttick <= tick) && (tick < endtick)) {
+			notes.push_back(note);
+		}
+	}
+}
+
+
+void HumdrumFileStructure::getSoundingNotes(vector<HTp>& notes,
+		HumNum time, int track) {
+	getSoundingNotesAtTick(notes, timeToTick(time), track);
+}
+
+
+
 //////////////////////////////
 //
 // HumdrumFileStructure::HumdrumFileStructure -- HumdrumFileStructure
@@ -19509,6 +22430,7 @@ bool HumdrumFileStructure::analyzeStructure(void) {
 	}
 	if (!analyzeGlobalParameters() ) { return isValid(); }
 	if (!analyzeLocalParameters()  ) { return isValid(); }
+	indexLayoutParameters();
 	if (!analyzeTokenDurations()   ) { return isValid(); }
 	if (!analyzeTokenDurations()   ) { return isValid(); }
 	m_structure_analyzed = true;
@@ -19532,6 +22454,7 @@ bool HumdrumFileStructure::analyzeStructureNoRhythm(void) {
 	}
 	if (!analyzeGlobalParameters() ) { return isValid(); }
 	if (!analyzeLocalParameters()  ) { return isValid(); }
+	indexLayoutParameters();
 	if (!analyzeTokenDurations()   ) { return isValid(); }
 	analyzeSignifiers();
 	return isValid();
@@ -19546,6 +22469,7 @@ bool HumdrumFileStructure::analyzeStructureNoRhythm(void) {
 
 bool HumdrumFileStructure::analyzeRhythmStructure(void) {
 	m_rhythm_analyzed = true;
+	m_timeline_analyzed = false;
 	setLineRhythmAnalyzed();
 	if (!isStructureAnalyzed()) {
 		if (!analyzeStructureNoRhythm()) { return isValid(); }
@@ -19558,6 +22482,10 @@ bool HumdrumFileStructure::analyzeRhythmStructure(void) {
 		if (!analyzeRhythm()           ) { return isValid(); }
 		if (!analyzeDurationsOfNonRhythmicSpines()) { return isValid(); }
 	}
+	// Build the timeline index here rather than on the first query so
+	// that the timeline accessors only read data and can be called from
+	// several threads at once.
+	analyzeTimeline();
 	return isValid();
 }
 
@@ -19903,6 +22831,77 @@ void HumdrumFileStructure::setLineRhythmAnalyzed(void) {
 }
 
 
+
+//////////////////////////////
+//
+// HumdrumFileStructure::setAnalysisThreadCount -- Set the number of
+//     threads used to analyze independent tracks and strands when
+//     parsing the file.  A value of 1 disables parallel analysis (useful
+//     when files are already being parsed on separate threads).  The
+//     default value of 0 will use all hardware threads, but only for
+//     files which are large enough to benefit.
+//
+
+void HumdrumFileStructure::setAnalysisThreadCount(int count) {
+	m_analysisThreads = count < 0 ? 0 : count;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileStructure::getAnalysisThreadCount -- Return the number
+//     of threads to use for the given number of independent analysis jobs.
+//     For automatic thread counts, small files are analyzed serially since
+//     starting threads would take longer than the analysis.
+//
+
+int HumdrumFileStructure::getAnalysisThreadCount(void) {
+	return m_analysisThreads;
+}
+
+
+int HumdrumFileStructure::getAnalysisThreadCount(int jobcount) {
+	if (jobcount < 2) {
+		return 1;
+	}
+	if (m_analysisThreads > 0) {
+		return m_analysisThreads;
+	}
+	if ((long)getLineCount() * jobcount < 50000) {
+		return 1;
+	}
+	return HumParallel::getThreadCount(0);
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileStructure::hasCrossTrackLinks -- Returns true if any token
+//     links to a token in a different track (such as when spines of
+//     different tracks are merged).
+//
+
+bool HumdrumFileStructure::hasCrossTrackLinks(void) {
+	for (int i=0; i<getLineCount(); i++) {
+		if (!m_lines[i]->isManipulator()) {
+			continue;
+		}
+		for (int j=0; j<m_lines[i]->getTokenCount(); j++) {
+			HTp token = m_lines[i]->token(j);
+			for (int k=0; k<token->getNextTokenCount(); k++) {
+				if (token->getNextToken(k)->getTrack() != token->getTrack()) {
+					return true;
+				}
+			}
+		}
+	}
+	return false;
+}
+
+
+
 //////////////////////////////
 //
 // HumdrumFileStructure::analyzeRhythm -- Analyze the rhythmic structure
@@ -19916,9 +22915,9 @@ bool HumdrumFileStructure::analyzeRhythm(void) {
 	}
 	int startline = getTrackStart(1)->getLineIndex();
 	int testline;
-	HumNum zero(0);
 
 	int i;
+	vector<HTp> starts;
 	for (int i=1; i<=getMaxTrack(); i++) {
 		if (!getTrackStart(i)->hasRhythm()) {
 			// Can't analyze rhythm of spines that do not have rhythm.
@@ -19926,9 +22925,7 @@ bool HumdrumFileStructure::analyzeRhythm(void) {
 		}
 		testline = getTrackStart(i)->getLineIndex();
 		if (testline == startline) {
-			if (!assignDurationsToTrack(getTrackStart(i), zero)) {
-				return false;
-			}
+			starts.push_back(getTrackStart(i));
 		} else {
 			// Spine does not start at beginning of data, so
 			// the starting position of the spine has to be
@@ -19938,6 +22935,9 @@ bool HumdrumFileStructure::analyzeRhythm(void) {
 			continue;
 		}
 	}
+	if (!assignDurationsToTracks(starts)) {
+		return false;
+	}
 
 	// Go back and analyze spines that do not start at the
 	// beginning of the data stream.
@@ -20089,11 +23089,13 @@ bool HumdrumFileStructure::analyzeGlobalParameters(void) {
 //
 
 bool HumdrumFileStructure::analyzeLocalParameters(void) {
-	// analyze backward tokens:
+	// analyze backward tokens (strands do not share tokens, so they
+	// can be processed at the same time):
 
-	for (int i=0; i<getStrandCount(); i++) {
+	int count = getStrandCount();
+	HumParallel::run(count, getAnalysisThreadCount(count), [&](int i) {
 		processLocalParametersForStrand(i);
-	}
+	});
 
 //	for (int i=1; i<=getMaxTrack(); i++) {
 //		for (int j=0; j<getTrackEndCount(i); j++) {
@@ -20109,6 +23111,39 @@ bool HumdrumFileStructure::analyzeLocalParameters(void) {
 
 
 
+//////////////////////////////
+//
+// HumdrumFileStructure::indexLayoutParameters -- Resolve the linked
+//     layout parameters of each token into an index (see HumLayoutIndex),
+//     so that HumdrumToken::getLayoutParameter() and related functions
+//     do not need to search the parameters for each query.  This is done
+//     when the structure is analyzed; call it again after changing the
+//     text of layout parameters to rebuild the indexes.
+//
+
+void HumdrumFileStructure::indexLayoutParameters(void) {
+	m_layoutVersion++;
+	for (int i=0; i<getLineCount(); i++) {
+		for (int j=0; j<m_lines[i]->getFieldCount(); j++) {
+			m_lines[i]->token(j)->getLayoutIndex();
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumFileStructure::getLayoutParameterVersion -- Returns the number
+//     of times that the layout parameters have been indexed.
+//
+
+int HumdrumFileStructure::getLayoutParameterVersion(void) const {
+	return m_layoutVersion;
+}
+
+
+
 //////////////////////////////
 //
 // HumdrumFileStructure::analyzeDurationsOfNonRhythmicSpines -- Calculate the
@@ -20275,15 +23310,57 @@ bool HumdrumFileStructure::assignDurationsToTrack(HTp starttoken,
 
 
 
+//////////////////////////////
+//
+// HumdrumFileStructure::assignDurationsToTracks -- Assign durations from
+//    start for a list of tracks which start at the beginning of the data.
+//    For large files, the tracks are analyzed at the same time, with the
+//    line durationFromStart values for each track stored in a separate list.
+//    These lists are then applied to the lines in track order, so the
+//    results (and any rhythm error message) are the same as when analyzing
+//    one track at a time.  Files with spines that merge across tracks are
+//    always analyzed serially since such tracks share tokens.
+//
+
+bool HumdrumFileStructure::assignDurationsToTracks(vector<HTp>& starts) {
+	HumNum zero(0);
+	int threads = getAnalysisThreadCount((int)starts.size());
+	if ((threads <= 1) || hasCrossTrackLinks()) {
+		for (int i=0; i<(int)starts.size(); i++) {
+			if (!assignDurationsToTrack(starts[i], zero)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	vector<vector<pair<HTp, HumNum>>> linedurs(starts.size());
+	HumParallel::run((int)starts.size(), threads, [&](int i) {
+		prepareDurations(starts[i], starts[i]->getState(), zero, &linedurs[i]);
+	});
+	for (int i=0; i<(int)linedurs.size(); i++) {
+		for (int j=0; j<(int)linedurs[i].size(); j++) {
+			if (!setLineDurationFromStart(linedurs[i][j].first, linedurs[i][j].second)) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+
+
 //////////////////////////////
 //
 // HumdrumFileStructure::prepareDurations -- Helper function for
 //     HumdrumFileStructure::assignDurationsToTrack() which does all of the
-//     work for assigning durationFromStart values.
+//     work for assigning durationFromStart values.  If linedurs is not
+//     NULL, then the line durations are stored in it rather than being
+//     assigned to the lines (see assignDurationsToTracks()).
 //
 
 bool HumdrumFileStructure::prepareDurations(HTp token, int state,
-		HumNum startdur) {
+		HumNum startdur, vector<pair<HTp, HumNum>>* linedurs) {
 	if (state != token->getState()) {
 		return isValid();
 	}
@@ -20291,7 +23368,7 @@ bool HumdrumFileStructure::prepareDurations(HTp token, int state,
 	HumNum dursum = startdur;
 	token->incrementState();
 
-	if (!setLineDurationFromStart(token, dursum)) { return isValid(); }
+	if (!setLineDurationFromStart(token, dursum, linedurs)) { return isValid(); }
 	if (token->getDuration().isPositive()) {
 		dursum += token->getDuration();
 	}
@@ -20311,7 +23388,7 @@ bool HumdrumFileStructure::prepareDurations(HTp token, int state,
 			break;
 		}
 		token->incrementState();
-		if (!setLineDurationFromStart(token, dursum)) { return isValid(); }
+		if (!setLineDurationFromStart(token, dursum, linedurs)) { return isValid(); }
 		if (token->getDuration().isPositive()) {
 			dursum += token->getDuration();
 		}
@@ -20319,14 +23396,14 @@ bool HumdrumFileStructure::prepareDurations(HTp token, int state,
 	}
 
 	if ((tcount == 0) && (token->isTerminateInterpretation())) {
-		if (!setLineDurationFromStart(token, dursum)) { return isValid(); }
+		if (!setLineDurationFromStart(token, dursum, linedurs)) { return isValid(); }
 	}
 
 	// Process secondary tracks next:
 	int newstate = state;
 
 	for (int i=(int)reservoir.size()-1; i>=0; i--) {
-		prepareDurations(reservoir[i], newstate, startdurs[i]);
+		prepareDurations(reservoir[i], newstate, startdurs[i], linedurs);
 	}
 
 	return isValid();
@@ -20337,11 +23414,17 @@ bool HumdrumFileStructure::prepareDurations(HTp token, int state,
 //////////////////////////////
 //
 // HumdrumFileStructure::setLineDurationFromStart -- Set the duration of
-//      a line based on the analysis of tokens in the spine.
+//      a line based on the analysis of tokens in the spine.  If linedurs
+//      is not NULL, then store the token and duration in it for later
+//      processing instead.
 //
 
 bool HumdrumFileStructure::setLineDurationFromStart(HTp token,
-		HumNum dursum) {
+		HumNum dursum, vector<pair<HTp, HumNum>>* linedurs) {
+	if (linedurs) {
+		linedurs->emplace_back(token, dursum);
+		return true;
+	}
 	if ((!token->isTerminateInterpretation()) &&
 			token->getDuration().isNegative()) {
 		// undefined rhythm, so don't assign line duration information:
@@ -20716,16 +23799,15 @@ bool HumdrumFileStructure::analyzeStrands(void) {
 	int spines = getSpineCount();
 	m_strand1d.resize(0);
 	m_strand2d.resize(0);
+	m_strand2d.resize(spines);
 	int i, j;
-	for (i=0; i<spines; i++) {
-		HTp tok = getSpineStart(i);
-		m_strand2d.resize(m_strand2d.size()+1);
-		analyzeSpineStrands(m_strand2d.back(), tok);
-	}
-
-	for (i=0; i<(int)m_strand2d.size(); i++) {
+	HumParallel::run(spines, getAnalysisThreadCount(spines), [&](int i) {
+		analyzeSpineStrands(m_strand2d[i], getSpineStart(i));
 		std::sort(m_strand2d[i].begin(), m_strand2d[i].end(),
 				sortTokenPairsByLineIndex);
+	});
+
+	for (i=0; i<(int)m_strand2d.size(); i++) {
 		for (j=0; j<(int)m_strand2d[i].size(); j++) {
 			m_strand1d.push_back(m_strand2d[i][j]);
 		}
@@ -21073,6 +24155,8 @@ HumdrumLine::HumdrumLine(HumdrumLine& line)  : string((string)line) {
 	for (int i=0; i<(int)m_tabs.size(); i++) {
 		m_tabs.at(i) = line.m_tabs.at(i);
 	}
+	m_textdirty = line.m_textdirty;
+	m_class = line.m_class;
 	m_owner = NULL;
 }
 
@@ -21091,6 +24175,8 @@ HumdrumLine::HumdrumLine(HumdrumLine& line, void* owner) : string((string)line)
 	for (int i=0; i<(int)m_tabs.size(); i++) {
 		m_tabs.at(i) = line.m_tabs.at(i);
 	}
+	m_textdirty = line.m_textdirty;
+	m_class = line.m_class;
 	m_owner = owner;
 }
 
@@ -21115,6 +24201,8 @@ HumdrumLine& HumdrumLine::operator=(HumdrumLine& line) {
 	for (int i=0; i<(int)m_tabs.size(); i++) {
 		m_tabs.at(i) = line.m_tabs.at(i);
 	}
+	m_textdirty = line.m_textdirty;
+	m_class = line.m_class;
 	m_owner = NULL;
 	return *this;
 }
@@ -21194,34 +24282,56 @@ void HumdrumLine::setLineFromCsv(const string& csv, const string& separator) {
 	}
 	string& value = *this;
 	value = output;
+	updateLineClass();
 }
 
 
 
 //////////////////////////////
 //
-// HumdrumLine::setText -- Get the textual content of the line.  Note that
-//    you may need to run HumdrumLine::createLineFromTokens() if the tokens
-//    of the line have changed.
+// HumdrumLine::setText -- Set the textual content of the line.  Note that
+//    you will need to run HumdrumLine::createTokensFromLine() to update
+//    the tokens of the line.
 //
 
 void HumdrumLine::setText(const string& text) {
 	string::assign(text);
+	m_textdirty = false;
+	updateLineClass();
 }
 
 
 
 //////////////////////////////
 //
-// HumdrumLine::getText --
+// HumdrumLine::getText -- Return the textual content of the line.  The
+//    text is regenerated from the tokens if any of them have been changed.
+//    Use this function (or updateText()) rather than reading the line
+//    through its std::string interface if the tokens of a line with
+//    spines may have been changed.
 //
 
 string HumdrumLine::getText(void) {
+	updateText();
 	return string(*this);
 }
 
 
 
+//////////////////////////////
+//
+// HumdrumLine::updateText -- Regenerate the line text from the tokens
+//    if the tokens have been changed since the text was last created.
+//
+
+void HumdrumLine::updateText(void) {
+	if (m_textdirty) {
+		createLineFromTokens();
+	}
+}
+
+
+
 //////////////////////////////
 //
 // HumdrumLine::clear -- Remove stored tokens.
@@ -21237,6 +24347,7 @@ void HumdrumLine::clear(void) {
 	m_tokens.clear();
 	m_tabs.clear();
 	m_rhythm_analyzed = false;
+	updateLineClass();
 }
 
 
@@ -21254,7 +24365,7 @@ bool HumdrumLine::equalChar(int index, char ch) const {
 	if (index < 0) {
 		return false;
 	}
-	if (((string)(*this))[index] == ch) {
+	if ((*this)[index] == ch) {
 		return true;
 	} else {
 		return false;
@@ -21275,7 +24386,7 @@ bool HumdrumLine::isKernBoundaryStart(void) const {
 		return false;
 	}
 	for (int i=0; i<getFieldCount(); i++) {
-		if (!token(i)->isDataType("**kern")) {
+		if (!token(i)->isKern()) {
 			continue;
 		}
 		if (token(i)->isNull()) {
@@ -21301,7 +24412,7 @@ bool HumdrumLine::isKernBoundaryEnd(void) const {
 	}
 	HTp ntok;
 	for (int i=0; i<getFieldCount(); i++) {
-		if (!token(i)->isDataType("**kern")) {
+		if (!token(i)->isKern()) {
 			continue;
 		}
 		ntok = token(i)->getNextToken();
@@ -21330,7 +24441,7 @@ bool HumdrumLine::isKernBoundaryEnd(void) const {
 //
 
 bool HumdrumLine::isComment(void) const {
-	return equalChar(0, '!');
+	return m_class & LINE_COMMENT;
 }
 
 
@@ -21341,7 +24452,7 @@ bool HumdrumLine::isComment(void) const {
 //
 
 bool HumdrumLine::isCommentLocal(void) const {
-	return equalChar(0, '!') && !equalChar(1, '!');
+	return (m_class & (LINE_COMMENT | LINE_COMMENT_GLOBAL)) == LINE_COMMENT;
 }
 
 
@@ -21352,7 +24463,7 @@ bool HumdrumLine::isCommentLocal(void) const {
 //
 
 bool HumdrumLine::isCommentGlobal(void) const {
-	return equalChar(0, '!') && equalChar(1, '!');
+	return m_class & LINE_COMMENT_GLOBAL;
 }
 
 
@@ -21637,7 +24748,7 @@ string HumdrumLine::getUniversalReferenceValue(void) const {
 //
 
 bool HumdrumLine::isExclusive(void) const {
-	return equalChar(1, '*') && equalChar(0, '*');
+	return m_class & LINE_EXCLUSIVE;
 }
 
 
@@ -21669,7 +24780,7 @@ bool HumdrumLine::isTerminator(void) const {
 //
 
 bool HumdrumLine::isInterp(void) const {
-	return equalChar(0, '*');
+	return m_class & LINE_INTERPRETATION;
 }
 
 
@@ -21680,7 +24791,7 @@ bool HumdrumLine::isInterp(void) const {
 //
 
 bool HumdrumLine::isBarline(void) const {
-	return equalChar(0, '=');
+	return m_class & LINE_BARLINE;
 }
 
 
@@ -21691,11 +24802,7 @@ bool HumdrumLine::isBarline(void) const {
 //
 
 bool HumdrumLine::isData(void) const {
-	if (isComment() || isInterp() || isBarline() || isEmpty()) {
-		return false;
-	} else {
-		return true;
-	}
+	return m_class & LINE_DATA;
 }
 
 
@@ -21708,15 +24815,7 @@ bool HumdrumLine::isData(void) const {
 //
 
 bool HumdrumLine::isAllNull(void) const {
-	if (!hasSpines()) {
-		return false;
-	}
-	for (int i=0; i<getTokenCount(); i++) {
-		if (!token(i)->isNull()) {
-			return false;
-		}
-	}
-	return true;
+	return (m_class & LINE_ALL_NULL) && hasSpines();
 }
 
 
@@ -22096,12 +25195,64 @@ bool HumdrumLine::isGlobal(void) const {
 //
 
 bool HumdrumLine::isManipulator(void) const {
+	return m_class & LINE_MANIPULATOR;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumLine::updateLineClass -- Store the classes of the line for the
+//   is*() functions.  The text classes (data, interpretation, comment,
+//   etc.) come from the first characters of the line text, and the
+//   manipulator and null classes come from the token classes.  This is
+//   called whenever the line text or the list of tokens is changed, and
+//   by HumdrumToken::setText() when the class of a token changes.
+//
+
+void HumdrumLine::updateLineClass(void) {
+	m_class = 0;
+	if (!empty()) {
+		char firstchar = (*this)[0];
+		char secondchar = size() > 1 ? (*this)[1] : '\0';
+		switch (firstchar) {
+			case '*':
+				m_class |= LINE_INTERPRETATION;
+				if (secondchar == '*') {
+					m_class |= LINE_EXCLUSIVE;
+				}
+				break;
+			case '!':
+				m_class |= LINE_COMMENT;
+				if (secondchar == '!') {
+					m_class |= LINE_COMMENT_GLOBAL;
+				}
+				break;
+			case '=':
+				m_class |= LINE_BARLINE;
+				break;
+			default:
+				m_class |= LINE_DATA;
+		}
+	}
+
+	// A line without tokens counts as all-null, so that isAllNull() is
+	// true for a spined line which has not been tokenized.
+	bool allnull = true;
 	for (int i=0; i<(int)m_tokens.size(); i++) {
+		if (!m_tokens[i]) {
+			continue;
+		}
 		if (m_tokens[i]->isManipulator()) {
-			return true;
+			m_class |= LINE_MANIPULATOR;
+		}
+		if (!m_tokens[i]->isNull()) {
+			allnull = false;
 		}
 	}
-	return false;
+	if (allnull) {
+		m_class |= LINE_ALL_NULL;
+	}
 }
 
 
@@ -22175,6 +25326,7 @@ int HumdrumLine::createTokensFromLine(void) {
 	}
 	m_tokens.clear();
 	m_tabs.clear();
+	m_textdirty = false;
 	HTp token;
 	char ch = 0;
 	char lastch = 0;
@@ -22220,6 +25372,7 @@ int HumdrumLine::createTokensFromLine(void) {
 		m_tabs.push_back(0);
 		tstring.clear();
 	}
+	updateLineClass();
 
 	return (int)m_tokens.size();
 }
@@ -22229,15 +25382,18 @@ int HumdrumLine::createTokensFromLine(void) {
 //////////////////////////////
 //
 // HumdrumLine::createLineFromTokens --  Re-generate a HumdrumLine string from
-//    individual tokens on the line.  This function will be necessary to
-//    run before printing a HumdrumFile if you have changed any tokens on the
-//    line.  Otherwise, changes in the tokens will not be passed on to the
-///   printing of the line.
+//    individual tokens on the line.  Lines are regenerated automatically
+//    when printed or read with getText() if tokens were changed with
+//    HumdrumToken::setText() or the token list of the line was altered
+//    (global lines are regenerated immediately by setText()).  This
+//    function is still needed if tokens were altered through the
+//    std::string interface.
 //
 
 void HumdrumLine::createLineFromTokens(void) {
 	string& iline = *this;
 	iline = "";
+	m_textdirty = false;
 	// needed for empty lines for some reason:
 	if (m_tokens.size()) {
 		if (m_tokens.back() == NULL) {
@@ -22260,6 +25416,7 @@ void HumdrumLine::createLineFromTokens(void) {
 			}
 		}
 	}
+	updateLineClass();
 }
 
 
@@ -22275,6 +25432,7 @@ void HumdrumLine::createLineFromTokens(void) {
 
 void HumdrumLine::removeExtraTabs(void) {
 	fill(m_tabs.begin(), m_tabs.end(), 0);
+	m_textdirty = true;
 }
 
 
@@ -22294,6 +25452,7 @@ void HumdrumLine::addExtraTabs(vector<int>& trackWidths) {
 	}
 
 	fill(m_tabs.begin(), m_tabs.end(), 1);
+	m_textdirty = true;
 	vector<int> local(trackWidths.size(), 0);
 
 	int lasttrack = 0;
@@ -22436,27 +25595,18 @@ bool HumdrumLine::analyzeTracks(string& err) {
 		return !err.size();
 	}
 
-	string info;
+	HumdrumFileBase* owner = (HumdrumFileBase*)m_owner;
 	int track;
 	int maxtrack = 0;
-	int i, j, k;
+	int i;
 
 	for (i=0; i<(int)m_tokens.size(); i++) {
-		info = m_tokens[i]->getSpineInfo();
-		track = 0;
-		for (j=0; j<(int)info.size(); j++) {
-			if (!isdigit(info[j])) {
-				continue;
-			}
-			track = info[j] - '0';
-			for (k=j+1; k<(int)info.size(); k++) {
-				if (isdigit(info[k])) {
-					track = track * 10 + (info[k] - '0');
-				} else {
-					break;
-				}
-			}
-			break;
+		int id = m_tokens[i]->getSpineInfoId();
+		if (owner && (id >= 0)) {
+			// The track number of interned spine info is already known.
+			track = owner->getSpineInfoTrack(id);
+		} else {
+			track = HumAddress::getTrackFromSpineInfo(m_tokens[i]->getSpineInfo());
 		}
 		if (maxtrack < track) {
 			maxtrack = track;
@@ -22931,6 +26081,8 @@ void HumdrumLine::appendToken(HTp token, int tabcount) {
 	// deletion will be handled by class.
 	m_tokens.push_back(token);
 	m_tabs.push_back(tabcount);
+	m_textdirty = true;
+	updateLineClass();
 }
 
 
@@ -22938,6 +26090,8 @@ void HumdrumLine::appendToken(const HumdrumToken& token, int tabcount) {
 	HTp newtok = new HumdrumToken(token);
 	m_tokens.push_back(newtok);
 	m_tabs.push_back(tabcount);
+	m_textdirty = true;
+	updateLineClass();
 }
 
 
@@ -22945,6 +26099,8 @@ void HumdrumLine::appendToken(const string& token, int tabcount) {
 	HTp newtok = new HumdrumToken(token);
 	m_tokens.push_back(newtok);
 	m_tabs.push_back(tabcount);
+	m_textdirty = true;
+	updateLineClass();
 }
 
 
@@ -22952,6 +26108,8 @@ void HumdrumLine::appendToken(const char* token, int tabcount) {
 	HTp newtok = new HumdrumToken(token);
 	m_tokens.push_back(newtok);
 	m_tabs.push_back(tabcount);
+	m_textdirty = true;
+	updateLineClass();
 }
 
 
@@ -22987,6 +26145,8 @@ void HumdrumLine::insertToken(int index, HTp token, int tabcount) {
 	// already belongs to another HumdrumLine or HumdrumFile.
 	m_tokens.insert(m_tokens.begin() + index, token);
 	m_tabs.insert(m_tabs.begin() + index, tabcount);
+	m_textdirty = true;
+	updateLineClass();
 }
 
 
@@ -22994,6 +26154,8 @@ void HumdrumLine::insertToken(int index, const HumdrumToken& token, int tabcount
 	HTp newtok = new HumdrumToken(token);
 	m_tokens.insert(m_tokens.begin() + index, newtok);
 	m_tabs.insert(m_tabs.begin() + index, tabcount);
+	m_textdirty = true;
+	updateLineClass();
 }
 
 
@@ -23001,6 +26163,8 @@ void HumdrumLine::insertToken(int index, const string& token, int tabcount) {
 	HTp newtok = new HumdrumToken(token);
 	m_tokens.insert(m_tokens.begin() + index, newtok);
 	m_tabs.insert(m_tabs.begin() + index, tabcount);
+	m_textdirty = true;
+	updateLineClass();
 }
 
 
@@ -23008,6 +26172,8 @@ void HumdrumLine::insertToken(int index, const char* token, int tabcount) {
 	HTp newtok = new HumdrumToken(token);
 	m_tokens.insert(m_tokens.begin() + index, newtok);
 	m_tabs.insert(m_tabs.begin() + index, tabcount);
+	m_textdirty = true;
+	updateLineClass();
 }
 
 
@@ -23056,17 +26222,396 @@ void HumdrumLine::storeGlobalLinkedParameters(void) {
 //
 
 ostream& operator<<(ostream& out, HumdrumLine& line) {
+	line.updateText();
 	out << (string)line;
 	return out;
 }
 
 ostream& operator<< (ostream& out, HumdrumLine* line) {
+	line->updateText();
 	out << (string)(*line);
 	return out;
 }
 
 
 
+
+//////////////////////////////
+//
+// HumdrumLineStream::HumdrumLineStream -- Constructor.  The input
+//    sources are the same as for HumdrumFileStream.
+//
+
+HumdrumLineStream::HumdrumLineStream(void) : HumdrumFileStream() {
+	// do nothing
+}
+
+HumdrumLineStream::HumdrumLineStream(char** list) : HumdrumFileStream(list) {
+	// do nothing
+}
+
+HumdrumLineStream::HumdrumLineStream(const vector<string>& list) :
+		HumdrumFileStream(list) {
+	// do nothing
+}
+
+HumdrumLineStream::HumdrumLineStream(Options& options) :
+		HumdrumFileStream(options) {
+	// do nothing
+}
+
+HumdrumLineStream::HumdrumLineStream(const string& datastream) :
+		HumdrumFileStream(datastream) {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumLineStream::~HumdrumLineStream -- Deconstructor.
+//
+
+HumdrumLineStream::~HumdrumLineStream() {
+	// do nothing
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumLineStream::getLine -- Read the next line of the input.  The
+//    line and its tokens are only valid until the next call to getLine(),
+//    and the line index is the index of the line in its segment (file).
+//    Returns NULL if there are no more lines to read, or if the spine
+//    structure of the input is invalid (see getError()).
+//
+
+HLp HumdrumLineStream::getLine(void) {
+	if (hasError()) {
+		return NULL;
+	}
+	string text;
+	if (!getText(text)) {
+		return NULL;
+	}
+	if ((!text.empty()) && (text.back() == 0x0d)) {
+		text.resize(text.size() - 1);
+	}
+	m_line.setText(text);
+	m_line.createTokensFromLine();
+	m_line.setLineIndex(++m_lineindex);
+	if (!analyzeSpines()) {
+		return NULL;
+	}
+	return &m_line;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumLineStream::process -- Send each line of the input to a
+//    function.  Returns false if the input could not be parsed.
+//
+
+bool HumdrumLineStream::process(const std::function<void(HumdrumLine&)>& event) {
+	HLp line;
+	while ((line = getLine())) {
+		event(*line);
+	}
+	return !hasError();
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumLineStream::getDataType -- Return the exclusive interpretation
+//    for a field on the current line.  Tokens read by the stream do not
+//    belong to a HumdrumFile, so use this function rather than
+//    HumdrumToken::getDataType() or HumdrumToken::isKern().
+//
+
+const string& HumdrumLineStream::getDataType(int index) const {
+	static const string empty;
+	if ((index < 0) || (index >= (int)m_datatypes.size())) {
+		return empty;
+	}
+	return m_datatypes[index];
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumLineStream::getMaxTrack -- Return the highest track number
+//    found so far in the current segment.
+//
+
+int HumdrumLineStream::getMaxTrack(void) const {
+	return m_maxtrack;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumLineStream::getFilename -- Return the filename of the current
+//    segment (from the input file list or a !!!!SEGMENT: record).
+//
+
+const string& HumdrumLineStream::getFilename(void) const {
+	return m_filename;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumLineStream::getSegmentLevel -- Return the level given in the
+//    !!!!SEGMENT record of the current segment.
+//
+
+int HumdrumLineStream::getSegmentLevel(void) const {
+	return m_segmentlevel;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumLineStream::hasError -- Returns true if the spine structure of
+//    the input was invalid.
+//
+
+bool HumdrumLineStream::hasError(void) const {
+	return !m_error.empty();
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumLineStream::getError -- Return the description of the spine
+//    structure error.
+//
+
+const string& HumdrumLineStream::getError(void) const {
+	return m_error;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumLineStream::setError -- Store a parsing error.  Always returns
+//    false.
+//
+
+bool HumdrumLineStream::setError(const string& message) {
+	stringstream err;
+	err << "Error on line " << (m_lineindex + 1);
+	if (!m_filename.empty()) {
+		err << " of " << m_filename;
+	}
+	err << ":" << endl;
+	err << "   " << message << endl;
+	err << "   LINE: " << m_line << endl;
+	m_error = err.str();
+	return false;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumLineStream::getText -- Get the text of the next line.  The
+//    input is divided into segments by the same reader as
+//    HumdrumFileStream::getFileContents(), so the lines are the same as
+//    the lines of the files read by HumdrumFileStream::getFile().
+//
+
+bool HumdrumLineStream::getText(string& text) {
+	while (true) {
+		if (m_doneQ) {
+			return false;
+		}
+		if (m_input == NULL) {
+			if (!startSegment()) {
+				m_doneQ = true;
+				return false;
+			}
+			resetSpines();
+		}
+		if (readSegmentLine(text)) {
+			return true;
+		}
+		m_input = NULL;
+		if (!m_dataFoundQ) {
+			// Nothing found in the segment.
+			if (m_addedFilenameQ) {
+				continue;
+			}
+			m_doneQ = true;
+			return false;
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumLineStream::resetSpines -- Clear the spine state at the start
+//    of a segment.
+//
+
+void HumdrumLineStream::resetSpines(void) {
+	m_datatypes.clear();
+	m_spineinfo.clear();
+	m_spineids.clear();
+	m_nexttypes.clear();
+	m_nextinfo.clear();
+	m_adjustQ = false;
+	m_maxtrack = 0;
+	m_lineindex = -1;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumLineStream::analyzeSpines -- Set the spine info, track and
+//    subtrack of the tokens on the current line (see
+//    HumdrumFileBase::analyzeSpines()).  The spine info strings are
+//    only interned when the spine structure changes.
+//
+
+bool HumdrumLineStream::analyzeSpines(void) {
+	if (!m_line.hasSpines()) {
+		m_line.token(0)->setFieldIndex(0);
+		return true;
+	}
+
+	if (m_adjustQ) {
+		m_datatypes.swap(m_nexttypes);
+		m_spineinfo.swap(m_nextinfo);
+		m_spineids.clear();
+		m_adjustQ = false;
+	}
+
+	int count = m_line.getTokenCount();
+	bool initQ = false;
+	if (m_datatypes.empty()) {
+		if (!m_line.isExclusive()) {
+			return setError("Data found before exclusive interpretation");
+		}
+		initQ = true;
+		m_maxtrack = count;
+		m_datatypes.resize(count);
+		m_spineinfo.resize(count);
+		for (int j=0; j<count; j++) {
+			m_datatypes[j] = *m_line.token(j);
+			m_spineinfo[j] = to_string(j+1);
+		}
+	}
+
+	if ((int)m_datatypes.size() != count) {
+		return setError("Expected " + to_string(m_datatypes.size())
+				+ " fields, but found " + to_string(count));
+	}
+
+	bool internQ = m_spineids.empty();
+	if (internQ) {
+		m_spineids.resize(count);
+	}
+	for (int j=0; j<count; j++) {
+		HTp token = m_line.token(j);
+		if (internQ) {
+			token->setSpineInfo(m_spineinfo[j]);
+			m_spineids[j] = token->getSpineInfoId();
+		} else {
+			token->setSpineInfoId(m_spineids[j]);
+		}
+		token->setFieldIndex(j);
+		if ((!initQ) && (token->compare(0, 2, "**") == 0)) {
+			if (!m_datatypes[j].empty()) {
+				return setError("Exclusive interpretation with no preparation");
+			}
+			m_datatypes[j] = *token;
+		}
+	}
+
+	string err;
+	if (!m_line.analyzeTracks(err)) {
+		return setError(err);
+	}
+
+	if ((!initQ) && m_line.isManipulator()) {
+		return adjustSpines();
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumLineStream::adjustSpines -- Calculate the spine state after a
+//    manipulator line (see HumdrumFileBase::adjustSpines()).
+//
+
+bool HumdrumLineStream::adjustSpines(void) {
+	m_nexttypes.clear();
+	m_nextinfo.clear();
+	int count = m_line.getTokenCount();
+	for (int i=0; i<count; i++) {
+		HTp token = m_line.token(i);
+		if (token->isSplitInterpretation()) {
+			m_nexttypes.push_back(m_datatypes[i]);
+			m_nexttypes.push_back(m_datatypes[i]);
+			m_nextinfo.push_back('(' + m_spineinfo[i] + ")a");
+			m_nextinfo.push_back('(' + m_spineinfo[i] + ")b");
+		} else if (token->isMergeInterpretation()) {
+			int mergecount = 0;
+			for (int j=i+1; j<count; j++) {
+				if (!m_line.token(j)->isMergeInterpretation()) {
+					break;
+				}
+				mergecount++;
+			}
+			m_nexttypes.push_back(m_datatypes[i]);
+			m_nextinfo.push_back(HumdrumFileBase::getMergedSpineInfo(m_spineinfo,
+					i, mergecount));
+			i += mergecount;
+		} else if (token->isAddInterpretation()) {
+			m_nexttypes.push_back(m_datatypes[i]);
+			m_nexttypes.push_back("");
+			m_nextinfo.push_back(m_spineinfo[i]);
+			m_nextinfo.push_back(to_string(++m_maxtrack));
+		} else if (token->isExchangeInterpretation()) {
+			if (i >= count - 1) {
+				return setError("Exchange manipulator in last field");
+			}
+			m_nexttypes.push_back(m_datatypes[i+1]);
+			m_nexttypes.push_back(m_datatypes[i]);
+			m_nextinfo.push_back(m_spineinfo[i+1]);
+			m_nextinfo.push_back(m_spineinfo[i]);
+			i++;
+		} else if (token->isTerminateInterpretation()) {
+			// spine ends
+		} else {
+			m_nexttypes.push_back(m_datatypes[i]);
+			m_nextinfo.push_back(m_spineinfo[i]);
+		}
+	}
+	m_adjustQ = true;
+	return true;
+}
+
+
+
 // spine mainipulators:
 #define SPLIT_TOKEN       "*^"
 #define MERGE_TOKEN       "*v"
@@ -23093,6 +26638,7 @@ HumdrumToken::HumdrumToken(void) : string() {
 	setPrefix("!");
 	m_strand = -1;
 	m_nullresolve = NULL;
+	updateTokenClass();
 }
 
 
@@ -23101,6 +26647,7 @@ HumdrumToken::HumdrumToken(const string& aString) : string(aString) {
 	setPrefix("!");
 	m_strand = -1;
 	m_nullresolve = NULL;
+	updateTokenClass();
 }
 
 
@@ -23109,6 +26656,7 @@ HumdrumToken::HumdrumToken(const char* aString) : string(aString) {
 	setPrefix("!");
 	m_strand = -1;
 	m_nullresolve = NULL;
+	updateTokenClass();
 }
 
 
@@ -23125,6 +26673,7 @@ HumdrumToken::HumdrumToken(const HumdrumToken& token) :
 	m_strand          = -1;
 	m_nullresolve     = NULL;
 	setPrefix(token.getPrefix());
+	updateTokenClass();
 }
 
 
@@ -23141,6 +26690,7 @@ HumdrumToken::HumdrumToken(HumdrumToken* token) :
 	m_strand          = -1;
 	m_nullresolve     = NULL;
 	setPrefix(token->getPrefix());
+	updateTokenClass();
 }
 
 
@@ -23158,6 +26708,7 @@ HumdrumToken::HumdrumToken(const HumdrumToken& token, HumdrumLine* owner) :
 	m_strand          = -1;
 	m_nullresolve     = NULL;
 	setPrefix(token.getPrefix());
+	updateTokenClass();
 }
 
 
@@ -23174,6 +26725,7 @@ HumdrumToken::HumdrumToken(HumdrumToken* token, HumdrumLine* owner) :
 	m_strand          = -1;
 	m_nullresolve     = NULL;
 	setPrefix(token->getPrefix());
+	updateTokenClass();
 }
 
 
@@ -23201,6 +26753,7 @@ HumdrumToken& HumdrumToken::operator=(HumdrumToken& token) {
 	m_strand          = -1;
 	m_nullresolve     = NULL;
 	setPrefix(token.getPrefix());
+	updateTokenClass();
 
 	return *this;
 }
@@ -23219,6 +26772,7 @@ HumdrumToken& HumdrumToken::operator=(const string& token) {
 	m_strand          = -1;
 	m_nullresolve     = NULL;
 	setPrefix("!");
+	updateTokenClass();
 
 	return *this;
 }
@@ -23237,6 +26791,7 @@ HumdrumToken& HumdrumToken::operator=(const char* token) {
 	m_strand          = -1;
 	m_nullresolve     = NULL;
 	setPrefix("!");
+	updateTokenClass();
 
 	return *this;
 }
@@ -23253,6 +26808,10 @@ HumdrumToken::~HumdrumToken() {
 		delete m_linkedParameter;
 		m_linkedParameter = NULL;
 	}
+	if (m_layoutIndex) {
+		delete m_layoutIndex;
+		m_layoutIndex = NULL;
+	}
 }
 
 
@@ -23363,7 +26922,7 @@ HumdrumToken* HumdrumToken::getNextNonNullDataToken(int index) {
 //
 
 HumNum HumdrumToken::getSlurDuration(HumNum scale) {
-	if (!isDataType("**kern")) {
+	if (!isKern()) {
 		return 0;
 	}
 	if (isDefined("auto", "slurDuration")) {
@@ -23409,6 +26968,21 @@ bool HumdrumToken::isDataType(const string& dtype) const {
 
 
 
+//////////////////////////////
+//
+// HumdrumToken::getDataTypeId -- Returns the ID of the exclusive
+//   interpretation of the token in the owning file.  This can be compared
+//   to HumdrumFile::getDataTypeId() for a data type rather than comparing
+//   strings with isDataType().
+// @SEEALSO: isDataType
+//
+
+int HumdrumToken::getDataTypeId(void) const {
+	return m_address.getDataTypeId();
+}
+
+
+
 //////////////////////////////
 //
 // HumdrumToken::isKern -- Returns true if the data type of the token
@@ -23417,7 +26991,7 @@ bool HumdrumToken::isDataType(const string& dtype) const {
 //
 
 bool HumdrumToken::isKern(void) const {
-	return isDataType("**kern");
+	return m_address.getDataTypeId() == HumAddress::DATATYPE_KERN;
 }
 
 
@@ -23430,7 +27004,7 @@ bool HumdrumToken::isKern(void) const {
 //
 
 bool HumdrumToken::isMens(void) const {
-	return isDataType("**mens");
+	return m_address.getDataTypeId() == HumAddress::DATATYPE_MENS;
 }
 
 
@@ -23447,6 +27021,19 @@ void HumdrumToken::setSpineInfo(const string& spineinfo) {
 
 
 
+//////////////////////////////
+//
+// HumdrumToken::setSpineInfoId -- Sets the spine manipulation history
+//     from an ID in the spine info table of the owning file.
+// @SEEALTO: getSpineInfoId
+//
+
+void HumdrumToken::setSpineInfoId(int id) {
+	m_address.setSpineInfoId(id);
+}
+
+
+
 //////////////////////////////
 //
 // HumdrumToken::getSpineInfo -- Returns the spine split/merge history
@@ -23454,12 +27041,26 @@ void HumdrumToken::setSpineInfo(const string& spineinfo) {
 // @SEEALTO: setSpineInfo
 //
 
-string HumdrumToken::getSpineInfo(void) const {
+const string& HumdrumToken::getSpineInfo(void) const {
 	return m_address.getSpineInfo();
 }
 
 
 
+//////////////////////////////
+//
+// HumdrumToken::getSpineInfoId -- Returns the ID of the spine info string
+//    in the owning file.  Tokens in the same file have the same spine info
+//    when their IDs are the same.
+// @SEEALTO: getSpineInfo
+//
+
+int HumdrumToken::getSpineInfoId(void) const {
+	return m_address.getSpineInfoId();
+}
+
+
+
 //////////////////////////////
 //
 // HumdrumToken::getLineIndex -- Returns the line index of the owning
@@ -23809,13 +27410,7 @@ bool HumdrumToken::analyzeDuration(void) {
 //
 
 bool HumdrumToken::isManipulator(void) const {
-	if (isSplitInterpretation())     { return true; }
-	if (isMergeInterpretation())     { return true; }
-	if (isExchangeInterpretation())  { return true; }
-	if (isAddInterpretation())       { return true; }
-	if (isTerminateInterpretation()) { return true; }
-	if (isExclusiveInterpretation()) { return true; }
-	return false;
+	return m_class & TOKEN_MANIPULATOR;
 }
 
 
@@ -24217,7 +27812,7 @@ bool HumdrumToken::isNoteAttack(void) {
 //
 
 bool HumdrumToken::isInvisible(void) {
-	if (!isDataType("**kern")) {
+	if (!isKern()) {
 			return false;
 	}
 	if (isBarline()) {
@@ -24241,7 +27836,7 @@ bool HumdrumToken::isInvisible(void) {
 //
 
 bool HumdrumToken::isGrace(void) {
-	if (!isDataType("**kern")) {
+	if (!isKern()) {
 			return false;
 	}
 	if (!isData()) {
@@ -24261,7 +27856,7 @@ bool HumdrumToken::isGrace(void) {
 //
 
 bool HumdrumToken::isClef(void) {
-	if (!(isDataType("**kern") || isDataType("**mens"))) {
+	if (!(isKern() || isMens())) {
 			return false;
 	}
 	if (!isInterpretation()) {
@@ -24388,7 +27983,7 @@ bool HumdrumToken::isMensurationSymbol(void) {
 //
 
 bool HumdrumToken::hasSlurStart(void) {
-	if (isDataType("**kern")) {
+	if (isKern()) {
 		if (Convert::hasKernSlurStart((string)(*this))) {
 			return true;
 		}
@@ -24405,7 +28000,7 @@ bool HumdrumToken::hasSlurStart(void) {
 //
 
 bool HumdrumToken::hasSlurEnd(void) {
-	if (isDataType("**kern")) {
+	if (isKern()) {
 		if (Convert::hasKernSlurEnd((string)(*this))) {
 			return true;
 		}
@@ -24587,7 +28182,7 @@ bool HumdrumToken::hasObliquaLigatureEnd(void) {
 //
 
 bool HumdrumToken::isSecondaryTiedNote(void) {
-	if (isDataType("**kern")) {
+	if (isKern()) {
 		if (Convert::isKernSecondaryTiedNote((string)(*this))) {
 			return true;
 		}
@@ -24604,14 +28199,7 @@ bool HumdrumToken::isSecondaryTiedNote(void) {
 //
 
 bool HumdrumToken::isBarline(void) const {
-	if (size() == 0) {
-		return false;
-	}
-	if ((*this)[0] == '=') {
-		return true;
-	} else {
-		return false;
-	}
+	return m_class & TOKEN_BARLINE;
 }
 
 
@@ -24623,18 +28211,7 @@ bool HumdrumToken::isBarline(void) const {
 //
 
 bool HumdrumToken::isCommentGlobal(void) const {
-	if (size() == 0) {
-		return false;
-	}
-	if ((*this)[0] == '!') {
-		if (size() > 1) {
-			if ((*this)[1] == '!') {
-				// global comment
-				return true;
-			}
-		}
-	}
-	return false;
+	return m_class & TOKEN_COMMENT_GLOBAL;
 }
 
 
@@ -24646,20 +28223,7 @@ bool HumdrumToken::isCommentGlobal(void) const {
 //
 
 bool HumdrumToken::isCommentLocal(void) const {
-	if (size() == 0) {
-		return false;
-	}
-	if ((*this)[0] == '!') {
-		if (size() > 1) {
-			if ((*this)[1] == '!') {
-				// global comment
-				return false;
-			}
-		}
-		return true;
-	} else {
-		return false;
-	}
+	return (m_class & (TOKEN_COMMENT | TOKEN_COMMENT_GLOBAL)) == TOKEN_COMMENT;
 }
 
 
@@ -24670,14 +28234,7 @@ bool HumdrumToken::isCommentLocal(void) const {
 //
 
 bool HumdrumToken::isComment(void) const {
-	if (size() == 0) {
-		return false;
-	}
-	if ((*this)[0] == '!') {
-		return true;
-	} else {
-		return false;
-	}
+	return m_class & TOKEN_COMMENT;
 }
 
 
@@ -24691,14 +28248,7 @@ bool HumdrumToken::isComment(void) const {
 //
 
 bool HumdrumToken::isData(void) const {
-	if (size() == 0) {
-		return false;
-	}
-	int firstchar = (*this)[0];
-	if ((firstchar == '*') || (firstchar == '!') || (firstchar == '=')) {
-		return false;
-	}
-	return true;
+	return m_class & TOKEN_DATA;
 }
 
 
@@ -24709,14 +28259,7 @@ bool HumdrumToken::isData(void) const {
 //
 
 bool HumdrumToken::isInterpretation(void) const {
-	if (size() == 0) {
-		return false;
-	}
-	int firstchar = (*this)[0];
-	if (firstchar == '*') {
-		return true;
-	}
-	return false;
+	return m_class & TOKEN_INTERPRETATION;
 }
 
 
@@ -24728,7 +28271,7 @@ bool HumdrumToken::isInterpretation(void) const {
 //
 
 bool HumdrumToken::isNonNullData(void) const {
-	return isData() && !isNull();
+	return (m_class & (TOKEN_DATA | TOKEN_NULL)) == TOKEN_DATA;
 }
 
 
@@ -24740,7 +28283,7 @@ bool HumdrumToken::isNonNullData(void) const {
 //
 
 bool HumdrumToken::isNullData(void) const {
-	return isData() && isNull();
+	return (m_class & (TOKEN_DATA | TOKEN_NULL)) == (TOKEN_DATA | TOKEN_NULL);
 }
 
 
@@ -24783,8 +28326,7 @@ bool HumdrumToken::isChord(const string& separator) {
 //
 
 bool HumdrumToken::isExclusiveInterpretation(void) const {
-	const string& tok = (string)(*this);
-	return tok.substr(0, 2) == "**";
+	return m_class & TOKEN_EXCLUSIVE;
 }
 
 
@@ -24795,7 +28337,7 @@ bool HumdrumToken::isExclusiveInterpretation(void) const {
 //
 
 bool HumdrumToken::isSplitInterpretation(void) const {
-	return ((string)(*this)) == SPLIT_TOKEN;
+	return m_class & TOKEN_SPLIT;
 }
 
 
@@ -24806,7 +28348,7 @@ bool HumdrumToken::isSplitInterpretation(void) const {
 //
 
 bool HumdrumToken::isMergeInterpretation(void) const {
-	return ((string)(*this)) == MERGE_TOKEN;
+	return m_class & TOKEN_MERGE;
 }
 
 
@@ -24817,7 +28359,7 @@ bool HumdrumToken::isMergeInterpretation(void) const {
 //
 
 bool HumdrumToken::isExchangeInterpretation(void) const {
-	return ((string)(*this)) == EXCHANGE_TOKEN;
+	return m_class & TOKEN_EXCHANGE;
 }
 
 
@@ -24828,7 +28370,7 @@ bool HumdrumToken::isExchangeInterpretation(void) const {
 //
 
 bool HumdrumToken::isTerminateInterpretation(void) const {
-	return ((string)(*this)) == TERMINATE_TOKEN;
+	return m_class & TOKEN_TERMINATE;
 }
 
 
@@ -24839,7 +28381,7 @@ bool HumdrumToken::isTerminateInterpretation(void) const {
 //
 
 bool HumdrumToken::isAddInterpretation(void) const {
-	return ((string)(*this)) == ADD_TOKEN;
+	return m_class & TOKEN_ADD;
 }
 
 
@@ -24852,11 +28394,61 @@ bool HumdrumToken::isAddInterpretation(void) const {
 //
 
 bool HumdrumToken::isNull(void) const {
-	const string& tok = (string)(*this);
-	if (tok == NULL_DATA)           { return true; }
-	if (tok == NULL_INTERPRETATION) { return true; }
-	if (tok == NULL_COMMENT_LOCAL)  { return true; }
-	return false;
+	return m_class & TOKEN_NULL;
+}
+
+
+
+//////////////////////////////
+//
+// HumdrumToken::updateTokenClass -- Store the classes of the token text
+//   (data, interpretation, null, manipulator, etc.) for the is*()
+//   functions.  Only the first two characters and the length of the text
+//   are needed to identify the classes.
+//
+
+void HumdrumToken::updateTokenClass(void) {
+	m_class = 0;
+	int length = (int)size();
+	if (length == 0) {
+		return;
+	}
+	char firstchar = (*this)[0];
+	char secondchar = length > 1 ? (*this)[1] : '\0';
+	switch (firstchar) {
+		case '*':
+			m_class |= TOKEN_INTERPRETATION;
+			if (length == 1) {
+				m_class |= TOKEN_NULL;
+			} else if (secondchar == '*') {
+				m_class |= TOKEN_EXCLUSIVE | TOKEN_MANIPULATOR;
+			} else if (length == 2) {
+				switch (secondchar) {
+					case '^': m_class |= TOKEN_SPLIT     | TOKEN_MANIPULATOR; break;
+					case 'v': m_class |= TOKEN_MERGE     | TOKEN_MANIPULATOR; break;
+					case 'x': m_class |= TOKEN_EXCHANGE  | TOKEN_MANIPULATOR; break;
+					case '+': m_class |= TOKEN_ADD       | TOKEN_MANIPULATOR; break;
+					case '-': m_class |= TOKEN_TERMINATE | TOKEN_MANIPULATOR; break;
+				}
+			}
+			break;
+		case '!':
+			m_class |= TOKEN_COMMENT;
+			if (secondchar == '!') {
+				m_class |= TOKEN_COMMENT_GLOBAL;
+			} else if (length == 1) {
+				m_class |= TOKEN_NULL;
+			}
+			break;
+		case '=':
+			m_class |= TOKEN_BARLINE;
+			break;
+		default:
+			m_class |= TOKEN_DATA;
+			if ((length == 1) && (firstchar == '.')) {
+				m_class |= TOKEN_NULL;
+			}
+	}
 }
 
 
@@ -25091,7 +28683,33 @@ void HumdrumToken::setParameters(const string& pdata, HumdrumToken* ptok) {
 //
 
 void HumdrumToken::setText(const string& text) {
+	bool exinterp = (this->compare(0, 2, "**") == 0);
+	unsigned int oldclass = m_class;
 	string::assign(text);
+	updateTokenClass();
+	HumdrumLine* line = getOwner();
+	if (!line) {
+		return;
+	}
+	if (line->hasSpines()) {
+		// The line text will be regenerated from the tokens when printed.
+		line->markTextDirty();
+	} else {
+		// Global lines have a single token, so update the line text now,
+		// so that reference records can be read from the line string.
+		line->createLineFromTokens();
+	}
+	if (m_class != oldclass) {
+		line->updateLineClass();
+	}
+	if (exinterp || (this->compare(0, 2, "**") == 0)) {
+		// Keep the data type of the track up to date if the token
+		// starts a track.
+		HumdrumFile* file = line->getOwner();
+		if (file) {
+			file->updateTrackDataType(this);
+		}
+	}
 }
 
 
@@ -25119,6 +28737,10 @@ int HumdrumToken::addLinkedParameter(HTp token) {
 		}
 	}
 
+	if (m_layoutIndex) {
+		m_layoutIndex->clear();
+	}
+
 	if (m_linkedParameters.empty()) {
 		m_linkedParameters.push_back(token);
 	} else {
@@ -25195,6 +28817,45 @@ void HumdrumToken::storeLinkedParameters(void) {
 
 
 
+//////////////////////////////
+//
+// HumdrumToken::getLayoutIndex -- Return the index of the linked layout
+//     parameters, or NULL if there are no linked parameters.  The index
+//     is built when it is first needed, and rebuilt if a parameter has
+//     been linked since then, or if the layout parameters of the owning
+//     file have been indexed again (see
+//     HumdrumFileStructure::indexLayoutParameters()).
+//
+
+HumLayoutIndex* HumdrumToken::getLayoutIndex(void) {
+	if (m_linkedParameters.empty()) {
+		return NULL;
+	}
+	int version = 0;
+	HumdrumLine* line = getOwner();
+	if (line && line->getOwner()) {
+		version = line->getOwner()->getLayoutParameterVersion();
+	}
+	if (m_layoutIndex && (m_layoutIndex->getVersion() == version)) {
+		return m_layoutIndex;
+	}
+	if (m_layoutIndex) {
+		m_layoutIndex->clear();
+	} else {
+		m_layoutIndex = new HumLayoutIndex;
+	}
+	for (int i=0; i<(int)m_linkedParameters.size(); i++) {
+		HumParamSet* hps = getLinkedParameter(i);
+		if (hps) {
+			m_layoutIndex->addParameterSet(*hps);
+		}
+	}
+	m_layoutIndex->setVersion(version);
+	return m_layoutIndex;
+}
+
+
+
 //////////////////////////////
 //
 // HumdrumToken::makeForwardLink -- Line a following spine token to this one.
@@ -25292,70 +28953,12 @@ std::string HumdrumToken::getLayoutParameter(const std::string& category,
 		}
 	}
 
-	std::string output;
-	int lcount = this->getLinkedParameterCount();
-	if (lcount == 0) {
-		return output;
-	}
-
-	std::string nparam;
-	for (int p = 0; p < this->getLinkedParameterCount(); ++p) {
-		hum::HumParamSet *hps = this->getLinkedParameter(p);
-		if (hps == NULL) {
-			continue;
-		}
-		if (hps->getNamespace1() != "LO") {
-			continue;
-		}
-		if (hps->getNamespace2() != category) {
-			continue;
-		}
-
-		output = "";
-		for (int q = 0; q < hps->getCount(); ++q) {
-			string key = hps->getParameterName(q);
-			if (key == keyname) {
-				output = hps->getParameterValue(q);
-				if (subtokenindex < 0) {
-					return output;
-				}
-			}
-			if (key == "n") {
-				nparam = hps->getParameterValue(q);
-			}
-		}
-		if (nparam.empty()) {
-			// No subtoken selection for this parameter,
-			// so return if not empty:
-			if (!output.empty()) {
-				return output;
-			}
-		} else if (subtokenindex < 0) {
-			// No subtoken selection so return output if not empty
-			if (!output.empty()) {
-				return output;
-			}
-		} else {
-			// There is a subtoken selection number, so
-			// return output if n matches it (minus one)
-
-			// currently @n requires a single value
-			// (should allow a range or multiple values
-			// later).  Also not checking validity of
-			// string first (needs to start with a digit);
-
-			int n = stoi(nparam);
-			if (n == subtokenindex + 1) {
-				return output;
-			} else {
-				// not the output that is required,
-				// so suppress for end of loop:
-				output = "";
-			}
-		}
+	// Then the linked parameters (see HumLayoutIndex::getValue()):
+	HumLayoutIndex* index = getLayoutIndex();
+	if (!index) {
+		return "";
 	}
-
-	return output;
+	return index->getValue(category, keyname, subtokenindex);
 }
 
 
@@ -25383,33 +28986,12 @@ std::string HumdrumToken::getSlurLayoutParameter(const std::string& keyname,
 		}
 	}
 
-	int lcount = this->getLinkedParameterCount();
-	if (lcount == 0) {
+	HumLayoutIndex* index = getLayoutIndex();
+	if (!index) {
 		return output;
 	}
-
-	std::string sparam;
-	for (int p = 0; p < this->getLinkedParameterCount(); ++p) {
-		hum::HumParamSet *hps = this->getLinkedParameter(p);
-		if (hps == NULL) {
-			continue;
-		}
-		if (hps->getNamespace1() != "LO") {
-			continue;
-		}
-		if (hps->getNamespace2() != category) {
-			continue;
-		}
-		for (int q = 0; q < hps->getCount(); ++q) {
-			string key = hps->getParameterName(q);
-			if (key == "s") {
-				sparam = hps->getParameterValue(q);
-			}
-			if (key == keyname) {
-				output = hps->getParameterValue(q);
-			}
-		}
-	}
+	const std::string& sparam = index->getLastValue(category, "s");
+	output = index->getLastValue(category, keyname);
 	if (subtokenindex < 0) {
 		// do not filter by s parameter
 		return output;
@@ -25450,34 +29032,12 @@ std::string HumdrumToken::getLayoutParameterChord(const std::string& category,
 		}
 	}
 
-	std::string output;
-	int lcount = this->getLinkedParameterCount();
-	if (lcount == 0) {
-		return output;
-	}
-
-	std::string nparam;
-	for (int p = 0; p < this->getLinkedParameterCount(); ++p) {
-		hum::HumParamSet *hps = this->getLinkedParameter(p);
-		if (hps == NULL) {
-			continue;
-		}
-		if (hps->getNamespace1() != "LO") {
-			continue;
-		}
-		if (hps->getNamespace2() != category) {
-			continue;
-		}
-		for (int q = 0; q < hps->getCount(); ++q) {
-			string key = hps->getParameterName(q);
-			if (key == "n") {
-				nparam = hps->getParameterValue(q);
-			}
-			if (key == keyname) {
-				output = hps->getParameterValue(q);
-			}
-		}
+	HumLayoutIndex* index = getLayoutIndex();
+	if (!index) {
+		return "";
 	}
+	const std::string& nparam = index->getLastValue(category, "n");
+	const std::string& output = index->getLastValue(category, keyname);
 
 	if (!nparam.empty()) {
 		// parameter is qualified by a note number, so does not apply to whole token
@@ -25511,34 +29071,12 @@ std::string HumdrumToken::getLayoutParameterNote(const std::string& category,
 		}
 	}
 
-	std::string output;
-	int lcount = this->getLinkedParameterCount();
-	if (lcount == 0) {
-		return output;
-	}
-
-	std::string nparam;
-	for (int p = 0; p < this->getLinkedParameterCount(); ++p) {
-		hum::HumParamSet *hps = this->getLinkedParameter(p);
-		if (hps == NULL) {
-			continue;
-		}
-		if (hps->getNamespace1() != "LO") {
-			continue;
-		}
-		if (hps->getNamespace2() != category) {
-			continue;
-		}
-		for (int q = 0; q < hps->getCount(); ++q) {
-			string key = hps->getParameterName(q);
-			if (key == "n") {
-				nparam = hps->getParameterValue(q);
-			}
-			if (key == keyname) {
-				output = hps->getParameterValue(q);
-			}
-		}
+	HumLayoutIndex* index = getLayoutIndex();
+	if (!index) {
+		return "";
 	}
+	const std::string& nparam = index->getLastValue(category, "n");
+	const std::string& output = index->getLastValue(category, keyname);
 
 	if (!nparam.empty()) {
 		// a number number is specified from the parameter(s)
@@ -25618,7 +29156,7 @@ int  HumdrumToken::getStrandIndex(void) const {
 //
 
 int HumdrumToken::getSlurStartElisionLevel(int index) const {
-	if (isDataType("**kern") || isDataType("**mens")) {
+	if (isKern() || isMens()) {
 		return Convert::getKernSlurStartElisionLevel((string)(*this), index);
 	} else {
 		return -1;
@@ -25636,7 +29174,7 @@ int HumdrumToken::getSlurStartElisionLevel(int index) const {
 //
 
 int HumdrumToken::getSlurEndElisionLevel(int index) const {
-	if (isDataType("**kern") || isDataType("**mens")) {
+	if (isKern() || isMens()) {
 		return Convert::getKernSlurEndElisionLevel((string)(*this), index);
 	} else {
 		return -1;
@@ -25857,7 +29395,7 @@ ostream& HumdrumToken::printXmlBaseInfo(ostream& out, int level,
 	out << "</tokenType>\n";
 
 	// <tokenFunction>
-	if (isDataType("**kern")) {
+	if (isKern()) {
 		if (isNote()) {
 			out << Convert::repeatString(indent, level) << "<tokenFunction>";
 			out << "note" << "</tokenFunction>\n";
@@ -26235,6 +29773,62 @@ void MxmlEvent::setDuration(HumNum value) {
 
 
 
+//////////////////////////////
+//
+// MxmlEvent::setTickTimeline -- Store the start time and duration of
+//    the event as integer ticks, where tpq is the number of ticks per
+//    quarter note for the timeline of the part (see
+//    MxmlPart::setTimelineTpq()).
+//
+
+void MxmlEvent::setTickTimeline(int tpq) {
+	m_tickstart = timeToTicks(m_starttime, tpq);
+	m_tickdur   = timeToTicks(m_duration, tpq);
+}
+
+
+
+//////////////////////////////
+//
+// MxmlEvent::getTickStart -- Return the start time of the event in
+//    ticks of the part timeline.
+//
+
+long MxmlEvent::getTickStart(void) const {
+	return m_tickstart;
+}
+
+
+
+//////////////////////////////
+//
+// MxmlEvent::getTickDuration -- Return the duration of the event in
+//    ticks of the part timeline.
+//
+
+long MxmlEvent::getTickDuration(void) const {
+	return m_tickdur;
+}
+
+
+
+//////////////////////////////
+//
+// MxmlEvent::timeToTicks -- Convert a time in quarter notes into ticks,
+//    where tpq is the number of ticks per quarter note (which should be
+//    a multiple of the denominator of the time).
+//
+
+long MxmlEvent::timeToTicks(HumNum value, int tpq) {
+	int denominator = value.getDenominator();
+	if (tpq % denominator == 0) {
+		return (long)value.getNumerator() * (tpq / denominator);
+	}
+	return (long)value.getNumerator() * tpq / denominator;
+}
+
+
+
 //////////////////////////////
 //
 // MxmlEvent::getStartTime -- Return the start time of the event in terms
@@ -28279,7 +31873,8 @@ bool MxmlMeasure::parseMeasure(xml_node mel) {
    // musicxml2hum_interface::insertMeasure(), specifically:
 	// musicxml2hum_interface::checkForDummyRests().
 
-	sortEvents();
+	// Events are sorted after the tick timeline of the part is known
+	// (see getSortedEvents()).
 
 	return output;
 }
@@ -28322,6 +31917,9 @@ void MxmlMeasure::addDummyRest(void) {
    m_events.push_back(event);
    MxmlMeasure* measure = this;
    event->makeDummyRest(measure, starttime, measuredur);
+	if (getTimelineTpq() > 0) {
+		event->setTickTimeline(getTimelineTpq());
+	}
 }
 
 
@@ -28331,6 +31929,9 @@ void MxmlMeasure::addDummyRest(HumNum starttime, HumNum duration,
 	m_events.push_back(event);
    MxmlMeasure* measure = this;
    event->makeDummyRest(measure, starttime, duration, staffindex, voiceindex);
+	if (getTimelineTpq() > 0) {
+		event->setTickTimeline(getTimelineTpq());
+	}
 }
 
 
@@ -28630,15 +32231,76 @@ int MxmlMeasure::getEventCount(void) const {
 
 //////////////////////////////
 //
-// MxmlMeasure::getSortedEvents --
+// MxmlMeasure::getSortedEvents -- Return the events grouped by start
+//    time.  The tick timeline of the part is created if needed.
 //
 
 vector<SimultaneousEvents>* MxmlMeasure::getSortedEvents(void) {
+	if (m_owner && (m_owner->getTimelineTpq() <= 0)) {
+		m_owner->setTimelineTpq(m_owner->getMinimumTimelineTpq());
+	}
 	return &m_sortedevents;
 }
 
 
 
+//////////////////////////////
+//
+// MxmlMeasure::setTickTimeline -- Convert the start times and durations
+//    of the measure and its events into integer ticks, where tpq is the
+//    number of ticks per quarter note, and then sort the events.
+//
+
+void MxmlMeasure::setTickTimeline(int tpq) {
+	m_tickstart = MxmlEvent::timeToTicks(m_starttime, tpq);
+	m_tickdur   = MxmlEvent::timeToTicks(m_duration, tpq);
+	for (int i=0; i<(int)m_events.size(); i++) {
+		m_events[i]->setTickTimeline(tpq);
+	}
+	sortEvents();
+}
+
+
+
+//////////////////////////////
+//
+// MxmlMeasure::getTickStart -- Return the start time of the measure in
+//    ticks of the part timeline.
+//
+
+long MxmlMeasure::getTickStart(void) const {
+	return m_tickstart;
+}
+
+
+
+//////////////////////////////
+//
+// MxmlMeasure::getTickDuration -- Return the duration of the measure in
+//    ticks of the part timeline.
+//
+
+long MxmlMeasure::getTickDuration(void) const {
+	return m_tickdur;
+}
+
+
+
+//////////////////////////////
+//
+// MxmlMeasure::getTimelineTpq -- Return the ticks per quarter note of
+//    the part timeline, or 0 if the timeline has not been set.
+//
+
+int MxmlMeasure::getTimelineTpq(void) const {
+	if (m_owner) {
+		return m_owner->getTimelineTpq();
+	}
+	return 0;
+}
+
+
+
 //////////////////////////////
 //
 // MxmlMeasure::getEvent --
@@ -28738,37 +32400,35 @@ int MxmlMeasure::getStaffIndex(int voicenum) {
 //////////////////////////////
 //
 // MxmlMeasure::sortEvents -- Sorts events for the measure into
-//   time order.  They are split into zero-duration evnets and
-//   non-zero events.  mevent_floating type are placed into the
-//   non-zero events eventhough they have zero duration (this is
-//   for harmony not attached to a note attack, and will be
-//   eventually including basso continuo figuration having the
+//   time order (by tick times on the part timeline).  They are split
+//   into zero-duration evnets and non-zero events.  mevent_floating
+//   type are placed into the non-zero events eventhough they have zero
+//   duration (this is for harmony not attached to a note attack, and
+//   will be eventually including basso continuo figuration having the
 //   same situation).
 //
 
 void MxmlMeasure::sortEvents(void) {
 	int i;
-	set<HumNum> times;
-
+	vector<long> ticks(m_events.size());
 	for (i=0; i<(int)m_events.size(); i++) {
-		times.insert(m_events[i]->getStartTime());
-	}
-
-	m_sortedevents.resize(times.size());
-	int counter = 0;
-
-	for (HumNum val : times) {
-		m_sortedevents[counter++].starttime = val;
+		ticks[i] = m_events[i]->getTickStart();
 	}
+	std::sort(ticks.begin(), ticks.end());
+	ticks.erase(std::unique(ticks.begin(), ticks.end()), ticks.end());
 
-	// setup sorted access:
-	map<HumNum, SimultaneousEvents*> mapping;
+	m_sortedevents.clear();
+	m_sortedevents.resize(ticks.size());
 	for (i=0; i<(int)m_sortedevents.size(); i++) {
-		mapping[m_sortedevents[i].starttime] = &m_sortedevents[i];
+		m_sortedevents[i].tickstart = ticks[i];
+	}
+	SimultaneousEvents* now;
+	for (i=0; i<(int)m_events.size(); i++) {
+		now = getSortedEventsAtTick(m_events[i]->getTickStart());
+		now->starttime = m_events[i]->getStartTime();
 	}
 
-	HumNum duration;
-	HumNum starttime;
+	long duration;
 	for (i=0; i<(int)m_events.size(); i++) {
 
 		// skip storing certain types of events:
@@ -28776,7 +32436,7 @@ void MxmlMeasure::sortEvents(void) {
 			case mevent_backup:
 				continue;
 			case mevent_forward:
-            if (m_events[i]->getDuration() == this->getDuration()) {
+            if (m_events[i]->getTickDuration() == this->getTickDuration()) {
                  // forward elements are encoded as whole-measure rests
                  // if they fill the duration of a measure
             } else if (m_events[i]->getVoiceIndex() < 0) {
@@ -28788,14 +32448,14 @@ void MxmlMeasure::sortEvents(void) {
 				break;
 		}
 
-		starttime = m_events[i]->getStartTime();
-		duration  = m_events[i]->getDuration();
+		now = getSortedEventsAtTick(m_events[i]->getTickStart());
+		duration = m_events[i]->getTickDuration();
 		if (m_events[i]->isFloating()) {
-			mapping[starttime]->nonzerodur.push_back(m_events[i]);
+			now->nonzerodur.push_back(m_events[i]);
 		} else if (duration == 0) {
-			mapping[starttime]->zerodur.push_back(m_events[i]);
+			now->zerodur.push_back(m_events[i]);
 		} else {
-			mapping[starttime]->nonzerodur.push_back(m_events[i]);
+			now->nonzerodur.push_back(m_events[i]);
 		}
 	}
 
@@ -28841,6 +32501,28 @@ void MxmlMeasure::sortEvents(void) {
 
 
 
+//////////////////////////////
+//
+// MxmlMeasure::getSortedEventsAtTick -- Return the sorted-event entry
+//    for the given tick time (binary search of m_sortedevents).
+//
+
+SimultaneousEvents* MxmlMeasure::getSortedEventsAtTick(long tick) {
+	int low = 0;
+	int high = (int)m_sortedevents.size() - 1;
+	while (low < high) {
+		int mid = (low + high) / 2;
+		if (m_sortedevents[mid].tickstart < tick) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+	return &m_sortedevents[low];
+}
+
+
+
 //////////////////////////////
 //
 // MxmlMeasure::receiveStaffNumberFromChild -- Receive a staff number
@@ -29167,6 +32849,72 @@ HumNum MxmlPart::getDuration(void) const {
 
 
 
+//////////////////////////////
+//
+// MxmlPart::getMinimumTimelineTpq -- Return the smallest number of ticks
+//     per quarter note which can represent the start times and durations
+//     of all measures and events in the part as integers.  This is the
+//     least common multiple of the <divisions> values in the part, unless
+//     durations were corrected to values which are not on that grid.
+//
+
+int MxmlPart::getMinimumTimelineTpq(void) const {
+	set<int> denominators;
+	for (int i=0; i<(int)m_measures.size(); i++) {
+		MxmlMeasure* measure = m_measures[i];
+		denominators.insert(measure->getStartTime().getDenominator());
+		denominators.insert(measure->getDuration().getDenominator());
+		denominators.insert(measure->getTimeSigDur().getDenominator());
+		vector<MxmlEvent*>& events = measure->getEventList();
+		for (int j=0; j<(int)events.size(); j++) {
+			denominators.insert(events[j]->getStartTime().getDenominator());
+			denominators.insert(events[j]->getDuration().getDenominator());
+		}
+	}
+	denominators.erase(1);
+	if (denominators.empty()) {
+		return 1;
+	}
+	vector<int> numbers(denominators.begin(), denominators.end());
+	return Convert::getLcm(numbers);
+}
+
+
+
+//////////////////////////////
+//
+// MxmlPart::getTimelineTpq -- Return the number of ticks per quarter
+//     note of the integer timeline for the part, or 0 if it has not
+//     been set.
+//
+
+int MxmlPart::getTimelineTpq(void) const {
+	return m_timelinetpq;
+}
+
+
+
+//////////////////////////////
+//
+// MxmlPart::setTimelineTpq -- Assign integer tick times to all measures
+//     and events in the part, and sort the events in each measure by tick
+//     time.  Parts which will be aligned with each other should use the
+//     same tpq (the least common multiple of getMinimumTimelineTpq() for
+//     each part).
+//
+
+void MxmlPart::setTimelineTpq(int tpq) {
+	if (tpq < 1) {
+		tpq = 1;
+	}
+	m_timelinetpq = tpq;
+	for (int i=0; i<(int)m_measures.size(); i++) {
+		m_measures[i]->setTickTimeline(tpq);
+	}
+}
+
+
+
 //////////////////////////////
 //
 // MxmlPart::setPartNumber -- Set the part number for the part.  Typically
@@ -29751,6 +33499,19 @@ NoteCell::NoteCell(NoteGrid* owner, HTp token) {
 }
 
 
+//
+// b40 is the base-40 pitch of the token (or of the note which a null
+//     token refers to), such as from Convert::kernToBase40().
+//
+
+NoteCell::NoteCell(NoteGrid* owner, HTp token, int b40) {
+	clear();
+	m_owner = owner;
+	m_token = token;
+	setNumericPitches(b40);
+}
+
+
 
 //////////////////////////////
 //
@@ -29787,13 +33548,27 @@ void NoteCell::calculateNumericPitches(void) {
 		m_accidental = NAN;
 		return;
 	}
+	int b40 = 0;
+	if (!m_token->isRest()) {
+		b40 = Convert::kernToBase40(m_token->resolveNull());
+	}
+	setNumericPitches(b40);
+}
 
+
+
+//////////////////////////////
+//
+// NoteCell::setNumericPitches -- Fills in b7, b12, and b40 variables
+//    from the base-40 pitch of the (resolved) token.
+//
+
+void NoteCell::setNumericPitches(int b40) {
 	bool sustain = m_token->isNull() || m_token->isSecondaryTiedNote();
 	if (m_token->isRest()) {
 		m_b40 = NAN;
 	} else {
-		m_b40 = Convert::kernToBase40(m_token->resolveNull());
-		m_b40 = (sustain ? -m_b40 : m_b40);
+		m_b40 = (sustain ? -b40 : b40);
 	}
 
 	// convert to base-7 (diatonic pitch numbers)
@@ -30241,6 +34016,8 @@ bool NoteGrid::load(HumdrumFile& infile) {
 	int attack = 0;
 	int track, lasttrack;
 	vector<HTp> current;
+	vector<HTp> resolved;
+	vector<int> b40s;
 	HumRegex hre;
 	for (int i=0; i<infile.getLineCount(); i++) {
 		if (infile[i].isInterpretation()) {
@@ -30271,7 +34048,7 @@ bool NoteGrid::load(HumdrumFile& infile) {
 		for (int j=0; j<infile[i].getFieldCount(); j++) {
 			lasttrack = track;
 			track = infile.token(i, j)->getTrack();
-			if (!infile[i].token(j)->isDataType("**kern")) {
+			if (!infile[i].token(j)->isKern()) {
 				continue;
 			}
 			if (track == lasttrack) {
@@ -30289,8 +34066,13 @@ bool NoteGrid::load(HumdrumFile& infile) {
 			     << " compared to " << kernspines.size() << endl;
 			return false;
 		}
+		resolved.resize(current.size());
+		for (int j=0; j<(int)current.size(); j++) {
+			resolved[j] = current[j]->resolveNull();
+		}
+		Convert::kernToBase40(resolved, b40s);
 		for (int j=0; j<(int)current.size(); j++) {
-			NoteCell* cell = new NoteCell(this, current[j]);
+			NoteCell* cell = new NoteCell(this, current[j], b40s[j]);
 			track = current[j]->getTrack();
 			cell->setVoiceIndex(j);
 			cell->setSliceIndex((int)grid[j].size());
@@ -31069,6 +34851,59 @@ ostream& Option_register::print(ostream& out) {
 
 
 
+///////////////////////////////////////////////////////////////////////////
+//
+// Option_value class function definitions.
+//
+
+//////////////////////////////
+//
+// Option_value::set -- Set the option string and the numeric
+//     versions of it.  Integers can be in hexadecimal, decimal, and
+//     octal written in standard C syntax.
+//
+
+void Option_value::set(const string& aString) {
+	text = aString;
+	modifiedQ = true;
+	intValue = (int)strtol(aString.c_str(), (char**)NULL, 0);
+	doubleValue = strtod(aString.c_str(), (char**)NULL);
+}
+
+
+
+///////////////////////////////////////////////////////////////////////////
+//
+// Option_definitions class function definitions.
+//
+
+//////////////////////////////
+//
+// Option_definitions::getEmpty -- Return the list with no definitions,
+//     which is the starting point for all Options objects.
+//
+
+std::shared_ptr<Option_definitions> Option_definitions::getEmpty(void) {
+	static std::shared_ptr<Option_definitions> empty =
+			std::make_shared<Option_definitions>();
+	return empty;
+}
+
+
+
+//////////////////////////////
+//
+// Option_definitions::getMutex -- Lock for accessing m_next in any list,
+//     since tools can be created in multiple threads.
+//
+
+mutex& Option_definitions::getMutex(void) {
+	static mutex definitionMutex;
+	return definitionMutex;
+}
+
+
+
 ///////////////////////////////////////////////////////////////////////////
 //
 // Options class function definitions.
@@ -31080,11 +34915,12 @@ ostream& Option_register::print(ostream& out) {
 //
 
 Options::Options(void) {
-	// do nothing
+	m_definitions = Option_definitions::getEmpty();
 }
 
 
 Options::Options(int argc, char** argv) {
+	m_definitions = Option_definitions::getEmpty();
 	setOptions(argc, argv);
 }
 
@@ -31093,16 +34929,12 @@ Options::Options(const Options& options) {
 	m_argv = options.m_argv;
 	m_arguments = options.m_arguments;
 	m_optionFlag = options.m_optionFlag;
-	m_optionList = options.m_optionList;
 	m_options_error_checkQ = options.m_options_error_checkQ;
 	m_processedQ = options.m_processedQ;
 	m_suppressQ = options.m_suppressQ;
 	m_optionsArgQ = options.m_optionsArgQ;
-	for (int i=0; i<(int)options.m_optionRegister.size(); i++) {
-		Option_register* orr = new Option_register(*options.m_optionRegister[i]);
-		m_optionRegister.push_back(orr);
-	}
-
+	m_definitions = options.m_definitions;
+	m_values = options.m_values;
 }
 
 
@@ -31130,22 +34962,12 @@ Options& Options::operator=(const Options& options) {
 	m_argv = options.m_argv;
 	m_arguments = options.m_arguments;
 	m_optionFlag = options.m_optionFlag;
-	m_optionList = options.m_optionList;
 	m_options_error_checkQ = options.m_options_error_checkQ;
 	m_processedQ = options.m_processedQ;
 	m_suppressQ = options.m_suppressQ;
 	m_optionsArgQ = options.m_optionsArgQ;
-
-	for (int i=0; i<(int)m_optionRegister.size(); i++) {
-		delete m_optionRegister[i];
-		m_optionRegister[i] = NULL;
-	}
-	m_optionRegister.clear();
-
-	for (int i=0; i<(int)options.m_optionRegister.size(); i++) {
-		Option_register* orr = new Option_register(*options.m_optionRegister[i]);
-		m_optionRegister.push_back(orr);
-	}
+	m_definitions = options.m_definitions;
+	m_values = options.m_values;
 
 	m_error.str("");
 	return *this;
@@ -31186,9 +35008,48 @@ const vector<string>& Options::argv(void) const {
 // option-type :: single charater indicating the option data type.
 // option-default :: default value for option if no given on the command-line.
 //
+// The definitions are shared between all Options objects which define
+// the same options in the same order, so the definition strings only
+// need to be parsed the first time that a tool class is instantiated.
+// The return value is the index of the option, which can be used to
+// access the option value without looking up the option name.
+//
 
 int Options::define(const string& aDefinition) {
-	Option_register* definitionEntry = NULL;
+	return defineOption(aDefinition, "");
+}
+
+
+int Options::define(const string& aDefinition, const string& aDescription) {
+	return defineOption(aDefinition, aDescription);
+}
+
+
+
+//////////////////////////////
+//
+// Options::defineOption -- Add an option definition to the shared list
+//     of definitions, or move to an existing list which already has
+//     the definition added.
+//
+
+int Options::defineOption(const string& aDefinition,
+		const string& aDescription) {
+	string key = aDefinition;
+	key += '\n';
+	key += aDescription;
+
+	int definitionIndex = (int)m_values.size();
+
+	{
+		lock_guard<mutex> lock(Option_definitions::getMutex());
+		auto it = m_definitions->m_next.find(key);
+		if (it != m_definitions->m_next.end()) {
+			m_definitions = it->second;
+			m_values.push_back(m_definitions->m_defaults.back());
+			return definitionIndex;
+		}
+	}
 
 	// Error if definition string doesn't contain an equals sign
 	auto location = aDefinition.find("=");
@@ -31230,10 +35091,20 @@ int Options::define(const string& aDefinition) {
 		return -1;
 	}
 
-	// Set up space for a option entry in the registry
-	definitionEntry = new Option_register(aDefinition, otype[0], ovalue);
+	// Set up a new list of definitions containing the option
+	std::shared_ptr<Option_definitions> definitions =
+			std::make_shared<Option_definitions>();
+	definitions->m_registers = m_definitions->m_registers;
+	definitions->m_defaults = m_definitions->m_defaults;
+	definitions->m_names = m_definitions->m_names;
 
-	int definitionIndex = (int)m_optionRegister.size();
+	definitions->m_registers.emplace_back(aDefinition, otype[0], ovalue);
+	definitions->m_registers.back().setDescription(aDescription);
+	Option_value value;
+	value.set(ovalue);
+	value.text.clear();
+	value.modifiedQ = false;
+	definitions->m_defaults.push_back(value);
 
 	// Store option aliases
 	string optionName;
@@ -31242,15 +35113,16 @@ int Options::define(const string& aDefinition) {
 		if (::isspace(aliases[i])) {
 			continue;
 		} else if (aliases[i] == '|') {
-			if (isDefined(optionName)) {
+			auto it = definitions->m_names.find(optionName);
+			if (it != definitions->m_names.end()) {
 				m_error << "Option \"" << optionName << "\" from definition:" << endl;
 				m_error << "\t" << aDefinition << endl;
 				m_error << "is already defined in: " << endl;
-				m_error << "\t" << getDefinition(optionName) << endl;
+				m_error << "\t" << definitions->m_registers[it->second].getDefinition() << endl;
 				return -1;
 			}
 			if (optionName.size() > 0) {
-				m_optionList[optionName] = definitionIndex;
+				definitions->m_names[optionName] = definitionIndex;
 			}
 			optionName.clear();
 		} else {
@@ -31258,21 +35130,19 @@ int Options::define(const string& aDefinition) {
 		}
 	}
 
-	// Store definition in registry and return its indexed location.
-	// This location will be used to link option aliases to the main
-	// command name.
-	m_optionRegister.push_back(definitionEntry);
+	// Store the new list so that it can be reused by other objects.
+	// If another thread added the same definition in the meantime,
+	// use its list instead.
+	{
+		lock_guard<mutex> lock(Option_definitions::getMutex());
+		auto result = m_definitions->m_next.emplace(key, definitions);
+		m_definitions = result.first->second;
+	}
+	m_values.push_back(m_definitions->m_defaults.back());
 	return definitionIndex;
 }
 
 
-int Options::define(const string& aDefinition, const string& aDescription) {
-	int index = define(aDefinition);
-	m_optionRegister[index]->setDescription(aDescription);
-	return index;
-}
-
-
 
 //////////////////////////////
 //
@@ -31280,7 +35150,7 @@ int Options::define(const string& aDefinition, const string& aDescription) {
 //
 
 int Options::isDefined(const string& name) {
-	if (m_optionList.find(name) == m_optionList.end()) {
+	if (m_definitions->m_names.find(name) == m_definitions->m_names.end()) {
 		return 0;
 	} else {
 		return 1;
@@ -31363,11 +35233,15 @@ vector<string>& Options::getArgumentList(vector<string>& output) {
 //
 
 bool Options::getBoolean(const string& optionName) {
-	int index = getRegIndex(optionName);
-	if (index < 0) {
+	return getBoolean(getRegIndex(optionName));
+}
+
+
+bool Options::getBoolean(int index) {
+	if ((index < 0) || (index >= (int)m_values.size())) {
 		return 0;
 	}
-	return m_optionRegister[index]->isModified();
+	return m_values[index].modifiedQ;
 }
 
 
@@ -31417,11 +35291,11 @@ string Options::getCommandLine(void) {
 //
 
 string Options::getDefinition(const string& optionName) {
-	auto it = m_optionList.find(optionName);
-	if (it == m_optionList.end()) {
+	auto it = m_definitions->m_names.find(optionName);
+	if (it == m_definitions->m_names.end()) {
 		return "";
 	} else {
-		return m_optionRegister[it->second]->getDefinition();
+		return m_definitions->m_registers[it->second].getDefinition();
 	}
 }
 
@@ -31435,7 +35309,15 @@ string Options::getDefinition(const string& optionName) {
 //
 
 double Options::getDouble(const string& optionName) {
-	return strtod(getString(optionName).c_str(), (char**)NULL);
+	return getDouble(getRegIndex(optionName));
+}
+
+
+double Options::getDouble(int index) {
+	if ((index < 0) || (index >= (int)m_values.size())) {
+		return 0.0;
+	}
+	return m_values[index].doubleValue;
 }
 
 
@@ -31472,7 +35354,15 @@ float Options::getFloat(const string& optionName) {
 //
 
 int Options::getInt(const string& optionName) {
-	return (int)strtol(getString(optionName).c_str(), (char**)NULL, 0);
+	return getInt(getRegIndex(optionName));
+}
+
+
+int Options::getInt(int index) {
+	if ((index < 0) || (index >= (int)m_values.size())) {
+		return 0;
+	}
+	return m_values[index].intValue;
 }
 
 int Options::getInteger(const string& optionName) {
@@ -31480,6 +35370,11 @@ int Options::getInteger(const string& optionName) {
 }
 
 
+int Options::getInteger(int index) {
+	return getInt(index);
+}
+
+
 
 //////////////////////////////
 //
@@ -31487,16 +35382,38 @@ int Options::getInteger(const string& optionName) {
 //
 
 string Options::getString(const string& optionName) {
-	int index = getRegIndex(optionName);
-	if (index < 0) {
+	return getString(getRegIndex(optionName));
+}
+
+
+string Options::getString(int index) {
+	if ((index < 0) || (index >= (int)m_values.size())) {
 		return "UNKNOWN OPTION";
+	} else if (m_values[index].modifiedQ) {
+		return m_values[index].text;
 	} else {
-		return m_optionRegister[index]->getOption();
+		return m_definitions->m_registers[index].getDefault();
 	}
 }
 
 
 
+//////////////////////////////
+//
+// Options::getIndex -- Return the index of an option (the same value
+//     which is returned by define()), or -1 if the option is not defined.
+//
+
+int Options::getIndex(const string& optionName) {
+	auto it = m_definitions->m_names.find(optionName);
+	if (it == m_definitions->m_names.end()) {
+		return -1;
+	}
+	return it->second;
+}
+
+
+
 //////////////////////////////
 //
 // Options::optionsArg -- Return true if --options is present
@@ -31515,9 +35432,10 @@ int Options::optionsArg(void) {
 //
 
 ostream& Options::print(ostream& out) {
-	for (unsigned int i=0; i<m_optionRegister.size(); i++) {
-		out << m_optionRegister[i]->getDefinition() << "\t"
-			  << m_optionRegister[i]->getDescription() << endl;
+	vector<Option_register>& registers = m_definitions->m_registers;
+	for (unsigned int i=0; i<registers.size(); i++) {
+		out << registers[i].getDefinition() << "\t"
+			  << registers[i].getDescription() << endl;
 	}
 	return out;
 }
@@ -31533,11 +35451,8 @@ void Options::reset(void) {
 	m_argv.clear();
 	m_arguments.clear();
 
-	for (int i=0; i<(int)m_optionRegister.size(); i++) {
-		delete m_optionRegister[i];
-		m_optionRegister[i] = NULL;
-	}
-	m_optionRegister.clear();
+	m_definitions = Option_definitions::getEmpty();
+	m_values.clear();
 }
 
 
@@ -31573,12 +35488,15 @@ void Options::setFlag(char aFlag) {
 //
 
 void Options::setModified(const string& optionName, const string& aString) {
-	int index = getRegIndex(optionName);
-	if (index < 0) {
+	setModified(getRegIndex(optionName), aString);
+}
+
+
+void Options::setModified(int index, const string& aString) {
+	if ((index < 0) || (index >= (int)m_values.size())) {
 		return;
 	}
-
-	m_optionRegister[getRegIndex(optionName)]->setModified(aString);
+	m_values[index].set(aString);
 }
 
 
@@ -31737,7 +35655,7 @@ char Options::getType(const string& optionName) {
 	if (index < 0) {
 		return -1;
 	} else {
-		return m_optionRegister[getRegIndex(optionName)]->getType();
+		return m_definitions->m_registers[index].getType();
 	}
 }
 
@@ -31863,8 +35781,8 @@ int Options::getRegIndex(const string& optionName) {
 		return -1;
 	}
 
-	auto it = m_optionList.find(optionName);
-	if (it == m_optionList.end()) {
+	auto it = m_definitions->m_names.find(optionName);
+	if (it == m_definitions->m_names.end()) {
 		if (m_options_error_checkQ) {
 			m_error << "Error: unknown option \"" << optionName << "\"." << endl;
 			print(cout);
@@ -32015,7 +35933,9 @@ int Options::storeOption(int index, int& position, int& running) {
 //
 
 ostream& Options::printOptionList(ostream& out) {
-	for (auto it = m_optionList.begin(); it != m_optionList.end(); it++) {
+	map<string, int> names(m_definitions->m_names.begin(),
+			m_definitions->m_names.end());
+	for (auto it = names.begin(); it != names.end(); it++) {
 		out << it->first << "\t" << it->second << endl;
 	}
 	return out;
@@ -32029,9 +35949,11 @@ ostream& Options::printOptionList(ostream& out) {
 //
 
 ostream& Options::printOptionListBooleanState(ostream& out) {
-	for (auto it = m_optionList.begin(); it != m_optionList.end(); it++) {
+	map<string, int> names(m_definitions->m_names.begin(),
+			m_definitions->m_names.end());
+	for (auto it = names.begin(); it != names.end(); it++) {
 		out << it->first << "\t"
-			 << m_optionRegister[it->second]->isModified() << endl;
+			 << m_values[it->second].modifiedQ << endl;
 	}
 	return out;
 }
@@ -32044,8 +35966,12 @@ ostream& Options::printOptionListBooleanState(ostream& out) {
 //
 
 ostream& Options::printRegister(ostream& out) {
-	for (auto it = m_optionRegister.begin(); it != m_optionRegister.end(); it++) {
-		(*it)->print(out);
+	for (int i=0; i<(int)m_values.size(); i++) {
+		Option_register reg = m_definitions->m_registers[i];
+		if (m_values[i].modifiedQ) {
+			reg.setModified(m_values[i].text);
+		}
+		reg.print(out);
 	}
 	return out;
 }
@@ -32204,7 +36130,7 @@ void Tool_autobeam::removeBeams(HumdrumFile& infile) {
 			}
 			if (bfound) {
 				((string)(*token))[0] = 'X';
-				token->swap(newstr);
+				token->setText(newstr);
 			}
 			token = token->getNextToken();
 		}
@@ -32439,6 +36365,7 @@ Tool_autostem::Tool_autostem(void) {
 	define("u|up=b",          "Middle note on staff has stem up");
 	define("p|pos=b",         "Display only note vertical positions on staves");
 	define("v|voice=b",       "Display only voice/layer information");
+	define("csv=b",           "Print -p or -v analysis as CSV data");
 	define("author=b",        "Program author");
 	define("version=b",       "Program version");
 	define("example=b",       "Program examples");
@@ -32500,6 +36427,13 @@ bool Tool_autostem::run(HumdrumFile& infile) {
 		}
 	}
 	autostem(infile);
+	if (getBoolean("csv")) {
+		if (infile.getAnalysisColumnCount() > 0) {
+			infile.printAnalysisCsv(m_free_text);
+		}
+	} else {
+		infile.renderAnalysisColumns();
+	}
 	// Re-load the text for each line from their tokens.
 	infile.createLinesFromTokens();
 	return true;
@@ -33014,7 +36948,7 @@ void Tool_autostem::printVoiceInfo(HumdrumFile& infile,
 			voiceinfo[i].pop_back();
 		}
 	}
-	infile.appendDataSpine(voiceinfo, "", "**voice");
+	infile.addAnalysisColumn(voiceinfo, "", "**voice");
 }
 
 
@@ -33068,7 +37002,7 @@ void Tool_autostem::printNotePositions(HumdrumFile& infile,
 			}
 		}
 	}
-	infile.appendDataSpine(posinfo, "", "**vpos");
+	infile.addAnalysisColumn(posinfo, "", "**vpos");
 }
 
 
@@ -33685,6 +37619,8 @@ void Tool_autostem::countBeamStuff(const string& token, int& start, int& stop,
 Tool_binroll::Tool_binroll(void) {
 	// add options here
 	define("t|timebase=s:16", "timebase to do analysis at");
+	define("f|format=s:text", "output format: text, bits (raw bitplanes) or npy");
+	define("shard=s", "write rolls of all input files to one file; print index of file offsets");
 }
 
 
@@ -33727,8 +37663,86 @@ bool Tool_binroll::run(HumdrumFile& infile, ostream& out) {
 
 
 bool Tool_binroll::run(HumdrumFile& infile) {
-	m_duration.setValue(1, 4); // 16th note
-	processFile(infile);
+	if (!initialize()) {
+		return false;
+	}
+	processFile(infile, m_free_text);
+	return true;
+}
+
+
+//
+// Streaming interface: each file is read, analyzed and printed directly
+// to the output stream before the next file is read, so the output is
+// not stored in memory.  If the --shard option is given, the rolls for
+// all files are written to a single file, and a list of the files with
+// the index of their first time slice and the slice count is printed.
+//
+
+bool Tool_binroll::run(HumdrumFileStream& instream, ostream& out) {
+	if (!initialize()) {
+		return false;
+	}
+	if (!getBoolean("shard")) {
+		while (true) {
+			HumdrumFile infile;
+			if (!instream.getFile(infile)) {
+				break;
+			}
+			processFile(infile, out);
+		}
+		return true;
+	}
+
+	string filename = getString("shard");
+	ofstream shard(filename, ios::binary);
+	if (!shard.is_open()) {
+		m_error_text << "Error: cannot write shard file " << filename << endl;
+		return false;
+	}
+	if (m_format == "npy") {
+		// Shape is not known yet, so store a placeholder header which
+		// is rewritten at the end.
+		printNpyHeader(shard, 0);
+	}
+
+	int64_t offset = 0;
+	while (true) {
+		HumdrumFile infile;
+		if (!instream.getFile(infile)) {
+			break;
+		}
+		fillRoll(infile);
+		printRollData(shard);
+		out << infile.getFilename() << '\t' << offset << '\t' << m_slicecount << '\n';
+		offset += m_slicecount;
+	}
+
+	if (m_format == "npy") {
+		shard.seekp(0);
+		printNpyHeader(shard, offset);
+	}
+	shard.close();
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_binroll::initialize -- Process the command-line options.
+//
+
+bool Tool_binroll::initialize(void) {
+	m_duration = Convert::recipToDuration(getString("timebase"));
+	if (m_duration <= 0) {
+		m_duration.setValue(1, 4); // 16th note
+	}
+	m_format = getString("format");
+	if ((m_format != "text") && (m_format != "bits") && (m_format != "npy")) {
+		m_error_text << "Error: unknown output format " << m_format << endl;
+		return false;
+	}
 	return true;
 }
 
@@ -33739,14 +37753,27 @@ bool Tool_binroll::run(HumdrumFile& infile) {
 // Tool_binroll::processFile --
 //
 
-void Tool_binroll::processFile(HumdrumFile& infile) {
-	vector<vector<char>> output;
-	output.resize(128);
-	int count = (infile.getScoreDuration() / m_duration).getInteger() + 1;
-	for (int i=0; i<(int)output.size(); i++) {
-		output[i].resize(count);
-		std::fill(output[i].begin(), output[i].end(), 0);
+void Tool_binroll::processFile(HumdrumFile& infile, ostream& out) {
+	fillRoll(infile);
+	if (m_format == "text") {
+		printAnalysis(infile, out);
+	} else {
+		printRoll(out);
 	}
+}
+
+
+
+//////////////////////////////
+//
+// Tool_binroll::fillRoll -- Calculate the piano roll for all **kern
+//     strands in the file.
+//
+
+void Tool_binroll::fillRoll(HumdrumFile& infile) {
+	m_slicecount = (infile.getScoreDuration() / m_duration).getInteger() + 1;
+	m_sounding.assign(m_slicecount * 2, 0);
+	m_attacks.assign(m_slicecount * 2, 0);
 
 	int strandcount = infile.getStrandCount();
 	for (int i=0; i<strandcount; i++) {
@@ -33755,28 +37782,182 @@ void Tool_binroll::processFile(HumdrumFile& infile) {
 			continue;
 		}
 		HTp ending = infile.getStrandEnd(i);
-		processStrand(output, starting, ending);
+		processStrand(starting, ending);
 	}
+}
+
 
-	printAnalysis(infile, output);
 
+//////////////////////////////
+//
+// Tool_binroll::setCell -- Set a cell in the piano roll: 0 = off,
+//     1 = sustained note, 2 = note attack.
+//
+
+void Tool_binroll::setCell(int pitch, int index, int value) {
+	if ((index < 0) || (index >= m_slicecount)) {
+		return;
+	}
+	int word = index * 2 + (pitch >> 6);
+	uint64_t bit = (uint64_t)1 << (pitch & 0x3f);
+	if (value) {
+		m_sounding[word] |= bit;
+	} else {
+		m_sounding[word] &= ~bit;
+	}
+	if (value == 2) {
+		m_attacks[word] |= bit;
+	} else {
+		m_attacks[word] &= ~bit;
+	}
 }
 
 
 
 //////////////////////////////
 //
-// Tool_binroll::printAnalysis --
+// Tool_binroll::getCell -- Return the value of a cell in the piano roll:
+//     0 = off, 1 = sustained note, 2 = note attack.
 //
 
-void Tool_binroll::printAnalysis(HumdrumFile& infile,
-		vector<vector<char>>& roll) {
-	HumRegex hre;
+int Tool_binroll::getCell(int pitch, int index) const {
+	int word = index * 2 + (pitch >> 6);
+	int shift = pitch & 0x3f;
+	if ((m_attacks[word] >> shift) & 1) {
+		return 2;
+	}
+	return (m_sounding[word] >> shift) & 1;
+}
 
-	for (int i=0; i<infile.getLineCount(); i++) {
-		if (infile[i].isExclusive()) {
-			break;
+
+
+//////////////////////////////
+//
+// Tool_binroll::printRoll -- Print the piano roll in the output format
+//     (without any Humdrum comments).
+//
+
+void Tool_binroll::printRoll(ostream& out) {
+	if (m_format == "npy") {
+		printNpyHeader(out, m_slicecount);
+	}
+	printRollData(out);
+}
+
+
+
+//////////////////////////////
+//
+// Tool_binroll::printRollData -- Print the time slices of the piano roll
+//     in the output format, without any file header.
+//
+
+void Tool_binroll::printRollData(ostream& out) {
+	if (m_format == "bits") {
+		printBitplanes(out);
+	} else if (m_format == "npy") {
+		printNpyRoll(out);
+	} else {
+		printTextRoll(out);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// Tool_binroll::printTextRoll -- Print one line for each time slice, with
+//     the state of the 128 MIDI keys separated by spaces.
+//
+
+void Tool_binroll::printTextRoll(ostream& out) {
+	string line(128 * 2, ' ');
+	line.back() = '\n';
+	for (int i=0; i<m_slicecount; i++) {
+		for (int j=0; j<128; j++) {
+			line[j * 2] = '0' + getCell(j, i);
 		}
+		out.write(line.data(), line.size());
+	}
+}
+
+
+
+//////////////////////////////
+//
+// Tool_binroll::printBitplanes -- Print 32 bytes for each time slice: 16
+//     bytes for the sounding notes and then 16 bytes for the note attacks.
+//     MIDI key k is stored in bit (k % 8) of byte (k / 8) of each plane.
+//
+
+void Tool_binroll::printBitplanes(ostream& out) {
+	char buffer[32];
+	for (int i=0; i<m_slicecount; i++) {
+		for (int w=0; w<2; w++) {
+			uint64_t sounding = m_sounding[i * 2 + w];
+			uint64_t attacks  = m_attacks[i * 2 + w];
+			for (int b=0; b<8; b++) {
+				buffer[w * 8 + b]      = (char)((sounding >> (b * 8)) & 0xff);
+				buffer[16 + w * 8 + b] = (char)((attacks  >> (b * 8)) & 0xff);
+			}
+		}
+		out.write(buffer, 32);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// Tool_binroll::printNpyHeader -- Print a NumPy .npy (version 1.0) header
+//     for an array of unsigned bytes with the shape (slicecount, 128).
+//     The header is always 128 bytes long, so that it can be rewritten
+//     when the slice count is not known in advance.
+//
+
+void Tool_binroll::printNpyHeader(ostream& out, int64_t slicecount) {
+	string dict = "{'descr': '|u1', 'fortran_order': False, 'shape': (";
+	dict += to_string(slicecount);
+	dict += ", 128), }";
+	int headerlen = 128 - 10;
+	dict.resize(headerlen - 1, ' ');
+	dict += '\n';
+	out.write("\x93NUMPY\x01\x00", 8);
+	out.put((char)(headerlen & 0xff));
+	out.put((char)((headerlen >> 8) & 0xff));
+	out.write(dict.data(), dict.size());
+}
+
+
+
+//////////////////////////////
+//
+// Tool_binroll::printNpyRoll -- Print the roll as a row-major array of
+//     bytes, one row of 128 MIDI keys for each time slice, with the same
+//     values as the text output.
+//
+
+void Tool_binroll::printNpyRoll(ostream& out) {
+	char buffer[128];
+	for (int i=0; i<m_slicecount; i++) {
+		for (int j=0; j<128; j++) {
+			buffer[j] = (char)getCell(j, i);
+		}
+		out.write(buffer, 128);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// Tool_binroll::printComments -- Print lines from the file as comments,
+//     replacing leading "!" characters with "#".
+//
+
+void Tool_binroll::printComments(HumdrumFile& infile, int startline,
+		int endline, ostream& out) {
+	for (int i=startline; i<endline; i++) {
 		if (infile[i].isEmpty()) {
 			continue;
 		}
@@ -33784,24 +37965,35 @@ void Tool_binroll::printAnalysis(HumdrumFile& infile,
 		int found = 0;
 		for (int j=0; j<(int)line.size(); j++) {
 			if ((line[j] == '!') && !found) {
-				m_free_text << "#";
+				out << "#";
 			} else {
 				found = 1;
-				m_free_text << line[j];
+				out << line[j];
 			}
 		}
-		m_free_text << "\n";
+		out << "\n";
 	}
+}
 
-	for (int i=0; i<(int)roll[0].size(); i++) {
-		for (int j=0; j<(int)roll.size(); j++) {
-			m_free_text << (int)roll[j][i];
-			if (j < (int)roll.size() - 1) {
-				m_free_text << ' ';
-			}
+
+
+//////////////////////////////
+//
+// Tool_binroll::printAnalysis -- Print the roll as text, with the
+//     comments before and after the data in the file.
+//
+
+void Tool_binroll::printAnalysis(HumdrumFile& infile, ostream& out) {
+	int endline = infile.getLineCount();
+	for (int i=0; i<infile.getLineCount(); i++) {
+		if (infile[i].isExclusive()) {
+			endline = i;
+			break;
 		}
-		m_free_text << "\n";
 	}
+	printComments(infile, 0, endline, out);
+
+	printTextRoll(out);
 
 	int startindex = infile.getLineCount() - 1;
 	for (int i=infile.getLineCount()-1; i>=0; i--) {
@@ -33811,84 +38003,66 @@ void Tool_binroll::printAnalysis(HumdrumFile& infile,
 		}
 		startindex = i;
 	}
-
-	for (int i=startindex; i<infile.getLineCount(); i++) {
-		if (infile[i].isEmpty()) {
-			continue;
-		}
-		string line = infile[i].getText();
-		int found = 0;
-		for (int j=0; j<(int)line.size(); j++) {
-			if ((line[j] == '!') && !found) {
-				m_free_text << "#";
-			} else {
-				found = 1;
-				m_free_text << line[j];
-			}
-		}
-		m_free_text << "\n";
-	}
+	printComments(infile, startindex, infile.getLineCount(), out);
 }
 
 
 
 //////////////////////////////
 //
-// Tool_binroll::processStrand --
+// Tool_binroll::processStrand -- The notes of the strand are collected
+//     first so that their MIDI pitches can be calculated together.
 //
 
-void Tool_binroll::processStrand(vector<vector<char>>& roll, HTp starting,
-		HTp ending) {
+void Tool_binroll::processStrand(HTp starting, HTp ending) {
+	vector<string> pitches;   // note or chord subtoken
+	vector<HTp> tokens;       // token containing each pitch
+	vector<bool> chords;      // true if the pitch is in a chord
 	HTp current = starting;
-	int base12;
-	HumNum starttime;
-	HumNum duration;
-	int startindex;
-	int endindex;
 	while (current && (current != ending)) {
-		if (!current->isNonNullData()) {
+		if (!current->isNonNullData() || current->isRest()) {
 			current = current->getNextToken();
 			continue;
 		}
-		if (current->isRest()) {
-			current = current->getNextToken();
-			continue;
-		}
-
 		if (current->isChord()) {
 			int stcount = current->getSubtokenCount();
-			starttime = current->getDurationFromStart();
-			startindex = (starttime / m_duration).getInteger();
 			for (int s=0; s<stcount; s++) {
-				string tok = current->getSubtoken(s);
-				base12 = Convert::kernToMidiNoteNumber(tok);
-				if ((base12 < 0) || (base12 > 127)) {
-					continue;
-				}
-				duration = Convert::recipToDuration(tok);
-				endindex = ((starttime+duration) / m_duration).getInteger();
-				roll[base12][startindex] = 2;
-				for (int i=startindex+1; i<endindex; i++) {
-					roll[base12][i] = 1;
-				}
+				pitches.push_back(current->getSubtoken(s));
+				tokens.push_back(current);
+				chords.push_back(true);
 			}
 		} else {
-			base12 = Convert::kernToMidiNoteNumber(current);
-			if ((base12 < 0) || (base12 > 127)) {
-				current = current->getNextToken();
-				continue;
-			}
-			starttime = current->getDurationFromStart();
-			duration = current->getDuration();
-			startindex = (starttime / m_duration).getInteger();
-			endindex   = ((starttime+duration) / m_duration).getInteger();
-			roll[base12][startindex] = 2;
-			for (int i=startindex+1; i<endindex; i++) {
-				roll[base12][i] = 1;
-			}
+			pitches.push_back(*current);
+			tokens.push_back(current);
+			chords.push_back(false);
 		}
 		current = current->getNextToken();
 	}
+
+	vector<int> base12;
+	Convert::kernToMidiNoteNumber(pitches, base12);
+
+	HumNum starttime;
+	HumNum duration;
+	int startindex;
+	int endindex;
+	for (int i=0; i<(int)pitches.size(); i++) {
+		if ((base12[i] < 0) || (base12[i] > 127)) {
+			continue;
+		}
+		starttime = tokens[i]->getDurationFromStart();
+		if (chords[i]) {
+			duration = Convert::recipToDuration(pitches[i]);
+		} else {
+			duration = tokens[i]->getDuration();
+		}
+		startindex = (starttime / m_duration).getInteger();
+		endindex   = ((starttime+duration) / m_duration).getInteger();
+		setCell(base12[i], startindex, 2);
+		for (int j=startindex+1; j<endindex; j++) {
+			setCell(base12[i], j, 1);
+		}
+	}
 }
 
 
@@ -34376,6 +38550,10 @@ Tool_cint::Tool_cint(void) {
 	define("search=s:", "search string");
 	define("mark=b", "mark matches notes from searches in data");
 	define("count=b", "count matched modules from search query");
+	define("index=s:", "write an index of the modules in all input files");
+	define("lookup=s:", "search for --query module in an index file");
+	define("query=s:", "module to find with --lookup, such as \"8 1 5\"");
+	define("j|threads=i:0", "number of threads to use when creating an index");
 	define("debug=b");              // determine bad input line num
 	define("author=b");             // author of program
 	define("version=b");            // compilation info
@@ -34391,6 +38569,10 @@ Tool_cint::Tool_cint(void) {
 //
 
 bool Tool_cint::run(HumdrumFileSet& infiles) {
+	if (getBoolean("index")) {
+		initialize();
+		return buildModuleIndex(infiles, getString("index"));
+	}
 	bool status = true;
 	for (int i=0; i<infiles.getCount(); i++) {
 		status &= run(infiles[i]);
@@ -34521,41 +38703,21 @@ int Tool_cint::processFile(HumdrumFile& infile) {
 	vector<vector<NoteNode> > notes;
 	vector<string> names;
 	vector<int>    ktracks;
-	vector<HTp>    kstarts;
 	vector<int>    reverselookup;
 
-	infile.getSpineStartList(kstarts, "**kern");
-	ktracks.resize(kstarts.size());
-	for (int i=0; i<(int)kstarts.size(); i++) {
-		ktracks[i] = kstarts[i]->getTrack();
-	}
+//	if (locationQ || rhythmQ || durationQ) {
+//		infile.analyzeRhythm();
+//	}
 
-	if (koptionQ) {
-		adjustKTracks(ktracks, getString("koption"));
-	}
-	notes.resize(ktracks.size());
-	reverselookup.resize(infile.getTrackCount()+1);
-	fill(reverselookup.begin(), reverselookup.end(), -1);
+	prepareNoteArray(notes, infile, ktracks, reverselookup);
 
 	vector<vector<string> > retrospective;
 	if (retroQ) {
 		initializeRetrospective(retrospective, infile, ktracks);
 	}
 
-//	if (locationQ || rhythmQ || durationQ) {
-//		infile.analyzeRhythm();
-//	}
-
 	int i;
-	for (i=0; i<(int)ktracks.size(); i++) {
-		reverselookup[ktracks[i]] = i;
-		// notes[i].reserve(infile.getLineCount());
-		notes[i].resize(0);
-	}
-
 	getNames(names, reverselookup, infile);
-	HumRegex pre;
-	extractNoteArray(notes, infile, ktracks, reverselookup);
 
 	if (pitchesQ) {
 		printPitchGrid(notes, infile);
@@ -34605,6 +38767,38 @@ int Tool_cint::processFile(HumdrumFile& infile) {
 
 
 
+//////////////////////////////
+//
+// Tool_cint::prepareNoteArray -- Identify the **kern spines to analyze
+//     and extract their notes into the note array.
+//
+
+void Tool_cint::prepareNoteArray(vector<vector<NoteNode> >& notes,
+		HumdrumFile& infile, vector<int>& ktracks, vector<int>& reverselookup) {
+	vector<HTp> kstarts;
+	infile.getSpineStartList(kstarts, "**kern");
+	ktracks.resize(kstarts.size());
+	for (int i=0; i<(int)kstarts.size(); i++) {
+		ktracks[i] = kstarts[i]->getTrack();
+	}
+
+	if (koptionQ) {
+		adjustKTracks(ktracks, getString("koption"));
+	}
+	notes.resize(ktracks.size());
+	reverselookup.resize(infile.getTrackCount()+1);
+	fill(reverselookup.begin(), reverselookup.end(), -1);
+
+	for (int i=0; i<(int)ktracks.size(); i++) {
+		reverselookup[ktracks[i]] = i;
+		notes[i].resize(0);
+	}
+
+	extractNoteArray(notes, infile, ktracks, reverselookup);
+}
+
+
+
 //////////////////////////////
 //
 // Tool_cint::adjustKTracks -- Select only two spines to do analysis on.
@@ -35023,6 +39217,429 @@ int Tool_cint::printCombinationModulePrepare(ostream& out, const string& filenam
 
 
 
+//////////////////////////////
+//
+// Tool_cint::buildModuleIndex -- Extract the modules for every pair of
+//     voices in all input files and write them to an inverted index:
+//     each line of the index file contains a module (encoded as the
+//     integer intervals of the module) followed by a list of all locations
+//     in the files where the module occurs.  The note arrays of the files
+//     are extracted in parallel, and then all voice pairs are processed in
+//     parallel.  The index can be searched with --lookup and --query.
+//
+//     The module lines are sorted by their text, and are followed by a
+//     table of the byte offsets of the module lines in fixed-width records
+//     (see Tool_cint::getModuleIndexOffset()) and a fixed-width last line
+//     with the byte offset of the table, so that a module can be found
+//     with a binary search.
+//
+
+bool Tool_cint::buildModuleIndex(HumdrumFileSet& infiles,
+		const string& filename) {
+	int filecount = infiles.getCount();
+	int threads = HumParallel::getThreadCount(getInteger("threads"));
+
+	vector<vector<vector<NoteNode> > > notes(filecount);
+	HumParallel::run(filecount, threads, [&](int i) {
+		// Input streams are read without rhythm analysis, but the
+		// modules need the durations of the notes.
+		if (!infiles[i].isRhythmAnalyzed()) {
+			int analysisthreads = infiles[i].getAnalysisThreadCount();
+			infiles[i].setAnalysisThreadCount(1);
+			infiles[i].analyzeRhythmStructure();
+			infiles[i].setAnalysisThreadCount(analysisthreads);
+		}
+		vector<int> ktracks;
+		vector<int> reverselookup;
+		prepareNoteArray(notes[i], infiles[i], ktracks, reverselookup);
+	});
+
+	// One job for each pair of voices in each file:
+	vector<vector<int> > jobs;
+	for (int i=0; i<filecount; i++) {
+		int voices = (int)notes[i].size();
+		for (int j=0; j<voices; j++) {
+			for (int k=j+1; k<voices; k++) {
+				jobs.push_back({i, j, k});
+			}
+		}
+	}
+	vector<vector<pair<vector<int>, string> > > results(jobs.size());
+	HumParallel::run((int)jobs.size(), threads, [&](int i) {
+		int f = jobs[i][0];
+		extractModuleKeys(results[i], infiles[f], notes[f], f, jobs[i][1],
+				jobs[i][2]);
+	});
+
+	// Merge the results in job order so that the index is always the same
+	// regardless of the number of threads.
+	map<string, vector<string> > index;
+	int modulecount = 0;
+	for (int i=0; i<(int)results.size(); i++) {
+		for (int j=0; j<(int)results[i].size(); j++) {
+			index[getModuleKeyString(results[i][j].first)].push_back(results[i][j].second);
+			modulecount++;
+		}
+		results[i].clear();
+	}
+
+	ofstream output(filename.c_str(), ios::binary);
+	if (!output.is_open()) {
+		m_error_text << "Error: cannot write index file " << filename << endl;
+		return false;
+	}
+	output << "!!!cint-index: 2\n";
+	output << "!!!cint-options: " << getModuleIndexSignature() << "\n";
+	for (int i=0; i<filecount; i++) {
+		output << "!!!cint-file: " << infiles[i].getFilename() << "\n";
+	}
+	vector<std::streamoff> offsets;
+	offsets.reserve(index.size());
+	for (auto& entry : index) {
+		offsets.push_back(output.tellp());
+		output << entry.first;
+		for (int i=0; i<(int)entry.second.size(); i++) {
+			output << "\t" << entry.second[i];
+		}
+		output << "\n";
+	}
+	std::streamoff table = output.tellp();
+	for (int i=0; i<(int)offsets.size(); i++) {
+		output << std::setw(m_offsetwidth) << std::setfill('0') << offsets[i] << "\n";
+	}
+	output << m_tablemarker << std::setw(m_offsetwidth) << std::setfill('0') << table << "\n";
+	output.close();
+	if (!output) {
+		m_error_text << "Error: cannot write index file " << filename << endl;
+		return false;
+	}
+
+	m_free_text << "!!cint-index: " << filecount << " files, "
+		<< modulecount << " modules, " << index.size()
+		<< " distinct modules written to " << filename << endl;
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_cint::extractModuleKeys -- Store the encoded modules between two
+//     voices along with their locations for the module index.  A location
+//     is stored as "file:voice1:voice2:measure:loc", where file is the
+//     index of the file in the index header, the voices are numbered in
+//     the same way as the --location option, and loc is the position
+//     of the module in the score in the range from 0.0 to 1.0.
+//
+
+void Tool_cint::extractModuleKeys(vector<pair<vector<int>, string> >& entries,
+		HumdrumFile& infile, vector<vector<NoteNode> >& notes, int fileindex,
+		int part1, int part2) {
+	entries.clear();
+	if (notes.empty()) {
+		return;
+	}
+	// Module text is not needed, so send it to a stream without a buffer.
+	ostream nullout(NULL);
+	vector<vector<string> > retrospective;
+	string filename = infile.getFilename();
+	HumNum scoredur = infile.getScoreDuration();
+	int voices = (int)notes.size();
+	char notemarker;
+	vector<int> key;
+
+	for (int i=0; i<(int)notes[0].size(); i++) {
+		int status = printCombinationModule(nullout, filename, notes, Chaincount,
+				i, part1, part2, retrospective, notemarker, 0, &key);
+		if (!status) {
+			continue;
+		}
+		int line = notes[part1][i].line;
+		double loc = 0.0;
+		if (scoredur > 0) {
+			loc = infile[line].getDurationFromStart().getFloat() /
+					scoredur.getFloat();
+			loc = int(100.0 * loc + 0.5)/100.0;
+		}
+		stringstream location;
+		location << fileindex
+			<< ":" << (voices - part2)
+			<< ":" << (voices - part1)
+			<< ":" << notes[part1][i].measure
+			<< ":" << loc;
+		entries.emplace_back(key, location.str());
+	}
+}
+
+
+
+//////////////////////////////
+//
+// Tool_cint::lookupModuleIndex -- Search for the module given by the
+//     --query option in the index file given by the --lookup option.
+//     Matches are printed in the same format as --search --location.
+//     With the --count option, only the number of matches is printed.
+//     The module line is found with a binary search of the offset table
+//     at the end of the index (see Tool_cint::buildModuleIndex()).
+//
+
+bool Tool_cint::lookupModuleIndex(ostream& out) {
+	initialize();
+	string indexname = getString("lookup");
+	ifstream input(indexname.c_str(), ios::binary);
+	if (!input.is_open()) {
+		m_error_text << "Error: cannot read index file " << indexname << endl;
+		return false;
+	}
+	vector<int> key;
+	if (!parseModuleQuery(key, getString("query"))) {
+		m_error_text << "Error: cannot parse module query \""
+			<< getString("query") << "\"" << endl;
+		return false;
+	}
+	string target = getModuleKeyString(key);
+	string signature = getModuleIndexSignature();
+
+	// Read the header of the index:
+	vector<string> filenames;
+	vector<int> filecounts;
+	int version = 0;
+	string line;
+	while ((input.peek() == '!') && getline(input, line)) {
+		if (line.compare(0, 14, "!!!cint-file: ") == 0) {
+			filenames.push_back(line.substr(14));
+			filecounts.push_back(0);
+		} else if (line.compare(0, 15, "!!!cint-index: ") == 0) {
+			version = atoi(line.substr(15).c_str());
+		} else if (line.compare(0, 17, "!!!cint-options: ") == 0) {
+			if (line.substr(17) != signature) {
+				m_warning_text << "Warning: index " << indexname
+					<< " was created with options \"" << line.substr(17)
+					<< "\" rather than \"" << signature << "\"" << endl;
+			}
+		}
+	}
+
+	// Read the position of the offset table from the last line:
+	std::streamoff table = -1;
+	std::streamoff recordcount = 0;
+	std::streamoff lastsize = (std::streamoff)m_tablemarker.size() + m_offsetwidth + 1;
+	input.clear();
+	input.seekg(0, ios::end);
+	std::streamoff filesize = input.tellg();
+	if ((version >= 2) && (filesize >= lastsize)) {
+		input.seekg(filesize - lastsize);
+		if (getline(input, line) && (line.compare(0, m_tablemarker.size(),
+				m_tablemarker) == 0)) {
+			table = atoll(line.substr(m_tablemarker.size()).c_str());
+			recordcount = (filesize - lastsize - table) / (m_offsetwidth + 1);
+		}
+	}
+	if ((table < 0) || (recordcount < 0)) {
+		m_error_text << "Error: " << indexname << " has no module table "
+			<< "(rebuild it with --index)" << endl;
+		return false;
+	}
+
+	// Binary search of the module lines:
+	std::streamoff found = -1;
+	std::streamoff low = 0;
+	std::streamoff high = recordcount - 1;
+	string linekey;
+	while (low <= high) {
+		std::streamoff middle = low + (high - low) / 2;
+		std::streamoff offset = getModuleIndexOffset(input, table, middle);
+		if (offset < 0) {
+			m_error_text << "Error: invalid module table in " << indexname << endl;
+			return false;
+		}
+		input.seekg(offset);
+		getline(input, linekey, '\t');
+		int compare = linekey.compare(target);
+		if (compare == 0) {
+			found = offset;
+			break;
+		} else if (compare < 0) {
+			low = middle + 1;
+		} else {
+			high = middle - 1;
+		}
+	}
+
+	int count = 0;
+	if (found >= 0) {
+		input.clear();
+		input.seekg(found);
+		getline(input, line);
+		size_t tab = line.find('\t');
+		stringstream postings(tab == string::npos ? "" : line.substr(tab + 1));
+		string posting;
+		while (getline(postings, posting, '\t')) {
+			int fileindex;
+			int voice1;
+			int voice2;
+			int measure;
+			double loc;
+			char colon;
+			stringstream fields(posting);
+			fields >> fileindex >> colon >> voice1 >> colon >> voice2
+				>> colon >> measure >> colon >> loc;
+			if (fields.fail() || (fileindex < 0) ||
+					(fileindex >= (int)filenames.size())) {
+				m_warning_text << "Warning: invalid index entry " << posting << endl;
+				continue;
+			}
+			count++;
+			filecounts[fileindex]++;
+			if (!countQ) {
+				out << "!!LOCATION:"
+					<< "\t"  << loc
+					<< "\tm" << measure
+					<< "\tv" << voice1
+					<< ":v"  << voice2
+					<< "\t"  << filenames[fileindex]
+					<< endl;
+			}
+		}
+	}
+
+	if (countQ) {
+		if (filenameQ) {
+			for (int i=0; i<(int)filenames.size(); i++) {
+				if (filecounts[i]) {
+					out << filecounts[i] << "\t" << filenames[i] << endl;
+				}
+			}
+		} else {
+			out << count << endl;
+		}
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_cint::getModuleIndexOffset -- Return the byte offset of a module
+//     line in an index file from the given record of the offset table,
+//     or -1 if the record cannot be read.
+//
+
+std::streamoff Tool_cint::getModuleIndexOffset(istream& input,
+		std::streamoff table, std::streamoff record) {
+	input.clear();
+	input.seekg(table + record * (m_offsetwidth + 1));
+	string text(m_offsetwidth, '\0');
+	if (!input.read(&text[0], m_offsetwidth)) {
+		return -1;
+	}
+	return atoll(text.c_str());
+}
+
+
+
+//////////////////////////////
+//
+// Tool_cint::getModuleIndexSignature -- Return a list of the options which
+//     change the contents of modules.  This is stored in module index
+//     files, since queries must use the same options as the index.
+//
+
+string Tool_cint::getModuleIndexSignature(void) {
+	stringstream output;
+	output << "-n " << Chaincount;
+	if (base40Q) {
+		output << " --40";
+	} else if (base12Q) {
+		output << " --12";
+	}
+	if (zeroQ)       { output << " -z"; }
+	if (attackQ)     { output << " --attacks"; }
+	if (uncrossQ)    { output << " -c"; }
+	if (octaveQ)     { output << " -o"; }
+	if (octaveallQ)  { output << " -O"; }
+	if (noharmonicQ) { output << " -H"; }
+	if (nomelodicQ)  { output << " -M"; }
+	if (norestsQ)    { output << " -R"; }
+	if (nounisonsQ)  { output << " -U"; }
+	if (topQ)        { output << " -t"; }
+	if (toponlyQ)    { output << " -T"; }
+	if (sustainQ)    { output << " -s"; }
+	if (xoptionQ)    { output << " -x"; }
+	if (koptionQ)    { output << " -k " << getString("koption"); }
+	return output.str();
+}
+
+
+
+//////////////////////////////
+//
+// Tool_cint::getModuleKeyString -- Convert an encoded module into the
+//     text form used in index files: a comma-separated list of integers.
+//
+
+string Tool_cint::getModuleKeyString(const vector<int>& key) {
+	string output;
+	for (int i=0; i<(int)key.size(); i++) {
+		if (i > 0) {
+			output += ',';
+		}
+		output += to_string(key[i]);
+	}
+	return output;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_cint::parseModuleQuery -- Convert a module written in the same form
+//     as the --raw output (such as "7xs 1 6sx -2 8xx") into the integer
+//     encoding used in index files.  Intervals may be separated by spaces
+//     or commas, and "R" is used for rests.  Returns false if the query
+//     cannot be parsed.
+//
+
+bool Tool_cint::parseModuleQuery(vector<int>& key, const string& query) {
+	key.clear();
+	HumRegex hre;
+	vector<string> tokens;
+	hre.split(tokens, query, "[\\s,]+");
+	for (int i=0; i<(int)tokens.size(); i++) {
+		if (tokens[i].empty()) {
+			continue;
+		}
+		if (tokens[i] == RESTSTRING) {
+			key.push_back(RESTINT);
+			continue;
+		}
+		if (!hre.search(tokens[i], "^(-?\\d+)([sx])?([sx])?$")) {
+			return false;
+		}
+		int interval = hre.getMatchInt(1);
+		string state1 = hre.getMatch(2);
+		string state2 = hre.getMatch(3);
+		if (!state1.empty()) {
+			if (state2.empty()) {
+				return false;
+			}
+			int state = 0;
+			if (state1 == "s") {
+				state |= 2;
+			}
+			if (state2 == "s") {
+				state |= 1;
+			}
+			interval = interval * 4 + state;
+		}
+		key.push_back(interval);
+	}
+	return !key.empty();
+}
+
+
+
 //////////////////////////////
 //
 // Tool_cint::getMeasure -- return the last measure number of the given line index.
@@ -35324,9 +39941,12 @@ int Tool_cint::getOctaveAdjustForCombinationModule(vector<vector<NoteNode> >& no
 int Tool_cint::printCombinationModule(ostream& out, const string& filename,
 		vector<vector<NoteNode> >& notes, int n, int startline, int part1,
 		int part2, vector<vector<string> >& retrospective, char& notemarker,
-		int markstate) {
+		int markstate, vector<int>* key) {
 
 	notemarker = '\0';
+	if (key) {
+		key->clear();
+	}
 
 	if (norestsQ) {
 		if (notes[part1][startline].b40 == 0) {
@@ -35448,6 +40068,10 @@ int Tool_cint::printCombinationModule(ostream& out, const string& filename,
 			if (!toponlyQ) {
 				printInterval((*outp), notes[part1][lastindex],
 						notes[part1][i], INTERVAL_MELODIC);
+				if (key) {
+					addIntervalToKey(*key, notes[part1][lastindex],
+							notes[part1][i], INTERVAL_MELODIC);
+				}
 				if (mmarkerQ) {
 					(*outp) << "m";
 				}
@@ -35461,6 +40085,10 @@ int Tool_cint::printCombinationModule(ostream& out, const string& filename,
 				// top melodic interval:
 				printInterval((*outp), notes[part2][lastindex],
 						notes[part2][i], INTERVAL_MELODIC);
+				if (key) {
+					addIntervalToKey(*key, notes[part2][lastindex],
+							notes[part2][i], INTERVAL_MELODIC);
+				}
 				if (mmarkerQ) {
 					(*outp) << "m";
 				}
@@ -35488,6 +40116,10 @@ int Tool_cint::printCombinationModule(ostream& out, const string& filename,
 				//      notes[part2][i], INTERVAL_HARMONIC, octaveadjust);
 				printInterval((*outp), notes[part1][i],
 						notes[part2][i], INTERVAL_HARMONIC, octaveadjust);
+				if (key) {
+					addIntervalToKey(*key, notes[part1][i], notes[part2][i],
+							INTERVAL_HARMONIC, octaveadjust);
+				}
 			}
 
 			if (durationQ) {
@@ -36169,12 +40801,60 @@ int Tool_cint::printInterval(ostream& out, NoteNode& note1, NoteNode& note2,
 		return 0;
 	}
 	int cross = 0;
+	if ((type == INTERVAL_HARMONIC) && (abs(note2.b40) < abs(note1.b40))) {
+		cross = 1;
+	}
+	int interval = getIntervalNumber(note1, note2, type, octaveadjust);
+
+	if (chromaticQ) {
+		out << Convert::base40ToIntervalAbbr(interval);
+	} else {
+		int negative = 1;
+		if (interval < 0) {
+			negative = -1;
+			interval = -interval;
+		}
+		if (base7Q && !zeroQ) {
+			out << negative * (interval+1);
+		} else {
+			out << negative * interval;
+		}
+	}
+
+	if (sustainQ || ((type == INTERVAL_HARMONIC) && xoptionQ)) {
+		// print sustain/attack information of intervals.
+		if (note1.b40 < 0) {
+			out << "s";
+		} else {
+			out << "x";
+		}
+		if (note2.b40 < 0) {
+			out << "s";
+		} else {
+			out << "x";
+		}
+	}
+
+	return cross;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_cint::getIntervalNumber -- Return the interval between two
+//     (non-rest) notes in the current interval system.  Diatonic intervals
+//     are returned as zero-offset values, and chromatic intervals are
+//     returned in base-40.
+//
+
+int Tool_cint::getIntervalNumber(NoteNode& note1, NoteNode& note2,
+		int type, int octaveadjust) {
 	int pitch1 = abs(note1.b40);
 	int pitch2 = abs(note2.b40);
 	int interval = pitch2 - pitch1;
 
 	if ((type == INTERVAL_HARMONIC) && (interval < 0)) {
-		cross = 1;
 		if (uncrossQ) {
 			interval = -interval;
 		}
@@ -36232,37 +40912,40 @@ int Tool_cint::printInterval(ostream& out, NoteNode& note1, NoteNode& note2,
 		interval = interval + octaveadjust  * 7;
 	}
 
+	return interval;
+}
+
 
-	if (chromaticQ) {
-		out << Convert::base40ToIntervalAbbr(interval);
-	} else {
-		int negative = 1;
-		if (interval < 0) {
-			negative = -1;
-			interval = -interval;
-		}
-		if (base7Q && !zeroQ) {
-			out << negative * (interval+1);
-		} else {
-			out << negative * interval;
-		}
-	}
 
+//////////////////////////////
+//
+// Tool_cint::addIntervalToKey -- Append an interval to the integer
+//     encoding of a module which is used by the module index.  The key
+//     contains the interval numbers as they would be printed.  Attack/sustain
+//     markers ("xs") are stored in the two low bits of the interval number.
+//
+
+void Tool_cint::addIntervalToKey(vector<int>& key, NoteNode& note1,
+		NoteNode& note2, int type, int octaveadjust) {
+	if ((note1.b40 == REST) || (note2.b40 == REST)) {
+		key.push_back(RESTINT);
+		return;
+	}
+	int interval = getIntervalNumber(note1, note2, type, octaveadjust);
+	if (base7Q && !zeroQ) {
+		interval = (interval < 0) ? interval - 1 : interval + 1;
+	}
 	if (sustainQ || ((type == INTERVAL_HARMONIC) && xoptionQ)) {
-		// print sustain/attack information of intervals.
+		int state = 0;
 		if (note1.b40 < 0) {
-			out << "s";
-		} else {
-			out << "x";
+			state |= 2;
 		}
 		if (note2.b40 < 0) {
-			out << "s";
-		} else {
-			out << "x";
+			state |= 1;
 		}
+		interval = interval * 4 + state;
 	}
-
-	return cross;
+	key.push_back(interval);
 }
 
 
@@ -36549,11 +41232,8 @@ void Tool_cint::extractNoteArray(vector<vector<NoteNode> >& notes, HumdrumFile&
 
 	HumRegex hre;
 
-	Ids.resize(infile.getTrackCount()+1);
+	vector<string> ids(infile.getTrackCount()+1, EMPTY_ID);
 	int i, j, ii, jj;
-	for (i=0; i<(int)Ids.size(); i++) {
-		Ids[i] = EMPTY_ID;
-	}
 
 	vector<NoteNode> current(ktracks.size());
 	vector<double> beatsizes(infile.getTrackCount()+1, 1);
@@ -36615,7 +41295,7 @@ void Tool_cint::extractNoteArray(vector<vector<NoteNode> >& notes, HumdrumFile&
 			for (j=0; j<infile[i].getFieldCount(); j++) {
 				if (hre.search(*infile.token(i, j), "^!ID:\\s*([^\\s]*)")) {
 					int track = infile.token(i, j)->getTrack();
-					Ids[track] = hre.getMatch(1);
+					ids[track] = hre.getMatch(1);
 				}
 			}
 		}
@@ -36635,8 +41315,8 @@ void Tool_cint::extractNoteArray(vector<vector<NoteNode> >& notes, HumdrumFile&
 				continue;
 			}
 			if (idQ) {
-				current[index].getId() = Ids[track];
-				Ids[track] = "";  // don't assign to next item;
+				current[index].getId() = ids[track];
+				ids[track] = "";  // don't assign to next item;
 			}
 			current[index].line  = i;
 			current[index].spine = j;
@@ -37001,6 +41681,12 @@ void Tool_cint::initialize(void) {
 		SearchString = getString("search");
 	}
 
+	if (getBoolean("index") || getBoolean("lookup")) {
+		// Modules are stored as interval numbers in index files.
+		chromaticQ = 0;
+		idQ = 0;
+	}
+
 }
 
 
@@ -37296,6 +41982,9 @@ Tool_dissonant::Tool_dissonant(void) {
 	define("debug=b",                 "print grid cell information");
 	define("u|undirected=b",          "use undirected dissonance labels");
 	define("c|count=b",               "count dissonances by category");
+	define("filename=b",              "print filename before the analysis of each file");
+	define("csv=b",                   "print analysis as CSV data rather than adding spines");
+	define("j|threads=i:0",           "number of files to analyze at the same time");
 	define("i|x|e|exinterp=s:**cdata","specify exinterp for **cdata spine");
 	define("color|colorize|color-by-rhythm=b", "color dissonant notes by beat level");
 	define("color2|colorize2|color-by-interval=b", "color dissonant notes by dissonant interval");
@@ -37317,6 +42006,107 @@ bool Tool_dissonant::run(HumdrumFileSet& infiles) {
 }
 
 
+//
+// Batch processing of a stream of files: groups of files are analyzed in
+// parallel, and the results are stored in the order of the input files.
+//
+
+bool Tool_dissonant::run(HumdrumFileStream& instream) {
+	int threads = HumParallel::getThreadCount(getInteger("threads"));
+	int batchsize = threads * 4;
+	bool filenameQ = getBoolean("filename");
+	bool status = true;
+
+	while (true) {
+		HumdrumFileSet infiles;
+		for (int i=0; i<batchsize; i++) {
+			HumdrumFile* infile = new HumdrumFile;
+			if (!instream.getFile(*infile)) {
+				delete infile;
+				break;
+			}
+			infiles.appendHumdrumPointer(infile);
+		}
+		if (infiles.getCount() == 0) {
+			break;
+		}
+		status &= analyzeFiles(infiles, false, filenameQ);
+	}
+
+	return status;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_dissonant::printCountAnalysisForFiles -- Print the dissonance label
+//     counts of each file in the set (see printCountAnalysis()), with a
+//     !!!!SEGMENT record giving the filename before each count table.
+//     The files are analyzed in parallel.
+//
+
+bool Tool_dissonant::printCountAnalysisForFiles(HumdrumFileSet& infiles) {
+	return analyzeFiles(infiles, true, true);
+}
+
+
+
+//////////////////////////////
+//
+// Tool_dissonant::analyzeFiles -- Analyze the files of a set in parallel
+//     and store the output of each file in the order of the set.  If
+//     countQ is true, the label counts are printed as with the -c option.
+//     If filenameQ is true, a !!!!SEGMENT record is added before the
+//     output of each file.
+//
+
+bool Tool_dissonant::analyzeFiles(HumdrumFileSet& infiles, bool countQ,
+		bool filenameQ) {
+	int threads = HumParallel::getThreadCount(getInteger("threads"));
+	if (getBoolean("debug")) {
+		// keep debugging messages for each file together
+		threads = 1;
+	}
+
+	int count = infiles.getCount();
+	vector<string> output(count);
+	vector<string> warnings(count);
+	vector<char> statuses(count, 1);
+	HumParallel::run(count, threads, [&](int i) {
+		// Each file is analyzed with a separate copy of the tool, since
+		// the analysis stores information about the current file.
+		Tool_dissonant worker;
+		static_cast<Options&>(worker) = static_cast<const Options&>(*this);
+		worker.m_countQ = countQ;
+		int analysisthreads = infiles[i].getAnalysisThreadCount();
+		infiles[i].setAnalysisThreadCount(1);
+		statuses[i] = worker.run(infiles[i]);
+		infiles[i].setAnalysisThreadCount(analysisthreads);
+		stringstream out;
+		if (filenameQ) {
+			out << "!!!!SEGMENT: " << infiles[i].getFilename() << "\n";
+		}
+		if (worker.hasAnyText()) {
+			worker.getAllText(out);
+		} else {
+			out << infiles[i];
+		}
+		output[i] = out.str();
+		warnings[i] = worker.getWarning();
+	});
+
+	bool status = true;
+	for (int i=0; i<count; i++) {
+		m_humdrum_text << output[i];
+		m_warning_text << warnings[i];
+		status &= (bool)statuses[i];
+	}
+	return status;
+}
+
+
+
 bool Tool_dissonant::run(const string& indata, ostream& out) {
 
 	if (getBoolean("undirected")) {
@@ -37401,16 +42191,18 @@ bool Tool_dissonant::run(HumdrumFile& infile) {
 	suppressQ = getBoolean("suppress");
 	voiceFuncsQ = getBoolean("voice-functions");
 
-	vector<vector<string>> results;
-	vector<vector<string>> results2;
+	bool countQ = m_countQ || getBoolean("count");
+	vector<vector<int>> results;
+	vector<vector<int>> results2;
 	vector<vector<string>> voiceFuncs;
+	vector<vector<string>> labels;
 	vector<vector<NoteCell*>> attacks;
 	vector<vector<NoteCell*>> attacks2;
 
 	attacks.resize(grid.getVoiceCount());
 	results.resize(grid.getVoiceCount());
 	for (int i=0; i<(int)results.size(); i++) {
-		results[i].resize(infile.getLineCount());
+		results[i].resize(infile.getLineCount(), NO_LABEL);
 	}
 	doAnalysis(results, grid, attacks, getBoolean("debug"));
 
@@ -37426,7 +42218,7 @@ bool Tool_dissonant::run(HumdrumFile& infile) {
 		results2.resize(grid2.getVoiceCount());
 		for (int i=0; i<(int)results2.size(); i++) {
 			results2[i].clear();
-			results2[i].resize(infile.getLineCount());
+			results2[i].resize(infile.getLineCount(), NO_LABEL);
 		}
 		vector<vector<NoteCell*>> attacks2;
 		doAnalysis(results2, grid2, attacks2, getBoolean("debug"));
@@ -37434,27 +42226,18 @@ bool Tool_dissonant::run(HumdrumFile& infile) {
 	}
 
 	if (suppressQ) {
-		if (getBoolean("count")) {
+		if (countQ) {
 			printCountAnalysis(results2);
 			return false;
 		} else {
-			string exinterp = getString("exinterp");
-			vector<HTp> kernspines = infile.getKernSpineStartList();
-			infile.appendDataSpine(results2.back(), "", exinterp);
-			for (int i = (int)results2.size()-1; i>0; i--) {
-				int track = kernspines[i]->getTrack();
-				infile.insertDataSpineBefore(track, results2[i-1], "", exinterp);
-			}
-			printColorLegend(infile);
-
-			adjustColorization(infile);
-			infile.createLinesFromTokens();
-
-			return true;
+			getLabelStrings(labels, results2);
+			return printAnalysis(infile, labels);
 		}
 	} else if (voiceFuncsQ) { // run cadnetial-voice-function analysis if requested
-		if (getBoolean("count")) {
-			printCountAnalysis(voiceFuncs);
+		if (countQ) {
+			// voice functions are not counted
+			vector<vector<int>> empty;
+			printCountAnalysis(empty);
 			return false;
 		}
 
@@ -37466,42 +42249,55 @@ bool Tool_dissonant::run(HumdrumFile& infile) {
 			findCadentialVoiceFunctions(results, grid, attacks[i], voiceFuncs, i);
 		}
 
-		string exinterp = getString("exinterp");
-		vector<HTp> kernspines = infile.getKernSpineStartList();
-		infile.appendDataSpine(voiceFuncs.back(), "", exinterp);
-		for (int i = (int)voiceFuncs.size()-1; i>0; i--) {
-			int track = kernspines[i]->getTrack();
-			infile.insertDataSpineBefore(track, voiceFuncs[i-1], "", exinterp);
-		}
-		printColorLegend(infile);
-
-		adjustColorization(infile);
-		infile.createLinesFromTokens();
-
-		infile.createLinesFromTokens();
-		return true;
+		return printAnalysis(infile, voiceFuncs);
 	} else {
-		if (getBoolean("count")) {
+		if (countQ) {
 			printCountAnalysis(results);
 			return false;
 		} else {
-			string exinterp = getString("exinterp");
-			vector<HTp> kernspines = infile.getKernSpineStartList();
-			infile.appendDataSpine(results.back(), "", exinterp);
-			for (int i = (int)results.size()-1; i>0; i--) {
-				int track = kernspines[i]->getTrack();
-				infile.insertDataSpineBefore(track, results[i-1], "", exinterp);
-			}
-			printColorLegend(infile);
-			adjustColorization(infile);
-			infile.createLinesFromTokens();
-			return true;
+			getLabelStrings(labels, results);
+			return printAnalysis(infile, labels);
 		}
 	}
 }
 
 
 
+//////////////////////////////
+//
+// Tool_dissonant::printAnalysis -- Store the analysis of each voice in an
+//     analysis column of the file, placed after the **kern spine for the
+//     voice.  The columns are then printed as CSV data, or rendered as
+//     spines in the file and used to colorize the dissonant notes.
+//
+
+bool Tool_dissonant::printAnalysis(HumdrumFile& infile,
+		vector<vector<string> >& data) {
+	string exinterp = getString("exinterp");
+	vector<HTp> kernspines = infile.getKernSpineStartList();
+	HumAnalysisColumn* column;
+	column = &infile.addAnalysisColumn(data.back(), "", exinterp);
+	column->setName(column->getName() + "-" + to_string(kernspines.back()->getTrack()));
+	for (int i = (int)data.size()-1; i>0; i--) {
+		int track = kernspines[i]->getTrack();
+		column = &infile.addAnalysisColumn(data[i-1], "", exinterp, track);
+		column->setName(column->getName() + "-" + to_string(kernspines[i-1]->getTrack()));
+	}
+
+	if (getBoolean("csv")) {
+		infile.printAnalysisCsv(m_free_text);
+		return true;
+	}
+
+	infile.renderAnalysisColumns();
+	printColorLegend(infile);
+	adjustColorization(infile);
+	infile.createLinesFromTokens();
+	return true;
+}
+
+
+
 /////////////////////////////
 //
 // Tool_dissonant::adjustColorization -- The dissonance analysis will color the
@@ -37755,7 +42551,7 @@ void Tool_dissonant::addLabelToSuspensions(HTp disslabel, const string& marker)
 //
 
 void Tool_dissonant::suppressDissonances(HumdrumFile& infile, NoteGrid& grid,
-		vector<vector<NoteCell*>>& attacks, vector<vector<string>>& results) {
+		vector<vector<NoteCell*>>& attacks, vector<vector<int>>& results) {
 
 	// Loop over the dissonance results one full row at a time. The point of doing it
 	// one row at a time instead of one voice at a time is so that a weak dissonance in
@@ -37793,30 +42589,30 @@ void Tool_dissonant::suppressDissonances(HumdrumFile& infile, NoteGrid& grid,
 				continue;
 			}
 			int v = kernTrackToVoiceIndex.at(token->getTrack());
-			if (results[v][i].empty() || (results[v][i] == ".")) {
+			if ((results[v][i] == NO_LABEL) || (results[v][i] == NULL_LABEL)) {
 				continue;
 			}
 			// cerr << "\tCHECKING DISSONANCE " << results[v][i] << " for note " << token << endl;
 			HumNum notedur = token->getTiedDuration();
 
-			if ((results[v][i] == m_labels[PASSING_DOWN]) ||
-					(results[v][i] == m_labels[PASSING_UP]) ||
-					(results[v][i] == m_labels[NEIGHBOR_DOWN]) ||
-					(results[v][i] == m_labels[NEIGHBOR_UP]) ||
-					(results[v][i] == m_labels[CAMBIATA_DOWN_S]) ||
-					(results[v][i] == m_labels[CAMBIATA_UP_S]) ||
-					(results[v][i] == m_labels[CAMBIATA_DOWN_L]) ||
-					(results[v][i] == m_labels[CAMBIATA_UP_L]) ||
-					(results[v][i] == m_labels[ECHAPPEE_DOWN]) ||
-					(results[v][i] == m_labels[ECHAPPEE_UP]) ||
-					(results[v][i] == m_labels[ANT_DOWN]) ||
-					(results[v][i] == m_labels[ANT_UP]) ||
-					(results[v][i] == m_labels[REV_ECHAPPEE_DOWN]) ||
-					(results[v][i] == m_labels[REV_ECHAPPEE_UP]) ||
-					(results[v][i] == m_labels[REV_CAMBIATA_DOWN]) ||
-					(results[v][i] == m_labels[REV_CAMBIATA_UP]) ||
-					(results[v][i] == m_labels[DBL_NEIGHBOR_DOWN]) ||
-					(results[v][i] == m_labels[DBL_NEIGHBOR_UP]) ) {
+			if ((results[v][i] == m_labelcodes[PASSING_DOWN]) ||
+					(results[v][i] == m_labelcodes[PASSING_UP]) ||
+					(results[v][i] == m_labelcodes[NEIGHBOR_DOWN]) ||
+					(results[v][i] == m_labelcodes[NEIGHBOR_UP]) ||
+					(results[v][i] == m_labelcodes[CAMBIATA_DOWN_S]) ||
+					(results[v][i] == m_labelcodes[CAMBIATA_UP_S]) ||
+					(results[v][i] == m_labelcodes[CAMBIATA_DOWN_L]) ||
+					(results[v][i] == m_labelcodes[CAMBIATA_UP_L]) ||
+					(results[v][i] == m_labelcodes[ECHAPPEE_DOWN]) ||
+					(results[v][i] == m_labelcodes[ECHAPPEE_UP]) ||
+					(results[v][i] == m_labelcodes[ANT_DOWN]) ||
+					(results[v][i] == m_labelcodes[ANT_UP]) ||
+					(results[v][i] == m_labelcodes[REV_ECHAPPEE_DOWN]) ||
+					(results[v][i] == m_labelcodes[REV_ECHAPPEE_UP]) ||
+					(results[v][i] == m_labelcodes[REV_CAMBIATA_DOWN]) ||
+					(results[v][i] == m_labelcodes[REV_CAMBIATA_UP]) ||
+					(results[v][i] == m_labelcodes[DBL_NEIGHBOR_DOWN]) ||
+					(results[v][i] == m_labelcodes[DBL_NEIGHBOR_UP]) ) {
 				if (notedur > maxWeakDur) {
 					maxWeakDur = notedur;
 					maxToken = token;
@@ -37845,14 +42641,14 @@ void Tool_dissonant::suppressDissonances(HumdrumFile& infile, NoteGrid& grid,
 				continue;
 			}
 			int v = kernTrackToVoiceIndex.at(token->getTrack());
-			if (results[v][i].empty() || (results[v][i] == ".")) {
+			if ((results[v][i] == NO_LABEL) || (results[v][i] == NULL_LABEL)) {
 				continue;
 			}
 			HumNum notedur = token->getTiedDuration();
-			if ((results[v][i] == m_labels[SUS_BIN]) ||
-					(results[v][i] == m_labels[SUS_TERN]) ||
-					(results[v][i] == m_labels[AGENT_BIN]) ||
-					(results[v][i] == m_labels[AGENT_TERN])) {
+			if ((results[v][i] == m_labelcodes[SUS_BIN]) ||
+					(results[v][i] == m_labelcodes[SUS_TERN]) ||
+					(results[v][i] == m_labelcodes[AGENT_BIN]) ||
+					(results[v][i] == m_labelcodes[AGENT_TERN])) {
 				continue;
 			} else if (notedur <= maxWeakDur) {
 				mergeWithPreviousNote(infile, i, j);
@@ -37878,12 +42674,12 @@ void Tool_dissonant::suppressDissonances(HumdrumFile& infile, NoteGrid& grid,
 
 void Tool_dissonant::suppressDissonancesInVoice(HumdrumFile& infile,
 		NoteGrid& grid, int vindex, vector<NoteCell*>& attacks,
-		vector<string>& results) {
+		vector<int>& results) {
 
 	for (int i=0; i<(int)attacks.size(); i++) {
 		int lineindex = attacks[i]->getLineIndex();
 		int fieldindex = attacks[i]->getFieldIndex();
-		if ((results[lineindex] == "") || (results[lineindex] == ".") ) {
+		if ((results[lineindex] == NO_LABEL) || (results[lineindex] == NULL_LABEL) ) {
 			continue;
 		}
 
@@ -37897,21 +42693,21 @@ void Tool_dissonant::suppressDissonancesInVoice(HumdrumFile& infile,
 			continue;
 		}
 
-		if ((results[lineindex] == m_labels[THIRD_Q_PASS_UP]) ||
-			(results[lineindex] == m_labels[THIRD_Q_PASS_DOWN]) ||
-			(results[lineindex] == m_labels[THIRD_Q_LOWER_NEI]) ||
-			(results[lineindex] == m_labels[THIRD_Q_UPPER_NEI]) ||
-			(results[lineindex] == m_labels[ACC_PASSING_UP]) ||
-			(results[lineindex] == m_labels[ACC_PASSING_DOWN]) ||
-			(results[lineindex] == m_labels[ACC_LO_NEI]) ||
-			(results[lineindex] == m_labels[ACC_UP_NEI]) ||
-			(results[lineindex] == m_labels[RES_PITCH]) ||
-			(results[lineindex] == m_labels[APP_UPPER]) ||
-			(results[lineindex] == m_labels[APP_LOWER]) ||
-			(results[lineindex] == m_labels[PARALLEL_DOWN]) ||
-			(results[lineindex] == m_labels[PARALLEL_UP]) ||
-			(results[lineindex] == m_labels[ORNAMENTAL_SUS]) ||
-			(results[lineindex] == m_labels[CHANSON_IDIOM]) ) {
+		if ((results[lineindex] == m_labelcodes[THIRD_Q_PASS_UP]) ||
+			(results[lineindex] == m_labelcodes[THIRD_Q_PASS_DOWN]) ||
+			(results[lineindex] == m_labelcodes[THIRD_Q_LOWER_NEI]) ||
+			(results[lineindex] == m_labelcodes[THIRD_Q_UPPER_NEI]) ||
+			(results[lineindex] == m_labelcodes[ACC_PASSING_UP]) ||
+			(results[lineindex] == m_labelcodes[ACC_PASSING_DOWN]) ||
+			(results[lineindex] == m_labelcodes[ACC_LO_NEI]) ||
+			(results[lineindex] == m_labelcodes[ACC_UP_NEI]) ||
+			(results[lineindex] == m_labelcodes[RES_PITCH]) ||
+			(results[lineindex] == m_labelcodes[APP_UPPER]) ||
+			(results[lineindex] == m_labelcodes[APP_LOWER]) ||
+			(results[lineindex] == m_labelcodes[PARALLEL_DOWN]) ||
+			(results[lineindex] == m_labelcodes[PARALLEL_UP]) ||
+			(results[lineindex] == m_labelcodes[ORNAMENTAL_SUS]) ||
+			(results[lineindex] == m_labelcodes[CHANSON_IDIOM]) ) {
 			// cerr << "MERGING " << token << " with next note" << endl;
 			mergeWithNextNote(infile, lineindex, fieldindex);
 		}
@@ -37927,12 +42723,12 @@ void Tool_dissonant::suppressDissonancesInVoice(HumdrumFile& infile,
 
 void Tool_dissonant::suppressSusOrnamentsInVoice(HumdrumFile& infile,
 		NoteGrid& grid, int vindex, vector<NoteCell*>& attacks,
-		vector<string>& results) {
+		vector<int>& results) {
 
 	for (int i=0; i<(int)attacks.size(); i++) {
 		int lineindex = attacks[i]->getLineIndex();
 		int fieldindex = attacks[i]->getFieldIndex();
-		if ((results[lineindex] == "") || (results[lineindex] == ".") ) {
+		if ((results[lineindex] == NO_LABEL) || (results[lineindex] == NULL_LABEL) ) {
 			continue;
 		}
 
@@ -37946,8 +42742,8 @@ void Tool_dissonant::suppressSusOrnamentsInVoice(HumdrumFile& infile,
 			continue;
 		}
 
-		if (((results[lineindex] == m_labels[SUS_BIN]) ||
-			 (results[lineindex] == m_labels[SUS_TERN])) &&
+		if (((results[lineindex] == m_labelcodes[SUS_BIN]) ||
+			 (results[lineindex] == m_labelcodes[SUS_TERN])) &&
 			(i < ((int)attacks.size() - 3)) ) {
 			HumNum durn   = attacks[i+1]->getDuration();
 			HumNum durnn  = attacks[i+2]->getDuration();
@@ -37967,23 +42763,23 @@ void Tool_dissonant::suppressSusOrnamentsInVoice(HumdrumFile& infile,
 
 			if ((durn == durnn) && (durn < durnnn) && (levn > levnnn) &&
 				(intn == -1) && (intnn == -1) && (intnnn == 1) ) { // turn figure anticipation of resolution phase
-				if ((results[lineindexnn] == ".") && (!tokennn->isNull()) &&
+				if ((results[lineindexnn] == NULL_LABEL) && (!tokennn->isNull()) &&
 					(tokennn->isNoteAttack()) ) {
 					mergeWithPreviousNote(infile, lineindexnn, vindex);
 				}
-				if ((results[lineindexn] == ".") && (!tokenn->isNull()) &&
+				if ((results[lineindexn] == NULL_LABEL) && (!tokenn->isNull()) &&
 					(tokenn->isNoteAttack()) ) {
 					mergeWithPreviousNote(infile, lineindexn, vindex);
 				}
 			} else if ((durn == durnn) && (durn == durnnn) && (levn > levnn) &&
 				(levnn < levnnn) && (intn == -1) && (intnn == 0) &&
-				(intnnn == -1) && (results[lineindexnnn] == ".") &&
+				(intnnn == -1) && (results[lineindexnnn] == NULL_LABEL) &&
 				(!tokennnn->isNull()) && (tokennnn->isNoteAttack()) ) { // Du Fay ornament
 				mergeWithPreviousNote(infile, lineindexnnn, vindex);
 			}
 		}
-		if (((results[lineindex] == m_labels[SUS_BIN]) ||
-			 (results[lineindex] == m_labels[SUS_TERN])) &&
+		if (((results[lineindex] == m_labelcodes[SUS_BIN]) ||
+			 (results[lineindex] == m_labelcodes[SUS_TERN])) &&
 			(i < ((int)attacks.size() - 2)) ) {
 			HumNum durn  = attacks[i+1]->getDuration();
 			HumNum durnn = attacks[i+2]->getDuration();
@@ -37995,7 +42791,7 @@ void Tool_dissonant::suppressSusOrnamentsInVoice(HumdrumFile& infile,
 			HTp tokenn = infile.token(lineindexn, fieldindex);
 
 			if ((durn <= durnn) && (levn >= levnn) && (intn == -1) &&
-				(intnn == 0) && (results[lineindexn] == ".") &&
+				(intnn == 0) && (results[lineindexn] == NULL_LABEL) &&
 				(!tokenn->isNull()) && (tokenn->isNoteAttack()) ) { // anticipation of resolution phase
 				mergeWithPreviousNote(infile, lineindexn, vindex);
 			}
@@ -38426,7 +43222,7 @@ void Tool_dissonant::printColorLegend(HumdrumFile& infile) {
 // Tool_dissonant::doAnalysis -- do a basic melodic analysis of all parts.
 //
 
-void Tool_dissonant::doAnalysis(vector<vector<string>>& results,
+void Tool_dissonant::doAnalysis(vector<vector<int>>& results,
 		NoteGrid& grid, vector<vector<NoteCell*>>& attacks, bool debug) {
 	attacks.resize(grid.getVoiceCount());
 
@@ -38460,7 +43256,7 @@ void Tool_dissonant::doAnalysis(vector<vector<string>>& results,
 //     subtracting NoteCells to calculate the diatonic intervals.
 //
 
-void Tool_dissonant::doAnalysisForVoice(vector<vector<string>>& results,
+void Tool_dissonant::doAnalysisForVoice(vector<vector<int>>& results,
 		NoteGrid& grid, vector<NoteCell*>& attacks, int vindex, bool debug) {
 	attacks.clear();
 	grid.getNoteAndRestAttacks(attacks, vindex);
@@ -38500,7 +43296,7 @@ void Tool_dissonant::doAnalysisForVoice(vector<vector<string>>& results,
 	bool dissonant;    // true if  note is dissonant with other sounding notes.
 	char marking = '\0';
 	int ovoiceindex = -1;
-	string unexp_label; // default dissonance label if none of the diss types apply
+	int unexp_label = NO_LABEL; // default dissonance label if none of the diss types apply
 	int refMeterNum;    // the numerator of the reference voice's notated time signature
 	HumNum refMeterDen; // the denominator of the reference voice's notated time signature
 	int othMeterNum;    // the numerator of the other voice's notated time signature
@@ -38574,7 +43370,7 @@ RECONSIDER:
 				dissonant = true;
 				diss2Q = true;
 				marking = '@';
-				unexp_label = m_labels[UNLABELED_Z2];
+				unexp_label = m_labelcodes[UNLABELED_Z2];
 				ovoiceindex = j;
 				oattackindexn = getNextPitchAttackIndex(grid, ovoiceindex, sliceindex);
 				break;
@@ -38583,7 +43379,7 @@ RECONSIDER:
 				dissonant = true;
 				diss7Q = true;
 				marking = '+';
-				unexp_label = m_labels[UNLABELED_Z7];
+				unexp_label = m_labelcodes[UNLABELED_Z7];
 				ovoiceindex = j;
 				oattackindexn = getNextPitchAttackIndex(grid, ovoiceindex, sliceindex);
 				break;
@@ -38599,7 +43395,7 @@ RECONSIDER:
 				dissonant = true;
 				diss4Q = true;
 				marking = 'N';
-				unexp_label = m_labels[UNLABELED_Z4];
+				unexp_label = m_labelcodes[UNLABELED_Z4];
 				// ovoiceindex = lowestnotei;
 				ovoiceindex = j;
 				// oattackindexn = grid.cell(ovoiceindex, sliceindex)->getNextAttackIndex();
@@ -38619,7 +43415,7 @@ RECONSIDER:
 				marking = 'N';
 				ovoiceindex = lowestnotei;
 				oattackindexn = grid.cell(ovoiceindex, sliceindex)->getNextAttackIndex();
-				unexp_label = m_labels[UNLABELED_Z4];
+				unexp_label = m_labelcodes[UNLABELED_Z4];
 			}
 		}
 */
@@ -38777,10 +43573,10 @@ RECONSIDER:
 
 		ternAgent = false;
 		if (((othMeterNum % 3 == 0) && (odur >= othMeterDen)) && // the durational value of the meter's denominator groups in threes and the sus lasts at least as long as the denominator
-			(results[ovoiceindex][lineindex] != m_labels[SUS_BIN]) && // the other voice hasn't already been labeled as a binary suspension
+			(results[ovoiceindex][lineindex] != m_labelcodes[SUS_BIN]) && // the other voice hasn't already been labeled as a binary suspension
 			((dur == othMeterDen*2) || // the ref note lasts 2 times as long as the meter's denominator
 			 ((dur == othMeterDen*threehalves) && ((intn == 0) || (intn == -1))) || // ref note lasts 1.5 times the meter's denominator and next note is a tenorizans ornament
-			 ((dur == othMeterDen*threehalves) && ((unexp_label == m_labels[UNLABELED_Z4]) || (intn == 3))) || // 4-3 susp where agent leaps to diatonic pitch class of resolution
+			 ((dur == othMeterDen*threehalves) && ((unexp_label == m_labelcodes[UNLABELED_Z4]) || (intn == 3))) || // 4-3 susp where agent leaps to diatonic pitch class of resolution
 			 ((dur == sixteenthirds) && (refMeterNum == 3) && (refMeterDen == threehalves)) || // special case for 3/3 time signature
 			 ((odur == othMeterDen*threehalves) && (ointn == -1) && (odurn == 2) && (ointnn == 0)) || // change of agent suspension with ant of resolution
 			 ((dur == othMeterDen) && (odur == othMeterDen*2)) || // unornamented change of agent suspension
@@ -38799,63 +43595,63 @@ RECONSIDER:
 			(dur <= durp) && (condition2 || condition2b) && valid_acc_exit) { // weak dissonances
 			if (intp == -1) { // descending dissonances
 				if (intn == -1) { // downward passing tone
-					results[vindex][lineindex] = m_labels[PASSING_DOWN];
+					results[vindex][lineindex] = m_labelcodes[PASSING_DOWN];
 				} else if (intn == 1) { // lower neighbor
-					results[vindex][lineindex] = m_labels[NEIGHBOR_DOWN];
+					results[vindex][lineindex] = m_labelcodes[NEIGHBOR_DOWN];
 				} else if ((intn == 0) && (dur <= 2)) { // descending anticipation
-					results[vindex][lineindex] = m_labels[ANT_DOWN];
+					results[vindex][lineindex] = m_labelcodes[ANT_DOWN];
 				} else if (intn > 1) { // lower échappée
-					results[vindex][lineindex] = m_labels[ECHAPPEE_DOWN];
+					results[vindex][lineindex] = m_labelcodes[ECHAPPEE_DOWN];
 				} else if (intn < -1) { // descending short nota cambiata
-					results[vindex][lineindex] = m_labels[CAMBIATA_DOWN_S];
+					results[vindex][lineindex] = m_labelcodes[CAMBIATA_DOWN_S];
 				}
 			} else if (intp == 1) { // ascending dissonances
 				if (intn == 1) { // rising passing tone
-					results[vindex][lineindex] = m_labels[PASSING_UP];
+					results[vindex][lineindex] = m_labelcodes[PASSING_UP];
 				} else if (intn == -1) { // upper neighbor
-					results[vindex][lineindex] = m_labels[NEIGHBOR_UP];
+					results[vindex][lineindex] = m_labelcodes[NEIGHBOR_UP];
 				} else if (intn < -1) { // upper échappée
-					results[vindex][lineindex] = m_labels[ECHAPPEE_UP];
+					results[vindex][lineindex] = m_labelcodes[ECHAPPEE_UP];
 				} else if ((intn == 0) && (dur <= 2)) { // rising anticipation
-					results[vindex][lineindex] = m_labels[ANT_UP];
+					results[vindex][lineindex] = m_labelcodes[ANT_UP];
 				} else if (intn > 1) { // ascending short nota cambiata
-					results[vindex][lineindex] = m_labels[CAMBIATA_UP_S];
+					results[vindex][lineindex] = m_labelcodes[CAMBIATA_UP_S];
 				}
 			} else if (intp < -1) {
 				if (intn == 1) { // reverse lower échappée
-					results[vindex][lineindex] = m_labels[REV_ECHAPPEE_DOWN];
+					results[vindex][lineindex] = m_labelcodes[REV_ECHAPPEE_DOWN];
 				} else if (intn == -1) { // reverse descending nota cambiata
-					results[vindex][lineindex] = m_labels[REV_CAMBIATA_DOWN];
+					results[vindex][lineindex] = m_labelcodes[REV_CAMBIATA_DOWN];
 				}
 			} else if (intp > 1) {
 				if (intn == -1) { // reverse upper échappée
-					results[vindex][lineindex] = m_labels[REV_ECHAPPEE_UP];
+					results[vindex][lineindex] = m_labelcodes[REV_ECHAPPEE_UP];
 				} else if (intn == 1) { // reverse ascending nota cambiata
-					results[vindex][lineindex] = m_labels[REV_CAMBIATA_UP];
+					results[vindex][lineindex] = m_labelcodes[REV_CAMBIATA_UP];
 				}
 			}
 		} else if ((durp >= 2) && (dur == 1) && (lev < levn) && valid_acc_exit &&
 					 (condition2 || condition2b) && (lev == 1)) {
 			if (intp == -1) {
 				if (intn == -1) { // dissonant third quarter descending passing tone
-					results[vindex][lineindex] = m_labels[THIRD_Q_PASS_DOWN];
+					results[vindex][lineindex] = m_labelcodes[THIRD_Q_PASS_DOWN];
 				} else if (intn == 1) { // dissonant third quarter lower neighbor
-					results[vindex][lineindex] = m_labels[THIRD_Q_LOWER_NEI];
+					results[vindex][lineindex] = m_labelcodes[THIRD_Q_LOWER_NEI];
 				}
 			} else if (intp == 1) {
 				if (intn == 1) { // dissonant third quarter ascending passing tone
-					results[vindex][lineindex] = m_labels[THIRD_Q_PASS_UP];
+					results[vindex][lineindex] = m_labelcodes[THIRD_Q_PASS_UP];
 				} else if (intn == -1) { // dissonant third quarter upper neighbor
-					results[vindex][lineindex] = m_labels[THIRD_Q_UPPER_NEI];
+					results[vindex][lineindex] = m_labelcodes[THIRD_Q_UPPER_NEI];
 				}
 			}
 		} else if (((lev > levp) || (durp+durp+durp+durp == dur)) &&
 				   (lev == levn) && condition2 && (intn == -1) &&
 				   (dur == (durn+durn)) && ((dur+dur) <= odur)) {
 			if (fabs(intp) > 1.0) {
-				results[vindex][lineindex] = m_labels[SUS_NO_AGENT_LEAP];
+				results[vindex][lineindex] = m_labelcodes[SUS_NO_AGENT_LEAP];
 			} else if ((fabs(intp) == 1.0) || ((intp == 0) && (fabs(intpp) == 1.0))) {
-				results[vindex][lineindex] = m_labels[SUS_NO_AGENT_STEP];
+				results[vindex][lineindex] = m_labelcodes[SUS_NO_AGENT_STEP];
 			}
 		}
 
@@ -38866,54 +43662,54 @@ RECONSIDER:
 
 		else if (valid_sus_acc && ((ointn == -1) || ((ointn == -2) && (ointnn == 1)))) {
 			if ((durpp == 1) && (durp == 1) && (intpp == -1) && (intp == 1) &&
-					((results[vindex][lineindexpp] == m_labels[THIRD_Q_PASS_DOWN]) ||
-					(results[vindex][lineindexpp] == m_labels[ACC_PASSING_DOWN]) ||
-					(results[vindex][lineindexpp] == m_labels[UNLABELED_Z7]) ||
-					(results[vindex][lineindexpp] == m_labels[UNLABELED_Z4]))) {
-				results[vindex][lineindexpp] = m_labels[CHANSON_IDIOM];
+					((results[vindex][lineindexpp] == m_labelcodes[THIRD_Q_PASS_DOWN]) ||
+					(results[vindex][lineindexpp] == m_labelcodes[ACC_PASSING_DOWN]) ||
+					(results[vindex][lineindexpp] == m_labelcodes[UNLABELED_Z7]) ||
+					(results[vindex][lineindexpp] == m_labelcodes[UNLABELED_Z4]))) {
+				results[vindex][lineindexpp] = m_labelcodes[CHANSON_IDIOM];
 			}
 			if (ternAgent) { // ternary agent and suspension
-				results[vindex][lineindex] = m_labels[AGENT_TERN];
-				results[ovoiceindex][lineindex] = m_labels[SUS_TERN];
+				results[vindex][lineindex] = m_labelcodes[AGENT_TERN];
+				results[ovoiceindex][lineindex] = m_labelcodes[SUS_TERN];
 			} else if (((odur == .5) || (odur == 1)) && // purely ornamental suspension
 						((odurn == .5) || (odurn == 1)) &&
 						(ointn == -1) && (ointnn == -1) ) {
-				results[vindex][lineindex] = m_labels[AGENT_BIN];
-				results[ovoiceindex][lineindex] = m_labels[ORNAMENTAL_SUS];
+				results[vindex][lineindex] = m_labelcodes[AGENT_BIN];
+				results[ovoiceindex][lineindex] = m_labelcodes[ORNAMENTAL_SUS];
 			} else { // binary agent and suspension
-				results[vindex][lineindex] = m_labels[AGENT_BIN];
-				results[ovoiceindex][lineindex] = m_labels[SUS_BIN];
+				results[vindex][lineindex] = m_labelcodes[AGENT_BIN];
+				results[ovoiceindex][lineindex] = m_labelcodes[SUS_BIN];
 			}
 		} else if (valid_ornam_sus_acc && ((ointn == 0) && (ointnn == -1))) {
 			if ((durpp == 1) && (durp == 1) && (intpp == -1) && (intp == 1) &&
-					((results[vindex][lineindexpp] == m_labels[THIRD_Q_PASS_DOWN]) ||
-					(results[vindex][lineindexpp] == m_labels[ACC_PASSING_DOWN]) ||
-					(results[vindex][lineindexpp] == m_labels[UNLABELED_Z7]) ||
-					(results[vindex][lineindexpp] == m_labels[UNLABELED_Z4]))) {
-				results[vindex][lineindexpp] = m_labels[CHANSON_IDIOM];
+					((results[vindex][lineindexpp] == m_labelcodes[THIRD_Q_PASS_DOWN]) ||
+					(results[vindex][lineindexpp] == m_labelcodes[ACC_PASSING_DOWN]) ||
+					(results[vindex][lineindexpp] == m_labelcodes[UNLABELED_Z7]) ||
+					(results[vindex][lineindexpp] == m_labelcodes[UNLABELED_Z4]))) {
+				results[vindex][lineindexpp] = m_labelcodes[CHANSON_IDIOM];
 			}
 			if (ternAgent) { // ternary agent and suspension
-				results[vindex][lineindex] = m_labels[AGENT_TERN];
-				results[ovoiceindex][lineindex] = m_labels[SUS_TERN];
+				results[vindex][lineindex] = m_labelcodes[AGENT_TERN];
+				results[ovoiceindex][lineindex] = m_labelcodes[SUS_TERN];
 			} else { // binary agent and suspension
-				results[vindex][lineindex] = m_labels[AGENT_BIN];
-				results[ovoiceindex][lineindex] = m_labels[SUS_BIN];
+				results[vindex][lineindex] = m_labelcodes[AGENT_BIN];
+				results[ovoiceindex][lineindex] = m_labelcodes[SUS_BIN];
 			} // repeated-note of suspension
-			results[ovoiceindex][olineindexn] = m_labels[SUSPENSION_REP];
+			results[ovoiceindex][olineindexn] = m_labelcodes[SUSPENSION_REP];
 		} else if (valid_ornam_sus_acc && ((ointn == 1) && (ointnn == -2))) {
 			if ((durpp == 1) && (durp == 1) && (intpp == -1) && (intp == 1) &&
-					((results[vindex][lineindexpp] == m_labels[THIRD_Q_PASS_DOWN]) ||
-					(results[vindex][lineindexpp] == m_labels[ACC_PASSING_DOWN]) ||
-					(results[vindex][lineindexpp] == m_labels[UNLABELED_Z7]) ||
-					(results[vindex][lineindexpp] == m_labels[UNLABELED_Z4]))) {
-				results[vindex][lineindexpp] = m_labels[CHANSON_IDIOM];
+					((results[vindex][lineindexpp] == m_labelcodes[THIRD_Q_PASS_DOWN]) ||
+					(results[vindex][lineindexpp] == m_labelcodes[ACC_PASSING_DOWN]) ||
+					(results[vindex][lineindexpp] == m_labelcodes[UNLABELED_Z7]) ||
+					(results[vindex][lineindexpp] == m_labelcodes[UNLABELED_Z4]))) {
+				results[vindex][lineindexpp] = m_labelcodes[CHANSON_IDIOM];
 			}
 			if (ternAgent) { // ternary agent and suspension
-				results[vindex][lineindex] = m_labels[AGENT_TERN];
-				results[ovoiceindex][lineindex] = m_labels[SUS_TERN];
+				results[vindex][lineindex] = m_labelcodes[AGENT_TERN];
+				results[ovoiceindex][lineindex] = m_labelcodes[SUS_TERN];
 			} else { // binary agent and suspension
-				results[vindex][lineindex] = m_labels[AGENT_BIN];
-				results[ovoiceindex][lineindex] = m_labels[SUS_BIN];
+				results[vindex][lineindex] = m_labelcodes[AGENT_BIN];
+				results[ovoiceindex][lineindex] = m_labelcodes[SUS_BIN];
 			} // This ornament is consonant against the agent so no ornament label.
 		}
 
@@ -38927,10 +43723,10 @@ RECONSIDER:
 
 			if ((dur <= durp) && (lev >= levp) && (lev >= levn) &&
 					(intp == -1) && (intn == -2) && (intnn == 1)) { // long-form descending cambiata
-				results[vindex][lineindex] = m_labels[CAMBIATA_DOWN_L];
+				results[vindex][lineindex] = m_labelcodes[CAMBIATA_DOWN_L];
 			} else if ((dur <= durp) && (lev >= levp) && (lev >= levn) &&
 					(intp == 1) && (intn == 2) && (intnn == -1)) { // long-form ascending nota cambiata
-				results[vindex][lineindex] = m_labels[CAMBIATA_UP_L];
+				results[vindex][lineindex] = m_labelcodes[CAMBIATA_UP_L];
 			}
 		}
 
@@ -38941,7 +43737,7 @@ RECONSIDER:
 		bool refLeaptFrom = fabs(intn) > 1 ? true : false;
 		bool othLeaptFrom = fabs(ointn) > 1 ? true : false;
 
-		if ((results[vindex][lineindex] == "") && // this voice doesn't already have a dissonance label
+		if ((results[vindex][lineindex] == NO_LABEL) && // this voice doesn't already have a dissonance label
 				((olineindexc < lineindex) || // other voice does not attack at this point
 				((olineindexc == lineindex) && (dur < odur)) || // both voices attack together, but ref voice leaves dissonance first
 				(((olineindexc == lineindex) && (dur == odur)) && // both voices enter and leave dissonance simultaneously
@@ -38959,10 +43755,10 @@ RECONSIDER:
 		// against another note with which it might have a known dissonant function.
 		// Also go back if this voice was identified as an agent, because it may be
 		// the agent of multiple patients.
-		if ((results[vindex][lineindex] == m_labels[UNLABELED_Z4]) ||
-				(results[vindex][lineindex] == m_labels[UNLABELED_Z7]) ||
-				(results[vindex][lineindex] == m_labels[AGENT_BIN]) ||
-				(results[vindex][lineindex] == m_labels[AGENT_TERN])) {
+		if ((results[vindex][lineindex] == m_labelcodes[UNLABELED_Z4]) ||
+				(results[vindex][lineindex] == m_labelcodes[UNLABELED_Z7]) ||
+				(results[vindex][lineindex] == m_labelcodes[AGENT_BIN]) ||
+				(results[vindex][lineindex] == m_labelcodes[AGENT_TERN])) {
 			if (nextj < (int)harmint.size()) {
 				goto RECONSIDER;
 			}
@@ -38978,7 +43774,7 @@ RECONSIDER:
 // Tool_dissonant::findFakeSuspensions --
 //
 
-void Tool_dissonant::findFakeSuspensions(vector<vector<string>>& results, NoteGrid& grid,
+void Tool_dissonant::findFakeSuspensions(vector<vector<int>>& results, NoteGrid& grid,
 		vector<NoteCell*>& attacks, int vindex) {
 	double intp;        // abs value of diatonic interval from previous melodic note
 	int lineindexn;     // line index of the next note in the voice
@@ -38986,18 +43782,18 @@ void Tool_dissonant::findFakeSuspensions(vector<vector<string>>& results, NoteGr
 
 	for (int i=1; i<(int)attacks.size()-1; i++) {
 		int lineindex = attacks[i]->getLineIndex();
-		if ((results[vindex][lineindex].find("Z") == string::npos) &&
-			(results[vindex][lineindex].find("z") == string::npos) &&
-			(results[vindex][lineindex].find("M") == string::npos) &&
-			(results[vindex][lineindex].find("m") == string::npos)) {
+		if ((results[vindex][lineindex] != m_labelcodes[UNKNOWN_DISSONANCE]) &&
+			(results[vindex][lineindex] != m_labelcodes[UNLABELED_Z4]) &&
+			(results[vindex][lineindex] != m_labelcodes[SUS_NO_AGENT_LEAP]) &&
+			(results[vindex][lineindex] != m_labelcodes[SUS_NO_AGENT_STEP])) {
 			continue;
 		}
 		intp = fabs(*attacks[i] - *attacks[i-1]);
 		lineindexn = attacks[i+1]->getLineIndex();
 		sfound = false;
 		for (int j=lineindex + 1; j<=lineindexn; j++) {
-			if ((results[vindex][j].compare(0, 1, "s") == 0) ||
-					(results[vindex][j].compare(0, 1, "S") == 0)) {
+			if ((results[vindex][j] == m_labelcodes[SUS_BIN]) ||
+					(results[vindex][j] == m_labelcodes[SUS_TERN])) {
 				sfound = true;
 				break;
 			}
@@ -39009,16 +43805,16 @@ void Tool_dissonant::findFakeSuspensions(vector<vector<string>>& results, NoteGr
 		// and sustained through to the beginning of the resolution.
 
 		if (intp == 1) { // Apply labels for normal fake suspensions.
-			results[vindex][lineindex] = m_labels[FAKE_SUSPENSION_STEP];
+			results[vindex][lineindex] = m_labelcodes[FAKE_SUSPENSION_STEP];
 		} else if (intp > 1) {
-			results[vindex][lineindex] = m_labels[FAKE_SUSPENSION_LEAP];
+			results[vindex][lineindex] = m_labelcodes[FAKE_SUSPENSION_LEAP];
 		} else if (i > 1) { // as long as i > 1 intpp will be in range.
 			double intpp = fabs(*attacks[i-1] - *attacks[i-2]);
 			if (intp == 0) { // fake suspensions preceded by an anticipation.
 				if (intpp == 1) {
-					results[vindex][lineindex] = m_labels[FAKE_SUSPENSION_STEP];
+					results[vindex][lineindex] = m_labelcodes[FAKE_SUSPENSION_STEP];
 				} else if (intpp > 1) {
-					results[vindex][lineindex] = m_labels[FAKE_SUSPENSION_LEAP];
+					results[vindex][lineindex] = m_labelcodes[FAKE_SUSPENSION_LEAP];
 				}
 			}
 		}
@@ -39029,7 +43825,7 @@ void Tool_dissonant::findFakeSuspensions(vector<vector<string>>& results, NoteGr
 //
 // Tool_dissonant::findLs --
 //
-void Tool_dissonant::findLs(vector<vector<string>>& results, NoteGrid& grid,
+void Tool_dissonant::findLs(vector<vector<int>>& results, NoteGrid& grid,
 		vector<NoteCell*>& attacks, int vindex) {
 	HumNum dur;        // duration of current note;
 	HumNum odur;       // duration of current note in other voice which may have started earlier;
@@ -39049,8 +43845,8 @@ void Tool_dissonant::findLs(vector<vector<string>>& results, NoteGrid& grid,
 
 	for (int i=1; i<(int)attacks.size()-1; i++) {
 		lineindex = attacks[i]->getLineIndex();
-		if ((results[vindex][lineindex].find("Z") == string::npos) &&
-			(results[vindex][lineindex].find("z") == string::npos)) {
+		if ((results[vindex][lineindex] != m_labelcodes[UNKNOWN_DISSONANCE]) &&
+			(results[vindex][lineindex] != m_labelcodes[UNLABELED_Z4])) {
 			continue;
 		}
 		dur  = attacks[i]->getDuration();
@@ -39062,11 +43858,11 @@ void Tool_dissonant::findLs(vector<vector<string>>& results, NoteGrid& grid,
 			if (vindex == j) { // only compare different voices
 				continue;
 			}
-			if ((results[j][lineindex] == m_labels[AGENT_BIN]) ||
-				(results[j][lineindex] == m_labels[AGENT_TERN]) ||
-				(results[j][lineindex] == m_labels[UNLABELED_Z7]) ||
-				(results[j][lineindex] == m_labels[UNLABELED_Z4]) ||
-				(results[j][lineindex] == "")) {
+			if ((results[j][lineindex] == m_labelcodes[AGENT_BIN]) ||
+				(results[j][lineindex] == m_labelcodes[AGENT_TERN]) ||
+				(results[j][lineindex] == m_labelcodes[UNLABELED_Z7]) ||
+				(results[j][lineindex] == m_labelcodes[UNLABELED_Z4]) ||
+				(results[j][lineindex] == NO_LABEL)) {
 				continue; // skip if other voice is an agent, unexplainable, or empty.
 			}
 			oattackindexc = grid.cell(j, sliceindex)->getCurrAttackIndex();
@@ -39087,10 +43883,10 @@ void Tool_dissonant::findLs(vector<vector<string>>& results, NoteGrid& grid,
 			ointn = opitchn - opitch;
 			if ((intp == ointp) && (intn == ointn)) { // this note moves in parallel with an identifiable dissonance
 				if (intp > 0) {
-					results[vindex][lineindex] = m_labels[PARALLEL_UP];
+					results[vindex][lineindex] = m_labelcodes[PARALLEL_UP];
 					break;
 				} else if (intp < 0) {
-					results[vindex][lineindex] = m_labels[PARALLEL_DOWN];
+					results[vindex][lineindex] = m_labelcodes[PARALLEL_DOWN];
 					break;
 				}
 			}
@@ -39102,7 +43898,7 @@ void Tool_dissonant::findLs(vector<vector<string>>& results, NoteGrid& grid,
 //
 // Tool_dissonant::findYs --
 //
-void Tool_dissonant::findYs(vector<vector<string>>& results, NoteGrid& grid,
+void Tool_dissonant::findYs(vector<vector<int>>& results, NoteGrid& grid,
 		vector<NoteCell*>& attacks, int vindex) {
 	double intp;       // diatonic interval from previous melodic note
 	double intn;       // diatonic interval to next melodic note
@@ -39119,8 +43915,8 @@ void Tool_dissonant::findYs(vector<vector<string>>& results, NoteGrid& grid,
 
 	for (int i=1; i<(int)attacks.size()-1; i++) {
 		lineindex = attacks[i]->getLineIndex();
-		if ((results[vindex][lineindex].find("Z") == string::npos) &&
-			(results[vindex][lineindex].find("z") == string::npos)) {
+		if ((results[vindex][lineindex] != m_labelcodes[UNKNOWN_DISSONANCE]) &&
+			(results[vindex][lineindex] != m_labelcodes[UNLABELED_Z4])) {
 			continue;
 		}
 		intp = *attacks[i] - *attacks[i-1];
@@ -39157,10 +43953,10 @@ void Tool_dissonant::findYs(vector<vector<string>>& results, NoteGrid& grid,
 			}
 
 			if (((thisMod7 == 1) || (thisMod7 == -6)) && // creates 2nd or 7th diss
-				((results[j][lineindex] == m_labels[SUS_BIN]) || // other voice is susp
-				 (results[j][lineindex] == m_labels[SUS_TERN])) &&
+				((results[j][lineindex] == m_labelcodes[SUS_BIN]) || // other voice is susp
+				 (results[j][lineindex] == m_labelcodes[SUS_TERN])) &&
 				(fabs(intp) == 1) && (intn == -1) && valid_acc_exit) {
-				results[vindex][lineindex] = m_labels[RES_PITCH];
+				results[vindex][lineindex] = m_labelcodes[RES_PITCH];
 				onlyWithValids = false;
 			} else if (((abs(thisMod7) == 1) || (abs(thisMod7) == 6)  ||
 					((thisInt > 0) && (thisMod7 == 3) &&
@@ -39169,23 +43965,23 @@ void Tool_dissonant::findYs(vector<vector<string>>& results, NoteGrid& grid,
 					((thisInt < 0) && (thisMod7 == -3) && // a fourth by inversion is -3 and -3%7 = -3.
 					!(((int(opitch-lowestnote) % 7) == 2) ||
 					((int(opitch-lowestnote) % 7) == 4)))) &&
-					((results[j][olineindex] == m_labels[AGENT_BIN]) ||
-					(results[j][olineindex] == m_labels[AGENT_TERN]) ||
-					(results[j][olineindex] == m_labels[UNLABELED_Z7]) ||
-					(results[j][olineindex] == m_labels[UNLABELED_Z4]) ||
-					((results[j][olineindex] == "") &&
-					((results[j][lineindex] != m_labels[SUS_BIN]) &&
-					(results[j][lineindex] != m_labels[SUS_TERN]))))) {
+					((results[j][olineindex] == m_labelcodes[AGENT_BIN]) ||
+					(results[j][olineindex] == m_labelcodes[AGENT_TERN]) ||
+					(results[j][olineindex] == m_labelcodes[UNLABELED_Z7]) ||
+					(results[j][olineindex] == m_labelcodes[UNLABELED_Z4]) ||
+					((results[j][olineindex] == NO_LABEL) &&
+					((results[j][lineindex] != m_labelcodes[SUS_BIN]) &&
+					(results[j][lineindex] != m_labelcodes[SUS_TERN]))))) {
 				onlyWithValids = false;
 			}
 		}
 
-		if (onlyWithValids && ((results[vindex][lineindex] == m_labels[UNLABELED_Z7]) ||
-				(results[vindex][lineindex] == m_labels[UNLABELED_Z4]))) {
+		if (onlyWithValids && ((results[vindex][lineindex] == m_labelcodes[UNLABELED_Z7]) ||
+				(results[vindex][lineindex] == m_labelcodes[UNLABELED_Z4]))) {
 			if (intp > 0) {
-				results[vindex][lineindex] = m_labels[ONLY_WITH_VALID_UP];
+				results[vindex][lineindex] = m_labelcodes[ONLY_WITH_VALID_UP];
 			} else if (intp <= 0) {
-				results[vindex][lineindex] = m_labels[ONLY_WITH_VALID_DOWN];
+				results[vindex][lineindex] = m_labelcodes[ONLY_WITH_VALID_DOWN];
 			}
 		}
 	}
@@ -39195,7 +43991,7 @@ void Tool_dissonant::findYs(vector<vector<string>>& results, NoteGrid& grid,
 //
 // Tool_dissonant::findAppoggiaturas --
 //
-void Tool_dissonant::findAppoggiaturas(vector<vector<string>>& results, NoteGrid& grid,
+void Tool_dissonant::findAppoggiaturas(vector<vector<int>>& results, NoteGrid& grid,
 		vector<NoteCell*>& attacks, int vindex) {
 	HumNum durpp;      // duration of previous previous note
 	HumNum durp;       // duration of previous note
@@ -39219,10 +44015,10 @@ void Tool_dissonant::findAppoggiaturas(vector<vector<string>>& results, NoteGrid
 	for (int i=1; i<(int)attacks.size()-1; i++) {
 		lineindexp = attacks[i-1]->getLineIndex();
 		lineindex = attacks[i]->getLineIndex();
-		if ((results[vindex][lineindex].find("Z") == string::npos) &&
-			(results[vindex][lineindex].find("z") == string::npos) &&
-			(results[vindex][lineindex].find("J") == string::npos) &&
-			(results[vindex][lineindex].find("j") == string::npos)) {
+		if ((results[vindex][lineindex] != m_labelcodes[UNKNOWN_DISSONANCE]) &&
+			(results[vindex][lineindex] != m_labelcodes[UNLABELED_Z4]) &&
+			(results[vindex][lineindex] != m_labelcodes[REV_ECHAPPEE_UP]) &&
+			(results[vindex][lineindex] != m_labelcodes[REV_ECHAPPEE_DOWN])) {
 			continue;
 		}
 		durp = attacks[i-1]->getDuration();
@@ -39290,48 +44086,48 @@ void Tool_dissonant::findAppoggiaturas(vector<vector<string>>& results, NoteGrid
 					((int(opitch-lowestnote) % 7) == 4))))) {
 				continue;
 			} else if (((intp == -1) || ant_down) && ((lev <= levn) && (dur <= durn)) &&
-						((results[vindex][lineindex] == m_labels[UNLABELED_Z7]) ||
-						(results[vindex][lineindex] == m_labels[UNLABELED_Z4]))) {
+						((results[vindex][lineindex] == m_labelcodes[UNLABELED_Z7]) ||
+						(results[vindex][lineindex] == m_labelcodes[UNLABELED_Z4]))) {
 				if (intn == -1) {
-					results[vindex][lineindex] = m_labels[ACC_PASSING_DOWN]; // descending accented passing tone
+					results[vindex][lineindex] = m_labelcodes[ACC_PASSING_DOWN]; // descending accented passing tone
 				} else if (intn == 1) {
-					results[vindex][lineindex] = m_labels[ACC_LO_NEI]; // accented lower neighbor
+					results[vindex][lineindex] = m_labelcodes[ACC_LO_NEI]; // accented lower neighbor
 				}
 			} else if (((intp == 1) || ant_up) && ((lev <= levn) && (dur <= durn)) &&
-						((results[vindex][lineindex] == m_labels[UNLABELED_Z7]) ||
-						(results[vindex][lineindex] == m_labels[UNLABELED_Z4]))) {
+						((results[vindex][lineindex] == m_labelcodes[UNLABELED_Z7]) ||
+						(results[vindex][lineindex] == m_labelcodes[UNLABELED_Z4]))) {
 				if (intn == 1) {
-					results[vindex][lineindex] = m_labels[ACC_PASSING_UP]; // rising accented passing tone
+					results[vindex][lineindex] = m_labelcodes[ACC_PASSING_UP]; // rising accented passing tone
 				} else if (intn == -1) {
-					results[vindex][lineindex] = m_labels[ACC_UP_NEI]; // accented upper neighbor
+					results[vindex][lineindex] = m_labelcodes[ACC_UP_NEI]; // accented upper neighbor
 				}
 			} else if (intn == -1) {
-				if ((intp == 2) && (results[vindex][lineindexp] == m_labels[ECHAPPEE_DOWN]) &&
-					(((results[vindex][lineindex] == m_labels[UNLABELED_Z7]) ||
-						(results[vindex][lineindex] == m_labels[UNLABELED_Z4]) ||
-						(results[vindex][lineindex] == m_labels[REV_ECHAPPEE_UP])) ||
+				if ((intp == 2) && (results[vindex][lineindexp] == m_labelcodes[ECHAPPEE_DOWN]) &&
+					(((results[vindex][lineindex] == m_labelcodes[UNLABELED_Z7]) ||
+						(results[vindex][lineindex] == m_labelcodes[UNLABELED_Z4]) ||
+						(results[vindex][lineindex] == m_labelcodes[REV_ECHAPPEE_UP])) ||
 					 ((lev <= levn) && (dur <= durn)))) {
-					results[vindex][lineindexp] = m_labels[DBL_NEIGHBOR_DOWN];
-					results[vindex][lineindex]  = m_labels[DBL_NEIGHBOR_DOWN];
+					results[vindex][lineindexp] = m_labelcodes[DBL_NEIGHBOR_DOWN];
+					results[vindex][lineindex]  = m_labelcodes[DBL_NEIGHBOR_DOWN];
 				} else if (((fabs(intp) > 1) || ant_leapt_to) &&
 							((lev <= levn) && (dur <= durn)) &&
-							((results[vindex][lineindex] == m_labels[UNLABELED_Z7]) ||
-							(results[vindex][lineindex] == m_labels[UNLABELED_Z4]))) { // upper appoggiatura
-					results[vindex][lineindex] = m_labels[APP_UPPER];
+							((results[vindex][lineindex] == m_labelcodes[UNLABELED_Z7]) ||
+							(results[vindex][lineindex] == m_labelcodes[UNLABELED_Z4]))) { // upper appoggiatura
+					results[vindex][lineindex] = m_labelcodes[APP_UPPER];
 				}
 			} else if (intn == 1) {
-				if ((intp == -2) && (results[vindex][lineindexp] == m_labels[ECHAPPEE_UP]) &&
-					(((results[vindex][lineindex] == m_labels[UNLABELED_Z7]) ||
-						(results[vindex][lineindex] == m_labels[UNLABELED_Z4]) ||
-						(results[vindex][lineindex] == m_labels[REV_ECHAPPEE_DOWN])) ||
+				if ((intp == -2) && (results[vindex][lineindexp] == m_labelcodes[ECHAPPEE_UP]) &&
+					(((results[vindex][lineindex] == m_labelcodes[UNLABELED_Z7]) ||
+						(results[vindex][lineindex] == m_labelcodes[UNLABELED_Z4]) ||
+						(results[vindex][lineindex] == m_labelcodes[REV_ECHAPPEE_DOWN])) ||
 					 ((lev <= levn) && (dur <= durn)))) {
-					results[vindex][lineindexp] = m_labels[DBL_NEIGHBOR_UP];
-					results[vindex][lineindex]  = m_labels[DBL_NEIGHBOR_UP];
+					results[vindex][lineindexp] = m_labelcodes[DBL_NEIGHBOR_UP];
+					results[vindex][lineindex]  = m_labelcodes[DBL_NEIGHBOR_UP];
 				} else if (((fabs(intp) > 1) || ant_leapt_to) &&
 							((lev <= levn) && (dur <= durn)) &&
-							((results[vindex][lineindex] == m_labels[UNLABELED_Z7]) ||
-							(results[vindex][lineindex] == m_labels[UNLABELED_Z4]))) { // lower appoggiatura
-					results[vindex][lineindex] = m_labels[APP_LOWER];
+							((results[vindex][lineindex] == m_labelcodes[UNLABELED_Z7]) ||
+							(results[vindex][lineindex] == m_labelcodes[UNLABELED_Z4]))) { // lower appoggiatura
+					results[vindex][lineindex] = m_labelcodes[APP_LOWER];
 				}
 			}
 		}
@@ -39351,7 +44147,7 @@ void Tool_dissonant::findAppoggiaturas(vector<vector<string>>& results, NoteGrid
 //		Altizans must be found set against any of the other three types for
 //		anything to be detected.
 //
-void Tool_dissonant::findCadentialVoiceFunctions(vector<vector<string>>& results, NoteGrid& grid,
+void Tool_dissonant::findCadentialVoiceFunctions(vector<vector<int>>& results, NoteGrid& grid,
 		vector<NoteCell*>& attacks, vector<vector<string>>& voiceFuncs, int vindex) {
 	double int2;      // diatonic interval to next melodic note
 	double int3 = -22; // diatonic interval from next melodic note to following note
@@ -39382,8 +44178,8 @@ void Tool_dissonant::findCadentialVoiceFunctions(vector<vector<string>>& results
 	for (int i=1; i<(int)attacks.size()-1; i++) {
 		lineindex  = attacks[i]->getLineIndex();
 		// pass over if ref voice is not an agent
-		if ((results[vindex][lineindex] != m_labels[AGENT_BIN]) &&
-			(results[vindex][lineindex] != m_labels[AGENT_TERN])) {
+		if ((results[vindex][lineindex] != m_labelcodes[AGENT_BIN]) &&
+			(results[vindex][lineindex] != m_labelcodes[AGENT_TERN])) {
 			continue;
 		}
 		int2 = *attacks[i+1] - *attacks[i];
@@ -39395,8 +44191,8 @@ void Tool_dissonant::findCadentialVoiceFunctions(vector<vector<string>>& results
 			}
 
 			// skip if other voice isn't a patient
-			if ((results[j][lineindex] != m_labels[SUS_BIN]) &&
-				(results[j][lineindex] != m_labels[SUS_TERN])) {
+			if ((results[j][lineindex] != m_labelcodes[SUS_BIN]) &&
+				(results[j][lineindex] != m_labelcodes[SUS_TERN])) {
 				continue;
 			}
 
@@ -39464,12 +44260,12 @@ void Tool_dissonant::findCadentialVoiceFunctions(vector<vector<string>>& results
 				attInd3  = attacks[i+1]->getNextAttackIndex();
 				lineindex3 = attacks[i+2]->getLineIndex();
 				if (((thisMod7 == 6) || (thisMod7 == -1)) && (int2 == -1) &&
-					(results[vindex][lineindex2] == m_labels[ANT_DOWN]) &&
+					(results[vindex][lineindex2] == m_labelcodes[ANT_DOWN]) &&
 					(attInd3 == oattInd3) && (oint2 == -1) && (oint3 == 1)) {
 					voiceFuncs[j][lineindex3] = "C"; // cantizans
 					voiceFuncs[vindex][lineindex3] = "T"; // tenorizans
 				} else if ((thisMod7 == 3) && (int2 == -1) && (attInd3 == oattInd3) &&
-					(results[vindex][lineindex2] == m_labels[ANT_DOWN]) &&
+					(results[vindex][lineindex2] == m_labelcodes[ANT_DOWN]) &&
 					(oint2 == -1) && (oint3 == 1)) { // "^4xs 1 3sx -2 5xx$"
 					voiceFuncs[j][lineindex3] = "A"; // altizans
 					voiceFuncs[vindex][lineindex3] = "T"; // tenorizans
@@ -39587,22 +44383,21 @@ void Tool_dissonant::findCadentialVoiceFunctions(vector<vector<string>>& results
 // printCountAnalysis --
 //
 
-void Tool_dissonant::printCountAnalysis(vector<vector<string>>& data) {
+void Tool_dissonant::printCountAnalysis(vector<vector<int>>& data) {
 
 	map<string, bool> reduced;
 	bool brief = getBoolean("u");
 	bool percentQ = getBoolean("percent");
 
-	vector<map<string, int>> analysis;
+	vector<vector<int>> analysis;
 	analysis.resize(data.size());
 	int i;
 	int j;
 	for (i=0; i<(int)data.size(); i++) {
+		analysis[i].resize(LABELS_SIZE, 0);
 		for (j=0; j<(int)data[i].size(); j++) {
-			if (analysis[i].find(data[i][j]) != analysis[i].end()) {
+			if (data[i][j] >= 0) {
 				analysis[i][data[i][j]]++;
-			} else {
-				analysis[i][data[i][j]] = 1;
 			}
 		}
 	}
@@ -39619,6 +44414,7 @@ void Tool_dissonant::printCountAnalysis(vector<vector<string>>& data) {
 
 	int sumsum = 0;
 	int sum;
+	int code;
 	string item;
 	for (i=0; i<(int)LABELS_SIZE; i++) {
 		if (i == UNLABELED_Z2) {
@@ -39629,6 +44425,7 @@ void Tool_dissonant::printCountAnalysis(vector<vector<string>>& data) {
 		}
 
 		item = m_labels[i];
+		code = m_labelcodes[i];
 
 		if (brief && (reduced.find(item) != reduced.end())) {
 			continue;
@@ -39637,12 +44434,10 @@ void Tool_dissonant::printCountAnalysis(vector<vector<string>>& data) {
 
 		sum = 0;
 		for (j=0; j<(int)analysis.size(); j++) {
-			if (analysis[j].find(item) != analysis[j].end()) {
-				sum += analysis[j][item];
-				// Don't include agents in dissonant note summation.
-				if ((item != m_labels[AGENT_TERN]) && (item != m_labels[AGENT_BIN])) {
-					sumsum += analysis[j][item];
-				}
+			sum += analysis[j][code];
+			// Don't include agents in dissonant note summation.
+			if ((code != m_labelcodes[AGENT_TERN]) && (code != m_labelcodes[AGENT_BIN])) {
+				sumsum += analysis[j][code];
 			}
 		}
 
@@ -39655,15 +44450,15 @@ void Tool_dissonant::printCountAnalysis(vector<vector<string>>& data) {
 
 		for (int j=0; j<(int)analysis.size(); j++) {
 			m_humdrum_text << "\t";
-			if (analysis[j].find(item) != analysis[j].end()) {
+			if (analysis[j][code] > 0) {
 				if (percentQ) {
-					if ((item == m_labels[AGENT_BIN]) || (item == m_labels[AGENT_TERN])) {
+					if ((code == m_labelcodes[AGENT_BIN]) || (code == m_labelcodes[AGENT_TERN])) {
 						m_humdrum_text << ".";
 					} else {
-						m_humdrum_text << int(analysis[j][item] * 1.0 / sum * 1000.0 + 0.5) / 10.0;
+						m_humdrum_text << int(analysis[j][code] * 1.0 / sum * 1000.0 + 0.5) / 10.0;
 					}
 				} else {
-					m_humdrum_text << analysis[j][item];
+					m_humdrum_text << analysis[j][code];
 				}
 			} else {
 				m_humdrum_text << 0;
@@ -39684,6 +44479,32 @@ void Tool_dissonant::printCountAnalysis(vector<vector<string>>& data) {
 
 
 
+//////////////////////////////
+//
+// Tool_dissonant::getLabelStrings -- Convert the dissonance analysis
+//     from label codes into label text for output.
+//
+
+void Tool_dissonant::getLabelStrings(vector<vector<string>>& labels,
+		vector<vector<int>>& results) {
+	labels.resize(results.size());
+	for (int i=0; i<(int)results.size(); i++) {
+		labels[i].resize(results[i].size());
+		for (int j=0; j<(int)results[i].size(); j++) {
+			int code = results[i][j];
+			if (code >= 0) {
+				labels[i][j] = m_labels[code];
+			} else if (code == NULL_LABEL) {
+				labels[i][j] = ".";
+			} else {
+				labels[i][j] = "";
+			}
+		}
+	}
+}
+
+
+
 //////////////////////////////
 //
 // Tool_dissonant::getNextPitchAttackIndex -- Get the [line] index of the next
@@ -39777,6 +44598,8 @@ void Tool_dissonant::fillLabels(void) {
 	m_labels[UNLABELED_Z2        ] = "Z"; // unknown dissonance, 2nd interval
 	m_labels[UNLABELED_Z7        ] = "Z"; // unknown dissonance, 7th interval
 	m_labels[UNLABELED_Z4        ] = "z"; // unknown dissonance, 4th interval
+
+	fillLabelCodes();
 }
 
 
@@ -39837,6 +44660,32 @@ void Tool_dissonant::fillLabels2(void) {
 	m_labels[UNLABELED_Z2        ] = "Z"; // unknown dissonance, 2nd interval
 	m_labels[UNLABELED_Z7        ] = "Z"; // unknown dissonance, 7th interval
 	m_labels[UNLABELED_Z4        ] = "Z"; // unknown dissonance, 4th interval
+
+	fillLabelCodes();
+}
+
+
+
+//////////////////////////////
+//
+// Tool_dissonant::fillLabelCodes -- The analysis stores dissonance types as
+//     integer codes rather than strings.  Dissonance types which share the
+//     same label text (such as the types merged by --undirected) are given
+//     the code of the first type with that label, so that testing for a
+//     label is an integer comparison.
+//
+
+void Tool_dissonant::fillLabelCodes(void) {
+	m_labelcodes.resize(m_labels.size());
+	for (int i=0; i<(int)m_labels.size(); i++) {
+		m_labelcodes[i] = i;
+		for (int j=0; j<i; j++) {
+			if (m_labels[j] == m_labels[i]) {
+				m_labelcodes[i] = j;
+				break;
+			}
+		}
+	}
 }
 
 
@@ -39855,6 +44704,8 @@ Tool_esac2hum::Tool_esac2hum(void) {
 	define("s|split=s:file",     "Split song info into separate files");
 	define("x|extension=s:.krn", "Split filename extension");
 	define("f|first=i:1",        "Number of first split filename");
+	define("j|threads=i:0",      "Number of songs to convert at the same time");
+	define("report=b",           "Print conversion time and errors for each song");
 	define("author=b",           "author of program");
 	define("version=b",          "compilation info");
 	define("example=b",          "example usages");
@@ -39881,16 +44732,14 @@ bool Tool_esac2hum::convertFile(ostream& out, const string& filename) {
 
 
 bool Tool_esac2hum::convert(ostream& out, istream& input) {
-	convertEsacToHumdrum(out, input);
-	return true;
+	return convertEsacToHumdrum(out, input);
 }
 
 
 bool Tool_esac2hum::convert(ostream& out, const string& input) {
 	stringstream ss;
 	ss << input;
-	convertEsacToHumdrum(out, ss);
-	return true;
+	return convertEsacToHumdrum(out, ss);
 }
 
 
@@ -39943,6 +44792,8 @@ bool Tool_esac2hum::initialize(void) {
 	namebase = getString("split");
 	fileextension = getString("extension");
 	firstfilenum = getInteger("first");
+	threads = HumParallel::getThreadCount(getInteger("threads"));
+	reportQ = getBoolean("report");
 	return true;
 }
 
@@ -39953,112 +44804,200 @@ bool Tool_esac2hum::initialize(void) {
 
 //////////////////////////////
 //
-// Tool_esac2hum::convertEsacToHumdrum --
+// Tool_esac2hum::convertEsacToHumdrum -- Split the input into songs
+//     and then convert the songs, several at a time if more than one
+//     thread is used.  Each group of 16 songs is converted by a separate
+//     copy of the tool.  With the -s option, each song is written to its own file
+//     directly; otherwise, the songs are written to the output in their
+//     input order (directly when using one thread, or after each batch
+//     of songs has been converted).  Errors for a song are stored as
+//     warnings, and false is returned if any song had an error.
 //
 
-void Tool_esac2hum::convertEsacToHumdrum(ostream& output, istream& infile) {
+bool Tool_esac2hum::convertEsacToHumdrum(ostream& output, istream& infile) {
 	initialize();
-	vector<string> song;
-	song.reserve(400);
-	int init = 0;
-	// int filecounter = firstfilenum;
-	string outfilename;
-	string numberstring;
-	// ofstream outfile;
-	while (!infile.eof()) {
-		if (debugQ) {
-			cerr << "Getting a song..." << endl;
-		}
-		getSong(song, infile, init);
-		if (debugQ) {
-			cerr << "Got a song ..." << endl;
-		}
-		init = 1;
-/*
-		if (splitQ) {
-			outfilename = namebase);
-			outfilename += to_string(filecounter);
-			if (filecounter < 1000) {
-				outfilename += "0";
-			}
-			if (filecounter < 100) {
-				outfilename += "0";
-			}
-			if (filecounter < 10) {
-				outfilename += "0";
+	vector<vector<string>> songs;
+	vector<int> songlines;
+	getSongs(songs, songlines, infile);
+
+	int songcount = (int)songs.size();
+	vector<double> times(songcount, 0.0);
+	vector<string> errors(songcount);
+	bool directQ = splitQ || (threads <= 1);
+	int chunksize = 16;
+	int batchsize = directQ ? songcount : threads * chunksize * 4;
+
+	for (int start=0; start<songcount; start+=batchsize) {
+		int count = std::min(batchsize, songcount - start);
+		int chunkcount = (count + chunksize - 1) / chunksize;
+		vector<string> outputs(directQ ? 0 : count);
+		HumParallel::run(chunkcount, threads, [&](int chunk) {
+			// Each chunk of songs is converted with a separate copy of the
+			// tool, since the conversion stores information about the
+			// current song.
+			Tool_esac2hum worker;
+			worker.debugQ = debugQ;
+			worker.verboseQ = verboseQ;
+			worker.header = header;
+			worker.trailer = trailer;
+			int first = chunk * chunksize;
+			int last = std::min(first + chunksize, count);
+			for (int k=first; k<last; k++) {
+				int i = start + k;
+				auto starttime = std::chrono::steady_clock::now();
+				int cutindex = 0;
+				while ((cutindex < (int)songs[i].size()) &&
+						(songs[i][cutindex].compare(0, 4, "CUT[") != 0)) {
+					cutindex++;
+				}
+				worker.inputline = songlines[i] + (int)songs[i].size() - cutindex - 1;
+				worker.m_error_text.str("");
+				bool converted = false;
+				if (splitQ) {
+					stringstream out;
+					converted = worker.convertSong(songs[i], out);
+					string filename = getSplitFilename(i);
+					ofstream outfile;
+					if (converted) {
+						outfile.open(filename);
+					}
+					if (outfile.is_open()) {
+						outfile << out.str();
+					} else if (converted) {
+						worker.m_error_text << "Error: cannot write to file: "
+						                    << filename << endl;
+					}
+				} else if (directQ) {
+					converted = worker.convertSong(songs[i], output);
+				} else {
+					stringstream out;
+					converted = worker.convertSong(songs[i], out);
+					outputs[k] = out.str();
+				}
+				errors[i] = worker.m_error_text.str();
+				if (!converted && errors[i].empty()) {
+					errors[i] = "Error: song could not be converted\n";
+				}
+				times[i] = std::chrono::duration<double, std::milli>(
+						std::chrono::steady_clock::now() - starttime).count();
 			}
-			outfilename += numberstring;
-			outfilename += fileextension;
-			filecounter++;
-
-			outfile.open(outfilename);
+		});
+		for (int k=0; k<(int)outputs.size(); k++) {
+			output << outputs[k];
+		}
+	}
 
-			if (!outfile.is_open()) {
-				cerr << "Error: cannot write to file: " << outfilename << endl;
-			}
-			convertSong(song, outfile);
-			outfile.close();
-		} else {
-*/
-			convertSong(song, output);
-/*
+	bool status = true;
+	for (int i=0; i<songcount; i++) {
+		if (!errors[i].empty()) {
+			status = false;
+			m_warning_text << "Song " << (i+1) << " (input line "
+			               << songlines[i] << "):\n" << errors[i];
 		}
-*/
 	}
+	if (reportQ) {
+		printReport(m_free_text, songs, songlines, times, errors);
+	}
+	return status;
 }
 
 
 
 //////////////////////////////
 //
-// Tool_esac2hum::getSong -- get a song from the ESac file
+// Tool_esac2hum::getSongs -- Split the input data into songs, with each
+//     song starting at a CUT[] line.  Global comments before the first
+//     song are included in the first song.  The input line numbers
+//     (starting at 1) of the first line of each song are stored in
+//     songlines.
 //
 
-bool Tool_esac2hum::getSong(vector<string>& song, istream& infile, int init) {
-	static char holdbuffer[10000] = {0};
+void Tool_esac2hum::getSongs(vector<vector<string>>& songs,
+		vector<int>& songlines, istream& infile) {
+	songs.clear();
+	songlines.clear();
+	vector<string> comments;
+	string line;
+	int linenum = 0;
 
-	song.resize(0);
-	if (init) {
-		// do nothing holdbuffer has the CUT[] information
-	} else {
-		strcpy(holdbuffer, "");
-		while (!infile.eof() && strncmp(holdbuffer, "CUT[", 4) != 0) {
-			infile.getline(holdbuffer, 256, '\n');
-			if (verboseQ) {
-				cerr << "Contents: " << holdbuffer << endl;
-			}
-			if (strncmp(holdbuffer, "!!", 2) == 0) {
-				song.push_back(holdbuffer);
-			}
+	while (getline(infile, line)) {
+		linenum++;
+		if (!line.empty() && (line.back() == '\r')) {
+			line.resize(line.size() - 1);
 		}
-		if (infile.eof()) {
-			return false;
+		if (verboseQ) {
+			cerr << "READ LINE: " << line << endl;
+		}
+		if (line.compare(0, 4, "CUT[") == 0) {
+			songs.emplace_back();
+			songlines.push_back(linenum);
+			if (songs.size() == 1) {
+				songs.back().swap(comments);
+			} else {
+				chopExtraInfo(line);
+			}
+			songs.back().push_back(line);
+		} else if (!songs.empty()) {
+			chopExtraInfo(line);
+			songs.back().push_back(line);
+		} else if (line.compare(0, 2, "!!") == 0) {
+			comments.push_back(line);
 		}
 	}
+}
 
-	if (!infile.eof()) {
-		song.push_back(holdbuffer);
-	} else {
-		return false;
-	}
 
-	infile.getline(holdbuffer, 256, '\n');
-	chopExtraInfo(holdbuffer);
-	inputline++;
-	if (verboseQ) {
-		cerr << "READ LINE: " << holdbuffer << endl;
-	}
-	while (!infile.eof() && strncmp(holdbuffer, "CUT[", 4) != 0) {
-		song.push_back(holdbuffer);
-		infile.getline(holdbuffer, 256, '\n');
-		chopExtraInfo(holdbuffer);
-		inputline++;
-		if (verboseQ) {
-			cerr << "READ ANOTHER LINE: " << holdbuffer << endl;
+
+//////////////////////////////
+//
+// Tool_esac2hum::getSplitFilename -- Return the output filename for a
+//     song when using the -s option: the split name followed by the
+//     song number (at least four digits) and the file extension.
+//
+
+string Tool_esac2hum::getSplitFilename(int index) {
+	stringstream ss;
+	ss << namebase << std::setfill('0') << std::setw(4) << (index + firstfilenum)
+	   << fileextension;
+	return ss.str();
+}
+
+
+
+//////////////////////////////
+//
+// Tool_esac2hum::printReport -- Print the conversion time and status
+//     of each song, followed by a summary line.
+//
+
+void Tool_esac2hum::printReport(ostream& out, vector<vector<string>>& songs,
+		vector<int>& songlines, vector<double>& times,
+		vector<string>& errors) {
+	double total = 0.0;
+	int failures = 0;
+	out << "!!song\tline\tmsec\tstatus\ttitle\n";
+	for (int i=0; i<(int)songs.size(); i++) {
+		string title;
+		for (int j=0; j<(int)songs[i].size(); j++) {
+			if (songs[i][j].compare(0, 4, "CUT[") == 0) {
+				title = songs[i][j].substr(4);
+				if (!title.empty() && (title.back() == ']')) {
+					title.resize(title.size() - 1);
+				}
+				break;
+			}
 		}
+		total += times[i];
+		if (!errors[i].empty()) {
+			failures++;
+		}
+		out << (i+1) << "\t" << songlines[i] << "\t"
+		    << std::fixed << std::setprecision(3) << times[i] << "\t"
+		    << (errors[i].empty() ? "ok" : "error") << "\t"
+		    << title << "\n";
 	}
-
-	return true;
+	out << "!!songs: " << songs.size() << ", errors: " << failures
+	    << ", total msec: " << std::fixed << std::setprecision(3) << total << "\n";
 }
 
 
@@ -40068,15 +45007,15 @@ bool Tool_esac2hum::getSong(vector<string>& song, istream& infile, int init) {
 // Tool_esac2hum::chopExtraInfo -- remove phrase number information from Luxembourg data.
 //
 
-void Tool_esac2hum::chopExtraInfo(char* holdbuffer) {
-	int length = (int)strlen(holdbuffer);
+void Tool_esac2hum::chopExtraInfo(string& line) {
+	int length = (int)line.size();
 	int i;
 	int spacecount = 0;
 	for (i=length-2; i>=0; i--) {
-		if (holdbuffer[i] == ' ') {
+		if (line[i] == ' ') {
 			spacecount++;
 			if (spacecount > 10) {
-				holdbuffer[i] = '\0';
+				line.resize(i);
 				break;
 			}
 		} else {
@@ -40141,25 +45080,32 @@ void Tool_esac2hum::printHumdrumFooterInfo(ostream& out, vector<string>& song) {
 
 //////////////////////////////
 //
-// Tool_esac2hum::convertSong --
+// Tool_esac2hum::convertSong -- Convert one song.  Returns false without
+//     printing the song if its KEY[] entry cannot be read, in which case
+//     the error is stored in m_error_text.
 //
 
-void Tool_esac2hum::convertSong(vector<string>& song, ostream& out) {
+bool Tool_esac2hum::convertSong(vector<string>& song, ostream& out) {
 
 	int i;
+	chartable.assign(256, 0);
 	if (verboseQ) {
 		for (i=0; i<(int)song.size(); i++) {
 			out << song[i] << "\n";
 		}
 	}
 
-	printHumdrumHeaderInfo(out, song);
-
 	string key;
 	double mindur = 1.0;
 	string meter;
 	int tonic;
-	getKeyInfo(song, key, mindur, tonic, meter, out);
+	stringstream keywarnings;
+	if (!getKeyInfo(song, key, mindur, tonic, meter, keywarnings)) {
+		return false;
+	}
+
+	printHumdrumHeaderInfo(out, song);
+	out << keywarnings.str();
 
 	vector<NoteData> songdata;
 	songdata.resize(0);
@@ -40249,6 +45195,8 @@ void Tool_esac2hum::convertSong(vector<string>& song, ostream& out) {
 		out << "\n!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!" << endl;
 	}
 */
+
+	return true;
 }
 
 
@@ -40271,7 +45219,7 @@ bool Tool_esac2hum::placeLyrics(vector<string>& song, vector<NoteData>& songdata
 	string buffer;
 	for (line=0; line<=stop-start; line++) {
 		if (song[line+start].size() <= 4) {
-			cerr << "Error: lyric line is too short!: "
+			m_error_text << "Error: lyric line is too short!: "
 				  << song[line+start] << endl;
 			return false;
 		}
@@ -40431,8 +45379,8 @@ bool Tool_esac2hum::placeLyricPhrase(vector<NoteData>& songdata, vector<string>&
 	start = i;
 
 	if (!found) {
-		cerr << "Error: cannot find music for lyrics line " << line << endl;
-		cerr << "Error near input data line: " << inputline << endl;
+		m_error_text << "Error: cannot find music for lyrics line " << line << endl;
+		m_error_text << "Error near input data line: " << inputline << endl;
 		return false;
 	}
 
@@ -40561,7 +45509,7 @@ bool Tool_esac2hum::printTitleInfo(vector<string>& song, ostream& out) {
 	int stop = -1;
 	getLineRange(song, "CUT", start, stop);
 	if (start == -1) {
-		cerr << "Error: cannot find CUT[] field in song: " << song[0] << endl;
+		m_error_text << "Error: cannot find CUT[] field in song: " << song[0] << endl;
 		return false;
 	}
 
@@ -41067,7 +46015,7 @@ bool Tool_esac2hum::getNoteList(vector<string>& song, vector<NoteData>& songdata
 
 	for (i=melstart; i<=melstop; i++) {
 		if (song[i].size() < 4) {
-			cerr << "Error: invalid line in MEL[]: " << song[i] << endl;
+			m_error_text << "Error: invalid line in MEL[]: " << song[i] << endl;
 			return false;
 		}
 		j = 4;
@@ -41129,7 +46077,7 @@ bool Tool_esac2hum::getNoteList(vector<string>& song, vector<NoteData>& songdata
 //            case '>':                     break;   // unknown marker
 //            case '<':                     break;   //
 				case '^': tie = 1; state = STATE_NOTE; break;
-				default : cerr << "Error: unknown character " << song[i][j]
+				default : m_error_text << "Error: unknown character " << song[i][j]
 							      << " on the line: " << song[i] << endl;
 							 return false;
 			}
@@ -41338,6 +46286,10 @@ bool Tool_esac2hum::getKeyInfo(vector<string>& song, string& key, double& mindur
 	int i;
 	for (i=0; i<(int)song.size(); i++) {
 		if (song[i].compare(0, 4, "KEY[") == 0) {
+			if (song[i].size() < 18) {
+				m_error_text << "Error: KEY field is too short: " << song[i] << endl;
+				return false;
+			}
 			key = song[i][4]; // letter
 			key += song[i][5]; // number
 			key += song[i][6]; // number
@@ -41359,13 +46311,12 @@ bool Tool_esac2hum::getKeyInfo(vector<string>& song, string& key, double& mindur
 
 			string tonicstr;
 			if (song[i][14] != ' ') {
-				tonicstr[0] = song[i][14];
+				tonicstr = song[i][14];
 				if (tolower(song[i][15]) == 'b') {
-					tonicstr[1] = '-';
+					tonicstr += '-';
 				} else {
-					tonicstr[1] = song[i][15];
+					tonicstr += song[i][15];
 				}
-				tonicstr[2] = '\0';
 			} else {
 				tonicstr = song[i][15];
 			}
@@ -41381,15 +46332,15 @@ bool Tool_esac2hum::getKeyInfo(vector<string>& song, string& key, double& mindur
 
 			tonic = Convert::kernToBase40(tonicstr);
 			if (tonic <= 0) {
-				cerr << "Error: invalid tonic on line: " << song[i] << endl;
+				m_error_text << "Error: invalid tonic on line: " << song[i] << endl;
 				return false;
 			}
 			tonic = tonic % 40;
 			meter = song[i].substr(17);
 			if (meter.back() != ']') {
-				cerr << "Error with meter on line: " << song[i] << endl;
-				cerr << "Meter area: " << meter << endl;
-				cerr << "Expected ] as last character but found " << meter.back() << endl;
+				m_error_text << "Error with meter on line: " << song[i] << endl;
+				m_error_text << "Meter area: " << meter << endl;
+				m_error_text << "Expected ] as last character but found " << meter.back() << endl;
 				return false;
 			} else {
 				meter.resize((int)meter.size() - 1);
@@ -41397,7 +46348,7 @@ bool Tool_esac2hum::getKeyInfo(vector<string>& song, string& key, double& mindur
 			return true;
 		}
 	}
-	cerr << "Error: did not find a KEY field" << endl;
+	m_error_text << "Error: did not find a KEY field" << endl;
 	return false;
 }
 
@@ -41632,7 +46583,7 @@ bool Tool_extract::run(HumdrumFile& infile, ostream& out) {
 //
 
 bool Tool_extract::run(HumdrumFile& infile) {
-	initialize(infile);
+	initialize();
 	processFile(infile);
 	// Re-load the text for each line from their tokens.
 	// infile.createLinesFromTokens();
@@ -41640,6 +46591,135 @@ bool Tool_extract::run(HumdrumFile& infile) {
 }
 
 
+//
+// Line-at-a-time interface: each line is extracted and printed before
+// the next line is read.  Only used for lists of spine numbers given
+// with the -f and -x options (see isLineStreamable()), which do not
+// depend on the number of tracks.  Tracks may be added later in a
+// segment with *+, so the list is calculated once with a limit large
+// enough for all of the numbers in it.  The output of a segment from its
+// exclusive interpretation line is held back until the segment has as
+// many tracks as the largest number in the list (normally at that same
+// line), and is discarded if the list is still out of range at the end
+// of the segment.  As when
+// reading one segment at a time, processing stops after a segment with
+// errors.
+//
+
+bool Tool_extract::run(HumdrumLineStream& instream) {
+	initialize();
+	int limit = 1;
+	int value = 0;
+	for (int i=0; i<(int)fieldstring.size(); i++) {
+		if (isdigit(fieldstring[i])) {
+			value = value * 10 + fieldstring[i] - '0';
+			limit = std::max(limit, value);
+		} else {
+			value = 0;
+		}
+	}
+	fillFieldData(field, subfield, model, fieldstring, limit, NULL);
+	m_error_text.str("");
+
+	// held: Output of the current segment before its tracks are known.
+	std::ios& output = static_cast<std::ios&>(m_humdrum_text);
+	std::streambuf* target = output.rdbuf();
+	std::stringbuf held;
+	bool heldQ = false;
+	auto release = [&](void) {
+		output.rdbuf(target);
+		m_humdrum_text << held.str();
+		held.str("");
+		heldQ = false;
+	};
+	auto checkSegment = [&](int maxtrack) {
+		vector<int> checkfield;
+		vector<int> checksubfield;
+		vector<int> checkmodel;
+		fillFieldData(checkfield, checksubfield, checkmodel, fieldstring, maxtrack, NULL);
+		if (hasError()) {
+			output.rdbuf(target);
+			return false;
+		}
+		release();
+		return true;
+	};
+
+	int maxtrack = -1;
+	bool startQ = false;
+	remapQ = 1;
+	HLp line;
+	while ((line = instream.getLine())) {
+		if (line->getLineIndex() == 0) {
+			if (heldQ && !checkSegment(maxtrack)) {
+				return false;
+			}
+			startQ = true;
+		}
+		maxtrack = instream.getMaxTrack();
+		if (startQ && (maxtrack > 0)) {
+			// exclusive interpretation line of the segment
+			startQ = false;
+			output.rdbuf(&held);
+			heldQ = true;
+		}
+		if (heldQ && (maxtrack >= limit)) {
+			release();
+		}
+		if (fieldQ) {
+			extractFields(*line, limit, field, subfield, model);
+		} else {
+			excludeFields(*line, field, subfield, model);
+		}
+	}
+	if (instream.hasError()) {
+		output.rdbuf(target);
+		m_error_text << instream.getError();
+		return false;
+	}
+	if (heldQ) {
+		return checkSegment(maxtrack);
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_extract::isLineStreamable -- Only plain lists of spine numbers
+//    given with the -f or -x options can be extracted one line at a time.
+//    Subspines and cospines (a, b, c) need the rest of the file, as do
+//    the options which select spines by their contents, and $ needs the
+//    final number of tracks.
+//
+
+bool Tool_extract::isLineStreamable(void) {
+	vector<string> fileoptions = { "author", "version", "help", "example",
+		"debug", "count", "trace", "spine-list", "i", "I", "k", "grep",
+		"reverse", "R", "expand", "E", "empty", "no-empty" };
+	for (int i=0; i<(int)fileoptions.size(); i++) {
+		if (getBoolean(fileoptions[i])) {
+			return false;
+		}
+	}
+	string fields;
+	if (getBoolean("x")) {
+		fields = getString("x");
+	} else if (getBoolean("f")) {
+		fields = getString("f");
+	} else {
+		return false;
+	}
+	for (int i=0; i<(int)fields.size(); i++) {
+		if (isalpha(fields[i]) || (fields[i] == '$')) {
+			return false;
+		}
+	}
+	return true;
+}
+
+
 
 //////////////////////////////
 //
@@ -41666,7 +46746,7 @@ void Tool_extract::processFile(HumdrumFile& infile) {
 	} else if (noEmptyQ) {
 		fillFieldDataByNoEmpty(field, subfield, model, infile, interpstate);
 	} else if (fieldQ || excludeQ) {
-		fillFieldData(field, subfield, model, fieldstring, infile);
+		fillFieldData(field, subfield, model, fieldstring, infile.getMaxTrack(), &infile);
 	}
 
 	if (spineListQ) {
@@ -41847,8 +46927,12 @@ void Tool_extract::fillFieldDataByGrep(vector<int>& field, vector<int>& subfield
 			continue;
 		}
 		for (j=0; j<infile[i].getFieldCount(); j++) {
+			track = infile[i].token(j)->getTrack();
+			if (tracks[track]) {
+				// track already selected
+				continue;
+			}
 			if (hre.search(infile.token(i, j), searchstring.c_str(), "")) {
-				track = infile[i].token(j)->getTrack();
 				tracks[track] = 1;
 			}
 		}
@@ -42107,13 +47191,13 @@ void Tool_extract::reverseSpines(vector<int>& field, vector<int>& subfield, vect
 
 //////////////////////////////
 //
-// Tool_extract::fillFieldData --
+// Tool_extract::fillFieldData -- The input file is needed only for
+//     the -k option, and can be NULL otherwise.
 //
 
 void Tool_extract::fillFieldData(vector<int>& field, vector<int>& subfield,
-		vector<int>& model, string& fieldstring, HumdrumFile& infile) {
-
-	int maxtrack = infile.getMaxTrack();
+		vector<int>& model, string& fieldstring, int maxtrack,
+		HumdrumFile* infile) {
 
 	field.reserve(maxtrack);
 	field.resize(0);
@@ -42136,7 +47220,8 @@ void Tool_extract::fillFieldData(vector<int>& field, vector<int>& subfield,
 		tempfield.clear();
 		tempsubfield.clear();
 		tempmodel.clear();
-		processFieldEntry(tempfield, tempsubfield, tempmodel, hre.getMatch(1), infile);
+		processFieldEntry(tempfield, tempsubfield, tempmodel, hre.getMatch(1),
+				maxtrack, infile);
 		start += hre.getMatchEndIndex(1);
 		field.insert(field.end(), tempfield.begin(), tempfield.end());
 		subfield.insert(subfield.end(), tempsubfield.begin(), tempsubfield.end());
@@ -42156,13 +47241,14 @@ void Tool_extract::fillFieldData(vector<int>& field, vector<int>& subfield,
 
 void Tool_extract::processFieldEntry(vector<int>& field,
 		vector<int>& subfield, vector<int>& model, const string& astring,
-		HumdrumFile& infile) {
+		int maxtrack, HumdrumFile* infile) {
 
 	int finitsize = (int)field.size();
-	int maxtrack = infile.getMaxTrack();
 
 	vector<HTp> ktracks;
-	infile.getKernSpineStartList(ktracks);
+	if (kernQ && infile) {
+		infile->getKernSpineStartList(ktracks);
+	}
 	int maxkerntrack = (int)ktracks.size();
 
 	int modletter;
@@ -42269,7 +47355,7 @@ void Tool_extract::processFieldEntry(vector<int>& field,
 		}
 	}
 
-	if (!kernQ) {
+	if (!kernQ || !infile) {
 		return;
 	}
 
@@ -42279,7 +47365,7 @@ void Tool_extract::processFieldEntry(vector<int>& field,
 	vector<int> newmodel;
 
 	vector<HTp> trackstarts;
-	infile.getTrackStartList(trackstarts);
+	infile->getTrackStartList(trackstarts);
 	int i, j;
 	int spine;
 
@@ -42360,28 +47446,118 @@ void Tool_extract::removeDollarsFromString(string& buffer, int maxtrack) {
 
 void Tool_extract::excludeFields(HumdrumFile& infile, vector<int>& field,
 		vector<int>& subfield, vector<int>& model) {
-	int start = 0;
+	remapQ = 1;
 	for (int i=0; i<infile.getLineCount(); i++) {
-		if (!infile[i].hasSpines()) {
-			m_humdrum_text << infile[i] << '\n';
+		excludeFields(infile[i], field, subfield, model);
+	}
+}
+
+
+void Tool_extract::excludeFields(HumdrumLine& line, vector<int>& field,
+		vector<int>& subfield, vector<int>& model) {
+	if (!line.hasSpines()) {
+		m_humdrum_text << line << '\n';
+		return;
+	}
+	if (remapQ || line.isManipulator()) {
+		makeExcludeMap(line, field);
+	}
+	remapQ = line.isManipulator();
+	printFieldMap(line);
+}
+
+
+
+//////////////////////////////
+//
+// Tool_extract::makeExcludeMap -- Store the input fields on the line
+//     which are not in the list of excluded tracks.
+//
+
+void Tool_extract::makeExcludeMap(HumdrumLine& line, vector<int>& field) {
+	vector<char> excluded;
+	for (int i=0; i<(int)field.size(); i++) {
+		if (field[i] < 0) {
 			continue;
-		} else {
-			start = 0;
-			for (int j=0; j<infile[i].getFieldCount(); j++) {
-				if (isInList(infile[i].token(j)->getTrack(), field)) {
-					continue;
-				}
-				if (start != 0) {
-					m_humdrum_text << '\t';
-				}
-				start = 1;
-				m_humdrum_text << infile.token(i, j);
-			}
-			if (start != 0) {
-				m_humdrum_text << endl;
+		}
+		if (field[i] >= (int)excluded.size()) {
+			excluded.resize(field[i] + 1, 0);
+		}
+		excluded[field[i]] = 1;
+	}
+	fieldmap.clear();
+	for (int j=0; j<line.getFieldCount(); j++) {
+		int track = line.token(j)->getTrack();
+		if ((track >= 0) && (track < (int)excluded.size()) && excluded[track]) {
+			continue;
+		}
+		fieldmap.push_back(j);
+	}
+	fieldmapQ = 1;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_extract::makeFieldMap -- Store the input fields on the line for
+//     each extracted spine, in output order, or -1 for blank spines
+//     (track 0).  The map is the same for all lines until the next spine
+//     manipulator.  Returns false if the line has to be processed field by
+//     field (for subspines and cospines).
+//
+
+bool Tool_extract::makeFieldMap(HumdrumLine& line, vector<int>& field,
+		vector<int>& subfield) {
+	fieldmap.clear();
+	for (int t=0; t<(int)field.size(); t++) {
+		if (subfield[t]) {
+			fieldmap.clear();
+			return false;
+		}
+		if (field[t] == 0) {
+			fieldmap.push_back(-1);
+			continue;
+		}
+		for (int j=0; j<line.getFieldCount(); j++) {
+			if (line.token(j)->getTrack() == field[t]) {
+				fieldmap.push_back(j);
 			}
 		}
 	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_extract::printFieldMap -- Print the fields of the line given in
+//     the field map.
+//
+
+void Tool_extract::printFieldMap(HumdrumLine& line) {
+	if (fieldmap.empty()) {
+		return;
+	}
+	for (int k=0; k<(int)fieldmap.size(); k++) {
+		if (k > 0) {
+			m_humdrum_text << '\t';
+		}
+		int j = fieldmap[k];
+		if (j >= 0) {
+			m_humdrum_text << *line.token(j);
+		} else if (line.isLocalComment()) {
+			m_humdrum_text << "!";
+		} else if (line.isBarline()) {
+			m_humdrum_text << *line.token(0);
+		} else if (line.isData()) {
+			m_humdrum_text << ".";
+		} else if (line.isInterpretation()) {
+			m_humdrum_text << "*";
+		}
+	}
+	m_humdrum_text << '\n';
 }
 
 
@@ -42393,6 +47569,21 @@ void Tool_extract::excludeFields(HumdrumFile& infile, vector<int>& field,
 
 void Tool_extract::extractFields(HumdrumFile& infile, vector<int>& field,
 		vector<int>& subfield, vector<int>& model) {
+	int maxtrack = infile.getMaxTrack();
+	remapQ = 1;
+	for (int i=0; i<infile.getLineCount(); i++) {
+		extractFields(infile[i], maxtrack, field, subfield, model);
+	}
+}
+
+
+//
+// Single-line version: the secondary subspine and cospine (b and c)
+// fields require the line to be in a HumdrumFile.
+//
+
+void Tool_extract::extractFields(HumdrumLine& line, int maxtrack,
+		vector<int>& field, vector<int>& subfield, vector<int>& model) {
 
 	HumRegex hre;
 	int start = 0;
@@ -42401,107 +47592,114 @@ void Tool_extract::extractFields(HumdrumFile& infile, vector<int>& field,
 	int modeltarget;
 	string spat;
 
-	for (int i=0; i<infile.getLineCount(); i++) {
-		if (!infile[i].hasSpines()) {
-			m_humdrum_text << infile[i] << '\n';
-			continue;
-		}
+	if (!line.hasSpines()) {
+		m_humdrum_text << line << '\n';
+		return;
+	}
 
-		if (infile[i].isManipulator()) {
-			dealWithSpineManipulators(infile, i, field, subfield, model);
-			continue;
-		}
+	if (line.isManipulator()) {
+		dealWithSpineManipulators(line, maxtrack, field, subfield, model);
+		remapQ = 1;
+		return;
+	}
 
-		start = 0;
-		for (int t=0; t<(int)field.size(); t++) {
-			target = field[t];
-			subtarget = subfield[t];
-			modeltarget = model[t];
-			if (modeltarget == 0) {
-				switch (subtarget) {
-					 case 'a':
-					 case 'b':
-					    modeltarget = submodel;
-					    break;
-					 case 'c':
-					    modeltarget = comodel;
-				}
-			}
-			if (target == 0) {
-				if (start != 0) {
-					 m_humdrum_text << '\t';
-				}
-				start = 1;
-				if (!infile[i].isManipulator()) {
-					if (infile[i].isLocalComment()) {
-						m_humdrum_text << "!";
-					} else if (infile[i].isBarline()) {
-						m_humdrum_text << infile[i].token(0);
-					} else if (infile[i].isData()) {
-				       m_humdrum_text << ".";
-					    // interpretations handled in dealWithSpineManipulators()
-					    // [obviously not, so adding a blank one here
-					} else if (infile[i].isInterpretation()) {
-					    m_humdrum_text << "*";
-					 }
-				}
-			} else {
-				for (int j=0; j<infile[i].getFieldCount(); j++) {
-					 if (infile[i].token(j)->getTrack() != target) {
-					    continue;
-					 }
-					 switch (subtarget) {
-					 case 'a':
-					    getSearchPat(spat, target, "a");
-					    if (hre.search(infile.token(i,j)->getSpineInfo(), spat) ||
-					          !hre.search(infile.token(i, j)->getSpineInfo(), "\\(")) {
-					       if (start != 0) {
-					          m_humdrum_text << '\t';
-					       }
-					       start = 1;
-					       m_humdrum_text << infile.token(i, j);
-					    }
-					    break;
-					 case 'b':
-					    getSearchPat(spat, target, "b");
-					    if (hre.search(infile.token(i, j)->getSpineInfo(), spat)) {
-					       if (start != 0) {
-					          m_humdrum_text << '\t';
-					       }
-					       start = 1;
-					       m_humdrum_text << infile.token(i, j);
-					    } else if (!hre.search(infile.token(i, j)->getSpineInfo(),
-					          "\\(")) {
-					       if (start != 0) {
-					          m_humdrum_text << '\t';
-					       }
-					       start = 1;
-					       dealWithSecondarySubspine(field, subfield, model, t,
-					             infile, i, j, modeltarget);
-					    }
-					    break;
-					 case 'c':
-					    if (start != 0) {
-					       m_humdrum_text << '\t';
-					    }
-					    start = 1;
-					    dealWithCospine(field, subfield, model, t, infile, i, j,
-					       modeltarget, modeltarget, cointerp);
-					    break;
-					 default:
-					    if (start != 0) {
-					       m_humdrum_text << '\t';
-					    }
-					    start = 1;
-					    m_humdrum_text << infile.token(i, j);
-					 }
-				}
+	if (remapQ) {
+		fieldmapQ = makeFieldMap(line, field, subfield);
+		remapQ = 0;
+	}
+	if (fieldmapQ) {
+		printFieldMap(line);
+		return;
+	}
+
+	for (int t=0; t<(int)field.size(); t++) {
+		target = field[t];
+		subtarget = subfield[t];
+		modeltarget = model[t];
+		if (modeltarget == 0) {
+			switch (subtarget) {
+				 case 'a':
+				 case 'b':
+				    modeltarget = submodel;
+				    break;
+				 case 'c':
+				    modeltarget = comodel;
 			}
 		}
-		if (start != 0) {
-			m_humdrum_text << endl;
+		if (target == 0) {
+			if (start != 0) {
+				 m_humdrum_text << '\t';
+			}
+			start = 1;
+			if (!line.isManipulator()) {
+				if (line.isLocalComment()) {
+					m_humdrum_text << "!";
+				} else if (line.isBarline()) {
+					m_humdrum_text << line.token(0);
+				} else if (line.isData()) {
+			       m_humdrum_text << ".";
+				    // interpretations handled in dealWithSpineManipulators()
+				    // [obviously not, so adding a blank one here
+				} else if (line.isInterpretation()) {
+				    m_humdrum_text << "*";
+				 }
+			}
+		} else {
+			for (int j=0; j<line.getFieldCount(); j++) {
+				 if (line.token(j)->getTrack() != target) {
+				    continue;
+				 }
+				 switch (subtarget) {
+				 case 'a':
+				    getSearchPat(spat, target, "a");
+				    if (hre.search(line.token(j)->getSpineInfo(), spat) ||
+				          !hre.search(line.token(j)->getSpineInfo(), "\\(")) {
+				       if (start != 0) {
+				          m_humdrum_text << '\t';
+				       }
+				       start = 1;
+				       m_humdrum_text << line.token(j);
+				    }
+				    break;
+				 case 'b':
+				    getSearchPat(spat, target, "b");
+				    if (hre.search(line.token(j)->getSpineInfo(), spat)) {
+				       if (start != 0) {
+				          m_humdrum_text << '\t';
+				       }
+				       start = 1;
+				       m_humdrum_text << line.token(j);
+				    } else if (!hre.search(line.token(j)->getSpineInfo(),
+				          "\\(")) {
+				       if (start != 0) {
+				          m_humdrum_text << '\t';
+				       }
+				       start = 1;
+				       dealWithSecondarySubspine(field, subfield, model, t,
+				             *line.getOwner(), line.getLineIndex(), j, modeltarget);
+				    }
+				    break;
+				 case 'c':
+				    if (start != 0) {
+				       m_humdrum_text << '\t';
+				    }
+				    start = 1;
+				    dealWithCospine(field, subfield, model, t, *line.getOwner(),
+				       line.getLineIndex(), j, modeltarget, modeltarget, cointerp);
+				    break;
+				 default:
+				    if (start != 0) {
+				       m_humdrum_text << '\t';
+				    }
+				    start = 1;
+				    m_humdrum_text << line.token(j);
+				 }
+			}
 		}
 	}
+	if (start != 0) {
+		m_humdrum_text << endl;
+	}
 }
 
 
@@ -42762,24 +47960,24 @@ void Tool_extract::getSearchPat(string& spat, int target, const string& modifier
 //     spine manipulators (**, *-, *x, *v, *^) when creating the output.
 //
 
-void Tool_extract::dealWithSpineManipulators(HumdrumFile& infile, int line,
+void Tool_extract::dealWithSpineManipulators(HumdrumLine& line, int maxtrack,
 		vector<int>& field, vector<int>& subfield, vector<int>& model) {
 
 	vector<int> vmanip;  // counter for *v records on line
-	vmanip.resize(infile[line].getFieldCount());
+	vmanip.resize(line.getFieldCount());
 	fill(vmanip.begin(), vmanip.end(), 0);
 
 	vector<int> xmanip; // counter for *x record on line
-	xmanip.resize(infile[line].getFieldCount());
+	xmanip.resize(line.getFieldCount());
 	fill(xmanip.begin(), xmanip.end(), 0);
 
 	int i = 0;
 	int j;
 	for (j=0; j<(int)vmanip.size(); j++) {
-		if (*infile.token(line, j) == "*v") {
+		if (*line.token(j) == "*v") {
 			vmanip[j] = 1;
 		}
-		if (*infile.token(line, j) == "*x") {
+		if (*line.token(j) == "*x") {
 			xmanip[j] = 1;
 		}
 	}
@@ -42811,7 +48009,7 @@ void Tool_extract::dealWithSpineManipulators(HumdrumFile& infile, int line,
 	fill(fieldoccur.begin(), fieldoccur.end(), 0);
 
 	vector<int> trackcounter; // counter of input spines occurances in output
-	trackcounter.resize(infile.getMaxTrack()+1);
+	trackcounter.resize(maxtrack+1);
 	fill(trackcounter.begin(), trackcounter.end(), 0);
 
 	for (i=0; i<(int)field.size(); i++) {
@@ -42864,13 +48062,13 @@ void Tool_extract::dealWithSpineManipulators(HumdrumFile& infile, int line,
 		}
 		suppress = 0;
 		if (target == 0) {
-			if (infile.token(line, 0)->compare(0, 2, "**") == 0) {
+			if (line.token(0)->compare(0, 2, "**") == 0) {
 				storeToken(tempout, blankName);
 				tval = 0;
 				vserial.push_back(tval);
 				xserial.push_back(tval);
 				fpos.push_back(tval);
-			} else if (*infile.token(line, 0) == "*-") {
+			} else if (*line.token(0) == "*-") {
 				storeToken(tempout, "*-");
 				tval = 0;
 				vserial.push_back(tval);
@@ -42884,19 +48082,19 @@ void Tool_extract::dealWithSpineManipulators(HumdrumFile& infile, int line,
 				fpos.push_back(tval);
 			}
 		} else {
-			for (j=0; j<infile[line].getFieldCount(); j++) {
-				if (infile[line].token(j)->getTrack() != target) {
+			for (j=0; j<line.getFieldCount(); j++) {
+				if (line.token(j)->getTrack() != target) {
 					continue;
 				}
 		 // filter by subfield
 		 if (subtarget == 'a') {
 					getSearchPat(spat, target, "b");
-			 if (hre.search(infile.token(line, j)->getSpineInfo(), spat)) {
+			 if (hre.search(line.token(j)->getSpineInfo(), spat)) {
 						continue;
 			 }
 		 } else if (subtarget == 'b') {
 					getSearchPat(spat, target, "a");
-			 if (hre.search(infile.token(line, j)->getSpineInfo(), spat)) {
+			 if (hre.search(line.token(j)->getSpineInfo(), spat)) {
 						continue;
 					}
 				}
@@ -42904,29 +48102,29 @@ void Tool_extract::dealWithSpineManipulators(HumdrumFile& infile, int line,
 				switch (subtarget) {
 				case 'a':
 
-					if (!hre.search(infile.token(line, j)->getSpineInfo(), "\\(")) {
-						if (*infile.token(line, j)  == "*^") {
+					if (!hre.search(line.token(j)->getSpineInfo(), "\\(")) {
+						if (*line.token(j)  == "*^") {
 							 storeToken(tempout, "*");
 						} else {
-							 storeToken(tempout, *infile.token(line, j));
+							 storeToken(tempout, *line.token(j));
 						}
 					} else {
 						getSearchPat(spat, target, "a");
-						spinepat =  infile.token(line, j)->getSpineInfo();
+						spinepat =  line.token(j)->getSpineInfo();
 						hre.replaceDestructive(spinepat, "\\(", "\\(", "g");
 						hre.replaceDestructive(spinepat, "\\)", "\\)", "g");
 
-						if ((*infile.token(line, j) == "*v") &&
+						if ((*line.token(j) == "*v") &&
 							    (spinepat == spat)) {
 							 storeToken(tempout, "*");
 						} else {
 							 getSearchPat(spat, target, "b");
 							 if ((spinepat == spat) &&
-							       (*infile.token(line, j) ==  "*v")) {
+							       (*line.token(j) ==  "*v")) {
 							    // do nothing
 							    suppress = 1;
 							 } else {
-							    storeToken(tempout, *infile.token(line, j));
+							    storeToken(tempout, *line.token(j));
 							 }
 						}
 					}
@@ -42934,29 +48132,29 @@ void Tool_extract::dealWithSpineManipulators(HumdrumFile& infile, int line,
 					break;
 				case 'b':
 
-					if (!hre.search(infile.token(line, j)->getSpineInfo(), "\\(")) {
-						if (*infile.token(line, j) == "*^") {
+					if (!hre.search(line.token(j)->getSpineInfo(), "\\(")) {
+						if (*line.token(j) == "*^") {
 							 storeToken(tempout, "*");
 						} else {
-							 storeToken(tempout, *infile.token(line, j));
+							 storeToken(tempout, *line.token(j));
 						}
 					} else {
 						getSearchPat(spat, target, "b");
-						spinepat = infile.token(line, j)->getSpineInfo();
+						spinepat = line.token(j)->getSpineInfo();
 						hre.replaceDestructive(spinepat, "\\(", "\\(", "g");
 						hre.replaceDestructive(spinepat, "\\)", "\\)", "g");
 
-						if ((*infile.token(line, j) ==  "*v") &&
+						if ((*line.token(j) ==  "*v") &&
 							    (spinepat == spat)) {
 							 storeToken(tempout, "*");
 						} else {
 							 getSearchPat(spat, target, "a");
 							 if ((spinepat == spat) &&
-							       (*infile.token(line, j) == "*v")) {
+							       (*line.token(j) == "*v")) {
 							    // do nothing
 							    suppress = 1;
 							 } else {
-							    storeToken(tempout, *infile.token(line, j));
+							    storeToken(tempout, *line.token(j));
 							 }
 						}
 					}
@@ -42964,10 +48162,10 @@ void Tool_extract::dealWithSpineManipulators(HumdrumFile& infile, int line,
 					break;
 				case 'c':
 					// work on later
-					storeToken(tempout, *infile.token(line, j));
+					storeToken(tempout, *line.token(j));
 					break;
 				default:
-					storeToken(tempout, *infile.token(line, j));
+					storeToken(tempout, *line.token(j));
 				}
 
 				if (suppress) {
@@ -43007,7 +48205,7 @@ void Tool_extract::dealWithSpineManipulators(HumdrumFile& infile, int line,
 	}
 
 	if (debugQ && vdebug) {
-		m_humdrum_text << "!!LINE: " << infile[line] << endl;
+		m_humdrum_text << "!!LINE: " << line << endl;
 		m_humdrum_text << "!! *v serials = ";
 		for (int ii=0; ii<(int)vserial.size(); ii++) {
 			m_humdrum_text << vserial[ii] << " ";
@@ -43209,25 +48407,6 @@ void storeToken(vector<string>& storage, int index, const string& string) {
 
 
 
-//////////////////////////////
-//
-// Tool_extract::isInList -- returns true if first number found in list of numbers.
-//     returns the matching index plus one.
-//
-
-int Tool_extract::isInList(int number, vector<int>& listofnum) {
-	int i;
-	for (i=0; i<(int)listofnum.size(); i++) {
-		if (listofnum[i] == number) {
-			return i+1;
-		}
-	}
-	return 0;
-
-}
-
-
-
 //////////////////////////////
 //
 // Tool_extract::getTraceData --
@@ -43275,7 +48454,7 @@ void Tool_extract::getTraceData(vector<int>& startline, vector<vector<int> >& fi
 		}
 		startline.push_back(linenum);
 		string ttemp = temps;
-		fillFieldData(field, subfield, model, ttemp, infile);
+		fillFieldData(field, subfield, model, ttemp, infile.getMaxTrack(), &infile);
 		fields.push_back(field);
 		input.getline(buffer, 1024);
 	}
@@ -43403,7 +48582,7 @@ void Tool_extract::usage(const string& command) {
 // Tool_extract::initialize --
 //
 
-void Tool_extract::initialize(HumdrumFile& infile) {
+void Tool_extract::initialize(void) {
 	// handle basic options:
 	if (getBoolean("author")) {
 		m_free_text << "Written by Craig Stuart Sapp, "
@@ -43843,6 +49022,7 @@ Tool_homophonic::Tool_homophonic(void) {
 	define("f|fraction=b", "calculate fraction of music that is homophonic");
 	define("v|voice=b", "display voice information or fraction results");
 	define("F|filename=b", "show filename for f option");
+	define("csv=b", "print analysis as CSV data rather than adding spines");
 	define("n|t|threshold=d:4.0", "Threshold score sum required for homophonic texture detection");
 	define("s|score=d:1.0", "Score assigned to a sonority with three or more attacks");
 	define("m|intermediate-score=d:0.5", "Score to give sonority between two adjacent attack sonoroties");
@@ -43893,6 +49073,13 @@ bool Tool_homophonic::run(HumdrumFile& infile) {
 	infile.analyzeStructure();
 	m_voice_count = getExtantVoiceCount(infile);
 	processFile(infile);
+	if (getBoolean("csv")) {
+		if (infile.getAnalysisColumnCount() > 0) {
+			infile.printAnalysisCsv(m_free_text);
+		}
+	} else {
+		infile.renderAnalysisColumns();
+	}
 	infile.createLinesFromTokens();
 	return true;
 }
@@ -44039,7 +49226,7 @@ void Tool_homophonic::processFile(HumdrumFile& infile) {
 				m_homophonic[data[i]] = "black";
 			}
 		}
-		infile.appendDataSpine(m_homophonic, "", "**color");
+		infile.addAnalysisColumn(m_homophonic, "", "**color");
 	}
 }
 
@@ -44051,7 +49238,7 @@ void Tool_homophonic::processFile(HumdrumFile& infile) {
 //
 
 void Tool_homophonic::printAccumulatedScores(HumdrumFile& infile, vector<double>& score) {
-	infile.appendDataSpine(score, "", "**score");
+	infile.addAnalysisColumn(score, "", "**score");
 }
 
 
@@ -44062,7 +49249,7 @@ void Tool_homophonic::printAccumulatedScores(HumdrumFile& infile, vector<double>
 //
 
 void Tool_homophonic::printRawAnalysis(HumdrumFile& infile, vector<double>& raw) {
-	infile.appendDataSpine(raw, "", "**raw");
+	infile.addAnalysisColumn(raw, "", "**raw");
 }
 
 
@@ -44073,7 +49260,7 @@ void Tool_homophonic::printRawAnalysis(HumdrumFile& infile, vector<double>& raw)
 //
 
 void Tool_homophonic::printAttacks(HumdrumFile& infile, vector<int>& attacks) {
-	infile.appendDataSpine(attacks, "", "**atks");
+	infile.addAnalysisColumn(attacks, "", "**atks");
 }
 
 
@@ -44458,6 +49645,9 @@ Tool_humdiff::Tool_humdiff(void) {
 	define("time-points|times=b", "display timepoint lists for each file");
 	define("note-points|notes=b", "display notepoint lists for each file");
 	define("c|color=s:red",       "color for markers");
+	define("delta=b",             "display tab-separated list of note differences");
+	define("g|group-size=i:0",    "number of files in each comparison group (0 = all)");
+	define("j|threads=i:0",       "number of threads for comparisons (0 = all cores)");
 }
 
 
@@ -44468,13 +49658,11 @@ Tool_humdiff::Tool_humdiff(void) {
 //
 
 bool Tool_humdiff::run(HumdrumFileSet& infiles) {
-	bool status = true;
-	if (infiles.getCount() >= 2) {
-		status = run(infiles[0], infiles[1]);
-	} else {
-		status = false;
+	if (infiles.getCount() < 2) {
+		return false;
 	}
-	return status;
+	processFileSet(infiles);
+	return true;
 }
 
 
@@ -44531,155 +49719,472 @@ bool Tool_humdiff::run(HumdrumFile& infile1, HumdrumFile& infile2) {
 
 //////////////////////////////
 //
-// Tool_humdiff::processFile
+// Tool_humdiff::processFile --
 //
 
 void Tool_humdiff::processFile(HumdrumFile& infile1, HumdrumFile& infile2) {
 	HumdrumFileSet humset;
 	humset.readAppendHumdrum(infile1);
 	humset.readAppendHumdrum(infile2);
+	processFileSet(humset);
+}
+
+
+
+//////////////////////////////
+//
+// Tool_humdiff::processFileSet -- Compare the files in the set.  By default
+//     all files form a single group, and the reference file of the group
+//     (the first file, or the one given by -r) is compared to each of the
+//     other files.  With -g, consecutive files are split into groups of
+//     the given size, each group having its own reference file.
+//
+
+void Tool_humdiff::processFileSet(HumdrumFileSet& infiles) {
+	if (infiles.getSize() == 0) {
+		m_warning_text << "Usage: " << getCommand() << " files" << endl;
+		return;
+	}
+	int groupsize = getInteger("group-size");
+	if (groupsize <= 0) {
+		groupsize = infiles.getSize();
+	}
+
+	vector<vector<HumdrumFile*>> groups;
+	for (int i=0; i<infiles.getSize(); i++) {
+		if (i % groupsize == 0) {
+			groups.resize(groups.size() + 1);
+		}
+		groups.back().push_back(&infiles[i]);
+	}
+
+	vector<vector<HumdrumFile*>> validgroups;
+	validgroups.reserve(groups.size());
+	for (int i=0; i<(int)groups.size(); i++) {
+		if (prepareGroup(groups[i])) {
+			validgroups.push_back(groups[i]);
+		}
+	}
+	compareGroups(validgroups);
+}
+
+
+
+//////////////////////////////
+//
+// Tool_humdiff::prepareGroup -- Move the reference file to the start of the
+//     group and check that the group can be compared.  Returns false
+//     (with a warning message) if the group cannot be compared.
+//
+
+bool Tool_humdiff::prepareGroup(vector<HumdrumFile*>& group) {
 	int reference = getInteger("reference");
 	if (reference > 1) {
-		if (reference > humset.getCount()) {
-			cerr << "Error: work number is too large: " << reference << endl;
-			cerr << "Maximum is " << humset.getCount() << endl;
-			return;
+		if (reference > (int)group.size()) {
+			m_warning_text << "Error: work number is too large: " << reference << endl;
+			m_warning_text << "Maximum is " << group.size() << endl;
+			return false;
 		}
 		reference--;
-		humset.swap(0, reference);
+		std::swap(group[0], group[reference]);
 	}
 
-	if (humset.getSize() == 0) {
-		cerr << "Usage: " << getCommand() << " files" << endl;
-		return;
-	} else if (humset.getSize() < 2) {
-		cerr << "Error: requires two or more files" << endl;
-		cerr << "Usage: " << getCommand() << " files" << endl;
-		return;
-	} else {
-		HumNum targetdur = humset[0].getScoreDuration();
-		for (int i=1; i<humset.getSize(); i++) {
-			HumNum dur = humset[i].getScoreDuration();
-			if (dur != targetdur) {
-				cerr << "Error: all files must have the same duration" << endl;
-				return;
+	if (group.size() < 2) {
+		m_warning_text << "Error: requires two or more files" << endl;
+		m_warning_text << "Usage: " << getCommand() << " files" << endl;
+		return false;
+	}
+
+	HumNum targetdur = group[0]->getScoreDuration();
+	for (int i=1; i<(int)group.size(); i++) {
+		HumNum dur = group[i]->getScoreDuration();
+		if (dur != targetdur) {
+			m_warning_text << "Error: all files must have the same duration";
+			if (!group[0]->getFilename().empty()) {
+				m_warning_text << " (" << group[0]->getFilename() << ")";
 			}
+			m_warning_text << endl;
+			return false;
 		}
-		compareFiles(humset);
 	}
 
-	if (!getBoolean("report")) {
-		humset[0].createLinesFromTokens();
-		m_humdrum_text << humset[0];
-		if (m_marked) {
-			m_humdrum_text << "!!!RDF**kern: @ = marked note";
-			if (getBoolean("color")) {
-				m_humdrum_text << "color=\"" << getString("color") << "\"";
+	vector<long long> tickscales;
+	return getTickScales(group, tickscales);
+}
+
+
+
+//////////////////////////////
+//
+// Tool_humdiff::getTickScales -- Calculate the factor for each file in a
+//     group which converts its ticks into ticks of the least common
+//     multiple of the ticks-per-quarter values of the group.  Returns
+//     false (with a warning message) if the group ticks do not fit into
+//     a 64-bit integer, which can happen with many different tuplets.
+//
+
+bool Tool_humdiff::getTickScales(vector<HumdrumFile*>& group,
+		vector<long long>& tickscales) {
+	const long long maxticks = std::numeric_limits<long long>::max();
+	tickscales.clear();
+	long long lcm = 1;
+	bool overflowQ = false;
+	for (int i=0; i<(int)group.size(); i++) {
+		long long tpq = std::max(group[i]->tpq(), 1);
+		long long a = lcm;
+		long long b = tpq;
+		while (b != 0) {
+			long long c = a % b;
+			a = b;
+			b = c;
+		}
+		long long factor = tpq / a;
+		if (lcm > maxticks / factor) {
+			overflowQ = true;
+			break;
+		}
+		lcm *= factor;
+	}
+	if (!overflowQ) {
+		for (int i=0; i<(int)group.size(); i++) {
+			long long scale = lcm / std::max(group[i]->tpq(), 1);
+			long long ticks = group[i]->timeToTick(group[i]->getScoreDuration());
+			if ((ticks > 0) && (scale > maxticks / ticks)) {
+				overflowQ = true;
+				break;
 			}
-			m_humdrum_text << endl;
+			tickscales.push_back(scale);
 		}
 	}
+	if (overflowQ) {
+		tickscales.clear();
+		m_warning_text << "Error: the rhythms of the files are too complex to compare";
+		if (!group[0]->getFilename().empty()) {
+			m_warning_text << " (" << group[0]->getFilename() << ")";
+		}
+		m_warning_text << endl;
+		return false;
+	}
+	return true;
 }
 
 
 
 //////////////////////////////
 //
-// Tool_humdiff::compareFiles --
+// Tool_humdiff::compareGroups -- Extract the notes of every file and then
+//     align the reference file of each group with each of the other files
+//     in the group.  The extractions and comparison pairs are independent,
+//     so they are run in parallel.  Note start times and durations are
+//     converted into integer ticks that are shared by all files in a group,
+//     and notes are aligned with a hash table keyed by start time and pitch,
+//     so each comparison is linear in the number of notes.
 //
 
-void Tool_humdiff::compareFiles(HumdrumFileSet& humset) {
-	vector<vector<TimePoint>> timepoints(humset.getSize());;
-	for (int i=0; i<humset.getSize(); i++) {
-		extractTimePoints(timepoints.at(i), humset[i]);
+void Tool_humdiff::compareGroups(vector<vector<HumdrumFile*>>& groups) {
+	int threads = getInteger("threads");
+
+	// Flatten the list of files and calculate the tick scaling for each
+	// file so that each group uses a common ticks-per-quarter value.
+	vector<HumdrumFile*> files;
+	vector<long long> tickscales;
+	vector<int> groupstarts;
+	for (int i=0; i<(int)groups.size(); i++) {
+		vector<long long> scales;
+		getTickScales(groups[i], scales);
+		groupstarts.push_back((int)files.size());
+		for (int j=0; j<(int)groups[i].size(); j++) {
+			files.push_back(groups[i][j]);
+			tickscales.push_back(scales[j]);
+		}
 	}
 
 	if (getBoolean("time-points")) {
-		for (int i=0; i<(int)timepoints.size(); i++) {
-	 		printTimePoints(cout, timepoints[i]);
+		for (int i=0; i<(int)files.size(); i++) {
+			vector<TimePoint> timepoints;
+			extractTimePoints(timepoints, *files[i]);
+			printTimePoints(cout, timepoints);
 		}
 	}
 
-	compareTimePoints(cout, timepoints, humset);
-}
+	vector<vector<NotePoint>> notes(files.size());
+	HumParallel::run((int)files.size(), threads, [&](int i) {
+		int sourceindex = i;
+		auto it = std::upper_bound(groupstarts.begin(), groupstarts.end(), i);
+		sourceindex -= *(it - 1);
+		extractNotePoints(notes[i], *files[i], sourceindex, tickscales[i]);
+	});
 
+	if (getBoolean("notes")) {
+		for (int i=0; i<(int)notes.size(); i++) {
+			cerr << "========== NOTES FOR I=" << i << endl;
+			printNotePoints(notes[i]);
+			cerr << endl;
+		}
+	}
 
+	// Prepare the list of (reference, source) comparisons:
+	vector<pair<int, int>> pairs;
+	for (int i=0; i<(int)groups.size(); i++) {
+		for (int j=1; j<(int)groups[i].size(); j++) {
+			pairs.emplace_back(groupstarts[i], groupstarts[i] + j);
+		}
+	}
 
-//////////////////////////////
-//
-// Tool_humdiff::printTimePoints --
-//
+	vector<vector<int>> matches(pairs.size());
+	vector<vector<int>> extras(pairs.size());
+	HumParallel::run((int)pairs.size(), threads, [&](int i) {
+		alignNotePoints(notes[pairs[i].first], notes[pairs[i].second],
+				matches[i], extras[i]);
+	});
 
-ostream& Tool_humdiff::printTimePoints(ostream& out, vector<TimePoint>& timepoints) {
-	for (int i=0; i<(int)timepoints.size(); i++) {
-		out << "TIMEPOINT " << i << ":" << endl;
-		out << timepoints[i] << endl;
+	// Store the matches in the reference notes:
+	for (int i=0; i<(int)pairs.size(); i++) {
+		vector<NotePoint>& reference = notes[pairs[i].first];
+		int sourceindex = pairs[i].second - pairs[i].first;
+		for (int j=0; j<(int)reference.size(); j++) {
+			if ((int)reference[j].matched.size() <= sourceindex) {
+				reference[j].matched.resize(sourceindex + 1, -1);
+				reference[j].matched[0] = j;
+			}
+			reference[j].matched[sourceindex] = matches[i][j];
+		}
+	}
+
+	bool reportQ = getBoolean("report");
+	bool deltaQ = getBoolean("delta");
+	int pairindex = 0;
+	for (int i=0; i<(int)groups.size(); i++) {
+		vector<NotePoint>& reference = notes[groupstarts[i]];
+		int paircount = (int)groups[i].size() - 1;
+		if (deltaQ) {
+			vector<vector<NotePoint>> groupnotes;
+			groupnotes.reserve(groups[i].size());
+			for (int j=0; j<(int)groups[i].size(); j++) {
+				groupnotes.push_back(notes[groupstarts[i] + j]);
+			}
+			vector<vector<int>> groupextras(extras.begin() + pairindex,
+					extras.begin() + pairindex + paircount);
+			printDelta(i, groups[i], groupnotes, groupextras);
+		} else if (reportQ) {
+			printReport(groups[i], reference);
+		} else {
+			m_marked = 0;
+			for (int j=0; j<(int)reference.size(); j++) {
+				for (int k=1; k<(int)reference[j].matched.size(); k++) {
+					if (reference[j].matched[k] < 0) {
+						markNote(reference[j]);
+						break;
+					}
+				}
+			}
+			HumdrumFile& infile = *groups[i][0];
+			infile.createLinesFromTokens();
+			m_humdrum_text << infile;
+			if (m_marked) {
+				m_humdrum_text << "!!!RDF**kern: @ = marked note";
+				if (getBoolean("color")) {
+					m_humdrum_text << "color=\"" << getString("color") << "\"";
+				}
+				m_humdrum_text << endl;
+			}
+		}
+		pairindex += paircount;
 	}
-	return out;
 }
 
 
 
 //////////////////////////////
 //
-// Tool_humdiff::compareTimePoints --
+// Tool_humdiff::alignNotePoints -- Find an equivalent note in the source
+//     for each note in the reference.  Notes are equivalent if they start
+//     at the same time, have the same pitch and the same (tied) duration.
+//     Each source note can be matched only once.  The matches list gives
+//     the index of the matching source note for each reference note (or -1
+//     if there is no match), and the extras list gives the indexes of
+//     source notes which do not have a match in the reference.
 //
 
-ostream& Tool_humdiff::compareTimePoints(ostream& out, vector<vector<TimePoint>>& timepoints, HumdrumFileSet& humset) {
-	vector<int> indexes(timepoints.size(), 0);
-	HumNum minval;
-	HumNum value;
-	int found;
+void Tool_humdiff::alignNotePoints(vector<NotePoint>& reference,
+		vector<NotePoint>& source, vector<int>& matches, vector<int>& extras) {
+	matches.assign(reference.size(), -1);
+	extras.clear();
 
-	vector<int> increment(timepoints.size(), 0);
+	// Hash the source notes by start time and pitch.  Notes with the same
+	// time and pitch but different durations share a bucket, which are
+	// then checked one at a time.
+	std::unordered_map<unsigned long long, vector<int>> table;
+	table.reserve(source.size());
+	for (int i=(int)source.size()-1; i>=0; i--) {
+		unsigned long long key = ((unsigned long long)(unsigned int)source[i].tick << 32)
+				| (unsigned int)source[i].b40;
+		table[key].push_back(i);
+	}
 
-	while ((1)) {
-		if (indexes.at(0) >= (int)timepoints.at(0).size()) {
-			// at the end of the list of notes for the first file.
-			// break from the comparison for now and figure out how
-			// to report differences of added notes in the other file(s)
-			// later.
-			break;
-		}
-		timepoints.at(0).at(indexes.at(0)).index.resize(timepoints.size());
-		for (int i=1; i<(int)timepoints.size(); i++) {
-			timepoints.at(0).at(indexes.at(0)).index.at(i) = -1;
+	vector<char> used(source.size(), 0);
+	for (int i=0; i<(int)reference.size(); i++) {
+		unsigned long long key = ((unsigned long long)(unsigned int)reference[i].tick << 32)
+				| (unsigned int)reference[i].b40;
+		auto it = table.find(key);
+		if (it == table.end()) {
+			continue;
 		}
-		minval = timepoints.at(0).at(indexes.at(0)).timestamp;
-		for (int i=1; i<(int)timepoints.size(); i++) {
-			if (indexes.at(i) >= (int)timepoints.at(i).size()) {
+		vector<int>& bucket = it->second;
+		for (int j=(int)bucket.size()-1; j>=0; j--) {
+			NotePoint& note = source[bucket[j]];
+			if ((note.tick != reference[i].tick) || (note.b40 != reference[i].b40) ||
+					(note.durticks != reference[i].durticks)) {
 				continue;
 			}
-			value = timepoints.at(i).at(indexes.at(i)).timestamp;
-			if (value < minval) {
-				minval = value;
+			matches[i] = bucket[j];
+			used[bucket[j]] = 1;
+			bucket.erase(bucket.begin() + j);
+			break;
+		}
+	}
+
+	for (int i=0; i<(int)used.size(); i++) {
+		if (!used[i]) {
+			extras.push_back(i);
+		}
+	}
+}
+
+
+
+//////////////////////////////
+//
+// Tool_humdiff::extractNotePoints -- Extract a list of the note attacks
+//     in a file.  Lines that contain only grace notes are ignored.
+//     Times and durations are stored in ticks scaled by tickscale, so that
+//     files with different tpq() values can be compared.
+//
+
+void Tool_humdiff::extractNotePoints(vector<NotePoint>& notelist,
+		HumdrumFile& infile, int sourceindex, long long tickscale) {
+	notelist.clear();
+	HumRegex hre;
+	int measure = -1;
+	int tpindex = 0;
+	for (int i=0; i<infile.getLineCount(); i++) {
+		if (infile[i].isBarline()) {
+			if (hre.search(infile.token(i, 0), "(\\d+)")) {
+				measure = hre.getMatchInt(1);
 			}
 		}
-		found = 0;
-		fill(increment.begin(), increment.end(), 0);
-		
-		for (int i=0; i<(int)timepoints.size(); i++) {
-			if (indexes.at(i) >= (int)timepoints.at(i).size()) {
-				// index is too large for file, so skip checking it.
+		if (!infile[i].isData()) {
+			continue;
+		}
+		if (infile[i].getDuration() == 0) {
+			// ignore grace notes for now
+			continue;
+		}
+		getNoteList(notelist, infile, i, measure, sourceindex, tpindex++, tickscale);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// Tool_humdiff::printReport -- Print a description of the reference notes
+//     that do not have a match in the other files of a group.
+//
+
+void Tool_humdiff::printReport(vector<HumdrumFile*>& group,
+		vector<NotePoint>& reference) {
+	HumdrumFile& infile = *group[0];
+	for (int i=0; i<(int)reference.size(); i++) {
+		for (int j=1; j<(int)reference[i].matched.size(); j++) {
+			if (reference[i].matched[j] >= 0) {
 				continue;
 			}
-			found = 1;
-			value = timepoints.at(i).at(indexes.at(i)).timestamp;
+			m_free_text << "NOTE " << reference[i].subtoken
+			     << " DOES NOT HAVE EXACT MATCH IN SOURCE " << j << endl;
+			int humindex = reference[i].token->getLineIndex();
+			m_free_text << "\tREFERENCE MEASURE\t: " << reference[i].measure << endl;
+			m_free_text << "\tREFERENCE LINE NO.\t: " << humindex+1 << endl;
+			m_free_text << "\tREFERENCE LINE TEXT\t: " << infile[humindex] << endl;
 
-			if (value == minval) {
-				timepoints.at(0).at(indexes.at(0)).index.at(i) = timepoints.at(i).at(indexes.at(i)).index.at(0);
-				increment.at(i)++;
+			m_free_text << "\tTARGET  " << j << " LINE NO. ";
+			if (j < 10) {
+				m_free_text << " ";
 			}
+			m_free_text << ":\t" << "X" << endl;
+
+			m_free_text << "\tTARGET  " << j << " LINE TEXT";
+			if (j < 10) {
+				m_free_text << " ";
+			}
+			m_free_text << ":\t" << "X" << endl;
+
+			m_free_text << endl;
 		}
-		if (!found) {
-			break;
-		} else {
-			compareLines(minval, indexes, timepoints, humset);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// Tool_humdiff::printDelta -- Print a tab-separated list of the note
+//     differences between the reference file of a group and the other
+//     files in the group.  Each group starts with a list of the files in
+//     the group, followed by one line for each difference:
+//        group, source, op, measure, line, field, subtoken, time, duration, b40
+//     Where op is "-" for a reference note which is not in the source (line
+//     and field are for the reference file), and "+" for a source note which
+//     is not in the reference (line and field are for the source file).
+//     Line and field numbers are 1-indexed, times and durations are in
+//     quarter notes.
+//
+
+void Tool_humdiff::printDelta(int groupindex, vector<HumdrumFile*>& group,
+		vector<vector<NotePoint>>& notes, vector<vector<int>>& extras) {
+	if (groupindex == 0) {
+		m_free_text << "#group\tsource\top\tmeasure\tline\tfield\tnote\ttime\tduration\tb40\n";
+	}
+	for (int i=0; i<(int)group.size(); i++) {
+		m_free_text << "#file\t" << groupindex << "\t" << i << "\t" << group[i]->getFilename() << "\n";
+	}
+
+	auto printNote = [&](int source, char op, NotePoint& np) {
+		m_free_text << groupindex << "\t" << source << "\t" << op;
+		m_free_text << "\t" << np.measure;
+		m_free_text << "\t" << np.token->getLineNumber();
+		m_free_text << "\t" << np.token->getFieldNumber();
+		m_free_text << "\t" << np.subtoken;
+		m_free_text << "\t" << np.token->getDurationFromStart();
+		m_free_text << "\t" << np.duration;
+		m_free_text << "\t" << np.b40 << "\n";
+	};
+
+	vector<NotePoint>& reference = notes[0];
+	for (int j=1; j<(int)group.size(); j++) {
+		for (int i=0; i<(int)reference.size(); i++) {
+			if (reference[i].matched.at(j) < 0) {
+				printNote(j, '-', reference[i]);
+			}
 		}
-		for (int i=0; i<(int)increment.size(); i++) {
-			indexes.at(i) += increment.at(i);
+		for (int i=0; i<(int)extras[j-1].size(); i++) {
+			printNote(j, '+', notes[j][extras[j-1][i]]);
 		}
 	}
+}
+
+
+
+//////////////////////////////
+//
+// Tool_humdiff::printTimePoints --
+//
+
+ostream& Tool_humdiff::printTimePoints(ostream& out, vector<TimePoint>& timepoints) {
+	for (int i=0; i<(int)timepoints.size(); i++) {
+		out << "TIMEPOINT " << i << ":" << endl;
+		out << timepoints[i] << endl;
+	}
 	return out;
 }
 
@@ -44731,122 +50236,14 @@ void Tool_humdiff::markNote(NotePoint& np) {
 
 
 
-//////////////////////////////
-//
-// Tool_humdiff::compareLines --
-//
-
-void Tool_humdiff::compareLines(HumNum minval, vector<int>& indexes,
-		vector<vector<TimePoint>>& timepoints, HumdrumFileSet& humset) {
-
-	bool reportQ = getBoolean("report");
-
-	// cerr << "COMPARING LINES ====================================" << endl;
-	vector<vector<NotePoint>> notelist(indexes.size());
-	for (int i=0; i<(int)timepoints.size(); i++) {
-		if (indexes.at(i) >= (int)timepoints.at(i).size()) {
-			continue;
-		}
-		if (timepoints.at(i).at(indexes.at(i)).timestamp != minval) {
-			// not at the same time
-			continue;
-		}
-
-		getNoteList(notelist.at(i), humset[i], 
-			timepoints.at(i).at(indexes.at(i)).index[0], 
-			timepoints.at(i).at(indexes.at(i)).measure, i, indexes.at(i));
-
-
-	}
-	for (int i=0; i<(int)notelist.at(0).size(); i++) {
-		notelist.at(0).at(i).matched.resize(notelist.size());
-		fill(notelist.at(0).at(i).matched.begin(), notelist.at(0).at(i).matched.end(), -1);
-		notelist.at(0).at(i).matched.at(0) = i;
-		for (int j=1; j<(int)notelist.size(); j++) {
-			int status = findNoteInList(notelist.at(0).at(i), notelist.at(j));
-			notelist.at(0).at(i).matched.at(j) = status;
-			if ((status < 0) && !reportQ) {
-				markNote(notelist.at(0).at(i));
-			}
-		}
-	}
-
-	if (getBoolean("notes")) {
-		for (int i=0; i<(int)notelist.size(); i++) {
-			cerr << "========== NOTES FOR I=" << i << endl;
-			printNotePoints(notelist.at(i));
-			cerr << endl;
-		}
-	}
-
-	if (!reportQ) {
-		return;
-	}
-
-	// report
-	for (int i=0; i<(int)notelist.at(0).size(); i++) {
-		for (int j=1; j<(int)notelist.at(0).at(i).matched.size(); j++) {
-			if (notelist.at(0).at(i).matched.at(j) < 0) {
-				cout << "NOTE " << notelist.at(0).at(i).subtoken 
-				     << " DOES NOT HAVE EXACT MATCH IN SOURCE " << j << endl;
-				int humindex = notelist.at(0).at(i).token->getLineIndex();
-				cout << "\tREFERENCE MEASURE\t: " << notelist.at(0).at(i).measure << endl;
-				cout << "\tREFERENCE LINE NO.\t: " << humindex+1 << endl;
-				cout << "\tREFERENCE LINE TEXT\t: " << humset[0][humindex] << endl;
-
-				cout << "\tTARGET  " << j << " LINE NO. ";
-				if (j < 10) {
-					cout << " ";
-				}
-				cout << ":\t" << "X" << endl;
-
-				cout << "\tTARGET  " << j << " LINE TEXT";
-				if (j < 10) {
-					cout << " ";
-				}
-				cout << ":\t" << "X" << endl;
-
-				cout << endl;
-			}
-		}
-	}
-
-}
-
-
-
-//////////////////////////////
-//
-// Tool_humdiff::findNoteInList --
-//
-
-int Tool_humdiff::findNoteInList(NotePoint& np, vector<NotePoint>& nps) {
-	for (int i=0; i<(int)nps.size(); i++) {
-		// cerr << "COMPARING " << np.token << " (" << np.b40 << ") TO " << nps.at(i).token << " (" << nps.at(i).b40 << ") " << endl;
-		if (nps.at(i).processed) {
-			continue;
-		}
-		if (nps.at(i).b40 != np.b40) {
-			continue;
-		}
-		if (nps.at(i).duration != np.duration) {
-			continue;
-		}
-		return i;
-	}
-	// cerr << "\tCannot find note " << np.token << " on line " << np.token->getLineIndex() << " in other work" << endl;
-	return -1;
-}
-
-
-
-
 //////////////////////////////
 //
 // Tool_humdiff::getNoteList --
 //
 
-void Tool_humdiff::getNoteList(vector<NotePoint>& notelist, HumdrumFile& infile, int line, int measure, int sourceindex, int tpindex) {
+void Tool_humdiff::getNoteList(vector<NotePoint>& notelist, HumdrumFile& infile,
+		int line, int measure, int sourceindex, int tpindex, long long tickscale) {
+	long long tick = infile.getLineTick(line) * tickscale;
 	for (int i=0; i<infile[line].getFieldCount(); i++) {
 		HTp token = infile.token(line, i);
 		if (!token->isKern()) {
@@ -44875,13 +50272,16 @@ void Tool_humdiff::getNoteList(vector<NotePoint>& notelist, HumdrumFile& infile,
 			notelist.back().subtoken = subtok;
 			notelist.back().subindex = j;
 			notelist.back().measurequarter = token->getDurationFromBarline();
-			notelist.back().measure = 
+			notelist.back().measure = measure;
 			notelist.back().track = track;
 			notelist.back().layer = layer;
 			notelist.back().sourceindex = sourceindex;
 			notelist.back().tpindex = tpindex;
 			notelist.back().duration = token->getTiedDuration();
 			notelist.back().b40 = Convert::kernToBase40(subtok);
+			notelist.back().tick = tick;
+			notelist.back().durticks = infile.timeToTick(notelist.back().duration)
+					* tickscale;
 		}
 	}
 }
@@ -45160,6 +50560,7 @@ Tool_imitation::Tool_imitation(void) {
 	define("R|rest2=b",           "require match target to also follow a rest");
 	define("i|intervals=s",       "require given interval sequence in imitation");
 	define("M|no-mark=b",         "do not mark matched sequences");
+	define("csv=b",               "print analysis as CSV data rather than adding spines");
 }
 
 
@@ -45248,11 +50649,19 @@ bool Tool_imitation::run(HumdrumFile& infile) {
 
 	string exinterp = getString("exinterp");
 	vector<HTp> kernspines = infile.getKernSpineStartList();
-	infile.appendDataSpine(results.back(), "", exinterp);
+	HumAnalysisColumn* column;
+	column = &infile.addAnalysisColumn(results.back(), "", exinterp);
+	column->setName(column->getName() + "-" + to_string(kernspines.back()->getTrack()));
 	for (int i = (int)results.size()-1; i>0; i--) {
 		int track = kernspines[i]->getTrack();
-		infile.insertDataSpineBefore(track, results[i-1], "", exinterp);
+		column = &infile.addAnalysisColumn(results[i-1], "", exinterp, track);
+		column->setName(column->getName() + "-" + to_string(kernspines[i-1]->getTrack()));
+	}
+	if (getBoolean("csv")) {
+		infile.printAnalysisCsv(m_free_text);
+		return true;
 	}
+	infile.renderAnalysisColumns();
 	infile.createLinesFromTokens();
 	if (m_mark && Enumerator) {
 		string rdfline = "!!!RDF**kern: ";
@@ -45845,21 +51254,50 @@ Tool_mei2hum::Tool_mei2hum(void) {
 	define("r|recip=b", "output **recip spine");
 	define("s|stems=b", "include stems in output");
 	define("P|no-place=b", "Do not convert placement attribute");
+	define("j|threads=i:0", "number of files to convert at the same time (0 = all cores)");
+	define("outdir=s", "write each converted file into this directory");
+	define("report=b", "print conversion time and status of each file");
+
+	clear();
+}
+
 
-	m_maxverse.resize(m_maxstaff);
-	fill(m_maxverse.begin(), m_maxverse.end(), 0);
 
-	m_measureDuration.resize(m_maxstaff);
-	fill(m_measureDuration.begin(), m_measureDuration.end(), 0);
+//////////////////////////////
+//
+// Tool_mei2hum::clear -- Reset the information stored about the score
+//     being converted, so that the same tool object can be used to
+//     convert another file.
+//
 
-	m_currentMeterUnit.resize(m_maxstaff);
-	fill(m_currentMeterUnit.begin(), m_currentMeterUnit.end(), 4);
+void Tool_mei2hum::clear(void) {
+	m_scoreDef.clear();
+	m_staffcount = 0;
+	m_tupletfactor = 1;
+	m_outdata.clear();
+	m_currentLayer = 0;
+	m_currentStaff = 0;
+	m_maxStaffInFile = 0;
+	m_currentMeasure = -1;
+	m_currentMeterUnit.assign(m_maxstaff, 4);
+	m_beamPrefix.clear();
+	m_beamPostfix.clear();
+	m_aboveQ = false;
+	m_belowQ = false;
+	m_editorialAccidentalQ = false;
+	m_systemDecoration.clear();
 
-	m_hasDynamics.resize(m_maxstaff);
-	fill(m_hasDynamics.begin(), m_hasDynamics.end(), false);
+	m_maxverse.assign(m_maxstaff, 0);
+	m_measureDuration.assign(m_maxstaff, 0);
+	m_hasDynamics.assign(m_maxstaff, false);
+	m_hasHarm.assign(m_maxstaff, false);
 
-	m_hasHarm.resize(m_maxstaff);
-	fill(m_hasHarm.begin(), m_hasHarm.end(), false);
+	m_fermata = false;
+	m_gracenotes.clear();
+	m_gracetime = 0;
+	m_hairpins.clear();
+	m_startlinks.clear();
+	m_stoplinks.clear();
 }
 
 
@@ -45867,19 +51305,16 @@ Tool_mei2hum::Tool_mei2hum(void) {
 //////////////////////////////
 //
 // Tool_mei2hum::convert -- Convert an MEI file into
-//     Humdrum content.
+//     Humdrum content.  Returns false if the file cannot be read or
+//     converted (with the reason stored in the error text).
 //
 
 bool Tool_mei2hum::convertFile(ostream& out, const char* filename) {
 	xml_document doc;
-	auto result = doc.load_file(filename);
-	if (!result) {
-		cerr << "\nXML file [" << filename << "] has syntax errors\n";
-		cerr << "Error description:\t" << result.description() << "\n";
-		cerr << "Error offset:\t" << result.offset << "\n\n";
-		exit(1);
+	vector<char> buffer;
+	if (!loadFile(doc, buffer, filename)) {
+		return false;
 	}
-
 	return convert(out, doc);
 }
 
@@ -45894,10 +51329,10 @@ bool Tool_mei2hum::convert(ostream& out, const char* input) {
 	xml_document doc;
 	auto result = doc.load_string(input);
 	if (!result) {
-		cout << "\nXML content has syntax errors\n";
-		cout << "Error description:\t" << result.description() << "\n";
-		cout << "Error offset:\t" << result.offset << "\n\n";
-		exit(1);
+		m_error_text << "XML content has syntax errors\n";
+		m_error_text << "Error description:\t" << result.description() << "\n";
+		m_error_text << "Error offset:\t" << result.offset << "\n";
+		return false;
 	}
 
 	return convert(out, doc);
@@ -45907,6 +51342,7 @@ bool Tool_mei2hum::convert(ostream& out, const char* input) {
 
 bool Tool_mei2hum::convert(ostream& out, xml_document& doc) {
 	initialize();
+	clear();
 
 	bool status = true; // for keeping track of problems in conversion process.
 
@@ -45915,10 +51351,10 @@ bool Tool_mei2hum::convert(ostream& out, xml_document& doc) {
 	auto score = doc.select_node("/mei/music/body/mdiv/score").node();
 
 	if (!score) {
-		cerr << "Cannot find score, so cannot convert MEI file to Humdrum";
-		cerr << endl;
-		cerr << "Perhaps there is a problem in the XML structure of the file.";
-		cerr << endl;
+		m_error_text << "Cannot find score, so cannot convert MEI file to Humdrum";
+		m_error_text << endl;
+		m_error_text << "Perhaps there is a problem in the XML structure of the file.";
+		m_error_text << endl;
 		return false;
 	}
 
@@ -45993,6 +51429,223 @@ bool Tool_mei2hum::convert(ostream& out, xml_document& doc) {
 
 
 
+//////////////////////////////
+//
+// Tool_mei2hum::convertFiles -- Convert a list of MEI files, several at
+//     a time if more than one thread is used.  Each thread has its own
+//     copy of the tool, as well as an XML document and input buffer which
+//     are reused for each file that it converts.  With the --outdir option,
+//     each file is written to that directory; otherwise, the files are
+//     written to the output in their input order (with a !!!!SEGMENT:
+//     line before each file when there is more than one file).  Errors
+//     for a file do not stop the conversion of the other files, and files
+//     which could not be converted are left out of the output.  Returns
+//     false if any file could not be converted.  The --report table is
+//     stored in the free text of the tool.
+//
+
+bool Tool_mei2hum::convertFiles(ostream& out, const vector<string>& filenames) {
+	initialize();
+	int filecount = (int)filenames.size();
+	if (filecount == 0) {
+		return true;
+	}
+	int threads = std::min(m_threads, filecount);
+	bool directQ = !m_outdir.empty();
+	bool segmentQ = !directQ && (filecount > 1);
+	int batchsize = directQ ? filecount : threads * 8;
+
+	vector<double> times(filecount, 0.0);
+	vector<size_t> sizes(filecount, 0);
+	vector<string> errors(filecount);
+	vector<string> warnings(filecount);
+
+	vector<Tool_mei2hum> workers(threads);
+	vector<xml_document> docs(threads);
+	vector<vector<char>> buffers(threads);
+	for (int w=0; w<threads; w++) {
+		static_cast<Options&>(workers[w]) = *this;
+	}
+
+	auto wallstart = std::chrono::steady_clock::now();
+	for (int start=0; start<filecount; start+=batchsize) {
+		int count = std::min(batchsize, filecount - start);
+		vector<string> outputs(directQ ? 0 : count);
+		std::atomic<int> next(start);
+		HumParallel::run(threads, threads, [&](int w) {
+			Tool_mei2hum& worker = workers[w];
+			int i;
+			while ((i = next++) < start + count) {
+				auto starttime = std::chrono::steady_clock::now();
+				worker.m_error_text.str("");
+				worker.m_warning_text.str("");
+				stringstream output;
+				bool status = false;
+				try {
+					if (worker.loadFile(docs[w], buffers[w], filenames[i])) {
+						sizes[i] = buffers[w].size();
+						status = worker.convert(output, docs[w]);
+					}
+				} catch (std::exception& e) {
+					worker.m_error_text << "Error: " << e.what() << endl;
+					status = false;
+				}
+				docs[w].reset();
+				if (!status && (worker.m_error_text.tellp() == 0)) {
+					worker.m_error_text << "Error: cannot convert file" << endl;
+				}
+				if (status && directQ) {
+					string filename = getOutputFilename(filenames[i]);
+					ofstream outfile(filename);
+					outfile << output.str();
+					if (!outfile) {
+						worker.m_error_text << "Error: cannot write to file: "
+						                    << filename << endl;
+					}
+				} else if (!directQ) {
+					outputs[i - start] = output.str();
+				}
+				errors[i] = worker.m_error_text.str();
+				warnings[i] = worker.m_warning_text.str();
+				times[i] = std::chrono::duration<double, std::milli>(
+						std::chrono::steady_clock::now() - starttime).count();
+			}
+		});
+		for (int k=0; k<(int)outputs.size(); k++) {
+			if (!errors[start + k].empty()) {
+				// The file is left out of the output (the error is reported
+				// separately).
+				continue;
+			}
+			if (segmentQ) {
+				out << "!!!!SEGMENT: " << filenames[start + k] << "\n";
+			}
+			out << outputs[k];
+		}
+	}
+	double wallclock = std::chrono::duration<double, std::milli>(
+			std::chrono::steady_clock::now() - wallstart).count();
+
+	bool status = true;
+	for (int i=0; i<filecount; i++) {
+		if (!warnings[i].empty()) {
+			m_warning_text << "File " << filenames[i] << ":\n" << warnings[i];
+		}
+		if (!errors[i].empty()) {
+			status = false;
+			m_error_text << "Error converting file " << filenames[i] << ":\n"
+			             << errors[i];
+		}
+	}
+	if (m_reportQ) {
+		printReport(m_free_text, filenames, times, sizes, errors, wallclock);
+	}
+	return status;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_mei2hum::loadFile -- Read an MEI file into the buffer and parse
+//     it in place, so that the buffer memory (and the memory of the XML
+//     document) can be reused for the next file.  The buffer must not be
+//     changed while the document is in use.
+//
+
+bool Tool_mei2hum::loadFile(xml_document& doc, vector<char>& buffer,
+		const string& filename) {
+	ifstream input(filename, ios::binary);
+	if (!input.is_open()) {
+		m_error_text << "Error: cannot read file: " << filename << endl;
+		return false;
+	}
+	input.seekg(0, ios::end);
+	std::streamoff size = input.tellg();
+	input.seekg(0, ios::beg);
+	buffer.resize(size > 0 ? (size_t)size : 0);
+	if ((size > 0) && !input.read(buffer.data(), size)) {
+		m_error_text << "Error: cannot read file: " << filename << endl;
+		return false;
+	}
+	auto result = doc.load_buffer_inplace(buffer.data(), buffer.size());
+	if (!result) {
+		m_error_text << "XML file [" << filename << "] has syntax errors\n";
+		m_error_text << "Error description:\t" << result.description() << "\n";
+		m_error_text << "Error offset:\t" << result.offset << "\n";
+		return false;
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_mei2hum::getOutputFilename -- Return the name of the file for
+//     the conversion of an MEI file when using the --outdir option: the
+//     directory and extension of the input filename are replaced.
+//
+
+string Tool_mei2hum::getOutputFilename(const string& filename) {
+	string base = filename;
+	auto slash = base.find_last_of("/\\");
+	if (slash != string::npos) {
+		base = base.substr(slash + 1);
+	}
+	auto dot = base.rfind('.');
+	if ((dot != string::npos) && (dot > 0)) {
+		base.resize(dot);
+	}
+	string output = m_outdir;
+	if (!output.empty() && (output.back() != '/')) {
+		output += '/';
+	}
+	return output + base + ".krn";
+}
+
+
+
+//////////////////////////////
+//
+// Tool_mei2hum::printReport -- Print the conversion time, input size and
+//     status of each file, followed by a summary line with the throughput
+//     for the elapsed time of the whole conversion.
+//
+
+void Tool_mei2hum::printReport(ostream& out, const vector<string>& filenames,
+		vector<double>& times, vector<size_t>& sizes, vector<string>& errors,
+		double wallclock) {
+	double total = 0.0;
+	double bytes = 0.0;
+	int failures = 0;
+	out << "!!file\tmsec\tbytes\tstatus\n";
+	for (int i=0; i<(int)filenames.size(); i++) {
+		total += times[i];
+		bytes += sizes[i];
+		if (!errors[i].empty()) {
+			failures++;
+		}
+		out << filenames[i] << "\t"
+		    << std::fixed << std::setprecision(3) << times[i] << "\t"
+		    << sizes[i] << "\t"
+		    << (errors[i].empty() ? "ok" : "error") << "\n";
+	}
+	double seconds = wallclock / 1000.0;
+	out << "!!files: " << filenames.size() << ", errors: " << failures
+	    << ", total msec: " << std::fixed << std::setprecision(3) << total
+	    << ", elapsed msec: " << wallclock;
+	if (seconds > 0.0) {
+		out << ", files/sec: " << std::setprecision(1)
+		    << filenames.size() / seconds
+		    << ", MB/sec: " << std::setprecision(3)
+		    << bytes / 1000000.0 / seconds;
+	}
+	out << "\n";
+}
+
+
+
 //////////////////////////////
 //
 // Tool_mei2hum::processHairpins --
@@ -46023,7 +51676,7 @@ void Tool_mei2hum::processHairpin(hairpin_info& info) {
 	string form    = hairpin.attribute("form").value();
 	string staff   = hairpin.attribute("staff").value();
 	if (staff == "") {
-		cerr << "Error: hairpin requires a staff number" << endl;
+		m_warning_text << "Error: hairpin requires a staff number" << endl;
 		return;
 	}
 
@@ -46287,7 +51940,7 @@ HumNum Tool_mei2hum::parseScore(xml_node score, HumNum starttime) {
 		} else if (nodename == "section") {
 			starttime = parseSection(item, starttime);
 		} else {
-			cerr << DKHTP << score.name() << "/" << nodename << CURRLOC << endl;
+			m_warning_text << DKHTP << score.name() << "/" << nodename << CURRLOC << endl;
 		}
 	}
 
@@ -46323,7 +51976,7 @@ void Tool_mei2hum::parseScoreDef(xml_node scoreDef, HumNum starttime) {
 		} else if (nodename == "pgFoot") {
 		    processPgFoot(item, starttime);
 		} else {
-			cerr << DKHTP << scoreDef.name() << "/" << nodename << CURRLOC << endl;
+			m_warning_text << DKHTP << scoreDef.name() << "/" << nodename << CURRLOC << endl;
 		}
 	}
 
@@ -46391,12 +52044,12 @@ void Tool_mei2hum::getRecursiveSDString(string& output, xml_node current) {
 	if (name == "staffDef") {
 		xml_attribute natt = current.attribute("n");
 		if (!natt) {
-			cerr << "Error: unknown staff number for staffDef" << endl;
+			m_warning_text << "Error: unknown staff number for staffDef" << endl;
 			return;
 		}
 		int n = natt.as_int();
 		if (n < 1) {
-			cerr << "Staff number " << n << " must be positive" << endl;
+			m_warning_text << "Staff number " << n << " must be positive" << endl;
 			return;
 		}
 		output += "s" + to_string(n);
@@ -46444,7 +52097,7 @@ void Tool_mei2hum::getRecursiveSDString(string& output, xml_node current) {
 	} else if (name == "pgFoot") {
 		return;
 	} else {
-		cerr << "Unknown element in scoreDef descendant: " << name << endl;
+		m_warning_text << "Unknown element in scoreDef descendant: " << name << endl;
 	}
 }
 
@@ -46490,7 +52143,7 @@ void Tool_mei2hum::parseStaffGrp(xml_node staffGrp, HumNum starttime) {
 		} else if (nodename == "staffDef") {
 		    parseStaffDef(item, starttime);
 		} else {
-			cerr << DKHTP << staffGrp.name() << "/" << nodename << CURRLOC << endl;
+			m_warning_text << DKHTP << staffGrp.name() << "/" << nodename << CURRLOC << endl;
 		}
 	}
 
@@ -46762,7 +52415,7 @@ void Tool_mei2hum::fillWithStaffDefAttributes(mei_staffDef& staffinfo, xml_node
 				m_currentMeterUnit.at(nnum-1) = stoi(meterunit);
 			}
 		} else {
-			cerr << DKHTP << element.name() << "@meter.count/@meter.unit" << CURRLOC << endl;
+			m_warning_text << DKHTP << element.name() << "@meter.count/@meter.unit" << CURRLOC << endl;
 		}
 
 		staffinfo.timesig = "*M" + metercount + "/" + meterunit;
@@ -46848,7 +52501,7 @@ HumNum Tool_mei2hum::parseSection(xml_node section, HumNum starttime) {
 		} else if (nodename == "staffDef") {   // will this have any useful info?
 		   // ignore for now
 		} else {
-			cerr << DKHTP << section.name() << "/" << nodename << CURRLOC << endl;
+			m_warning_text << DKHTP << section.name() << "/" << nodename << CURRLOC << endl;
 		}
 	}
 
@@ -46873,7 +52526,7 @@ void Tool_mei2hum::parseSectionScoreDef(xml_node scoreDef, HumNum starttime) {
 
 	for (int i=0; i<(int)children.size(); i++) {
 		string nodename = children[i].name();
-		cerr << DKHTP << scoreDef.name() << "/" << nodename << CURRLOC << endl;
+		m_warning_text << DKHTP << scoreDef.name() << "/" << nodename << CURRLOC << endl;
 	}
 }
 
@@ -46892,7 +52545,7 @@ void Tool_mei2hum::parsePb(xml_node pb, HumNum starttime) {
 	// There should be no children of pb (at least any that are currently known)
 	for (int i=0; i<(int)children.size(); i++) {
 		string nodename = children[i].name();
-		cerr << DKHTP << pb.name() << "/" << nodename << CURRLOC << endl;
+		m_warning_text << DKHTP << pb.name() << "/" << nodename << CURRLOC << endl;
 	}
 
 	m_outdata.back()->appendGlobalLayout("!!LO:LB", starttime QUARTER_CONVERT);
@@ -46912,7 +52565,7 @@ void Tool_mei2hum::parseSb(xml_node sb, HumNum starttime) {
 	// There should be no children of sb (at least any that are currently known)
 	for (int i=0; i<(int)children.size(); i++) {
 		string nodename = children[i].name();
-		cerr << DKHTP << sb.name() << "/" << nodename << CURRLOC << endl;
+		m_warning_text << DKHTP << sb.name() << "/" << nodename << CURRLOC << endl;
 	}
 
 	m_outdata.back()->appendGlobalLayout("!!LO:LB", starttime QUARTER_CONVERT);
@@ -46952,7 +52605,7 @@ HumNum Tool_mei2hum::parseApp(xml_node app, HumNum starttime) {
 	} else if (nodename == "rdg") {
 		starttime = parseRdg(target, starttime);
 	} else {
-		cerr << DKHTP << app.name() << "/" << nodename << CURRLOC << endl;
+		m_warning_text << DKHTP << app.name() << "/" << nodename << CURRLOC << endl;
 	}
 
 	return starttime;
@@ -46976,7 +52629,7 @@ HumNum Tool_mei2hum::parseLem(xml_node lem, HumNum starttime) {
 		} else if (nodename == "measure") {
 			starttime = parseMeasure(children[i], starttime);
 		} else {
-			cerr << DKHTP << lem.name() << "/" << nodename << CURRLOC << endl;
+			m_warning_text << DKHTP << lem.name() << "/" << nodename << CURRLOC << endl;
 		}
 	}
 
@@ -47001,7 +52654,7 @@ HumNum Tool_mei2hum::parseRdg(xml_node rdg, HumNum starttime) {
 		} else if (nodename == "measure") {
 			starttime = parseMeasure(children[i], starttime);
 		} else {
-			cerr << DKHTP << rdg.name() << "/" << nodename << CURRLOC << endl;
+			m_warning_text << DKHTP << rdg.name() << "/" << nodename << CURRLOC << endl;
 		}
 	}
 
@@ -47027,7 +52680,7 @@ HumNum Tool_mei2hum::parseMeasure(xml_node measure, HumNum starttime) {
 		nnum = stoi(n);
 	}
 	if (nnum < 0) {
-		cerr << "Error: invalid measure number: " << nnum << endl;
+		m_warning_text << "Error: invalid measure number: " << nnum << endl;
 	}
 	m_currentMeasure = nnum;
 
@@ -47065,7 +52718,7 @@ HumNum Tool_mei2hum::parseMeasure(xml_node measure, HumNum starttime) {
 		} else if (nodename == "reh") {
 			parseReh(children[i], starttime);
 		} else {
-			cerr << DKHTP << measure.name() << "/" << nodename << CURRLOC << endl;
+			m_warning_text << DKHTP << measure.name() << "/" << nodename << CURRLOC << endl;
 		}
 	}
 
@@ -47107,7 +52760,7 @@ HumNum Tool_mei2hum::parseMeasure(xml_node measure, HumNum starttime) {
 				message << ", staff " << i+1 << " is underfilled: ";
 				message << "adding token " << spacer;
 				message << " at end of measure to complete its duration.";
-				cerr << message.str() << endl;
+				m_warning_text << message.str() << endl;
 
 				// Add an invisible rest to fill in the problem spot.
 				// staff with multiple layers will have to be addressed as well...
@@ -47124,7 +52777,7 @@ HumNum Tool_mei2hum::parseMeasure(xml_node measure, HumNum starttime) {
 				message << (durations[i] QUARTER_CONVERT).getFloat();
 				message << " quarter notes instead of ";
 				message << targetDur.getFloat() * 4 << ".";
-				cerr << message.str() << endl;
+				m_warning_text << message.str() << endl;
 				m_outdata.back()->addGlobalComment("!!" + message.str(), starttime QUARTER_CONVERT);
 
 				overfilledQ = true;
@@ -47196,7 +52849,7 @@ void Tool_mei2hum::parseHairpin(xml_node hairpin, HumNum starttime) {
 
 	for (int i=0; i<(int)children.size(); i++) {
 		string nodename = children[i].name();
-		cerr << DKHTP << hairpin.name() << "/" << nodename << CURRLOC << endl;
+		m_warning_text << DKHTP << hairpin.name() << "/" << nodename << CURRLOC << endl;
 	}
 
 	// Store the hairpin for later parsing when more of the
@@ -47227,7 +52880,7 @@ void Tool_mei2hum::parseReh(xml_node reh, HumNum starttime) {
 		if (nodename == "rend") {
 			// deal with reh/rend here.
 		} else {
-			cerr << DKHTP << reh.name() << "/" << nodename << CURRLOC << endl;
+			m_warning_text << DKHTP << reh.name() << "/" << nodename << CURRLOC << endl;
 		}
 	}
 
@@ -47247,12 +52900,12 @@ HumNum Tool_mei2hum::parseStaff(xml_node staff, HumNum starttime) {
 	string n = staff.attribute("n").value();
 	int nnum = 0;
 	if (n.empty()) {
-		cerr << "Warning: no staff number on staff element in measure " << m_currentMeasure << endl;
+		m_warning_text << "Warning: no staff number on staff element in measure " << m_currentMeasure << endl;
 	} else {
 		nnum = stoi(n);
 	}
 	if (nnum < 1) {
-		cerr << "Error: invalid staff number: " << nnum << endl;
+		m_warning_text << "Error: invalid staff number: " << nnum << endl;
 		m_currentStaff++;
 	} else {
 		m_currentStaff = nnum;
@@ -47270,7 +52923,7 @@ HumNum Tool_mei2hum::parseStaff(xml_node staff, HumNum starttime) {
 		if (nodename == "layer") {
 			durations.push_back(parseLayer(children[i], starttime, layerPresent) - starttime);
 		} else {
-			cerr << DKHTP << staff.name() << "/" << nodename << CURRLOC << endl;
+			m_warning_text << DKHTP << staff.name() << "/" << nodename << CURRLOC << endl;
 		}
 	}
 
@@ -47289,7 +52942,7 @@ HumNum Tool_mei2hum::parseStaff(xml_node staff, HumNum starttime) {
 	}
 	if (!complete) {
 		// need to add invisible rests in un-specified layers.
-		cerr << "INCOMPLETE LAYERS IN STAFF" << endl;
+		m_warning_text << "INCOMPLETE LAYERS IN STAFF" << endl;
 	}
 
 	// Check that the duration of each layer is the same here.
@@ -47333,13 +52986,13 @@ HumNum Tool_mei2hum::parseLayer(xml_node layer, HumNum starttime, vector<bool>&
 		nnum = nattr.as_int();
 	}
 	if (nnum < 1) {
-		cerr << "Error: Ignoring layer with invalid number: " << nnum
+		m_warning_text << "Error: Ignoring layer with invalid number: " << nnum
 		     << " in measure " << m_currentMeasure
 		     << ", staff " << m_currentStaff << endl;
 		return starttime;
 	}
 	if (nnum > 8) {
-		cerr << "Error: Ignoring layer with ridiculous number: " << nnum
+		m_warning_text << "Error: Ignoring layer with ridiculous number: " << nnum
 		     << " in measure " << m_currentMeasure
 		     << ", staff " << m_currentStaff << endl;
 		return starttime;
@@ -47366,7 +53019,7 @@ HumNum Tool_mei2hum::parseLayer(xml_node layer, HumNum starttime, vector<bool>&
 
 
 	if (layerPresent.at(m_currentLayer - 1)) {
-		cerr << "Error: measure " << m_currentMeasure
+		m_warning_text << "Error: measure " << m_currentMeasure
 		     << ", staff " << m_currentStaff
 		     << ": layer " << m_currentLayer << " is duplicated on staff: "
 		     << m_currentStaff << ". Ignoring duplicate layer." << endl;
@@ -47397,7 +53050,7 @@ HumNum Tool_mei2hum::parseLayer(xml_node layer, HumNum starttime, vector<bool>&
 		} else if (nodename == "clef") {
 			parseClef(children[i], starttime);
 		} else {
-			cerr << DKHTP << layer.name() << "/" << nodename << CURRLOC << endl;
+			m_warning_text << DKHTP << layer.name() << "/" << nodename << CURRLOC << endl;
 		}
 	}
 
@@ -47425,13 +53078,13 @@ HumNum Tool_mei2hum::parseTuplet(xml_node tuplet, HumNum starttime) {
 	HumNum newfactor = 1;
 
 	if (numbase == "") {
-		cerr << "Warning: tuplet@numbase is empty" << endl;
+		m_warning_text << "Warning: tuplet@numbase is empty" << endl;
 	} else {
 		newfactor = stoi(numbase);
 	}
 
 	if (num == "") {
-		cerr << "Warning: tuplet@num is empty" << endl;
+		m_warning_text << "Warning: tuplet@num is empty" << endl;
 	} else {
 		newfactor /= stoi(num);
 	}
@@ -47474,7 +53127,7 @@ HumNum Tool_mei2hum::parseTuplet(xml_node tuplet, HumNum starttime) {
 		} else if (nodename == "beam") {
 			starttime = parseBeam(children[i], starttime);
 		} else {
-			cerr << DKHTP << tuplet.name() << "/" << nodename << CURRLOC << endl;
+			m_warning_text << DKHTP << tuplet.name() << "/" << nodename << CURRLOC << endl;
 		}
 	}
 
@@ -47536,7 +53189,7 @@ HumNum Tool_mei2hum::parseBeam(xml_node beam, HumNum starttime) {
 		} else if (nodename == "tuplet") {
 			starttime = parseTuplet(children[i], starttime);
 		} else {
-			cerr << DKHTP << beam.name() << "/" << nodename << CURRLOC << endl;
+			m_warning_text << DKHTP << beam.name() << "/" << nodename << CURRLOC << endl;
 		}
 	}
 
@@ -47623,7 +53276,7 @@ void Tool_mei2hum::processGraceNotes(HumNum timestamp) {
 			m_beamPostfix = m_gracenotes[i].beampostfix;
 			parseChord(m_gracenotes[i].node, m_gracetime, counter);
 		} else {
-			cerr << "STRANGE THING HAPPENED HERE, node name is " << nodename << endl;
+			m_warning_text << "STRANGE THING HAPPENED HERE, node name is " << nodename << endl;
 		}
 		counter++;
 	}
@@ -47656,9 +53309,9 @@ HumNum Tool_mei2hum::parseNote(xml_node note, xml_node chord, string& output,
 					// Grace notes at end of previous measure which
 					// should have been processed before coming into the
 					// next measure.
-					cerr << "STRANGE ERROR IN GRACE NOTE PARSING" << endl;
-					cerr << "\tSTARTTIME: " << starttime << endl;
-					cerr << "\tGRACETIME: " << m_gracetime << endl;
+					m_warning_text << "STRANGE ERROR IN GRACE NOTE PARSING" << endl;
+					m_warning_text << "\tSTARTTIME: " << starttime << endl;
+					m_warning_text << "\tGRACETIME: " << m_gracetime << endl;
 				}
 			} else {
 				m_gracetime = starttime;
@@ -47771,7 +53424,7 @@ HumNum Tool_mei2hum::parseNote(xml_node note, xml_node chord, string& output,
 		} else if (nodename == "accid") {
 			// handled elsewhere: don't do anything
 		} else {
-			cerr << DKHTP << note.name() << "/" << nodename << CURRLOC << endl;
+			m_warning_text << DKHTP << note.name() << "/" << nodename << CURRLOC << endl;
 		}
 	}
 
@@ -48261,7 +53914,7 @@ void Tool_mei2hum::processNodeStartLinks(string& output, xml_node node,
 		} else if (nodename == "tupletSpan") {
 			// handled in processNodeStartLinks2
 		} else {
-			cerr << DKHTP << nodename
+			m_warning_text << DKHTP << nodename
 			     << " element in processNodeStartLinks()" << endl;
 		}
 	}
@@ -48301,14 +53954,14 @@ void Tool_mei2hum::parseTupletSpanStart(xml_node node,
 	NODE_VERIFY(tupletSpan, )
 
 	if (strcmp(tupletSpan.attribute("endid").value(), "") == 0) {
-		cerr << "Warning: <tupletSpan> requires endid attribute (at least ";
-		cerr << "for this parser)" << endl;
+		m_warning_text << "Warning: <tupletSpan> requires endid attribute (at least ";
+		m_warning_text << "for this parser)" << endl;
 		return;
 	}
 
 	if (strcmp(tupletSpan.attribute("startid").value(), "") == 0) {
-		cerr << "Warning: <tupletSpan> requires startid attribute (at least ";
-		cerr << "for this parser)" << endl;
+		m_warning_text << "Warning: <tupletSpan> requires startid attribute (at least ";
+		m_warning_text << "for this parser)" << endl;
 		return;
 	}
 
@@ -48318,13 +53971,13 @@ void Tool_mei2hum::parseTupletSpanStart(xml_node node,
 	HumNum newfactor = 1;
 
 	if (numbase == "") {
-		cerr << "Warning: tuplet@numbase is empty" << endl;
+		m_warning_text << "Warning: tuplet@numbase is empty" << endl;
 	} else {
 		newfactor = stoi(numbase);
 	}
 
 	if (num == "") {
-		cerr << "Warning: tuplet@num is empty" << endl;
+		m_warning_text << "Warning: tuplet@num is empty" << endl;
 	} else {
 		newfactor /= stoi(num);
 	}
@@ -48361,13 +54014,13 @@ void Tool_mei2hum::parseTupletSpanStop(string& output, xml_node node,
 	HumNum newfactor = 1;
 
 	if (numbase == "") {
-		cerr << "Warning: tuplet@numbase is empty" << endl;
+		m_warning_text << "Warning: tuplet@numbase is empty" << endl;
 	} else {
 		newfactor = stoi(numbase);
 	}
 
 	if (num == "") {
-		cerr << "Warning: tuplet@num is empty" << endl;
+		m_warning_text << "Warning: tuplet@num is empty" << endl;
 	} else {
 		newfactor /= stoi(num);
 	}
@@ -48389,7 +54042,7 @@ void Tool_mei2hum::parseArpeg(string& output, xml_node node, xml_node arpeg) {
 	NODE_VERIFY(arpeg, )
 
 	if (strcmp(arpeg.attribute("endid").value(), "") != 0) {
-		cerr << "Warning: multi-note arpeggios are not yet handled in the converter." << endl;
+		m_warning_text << "Warning: multi-note arpeggios are not yet handled in the converter." << endl;
 	}
 
 	string nodename = node.name();
@@ -48407,7 +54060,7 @@ void Tool_mei2hum::parseArpeg(string& output, xml_node node, xml_node arpeg) {
 		}
 		output += ':';
 	} else {
-		cerr << DKHTP << "an arpeggio attached to a "
+		m_warning_text << DKHTP << "an arpeggio attached to a "
 		     << nodename << " element" << endl;
 		return;
 	}
@@ -48432,7 +54085,7 @@ void Tool_mei2hum::processNodeStopLinks(string& output, xml_node node,
 		} else if (nodename == "tupletSpan") {
 			parseTupletSpanStop(output, node, nodelist[i]);
 		} else {
-			cerr << DKHTP << nodename
+			m_warning_text << DKHTP << nodename
 			     << " element in processNodeStopLinks()" << endl;
 		}
 	}
@@ -48453,7 +54106,7 @@ void Tool_mei2hum::parseSlurStart(string& output, xml_node node, xml_node slur)
 	} else if (nodename == "chord") {
 		output = "(" + setPlacement(slur.attribute("curvedir").value()) + output;
 	} else {
-		cerr << DKHTP << "a slur start attached to a "
+		m_warning_text << DKHTP << "a slur start attached to a "
 		     << nodename << " element" << endl;
 		return;
 	}
@@ -48475,7 +54128,7 @@ void Tool_mei2hum::parseSlurStop(string& output, xml_node node, xml_node slur) {
 	} else if (nodename == "chord") {
 		output += ")";
 	} else {
-		cerr << DKHTP << "a tie end attached to a "
+		m_warning_text << DKHTP << "a tie end attached to a "
 		     << nodename << " element" << endl;
 		return;
 	}
@@ -48508,7 +54161,7 @@ void Tool_mei2hum::parseTieStart(string& output, xml_node node, xml_node tie) {
 	if (nodename == "note") {
 		output = "[" + output;
 	} else {
-		cerr << DKHTP << "a tie start attached to a "
+		m_warning_text << DKHTP << "a tie start attached to a "
 		     << nodename << " element" << endl;
 		return;
 	}
@@ -48568,7 +54221,7 @@ void Tool_mei2hum::parseTieStop(string& output, xml_node node, xml_node tie) {
 	if (nodename == "note") {
 		output += "]";
 	} else {
-		cerr << DKHTP << "a tie end attached to a "
+		m_warning_text << DKHTP << "a tie end attached to a "
 		     << nodename << " element" << endl;
 		return;
 	}
@@ -48593,7 +54246,7 @@ void Tool_mei2hum::parseFermata(string& output, xml_node node, xml_node fermata)
 	} else if (nodename == "rest") {
 		output += ';';
 	} else {
-		cerr << DKHTP << "a fermata attached to a "
+		m_warning_text << DKHTP << "a fermata attached to a "
 		     << nodename << " element" << endl;
 		return;
 	}
@@ -48717,15 +54370,15 @@ string Tool_mei2hum::getHumdrumPitch(xml_node note, vector<xml_node>& children)
 	int octnum = 4;
 	string oct = note.attribute("oct").value();
 	if (oct == "") {
-		cerr << "Empty octave" << endl;
+		m_warning_text << "Empty octave" << endl;
 	} else if (isdigit(oct[0])) {
 		octnum = stoi(oct);
 	} else {
-		cerr << "Unknown octave value: " << oct << endl;
+		m_warning_text << "Unknown octave value: " << oct << endl;
 	}
 
 	if (pname == "") {
-		cerr << "Empty pname" << endl;
+		m_warning_text << "Empty pname" << endl;
 		return "x";
 	}
 
@@ -48823,12 +54476,12 @@ HumNum Tool_mei2hum::getDuration(xml_node element) {
 		output = 1;
 		output /= stoi(dur);
 	} else {
-		cerr << "Unknown " << element.name() << "@dur: " << dur << endl;
+		m_warning_text << "Unknown " << element.name() << "@dur: " << dur << endl;
 		return 0;
 	}
 
 	if (output == 0) {
-		cerr << "Error: zero duration for note" << endl;
+		m_warning_text << "Error: zero duration for note" << endl;
 	}
 
 	int dotcount;
@@ -48838,7 +54491,7 @@ HumNum Tool_mei2hum::getDuration(xml_node element) {
 	} else if (isdigit(dots[0])) {
 		dotcount = stoi(dots);
 	} else {
-		cerr << "Unknown " << element.name() << "@dotcount: " << dur << endl;
+		m_warning_text << "Unknown " << element.name() << "@dotcount: " << dur << endl;
 		return 0;
 	}
 
@@ -48871,13 +54524,13 @@ void Tool_mei2hum::parseVerse(xml_node verse, GridStaff* staff) {
 	string n = verse.attribute("n").value();
 	int nnum = 1;
 	if (n.empty()) {
-		cerr << "Warning: no layer number on layer element" << endl;
+		m_warning_text << "Warning: no layer number on layer element" << endl;
 	} else {
 		nnum = stoi(n);
 	}
 	if (nnum < 1) {
-		cerr << "Warning: invalid layer number: " << nnum << endl;
-		cerr << "Setting it to 1." << endl;
+		m_warning_text << "Warning: invalid layer number: " << nnum << endl;
+		m_warning_text << "Setting it to 1." << endl;
 		nnum = 1;
 	}
 
@@ -48893,7 +54546,7 @@ void Tool_mei2hum::parseVerse(xml_node verse, GridStaff* staff) {
 			sylcount++;
 			versetext += parseSyl(children[i]);
 		} else {
-			cerr << DKHTP << verse.name() << "/" << nodename << CURRLOC << endl;
+			m_warning_text << DKHTP << verse.name() << "/" << nodename << CURRLOC << endl;
 		}
 	}
 
@@ -48926,8 +54579,8 @@ void Tool_mei2hum::parseBareSyl(xml_node syl, GridStaff* staff) {
 	}
 
 	if (nnum < 1) {
-		cerr << "Warning: invalid layer number: " << nnum << endl;
-		cerr << "Setting it to 1." << endl;
+		m_warning_text << "Warning: invalid layer number: " << nnum << endl;
+		m_warning_text << "Setting it to 1." << endl;
 		nnum = 1;
 	}
 
@@ -49079,7 +54732,7 @@ HumNum Tool_mei2hum::parseChord(xml_node chord, HumNum starttime, int gracenumbe
 		} else if (nodename == "artic") {
 			// This is handled within parseNote();
 		} else {
-			cerr << DKHTP << chord.name() << "/" << nodename << CURRLOC << endl;
+			m_warning_text << DKHTP << chord.name() << "/" << nodename << CURRLOC << endl;
 		}
 	}
 
@@ -49125,6 +54778,9 @@ void Tool_mei2hum::initialize(void) {
 	m_stemsQ   =  getBoolean("stems");
 	m_appLabel =  getString("app-label");
 	m_placeQ   = !getBoolean("no-place");
+	m_threads  =  HumParallel::getThreadCount(getInteger("threads"));
+	m_outdir   =  getString("outdir");
+	m_reportQ  =  getBoolean("report");
 }
 
 
@@ -49244,7 +54900,7 @@ void Tool_mei2hum::parseDir(xml_node dir, HumNum starttime) {
 				count++;
 				text += children[i].value();
 			} else {
-				cerr << DKHTP << dir.name() << "/" << nodename << CURRLOC << endl;
+				m_warning_text << DKHTP << dir.name() << "/" << nodename << CURRLOC << endl;
 			}
 		}
 	}
@@ -49262,20 +54918,20 @@ void Tool_mei2hum::parseDir(xml_node dir, HumNum starttime) {
 
 	string ts = dir.attribute("tstamp").value();
 	if (ts.empty()) {
-		cerr << "Error: no timestamp on dir element and can't currently processes with @startid." << endl;
+		m_warning_text << "Error: no timestamp on dir element and can't currently processes with @startid." << endl;
 		return;
 	}
 
 	xml_attribute atstaffnum = dir.attribute("staff");
 	if (!atstaffnum) {
-		cerr << "Error: staff number required on dir element in measure "
+		m_warning_text << "Error: staff number required on dir element in measure "
 		     << m_currentMeasure  << " (ignoring text: " << cleanWhiteSpace(text) << ")" << endl;
 		return;
 	}
 	int staffnum = dir.attribute("staff").as_int();
 	if (staffnum <= 0) {
-		cerr << "Error: staff number on dir element in measure should be positive.\n";
-		cerr << "Instead the staff number is: " << m_currentMeasure  << " (ignoring text: " <<  cleanWhiteSpace(text) << ")" << endl;
+		m_warning_text << "Error: staff number on dir element in measure should be positive.\n";
+		m_warning_text << "Instead the staff number is: " << m_currentMeasure  << " (ignoring text: " <<  cleanWhiteSpace(text) << ")" << endl;
 		return;
 	}
 
@@ -49339,7 +54995,7 @@ void Tool_mei2hum::parseDir(xml_node dir, HumNum starttime) {
 		break;
 	}
 	if (!foundslice) {
-		cerr << "Warning: dir elements not occuring at note/rest times are not yet supported" << endl;
+		m_warning_text << "Warning: dir elements not occuring at note/rest times are not yet supported" << endl;
 	}
 }
 
@@ -49690,7 +55346,7 @@ void Tool_mei2hum::parseHarm(xml_node harm, HumNum starttime) {
 				count++;
 				text += children[i].value();
 			} else {
-				cerr << DKHTP << harm.name() << "/" << nodename << CURRLOC << endl;
+				m_warning_text << DKHTP << harm.name() << "/" << nodename << CURRLOC << endl;
 			}
 		}
 	}
@@ -49707,7 +55363,7 @@ void Tool_mei2hum::parseHarm(xml_node harm, HumNum starttime) {
 
 	int staffnum = harm.attribute("staff").as_int();
 	if (staffnum == 0) {
-		cerr << "Error: staff number required on harm element" << endl;
+		m_warning_text << "Error: staff number required on harm element" << endl;
 		return;
 	}
 	double meterunit = m_currentMeterUnit[staffnum - 1];
@@ -49715,13 +55371,13 @@ void Tool_mei2hum::parseHarm(xml_node harm, HumNum starttime) {
 	if (!startid.empty()) {
 		// Harmony is (or at least should) be attached directly
 		// do a note, so it is handled elsewhere.
-		cerr << "Warning DYNAMIC " << text << " is not yet processed." << endl;
+		m_warning_text << "Warning DYNAMIC " << text << " is not yet processed." << endl;
 		return;
 	}
 
 	string ts = harm.attribute("tstamp").value();
 	if (ts.empty()) {
-		cerr << "Error: no timestamp on harm element" << endl;
+		m_warning_text << "Error: no timestamp on harm element" << endl;
 		return;
 	}
 	double tsd = (stof(ts)-1) * 4.0 / meterunit;
@@ -49755,7 +55411,7 @@ void Tool_mei2hum::parseHarm(xml_node harm, HumNum starttime) {
 	}
 	if (!foundslice) {
 		if (nextgs == NULL) {
-			cerr << "Warning: harmony not attched to system events "
+			m_warning_text << "Warning: harmony not attched to system events "
 					<< "are not yet supported in measure " << m_currentMeasure << endl;
 		} else {
 			GridPart* part = nextgs->at(staffnum-1);
@@ -49808,7 +55464,7 @@ void Tool_mei2hum::parseDynam(xml_node dynam, HumNum starttime) {
 				count++;
 				text += children[i].value();
 			} else {
-				cerr << DKHTP << dynam.name() << "/" << nodename << CURRLOC << endl;
+				m_warning_text << DKHTP << dynam.name() << "/" << nodename << CURRLOC << endl;
 			}
 		}
 	}
@@ -49821,7 +55477,7 @@ void Tool_mei2hum::parseDynam(xml_node dynam, HumNum starttime) {
 
 	int staffnum = dynam.attribute("staff").as_int();
 	if (staffnum == 0) {
-		cerr << "Error: staff number required on dynam element" << endl;
+		m_warning_text << "Error: staff number required on dynam element" << endl;
 		return;
 	}
 	double meterunit = m_currentMeterUnit[staffnum - 1];
@@ -49829,13 +55485,13 @@ void Tool_mei2hum::parseDynam(xml_node dynam, HumNum starttime) {
 	if (!startid.empty()) {
 		// Dynamic is (or at least should) be attached directly
 		// do a note, so it is handled elsewhere.
-		cerr << "Warning DYNAMIC " << text << " is not yet processed." << endl;
+		m_warning_text << "Warning DYNAMIC " << text << " is not yet processed." << endl;
 		return;
 	}
 
 	string ts = dynam.attribute("tstamp").value();
 	if (ts.empty()) {
-		cerr << "Error: no timestamp on dynam element" << endl;
+		m_warning_text << "Error: no timestamp on dynam element" << endl;
 		return;
 	}
 	double tsd = (stof(ts)-1) * 4.0 / meterunit;
@@ -49868,7 +55524,7 @@ void Tool_mei2hum::parseDynam(xml_node dynam, HumNum starttime) {
 	}
 	if (!foundslice) {
 		if (nextgs == NULL) {
-			cerr << "Warning: dynamics not attched to system events "
+			m_warning_text << "Warning: dynamics not attched to system events "
 					<< "are not yet supported in measure " << m_currentMeasure << endl;
 		} else {
 			GridPart* part = nextgs->at(staffnum-1);
@@ -49897,6 +55553,10 @@ Tool_metlev::Tool_metlev(void) {
 	define("G|no-grace-notes=b",  "do not mark grace note lines");
 	define("k|kern-spine=i:1",    "analyze only given kern spine");
 	define("e|exinterp=s:blev",   "exclusive interpretation type for output");
+
+	// The Humdrum output is read back in when adding the analysis
+	// to the input data:
+	m_buffer_humdrum = true;
 }
 
 
@@ -50790,6 +56450,9 @@ bool Tool_musicxml2hum::convert(ostream& out, xml_document& doc) {
 	// re-index voices to disallow empty intermediate voices.
 	reindexVoices(partdata);
 
+	// place all parts on a common integer timeline for alignment:
+	setTimelineTpq(partdata);
+
 	HumGrid outdata;
 	status &= stitchParts(outdata, partids, partinfo, partcontent, partdata);
 
@@ -51516,6 +57179,27 @@ void Tool_musicxml2hum::insertPartNames(HumGrid& outdata, vector<MxmlPart>& part
 
 
 
+//////////////////////////////
+//
+// Tool_musicxml2hum::setTimelineTpq -- Convert the event times of all
+//     parts into integer ticks using a common number of ticks per quarter
+//     note, so that events in different parts (which may have different
+//     <divisions>) can be aligned with integer comparisons.
+//
+
+void Tool_musicxml2hum::setTimelineTpq(vector<MxmlPart>& partdata) {
+	vector<int> tpqs;
+	for (int i=0; i<(int)partdata.size(); i++) {
+		tpqs.push_back(partdata[i].getMinimumTimelineTpq());
+	}
+	int tpq = tpqs.empty() ? 1 : Convert::getLcm(tpqs);
+	for (int i=0; i<(int)partdata.size(); i++) {
+		partdata[i].setTimelineTpq(tpq);
+	}
+}
+
+
+
 //////////////////////////////
 //
 // Tool_musicxml2hum::stitchParts -- Merge individual parts into a
@@ -51663,15 +57347,19 @@ bool Tool_musicxml2hum::insertMeasure(HumGrid& outdata, int mnum,
 		}
 	}
 
+	// Event times are compared as integer ticks on the common timeline
+	// of the parts, and the quarter-note times are passed to the grid.
+	int tpq = partdata[0].getTimelineTpq();
+	vector<long> curtick(partdata.size());
 	vector<HumNum> curtime(partdata.size());
-	vector<HumNum> measuredurs(partdata.size());
 	vector<int> curindex(partdata.size(), 0); // assuming data in a measure...
+	long nexttick = -1;
 	HumNum nexttime = -1;
 
 	vector<vector<MxmlEvent*>> endingDirections(partdata.size());
 
 	HumNum tsdur;
-	for (i=0; i<(int)curtime.size(); i++) {
+	for (i=0; i<(int)curtick.size(); i++) {
 		tsdur = measuredata[i]->getTimeSigDur();
 		if ((tsdur == 0) && (i > 0)) {
 			tsdur = measuredata[i-1]->getTimeSigDur();
@@ -51718,16 +57406,16 @@ bool Tool_musicxml2hum::insertMeasure(HumGrid& outdata, int mnum,
 			cerr << "======================================" << endl;
 		}
 		if (!(*sevents[i]).empty()) {
+			curtick[i] = (*sevents[i])[curindex[i]].tickstart;
 			curtime[i] = (*sevents[i])[curindex[i]].starttime;
 		} else {
+			curtick[i] = MxmlEvent::timeToTicks(tsdur, tpq);
 			curtime[i] = tsdur;
 		}
-		if (nexttime < 0) {
-			nexttime = curtime[i];
-		} else if (curtime[i] < nexttime) {
+		if ((nexttick < 0) || (curtick[i] < nexttick)) {
+			nexttick = curtick[i];
 			nexttime = curtime[i];
 		}
-		measuredurs[i] = measuredata[i]->getDuration();
 	}
 
 	bool allend = false;
@@ -51736,18 +57424,21 @@ bool Tool_musicxml2hum::insertMeasure(HumGrid& outdata, int mnum,
 	bool status = true;
 
 	HumNum processtime = nexttime;
+	long processtick = nexttick;
 	while (!allend) {
 		nowevents.resize(0);
 		nowparts.resize(0);
 		allend = true;
 		processtime = nexttime;
+		processtick = nexttick;
 		nexttime = -1;
+		nexttick = -1;
 		for (i = (int)partdata.size()-1; i >= 0; i--) {
 			if (curindex[i] >= (int)(*sevents[i]).size()) {
 				continue;
 			}
 
-			if ((*sevents[i])[curindex[i]].starttime == processtime) {
+			if ((*sevents[i])[curindex[i]].tickstart == processtick) {
 				SimultaneousEvents* thing = &(*sevents[i])[curindex[i]];
 				nowevents.push_back(thing);
 				nowparts.push_back(i);
@@ -51756,8 +57447,9 @@ bool Tool_musicxml2hum::insertMeasure(HumGrid& outdata, int mnum,
 
 			if (curindex[i] < (int)(*sevents[i]).size()) {
 				allend = false;
-				if ((nexttime < 0) ||
-						((*sevents[i])[curindex[i]].starttime < nexttime)) {
+				if ((nexttick < 0) ||
+						((*sevents[i])[curindex[i]].tickstart < nexttick)) {
+					nexttick = (*sevents[i])[curindex[i]].tickstart;
 					nexttime = (*sevents[i])[curindex[i]].starttime;
 				}
 			}
@@ -54859,13 +60551,44 @@ bool Tool_myank::run(HumdrumFileSet& infiles) {
 
 bool Tool_myank::run(const string& indata, ostream& out) {
 	HumdrumFile infile(indata);
-	bool status = run(infile);
-	if (hasAnyText()) {
-		getAllText(out);
-	} else {
-		out << infile;
+	return run(infile, out);
+}
+
+//
+// Extract measures from the text of a score.  The score is indexed
+// rather than parsed if a single range of measures is requested.
+//
+
+bool Tool_myank::runString(const string& data, ostream& out) {
+	if (isIndexable()) {
+		MyankIndex index;
+		index.build(data);
+		return run(index, out);
 	}
-	return status;
+	HumdrumFile infile;
+	infile.readString(data);
+	return run(infile, out);
+}
+
+//
+// Extract measures from an indexed score.  If a single range of measures
+// is requested, only the lines of the score needed for the range are
+// parsed; otherwise the entire score is parsed.
+//
+
+bool Tool_myank::run(const MyankIndex& index, ostream& out) {
+	int startmeasure;
+	int endmeasure;
+	string data;
+	if (getSimpleMeasureRange(startmeasure, endmeasure)
+			&& index.extract(data, startmeasure, endmeasure)) {
+		HumdrumFile infile;
+		infile.readString(data);
+		return run(infile, out);
+	}
+	HumdrumFile infile;
+	infile.readString(index.getData());
+	return run(infile, out);
 }
 
 
@@ -55050,6 +60773,7 @@ void Tool_myank::processFile(HumdrumFile& infile) {
 	}
 
 	// expand to multiple measures later.
+	MeasureOutList.clear();
 	expandMeasureOutList(MeasureOutList, MeasureInList, infile,
 			measurestring);
 
@@ -55076,6 +60800,60 @@ void Tool_myank::processFile(HumdrumFile& infile) {
 
 
 
+//////////////////////////////
+//
+// Tool_myank::isIndexable -- Returns true if the options can be processed
+//     with a MyankIndex (see runString()), so that the input does not
+//     need to be parsed before running the tool.
+//
+
+bool Tool_myank::isIndexable(void) {
+	int startmeasure;
+	int endmeasure;
+	return getSimpleMeasureRange(startmeasure, endmeasure);
+}
+
+
+
+//////////////////////////////
+//
+// Tool_myank::getSimpleMeasureRange -- Returns true if the options request
+//     a single ascending range of numbered measures (such as "-m 120-130")
+//     which can be extracted with a MyankIndex.
+//
+
+bool Tool_myank::getSimpleMeasureRange(int& startmeasure, int& endmeasure) {
+	startmeasure = -1;
+	endmeasure = -1;
+	if (!getBoolean("measures")) {
+		return false;
+	}
+	if (getBoolean("author") || getBoolean("version") || getBoolean("help")
+			|| getBoolean("example") || getBoolean("debug")
+			|| getBoolean("inlist") || getBoolean("outlist")
+			|| getBoolean("max") || getBoolean("min") || getBoolean("mark")
+			|| getBoolean("section-count") || getInteger("section")) {
+		return false;
+	}
+	HumRegex hre;
+	if (!hre.search(getString("measures"), "^\\s*(\\d+)\\s*(-+\\s*(\\d+))?\\s*$")) {
+		return false;
+	}
+	startmeasure = hre.getMatchInt(1);
+	if (hre.getMatch(3).empty()) {
+		endmeasure = startmeasure;
+	} else {
+		endmeasure = hre.getMatchInt(3);
+	}
+	// Measure 0 (pickup) requires analysis of the start of the score.
+	if ((startmeasure <= 0) || (endmeasure < startmeasure)) {
+		return false;
+	}
+	return true;
+}
+
+
+
 ////////////////////////
 //
 // Tool_myank::getMetStates --  Store the current *met for every token
@@ -56168,10 +61946,6 @@ void Tool_myank::printEnding(HumdrumFile& infile, int lastline, int adjlin) {
 		}
 	}
 
-	if (ending >= 0) {
-		reconcileSpineBoundary(infile, adjlin, ending);
-	}
-
 	int startline  = ending;
 	if (marker >= 0) {
 		// capture any comment which occur after the last measure
@@ -56179,6 +61953,23 @@ void Tool_myank::printEnding(HumdrumFile& infile, int lastline, int adjlin) {
 		startline = marker;
 	}
 
+	// Lines from startline to the end are printed verbatim, so reconcile
+	// with the first spined line which is printed rather than with the
+	// final "*-" line (otherwise any manipulators in between will be
+	// applied twice).
+	int reconcileline = ending;
+	if (startline >= 0) {
+		for (i=startline; i<infile.getLineCount(); i++) {
+			if (infile[i].hasSpines()) {
+				reconcileline = i;
+				break;
+			}
+		}
+	}
+	if (reconcileline >= 0) {
+		reconcileSpineBoundary(infile, adjlin, reconcileline);
+	}
+
 	// reconcileSpineBoundary(infile, lastline, startline);
 
 	if (startline >= 0) {
@@ -57075,6 +62866,367 @@ void Tool_myank::removeDollarsFromString(string& buffer, int maxx) {
 
 
 
+//////////////////////////////
+//
+// MyankIndex::clear -- Remove the contents of the index.
+//
+
+void MyankIndex::clear(void) {
+	m_data = NULL;
+	m_valid = false;
+	m_kern.clear();
+	m_headerend = 0;
+	m_tailstart = 0;
+	m_barnum.clear();
+	m_baroffset.clear();
+	m_stateoffset.clear();
+}
+
+
+
+//////////////////////////////
+//
+// MyankIndex::build -- Index the numbered barlines and the lines containing
+//     clef, key signature, key, time signature, mensuration and tempo
+//     interpretations in the given Humdrum data.  Only the first character
+//     of most lines is examined.  Returns false if the data cannot be used
+//     for indexed extraction: spine manipulators (other than the final
+//     terminators), multiple segments, or barline numbers which are not
+//     strictly increasing.  In that case the data has to be processed by
+//     parsing the entire score.
+//
+
+bool MyankIndex::build(const string& data) {
+	clear();
+	m_data = &data;
+
+	bool exinterp = false;
+	bool terminated = false;
+	size_t tailstart = string::npos;
+	size_t size = data.size();
+	size_t pos = 0;
+	vector<string> tokens;
+
+	while (pos < size) {
+		size_t end = getLineEnd(pos);
+		size_t next = (end < size) ? end + 1 : size;
+		if ((pos == end) || (data[pos] == '!')) {
+			pos = next;
+			continue;
+		}
+		if (terminated) {
+			// Multiple segments or data after the spine terminators.
+			return false;
+		}
+
+		if (data[pos] == '*') {
+			string line = data.substr(pos, end - pos);
+			if (!line.empty() && (line.back() == '\r')) {
+				line.pop_back();
+			}
+			tokens.clear();
+			size_t tstart = 0;
+			while (true) {
+				size_t tend = line.find('\t', tstart);
+				tokens.push_back(line.substr(tstart, tend - tstart));
+				if (tend == string::npos) {
+					break;
+				}
+				tstart = tend + 1;
+			}
+			if (line.compare(0, 2, "**") == 0) {
+				if (exinterp) {
+					return false;
+				}
+				exinterp = true;
+				m_kern.resize(tokens.size());
+				for (int i=0; i<(int)tokens.size(); i++) {
+					m_kern[i] = (tokens[i] == "**kern");
+				}
+				pos = next;
+				continue;
+			}
+			if ((!exinterp) || (tokens.size() != m_kern.size())) {
+				return false;
+			}
+			int terminators = 0;
+			bool state = false;
+			for (int i=0; i<(int)tokens.size(); i++) {
+				const string& token = tokens[i];
+				if (token == "*-") {
+					terminators++;
+				} else if ((token == "*^") || (token == "*v") || (token == "*+")
+						|| (token == "*x")) {
+					return false;
+				} else if (m_kern[i] && (getStateType(token) >= 0)) {
+					state = true;
+				}
+			}
+			if (terminators) {
+				if (terminators != (int)tokens.size()) {
+					return false;
+				}
+				terminated = true;
+			} else if (state) {
+				m_stateoffset.push_back(pos);
+			}
+			pos = next;
+			continue;
+		}
+
+		if (!exinterp) {
+			return false;
+		}
+		tailstart = next;
+		if (data[pos] == '=') {
+			// Measures start at barlines in the form "=%d" (see
+			// Tool_myank::getMeasureStartStop()), so other barlines
+			// with numbers cannot be indexed.
+			size_t tend = data.find_first_of("\t\r\n", pos);
+			if ((tend == string::npos) || (tend > end)) {
+				tend = end;
+			}
+			bool hasdigit = false;
+			for (size_t i=pos+1; i<tend; i++) {
+				if (isdigit(data[i])) {
+					hasdigit = true;
+					break;
+				}
+			}
+			if (hasdigit) {
+				if (!isdigit(data[pos+1])) {
+					return false;
+				}
+				int number = atoi(data.c_str() + pos + 1);
+				if ((!m_barnum.empty()) && (number <= m_barnum.back())) {
+					return false;
+				}
+				m_barnum.push_back(number);
+				m_baroffset.push_back(pos);
+			}
+		}
+		pos = next;
+	}
+
+	if ((!terminated) || m_barnum.empty()) {
+		return false;
+	}
+	m_headerend = m_baroffset[0];
+	m_tailstart = tailstart;
+	m_valid = true;
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// MyankIndex::getData -- Return the indexed text.
+//
+
+const string& MyankIndex::getData(void) const {
+	static const string empty;
+	if (m_data == NULL) {
+		return empty;
+	}
+	return *m_data;
+}
+
+
+
+//////////////////////////////
+//
+// MyankIndex::hasMeasure -- Returns true if the given measure number
+//     has been indexed.
+//
+
+bool MyankIndex::hasMeasure(int number) const {
+	if (!m_valid) {
+		return false;
+	}
+	return std::binary_search(m_barnum.begin(), m_barnum.end(), number);
+}
+
+
+
+//////////////////////////////
+//
+// MyankIndex::extract -- Create a reduced Humdrum score which contains the
+//     header of the indexed data, the barline before the start of the
+//     measure range followed by interpretation lines giving the clef, key
+//     and meter state in effect at that point, the lines of the measure
+//     range and the end of the data.  Running myank on the reduced score
+//     with the same measure range produces the same output as running it
+//     on the complete score.  Returns false if the range cannot be
+//     extracted from the index.
+//
+
+bool MyankIndex::extract(string& output, int startmeasure, int endmeasure) const {
+	output.clear();
+	if ((!m_valid) || (startmeasure > endmeasure)) {
+		return false;
+	}
+	auto first = std::lower_bound(m_barnum.begin(), m_barnum.end(), startmeasure);
+	if ((first == m_barnum.end()) || (*first != startmeasure)) {
+		return false;
+	}
+	auto last = std::lower_bound(first, m_barnum.end(), endmeasure);
+	if ((last == m_barnum.end()) || (*last != endmeasure)) {
+		return false;
+	}
+	int b1 = (int)(first - m_barnum.begin());
+	int b2 = (int)(last - m_barnum.begin());
+	const string& data = *m_data;
+
+	output.append(data, 0, m_headerend);
+
+	if (b1 > 0) {
+		appendLine(output, m_baroffset[b1-1]);
+
+		// Search backwards for the last clef, key signature, key, time
+		// signature, mensuration and tempo in each **kern spine.  States
+		// set in the header are already present in the output.
+		int fields = (int)m_kern.size();
+		vector<vector<string>> state(6);
+		for (int i=0; i<(int)state.size(); i++) {
+			state[i].resize(fields);
+		}
+		int unresolved = 0;
+		for (int i=0; i<fields; i++) {
+			if (m_kern[i]) {
+				unresolved += (int)state.size();
+			}
+		}
+		auto it = std::lower_bound(m_stateoffset.begin(), m_stateoffset.end(),
+				m_baroffset[b1]);
+		while ((unresolved > 0) && (it != m_stateoffset.begin())) {
+			--it;
+			if (*it < m_headerend) {
+				break;
+			}
+			string line = data.substr(*it, getLineEnd(*it) - *it);
+			if (!line.empty() && (line.back() == '\r')) {
+				line.pop_back();
+			}
+			size_t tstart = 0;
+			for (int i=0; i<fields; i++) {
+				size_t tend = line.find('\t', tstart);
+				if (m_kern[i]) {
+					string token = line.substr(tstart, tend - tstart);
+					int type = getStateType(token);
+					if ((type >= 0) && state[type][i].empty()) {
+						state[type][i] = token;
+						unresolved--;
+					}
+				}
+				if (tend == string::npos) {
+					break;
+				}
+				tstart = tend + 1;
+			}
+		}
+		for (int i=0; i<(int)state.size(); i++) {
+			bool found = false;
+			for (int j=0; j<fields; j++) {
+				if (!state[i][j].empty()) {
+					found = true;
+					break;
+				}
+			}
+			if (!found) {
+				continue;
+			}
+			for (int j=0; j<fields; j++) {
+				output += state[i][j].empty() ? "*" : state[i][j];
+				output += (j < fields - 1) ? '\t' : '\n';
+			}
+		}
+	}
+
+	if (b2 + 1 < (int)m_baroffset.size()) {
+		// Copy up to the barline ending the range, then the spine
+		// terminators and any comments after the last measure.
+		size_t stop = getLineEnd(m_baroffset[b2+1]);
+		output.append(data, m_baroffset[b1], stop - m_baroffset[b1]);
+		output += '\n';
+		if (m_tailstart < data.size()) {
+			output.append(data, m_tailstart, string::npos);
+		}
+	} else {
+		output.append(data, m_baroffset[b1], string::npos);
+	}
+
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// MyankIndex::getStateType -- Return the type of state interpretation, in
+//     the same order of precedence as Tool_myank::fillGlobalDefaults():
+//     0 = clef, 1 = key signature, 2 = key, 3 = time signature,
+//     4 = mensuration, 5 = tempo.  Returns -1 for other tokens.
+//
+
+int MyankIndex::getStateType(const string& token) const {
+	if ((token.size() < 3) || (token[0] != '*')) {
+		return -1;
+	}
+	if (token.compare(0, 5, "*clef") == 0) {
+		return 0;
+	}
+	HumRegex hre;
+	if (hre.search(token, R"(^\*k\[.*\])")) {
+		return 1;
+	}
+	if (hre.search(token, "^\\*[A-G][#-]?:", "i")) {
+		return 2;
+	}
+	if (hre.search(token, R"(^\*M\d+/\d+)")) {
+		return 3;
+	}
+	if (hre.search(token, R"(^\*met\(.*\))")) {
+		return 4;
+	}
+	if (hre.search(token, R"(^\*MM[\d.]+)")) {
+		return 5;
+	}
+	return -1;
+}
+
+
+
+//////////////////////////////
+//
+// MyankIndex::appendLine -- Append the line starting at the given offset
+//     in the indexed text to the output.
+//
+
+void MyankIndex::appendLine(string& output, size_t offset) const {
+	output.append(*m_data, offset, getLineEnd(offset) - offset);
+	output += '\n';
+}
+
+
+
+//////////////////////////////
+//
+// MyankIndex::getLineEnd -- Return the offset of the newline at the end
+//     of the line starting at the given offset (or the size of the text
+//     if the last line has no newline).
+//
+
+size_t MyankIndex::getLineEnd(size_t offset) const {
+	size_t end = m_data->find('\n', offset);
+	if (end == string::npos) {
+		return m_data->size();
+	}
+	return end;
+}
+
+
+
 //////////////////////////////
 //
 // Tool_myank::example -- example function calls to the program.
@@ -57099,6 +63251,400 @@ void Tool_myank::usage(const string& ommand) {
 
 
 
+/////////////////////////////////
+//
+// Tool_notecols::Tool_notecols -- Set the recognized options for the tool.
+//
+
+Tool_notecols::Tool_notecols(void) {
+	define("t|text=b", "print columns as tab-separated text");
+	define("j|threads=i:0", "number of files to analyze at the same time (0 = all cores)");
+	define("b|batch=i:64", "number of input files to read before analyzing them");
+}
+
+
+
+/////////////////////////////////
+//
+// Tool_notecols::run -- Do the main work of the tool.  The output for
+//     all files processed by the same tool object is stored in a single
+//     table with one header.
+//
+
+bool Tool_notecols::run(HumdrumFileSet& infiles) {
+	if (!initialize()) {
+		return false;
+	}
+	printHeader(m_free_text);
+	return processFiles(infiles, m_free_text);
+}
+
+
+bool Tool_notecols::run(const string& indata, ostream& out) {
+	HumdrumFile infile(indata);
+	bool status = run(infile);
+	if (hasAnyText()) {
+		getAllText(out);
+	} else {
+		out << infile;
+	}
+	return status;
+}
+
+
+bool Tool_notecols::run(HumdrumFile& infile, ostream& out) {
+	bool status = run(infile);
+	if (hasAnyText()) {
+		getAllText(out);
+	} else {
+		out << infile;
+	}
+	return status;
+}
+
+
+bool Tool_notecols::run(HumdrumFile& infile) {
+	if (!initialize()) {
+		return false;
+	}
+	printHeader(m_free_text);
+	printBlock(infile, m_free_text);
+	return true;
+}
+
+
+//
+// Streaming interface: the text of the input files is read in batches
+// (-b option), and the files of each batch are parsed and analyzed in
+// parallel and printed in their input order before the next batch is read.
+//
+
+bool Tool_notecols::run(HumdrumFileStream& instream, ostream& out) {
+	if (!initialize()) {
+		return false;
+	}
+	printHeader(out);
+	bool status = true;
+	bool doneQ = false;
+	stringstream buffer;
+	HumdrumFile fileinfo;
+	while (!doneQ) {
+		vector<string> contents;
+		vector<string> filenames;
+		while ((int)contents.size() < m_batch) {
+			if (!instream.getFileContents(buffer, fileinfo)) {
+				doneQ = true;
+				break;
+			}
+			contents.push_back(buffer.str());
+			filenames.push_back(fileinfo.getFilename());
+		}
+		status &= processContents(contents, filenames, out);
+	}
+	return status;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_notecols::initialize -- Process the command-line options.
+//
+
+bool Tool_notecols::initialize(void) {
+	m_textQ   = getBoolean("text");
+	m_threads = HumParallel::getThreadCount(getInteger("threads"));
+	m_batch   = getInteger("batch");
+	if (m_batch < 1) {
+		m_batch = 1;
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_notecols::processFiles -- Analyze the files in parallel, and
+//     then print them in order.
+//
+
+bool Tool_notecols::processFiles(HumdrumFileSet& infiles, ostream& out) {
+	int count = infiles.getCount();
+	vector<string> blocks(count);
+	HumParallel::run(count, m_threads, [&](int i) {
+		int analysisthreads = infiles[i].getAnalysisThreadCount();
+		infiles[i].setAnalysisThreadCount(1);
+		stringstream block;
+		printBlock(infiles[i], block);
+		infiles[i].setAnalysisThreadCount(analysisthreads);
+		blocks[i] = block.str();
+	});
+	for (int i=0; i<count; i++) {
+		out << blocks[i];
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_notecols::processContents -- Parse and analyze the text of the
+//     files in parallel, and then print them in order.  Parse errors are
+//     stored as warnings in the input order.
+//
+
+bool Tool_notecols::processContents(vector<string>& contents,
+		vector<string>& filenames, ostream& out) {
+	int count = (int)contents.size();
+	vector<string> blocks(count);
+	vector<string> errors(count);
+	HumParallel::run(count, m_threads, [&](int i) {
+		HumdrumFile infile;
+		// The files are already parsed in parallel, so do not also
+		// analyze the tracks of each file in parallel.
+		infile.setAnalysisThreadCount(1);
+		infile.setQuietParsing();
+		stringstream input(contents[i]);
+		contents[i].clear();
+		infile.read(input);
+		if (!filenames[i].empty()) {
+			infile.setFilename(filenames[i]);
+		}
+		errors[i] = infile.getParseError();
+		stringstream block;
+		printBlock(infile, block);
+		blocks[i] = block.str();
+	});
+	for (int i=0; i<count; i++) {
+		if (!errors[i].empty()) {
+			m_warning_text << errors[i] << endl;
+		}
+		out << blocks[i];
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_notecols::printHeader -- Print the column descriptions (only
+//     once for each tool object).
+//
+
+void Tool_notecols::printHeader(ostream& out) {
+	if (m_headerQ) {
+		return;
+	}
+	m_headerQ = true;
+
+	if (m_textQ) {
+		out << "file\tonset\tduration\tmidi\tb40\ttrack\tlayer\tmeasure\tmetlev\n";
+		return;
+	}
+
+	vector<pair<char, string>> columns = {
+		{ 'd', "onset"    },
+		{ 'd', "duration" },
+		{ 'h', "midi"     },
+		{ 'h', "b40"      },
+		{ 'h', "track"    },
+		{ 'h', "layer"    },
+		{ 'i', "measure"  },
+		{ 'f', "metlev"   }
+	};
+	string buffer = "HUMNOTES";
+	appendLittleEndian(buffer, 1, 2);
+	appendLittleEndian(buffer, columns.size(), 2);
+	for (int i=0; i<(int)columns.size(); i++) {
+		buffer += columns[i].first;
+		buffer += (char)columns[i].second.size();
+		buffer += columns[i].second;
+	}
+	out.write(buffer.data(), buffer.size());
+}
+
+
+
+//////////////////////////////
+//
+// Tool_notecols::printBlock -- Print the notes of a file.  This function
+//     only uses the file and the tool options, so it can be called for
+//     different files at the same time.
+//
+
+void Tool_notecols::printBlock(HumdrumFile& infile, ostream& out) {
+	NoteColumns columns;
+	fillColumns(infile, columns);
+	if (m_textQ) {
+		printTextBlock(infile.getFilename(), columns, out);
+	} else {
+		printBinaryBlock(infile.getFilename(), columns, out);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// Tool_notecols::fillColumns -- Extract the note attacks in a file.
+//
+
+void Tool_notecols::fillColumns(HumdrumFile& infile, NoteColumns& columns) {
+	columns.clear();
+	if (!infile.isRhythmAnalyzed()) {
+		infile.analyzeRhythmStructure();
+	}
+	vector<double> metlevs;
+	infile.getMetricLevels(metlevs);
+
+	vector<string> pitches;
+	int measure = 0;
+	for (int i=0; i<infile.getLineCount(); i++) {
+		if (infile[i].isBarline()) {
+			int number = infile.getMeasureNumber(i);
+			if (number >= 0) {
+				measure = number;
+			}
+			continue;
+		}
+		if (!infile[i].isData()) {
+			continue;
+		}
+		for (int j=0; j<infile[i].getFieldCount(); j++) {
+			HTp token = infile.token(i, j);
+			if (!token->isKern()) {
+				continue;
+			}
+			if (token->isNull() || token->isRest() || token->isSecondaryTiedNote()) {
+				continue;
+			}
+			double onset = token->getDurationFromStart().getFloat();
+			double duration = token->getTiedDuration().getFloat();
+			int scount = token->getSubtokenCount();
+			for (int k=0; k<scount; k++) {
+				string subtok = (scount == 1) ? (string)*token : token->getSubtoken(k);
+				if (subtok.find('r') != string::npos) {
+					continue;
+				}
+				if ((scount > 1) && ((subtok.find('_') != string::npos) ||
+						(subtok.find(']') != string::npos))) {
+					// secondary tied note in a chord
+					continue;
+				}
+				pitches.push_back(subtok);
+				columns.onset.push_back(onset);
+				columns.duration.push_back(duration);
+				columns.track.push_back((int16_t)token->getTrack());
+				columns.layer.push_back((int16_t)(token->getSubtrack() > 0 ? token->getSubtrack() : 1));
+				columns.measure.push_back(measure);
+				columns.metlev.push_back((float)metlevs[i]);
+			}
+		}
+	}
+
+	vector<int> b40;
+	vector<int> midi;
+	Convert::kernToPitchNumbers(pitches, &b40, NULL, NULL, &midi);
+	columns.b40.assign(b40.begin(), b40.end());
+	columns.midi.assign(midi.begin(), midi.end());
+}
+
+
+
+//////////////////////////////
+//
+// Tool_notecols::printBinaryBlock -- Print the notes of a file in the
+//     binary format described at the top of this file.
+//
+
+void Tool_notecols::printBinaryBlock(const string& filename,
+		NoteColumns& columns, ostream& out) {
+	int rows = columns.getRowCount();
+	string buffer;
+	buffer.reserve(filename.size() + 12 + rows * 32);
+	appendLittleEndian(buffer, filename.size(), 4);
+	buffer += filename;
+	appendLittleEndian(buffer, rows, 8);
+
+	uint64_t bits64;
+	uint32_t bits32;
+	for (int i=0; i<rows; i++) {
+		memcpy(&bits64, &columns.onset[i], sizeof(bits64));
+		appendLittleEndian(buffer, bits64, 8);
+	}
+	for (int i=0; i<rows; i++) {
+		memcpy(&bits64, &columns.duration[i], sizeof(bits64));
+		appendLittleEndian(buffer, bits64, 8);
+	}
+	for (int i=0; i<rows; i++) {
+		appendLittleEndian(buffer, (uint16_t)columns.midi[i], 2);
+	}
+	for (int i=0; i<rows; i++) {
+		appendLittleEndian(buffer, (uint16_t)columns.b40[i], 2);
+	}
+	for (int i=0; i<rows; i++) {
+		appendLittleEndian(buffer, (uint16_t)columns.track[i], 2);
+	}
+	for (int i=0; i<rows; i++) {
+		appendLittleEndian(buffer, (uint16_t)columns.layer[i], 2);
+	}
+	for (int i=0; i<rows; i++) {
+		appendLittleEndian(buffer, (uint32_t)columns.measure[i], 4);
+	}
+	for (int i=0; i<rows; i++) {
+		memcpy(&bits32, &columns.metlev[i], sizeof(bits32));
+		appendLittleEndian(buffer, bits32, 4);
+	}
+	out.write(buffer.data(), buffer.size());
+}
+
+
+
+//////////////////////////////
+//
+// Tool_notecols::printTextBlock -- Print the notes of a file with one
+//     line for each row.
+//
+
+void Tool_notecols::printTextBlock(const string& filename,
+		NoteColumns& columns, ostream& out) {
+	for (int i=0; i<columns.getRowCount(); i++) {
+		out << filename;
+		out << '\t' << columns.onset[i];
+		out << '\t' << columns.duration[i];
+		out << '\t' << columns.midi[i];
+		out << '\t' << columns.b40[i];
+		out << '\t' << columns.track[i];
+		out << '\t' << columns.layer[i];
+		out << '\t' << columns.measure[i];
+		out << '\t' << columns.metlev[i];
+		out << '\n';
+	}
+}
+
+
+
+//////////////////////////////
+//
+// Tool_notecols::appendLittleEndian -- Add an integer to the buffer with
+//     the lowest byte first.
+//
+
+void Tool_notecols::appendLittleEndian(string& buffer, uint64_t value,
+		int bytecount) {
+	for (int i=0; i<bytecount; i++) {
+		buffer += (char)(value & 0xff);
+		value >>= 8;
+	}
+}
+
+
+
+
+
 
 /////////////////////////////////
 //
@@ -57922,20 +64468,74 @@ bool Tool_pnum::run(HumdrumFile& infile, ostream& out) {
 
 
 bool Tool_pnum::run(HumdrumFile& infile) {
-   initialize(infile);
+	initialize();
 	processFile(infile);
 	infile.createLinesFromTokens();
 	return true;
 }
 
 
+//
+// Line-at-a-time interface: each line is converted and printed before
+// the next line is read.
+//
+
+bool Tool_pnum::run(HumdrumLineStream& instream) {
+	initialize();
+	vector<HTp> notes;
+	HLp line;
+	while ((line = instream.getLine())) {
+		if (line->hasSpines()) {
+			notes.clear();
+			for (int j=0; j<line->getFieldCount(); j++) {
+				if (instream.getDataType(j) != "**kern") {
+					continue;
+				}
+				HTp token = line->token(j);
+				if (*token == "**kern") {
+					token->setText(m_exinterp);
+					continue;
+				}
+				if (!token->isData()) {
+					continue;
+				}
+				if (token->isNull()) {
+					continue;
+				}
+				notes.push_back(token);
+			}
+			convertTokensToBase(notes);
+		}
+		line->createLineFromTokens();
+		m_humdrum_text << line << '\n';
+	}
+	if (instream.hasError()) {
+		m_error_text << instream.getError();
+		return false;
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_pnum::isLineStreamable -- The conversion only needs the current
+//    line, so the input can always be processed one line at a time.
+//
+
+bool Tool_pnum::isLineStreamable(void) {
+	return true;
+}
+
+
 
 //////////////////////////////
 //
 // Tool_pnum::initialize --
 //
 
-void Tool_pnum::initialize(HumdrumFile& infile) {
+void Tool_pnum::initialize(void) {
 	m_midiQ = false;
 	if (getString("base") == "midi") {
 		m_base = 12;
@@ -57951,6 +64551,12 @@ void Tool_pnum::initialize(HumdrumFile& infile) {
 	m_attacksQ  =  getBoolean("attacks-only");
 	m_rest      =  getString("rest");
 	m_restQ     = !getBoolean("no-rests");
+
+	if (m_midiQ) {
+		m_exinterp = "**pmid";
+	} else {
+		m_exinterp = "**b" + to_string(m_base);
+	}
 }
 
 
@@ -57962,6 +64568,7 @@ void Tool_pnum::initialize(HumdrumFile& infile) {
 
 void Tool_pnum::processFile(HumdrumFile& infile) {
 	vector<HTp> kex;
+	vector<HTp> notes;
 
 	for (int i=0; i<infile.getLineCount(); i++) {
 		if (!infile[i].hasSpines()) {
@@ -57982,18 +64589,13 @@ void Tool_pnum::processFile(HumdrumFile& infile) {
 			if (token->isNull()) {
 				continue;
 			}
-			convertTokenToBase(token);
+			notes.push_back(token);
 		}
 	}
+	convertTokensToBase(notes);
 
-	string newex;
 	for (int i=0; i<(int)kex.size(); i++) {
-		if (m_midiQ) {
-			newex = "**pmid";
-		} else {
-			newex = "**b" + to_string(m_base);
-		}
-		kex[i]->setText(newex);
+		kex[i]->setText(m_exinterp);
 	}
 }
 
@@ -58001,44 +64603,69 @@ void Tool_pnum::processFile(HumdrumFile& infile) {
 
 //////////////////////////////
 //
-// Tool_pnum::convertTokenToBase --
+// Tool_pnum::convertTokensToBase -- Convert the pitches of all
+//     subtokens in a list of tokens at once, then replace the text
+//     of each token.
 //
 
-void Tool_pnum::convertTokenToBase(HTp token) {
+void Tool_pnum::convertTokensToBase(vector<HTp>& tokens) {
+	vector<string> subtokens;
+	vector<int> counts(tokens.size(), 0);
+	for (int i=0; i<(int)tokens.size(); i++) {
+		const string& text = *tokens[i];
+		string::size_type start = 0;
+		while (true) {
+			string::size_type loc = text.find(' ', start);
+			subtokens.push_back(text.substr(start, loc - start));
+			counts[i]++;
+			if (loc == string::npos) {
+				break;
+			}
+			start = loc + 1;
+		}
+	}
+
+	vector<int> pitches;
+	switch (m_base) {
+		case 7:
+			Convert::kernToBase7(subtokens, pitches);
+			break;
+		case 40:
+			Convert::kernToBase40(subtokens, pitches);
+			break;
+		default:
+			Convert::kernToBase12(subtokens, pitches);
+	}
+
+	int index = 0;
 	string output;
-	int scount = token->getSubtokenCount();
-	for (int i=0; i<scount; i++) {
-		string subtok = token->getSubtoken(i);
-		output += convertSubtokenToBase(subtok);
-		if (i < scount - 1) {
-			output += " ";
+	for (int i=0; i<(int)tokens.size(); i++) {
+		output.clear();
+		for (int j=0; j<counts[i]; j++) {
+			output += convertSubtokenToBase(subtokens[index], pitches[index]);
+			index++;
+			if (j < counts[i] - 1) {
+				output += " ";
+			}
 		}
+		tokens[i]->setText(output);
 	}
-	token->setText(output);
 }
 
 
 
 //////////////////////////////
 //
-// Tool_pnum::convertSubtokenToBase --
+// Tool_pnum::convertSubtokenToBase -- The pitch is the base-7, base-12
+//     or base-40 value of the subtoken.
 //
 
-string Tool_pnum::convertSubtokenToBase(const string& text) {
-	int pitch = 0;
-	if (text.find("r") == string::npos) {
-		switch (m_base) {
-			case 7:
-				pitch = Convert::kernToBase7(text);
-				break;
-			case 40:
-				pitch = Convert::kernToBase40(text);
-				break;
-			default:
-				pitch = Convert::kernToBase12(text);
+string Tool_pnum::convertSubtokenToBase(const string& text, int pitch) {
+	if (text.find("r") != string::npos) {
+		if (!m_restQ) {
+			return ".";
 		}
-	} else if (!m_restQ) {
-		return ".";
+		pitch = 0;
 	}
 	string recip;
 	if (m_durationQ) {
@@ -58152,7 +64779,8 @@ bool Tool_recip::run(HumdrumFile& infile, ostream& out) {
 
 
 bool Tool_recip::run(HumdrumFile& infile) {
-   initialize(infile);
+	initialize();
+	m_kernspines = infile.getKernSpineStartList();
 
 	int lineCount = infile.getLineCount();
 	if (lineCount == 0) {
@@ -58180,6 +64808,51 @@ bool Tool_recip::run(HumdrumFile& infile) {
 }
 
 
+//
+// Line-at-a-time interface: each line is converted and printed before
+// the next line is read.
+//
+
+bool Tool_recip::run(HumdrumLineStream& instream) {
+	initialize();
+	bool replaceQ = getBoolean("replace");
+	HumRegex hre;
+	HLp line;
+	while ((line = instream.getLine())) {
+		if (line->hasSpines()) {
+			if (replaceQ) {
+				replaceKernWithRecip(*line, instream, hre);
+			} else {
+				insertAnalysisSpines(*line, instream, hre);
+			}
+		}
+		line->createLineFromTokens();
+		m_humdrum_text << line << '\n';
+	}
+	if (instream.hasError()) {
+		m_error_text << instream.getError();
+		return false;
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_recip::isLineStreamable -- The composite analysis needs the
+//    durations of the lines, so only the spine replacement and insertion
+//    modes can process the input one line at a time.
+//
+
+bool Tool_recip::isLineStreamable(void) {
+	if (getBoolean("composite") || getBoolean("append") || getBoolean("prepend")) {
+		return false;
+	}
+	return true;
+}
+
+
 
 //////////////////////////////
 //
@@ -58215,6 +64888,50 @@ void Tool_recip::insertAnalysisSpines(HumdrumFile& infile, HumdrumFile& cfile) {
 }
 
 
+//
+// Line-at-a-time version: a **recip spine is inserted after the
+// last field of each **kern track on the line.
+//
+
+void Tool_recip::insertAnalysisSpines(HumdrumLine& line,
+		HumdrumLineStream& instream, HumRegex& hre) {
+	int fcount = line.getFieldCount();
+	vector<string> recips(fcount);
+	vector<int> lastfield(instream.getMaxTrack() + 1, -1);
+	for (int j=0; j<fcount; j++) {
+		if (instream.getDataType(j) != "**kern") {
+			continue;
+		}
+		HTp token = line.token(j);
+		recips[j] = getRecipText(token, hre);
+		int track = token->getTrack();
+		if ((track >= 0) && (track < (int)lastfield.size())) {
+			lastfield[track] = j;
+		}
+	}
+	// Insert from right to left so that the indexes of the fields which
+	// are still to be processed do not change:
+	for (int j=fcount-1; j>=0; j--) {
+		if (instream.getDataType(j) != "**kern") {
+			continue;
+		}
+		int track = line.token(j)->getTrack();
+		if ((track < 0) || (track >= (int)lastfield.size()) || (lastfield[track] != j)) {
+			continue;
+		}
+		for (int k=j; k>=0; k--) {
+			if (instream.getDataType(k) != "**kern") {
+				continue;
+			}
+			if (line.token(k)->getTrack() != track) {
+				continue;
+			}
+			line.appendToken(j, recips[k]);
+		}
+	}
+}
+
+
 
 //////////////////////////////
 //
@@ -58257,9 +64974,10 @@ void Tool_recip::doCompositeAnalysis(HumdrumFile& infile) {
 		return;
 	} else {
 		infile.prependDataSpine(recips, "", m_exinterp);
-		infile.printFieldIndex(0, m_humdrum_text);
+		stringstream analysis;
+		infile.printFieldIndex(0, analysis);
 		infile.clear();
-		infile.readString(m_humdrum_text.str());
+		infile.readString(analysis.str());
 	}
 }
 
@@ -58297,7 +65015,9 @@ void Tool_recip::replaceKernWithRecip(HumdrumFile& infile) {
 					tok->setText(".");
 				}
 			} else {
-				hre.replaceDestructive(*tok, "", expression, "g");
+				string text = *tok;
+				hre.replaceDestructive(text, "", expression, "g");
+				tok->setText(text);
 			}
 			tok = tok->getNextToken();
 		}
@@ -58310,6 +65030,49 @@ void Tool_recip::replaceKernWithRecip(HumdrumFile& infile) {
 }
 
 
+//
+// Line-at-a-time version: **kern tokens on the line are replaced
+// by their **recip equivalents.
+//
+
+void Tool_recip::replaceKernWithRecip(HumdrumLine& line,
+		HumdrumLineStream& instream, HumRegex& hre) {
+	for (int j=0; j<line.getFieldCount(); j++) {
+		if (instream.getDataType(j) != "**kern") {
+			continue;
+		}
+		HTp token = line.token(j);
+		token->setText(getRecipText(token, hre));
+	}
+}
+
+
+
+//////////////////////////////
+//
+// Tool_recip::getRecipText -- Return the **recip version of a **kern
+//     token (see replaceKernWithRecip()).
+//
+
+string Tool_recip::getRecipText(HTp token, HumRegex& hre) {
+	if (*token == "**kern") {
+		return m_exinterp;
+	}
+	if (!token->isData()) {
+		return *token;
+	}
+	if (token->isNull()) {
+		return *token;
+	}
+	if (token->find('q') != string::npos) {
+		return m_graceQ ? "q" : ".";
+	}
+	string output = *token;
+	hre.replaceDestructive(output, "", "[^q\\d.%\\]\\[]+", "g");
+	return output;
+}
+
+
 
 
 //////////////////////////////
@@ -58317,8 +65080,7 @@ void Tool_recip::replaceKernWithRecip(HumdrumFile& infile) {
 // Tool_recip::initialize --
 //
 
-void Tool_recip::initialize(HumdrumFile& infile) {
-	m_kernspines = infile.getKernSpineStartList();
+void Tool_recip::initialize(void) {
 	m_graceQ = !getBoolean("ignore-grace-notes");
 
 	m_exinterp = getString("exinterp");
@@ -60435,20 +67197,52 @@ bool Tool_spinetrace::run(HumdrumFile& infile, ostream& out) {
 
 
 bool Tool_spinetrace::run(HumdrumFile& infile) {
-   initialize(infile);
+	initialize();
 	processFile(infile);
 	return true;
 }
 
 
+//
+// Line-at-a-time interface: the analysis only needs the spine info of the
+// current line, so the input is not stored.
+//
+
+bool Tool_spinetrace::run(HumdrumLineStream& instream) {
+	initialize();
+	HLp line;
+	while ((line = instream.getLine())) {
+		processLine(*line);
+	}
+	if (instream.hasError()) {
+		m_error_text << instream.getError();
+		return false;
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_spinetrace::isLineStreamable -- The input can always be processed
+//    one line at a time.
+//
+
+bool Tool_spinetrace::isLineStreamable(void) {
+	return true;
+}
+
+
 
 //////////////////////////////
 //
 // Tool_spinetrace::initialize --
 //
 
-void Tool_spinetrace::initialize(HumdrumFile& infile) {
-	// do nothing for now
+void Tool_spinetrace::initialize(void) {
+	m_appendQ  = getBoolean("append");
+	m_prependQ = getBoolean("prepend");
 }
 
 
@@ -60459,51 +67253,59 @@ void Tool_spinetrace::initialize(HumdrumFile& infile) {
 //
 
 void Tool_spinetrace::processFile(HumdrumFile& infile) {
-	bool appendQ = getBoolean("append");
-	bool prependQ = getBoolean("prepend");
-
 	int linecount = infile.getLineCount();
 	for (int i=0; i<linecount; i++) {
-		if (!infile[i].hasSpines()) {
-			m_humdrum_text << infile[i] << endl;
-			continue;
-		}
-		if (appendQ) {
-			m_humdrum_text << infile[i] << "\t";
-		}
+		processLine(infile[i]);
+	}
+}
 
-		if (!infile[i].isData()) {
-			if (infile[i].isInterpretation()) {
-				int fieldcount = infile[i].getFieldCount();
-				for (int j=0; j<fieldcount; j++) {
-					HTp token = infile.token(i, j);
-					if (token->compare(0, 2, "**") == 0) {
-						m_humdrum_text << "**spine";
-					} else {
-						m_humdrum_text << token;
-					}
-					if (j < fieldcount - 1) {
-						m_humdrum_text << "\t";
-					}
-				}
-			} else {
-				m_humdrum_text << infile[i];
-			}
-		} else {
-			int fieldcount = infile[i].getFieldCount();
+
+
+//////////////////////////////
+//
+// Tool_spinetrace::processLine --
+//
+
+void Tool_spinetrace::processLine(HumdrumLine& line) {
+	if (!line.hasSpines()) {
+		m_humdrum_text << line << endl;
+		return;
+	}
+	if (m_appendQ) {
+		m_humdrum_text << line << "\t";
+	}
+
+	if (!line.isData()) {
+		if (line.isInterpretation()) {
+			int fieldcount = line.getFieldCount();
 			for (int j=0; j<fieldcount; j++) {
-				m_humdrum_text << infile[i].token(j)->getSpineInfo();
+				HTp token = line.token(j);
+				if (token->compare(0, 2, "**") == 0) {
+					m_humdrum_text << "**spine";
+				} else {
+					m_humdrum_text << token;
+				}
 				if (j < fieldcount - 1) {
-					m_humdrum_text << '\t';
+					m_humdrum_text << "\t";
 				}
 			}
+		} else {
+			m_humdrum_text << line;
+		}
+	} else {
+		int fieldcount = line.getFieldCount();
+		for (int j=0; j<fieldcount; j++) {
+			m_humdrum_text << line.token(j)->getSpineInfo();
+			if (j < fieldcount - 1) {
+				m_humdrum_text << '\t';
+			}
 		}
+	}
 
-		if (prependQ) {
-			m_humdrum_text << "\t" << infile[i];
-		}
-		m_humdrum_text << "\n";
+	if (m_prependQ) {
+		m_humdrum_text << "\t" << line;
 	}
+	m_humdrum_text << "\n";
 }
 
 
@@ -60555,6 +67357,37 @@ bool Tool_tabber::run(HumdrumFile& infile) {
 }
 
 
+//
+// Line-at-a-time interface for removing tabs (see isLineStreamable()).
+//
+
+bool Tool_tabber::run(HumdrumLineStream& instream) {
+	HLp line;
+	while ((line = instream.getLine())) {
+		line->removeExtraTabs();
+		line->createLineFromTokens();
+		m_humdrum_text << line << '\n';
+	}
+	if (instream.hasError()) {
+		m_error_text << instream.getError();
+		return false;
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_tabber::isLineStreamable -- Extra tabs can be removed one line
+//    at a time, but adding tabs needs the track widths of the entire file.
+//
+
+bool Tool_tabber::isLineStreamable(void) {
+	return getBoolean("remove");
+}
+
+
 
 //////////////////////////////
 //
@@ -61467,6 +68300,7 @@ Tool_transpose::Tool_transpose(void) {
 	define("t|transpose=s",   "musical interval transposition value");
 	define("k|settonic=s",    "transpose to the given key/tonic (mode will not change)");
 	define("auto=b",          "auto. trans. inst. parts to concert pitch");
+	define("profile=s:kostka-payne", "key profiles for --auto: kostka-payne, krumhansl-kessler or aarden-essen");
 	define("debug=b",         "print debugging statements");
 	define("s|spines=s:",     "transpose only specified spines");
 	// quiet reversed with -T option (actively need to request transposition code now)
@@ -62467,15 +69301,9 @@ void Tool_transpose::usage(const string& command) {
 
 void Tool_transpose::doAutoTransposeAnalysis(HumdrumFile& infile) {
 	vector<int> ktracks(infile.getMaxTrack()+1, 0);
-
-	vector<HTp> tracks;
-	infile.getTrackStartList(tracks);
-	int i;
-	for (i=0; i<(int)tracks.size(); i++) {
-		if (tracks[i]->isKern()) {
-			ktracks[i] = tracks[i]->getTrack();
-		} else {
-			ktracks[i] = 0;
+	for (int t=1; t<=infile.getMaxTrack(); t++) {
+		if (infile.getTrackStart(t)->isKern()) {
+			ktracks[t] = t;
 		}
 	}
 
@@ -62485,13 +69313,7 @@ void Tool_transpose::doAutoTransposeAnalysis(HumdrumFile& infile) {
 	}
 
 	vector<vector<vector<double> > > trackhist;
-	trackhist.resize(ktracks.size());
-
-	for (i=1; i<(int)trackhist.size(); i++) {
-		if (ktracks[i]) {
-			storeHistogramForTrack(trackhist[i], infile, i, segments);
-		}
-	}
+	HumKeyFinder::getTrackHistograms(infile, segments, trackhist);
 
 	if (debugQ) {
 		m_free_text << "Segment pitch histograms: " << endl;
@@ -62544,8 +69366,8 @@ void Tool_transpose::doTranspositionAnalysis(vector<vector<vector<double> > >& a
 	int value;
 
 	for (i=0; i<1; i++) {
-		for (j=2; j<3; j++) {
-			for (k=0; k<(int)analysis[i].size(); k++) {
+		for (j=2; j<3 && j<(int)analysis.size(); j++) {
+			for (k=0; k<(int)analysis[i].size() && k<(int)analysis[j].size(); k++) {
 				if (analysis[i][k][24] >= 0 && analysis[j][k][24] >= 0) {
 					value1 = (int)analysis[i][k][25];
 	 				if (value1 >= 12) {
@@ -62581,24 +69403,22 @@ void Tool_transpose::printRawTrackAnalysis(vector<vector<vector<double> > >& ana
 
 	int i, j;
 	int value;
-	int value2;
 
+	if (analysis.empty()) {
+		return;
+	}
 	for (i=0; i<(int)analysis[0].size(); i++) {
 		m_free_text << "Frame\t" << i << ":";
 		for (j=0; j<(int)analysis.size(); j++) {
 			m_free_text << "\t";
+			if (i >= (int)analysis[j].size()) {
+				continue;
+			}
 	 		value = (int)analysis[j][i][24];
 	 		if (value >= 12) {
 				value = value - 12;
 			}
-	 		value2 = (int)analysis[j][i][25];
-	 		if (value2 >= 12) {
-				value2 = value2 - 12;
-			}
 			m_free_text << value;
-	 		// if (value != value2) {
-	 		//    m_free_text << "," << value2;
-			// }
 		}
 		m_free_text << "\n";
 	}
@@ -62608,237 +69428,46 @@ void Tool_transpose::printRawTrackAnalysis(vector<vector<vector<double> > >& ana
 
 //////////////////////////////
 //
-// doAutoKeyAnalysis --
+// doAutoKeyAnalysis -- Key analysis of windows of level segments,
+//     starting every hop segments, in each **kern track.
 //
 
 void Tool_transpose::doAutoKeyAnalysis(vector<vector<vector<double> > >& analysis, int level,
 		int hop, int count, int segments, vector<int>& ktracks,
 		vector<vector<vector<double> > >& trackhist) {
 
-	vector<double> majorweights;
-	vector<double> minorweights;
-	fillWeightsWithKostkaPayne(majorweights, minorweights);
-
-	int size = 0;
-	int i;
-	for (i=1; i<(int)ktracks.size(); i++) {
-		if (ktracks[i]) {
-			size++;
-		}
-	}
-
-	analysis.resize(size);
-	for (i=0; i<(int)analysis.size(); i++) {
-		analysis[i].reserve(count);
-	}
+	HumKeyFinder finder;
+	finder.setProfile(getString("profile"));
 
-	int aindex = 0;
-	for (i=1; i<(int)ktracks.size(); i++) {
+	analysis.clear();
+	for (int i=1; i<(int)ktracks.size(); i++) {
 		if (!ktracks[i]) {
 			continue;
 		}
-		doTrackKeyAnalysis(analysis[aindex++], level, hop, count,
-				trackhist[i], majorweights, minorweights);
+		analysis.resize(analysis.size() + 1);
+		finder.setHistograms(trackhist[i]);
+		finder.analyzeWindows(level, hop, count, analysis.back());
 	}
 }
 
 
 
-//////////////////////////////
-//
-// Tool_transpose::doTrackKeyAnalysis -- Do individual key analyses of sections of the
-//   given track.
-//
-
-void Tool_transpose::doTrackKeyAnalysis(vector<vector<double> >& analysis, int level, int hop,
-		int count, vector<vector<double> >& trackhist,
-		vector<double>& majorweights, vector<double>& minorweights) {
-
-	int i;
-	for (i=0; i<count; i++) {
-		if (i * hop + level > (int)trackhist.size()) {
-			break;
-		}
-		analysis.resize(i+1);
-		doSingleAnalysis(analysis[analysis.size()-1], i*hop+level, level,
-				trackhist, majorweights, minorweights);
-	}
-}
-
-
-
-//////////////////////////////
-//
-// Tool_transpose::doSingleAnalysis --
-//
-
-void Tool_transpose::doSingleAnalysis(vector<double>& analysis, int startindex, int length,
-		vector<vector<double> >& trackhist, vector<double>& majorweights,
-		vector<double>& minorweights) {
-	vector<double> histsum(12, 0);
-
-	for (int i=0; (i<length) && (startindex+i+length<(int)trackhist.size()); i++) {
-		for (int k=0; k<12; k++) {
-			histsum[k] += trackhist[i+startindex][k];
-		}
-	}
-
-	identifyKey(analysis, histsum, majorweights, minorweights);
-}
-
-
-
-///////////////////////////////
-//
-// Tool_transpose::fillWeightsWithKostkaPayne --
-//
-
-void Tool_transpose::fillWeightsWithKostkaPayne(vector<double>& maj, vector<double>& min) {
-	maj.resize(12);
-	min.resize(12);
-
-	// found in David Temperley: Music and Probability 2006
-	maj[0]  = 0.748;	// C major weights
-	maj[1]  = 0.060;	// C#
-	maj[2]  = 0.488;	// D
-	maj[3]  = 0.082;	// D#
-	maj[4]  = 0.670;	// E
-	maj[5]  = 0.460;	// F
-	maj[6]  = 0.096;	// F#
-	maj[7]  = 0.715;	// G
-	maj[8]  = 0.104;	// G#
-	maj[9]  = 0.366;	// A
-	maj[10] = 0.057;	// A#
-	maj[11] = 0.400;	// B
-	min[0]  = 0.712;	// c minor weights
-	min[1]  = 0.084;	// c#
-	min[2]  = 0.474;	// d
-	min[3]  = 0.618;	// d#
-	min[4]  = 0.049;	// e
-	min[5]  = 0.460;	// f
-	min[6]  = 0.105;	// f#
-	min[7]  = 0.747;	// g
-	min[8]  = 0.404;	// g#
-	min[9]  = 0.067;	// a
-	min[10] = 0.133;	// a#
-	min[11] = 0.330;	// b
-}
-
-
-
-////////////////////////////////////////
-//
-// identifyKey -- correls contains the 12 major key correlation
-//      values, then the 12 minor key correlation values, then two
-//      more values: index=24 is the best key, and index=25 is the
-//      second best key.  If [24] or [25] is -1, then that means that
-//      all entries in the original histogram were zero (all rests).
-//
-
-void Tool_transpose::identifyKey(vector<double>& correls,
-		vector<double>& histogram, vector<double>& majorweights,
-		vector<double>& minorweights) {
-
-	correls.clear();
-	correls.reserve(26);
-
-	double testsum = 0.0;
-	for (int i=0; i<12; i++) {
-		testsum += histogram[i];
-	}
-	if (testsum == 0.0) {
-		correls.resize(26);
-		fill(correls.begin(), correls.end(), -1);
-		correls[24] = -1;
-		correls[25] = -1;
-		return;
-	}
-
-	vector<double> majorcorrels;
-	vector<double> minorcorrels;
-	for (int i=0; i<12; i++) {
-		majorcorrels[i] = Convert::pearsonCorrelation(majorweights, histogram);
-		minorcorrels[i] = Convert::pearsonCorrelation(minorweights, histogram);
-	}
-
-	// find max value
-	int besti;
-	int majorbesti = 0;
-	int minorbesti = 0;
-	for (int i=1; i<12; i++) {
-		if (majorcorrels[i] > majorcorrels[majorbesti]) {
-			majorbesti = i;
-		}
-		if (minorcorrels[i] > minorcorrels[minorbesti]) {
-			minorbesti = i;
-		}
-	}
-	besti = majorbesti;
-	if (majorcorrels[majorbesti] < minorcorrels[minorbesti]) {
-		besti = minorbesti + 12;
-	}
-
-	// find second best major key
-	int majorsecondbesti = 0;
-	if (majorbesti == 0) {
-		majorsecondbesti = 1;
-	}
-	for (int i=1; i<12; i++) {
-		if (i == majorbesti) {
-			continue;
-		}
-		if (majorcorrels[i] > majorcorrels[majorsecondbesti]) {
-			majorsecondbesti = i;
-		}
-	}
-
-	// find second best minor key
-	int minorsecondbesti = 0;
-	if (minorbesti == 0) {
-		minorsecondbesti = 1;
-	}
-	for (int i=1; i<12; i++) {
-		if (i == minorbesti) {
-			continue;
-		}
-		if (minorcorrels[i] > minorcorrels[minorsecondbesti]) {
-			minorsecondbesti = i;
-		}
-	}
-
-	int secondbesti = majorsecondbesti;
-	if (majorcorrels[majorsecondbesti] < minorcorrels[minorsecondbesti]) {
-		secondbesti = minorsecondbesti;
-	}
-	secondbesti += 12;
-
-	correls = majorcorrels;
-	correls.insert(correls.end(), minorcorrels.begin(), minorcorrels.end());
-	correls.push_back(besti);
-	correls.push_back(secondbesti);
-}
-
-
-
 //////////////////////////////
 //
 // Tool_transpose::printHistograms --
 //
 
 void Tool_transpose::printHistograms(int segments, vector<int> ktracks,
-vector<vector<vector<double> > >& trackhist) {
+		vector<vector<vector<double> > >& trackhist) {
 	int i, j, k;
 	int start;
 
 	for (i=0; i<segments; i++) {
-//m_free_text << "i=" << i << endl;
 		m_free_text << "segment " << i
 				<< " ==========================================\n";
 		for (j=0; j<12; j++) {
 			start = 0;
-//m_free_text << "j=" << i << endl;
 			for (k=1; k<(int)ktracks.size(); k++) {
-//m_free_text << "k=" << i << endl;
 				if (!ktracks[k]) {
 					continue;
 				}
@@ -62849,7 +69478,7 @@ vector<vector<vector<double> > >& trackhist) {
 				m_free_text << "\t";
 				m_free_text << trackhist[k][i][j];
 			}
-	 if (start) {
+			if (start) {
 				m_free_text << "\n";
 			}
 		}
@@ -62859,115 +69488,6 @@ vector<vector<vector<double> > >& trackhist) {
 
 
 
-//////////////////////////////
-//
-// Tool_transpose::storeHistogramForTrack --
-//
-
-double Tool_transpose::storeHistogramForTrack(vector<vector<double> >& histogram,
-		HumdrumFile& infile, int track, int segments) {
-
-	histogram.clear();
-	histogram.reserve(segments);
-
-	int i;
-	int j;
-	int k;
-
-	for (i=0; i<(int)histogram.size(); i++) {
-		histogram[i].resize(12);
-		fill(histogram[i].begin(), histogram[i].end(), 0);
-	}
-
-	double totalduration = infile.getScoreDuration().getFloat();
-
-	double duration;
-	string buffer;
-	int pitch;
-	double start;
-	int tokencount;
-	for (i=0; i<infile.getLineCount(); i++) {
-		if (!infile[i].isData()) {
-			continue;
-		}
-		start = infile[i].getDurationFromStart().getFloat();
-		for (j=0; j<infile[i].getFieldCount(); j++) {
-			if (!infile.token(i, j)->isKern()) {
-				continue;
-			}
-	 		if (infile.token(i, j)->getTrack() != track) {
-				continue;
-			}
-			if (!infile.token(i, j)->isKern()) {
-				continue;
-			}
-			if (!infile.token(i, j)->isNull()) {
-				continue;
-			}
-			tokencount = infile.token(i, j)->getSubtokenCount();
-			for (k=0; k<tokencount; k++) {
-				buffer = *infile.token(j, k);
-				if (buffer == ".") {
-					continue;  // ignore illegal inline null tokens
-				}
-				pitch = Convert::kernToMidiNoteNumber(buffer);
-				if (pitch < 0) {
-					continue;  // ignore rests or strange objects
-				}
-				pitch = pitch % 12;  // convert to chromatic pitch-class
-				duration = Convert::recipToDuration(buffer).getFloat();
-				if (duration <= 0.0) {
-					continue;   // ignore grace notes and strange objects
-				}
-				addToHistogramDouble(histogram, pitch,
-						  start, duration, totalduration, segments);
-			}
-		}
-	}
-
-	return totalduration;
-}
-
-
-
-//////////////////////////////
-//
-// Tool_transpose::addToHistogramDouble -- fill the pitch histogram in the right spots.
-//
-
-void Tool_transpose::addToHistogramDouble(vector<vector<double> >& histogram, int pc,
-		double start, double dur, double tdur, int segments) {
-
-	pc = (pc + 12) % 12;
-
-	double startseg = start / tdur * segments;
-	double startfrac = startseg - (int)startseg;
-
-	double segdur = dur / tdur * segments;
-
-	if (segdur <= 1.0 - startfrac) {
-		histogram[(int)startseg][pc] += segdur;
-		return;
-	} else if (1.0 - startfrac > 0.0) {
-		histogram[(int)startseg][pc] += (1.0 - startfrac);
-		segdur -= (1.0 - startfrac);
-	}
-
-	int i = (int)(startseg + 1);
-	while (segdur > 0.0 && i < (int)histogram.size()) {
-		if (segdur < 1.0) {
-			histogram[i][pc] += segdur;
-			segdur = 0.0;
-		} else {
-			histogram[i][pc] += 1.0;
-			segdur -= 1.0;
-		}
-		i++;
-	}
-}
-
-
-
 //////////////////////////////
 //
 // Tool_transpose::initialize --
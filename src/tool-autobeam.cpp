@@ -2,6 +2,7 @@
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Wed Nov 30 01:02:57 PST 2016
 // Last Modified: Sun May 21 21:11:12 CEST 2017 Ignore non-kern spines when adding beams
+// Last Modified: Mon Oct 19 00:41:30 PDT 2026 Use setText() to remove beams
 // Filename:      tool-autobeam.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/tool-autobeam.cpp
 // Syntax:        C++11; humlib
@@ -144,7 +145,7 @@ void Tool_autobeam::removeBeams(HumdrumFile& infile) {
 			}
 			if (bfound) {
 				((string)(*token))[0] = 'X';
-				token->swap(newstr);
+				token->setText(newstr);
 			}
 			token = token->getNextToken();
 		}
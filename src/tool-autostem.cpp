@@ -2,6 +2,7 @@
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sun Dec 26 03:28:25 PST 2010
 // Last Modified: Sun Dec  4 16:15:36 PST 2016 Ported from humextras
+// Last Modified: Sun Oct 18 17:24:10 PDT 2026 Store results in analysis columns
 // Filename:      tool-autostem.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/tool-autostem.cpp
 // Syntax:        C++11; humlib
@@ -44,6 +45,7 @@ Tool_autostem::Tool_autostem(void) {
 	define("u|up=b",          "Middle note on staff has stem up");
 	define("p|pos=b",         "Display only note vertical positions on staves");
 	define("v|voice=b",       "Display only voice/layer information");
+	define("csv=b",           "Print -p or -v analysis as CSV data");
 	define("author=b",        "Program author");
 	define("version=b",       "Program version");
 	define("example=b",       "Program examples");
@@ -105,6 +107,13 @@ bool Tool_autostem::run(HumdrumFile& infile) {
 		}
 	}
 	autostem(infile);
+	if (getBoolean("csv")) {
+		if (infile.getAnalysisColumnCount() > 0) {
+			infile.printAnalysisCsv(m_free_text);
+		}
+	} else {
+		infile.renderAnalysisColumns();
+	}
 	// Re-load the text for each line from their tokens.
 	infile.createLinesFromTokens();
 	return true;
@@ -619,7 +628,7 @@ void Tool_autostem::printVoiceInfo(HumdrumFile& infile,
 			voiceinfo[i].pop_back();
 		}
 	}
-	infile.appendDataSpine(voiceinfo, "", "**voice");
+	infile.addAnalysisColumn(voiceinfo, "", "**voice");
 }
 
 
@@ -673,7 +682,7 @@ void Tool_autostem::printNotePositions(HumdrumFile& infile,
 			}
 		}
 	}
-	infile.appendDataSpine(posinfo, "", "**vpos");
+	infile.addAnalysisColumn(posinfo, "", "**vpos");
 }
 
 
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sun Mar  4 21:09:10 PST 2018
-// Last Modified: Sun Mar  4 21:09:13 PST 2018
+// Last Modified: Sun Oct 18 21:24:02 PDT 2026 Batch pitch conversion
 // Filename:      tool-binroll.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/tool-binroll.cpp
 // Syntax:        C++11; humlib
@@ -14,6 +14,8 @@
 #include "Convert.h"
 #include "HumRegex.h"
 
+#include <fstream>
+
 using namespace std;
 
 namespace hum {
@@ -29,6 +31,8 @@ namespace hum {
 Tool_binroll::Tool_binroll(void) {
 	// add options here
 	define("t|timebase=s:16", "timebase to do analysis at");
+	define("f|format=s:text", "output format: text, bits (raw bitplanes) or npy");
+	define("shard=s", "write rolls of all input files to one file; print index of file offsets");
 }
 
 
@@ -71,8 +75,86 @@ bool Tool_binroll::run(HumdrumFile& infile, ostream& out) {
 
 
 bool Tool_binroll::run(HumdrumFile& infile) {
-	m_duration.setValue(1, 4); // 16th note
-	processFile(infile);
+	if (!initialize()) {
+		return false;
+	}
+	processFile(infile, m_free_text);
+	return true;
+}
+
+
+//
+// Streaming interface: each file is read, analyzed and printed directly
+// to the output stream before the next file is read, so the output is
+// not stored in memory.  If the --shard option is given, the rolls for
+// all files are written to a single file, and a list of the files with
+// the index of their first time slice and the slice count is printed.
+//
+
+bool Tool_binroll::run(HumdrumFileStream& instream, ostream& out) {
+	if (!initialize()) {
+		return false;
+	}
+	if (!getBoolean("shard")) {
+		while (true) {
+			HumdrumFile infile;
+			if (!instream.getFile(infile)) {
+				break;
+			}
+			processFile(infile, out);
+		}
+		return true;
+	}
+
+	string filename = getString("shard");
+	ofstream shard(filename, ios::binary);
+	if (!shard.is_open()) {
+		m_error_text << "Error: cannot write shard file " << filename << endl;
+		return false;
+	}
+	if (m_format == "npy") {
+		// Shape is not known yet, so store a placeholder header which
+		// is rewritten at the end.
+		printNpyHeader(shard, 0);
+	}
+
+	int64_t offset = 0;
+	while (true) {
+		HumdrumFile infile;
+		if (!instream.getFile(infile)) {
+			break;
+		}
+		fillRoll(infile);
+		printRollData(shard);
+		out << infile.getFilename() << '\t' << offset << '\t' << m_slicecount << '\n';
+		offset += m_slicecount;
+	}
+
+	if (m_format == "npy") {
+		shard.seekp(0);
+		printNpyHeader(shard, offset);
+	}
+	shard.close();
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_binroll::initialize -- Process the command-line options.
+//
+
+bool Tool_binroll::initialize(void) {
+	m_duration = Convert::recipToDuration(getString("timebase"));
+	if (m_duration <= 0) {
+		m_duration.setValue(1, 4); // 16th note
+	}
+	m_format = getString("format");
+	if ((m_format != "text") && (m_format != "bits") && (m_format != "npy")) {
+		m_error_text << "Error: unknown output format " << m_format << endl;
+		return false;
+	}
 	return true;
 }
 
@@ -83,14 +165,27 @@ bool Tool_binroll::run(HumdrumFile& infile) {
 // Tool_binroll::processFile --
 //
 
-void Tool_binroll::processFile(HumdrumFile& infile) {
-	vector<vector<char>> output;
-	output.resize(128);
-	int count = (infile.getScoreDuration() / m_duration).getInteger() + 1;
-	for (int i=0; i<(int)output.size(); i++) {
-		output[i].resize(count);
-		std::fill(output[i].begin(), output[i].end(), 0);
+void Tool_binroll::processFile(HumdrumFile& infile, ostream& out) {
+	fillRoll(infile);
+	if (m_format == "text") {
+		printAnalysis(infile, out);
+	} else {
+		printRoll(out);
 	}
+}
+
+
+
+//////////////////////////////
+//
+// Tool_binroll::fillRoll -- Calculate the piano roll for all **kern
+//     strands in the file.
+//
+
+void Tool_binroll::fillRoll(HumdrumFile& infile) {
+	m_slicecount = (infile.getScoreDuration() / m_duration).getInteger() + 1;
+	m_sounding.assign(m_slicecount * 2, 0);
+	m_attacks.assign(m_slicecount * 2, 0);
 
 	int strandcount = infile.getStrandCount();
 	for (int i=0; i<strandcount; i++) {
@@ -99,28 +194,182 @@ void Tool_binroll::processFile(HumdrumFile& infile) {
 			continue;
 		}
 		HTp ending = infile.getStrandEnd(i);
-		processStrand(output, starting, ending);
+		processStrand(starting, ending);
 	}
+}
+
+
 
-	printAnalysis(infile, output);
+//////////////////////////////
+//
+// Tool_binroll::setCell -- Set a cell in the piano roll: 0 = off,
+//     1 = sustained note, 2 = note attack.
+//
 
+void Tool_binroll::setCell(int pitch, int index, int value) {
+	if ((index < 0) || (index >= m_slicecount)) {
+		return;
+	}
+	int word = index * 2 + (pitch >> 6);
+	uint64_t bit = (uint64_t)1 << (pitch & 0x3f);
+	if (value) {
+		m_sounding[word] |= bit;
+	} else {
+		m_sounding[word] &= ~bit;
+	}
+	if (value == 2) {
+		m_attacks[word] |= bit;
+	} else {
+		m_attacks[word] &= ~bit;
+	}
 }
 
 
 
 //////////////////////////////
 //
-// Tool_binroll::printAnalysis --
+// Tool_binroll::getCell -- Return the value of a cell in the piano roll:
+//     0 = off, 1 = sustained note, 2 = note attack.
 //
 
-void Tool_binroll::printAnalysis(HumdrumFile& infile,
-		vector<vector<char>>& roll) {
-	HumRegex hre;
+int Tool_binroll::getCell(int pitch, int index) const {
+	int word = index * 2 + (pitch >> 6);
+	int shift = pitch & 0x3f;
+	if ((m_attacks[word] >> shift) & 1) {
+		return 2;
+	}
+	return (m_sounding[word] >> shift) & 1;
+}
 
-	for (int i=0; i<infile.getLineCount(); i++) {
-		if (infile[i].isExclusive()) {
-			break;
+
+
+//////////////////////////////
+//
+// Tool_binroll::printRoll -- Print the piano roll in the output format
+//     (without any Humdrum comments).
+//
+
+void Tool_binroll::printRoll(ostream& out) {
+	if (m_format == "npy") {
+		printNpyHeader(out, m_slicecount);
+	}
+	printRollData(out);
+}
+
+
+
+//////////////////////////////
+//
+// Tool_binroll::printRollData -- Print the time slices of the piano roll
+//     in the output format, without any file header.
+//
+
+void Tool_binroll::printRollData(ostream& out) {
+	if (m_format == "bits") {
+		printBitplanes(out);
+	} else if (m_format == "npy") {
+		printNpyRoll(out);
+	} else {
+		printTextRoll(out);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// Tool_binroll::printTextRoll -- Print one line for each time slice, with
+//     the state of the 128 MIDI keys separated by spaces.
+//
+
+void Tool_binroll::printTextRoll(ostream& out) {
+	string line(128 * 2, ' ');
+	line.back() = '\n';
+	for (int i=0; i<m_slicecount; i++) {
+		for (int j=0; j<128; j++) {
+			line[j * 2] = '0' + getCell(j, i);
+		}
+		out.write(line.data(), line.size());
+	}
+}
+
+
+
+//////////////////////////////
+//
+// Tool_binroll::printBitplanes -- Print 32 bytes for each time slice: 16
+//     bytes for the sounding notes and then 16 bytes for the note attacks.
+//     MIDI key k is stored in bit (k % 8) of byte (k / 8) of each plane.
+//
+
+void Tool_binroll::printBitplanes(ostream& out) {
+	char buffer[32];
+	for (int i=0; i<m_slicecount; i++) {
+		for (int w=0; w<2; w++) {
+			uint64_t sounding = m_sounding[i * 2 + w];
+			uint64_t attacks  = m_attacks[i * 2 + w];
+			for (int b=0; b<8; b++) {
+				buffer[w * 8 + b]      = (char)((sounding >> (b * 8)) & 0xff);
+				buffer[16 + w * 8 + b] = (char)((attacks  >> (b * 8)) & 0xff);
+			}
+		}
+		out.write(buffer, 32);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// Tool_binroll::printNpyHeader -- Print a NumPy .npy (version 1.0) header
+//     for an array of unsigned bytes with the shape (slicecount, 128).
+//     The header is always 128 bytes long, so that it can be rewritten
+//     when the slice count is not known in advance.
+//
+
+void Tool_binroll::printNpyHeader(ostream& out, int64_t slicecount) {
+	string dict = "{'descr': '|u1', 'fortran_order': False, 'shape': (";
+	dict += to_string(slicecount);
+	dict += ", 128), }";
+	int headerlen = 128 - 10;
+	dict.resize(headerlen - 1, ' ');
+	dict += '\n';
+	out.write("\x93NUMPY\x01\x00", 8);
+	out.put((char)(headerlen & 0xff));
+	out.put((char)((headerlen >> 8) & 0xff));
+	out.write(dict.data(), dict.size());
+}
+
+
+
+//////////////////////////////
+//
+// Tool_binroll::printNpyRoll -- Print the roll as a row-major array of
+//     bytes, one row of 128 MIDI keys for each time slice, with the same
+//     values as the text output.
+//
+
+void Tool_binroll::printNpyRoll(ostream& out) {
+	char buffer[128];
+	for (int i=0; i<m_slicecount; i++) {
+		for (int j=0; j<128; j++) {
+			buffer[j] = (char)getCell(j, i);
 		}
+		out.write(buffer, 128);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// Tool_binroll::printComments -- Print lines from the file as comments,
+//     replacing leading "!" characters with "#".
+//
+
+void Tool_binroll::printComments(HumdrumFile& infile, int startline,
+		int endline, ostream& out) {
+	for (int i=startline; i<endline; i++) {
 		if (infile[i].isEmpty()) {
 			continue;
 		}
@@ -128,24 +377,35 @@ void Tool_binroll::printAnalysis(HumdrumFile& infile,
 		int found = 0;
 		for (int j=0; j<(int)line.size(); j++) {
 			if ((line[j] == '!') && !found) {
-				m_free_text << "#";
+				out << "#";
 			} else {
 				found = 1;
-				m_free_text << line[j];
+				out << line[j];
 			}
 		}
-		m_free_text << "\n";
+		out << "\n";
 	}
+}
 
-	for (int i=0; i<(int)roll[0].size(); i++) {
-		for (int j=0; j<(int)roll.size(); j++) {
-			m_free_text << (int)roll[j][i];
-			if (j < (int)roll.size() - 1) {
-				m_free_text << ' ';
-			}
+
+
+//////////////////////////////
+//
+// Tool_binroll::printAnalysis -- Print the roll as text, with the
+//     comments before and after the data in the file.
+//
+
+void Tool_binroll::printAnalysis(HumdrumFile& infile, ostream& out) {
+	int endline = infile.getLineCount();
+	for (int i=0; i<infile.getLineCount(); i++) {
+		if (infile[i].isExclusive()) {
+			endline = i;
+			break;
 		}
-		m_free_text << "\n";
 	}
+	printComments(infile, 0, endline, out);
+
+	printTextRoll(out);
 
 	int startindex = infile.getLineCount() - 1;
 	for (int i=infile.getLineCount()-1; i>=0; i--) {
@@ -155,84 +415,66 @@ void Tool_binroll::printAnalysis(HumdrumFile& infile,
 		}
 		startindex = i;
 	}
-
-	for (int i=startindex; i<infile.getLineCount(); i++) {
-		if (infile[i].isEmpty()) {
-			continue;
-		}
-		string line = infile[i].getText();
-		int found = 0;
-		for (int j=0; j<(int)line.size(); j++) {
-			if ((line[j] == '!') && !found) {
-				m_free_text << "#";
-			} else {
-				found = 1;
-				m_free_text << line[j];
-			}
-		}
-		m_free_text << "\n";
-	}
+	printComments(infile, startindex, infile.getLineCount(), out);
 }
 
 
 
 //////////////////////////////
 //
-// Tool_binroll::processStrand --
+// Tool_binroll::processStrand -- The notes of the strand are collected
+//     first so that their MIDI pitches can be calculated together.
 //
 
-void Tool_binroll::processStrand(vector<vector<char>>& roll, HTp starting,
-		HTp ending) {
+void Tool_binroll::processStrand(HTp starting, HTp ending) {
+	vector<string> pitches;   // note or chord subtoken
+	vector<HTp> tokens;       // token containing each pitch
+	vector<bool> chords;      // true if the pitch is in a chord
 	HTp current = starting;
-	int base12;
-	HumNum starttime;
-	HumNum duration;
-	int startindex;
-	int endindex;
 	while (current && (current != ending)) {
-		if (!current->isNonNullData()) {
-			current = current->getNextToken();
-			continue;
-		}
-		if (current->isRest()) {
+		if (!current->isNonNullData() || current->isRest()) {
 			current = current->getNextToken();
 			continue;
 		}
-
 		if (current->isChord()) {
 			int stcount = current->getSubtokenCount();
-			starttime = current->getDurationFromStart();
-			startindex = (starttime / m_duration).getInteger();
 			for (int s=0; s<stcount; s++) {
-				string tok = current->getSubtoken(s);
-				base12 = Convert::kernToMidiNoteNumber(tok);
-				if ((base12 < 0) || (base12 > 127)) {
-					continue;
-				}
-				duration = Convert::recipToDuration(tok);
-				endindex = ((starttime+duration) / m_duration).getInteger();
-				roll[base12][startindex] = 2;
-				for (int i=startindex+1; i<endindex; i++) {
-					roll[base12][i] = 1;
-				}
+				pitches.push_back(current->getSubtoken(s));
+				tokens.push_back(current);
+				chords.push_back(true);
 			}
 		} else {
-			base12 = Convert::kernToMidiNoteNumber(current);
-			if ((base12 < 0) || (base12 > 127)) {
-				current = current->getNextToken();
-				continue;
-			}
-			starttime = current->getDurationFromStart();
-			duration = current->getDuration();
-			startindex = (starttime / m_duration).getInteger();
-			endindex   = ((starttime+duration) / m_duration).getInteger();
-			roll[base12][startindex] = 2;
-			for (int i=startindex+1; i<endindex; i++) {
-				roll[base12][i] = 1;
-			}
+			pitches.push_back(*current);
+			tokens.push_back(current);
+			chords.push_back(false);
 		}
 		current = current->getNextToken();
 	}
+
+	vector<int> base12;
+	Convert::kernToMidiNoteNumber(pitches, base12);
+
+	HumNum starttime;
+	HumNum duration;
+	int startindex;
+	int endindex;
+	for (int i=0; i<(int)pitches.size(); i++) {
+		if ((base12[i] < 0) || (base12[i] > 127)) {
+			continue;
+		}
+		starttime = tokens[i]->getDurationFromStart();
+		if (chords[i]) {
+			duration = Convert::recipToDuration(pitches[i]);
+		} else {
+			duration = tokens[i]->getDuration();
+		}
+		startindex = (starttime / m_duration).getInteger();
+		endindex   = ((starttime+duration) / m_duration).getInteger();
+		setCell(base12[i], startindex, 2);
+		for (int j=startindex+1; j<endindex; j++) {
+			setCell(base12[i], j, 1);
+		}
+	}
 }
 
 
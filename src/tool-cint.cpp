@@ -13,9 +13,15 @@
 
 #include "tool-cint.h"
 #include "HumRegex.h"
+#include "HumParallel.h"
 #include "Convert.h"
 
 #include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
 
 using namespace std;
 
@@ -80,6 +86,10 @@ Tool_cint::Tool_cint(void) {
 	define("search=s:", "search string");
 	define("mark=b", "mark matches notes from searches in data");
 	define("count=b", "count matched modules from search query");
+	define("index=s:", "write an index of the modules in all input files");
+	define("lookup=s:", "search for --query module in an index file");
+	define("query=s:", "module to find with --lookup, such as \"8 1 5\"");
+	define("j|threads=i:0", "number of threads to use when creating an index");
 	define("debug=b");              // determine bad input line num
 	define("author=b");             // author of program
 	define("version=b");            // compilation info
@@ -95,6 +105,10 @@ Tool_cint::Tool_cint(void) {
 //
 
 bool Tool_cint::run(HumdrumFileSet& infiles) {
+	if (getBoolean("index")) {
+		initialize();
+		return buildModuleIndex(infiles, getString("index"));
+	}
 	bool status = true;
 	for (int i=0; i<infiles.getCount(); i++) {
 		status &= run(infiles[i]);
@@ -225,41 +239,21 @@ int Tool_cint::processFile(HumdrumFile& infile) {
 	vector<vector<NoteNode> > notes;
 	vector<string> names;
 	vector<int>    ktracks;
-	vector<HTp>    kstarts;
 	vector<int>    reverselookup;
 
-	infile.getSpineStartList(kstarts, "**kern");
-	ktracks.resize(kstarts.size());
-	for (int i=0; i<(int)kstarts.size(); i++) {
-		ktracks[i] = kstarts[i]->getTrack();
-	}
+//	if (locationQ || rhythmQ || durationQ) {
+//		infile.analyzeRhythm();
+//	}
 
-	if (koptionQ) {
-		adjustKTracks(ktracks, getString("koption"));
-	}
-	notes.resize(ktracks.size());
-	reverselookup.resize(infile.getTrackCount()+1);
-	fill(reverselookup.begin(), reverselookup.end(), -1);
+	prepareNoteArray(notes, infile, ktracks, reverselookup);
 
 	vector<vector<string> > retrospective;
 	if (retroQ) {
 		initializeRetrospective(retrospective, infile, ktracks);
 	}
 
-//	if (locationQ || rhythmQ || durationQ) {
-//		infile.analyzeRhythm();
-//	}
-
 	int i;
-	for (i=0; i<(int)ktracks.size(); i++) {
-		reverselookup[ktracks[i]] = i;
-		// notes[i].reserve(infile.getLineCount());
-		notes[i].resize(0);
-	}
-
 	getNames(names, reverselookup, infile);
-	HumRegex pre;
-	extractNoteArray(notes, infile, ktracks, reverselookup);
 
 	if (pitchesQ) {
 		printPitchGrid(notes, infile);
@@ -309,6 +303,38 @@ int Tool_cint::processFile(HumdrumFile& infile) {
 
 
 
+//////////////////////////////
+//
+// Tool_cint::prepareNoteArray -- Identify the **kern spines to analyze
+//     and extract their notes into the note array.
+//
+
+void Tool_cint::prepareNoteArray(vector<vector<NoteNode> >& notes,
+		HumdrumFile& infile, vector<int>& ktracks, vector<int>& reverselookup) {
+	vector<HTp> kstarts;
+	infile.getSpineStartList(kstarts, "**kern");
+	ktracks.resize(kstarts.size());
+	for (int i=0; i<(int)kstarts.size(); i++) {
+		ktracks[i] = kstarts[i]->getTrack();
+	}
+
+	if (koptionQ) {
+		adjustKTracks(ktracks, getString("koption"));
+	}
+	notes.resize(ktracks.size());
+	reverselookup.resize(infile.getTrackCount()+1);
+	fill(reverselookup.begin(), reverselookup.end(), -1);
+
+	for (int i=0; i<(int)ktracks.size(); i++) {
+		reverselookup[ktracks[i]] = i;
+		notes[i].resize(0);
+	}
+
+	extractNoteArray(notes, infile, ktracks, reverselookup);
+}
+
+
+
 //////////////////////////////
 //
 // Tool_cint::adjustKTracks -- Select only two spines to do analysis on.
@@ -727,6 +753,429 @@ int Tool_cint::printCombinationModulePrepare(ostream& out, const string& filenam
 
 
 
+//////////////////////////////
+//
+// Tool_cint::buildModuleIndex -- Extract the modules for every pair of
+//     voices in all input files and write them to an inverted index:
+//     each line of the index file contains a module (encoded as the
+//     integer intervals of the module) followed by a list of all locations
+//     in the files where the module occurs.  The note arrays of the files
+//     are extracted in parallel, and then all voice pairs are processed in
+//     parallel.  The index can be searched with --lookup and --query.
+//
+//     The module lines are sorted by their text, and are followed by a
+//     table of the byte offsets of the module lines in fixed-width records
+//     (see Tool_cint::getModuleIndexOffset()) and a fixed-width last line
+//     with the byte offset of the table, so that a module can be found
+//     with a binary search.
+//
+
+bool Tool_cint::buildModuleIndex(HumdrumFileSet& infiles,
+		const string& filename) {
+	int filecount = infiles.getCount();
+	int threads = HumParallel::getThreadCount(getInteger("threads"));
+
+	vector<vector<vector<NoteNode> > > notes(filecount);
+	HumParallel::run(filecount, threads, [&](int i) {
+		// Input streams are read without rhythm analysis, but the
+		// modules need the durations of the notes.
+		if (!infiles[i].isRhythmAnalyzed()) {
+			int analysisthreads = infiles[i].getAnalysisThreadCount();
+			infiles[i].setAnalysisThreadCount(1);
+			infiles[i].analyzeRhythmStructure();
+			infiles[i].setAnalysisThreadCount(analysisthreads);
+		}
+		vector<int> ktracks;
+		vector<int> reverselookup;
+		prepareNoteArray(notes[i], infiles[i], ktracks, reverselookup);
+	});
+
+	// One job for each pair of voices in each file:
+	vector<vector<int> > jobs;
+	for (int i=0; i<filecount; i++) {
+		int voices = (int)notes[i].size();
+		for (int j=0; j<voices; j++) {
+			for (int k=j+1; k<voices; k++) {
+				jobs.push_back({i, j, k});
+			}
+		}
+	}
+	vector<vector<pair<vector<int>, string> > > results(jobs.size());
+	HumParallel::run((int)jobs.size(), threads, [&](int i) {
+		int f = jobs[i][0];
+		extractModuleKeys(results[i], infiles[f], notes[f], f, jobs[i][1],
+				jobs[i][2]);
+	});
+
+	// Merge the results in job order so that the index is always the same
+	// regardless of the number of threads.
+	map<string, vector<string> > index;
+	int modulecount = 0;
+	for (int i=0; i<(int)results.size(); i++) {
+		for (int j=0; j<(int)results[i].size(); j++) {
+			index[getModuleKeyString(results[i][j].first)].push_back(results[i][j].second);
+			modulecount++;
+		}
+		results[i].clear();
+	}
+
+	ofstream output(filename.c_str(), ios::binary);
+	if (!output.is_open()) {
+		m_error_text << "Error: cannot write index file " << filename << endl;
+		return false;
+	}
+	output << "!!!cint-index: 2\n";
+	output << "!!!cint-options: " << getModuleIndexSignature() << "\n";
+	for (int i=0; i<filecount; i++) {
+		output << "!!!cint-file: " << infiles[i].getFilename() << "\n";
+	}
+	vector<std::streamoff> offsets;
+	offsets.reserve(index.size());
+	for (auto& entry : index) {
+		offsets.push_back(output.tellp());
+		output << entry.first;
+		for (int i=0; i<(int)entry.second.size(); i++) {
+			output << "\t" << entry.second[i];
+		}
+		output << "\n";
+	}
+	std::streamoff table = output.tellp();
+	for (int i=0; i<(int)offsets.size(); i++) {
+		output << std::setw(m_offsetwidth) << std::setfill('0') << offsets[i] << "\n";
+	}
+	output << m_tablemarker << std::setw(m_offsetwidth) << std::setfill('0') << table << "\n";
+	output.close();
+	if (!output) {
+		m_error_text << "Error: cannot write index file " << filename << endl;
+		return false;
+	}
+
+	m_free_text << "!!cint-index: " << filecount << " files, "
+		<< modulecount << " modules, " << index.size()
+		<< " distinct modules written to " << filename << endl;
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_cint::extractModuleKeys -- Store the encoded modules between two
+//     voices along with their locations for the module index.  A location
+//     is stored as "file:voice1:voice2:measure:loc", where file is the
+//     index of the file in the index header, the voices are numbered in
+//     the same way as the --location option, and loc is the position
+//     of the module in the score in the range from 0.0 to 1.0.
+//
+
+void Tool_cint::extractModuleKeys(vector<pair<vector<int>, string> >& entries,
+		HumdrumFile& infile, vector<vector<NoteNode> >& notes, int fileindex,
+		int part1, int part2) {
+	entries.clear();
+	if (notes.empty()) {
+		return;
+	}
+	// Module text is not needed, so send it to a stream without a buffer.
+	ostream nullout(NULL);
+	vector<vector<string> > retrospective;
+	string filename = infile.getFilename();
+	HumNum scoredur = infile.getScoreDuration();
+	int voices = (int)notes.size();
+	char notemarker;
+	vector<int> key;
+
+	for (int i=0; i<(int)notes[0].size(); i++) {
+		int status = printCombinationModule(nullout, filename, notes, Chaincount,
+				i, part1, part2, retrospective, notemarker, 0, &key);
+		if (!status) {
+			continue;
+		}
+		int line = notes[part1][i].line;
+		double loc = 0.0;
+		if (scoredur > 0) {
+			loc = infile[line].getDurationFromStart().getFloat() /
+					scoredur.getFloat();
+			loc = int(100.0 * loc + 0.5)/100.0;
+		}
+		stringstream location;
+		location << fileindex
+			<< ":" << (voices - part2)
+			<< ":" << (voices - part1)
+			<< ":" << notes[part1][i].measure
+			<< ":" << loc;
+		entries.emplace_back(key, location.str());
+	}
+}
+
+
+
+//////////////////////////////
+//
+// Tool_cint::lookupModuleIndex -- Search for the module given by the
+//     --query option in the index file given by the --lookup option.
+//     Matches are printed in the same format as --search --location.
+//     With the --count option, only the number of matches is printed.
+//     The module line is found with a binary search of the offset table
+//     at the end of the index (see Tool_cint::buildModuleIndex()).
+//
+
+bool Tool_cint::lookupModuleIndex(ostream& out) {
+	initialize();
+	string indexname = getString("lookup");
+	ifstream input(indexname.c_str(), ios::binary);
+	if (!input.is_open()) {
+		m_error_text << "Error: cannot read index file " << indexname << endl;
+		return false;
+	}
+	vector<int> key;
+	if (!parseModuleQuery(key, getString("query"))) {
+		m_error_text << "Error: cannot parse module query \""
+			<< getString("query") << "\"" << endl;
+		return false;
+	}
+	string target = getModuleKeyString(key);
+	string signature = getModuleIndexSignature();
+
+	// Read the header of the index:
+	vector<string> filenames;
+	vector<int> filecounts;
+	int version = 0;
+	string line;
+	while ((input.peek() == '!') && getline(input, line)) {
+		if (line.compare(0, 14, "!!!cint-file: ") == 0) {
+			filenames.push_back(line.substr(14));
+			filecounts.push_back(0);
+		} else if (line.compare(0, 15, "!!!cint-index: ") == 0) {
+			version = atoi(line.substr(15).c_str());
+		} else if (line.compare(0, 17, "!!!cint-options: ") == 0) {
+			if (line.substr(17) != signature) {
+				m_warning_text << "Warning: index " << indexname
+					<< " was created with options \"" << line.substr(17)
+					<< "\" rather than \"" << signature << "\"" << endl;
+			}
+		}
+	}
+
+	// Read the position of the offset table from the last line:
+	std::streamoff table = -1;
+	std::streamoff recordcount = 0;
+	std::streamoff lastsize = (std::streamoff)m_tablemarker.size() + m_offsetwidth + 1;
+	input.clear();
+	input.seekg(0, ios::end);
+	std::streamoff filesize = input.tellg();
+	if ((version >= 2) && (filesize >= lastsize)) {
+		input.seekg(filesize - lastsize);
+		if (getline(input, line) && (line.compare(0, m_tablemarker.size(),
+				m_tablemarker) == 0)) {
+			table = atoll(line.substr(m_tablemarker.size()).c_str());
+			recordcount = (filesize - lastsize - table) / (m_offsetwidth + 1);
+		}
+	}
+	if ((table < 0) || (recordcount < 0)) {
+		m_error_text << "Error: " << indexname << " has no module table "
+			<< "(rebuild it with --index)" << endl;
+		return false;
+	}
+
+	// Binary search of the module lines:
+	std::streamoff found = -1;
+	std::streamoff low = 0;
+	std::streamoff high = recordcount - 1;
+	string linekey;
+	while (low <= high) {
+		std::streamoff middle = low + (high - low) / 2;
+		std::streamoff offset = getModuleIndexOffset(input, table, middle);
+		if (offset < 0) {
+			m_error_text << "Error: invalid module table in " << indexname << endl;
+			return false;
+		}
+		input.seekg(offset);
+		getline(input, linekey, '\t');
+		int compare = linekey.compare(target);
+		if (compare == 0) {
+			found = offset;
+			break;
+		} else if (compare < 0) {
+			low = middle + 1;
+		} else {
+			high = middle - 1;
+		}
+	}
+
+	int count = 0;
+	if (found >= 0) {
+		input.clear();
+		input.seekg(found);
+		getline(input, line);
+		size_t tab = line.find('\t');
+		stringstream postings(tab == string::npos ? "" : line.substr(tab + 1));
+		string posting;
+		while (getline(postings, posting, '\t')) {
+			int fileindex;
+			int voice1;
+			int voice2;
+			int measure;
+			double loc;
+			char colon;
+			stringstream fields(posting);
+			fields >> fileindex >> colon >> voice1 >> colon >> voice2
+				>> colon >> measure >> colon >> loc;
+			if (fields.fail() || (fileindex < 0) ||
+					(fileindex >= (int)filenames.size())) {
+				m_warning_text << "Warning: invalid index entry " << posting << endl;
+				continue;
+			}
+			count++;
+			filecounts[fileindex]++;
+			if (!countQ) {
+				out << "!!LOCATION:"
+					<< "\t"  << loc
+					<< "\tm" << measure
+					<< "\tv" << voice1
+					<< ":v"  << voice2
+					<< "\t"  << filenames[fileindex]
+					<< endl;
+			}
+		}
+	}
+
+	if (countQ) {
+		if (filenameQ) {
+			for (int i=0; i<(int)filenames.size(); i++) {
+				if (filecounts[i]) {
+					out << filecounts[i] << "\t" << filenames[i] << endl;
+				}
+			}
+		} else {
+			out << count << endl;
+		}
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_cint::getModuleIndexOffset -- Return the byte offset of a module
+//     line in an index file from the given record of the offset table,
+//     or -1 if the record cannot be read.
+//
+
+std::streamoff Tool_cint::getModuleIndexOffset(istream& input,
+		std::streamoff table, std::streamoff record) {
+	input.clear();
+	input.seekg(table + record * (m_offsetwidth + 1));
+	string text(m_offsetwidth, '\0');
+	if (!input.read(&text[0], m_offsetwidth)) {
+		return -1;
+	}
+	return atoll(text.c_str());
+}
+
+
+
+//////////////////////////////
+//
+// Tool_cint::getModuleIndexSignature -- Return a list of the options which
+//     change the contents of modules.  This is stored in module index
+//     files, since queries must use the same options as the index.
+//
+
+string Tool_cint::getModuleIndexSignature(void) {
+	stringstream output;
+	output << "-n " << Chaincount;
+	if (base40Q) {
+		output << " --40";
+	} else if (base12Q) {
+		output << " --12";
+	}
+	if (zeroQ)       { output << " -z"; }
+	if (attackQ)     { output << " --attacks"; }
+	if (uncrossQ)    { output << " -c"; }
+	if (octaveQ)     { output << " -o"; }
+	if (octaveallQ)  { output << " -O"; }
+	if (noharmonicQ) { output << " -H"; }
+	if (nomelodicQ)  { output << " -M"; }
+	if (norestsQ)    { output << " -R"; }
+	if (nounisonsQ)  { output << " -U"; }
+	if (topQ)        { output << " -t"; }
+	if (toponlyQ)    { output << " -T"; }
+	if (sustainQ)    { output << " -s"; }
+	if (xoptionQ)    { output << " -x"; }
+	if (koptionQ)    { output << " -k " << getString("koption"); }
+	return output.str();
+}
+
+
+
+//////////////////////////////
+//
+// Tool_cint::getModuleKeyString -- Convert an encoded module into the
+//     text form used in index files: a comma-separated list of integers.
+//
+
+string Tool_cint::getModuleKeyString(const vector<int>& key) {
+	string output;
+	for (int i=0; i<(int)key.size(); i++) {
+		if (i > 0) {
+			output += ',';
+		}
+		output += to_string(key[i]);
+	}
+	return output;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_cint::parseModuleQuery -- Convert a module written in the same form
+//     as the --raw output (such as "7xs 1 6sx -2 8xx") into the integer
+//     encoding used in index files.  Intervals may be separated by spaces
+//     or commas, and "R" is used for rests.  Returns false if the query
+//     cannot be parsed.
+//
+
+bool Tool_cint::parseModuleQuery(vector<int>& key, const string& query) {
+	key.clear();
+	HumRegex hre;
+	vector<string> tokens;
+	hre.split(tokens, query, "[\\s,]+");
+	for (int i=0; i<(int)tokens.size(); i++) {
+		if (tokens[i].empty()) {
+			continue;
+		}
+		if (tokens[i] == RESTSTRING) {
+			key.push_back(RESTINT);
+			continue;
+		}
+		if (!hre.search(tokens[i], "^(-?\\d+)([sx])?([sx])?$")) {
+			return false;
+		}
+		int interval = hre.getMatchInt(1);
+		string state1 = hre.getMatch(2);
+		string state2 = hre.getMatch(3);
+		if (!state1.empty()) {
+			if (state2.empty()) {
+				return false;
+			}
+			int state = 0;
+			if (state1 == "s") {
+				state |= 2;
+			}
+			if (state2 == "s") {
+				state |= 1;
+			}
+			interval = interval * 4 + state;
+		}
+		key.push_back(interval);
+	}
+	return !key.empty();
+}
+
+
+
 //////////////////////////////
 //
 // Tool_cint::getMeasure -- return the last measure number of the given line index.
@@ -1028,9 +1477,12 @@ int Tool_cint::getOctaveAdjustForCombinationModule(vector<vector<NoteNode> >& no
 int Tool_cint::printCombinationModule(ostream& out, const string& filename,
 		vector<vector<NoteNode> >& notes, int n, int startline, int part1,
 		int part2, vector<vector<string> >& retrospective, char& notemarker,
-		int markstate) {
+		int markstate, vector<int>* key) {
 
 	notemarker = '\0';
+	if (key) {
+		key->clear();
+	}
 
 	if (norestsQ) {
 		if (notes[part1][startline].b40 == 0) {
@@ -1152,6 +1604,10 @@ int Tool_cint::printCombinationModule(ostream& out, const string& filename,
 			if (!toponlyQ) {
 				printInterval((*outp), notes[part1][lastindex],
 						notes[part1][i], INTERVAL_MELODIC);
+				if (key) {
+					addIntervalToKey(*key, notes[part1][lastindex],
+							notes[part1][i], INTERVAL_MELODIC);
+				}
 				if (mmarkerQ) {
 					(*outp) << "m";
 				}
@@ -1165,6 +1621,10 @@ int Tool_cint::printCombinationModule(ostream& out, const string& filename,
 				// top melodic interval:
 				printInterval((*outp), notes[part2][lastindex],
 						notes[part2][i], INTERVAL_MELODIC);
+				if (key) {
+					addIntervalToKey(*key, notes[part2][lastindex],
+							notes[part2][i], INTERVAL_MELODIC);
+				}
 				if (mmarkerQ) {
 					(*outp) << "m";
 				}
@@ -1192,6 +1652,10 @@ int Tool_cint::printCombinationModule(ostream& out, const string& filename,
 				//      notes[part2][i], INTERVAL_HARMONIC, octaveadjust);
 				printInterval((*outp), notes[part1][i],
 						notes[part2][i], INTERVAL_HARMONIC, octaveadjust);
+				if (key) {
+					addIntervalToKey(*key, notes[part1][i], notes[part2][i],
+							INTERVAL_HARMONIC, octaveadjust);
+				}
 			}
 
 			if (durationQ) {
@@ -1873,12 +2337,60 @@ int Tool_cint::printInterval(ostream& out, NoteNode& note1, NoteNode& note2,
 		return 0;
 	}
 	int cross = 0;
+	if ((type == INTERVAL_HARMONIC) && (abs(note2.b40) < abs(note1.b40))) {
+		cross = 1;
+	}
+	int interval = getIntervalNumber(note1, note2, type, octaveadjust);
+
+	if (chromaticQ) {
+		out << Convert::base40ToIntervalAbbr(interval);
+	} else {
+		int negative = 1;
+		if (interval < 0) {
+			negative = -1;
+			interval = -interval;
+		}
+		if (base7Q && !zeroQ) {
+			out << negative * (interval+1);
+		} else {
+			out << negative * interval;
+		}
+	}
+
+	if (sustainQ || ((type == INTERVAL_HARMONIC) && xoptionQ)) {
+		// print sustain/attack information of intervals.
+		if (note1.b40 < 0) {
+			out << "s";
+		} else {
+			out << "x";
+		}
+		if (note2.b40 < 0) {
+			out << "s";
+		} else {
+			out << "x";
+		}
+	}
+
+	return cross;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_cint::getIntervalNumber -- Return the interval between two
+//     (non-rest) notes in the current interval system.  Diatonic intervals
+//     are returned as zero-offset values, and chromatic intervals are
+//     returned in base-40.
+//
+
+int Tool_cint::getIntervalNumber(NoteNode& note1, NoteNode& note2,
+		int type, int octaveadjust) {
 	int pitch1 = abs(note1.b40);
 	int pitch2 = abs(note2.b40);
 	int interval = pitch2 - pitch1;
 
 	if ((type == INTERVAL_HARMONIC) && (interval < 0)) {
-		cross = 1;
 		if (uncrossQ) {
 			interval = -interval;
 		}
@@ -1936,37 +2448,40 @@ int Tool_cint::printInterval(ostream& out, NoteNode& note1, NoteNode& note2,
 		interval = interval + octaveadjust  * 7;
 	}
 
+	return interval;
+}
 
-	if (chromaticQ) {
-		out << Convert::base40ToIntervalAbbr(interval);
-	} else {
-		int negative = 1;
-		if (interval < 0) {
-			negative = -1;
-			interval = -interval;
-		}
-		if (base7Q && !zeroQ) {
-			out << negative * (interval+1);
-		} else {
-			out << negative * interval;
-		}
-	}
 
+
+//////////////////////////////
+//
+// Tool_cint::addIntervalToKey -- Append an interval to the integer
+//     encoding of a module which is used by the module index.  The key
+//     contains the interval numbers as they would be printed.  Attack/sustain
+//     markers ("xs") are stored in the two low bits of the interval number.
+//
+
+void Tool_cint::addIntervalToKey(vector<int>& key, NoteNode& note1,
+		NoteNode& note2, int type, int octaveadjust) {
+	if ((note1.b40 == REST) || (note2.b40 == REST)) {
+		key.push_back(RESTINT);
+		return;
+	}
+	int interval = getIntervalNumber(note1, note2, type, octaveadjust);
+	if (base7Q && !zeroQ) {
+		interval = (interval < 0) ? interval - 1 : interval + 1;
+	}
 	if (sustainQ || ((type == INTERVAL_HARMONIC) && xoptionQ)) {
-		// print sustain/attack information of intervals.
+		int state = 0;
 		if (note1.b40 < 0) {
-			out << "s";
-		} else {
-			out << "x";
+			state |= 2;
 		}
 		if (note2.b40 < 0) {
-			out << "s";
-		} else {
-			out << "x";
+			state |= 1;
 		}
+		interval = interval * 4 + state;
 	}
-
-	return cross;
+	key.push_back(interval);
 }
 
 
@@ -2253,11 +2768,8 @@ void Tool_cint::extractNoteArray(vector<vector<NoteNode> >& notes, HumdrumFile&
 
 	HumRegex hre;
 
-	Ids.resize(infile.getTrackCount()+1);
+	vector<string> ids(infile.getTrackCount()+1, EMPTY_ID);
 	int i, j, ii, jj;
-	for (i=0; i<(int)Ids.size(); i++) {
-		Ids[i] = EMPTY_ID;
-	}
 
 	vector<NoteNode> current(ktracks.size());
 	vector<double> beatsizes(infile.getTrackCount()+1, 1);
@@ -2319,7 +2831,7 @@ void Tool_cint::extractNoteArray(vector<vector<NoteNode> >& notes, HumdrumFile&
 			for (j=0; j<infile[i].getFieldCount(); j++) {
 				if (hre.search(*infile.token(i, j), "^!ID:\\s*([^\\s]*)")) {
 					int track = infile.token(i, j)->getTrack();
-					Ids[track] = hre.getMatch(1);
+					ids[track] = hre.getMatch(1);
 				}
 			}
 		}
@@ -2339,8 +2851,8 @@ void Tool_cint::extractNoteArray(vector<vector<NoteNode> >& notes, HumdrumFile&
 				continue;
 			}
 			if (idQ) {
-				current[index].getId() = Ids[track];
-				Ids[track] = "";  // don't assign to next item;
+				current[index].getId() = ids[track];
+				ids[track] = "";  // don't assign to next item;
 			}
 			current[index].line  = i;
 			current[index].spine = j;
@@ -2705,6 +3217,12 @@ void Tool_cint::initialize(void) {
 		SearchString = getString("search");
 	}
 
+	if (getBoolean("index") || getBoolean("lookup")) {
+		// Modules are stored as interval numbers in index files.
+		chromaticQ = 0;
+		idQ = 0;
+	}
+
 }
 
 
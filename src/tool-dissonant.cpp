@@ -3,6 +3,7 @@
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sat Aug  8 12:24:49 PDT 2015
 // Last Modified: Wed May 24 15:39:19 CEST 2017
+// Last Modified: Sun Oct 18 17:24:10 PDT 2026 Store results in analysis columns
 // Filename:      tool-dissonant.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/tool-dissonant.cpp
 // Syntax:        C++11; humlib
@@ -14,6 +15,7 @@
 #include "tool-dissonant.h"
 #include "Convert.h"
 #include "HumRegex.h"
+#include "HumParallel.h"
 
 #include <algorithm>
 #include <cmath>
@@ -46,6 +48,9 @@ Tool_dissonant::Tool_dissonant(void) {
 	define("debug=b",                 "print grid cell information");
 	define("u|undirected=b",          "use undirected dissonance labels");
 	define("c|count=b",               "count dissonances by category");
+	define("filename=b",              "print filename before the analysis of each file");
+	define("csv=b",                   "print analysis as CSV data rather than adding spines");
+	define("j|threads=i:0",           "number of files to analyze at the same time");
 	define("i|x|e|exinterp=s:**cdata","specify exinterp for **cdata spine");
 	define("color|colorize|color-by-rhythm=b", "color dissonant notes by beat level");
 	define("color2|colorize2|color-by-interval=b", "color dissonant notes by dissonant interval");
@@ -67,6 +72,107 @@ bool Tool_dissonant::run(HumdrumFileSet& infiles) {
 }
 
 
+//
+// Batch processing of a stream of files: groups of files are analyzed in
+// parallel, and the results are stored in the order of the input files.
+//
+
+bool Tool_dissonant::run(HumdrumFileStream& instream) {
+	int threads = HumParallel::getThreadCount(getInteger("threads"));
+	int batchsize = threads * 4;
+	bool filenameQ = getBoolean("filename");
+	bool status = true;
+
+	while (true) {
+		HumdrumFileSet infiles;
+		for (int i=0; i<batchsize; i++) {
+			HumdrumFile* infile = new HumdrumFile;
+			if (!instream.getFile(*infile)) {
+				delete infile;
+				break;
+			}
+			infiles.appendHumdrumPointer(infile);
+		}
+		if (infiles.getCount() == 0) {
+			break;
+		}
+		status &= analyzeFiles(infiles, false, filenameQ);
+	}
+
+	return status;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_dissonant::printCountAnalysisForFiles -- Print the dissonance label
+//     counts of each file in the set (see printCountAnalysis()), with a
+//     !!!!SEGMENT record giving the filename before each count table.
+//     The files are analyzed in parallel.
+//
+
+bool Tool_dissonant::printCountAnalysisForFiles(HumdrumFileSet& infiles) {
+	return analyzeFiles(infiles, true, true);
+}
+
+
+
+//////////////////////////////
+//
+// Tool_dissonant::analyzeFiles -- Analyze the files of a set in parallel
+//     and store the output of each file in the order of the set.  If
+//     countQ is true, the label counts are printed as with the -c option.
+//     If filenameQ is true, a !!!!SEGMENT record is added before the
+//     output of each file.
+//
+
+bool Tool_dissonant::analyzeFiles(HumdrumFileSet& infiles, bool countQ,
+		bool filenameQ) {
+	int threads = HumParallel::getThreadCount(getInteger("threads"));
+	if (getBoolean("debug")) {
+		// keep debugging messages for each file together
+		threads = 1;
+	}
+
+	int count = infiles.getCount();
+	vector<string> output(count);
+	vector<string> warnings(count);
+	vector<char> statuses(count, 1);
+	HumParallel::run(count, threads, [&](int i) {
+		// Each file is analyzed with a separate copy of the tool, since
+		// the analysis stores information about the current file.
+		Tool_dissonant worker;
+		static_cast<Options&>(worker) = static_cast<const Options&>(*this);
+		worker.m_countQ = countQ;
+		int analysisthreads = infiles[i].getAnalysisThreadCount();
+		infiles[i].setAnalysisThreadCount(1);
+		statuses[i] = worker.run(infiles[i]);
+		infiles[i].setAnalysisThreadCount(analysisthreads);
+		stringstream out;
+		if (filenameQ) {
+			out << "!!!!SEGMENT: " << infiles[i].getFilename() << "\n";
+		}
+		if (worker.hasAnyText()) {
+			worker.getAllText(out);
+		} else {
+			out << infiles[i];
+		}
+		output[i] = out.str();
+		warnings[i] = worker.getWarning();
+	});
+
+	bool status = true;
+	for (int i=0; i<count; i++) {
+		m_humdrum_text << output[i];
+		m_warning_text << warnings[i];
+		status &= (bool)statuses[i];
+	}
+	return status;
+}
+
+
+
 bool Tool_dissonant::run(const string& indata, ostream& out) {
 
 	if (getBoolean("undirected")) {
@@ -151,16 +257,18 @@ bool Tool_dissonant::run(HumdrumFile& infile) {
 	suppressQ = getBoolean("suppress");
 	voiceFuncsQ = getBoolean("voice-functions");
 
-	vector<vector<string>> results;
-	vector<vector<string>> results2;
+	bool countQ = m_countQ || getBoolean("count");
+	vector<vector<int>> results;
+	vector<vector<int>> results2;
 	vector<vector<string>> voiceFuncs;
+	vector<vector<string>> labels;
 	vector<vector<NoteCell*>> attacks;
 	vector<vector<NoteCell*>> attacks2;
 
 	attacks.resize(grid.getVoiceCount());
 	results.resize(grid.getVoiceCount());
 	for (int i=0; i<(int)results.size(); i++) {
-		results[i].resize(infile.getLineCount());
+		results[i].resize(infile.getLineCount(), NO_LABEL);
 	}
 	doAnalysis(results, grid, attacks, getBoolean("debug"));
 
@@ -176,7 +284,7 @@ bool Tool_dissonant::run(HumdrumFile& infile) {
 		results2.resize(grid2.getVoiceCount());
 		for (int i=0; i<(int)results2.size(); i++) {
 			results2[i].clear();
-			results2[i].resize(infile.getLineCount());
+			results2[i].resize(infile.getLineCount(), NO_LABEL);
 		}
 		vector<vector<NoteCell*>> attacks2;
 		doAnalysis(results2, grid2, attacks2, getBoolean("debug"));
@@ -184,27 +292,18 @@ bool Tool_dissonant::run(HumdrumFile& infile) {
 	}
 
 	if (suppressQ) {
-		if (getBoolean("count")) {
+		if (countQ) {
 			printCountAnalysis(results2);
 			return false;
 		} else {
-			string exinterp = getString("exinterp");
-			vector<HTp> kernspines = infile.getKernSpineStartList();
-			infile.appendDataSpine(results2.back(), "", exinterp);
-			for (int i = (int)results2.size()-1; i>0; i--) {
-				int track = kernspines[i]->getTrack();
-				infile.insertDataSpineBefore(track, results2[i-1], "", exinterp);
-			}
-			printColorLegend(infile);
-
-			adjustColorization(infile);
-			infile.createLinesFromTokens();
-
-			return true;
+			getLabelStrings(labels, results2);
+			return printAnalysis(infile, labels);
 		}
 	} else if (voiceFuncsQ) { // run cadnetial-voice-function analysis if requested
-		if (getBoolean("count")) {
-			printCountAnalysis(voiceFuncs);
+		if (countQ) {
+			// voice functions are not counted
+			vector<vector<int>> empty;
+			printCountAnalysis(empty);
 			return false;
 		}
 
@@ -216,42 +315,55 @@ bool Tool_dissonant::run(HumdrumFile& infile) {
 			findCadentialVoiceFunctions(results, grid, attacks[i], voiceFuncs, i);
 		}
 
-		string exinterp = getString("exinterp");
-		vector<HTp> kernspines = infile.getKernSpineStartList();
-		infile.appendDataSpine(voiceFuncs.back(), "", exinterp);
-		for (int i = (int)voiceFuncs.size()-1; i>0; i--) {
-			int track = kernspines[i]->getTrack();
-			infile.insertDataSpineBefore(track, voiceFuncs[i-1], "", exinterp);
-		}
-		printColorLegend(infile);
-
-		adjustColorization(infile);
-		infile.createLinesFromTokens();
-
-		infile.createLinesFromTokens();
-		return true;
+		return printAnalysis(infile, voiceFuncs);
 	} else {
-		if (getBoolean("count")) {
+		if (countQ) {
 			printCountAnalysis(results);
 			return false;
 		} else {
-			string exinterp = getString("exinterp");
-			vector<HTp> kernspines = infile.getKernSpineStartList();
-			infile.appendDataSpine(results.back(), "", exinterp);
-			for (int i = (int)results.size()-1; i>0; i--) {
-				int track = kernspines[i]->getTrack();
-				infile.insertDataSpineBefore(track, results[i-1], "", exinterp);
-			}
-			printColorLegend(infile);
-			adjustColorization(infile);
-			infile.createLinesFromTokens();
-			return true;
+			getLabelStrings(labels, results);
+			return printAnalysis(infile, labels);
 		}
 	}
 }
 
 
 
+//////////////////////////////
+//
+// Tool_dissonant::printAnalysis -- Store the analysis of each voice in an
+//     analysis column of the file, placed after the **kern spine for the
+//     voice.  The columns are then printed as CSV data, or rendered as
+//     spines in the file and used to colorize the dissonant notes.
+//
+
+bool Tool_dissonant::printAnalysis(HumdrumFile& infile,
+		vector<vector<string> >& data) {
+	string exinterp = getString("exinterp");
+	vector<HTp> kernspines = infile.getKernSpineStartList();
+	HumAnalysisColumn* column;
+	column = &infile.addAnalysisColumn(data.back(), "", exinterp);
+	column->setName(column->getName() + "-" + to_string(kernspines.back()->getTrack()));
+	for (int i = (int)data.size()-1; i>0; i--) {
+		int track = kernspines[i]->getTrack();
+		column = &infile.addAnalysisColumn(data[i-1], "", exinterp, track);
+		column->setName(column->getName() + "-" + to_string(kernspines[i-1]->getTrack()));
+	}
+
+	if (getBoolean("csv")) {
+		infile.printAnalysisCsv(m_free_text);
+		return true;
+	}
+
+	infile.renderAnalysisColumns();
+	printColorLegend(infile);
+	adjustColorization(infile);
+	infile.createLinesFromTokens();
+	return true;
+}
+
+
+
 /////////////////////////////
 //
 // Tool_dissonant::adjustColorization -- The dissonance analysis will color the
@@ -505,7 +617,7 @@ void Tool_dissonant::addLabelToSuspensions(HTp disslabel, const string& marker)
 //
 
 void Tool_dissonant::suppressDissonances(HumdrumFile& infile, NoteGrid& grid,
-		vector<vector<NoteCell*>>& attacks, vector<vector<string>>& results) {
+		vector<vector<NoteCell*>>& attacks, vector<vector<int>>& results) {
 
 	// Loop over the dissonance results one full row at a time. The point of doing it
 	// one row at a time instead of one voice at a time is so that a weak dissonance in
@@ -543,30 +655,30 @@ void Tool_dissonant::suppressDissonances(HumdrumFile& infile, NoteGrid& grid,
 				continue;
 			}
 			int v = kernTrackToVoiceIndex.at(token->getTrack());
-			if (results[v][i].empty() || (results[v][i] == ".")) {
+			if ((results[v][i] == NO_LABEL) || (results[v][i] == NULL_LABEL)) {
 				continue;
 			}
 			// cerr << "\tCHECKING DISSONANCE " << results[v][i] << " for note " << token << endl;
 			HumNum notedur = token->getTiedDuration();
 
-			if ((results[v][i] == m_labels[PASSING_DOWN]) ||
-					(results[v][i] == m_labels[PASSING_UP]) ||
-					(results[v][i] == m_labels[NEIGHBOR_DOWN]) ||
-					(results[v][i] == m_labels[NEIGHBOR_UP]) ||
-					(results[v][i] == m_labels[CAMBIATA_DOWN_S]) ||
-					(results[v][i] == m_labels[CAMBIATA_UP_S]) ||
-					(results[v][i] == m_labels[CAMBIATA_DOWN_L]) ||
-					(results[v][i] == m_labels[CAMBIATA_UP_L]) ||
-					(results[v][i] == m_labels[ECHAPPEE_DOWN]) ||
-					(results[v][i] == m_labels[ECHAPPEE_UP]) ||
-					(results[v][i] == m_labels[ANT_DOWN]) ||
-					(results[v][i] == m_labels[ANT_UP]) ||
-					(results[v][i] == m_labels[REV_ECHAPPEE_DOWN]) ||
-					(results[v][i] == m_labels[REV_ECHAPPEE_UP]) ||
-					(results[v][i] == m_labels[REV_CAMBIATA_DOWN]) ||
-					(results[v][i] == m_labels[REV_CAMBIATA_UP]) ||
-					(results[v][i] == m_labels[DBL_NEIGHBOR_DOWN]) ||
-					(results[v][i] == m_labels[DBL_NEIGHBOR_UP]) ) {
+			if ((results[v][i] == m_labelcodes[PASSING_DOWN]) ||
+					(results[v][i] == m_labelcodes[PASSING_UP]) ||
+					(results[v][i] == m_labelcodes[NEIGHBOR_DOWN]) ||
+					(results[v][i] == m_labelcodes[NEIGHBOR_UP]) ||
+					(results[v][i] == m_labelcodes[CAMBIATA_DOWN_S]) ||
+					(results[v][i] == m_labelcodes[CAMBIATA_UP_S]) ||
+					(results[v][i] == m_labelcodes[CAMBIATA_DOWN_L]) ||
+					(results[v][i] == m_labelcodes[CAMBIATA_UP_L]) ||
+					(results[v][i] == m_labelcodes[ECHAPPEE_DOWN]) ||
+					(results[v][i] == m_labelcodes[ECHAPPEE_UP]) ||
+					(results[v][i] == m_labelcodes[ANT_DOWN]) ||
+					(results[v][i] == m_labelcodes[ANT_UP]) ||
+					(results[v][i] == m_labelcodes[REV_ECHAPPEE_DOWN]) ||
+					(results[v][i] == m_labelcodes[REV_ECHAPPEE_UP]) ||
+					(results[v][i] == m_labelcodes[REV_CAMBIATA_DOWN]) ||
+					(results[v][i] == m_labelcodes[REV_CAMBIATA_UP]) ||
+					(results[v][i] == m_labelcodes[DBL_NEIGHBOR_DOWN]) ||
+					(results[v][i] == m_labelcodes[DBL_NEIGHBOR_UP]) ) {
 				if (notedur > maxWeakDur) {
 					maxWeakDur = notedur;
 					maxToken = token;
@@ -595,14 +707,14 @@ void Tool_dissonant::suppressDissonances(HumdrumFile& infile, NoteGrid& grid,
 				continue;
 			}
 			int v = kernTrackToVoiceIndex.at(token->getTrack());
-			if (results[v][i].empty() || (results[v][i] == ".")) {
+			if ((results[v][i] == NO_LABEL) || (results[v][i] == NULL_LABEL)) {
 				continue;
 			}
 			HumNum notedur = token->getTiedDuration();
-			if ((results[v][i] == m_labels[SUS_BIN]) ||
-					(results[v][i] == m_labels[SUS_TERN]) ||
-					(results[v][i] == m_labels[AGENT_BIN]) ||
-					(results[v][i] == m_labels[AGENT_TERN])) {
+			if ((results[v][i] == m_labelcodes[SUS_BIN]) ||
+					(results[v][i] == m_labelcodes[SUS_TERN]) ||
+					(results[v][i] == m_labelcodes[AGENT_BIN]) ||
+					(results[v][i] == m_labelcodes[AGENT_TERN])) {
 				continue;
 			} else if (notedur <= maxWeakDur) {
 				mergeWithPreviousNote(infile, i, j);
@@ -628,12 +740,12 @@ void Tool_dissonant::suppressDissonances(HumdrumFile& infile, NoteGrid& grid,
 
 void Tool_dissonant::suppressDissonancesInVoice(HumdrumFile& infile,
 		NoteGrid& grid, int vindex, vector<NoteCell*>& attacks,
-		vector<string>& results) {
+		vector<int>& results) {
 
 	for (int i=0; i<(int)attacks.size(); i++) {
 		int lineindex = attacks[i]->getLineIndex();
 		int fieldindex = attacks[i]->getFieldIndex();
-		if ((results[lineindex] == "") || (results[lineindex] == ".") ) {
+		if ((results[lineindex] == NO_LABEL) || (results[lineindex] == NULL_LABEL) ) {
 			continue;
 		}
 
@@ -647,21 +759,21 @@ void Tool_dissonant::suppressDissonancesInVoice(HumdrumFile& infile,
 			continue;
 		}
 
-		if ((results[lineindex] == m_labels[THIRD_Q_PASS_UP]) ||
-			(results[lineindex] == m_labels[THIRD_Q_PASS_DOWN]) ||
-			(results[lineindex] == m_labels[THIRD_Q_LOWER_NEI]) ||
-			(results[lineindex] == m_labels[THIRD_Q_UPPER_NEI]) ||
-			(results[lineindex] == m_labels[ACC_PASSING_UP]) ||
-			(results[lineindex] == m_labels[ACC_PASSING_DOWN]) ||
-			(results[lineindex] == m_labels[ACC_LO_NEI]) ||
-			(results[lineindex] == m_labels[ACC_UP_NEI]) ||
-			(results[lineindex] == m_labels[RES_PITCH]) ||
-			(results[lineindex] == m_labels[APP_UPPER]) ||
-			(results[lineindex] == m_labels[APP_LOWER]) ||
-			(results[lineindex] == m_labels[PARALLEL_DOWN]) ||
-			(results[lineindex] == m_labels[PARALLEL_UP]) ||
-			(results[lineindex] == m_labels[ORNAMENTAL_SUS]) ||
-			(results[lineindex] == m_labels[CHANSON_IDIOM]) ) {
+		if ((results[lineindex] == m_labelcodes[THIRD_Q_PASS_UP]) ||
+			(results[lineindex] == m_labelcodes[THIRD_Q_PASS_DOWN]) ||
+			(results[lineindex] == m_labelcodes[THIRD_Q_LOWER_NEI]) ||
+			(results[lineindex] == m_labelcodes[THIRD_Q_UPPER_NEI]) ||
+			(results[lineindex] == m_labelcodes[ACC_PASSING_UP]) ||
+			(results[lineindex] == m_labelcodes[ACC_PASSING_DOWN]) ||
+			(results[lineindex] == m_labelcodes[ACC_LO_NEI]) ||
+			(results[lineindex] == m_labelcodes[ACC_UP_NEI]) ||
+			(results[lineindex] == m_labelcodes[RES_PITCH]) ||
+			(results[lineindex] == m_labelcodes[APP_UPPER]) ||
+			(results[lineindex] == m_labelcodes[APP_LOWER]) ||
+			(results[lineindex] == m_labelcodes[PARALLEL_DOWN]) ||
+			(results[lineindex] == m_labelcodes[PARALLEL_UP]) ||
+			(results[lineindex] == m_labelcodes[ORNAMENTAL_SUS]) ||
+			(results[lineindex] == m_labelcodes[CHANSON_IDIOM]) ) {
 			// cerr << "MERGING " << token << " with next note" << endl;
 			mergeWithNextNote(infile, lineindex, fieldindex);
 		}
@@ -677,12 +789,12 @@ void Tool_dissonant::suppressDissonancesInVoice(HumdrumFile& infile,
 
 void Tool_dissonant::suppressSusOrnamentsInVoice(HumdrumFile& infile,
 		NoteGrid& grid, int vindex, vector<NoteCell*>& attacks,
-		vector<string>& results) {
+		vector<int>& results) {
 
 	for (int i=0; i<(int)attacks.size(); i++) {
 		int lineindex = attacks[i]->getLineIndex();
 		int fieldindex = attacks[i]->getFieldIndex();
-		if ((results[lineindex] == "") || (results[lineindex] == ".") ) {
+		if ((results[lineindex] == NO_LABEL) || (results[lineindex] == NULL_LABEL) ) {
 			continue;
 		}
 
@@ -696,8 +808,8 @@ void Tool_dissonant::suppressSusOrnamentsInVoice(HumdrumFile& infile,
 			continue;
 		}
 
-		if (((results[lineindex] == m_labels[SUS_BIN]) ||
-			 (results[lineindex] == m_labels[SUS_TERN])) &&
+		if (((results[lineindex] == m_labelcodes[SUS_BIN]) ||
+			 (results[lineindex] == m_labelcodes[SUS_TERN])) &&
 			(i < ((int)attacks.size() - 3)) ) {
 			HumNum durn   = attacks[i+1]->getDuration();
 			HumNum durnn  = attacks[i+2]->getDuration();
@@ -717,23 +829,23 @@ void Tool_dissonant::suppressSusOrnamentsInVoice(HumdrumFile& infile,
 
 			if ((durn == durnn) && (durn < durnnn) && (levn > levnnn) &&
 				(intn == -1) && (intnn == -1) && (intnnn == 1) ) { // turn figure anticipation of resolution phase
-				if ((results[lineindexnn] == ".") && (!tokennn->isNull()) &&
+				if ((results[lineindexnn] == NULL_LABEL) && (!tokennn->isNull()) &&
 					(tokennn->isNoteAttack()) ) {
 					mergeWithPreviousNote(infile, lineindexnn, vindex);
 				}
-				if ((results[lineindexn] == ".") && (!tokenn->isNull()) &&
+				if ((results[lineindexn] == NULL_LABEL) && (!tokenn->isNull()) &&
 					(tokenn->isNoteAttack()) ) {
 					mergeWithPreviousNote(infile, lineindexn, vindex);
 				}
 			} else if ((durn == durnn) && (durn == durnnn) && (levn > levnn) &&
 				(levnn < levnnn) && (intn == -1) && (intnn == 0) &&
-				(intnnn == -1) && (results[lineindexnnn] == ".") &&
+				(intnnn == -1) && (results[lineindexnnn] == NULL_LABEL) &&
 				(!tokennnn->isNull()) && (tokennnn->isNoteAttack()) ) { // Du Fay ornament
 				mergeWithPreviousNote(infile, lineindexnnn, vindex);
 			}
 		}
-		if (((results[lineindex] == m_labels[SUS_BIN]) ||
-			 (results[lineindex] == m_labels[SUS_TERN])) &&
+		if (((results[lineindex] == m_labelcodes[SUS_BIN]) ||
+			 (results[lineindex] == m_labelcodes[SUS_TERN])) &&
 			(i < ((int)attacks.size() - 2)) ) {
 			HumNum durn  = attacks[i+1]->getDuration();
 			HumNum durnn = attacks[i+2]->getDuration();
@@ -745,7 +857,7 @@ void Tool_dissonant::suppressSusOrnamentsInVoice(HumdrumFile& infile,
 			HTp tokenn = infile.token(lineindexn, fieldindex);
 
 			if ((durn <= durnn) && (levn >= levnn) && (intn == -1) &&
-				(intnn == 0) && (results[lineindexn] == ".") &&
+				(intnn == 0) && (results[lineindexn] == NULL_LABEL) &&
 				(!tokenn->isNull()) && (tokenn->isNoteAttack()) ) { // anticipation of resolution phase
 				mergeWithPreviousNote(infile, lineindexn, vindex);
 			}
@@ -1176,7 +1288,7 @@ void Tool_dissonant::printColorLegend(HumdrumFile& infile) {
 // Tool_dissonant::doAnalysis -- do a basic melodic analysis of all parts.
 //
 
-void Tool_dissonant::doAnalysis(vector<vector<string>>& results,
+void Tool_dissonant::doAnalysis(vector<vector<int>>& results,
 		NoteGrid& grid, vector<vector<NoteCell*>>& attacks, bool debug) {
 	attacks.resize(grid.getVoiceCount());
 
@@ -1210,7 +1322,7 @@ void Tool_dissonant::doAnalysis(vector<vector<string>>& results,
 //     subtracting NoteCells to calculate the diatonic intervals.
 //
 
-void Tool_dissonant::doAnalysisForVoice(vector<vector<string>>& results,
+void Tool_dissonant::doAnalysisForVoice(vector<vector<int>>& results,
 		NoteGrid& grid, vector<NoteCell*>& attacks, int vindex, bool debug) {
 	attacks.clear();
 	grid.getNoteAndRestAttacks(attacks, vindex);
@@ -1250,7 +1362,7 @@ void Tool_dissonant::doAnalysisForVoice(vector<vector<string>>& results,
 	bool dissonant;    // true if  note is dissonant with other sounding notes.
 	char marking = '\0';
 	int ovoiceindex = -1;
-	string unexp_label; // default dissonance label if none of the diss types apply
+	int unexp_label = NO_LABEL; // default dissonance label if none of the diss types apply
 	int refMeterNum;    // the numerator of the reference voice's notated time signature
 	HumNum refMeterDen; // the denominator of the reference voice's notated time signature
 	int othMeterNum;    // the numerator of the other voice's notated time signature
@@ -1324,7 +1436,7 @@ RECONSIDER:
 				dissonant = true;
 				diss2Q = true;
 				marking = '@';
-				unexp_label = m_labels[UNLABELED_Z2];
+				unexp_label = m_labelcodes[UNLABELED_Z2];
 				ovoiceindex = j;
 				oattackindexn = getNextPitchAttackIndex(grid, ovoiceindex, sliceindex);
 				break;
@@ -1333,7 +1445,7 @@ RECONSIDER:
 				dissonant = true;
 				diss7Q = true;
 				marking = '+';
-				unexp_label = m_labels[UNLABELED_Z7];
+				unexp_label = m_labelcodes[UNLABELED_Z7];
 				ovoiceindex = j;
 				oattackindexn = getNextPitchAttackIndex(grid, ovoiceindex, sliceindex);
 				break;
@@ -1349,7 +1461,7 @@ RECONSIDER:
 				dissonant = true;
 				diss4Q = true;
 				marking = 'N';
-				unexp_label = m_labels[UNLABELED_Z4];
+				unexp_label = m_labelcodes[UNLABELED_Z4];
 				// ovoiceindex = lowestnotei;
 				ovoiceindex = j;
 				// oattackindexn = grid.cell(ovoiceindex, sliceindex)->getNextAttackIndex();
@@ -1369,7 +1481,7 @@ RECONSIDER:
 				marking = 'N';
 				ovoiceindex = lowestnotei;
 				oattackindexn = grid.cell(ovoiceindex, sliceindex)->getNextAttackIndex();
-				unexp_label = m_labels[UNLABELED_Z4];
+				unexp_label = m_labelcodes[UNLABELED_Z4];
 			}
 		}
 */
@@ -1527,10 +1639,10 @@ RECONSIDER:
 
 		ternAgent = false;
 		if (((othMeterNum % 3 == 0) && (odur >= othMeterDen)) && // the durational value of the meter's denominator groups in threes and the sus lasts at least as long as the denominator
-			(results[ovoiceindex][lineindex] != m_labels[SUS_BIN]) && // the other voice hasn't already been labeled as a binary suspension
+			(results[ovoiceindex][lineindex] != m_labelcodes[SUS_BIN]) && // the other voice hasn't already been labeled as a binary suspension
 			((dur == othMeterDen*2) || // the ref note lasts 2 times as long as the meter's denominator
 			 ((dur == othMeterDen*threehalves) && ((intn == 0) || (intn == -1))) || // ref note lasts 1.5 times the meter's denominator and next note is a tenorizans ornament
-			 ((dur == othMeterDen*threehalves) && ((unexp_label == m_labels[UNLABELED_Z4]) || (intn == 3))) || // 4-3 susp where agent leaps to diatonic pitch class of resolution
+			 ((dur == othMeterDen*threehalves) && ((unexp_label == m_labelcodes[UNLABELED_Z4]) || (intn == 3))) || // 4-3 susp where agent leaps to diatonic pitch class of resolution
 			 ((dur == sixteenthirds) && (refMeterNum == 3) && (refMeterDen == threehalves)) || // special case for 3/3 time signature
 			 ((odur == othMeterDen*threehalves) && (ointn == -1) && (odurn == 2) && (ointnn == 0)) || // change of agent suspension with ant of resolution
 			 ((dur == othMeterDen) && (odur == othMeterDen*2)) || // unornamented change of agent suspension
@@ -1549,63 +1661,63 @@ RECONSIDER:
 			(dur <= durp) && (condition2 || condition2b) && valid_acc_exit) { // weak dissonances
 			if (intp == -1) { // descending dissonances
 				if (intn == -1) { // downward passing tone
-					results[vindex][lineindex] = m_labels[PASSING_DOWN];
+					results[vindex][lineindex] = m_labelcodes[PASSING_DOWN];
 				} else if (intn == 1) { // lower neighbor
-					results[vindex][lineindex] = m_labels[NEIGHBOR_DOWN];
+					results[vindex][lineindex] = m_labelcodes[NEIGHBOR_DOWN];
 				} else if ((intn == 0) && (dur <= 2)) { // descending anticipation
-					results[vindex][lineindex] = m_labels[ANT_DOWN];
+					results[vindex][lineindex] = m_labelcodes[ANT_DOWN];
 				} else if (intn > 1) { // lower échappée
-					results[vindex][lineindex] = m_labels[ECHAPPEE_DOWN];
+					results[vindex][lineindex] = m_labelcodes[ECHAPPEE_DOWN];
 				} else if (intn < -1) { // descending short nota cambiata
-					results[vindex][lineindex] = m_labels[CAMBIATA_DOWN_S];
+					results[vindex][lineindex] = m_labelcodes[CAMBIATA_DOWN_S];
 				}
 			} else if (intp == 1) { // ascending dissonances
 				if (intn == 1) { // rising passing tone
-					results[vindex][lineindex] = m_labels[PASSING_UP];
+					results[vindex][lineindex] = m_labelcodes[PASSING_UP];
 				} else if (intn == -1) { // upper neighbor
-					results[vindex][lineindex] = m_labels[NEIGHBOR_UP];
+					results[vindex][lineindex] = m_labelcodes[NEIGHBOR_UP];
 				} else if (intn < -1) { // upper échappée
-					results[vindex][lineindex] = m_labels[ECHAPPEE_UP];
+					results[vindex][lineindex] = m_labelcodes[ECHAPPEE_UP];
 				} else if ((intn == 0) && (dur <= 2)) { // rising anticipation
-					results[vindex][lineindex] = m_labels[ANT_UP];
+					results[vindex][lineindex] = m_labelcodes[ANT_UP];
 				} else if (intn > 1) { // ascending short nota cambiata
-					results[vindex][lineindex] = m_labels[CAMBIATA_UP_S];
+					results[vindex][lineindex] = m_labelcodes[CAMBIATA_UP_S];
 				}
 			} else if (intp < -1) {
 				if (intn == 1) { // reverse lower échappée
-					results[vindex][lineindex] = m_labels[REV_ECHAPPEE_DOWN];
+					results[vindex][lineindex] = m_labelcodes[REV_ECHAPPEE_DOWN];
 				} else if (intn == -1) { // reverse descending nota cambiata
-					results[vindex][lineindex] = m_labels[REV_CAMBIATA_DOWN];
+					results[vindex][lineindex] = m_labelcodes[REV_CAMBIATA_DOWN];
 				}
 			} else if (intp > 1) {
 				if (intn == -1) { // reverse upper échappée
-					results[vindex][lineindex] = m_labels[REV_ECHAPPEE_UP];
+					results[vindex][lineindex] = m_labelcodes[REV_ECHAPPEE_UP];
 				} else if (intn == 1) { // reverse ascending nota cambiata
-					results[vindex][lineindex] = m_labels[REV_CAMBIATA_UP];
+					results[vindex][lineindex] = m_labelcodes[REV_CAMBIATA_UP];
 				}
 			}
 		} else if ((durp >= 2) && (dur == 1) && (lev < levn) && valid_acc_exit &&
 					 (condition2 || condition2b) && (lev == 1)) {
 			if (intp == -1) {
 				if (intn == -1) { // dissonant third quarter descending passing tone
-					results[vindex][lineindex] = m_labels[THIRD_Q_PASS_DOWN];
+					results[vindex][lineindex] = m_labelcodes[THIRD_Q_PASS_DOWN];
 				} else if (intn == 1) { // dissonant third quarter lower neighbor
-					results[vindex][lineindex] = m_labels[THIRD_Q_LOWER_NEI];
+					results[vindex][lineindex] = m_labelcodes[THIRD_Q_LOWER_NEI];
 				}
 			} else if (intp == 1) {
 				if (intn == 1) { // dissonant third quarter ascending passing tone
-					results[vindex][lineindex] = m_labels[THIRD_Q_PASS_UP];
+					results[vindex][lineindex] = m_labelcodes[THIRD_Q_PASS_UP];
 				} else if (intn == -1) { // dissonant third quarter upper neighbor
-					results[vindex][lineindex] = m_labels[THIRD_Q_UPPER_NEI];
+					results[vindex][lineindex] = m_labelcodes[THIRD_Q_UPPER_NEI];
 				}
 			}
 		} else if (((lev > levp) || (durp+durp+durp+durp == dur)) &&
 				   (lev == levn) && condition2 && (intn == -1) &&
 				   (dur == (durn+durn)) && ((dur+dur) <= odur)) {
 			if (fabs(intp) > 1.0) {
-				results[vindex][lineindex] = m_labels[SUS_NO_AGENT_LEAP];
+				results[vindex][lineindex] = m_labelcodes[SUS_NO_AGENT_LEAP];
 			} else if ((fabs(intp) == 1.0) || ((intp == 0) && (fabs(intpp) == 1.0))) {
-				results[vindex][lineindex] = m_labels[SUS_NO_AGENT_STEP];
+				results[vindex][lineindex] = m_labelcodes[SUS_NO_AGENT_STEP];
 			}
 		}
 
@@ -1616,54 +1728,54 @@ RECONSIDER:
 
 		else if (valid_sus_acc && ((ointn == -1) || ((ointn == -2) && (ointnn == 1)))) {
 			if ((durpp == 1) && (durp == 1) && (intpp == -1) && (intp == 1) &&
-					((results[vindex][lineindexpp] == m_labels[THIRD_Q_PASS_DOWN]) ||
-					(results[vindex][lineindexpp] == m_labels[ACC_PASSING_DOWN]) ||
-					(results[vindex][lineindexpp] == m_labels[UNLABELED_Z7]) ||
-					(results[vindex][lineindexpp] == m_labels[UNLABELED_Z4]))) {
-				results[vindex][lineindexpp] = m_labels[CHANSON_IDIOM];
+					((results[vindex][lineindexpp] == m_labelcodes[THIRD_Q_PASS_DOWN]) ||
+					(results[vindex][lineindexpp] == m_labelcodes[ACC_PASSING_DOWN]) ||
+					(results[vindex][lineindexpp] == m_labelcodes[UNLABELED_Z7]) ||
+					(results[vindex][lineindexpp] == m_labelcodes[UNLABELED_Z4]))) {
+				results[vindex][lineindexpp] = m_labelcodes[CHANSON_IDIOM];
 			}
 			if (ternAgent) { // ternary agent and suspension
-				results[vindex][lineindex] = m_labels[AGENT_TERN];
-				results[ovoiceindex][lineindex] = m_labels[SUS_TERN];
+				results[vindex][lineindex] = m_labelcodes[AGENT_TERN];
+				results[ovoiceindex][lineindex] = m_labelcodes[SUS_TERN];
 			} else if (((odur == .5) || (odur == 1)) && // purely ornamental suspension
 						((odurn == .5) || (odurn == 1)) &&
 						(ointn == -1) && (ointnn == -1) ) {
-				results[vindex][lineindex] = m_labels[AGENT_BIN];
-				results[ovoiceindex][lineindex] = m_labels[ORNAMENTAL_SUS];
+				results[vindex][lineindex] = m_labelcodes[AGENT_BIN];
+				results[ovoiceindex][lineindex] = m_labelcodes[ORNAMENTAL_SUS];
 			} else { // binary agent and suspension
-				results[vindex][lineindex] = m_labels[AGENT_BIN];
-				results[ovoiceindex][lineindex] = m_labels[SUS_BIN];
+				results[vindex][lineindex] = m_labelcodes[AGENT_BIN];
+				results[ovoiceindex][lineindex] = m_labelcodes[SUS_BIN];
 			}
 		} else if (valid_ornam_sus_acc && ((ointn == 0) && (ointnn == -1))) {
 			if ((durpp == 1) && (durp == 1) && (intpp == -1) && (intp == 1) &&
-					((results[vindex][lineindexpp] == m_labels[THIRD_Q_PASS_DOWN]) ||
-					(results[vindex][lineindexpp] == m_labels[ACC_PASSING_DOWN]) ||
-					(results[vindex][lineindexpp] == m_labels[UNLABELED_Z7]) ||
-					(results[vindex][lineindexpp] == m_labels[UNLABELED_Z4]))) {
-				results[vindex][lineindexpp] = m_labels[CHANSON_IDIOM];
+					((results[vindex][lineindexpp] == m_labelcodes[THIRD_Q_PASS_DOWN]) ||
+					(results[vindex][lineindexpp] == m_labelcodes[ACC_PASSING_DOWN]) ||
+					(results[vindex][lineindexpp] == m_labelcodes[UNLABELED_Z7]) ||
+					(results[vindex][lineindexpp] == m_labelcodes[UNLABELED_Z4]))) {
+				results[vindex][lineindexpp] = m_labelcodes[CHANSON_IDIOM];
 			}
 			if (ternAgent) { // ternary agent and suspension
-				results[vindex][lineindex] = m_labels[AGENT_TERN];
-				results[ovoiceindex][lineindex] = m_labels[SUS_TERN];
+				results[vindex][lineindex] = m_labelcodes[AGENT_TERN];
+				results[ovoiceindex][lineindex] = m_labelcodes[SUS_TERN];
 			} else { // binary agent and suspension
-				results[vindex][lineindex] = m_labels[AGENT_BIN];
-				results[ovoiceindex][lineindex] = m_labels[SUS_BIN];
+				results[vindex][lineindex] = m_labelcodes[AGENT_BIN];
+				results[ovoiceindex][lineindex] = m_labelcodes[SUS_BIN];
 			} // repeated-note of suspension
-			results[ovoiceindex][olineindexn] = m_labels[SUSPENSION_REP];
+			results[ovoiceindex][olineindexn] = m_labelcodes[SUSPENSION_REP];
 		} else if (valid_ornam_sus_acc && ((ointn == 1) && (ointnn == -2))) {
 			if ((durpp == 1) && (durp == 1) && (intpp == -1) && (intp == 1) &&
-					((results[vindex][lineindexpp] == m_labels[THIRD_Q_PASS_DOWN]) ||
-					(results[vindex][lineindexpp] == m_labels[ACC_PASSING_DOWN]) ||
-					(results[vindex][lineindexpp] == m_labels[UNLABELED_Z7]) ||
-					(results[vindex][lineindexpp] == m_labels[UNLABELED_Z4]))) {
-				results[vindex][lineindexpp] = m_labels[CHANSON_IDIOM];
+					((results[vindex][lineindexpp] == m_labelcodes[THIRD_Q_PASS_DOWN]) ||
+					(results[vindex][lineindexpp] == m_labelcodes[ACC_PASSING_DOWN]) ||
+					(results[vindex][lineindexpp] == m_labelcodes[UNLABELED_Z7]) ||
+					(results[vindex][lineindexpp] == m_labelcodes[UNLABELED_Z4]))) {
+				results[vindex][lineindexpp] = m_labelcodes[CHANSON_IDIOM];
 			}
 			if (ternAgent) { // ternary agent and suspension
-				results[vindex][lineindex] = m_labels[AGENT_TERN];
-				results[ovoiceindex][lineindex] = m_labels[SUS_TERN];
+				results[vindex][lineindex] = m_labelcodes[AGENT_TERN];
+				results[ovoiceindex][lineindex] = m_labelcodes[SUS_TERN];
 			} else { // binary agent and suspension
-				results[vindex][lineindex] = m_labels[AGENT_BIN];
-				results[ovoiceindex][lineindex] = m_labels[SUS_BIN];
+				results[vindex][lineindex] = m_labelcodes[AGENT_BIN];
+				results[ovoiceindex][lineindex] = m_labelcodes[SUS_BIN];
 			} // This ornament is consonant against the agent so no ornament label.
 		}
 
@@ -1677,10 +1789,10 @@ RECONSIDER:
 
 			if ((dur <= durp) && (lev >= levp) && (lev >= levn) &&
 					(intp == -1) && (intn == -2) && (intnn == 1)) { // long-form descending cambiata
-				results[vindex][lineindex] = m_labels[CAMBIATA_DOWN_L];
+				results[vindex][lineindex] = m_labelcodes[CAMBIATA_DOWN_L];
 			} else if ((dur <= durp) && (lev >= levp) && (lev >= levn) &&
 					(intp == 1) && (intn == 2) && (intnn == -1)) { // long-form ascending nota cambiata
-				results[vindex][lineindex] = m_labels[CAMBIATA_UP_L];
+				results[vindex][lineindex] = m_labelcodes[CAMBIATA_UP_L];
 			}
 		}
 
@@ -1691,7 +1803,7 @@ RECONSIDER:
 		bool refLeaptFrom = fabs(intn) > 1 ? true : false;
 		bool othLeaptFrom = fabs(ointn) > 1 ? true : false;
 
-		if ((results[vindex][lineindex] == "") && // this voice doesn't already have a dissonance label
+		if ((results[vindex][lineindex] == NO_LABEL) && // this voice doesn't already have a dissonance label
 				((olineindexc < lineindex) || // other voice does not attack at this point
 				((olineindexc == lineindex) && (dur < odur)) || // both voices attack together, but ref voice leaves dissonance first
 				(((olineindexc == lineindex) && (dur == odur)) && // both voices enter and leave dissonance simultaneously
@@ -1709,10 +1821,10 @@ RECONSIDER:
 		// against another note with which it might have a known dissonant function.
 		// Also go back if this voice was identified as an agent, because it may be
 		// the agent of multiple patients.
-		if ((results[vindex][lineindex] == m_labels[UNLABELED_Z4]) ||
-				(results[vindex][lineindex] == m_labels[UNLABELED_Z7]) ||
-				(results[vindex][lineindex] == m_labels[AGENT_BIN]) ||
-				(results[vindex][lineindex] == m_labels[AGENT_TERN])) {
+		if ((results[vindex][lineindex] == m_labelcodes[UNLABELED_Z4]) ||
+				(results[vindex][lineindex] == m_labelcodes[UNLABELED_Z7]) ||
+				(results[vindex][lineindex] == m_labelcodes[AGENT_BIN]) ||
+				(results[vindex][lineindex] == m_labelcodes[AGENT_TERN])) {
 			if (nextj < (int)harmint.size()) {
 				goto RECONSIDER;
 			}
@@ -1728,7 +1840,7 @@ RECONSIDER:
 // Tool_dissonant::findFakeSuspensions --
 //
 
-void Tool_dissonant::findFakeSuspensions(vector<vector<string>>& results, NoteGrid& grid,
+void Tool_dissonant::findFakeSuspensions(vector<vector<int>>& results, NoteGrid& grid,
 		vector<NoteCell*>& attacks, int vindex) {
 	double intp;        // abs value of diatonic interval from previous melodic note
 	int lineindexn;     // line index of the next note in the voice
@@ -1736,18 +1848,18 @@ void Tool_dissonant::findFakeSuspensions(vector<vector<string>>& results, NoteGr
 
 	for (int i=1; i<(int)attacks.size()-1; i++) {
 		int lineindex = attacks[i]->getLineIndex();
-		if ((results[vindex][lineindex].find("Z") == string::npos) &&
-			(results[vindex][lineindex].find("z") == string::npos) &&
-			(results[vindex][lineindex].find("M") == string::npos) &&
-			(results[vindex][lineindex].find("m") == string::npos)) {
+		if ((results[vindex][lineindex] != m_labelcodes[UNKNOWN_DISSONANCE]) &&
+			(results[vindex][lineindex] != m_labelcodes[UNLABELED_Z4]) &&
+			(results[vindex][lineindex] != m_labelcodes[SUS_NO_AGENT_LEAP]) &&
+			(results[vindex][lineindex] != m_labelcodes[SUS_NO_AGENT_STEP])) {
 			continue;
 		}
 		intp = fabs(*attacks[i] - *attacks[i-1]);
 		lineindexn = attacks[i+1]->getLineIndex();
 		sfound = false;
 		for (int j=lineindex + 1; j<=lineindexn; j++) {
-			if ((results[vindex][j].compare(0, 1, "s") == 0) ||
-					(results[vindex][j].compare(0, 1, "S") == 0)) {
+			if ((results[vindex][j] == m_labelcodes[SUS_BIN]) ||
+					(results[vindex][j] == m_labelcodes[SUS_TERN])) {
 				sfound = true;
 				break;
 			}
@@ -1759,16 +1871,16 @@ void Tool_dissonant::findFakeSuspensions(vector<vector<string>>& results, NoteGr
 		// and sustained through to the beginning of the resolution.
 
 		if (intp == 1) { // Apply labels for normal fake suspensions.
-			results[vindex][lineindex] = m_labels[FAKE_SUSPENSION_STEP];
+			results[vindex][lineindex] = m_labelcodes[FAKE_SUSPENSION_STEP];
 		} else if (intp > 1) {
-			results[vindex][lineindex] = m_labels[FAKE_SUSPENSION_LEAP];
+			results[vindex][lineindex] = m_labelcodes[FAKE_SUSPENSION_LEAP];
 		} else if (i > 1) { // as long as i > 1 intpp will be in range.
 			double intpp = fabs(*attacks[i-1] - *attacks[i-2]);
 			if (intp == 0) { // fake suspensions preceded by an anticipation.
 				if (intpp == 1) {
-					results[vindex][lineindex] = m_labels[FAKE_SUSPENSION_STEP];
+					results[vindex][lineindex] = m_labelcodes[FAKE_SUSPENSION_STEP];
 				} else if (intpp > 1) {
-					results[vindex][lineindex] = m_labels[FAKE_SUSPENSION_LEAP];
+					results[vindex][lineindex] = m_labelcodes[FAKE_SUSPENSION_LEAP];
 				}
 			}
 		}
@@ -1779,7 +1891,7 @@ void Tool_dissonant::findFakeSuspensions(vector<vector<string>>& results, NoteGr
 //
 // Tool_dissonant::findLs --
 //
-void Tool_dissonant::findLs(vector<vector<string>>& results, NoteGrid& grid,
+void Tool_dissonant::findLs(vector<vector<int>>& results, NoteGrid& grid,
 		vector<NoteCell*>& attacks, int vindex) {
 	HumNum dur;        // duration of current note;
 	HumNum odur;       // duration of current note in other voice which may have started earlier;
@@ -1799,8 +1911,8 @@ void Tool_dissonant::findLs(vector<vector<string>>& results, NoteGrid& grid,
 
 	for (int i=1; i<(int)attacks.size()-1; i++) {
 		lineindex = attacks[i]->getLineIndex();
-		if ((results[vindex][lineindex].find("Z") == string::npos) &&
-			(results[vindex][lineindex].find("z") == string::npos)) {
+		if ((results[vindex][lineindex] != m_labelcodes[UNKNOWN_DISSONANCE]) &&
+			(results[vindex][lineindex] != m_labelcodes[UNLABELED_Z4])) {
 			continue;
 		}
 		dur  = attacks[i]->getDuration();
@@ -1812,11 +1924,11 @@ void Tool_dissonant::findLs(vector<vector<string>>& results, NoteGrid& grid,
 			if (vindex == j) { // only compare different voices
 				continue;
 			}
-			if ((results[j][lineindex] == m_labels[AGENT_BIN]) ||
-				(results[j][lineindex] == m_labels[AGENT_TERN]) ||
-				(results[j][lineindex] == m_labels[UNLABELED_Z7]) ||
-				(results[j][lineindex] == m_labels[UNLABELED_Z4]) ||
-				(results[j][lineindex] == "")) {
+			if ((results[j][lineindex] == m_labelcodes[AGENT_BIN]) ||
+				(results[j][lineindex] == m_labelcodes[AGENT_TERN]) ||
+				(results[j][lineindex] == m_labelcodes[UNLABELED_Z7]) ||
+				(results[j][lineindex] == m_labelcodes[UNLABELED_Z4]) ||
+				(results[j][lineindex] == NO_LABEL)) {
 				continue; // skip if other voice is an agent, unexplainable, or empty.
 			}
 			oattackindexc = grid.cell(j, sliceindex)->getCurrAttackIndex();
@@ -1837,10 +1949,10 @@ void Tool_dissonant::findLs(vector<vector<string>>& results, NoteGrid& grid,
 			ointn = opitchn - opitch;
 			if ((intp == ointp) && (intn == ointn)) { // this note moves in parallel with an identifiable dissonance
 				if (intp > 0) {
-					results[vindex][lineindex] = m_labels[PARALLEL_UP];
+					results[vindex][lineindex] = m_labelcodes[PARALLEL_UP];
 					break;
 				} else if (intp < 0) {
-					results[vindex][lineindex] = m_labels[PARALLEL_DOWN];
+					results[vindex][lineindex] = m_labelcodes[PARALLEL_DOWN];
 					break;
 				}
 			}
@@ -1852,7 +1964,7 @@ void Tool_dissonant::findLs(vector<vector<string>>& results, NoteGrid& grid,
 //
 // Tool_dissonant::findYs --
 //
-void Tool_dissonant::findYs(vector<vector<string>>& results, NoteGrid& grid,
+void Tool_dissonant::findYs(vector<vector<int>>& results, NoteGrid& grid,
 		vector<NoteCell*>& attacks, int vindex) {
 	double intp;       // diatonic interval from previous melodic note
 	double intn;       // diatonic interval to next melodic note
@@ -1869,8 +1981,8 @@ void Tool_dissonant::findYs(vector<vector<string>>& results, NoteGrid& grid,
 
 	for (int i=1; i<(int)attacks.size()-1; i++) {
 		lineindex = attacks[i]->getLineIndex();
-		if ((results[vindex][lineindex].find("Z") == string::npos) &&
-			(results[vindex][lineindex].find("z") == string::npos)) {
+		if ((results[vindex][lineindex] != m_labelcodes[UNKNOWN_DISSONANCE]) &&
+			(results[vindex][lineindex] != m_labelcodes[UNLABELED_Z4])) {
 			continue;
 		}
 		intp = *attacks[i] - *attacks[i-1];
@@ -1907,10 +2019,10 @@ void Tool_dissonant::findYs(vector<vector<string>>& results, NoteGrid& grid,
 			}
 
 			if (((thisMod7 == 1) || (thisMod7 == -6)) && // creates 2nd or 7th diss
-				((results[j][lineindex] == m_labels[SUS_BIN]) || // other voice is susp
-				 (results[j][lineindex] == m_labels[SUS_TERN])) &&
+				((results[j][lineindex] == m_labelcodes[SUS_BIN]) || // other voice is susp
+				 (results[j][lineindex] == m_labelcodes[SUS_TERN])) &&
 				(fabs(intp) == 1) && (intn == -1) && valid_acc_exit) {
-				results[vindex][lineindex] = m_labels[RES_PITCH];
+				results[vindex][lineindex] = m_labelcodes[RES_PITCH];
 				onlyWithValids = false;
 			} else if (((abs(thisMod7) == 1) || (abs(thisMod7) == 6)  ||
 					((thisInt > 0) && (thisMod7 == 3) &&
@@ -1919,23 +2031,23 @@ void Tool_dissonant::findYs(vector<vector<string>>& results, NoteGrid& grid,
 					((thisInt < 0) && (thisMod7 == -3) && // a fourth by inversion is -3 and -3%7 = -3.
 					!(((int(opitch-lowestnote) % 7) == 2) ||
 					((int(opitch-lowestnote) % 7) == 4)))) &&
-					((results[j][olineindex] == m_labels[AGENT_BIN]) ||
-					(results[j][olineindex] == m_labels[AGENT_TERN]) ||
-					(results[j][olineindex] == m_labels[UNLABELED_Z7]) ||
-					(results[j][olineindex] == m_labels[UNLABELED_Z4]) ||
-					((results[j][olineindex] == "") &&
-					((results[j][lineindex] != m_labels[SUS_BIN]) &&
-					(results[j][lineindex] != m_labels[SUS_TERN]))))) {
+					((results[j][olineindex] == m_labelcodes[AGENT_BIN]) ||
+					(results[j][olineindex] == m_labelcodes[AGENT_TERN]) ||
+					(results[j][olineindex] == m_labelcodes[UNLABELED_Z7]) ||
+					(results[j][olineindex] == m_labelcodes[UNLABELED_Z4]) ||
+					((results[j][olineindex] == NO_LABEL) &&
+					((results[j][lineindex] != m_labelcodes[SUS_BIN]) &&
+					(results[j][lineindex] != m_labelcodes[SUS_TERN]))))) {
 				onlyWithValids = false;
 			}
 		}
 
-		if (onlyWithValids && ((results[vindex][lineindex] == m_labels[UNLABELED_Z7]) ||
-				(results[vindex][lineindex] == m_labels[UNLABELED_Z4]))) {
+		if (onlyWithValids && ((results[vindex][lineindex] == m_labelcodes[UNLABELED_Z7]) ||
+				(results[vindex][lineindex] == m_labelcodes[UNLABELED_Z4]))) {
 			if (intp > 0) {
-				results[vindex][lineindex] = m_labels[ONLY_WITH_VALID_UP];
+				results[vindex][lineindex] = m_labelcodes[ONLY_WITH_VALID_UP];
 			} else if (intp <= 0) {
-				results[vindex][lineindex] = m_labels[ONLY_WITH_VALID_DOWN];
+				results[vindex][lineindex] = m_labelcodes[ONLY_WITH_VALID_DOWN];
 			}
 		}
 	}
@@ -1945,7 +2057,7 @@ void Tool_dissonant::findYs(vector<vector<string>>& results, NoteGrid& grid,
 //
 // Tool_dissonant::findAppoggiaturas --
 //
-void Tool_dissonant::findAppoggiaturas(vector<vector<string>>& results, NoteGrid& grid,
+void Tool_dissonant::findAppoggiaturas(vector<vector<int>>& results, NoteGrid& grid,
 		vector<NoteCell*>& attacks, int vindex) {
 	HumNum durpp;      // duration of previous previous note
 	HumNum durp;       // duration of previous note
@@ -1969,10 +2081,10 @@ void Tool_dissonant::findAppoggiaturas(vector<vector<string>>& results, NoteGrid
 	for (int i=1; i<(int)attacks.size()-1; i++) {
 		lineindexp = attacks[i-1]->getLineIndex();
 		lineindex = attacks[i]->getLineIndex();
-		if ((results[vindex][lineindex].find("Z") == string::npos) &&
-			(results[vindex][lineindex].find("z") == string::npos) &&
-			(results[vindex][lineindex].find("J") == string::npos) &&
-			(results[vindex][lineindex].find("j") == string::npos)) {
+		if ((results[vindex][lineindex] != m_labelcodes[UNKNOWN_DISSONANCE]) &&
+			(results[vindex][lineindex] != m_labelcodes[UNLABELED_Z4]) &&
+			(results[vindex][lineindex] != m_labelcodes[REV_ECHAPPEE_UP]) &&
+			(results[vindex][lineindex] != m_labelcodes[REV_ECHAPPEE_DOWN])) {
 			continue;
 		}
 		durp = attacks[i-1]->getDuration();
@@ -2040,48 +2152,48 @@ void Tool_dissonant::findAppoggiaturas(vector<vector<string>>& results, NoteGrid
 					((int(opitch-lowestnote) % 7) == 4))))) {
 				continue;
 			} else if (((intp == -1) || ant_down) && ((lev <= levn) && (dur <= durn)) &&
-						((results[vindex][lineindex] == m_labels[UNLABELED_Z7]) ||
-						(results[vindex][lineindex] == m_labels[UNLABELED_Z4]))) {
+						((results[vindex][lineindex] == m_labelcodes[UNLABELED_Z7]) ||
+						(results[vindex][lineindex] == m_labelcodes[UNLABELED_Z4]))) {
 				if (intn == -1) {
-					results[vindex][lineindex] = m_labels[ACC_PASSING_DOWN]; // descending accented passing tone
+					results[vindex][lineindex] = m_labelcodes[ACC_PASSING_DOWN]; // descending accented passing tone
 				} else if (intn == 1) {
-					results[vindex][lineindex] = m_labels[ACC_LO_NEI]; // accented lower neighbor
+					results[vindex][lineindex] = m_labelcodes[ACC_LO_NEI]; // accented lower neighbor
 				}
 			} else if (((intp == 1) || ant_up) && ((lev <= levn) && (dur <= durn)) &&
-						((results[vindex][lineindex] == m_labels[UNLABELED_Z7]) ||
-						(results[vindex][lineindex] == m_labels[UNLABELED_Z4]))) {
+						((results[vindex][lineindex] == m_labelcodes[UNLABELED_Z7]) ||
+						(results[vindex][lineindex] == m_labelcodes[UNLABELED_Z4]))) {
 				if (intn == 1) {
-					results[vindex][lineindex] = m_labels[ACC_PASSING_UP]; // rising accented passing tone
+					results[vindex][lineindex] = m_labelcodes[ACC_PASSING_UP]; // rising accented passing tone
 				} else if (intn == -1) {
-					results[vindex][lineindex] = m_labels[ACC_UP_NEI]; // accented upper neighbor
+					results[vindex][lineindex] = m_labelcodes[ACC_UP_NEI]; // accented upper neighbor
 				}
 			} else if (intn == -1) {
-				if ((intp == 2) && (results[vindex][lineindexp] == m_labels[ECHAPPEE_DOWN]) &&
-					(((results[vindex][lineindex] == m_labels[UNLABELED_Z7]) ||
-						(results[vindex][lineindex] == m_labels[UNLABELED_Z4]) ||
-						(results[vindex][lineindex] == m_labels[REV_ECHAPPEE_UP])) ||
+				if ((intp == 2) && (results[vindex][lineindexp] == m_labelcodes[ECHAPPEE_DOWN]) &&
+					(((results[vindex][lineindex] == m_labelcodes[UNLABELED_Z7]) ||
+						(results[vindex][lineindex] == m_labelcodes[UNLABELED_Z4]) ||
+						(results[vindex][lineindex] == m_labelcodes[REV_ECHAPPEE_UP])) ||
 					 ((lev <= levn) && (dur <= durn)))) {
-					results[vindex][lineindexp] = m_labels[DBL_NEIGHBOR_DOWN];
-					results[vindex][lineindex]  = m_labels[DBL_NEIGHBOR_DOWN];
+					results[vindex][lineindexp] = m_labelcodes[DBL_NEIGHBOR_DOWN];
+					results[vindex][lineindex]  = m_labelcodes[DBL_NEIGHBOR_DOWN];
 				} else if (((fabs(intp) > 1) || ant_leapt_to) &&
 							((lev <= levn) && (dur <= durn)) &&
-							((results[vindex][lineindex] == m_labels[UNLABELED_Z7]) ||
-							(results[vindex][lineindex] == m_labels[UNLABELED_Z4]))) { // upper appoggiatura
-					results[vindex][lineindex] = m_labels[APP_UPPER];
+							((results[vindex][lineindex] == m_labelcodes[UNLABELED_Z7]) ||
+							(results[vindex][lineindex] == m_labelcodes[UNLABELED_Z4]))) { // upper appoggiatura
+					results[vindex][lineindex] = m_labelcodes[APP_UPPER];
 				}
 			} else if (intn == 1) {
-				if ((intp == -2) && (results[vindex][lineindexp] == m_labels[ECHAPPEE_UP]) &&
-					(((results[vindex][lineindex] == m_labels[UNLABELED_Z7]) ||
-						(results[vindex][lineindex] == m_labels[UNLABELED_Z4]) ||
-						(results[vindex][lineindex] == m_labels[REV_ECHAPPEE_DOWN])) ||
+				if ((intp == -2) && (results[vindex][lineindexp] == m_labelcodes[ECHAPPEE_UP]) &&
+					(((results[vindex][lineindex] == m_labelcodes[UNLABELED_Z7]) ||
+						(results[vindex][lineindex] == m_labelcodes[UNLABELED_Z4]) ||
+						(results[vindex][lineindex] == m_labelcodes[REV_ECHAPPEE_DOWN])) ||
 					 ((lev <= levn) && (dur <= durn)))) {
-					results[vindex][lineindexp] = m_labels[DBL_NEIGHBOR_UP];
-					results[vindex][lineindex]  = m_labels[DBL_NEIGHBOR_UP];
+					results[vindex][lineindexp] = m_labelcodes[DBL_NEIGHBOR_UP];
+					results[vindex][lineindex]  = m_labelcodes[DBL_NEIGHBOR_UP];
 				} else if (((fabs(intp) > 1) || ant_leapt_to) &&
 							((lev <= levn) && (dur <= durn)) &&
-							((results[vindex][lineindex] == m_labels[UNLABELED_Z7]) ||
-							(results[vindex][lineindex] == m_labels[UNLABELED_Z4]))) { // lower appoggiatura
-					results[vindex][lineindex] = m_labels[APP_LOWER];
+							((results[vindex][lineindex] == m_labelcodes[UNLABELED_Z7]) ||
+							(results[vindex][lineindex] == m_labelcodes[UNLABELED_Z4]))) { // lower appoggiatura
+					results[vindex][lineindex] = m_labelcodes[APP_LOWER];
 				}
 			}
 		}
@@ -2101,7 +2213,7 @@ void Tool_dissonant::findAppoggiaturas(vector<vector<string>>& results, NoteGrid
 //		Altizans must be found set against any of the other three types for
 //		anything to be detected.
 //
-void Tool_dissonant::findCadentialVoiceFunctions(vector<vector<string>>& results, NoteGrid& grid,
+void Tool_dissonant::findCadentialVoiceFunctions(vector<vector<int>>& results, NoteGrid& grid,
 		vector<NoteCell*>& attacks, vector<vector<string>>& voiceFuncs, int vindex) {
 	double int2;      // diatonic interval to next melodic note
 	double int3 = -22; // diatonic interval from next melodic note to following note
@@ -2132,8 +2244,8 @@ void Tool_dissonant::findCadentialVoiceFunctions(vector<vector<string>>& results
 	for (int i=1; i<(int)attacks.size()-1; i++) {
 		lineindex  = attacks[i]->getLineIndex();
 		// pass over if ref voice is not an agent
-		if ((results[vindex][lineindex] != m_labels[AGENT_BIN]) &&
-			(results[vindex][lineindex] != m_labels[AGENT_TERN])) {
+		if ((results[vindex][lineindex] != m_labelcodes[AGENT_BIN]) &&
+			(results[vindex][lineindex] != m_labelcodes[AGENT_TERN])) {
 			continue;
 		}
 		int2 = *attacks[i+1] - *attacks[i];
@@ -2145,8 +2257,8 @@ void Tool_dissonant::findCadentialVoiceFunctions(vector<vector<string>>& results
 			}
 
 			// skip if other voice isn't a patient
-			if ((results[j][lineindex] != m_labels[SUS_BIN]) &&
-				(results[j][lineindex] != m_labels[SUS_TERN])) {
+			if ((results[j][lineindex] != m_labelcodes[SUS_BIN]) &&
+				(results[j][lineindex] != m_labelcodes[SUS_TERN])) {
 				continue;
 			}
 
@@ -2214,12 +2326,12 @@ void Tool_dissonant::findCadentialVoiceFunctions(vector<vector<string>>& results
 				attInd3  = attacks[i+1]->getNextAttackIndex();
 				lineindex3 = attacks[i+2]->getLineIndex();
 				if (((thisMod7 == 6) || (thisMod7 == -1)) && (int2 == -1) &&
-					(results[vindex][lineindex2] == m_labels[ANT_DOWN]) &&
+					(results[vindex][lineindex2] == m_labelcodes[ANT_DOWN]) &&
 					(attInd3 == oattInd3) && (oint2 == -1) && (oint3 == 1)) {
 					voiceFuncs[j][lineindex3] = "C"; // cantizans
 					voiceFuncs[vindex][lineindex3] = "T"; // tenorizans
 				} else if ((thisMod7 == 3) && (int2 == -1) && (attInd3 == oattInd3) &&
-					(results[vindex][lineindex2] == m_labels[ANT_DOWN]) &&
+					(results[vindex][lineindex2] == m_labelcodes[ANT_DOWN]) &&
 					(oint2 == -1) && (oint3 == 1)) { // "^4xs 1 3sx -2 5xx$"
 					voiceFuncs[j][lineindex3] = "A"; // altizans
 					voiceFuncs[vindex][lineindex3] = "T"; // tenorizans
@@ -2337,22 +2449,21 @@ void Tool_dissonant::findCadentialVoiceFunctions(vector<vector<string>>& results
 // printCountAnalysis --
 //
 
-void Tool_dissonant::printCountAnalysis(vector<vector<string>>& data) {
+void Tool_dissonant::printCountAnalysis(vector<vector<int>>& data) {
 
 	map<string, bool> reduced;
 	bool brief = getBoolean("u");
 	bool percentQ = getBoolean("percent");
 
-	vector<map<string, int>> analysis;
+	vector<vector<int>> analysis;
 	analysis.resize(data.size());
 	int i;
 	int j;
 	for (i=0; i<(int)data.size(); i++) {
+		analysis[i].resize(LABELS_SIZE, 0);
 		for (j=0; j<(int)data[i].size(); j++) {
-			if (analysis[i].find(data[i][j]) != analysis[i].end()) {
+			if (data[i][j] >= 0) {
 				analysis[i][data[i][j]]++;
-			} else {
-				analysis[i][data[i][j]] = 1;
 			}
 		}
 	}
@@ -2369,6 +2480,7 @@ void Tool_dissonant::printCountAnalysis(vector<vector<string>>& data) {
 
 	int sumsum = 0;
 	int sum;
+	int code;
 	string item;
 	for (i=0; i<(int)LABELS_SIZE; i++) {
 		if (i == UNLABELED_Z2) {
@@ -2379,6 +2491,7 @@ void Tool_dissonant::printCountAnalysis(vector<vector<string>>& data) {
 		}
 
 		item = m_labels[i];
+		code = m_labelcodes[i];
 
 		if (brief && (reduced.find(item) != reduced.end())) {
 			continue;
@@ -2387,12 +2500,10 @@ void Tool_dissonant::printCountAnalysis(vector<vector<string>>& data) {
 
 		sum = 0;
 		for (j=0; j<(int)analysis.size(); j++) {
-			if (analysis[j].find(item) != analysis[j].end()) {
-				sum += analysis[j][item];
-				// Don't include agents in dissonant note summation.
-				if ((item != m_labels[AGENT_TERN]) && (item != m_labels[AGENT_BIN])) {
-					sumsum += analysis[j][item];
-				}
+			sum += analysis[j][code];
+			// Don't include agents in dissonant note summation.
+			if ((code != m_labelcodes[AGENT_TERN]) && (code != m_labelcodes[AGENT_BIN])) {
+				sumsum += analysis[j][code];
 			}
 		}
 
@@ -2405,15 +2516,15 @@ void Tool_dissonant::printCountAnalysis(vector<vector<string>>& data) {
 
 		for (int j=0; j<(int)analysis.size(); j++) {
 			m_humdrum_text << "\t";
-			if (analysis[j].find(item) != analysis[j].end()) {
+			if (analysis[j][code] > 0) {
 				if (percentQ) {
-					if ((item == m_labels[AGENT_BIN]) || (item == m_labels[AGENT_TERN])) {
+					if ((code == m_labelcodes[AGENT_BIN]) || (code == m_labelcodes[AGENT_TERN])) {
 						m_humdrum_text << ".";
 					} else {
-						m_humdrum_text << int(analysis[j][item] * 1.0 / sum * 1000.0 + 0.5) / 10.0;
+						m_humdrum_text << int(analysis[j][code] * 1.0 / sum * 1000.0 + 0.5) / 10.0;
 					}
 				} else {
-					m_humdrum_text << analysis[j][item];
+					m_humdrum_text << analysis[j][code];
 				}
 			} else {
 				m_humdrum_text << 0;
@@ -2434,6 +2545,32 @@ void Tool_dissonant::printCountAnalysis(vector<vector<string>>& data) {
 
 
 
+//////////////////////////////
+//
+// Tool_dissonant::getLabelStrings -- Convert the dissonance analysis
+//     from label codes into label text for output.
+//
+
+void Tool_dissonant::getLabelStrings(vector<vector<string>>& labels,
+		vector<vector<int>>& results) {
+	labels.resize(results.size());
+	for (int i=0; i<(int)results.size(); i++) {
+		labels[i].resize(results[i].size());
+		for (int j=0; j<(int)results[i].size(); j++) {
+			int code = results[i][j];
+			if (code >= 0) {
+				labels[i][j] = m_labels[code];
+			} else if (code == NULL_LABEL) {
+				labels[i][j] = ".";
+			} else {
+				labels[i][j] = "";
+			}
+		}
+	}
+}
+
+
+
 //////////////////////////////
 //
 // Tool_dissonant::getNextPitchAttackIndex -- Get the [line] index of the next
@@ -2527,6 +2664,8 @@ void Tool_dissonant::fillLabels(void) {
 	m_labels[UNLABELED_Z2        ] = "Z"; // unknown dissonance, 2nd interval
 	m_labels[UNLABELED_Z7        ] = "Z"; // unknown dissonance, 7th interval
 	m_labels[UNLABELED_Z4        ] = "z"; // unknown dissonance, 4th interval
+
+	fillLabelCodes();
 }
 
 
@@ -2587,6 +2726,32 @@ void Tool_dissonant::fillLabels2(void) {
 	m_labels[UNLABELED_Z2        ] = "Z"; // unknown dissonance, 2nd interval
 	m_labels[UNLABELED_Z7        ] = "Z"; // unknown dissonance, 7th interval
 	m_labels[UNLABELED_Z4        ] = "Z"; // unknown dissonance, 4th interval
+
+	fillLabelCodes();
+}
+
+
+
+//////////////////////////////
+//
+// Tool_dissonant::fillLabelCodes -- The analysis stores dissonance types as
+//     integer codes rather than strings.  Dissonance types which share the
+//     same label text (such as the types merged by --undirected) are given
+//     the code of the first type with that label, so that testing for a
+//     label is an integer comparison.
+//
+
+void Tool_dissonant::fillLabelCodes(void) {
+	m_labelcodes.resize(m_labels.size());
+	for (int i=0; i<(int)m_labels.size(); i++) {
+		m_labelcodes[i] = i;
+		for (int j=0; j<i; j++) {
+			if (m_labels[j] == m_labels[i]) {
+				m_labelcodes[i] = j;
+				break;
+			}
+		}
+	}
 }
 
 
@@ -4,6 +4,7 @@
 // Last Modified: Thu Sep 25 17:47:16 PDT 2003 Minor bug fixes
 // Last Modified: Mon Jun  5 02:44:53 PDT 2017 Convert to STL
 // Last Modified: Ported from Humdrum extras
+// Last Modified: Mon Oct 19 05:44:02 PDT 2026 Parallel song conversion
 // Filename:      tool-esac2hum.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/tool-esac2hum.cpp
 // Syntax:        C++11; humlib
@@ -14,13 +15,17 @@
 
 #include "tool-esac2hum.h"
 #include "Convert.h"
+#include "HumParallel.h"
 
 #include <string.h>
 #include <ctype.h>
 #include <stdio.h>
 #include <math.h>
 
+#include <algorithm>
+#include <chrono>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <vector>
 
@@ -44,6 +49,8 @@ Tool_esac2hum::Tool_esac2hum(void) {
 	define("s|split=s:file",     "Split song info into separate files");
 	define("x|extension=s:.krn", "Split filename extension");
 	define("f|first=i:1",        "Number of first split filename");
+	define("j|threads=i:0",      "Number of songs to convert at the same time");
+	define("report=b",           "Print conversion time and errors for each song");
 	define("author=b",           "author of program");
 	define("version=b",          "compilation info");
 	define("example=b",          "example usages");
@@ -70,16 +77,14 @@ bool Tool_esac2hum::convertFile(ostream& out, const string& filename) {
 
 
 bool Tool_esac2hum::convert(ostream& out, istream& input) {
-	convertEsacToHumdrum(out, input);
-	return true;
+	return convertEsacToHumdrum(out, input);
 }
 
 
 bool Tool_esac2hum::convert(ostream& out, const string& input) {
 	stringstream ss;
 	ss << input;
-	convertEsacToHumdrum(out, ss);
-	return true;
+	return convertEsacToHumdrum(out, ss);
 }
 
 
@@ -132,6 +137,8 @@ bool Tool_esac2hum::initialize(void) {
 	namebase = getString("split");
 	fileextension = getString("extension");
 	firstfilenum = getInteger("first");
+	threads = HumParallel::getThreadCount(getInteger("threads"));
+	reportQ = getBoolean("report");
 	return true;
 }
 
@@ -142,112 +149,200 @@ bool Tool_esac2hum::initialize(void) {
 
 //////////////////////////////
 //
-// Tool_esac2hum::convertEsacToHumdrum --
+// Tool_esac2hum::convertEsacToHumdrum -- Split the input into songs
+//     and then convert the songs, several at a time if more than one
+//     thread is used.  Each group of 16 songs is converted by a separate
+//     copy of the tool.  With the -s option, each song is written to its own file
+//     directly; otherwise, the songs are written to the output in their
+//     input order (directly when using one thread, or after each batch
+//     of songs has been converted).  Errors for a song are stored as
+//     warnings, and false is returned if any song had an error.
 //
 
-void Tool_esac2hum::convertEsacToHumdrum(ostream& output, istream& infile) {
+bool Tool_esac2hum::convertEsacToHumdrum(ostream& output, istream& infile) {
 	initialize();
-	vector<string> song;
-	song.reserve(400);
-	int init = 0;
-	// int filecounter = firstfilenum;
-	string outfilename;
-	string numberstring;
-	// ofstream outfile;
-	while (!infile.eof()) {
-		if (debugQ) {
-			cerr << "Getting a song..." << endl;
-		}
-		getSong(song, infile, init);
-		if (debugQ) {
-			cerr << "Got a song ..." << endl;
-		}
-		init = 1;
-/*
-		if (splitQ) {
-			outfilename = namebase);
-			outfilename += to_string(filecounter);
-			if (filecounter < 1000) {
-				outfilename += "0";
-			}
-			if (filecounter < 100) {
-				outfilename += "0";
-			}
-			if (filecounter < 10) {
-				outfilename += "0";
+	vector<vector<string>> songs;
+	vector<int> songlines;
+	getSongs(songs, songlines, infile);
+
+	int songcount = (int)songs.size();
+	vector<double> times(songcount, 0.0);
+	vector<string> errors(songcount);
+	bool directQ = splitQ || (threads <= 1);
+	int chunksize = 16;
+	int batchsize = directQ ? songcount : threads * chunksize * 4;
+
+	for (int start=0; start<songcount; start+=batchsize) {
+		int count = std::min(batchsize, songcount - start);
+		int chunkcount = (count + chunksize - 1) / chunksize;
+		vector<string> outputs(directQ ? 0 : count);
+		HumParallel::run(chunkcount, threads, [&](int chunk) {
+			// Each chunk of songs is converted with a separate copy of the
+			// tool, since the conversion stores information about the
+			// current song.
+			Tool_esac2hum worker;
+			worker.debugQ = debugQ;
+			worker.verboseQ = verboseQ;
+			worker.header = header;
+			worker.trailer = trailer;
+			int first = chunk * chunksize;
+			int last = std::min(first + chunksize, count);
+			for (int k=first; k<last; k++) {
+				int i = start + k;
+				auto starttime = std::chrono::steady_clock::now();
+				int cutindex = 0;
+				while ((cutindex < (int)songs[i].size()) &&
+						(songs[i][cutindex].compare(0, 4, "CUT[") != 0)) {
+					cutindex++;
+				}
+				worker.inputline = songlines[i] + (int)songs[i].size() - cutindex - 1;
+				worker.m_error_text.str("");
+				bool converted = false;
+				if (splitQ) {
+					stringstream out;
+					converted = worker.convertSong(songs[i], out);
+					string filename = getSplitFilename(i);
+					ofstream outfile;
+					if (converted) {
+						outfile.open(filename);
+					}
+					if (outfile.is_open()) {
+						outfile << out.str();
+					} else if (converted) {
+						worker.m_error_text << "Error: cannot write to file: "
+						                    << filename << endl;
+					}
+				} else if (directQ) {
+					converted = worker.convertSong(songs[i], output);
+				} else {
+					stringstream out;
+					converted = worker.convertSong(songs[i], out);
+					outputs[k] = out.str();
+				}
+				errors[i] = worker.m_error_text.str();
+				if (!converted && errors[i].empty()) {
+					errors[i] = "Error: song could not be converted\n";
+				}
+				times[i] = std::chrono::duration<double, std::milli>(
+						std::chrono::steady_clock::now() - starttime).count();
 			}
-			outfilename += numberstring;
-			outfilename += fileextension;
-			filecounter++;
-
-			outfile.open(outfilename);
+		});
+		for (int k=0; k<(int)outputs.size(); k++) {
+			output << outputs[k];
+		}
+	}
 
-			if (!outfile.is_open()) {
-				cerr << "Error: cannot write to file: " << outfilename << endl;
-			}
-			convertSong(song, outfile);
-			outfile.close();
-		} else {
-*/
-			convertSong(song, output);
-/*
+	bool status = true;
+	for (int i=0; i<songcount; i++) {
+		if (!errors[i].empty()) {
+			status = false;
+			m_warning_text << "Song " << (i+1) << " (input line "
+			               << songlines[i] << "):\n" << errors[i];
 		}
-*/
 	}
+	if (reportQ) {
+		printReport(m_free_text, songs, songlines, times, errors);
+	}
+	return status;
 }
 
 
 
 //////////////////////////////
 //
-// Tool_esac2hum::getSong -- get a song from the ESac file
+// Tool_esac2hum::getSongs -- Split the input data into songs, with each
+//     song starting at a CUT[] line.  Global comments before the first
+//     song are included in the first song.  The input line numbers
+//     (starting at 1) of the first line of each song are stored in
+//     songlines.
 //
 
-bool Tool_esac2hum::getSong(vector<string>& song, istream& infile, int init) {
-	static char holdbuffer[10000] = {0};
+void Tool_esac2hum::getSongs(vector<vector<string>>& songs,
+		vector<int>& songlines, istream& infile) {
+	songs.clear();
+	songlines.clear();
+	vector<string> comments;
+	string line;
+	int linenum = 0;
 
-	song.resize(0);
-	if (init) {
-		// do nothing holdbuffer has the CUT[] information
-	} else {
-		strcpy(holdbuffer, "");
-		while (!infile.eof() && strncmp(holdbuffer, "CUT[", 4) != 0) {
-			infile.getline(holdbuffer, 256, '\n');
-			if (verboseQ) {
-				cerr << "Contents: " << holdbuffer << endl;
-			}
-			if (strncmp(holdbuffer, "!!", 2) == 0) {
-				song.push_back(holdbuffer);
-			}
+	while (getline(infile, line)) {
+		linenum++;
+		if (!line.empty() && (line.back() == '\r')) {
+			line.resize(line.size() - 1);
 		}
-		if (infile.eof()) {
-			return false;
+		if (verboseQ) {
+			cerr << "READ LINE: " << line << endl;
+		}
+		if (line.compare(0, 4, "CUT[") == 0) {
+			songs.emplace_back();
+			songlines.push_back(linenum);
+			if (songs.size() == 1) {
+				songs.back().swap(comments);
+			} else {
+				chopExtraInfo(line);
+			}
+			songs.back().push_back(line);
+		} else if (!songs.empty()) {
+			chopExtraInfo(line);
+			songs.back().push_back(line);
+		} else if (line.compare(0, 2, "!!") == 0) {
+			comments.push_back(line);
 		}
 	}
+}
 
-	if (!infile.eof()) {
-		song.push_back(holdbuffer);
-	} else {
-		return false;
-	}
 
-	infile.getline(holdbuffer, 256, '\n');
-	chopExtraInfo(holdbuffer);
-	inputline++;
-	if (verboseQ) {
-		cerr << "READ LINE: " << holdbuffer << endl;
-	}
-	while (!infile.eof() && strncmp(holdbuffer, "CUT[", 4) != 0) {
-		song.push_back(holdbuffer);
-		infile.getline(holdbuffer, 256, '\n');
-		chopExtraInfo(holdbuffer);
-		inputline++;
-		if (verboseQ) {
-			cerr << "READ ANOTHER LINE: " << holdbuffer << endl;
+
+//////////////////////////////
+//
+// Tool_esac2hum::getSplitFilename -- Return the output filename for a
+//     song when using the -s option: the split name followed by the
+//     song number (at least four digits) and the file extension.
+//
+
+string Tool_esac2hum::getSplitFilename(int index) {
+	stringstream ss;
+	ss << namebase << std::setfill('0') << std::setw(4) << (index + firstfilenum)
+	   << fileextension;
+	return ss.str();
+}
+
+
+
+//////////////////////////////
+//
+// Tool_esac2hum::printReport -- Print the conversion time and status
+//     of each song, followed by a summary line.
+//
+
+void Tool_esac2hum::printReport(ostream& out, vector<vector<string>>& songs,
+		vector<int>& songlines, vector<double>& times,
+		vector<string>& errors) {
+	double total = 0.0;
+	int failures = 0;
+	out << "!!song\tline\tmsec\tstatus\ttitle\n";
+	for (int i=0; i<(int)songs.size(); i++) {
+		string title;
+		for (int j=0; j<(int)songs[i].size(); j++) {
+			if (songs[i][j].compare(0, 4, "CUT[") == 0) {
+				title = songs[i][j].substr(4);
+				if (!title.empty() && (title.back() == ']')) {
+					title.resize(title.size() - 1);
+				}
+				break;
+			}
 		}
+		total += times[i];
+		if (!errors[i].empty()) {
+			failures++;
+		}
+		out << (i+1) << "\t" << songlines[i] << "\t"
+		    << std::fixed << std::setprecision(3) << times[i] << "\t"
+		    << (errors[i].empty() ? "ok" : "error") << "\t"
+		    << title << "\n";
 	}
-
-	return true;
+	out << "!!songs: " << songs.size() << ", errors: " << failures
+	    << ", total msec: " << std::fixed << std::setprecision(3) << total << "\n";
 }
 
 
@@ -257,15 +352,15 @@ bool Tool_esac2hum::getSong(vector<string>& song, istream& infile, int init) {
 // Tool_esac2hum::chopExtraInfo -- remove phrase number information from Luxembourg data.
 //
 
-void Tool_esac2hum::chopExtraInfo(char* holdbuffer) {
-	int length = (int)strlen(holdbuffer);
+void Tool_esac2hum::chopExtraInfo(string& line) {
+	int length = (int)line.size();
 	int i;
 	int spacecount = 0;
 	for (i=length-2; i>=0; i--) {
-		if (holdbuffer[i] == ' ') {
+		if (line[i] == ' ') {
 			spacecount++;
 			if (spacecount > 10) {
-				holdbuffer[i] = '\0';
+				line.resize(i);
 				break;
 			}
 		} else {
@@ -330,25 +425,32 @@ void Tool_esac2hum::printHumdrumFooterInfo(ostream& out, vector<string>& song) {
 
 //////////////////////////////
 //
-// Tool_esac2hum::convertSong --
+// Tool_esac2hum::convertSong -- Convert one song.  Returns false without
+//     printing the song if its KEY[] entry cannot be read, in which case
+//     the error is stored in m_error_text.
 //
 
-void Tool_esac2hum::convertSong(vector<string>& song, ostream& out) {
+bool Tool_esac2hum::convertSong(vector<string>& song, ostream& out) {
 
 	int i;
+	chartable.assign(256, 0);
 	if (verboseQ) {
 		for (i=0; i<(int)song.size(); i++) {
 			out << song[i] << "\n";
 		}
 	}
 
-	printHumdrumHeaderInfo(out, song);
-
 	string key;
 	double mindur = 1.0;
 	string meter;
 	int tonic;
-	getKeyInfo(song, key, mindur, tonic, meter, out);
+	stringstream keywarnings;
+	if (!getKeyInfo(song, key, mindur, tonic, meter, keywarnings)) {
+		return false;
+	}
+
+	printHumdrumHeaderInfo(out, song);
+	out << keywarnings.str();
 
 	vector<NoteData> songdata;
 	songdata.resize(0);
@@ -438,6 +540,8 @@ void Tool_esac2hum::convertSong(vector<string>& song, ostream& out) {
 		out << "\n!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!" << endl;
 	}
 */
+
+	return true;
 }
 
 
@@ -460,7 +564,7 @@ bool Tool_esac2hum::placeLyrics(vector<string>& song, vector<NoteData>& songdata
 	string buffer;
 	for (line=0; line<=stop-start; line++) {
 		if (song[line+start].size() <= 4) {
-			cerr << "Error: lyric line is too short!: "
+			m_error_text << "Error: lyric line is too short!: "
 				  << song[line+start] << endl;
 			return false;
 		}
@@ -620,8 +724,8 @@ bool Tool_esac2hum::placeLyricPhrase(vector<NoteData>& songdata, vector<string>&
 	start = i;
 
 	if (!found) {
-		cerr << "Error: cannot find music for lyrics line " << line << endl;
-		cerr << "Error near input data line: " << inputline << endl;
+		m_error_text << "Error: cannot find music for lyrics line " << line << endl;
+		m_error_text << "Error near input data line: " << inputline << endl;
 		return false;
 	}
 
@@ -750,7 +854,7 @@ bool Tool_esac2hum::printTitleInfo(vector<string>& song, ostream& out) {
 	int stop = -1;
 	getLineRange(song, "CUT", start, stop);
 	if (start == -1) {
-		cerr << "Error: cannot find CUT[] field in song: " << song[0] << endl;
+		m_error_text << "Error: cannot find CUT[] field in song: " << song[0] << endl;
 		return false;
 	}
 
@@ -1256,7 +1360,7 @@ bool Tool_esac2hum::getNoteList(vector<string>& song, vector<NoteData>& songdata
 
 	for (i=melstart; i<=melstop; i++) {
 		if (song[i].size() < 4) {
-			cerr << "Error: invalid line in MEL[]: " << song[i] << endl;
+			m_error_text << "Error: invalid line in MEL[]: " << song[i] << endl;
 			return false;
 		}
 		j = 4;
@@ -1318,7 +1422,7 @@ bool Tool_esac2hum::getNoteList(vector<string>& song, vector<NoteData>& songdata
 //            case '>':                     break;   // unknown marker
 //            case '<':                     break;   //
 				case '^': tie = 1; state = STATE_NOTE; break;
-				default : cerr << "Error: unknown character " << song[i][j]
+				default : m_error_text << "Error: unknown character " << song[i][j]
 							      << " on the line: " << song[i] << endl;
 							 return false;
 			}
@@ -1527,6 +1631,10 @@ bool Tool_esac2hum::getKeyInfo(vector<string>& song, string& key, double& mindur
 	int i;
 	for (i=0; i<(int)song.size(); i++) {
 		if (song[i].compare(0, 4, "KEY[") == 0) {
+			if (song[i].size() < 18) {
+				m_error_text << "Error: KEY field is too short: " << song[i] << endl;
+				return false;
+			}
 			key = song[i][4]; // letter
 			key += song[i][5]; // number
 			key += song[i][6]; // number
@@ -1548,13 +1656,12 @@ bool Tool_esac2hum::getKeyInfo(vector<string>& song, string& key, double& mindur
 
 			string tonicstr;
 			if (song[i][14] != ' ') {
-				tonicstr[0] = song[i][14];
+				tonicstr = song[i][14];
 				if (tolower(song[i][15]) == 'b') {
-					tonicstr[1] = '-';
+					tonicstr += '-';
 				} else {
-					tonicstr[1] = song[i][15];
+					tonicstr += song[i][15];
 				}
-				tonicstr[2] = '\0';
 			} else {
 				tonicstr = song[i][15];
 			}
@@ -1570,15 +1677,15 @@ bool Tool_esac2hum::getKeyInfo(vector<string>& song, string& key, double& mindur
 
 			tonic = Convert::kernToBase40(tonicstr);
 			if (tonic <= 0) {
-				cerr << "Error: invalid tonic on line: " << song[i] << endl;
+				m_error_text << "Error: invalid tonic on line: " << song[i] << endl;
 				return false;
 			}
 			tonic = tonic % 40;
 			meter = song[i].substr(17);
 			if (meter.back() != ']') {
-				cerr << "Error with meter on line: " << song[i] << endl;
-				cerr << "Meter area: " << meter << endl;
-				cerr << "Expected ] as last character but found " << meter.back() << endl;
+				m_error_text << "Error with meter on line: " << song[i] << endl;
+				m_error_text << "Meter area: " << meter << endl;
+				m_error_text << "Expected ] as last character but found " << meter.back() << endl;
 				return false;
 			} else {
 				meter.resize((int)meter.size() - 1);
@@ -1586,7 +1693,7 @@ bool Tool_esac2hum::getKeyInfo(vector<string>& song, string& key, double& mindur
 			return true;
 		}
 	}
-	cerr << "Error: did not find a KEY field" << endl;
+	m_error_text << "Error: did not find a KEY field" << endl;
 	return false;
 }
 
@@ -11,6 +11,8 @@
 // Last Modified: Sat Mar 12 18:34:05 PST 2016 Add -k option
 // Last Modified: Tue Dec 13 18:50:58 PST 2016 Ported to humlib
 // Last Modified: Tue Dec 13 18:50:58 PST 2016 Add --no-empty option
+// Last Modified: Mon Oct 19 01:12:40 PDT 2026 Added line-at-a-time processing
+// Last Modified: Mon Oct 19 02:31:05 PDT 2026 Added field maps
 // Filename:      tool-extract.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/tool-extract.h
 // Syntax:        C++11;; humlib
@@ -27,6 +29,7 @@
 #include "HumRegex.h"
 
 #include <algorithm>
+#include <cctype>
 #include <cmath>
 #include <cstring>
 #include <fstream>
@@ -117,7 +120,7 @@ bool Tool_extract::run(HumdrumFile& infile, ostream& out) {
 //
 
 bool Tool_extract::run(HumdrumFile& infile) {
-	initialize(infile);
+	initialize();
 	processFile(infile);
 	// Re-load the text for each line from their tokens.
 	// infile.createLinesFromTokens();
@@ -125,6 +128,135 @@ bool Tool_extract::run(HumdrumFile& infile) {
 }
 
 
+//
+// Line-at-a-time interface: each line is extracted and printed before
+// the next line is read.  Only used for lists of spine numbers given
+// with the -f and -x options (see isLineStreamable()), which do not
+// depend on the number of tracks.  Tracks may be added later in a
+// segment with *+, so the list is calculated once with a limit large
+// enough for all of the numbers in it.  The output of a segment from its
+// exclusive interpretation line is held back until the segment has as
+// many tracks as the largest number in the list (normally at that same
+// line), and is discarded if the list is still out of range at the end
+// of the segment.  As when
+// reading one segment at a time, processing stops after a segment with
+// errors.
+//
+
+bool Tool_extract::run(HumdrumLineStream& instream) {
+	initialize();
+	int limit = 1;
+	int value = 0;
+	for (int i=0; i<(int)fieldstring.size(); i++) {
+		if (isdigit(fieldstring[i])) {
+			value = value * 10 + fieldstring[i] - '0';
+			limit = std::max(limit, value);
+		} else {
+			value = 0;
+		}
+	}
+	fillFieldData(field, subfield, model, fieldstring, limit, NULL);
+	m_error_text.str("");
+
+	// held: Output of the current segment before its tracks are known.
+	std::ios& output = static_cast<std::ios&>(m_humdrum_text);
+	std::streambuf* target = output.rdbuf();
+	std::stringbuf held;
+	bool heldQ = false;
+	auto release = [&](void) {
+		output.rdbuf(target);
+		m_humdrum_text << held.str();
+		held.str("");
+		heldQ = false;
+	};
+	auto checkSegment = [&](int maxtrack) {
+		vector<int> checkfield;
+		vector<int> checksubfield;
+		vector<int> checkmodel;
+		fillFieldData(checkfield, checksubfield, checkmodel, fieldstring, maxtrack, NULL);
+		if (hasError()) {
+			output.rdbuf(target);
+			return false;
+		}
+		release();
+		return true;
+	};
+
+	int maxtrack = -1;
+	bool startQ = false;
+	remapQ = 1;
+	HLp line;
+	while ((line = instream.getLine())) {
+		if (line->getLineIndex() == 0) {
+			if (heldQ && !checkSegment(maxtrack)) {
+				return false;
+			}
+			startQ = true;
+		}
+		maxtrack = instream.getMaxTrack();
+		if (startQ && (maxtrack > 0)) {
+			// exclusive interpretation line of the segment
+			startQ = false;
+			output.rdbuf(&held);
+			heldQ = true;
+		}
+		if (heldQ && (maxtrack >= limit)) {
+			release();
+		}
+		if (fieldQ) {
+			extractFields(*line, limit, field, subfield, model);
+		} else {
+			excludeFields(*line, field, subfield, model);
+		}
+	}
+	if (instream.hasError()) {
+		output.rdbuf(target);
+		m_error_text << instream.getError();
+		return false;
+	}
+	if (heldQ) {
+		return checkSegment(maxtrack);
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_extract::isLineStreamable -- Only plain lists of spine numbers
+//    given with the -f or -x options can be extracted one line at a time.
+//    Subspines and cospines (a, b, c) need the rest of the file, as do
+//    the options which select spines by their contents, and $ needs the
+//    final number of tracks.
+//
+
+bool Tool_extract::isLineStreamable(void) {
+	vector<string> fileoptions = { "author", "version", "help", "example",
+		"debug", "count", "trace", "spine-list", "i", "I", "k", "grep",
+		"reverse", "R", "expand", "E", "empty", "no-empty" };
+	for (int i=0; i<(int)fileoptions.size(); i++) {
+		if (getBoolean(fileoptions[i])) {
+			return false;
+		}
+	}
+	string fields;
+	if (getBoolean("x")) {
+		fields = getString("x");
+	} else if (getBoolean("f")) {
+		fields = getString("f");
+	} else {
+		return false;
+	}
+	for (int i=0; i<(int)fields.size(); i++) {
+		if (isalpha(fields[i]) || (fields[i] == '$')) {
+			return false;
+		}
+	}
+	return true;
+}
+
+
 
 //////////////////////////////
 //
@@ -151,7 +283,7 @@ void Tool_extract::processFile(HumdrumFile& infile) {
 	} else if (noEmptyQ) {
 		fillFieldDataByNoEmpty(field, subfield, model, infile, interpstate);
 	} else if (fieldQ || excludeQ) {
-		fillFieldData(field, subfield, model, fieldstring, infile);
+		fillFieldData(field, subfield, model, fieldstring, infile.getMaxTrack(), &infile);
 	}
 
 	if (spineListQ) {
@@ -332,8 +464,12 @@ void Tool_extract::fillFieldDataByGrep(vector<int>& field, vector<int>& subfield
 			continue;
 		}
 		for (j=0; j<infile[i].getFieldCount(); j++) {
+			track = infile[i].token(j)->getTrack();
+			if (tracks[track]) {
+				// track already selected
+				continue;
+			}
 			if (hre.search(infile.token(i, j), searchstring.c_str(), "")) {
-				track = infile[i].token(j)->getTrack();
 				tracks[track] = 1;
 			}
 		}
@@ -592,13 +728,13 @@ void Tool_extract::reverseSpines(vector<int>& field, vector<int>& subfield, vect
 
 //////////////////////////////
 //
-// Tool_extract::fillFieldData --
+// Tool_extract::fillFieldData -- The input file is needed only for
+//     the -k option, and can be NULL otherwise.
 //
 
 void Tool_extract::fillFieldData(vector<int>& field, vector<int>& subfield,
-		vector<int>& model, string& fieldstring, HumdrumFile& infile) {
-
-	int maxtrack = infile.getMaxTrack();
+		vector<int>& model, string& fieldstring, int maxtrack,
+		HumdrumFile* infile) {
 
 	field.reserve(maxtrack);
 	field.resize(0);
@@ -621,7 +757,8 @@ void Tool_extract::fillFieldData(vector<int>& field, vector<int>& subfield,
 		tempfield.clear();
 		tempsubfield.clear();
 		tempmodel.clear();
-		processFieldEntry(tempfield, tempsubfield, tempmodel, hre.getMatch(1), infile);
+		processFieldEntry(tempfield, tempsubfield, tempmodel, hre.getMatch(1),
+				maxtrack, infile);
 		start += hre.getMatchEndIndex(1);
 		field.insert(field.end(), tempfield.begin(), tempfield.end());
 		subfield.insert(subfield.end(), tempsubfield.begin(), tempsubfield.end());
@@ -641,13 +778,14 @@ void Tool_extract::fillFieldData(vector<int>& field, vector<int>& subfield,
 
 void Tool_extract::processFieldEntry(vector<int>& field,
 		vector<int>& subfield, vector<int>& model, const string& astring,
-		HumdrumFile& infile) {
+		int maxtrack, HumdrumFile* infile) {
 
 	int finitsize = (int)field.size();
-	int maxtrack = infile.getMaxTrack();
 
 	vector<HTp> ktracks;
-	infile.getKernSpineStartList(ktracks);
+	if (kernQ && infile) {
+		infile->getKernSpineStartList(ktracks);
+	}
 	int maxkerntrack = (int)ktracks.size();
 
 	int modletter;
@@ -754,7 +892,7 @@ void Tool_extract::processFieldEntry(vector<int>& field,
 		}
 	}
 
-	if (!kernQ) {
+	if (!kernQ || !infile) {
 		return;
 	}
 
@@ -764,7 +902,7 @@ void Tool_extract::processFieldEntry(vector<int>& field,
 	vector<int> newmodel;
 
 	vector<HTp> trackstarts;
-	infile.getTrackStartList(trackstarts);
+	infile->getTrackStartList(trackstarts);
 	int i, j;
 	int spine;
 
@@ -845,28 +983,118 @@ void Tool_extract::removeDollarsFromString(string& buffer, int maxtrack) {
 
 void Tool_extract::excludeFields(HumdrumFile& infile, vector<int>& field,
 		vector<int>& subfield, vector<int>& model) {
-	int start = 0;
+	remapQ = 1;
 	for (int i=0; i<infile.getLineCount(); i++) {
-		if (!infile[i].hasSpines()) {
-			m_humdrum_text << infile[i] << '\n';
+		excludeFields(infile[i], field, subfield, model);
+	}
+}
+
+
+void Tool_extract::excludeFields(HumdrumLine& line, vector<int>& field,
+		vector<int>& subfield, vector<int>& model) {
+	if (!line.hasSpines()) {
+		m_humdrum_text << line << '\n';
+		return;
+	}
+	if (remapQ || line.isManipulator()) {
+		makeExcludeMap(line, field);
+	}
+	remapQ = line.isManipulator();
+	printFieldMap(line);
+}
+
+
+
+//////////////////////////////
+//
+// Tool_extract::makeExcludeMap -- Store the input fields on the line
+//     which are not in the list of excluded tracks.
+//
+
+void Tool_extract::makeExcludeMap(HumdrumLine& line, vector<int>& field) {
+	vector<char> excluded;
+	for (int i=0; i<(int)field.size(); i++) {
+		if (field[i] < 0) {
 			continue;
-		} else {
-			start = 0;
-			for (int j=0; j<infile[i].getFieldCount(); j++) {
-				if (isInList(infile[i].token(j)->getTrack(), field)) {
-					continue;
-				}
-				if (start != 0) {
-					m_humdrum_text << '\t';
-				}
-				start = 1;
-				m_humdrum_text << infile.token(i, j);
-			}
-			if (start != 0) {
-				m_humdrum_text << endl;
+		}
+		if (field[i] >= (int)excluded.size()) {
+			excluded.resize(field[i] + 1, 0);
+		}
+		excluded[field[i]] = 1;
+	}
+	fieldmap.clear();
+	for (int j=0; j<line.getFieldCount(); j++) {
+		int track = line.token(j)->getTrack();
+		if ((track >= 0) && (track < (int)excluded.size()) && excluded[track]) {
+			continue;
+		}
+		fieldmap.push_back(j);
+	}
+	fieldmapQ = 1;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_extract::makeFieldMap -- Store the input fields on the line for
+//     each extracted spine, in output order, or -1 for blank spines
+//     (track 0).  The map is the same for all lines until the next spine
+//     manipulator.  Returns false if the line has to be processed field by
+//     field (for subspines and cospines).
+//
+
+bool Tool_extract::makeFieldMap(HumdrumLine& line, vector<int>& field,
+		vector<int>& subfield) {
+	fieldmap.clear();
+	for (int t=0; t<(int)field.size(); t++) {
+		if (subfield[t]) {
+			fieldmap.clear();
+			return false;
+		}
+		if (field[t] == 0) {
+			fieldmap.push_back(-1);
+			continue;
+		}
+		for (int j=0; j<line.getFieldCount(); j++) {
+			if (line.token(j)->getTrack() == field[t]) {
+				fieldmap.push_back(j);
 			}
 		}
 	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_extract::printFieldMap -- Print the fields of the line given in
+//     the field map.
+//
+
+void Tool_extract::printFieldMap(HumdrumLine& line) {
+	if (fieldmap.empty()) {
+		return;
+	}
+	for (int k=0; k<(int)fieldmap.size(); k++) {
+		if (k > 0) {
+			m_humdrum_text << '\t';
+		}
+		int j = fieldmap[k];
+		if (j >= 0) {
+			m_humdrum_text << *line.token(j);
+		} else if (line.isLocalComment()) {
+			m_humdrum_text << "!";
+		} else if (line.isBarline()) {
+			m_humdrum_text << *line.token(0);
+		} else if (line.isData()) {
+			m_humdrum_text << ".";
+		} else if (line.isInterpretation()) {
+			m_humdrum_text << "*";
+		}
+	}
+	m_humdrum_text << '\n';
 }
 
 
@@ -878,6 +1106,21 @@ void Tool_extract::excludeFields(HumdrumFile& infile, vector<int>& field,
 
 void Tool_extract::extractFields(HumdrumFile& infile, vector<int>& field,
 		vector<int>& subfield, vector<int>& model) {
+	int maxtrack = infile.getMaxTrack();
+	remapQ = 1;
+	for (int i=0; i<infile.getLineCount(); i++) {
+		extractFields(infile[i], maxtrack, field, subfield, model);
+	}
+}
+
+
+//
+// Single-line version: the secondary subspine and cospine (b and c)
+// fields require the line to be in a HumdrumFile.
+//
+
+void Tool_extract::extractFields(HumdrumLine& line, int maxtrack,
+		vector<int>& field, vector<int>& subfield, vector<int>& model) {
 
 	HumRegex hre;
 	int start = 0;
@@ -886,107 +1129,114 @@ void Tool_extract::extractFields(HumdrumFile& infile, vector<int>& field,
 	int modeltarget;
 	string spat;
 
-	for (int i=0; i<infile.getLineCount(); i++) {
-		if (!infile[i].hasSpines()) {
-			m_humdrum_text << infile[i] << '\n';
-			continue;
-		}
+	if (!line.hasSpines()) {
+		m_humdrum_text << line << '\n';
+		return;
+	}
 
-		if (infile[i].isManipulator()) {
-			dealWithSpineManipulators(infile, i, field, subfield, model);
-			continue;
-		}
+	if (line.isManipulator()) {
+		dealWithSpineManipulators(line, maxtrack, field, subfield, model);
+		remapQ = 1;
+		return;
+	}
 
-		start = 0;
-		for (int t=0; t<(int)field.size(); t++) {
-			target = field[t];
-			subtarget = subfield[t];
-			modeltarget = model[t];
-			if (modeltarget == 0) {
-				switch (subtarget) {
-					 case 'a':
-					 case 'b':
-					    modeltarget = submodel;
-					    break;
-					 case 'c':
-					    modeltarget = comodel;
-				}
-			}
-			if (target == 0) {
-				if (start != 0) {
-					 m_humdrum_text << '\t';
-				}
-				start = 1;
-				if (!infile[i].isManipulator()) {
-					if (infile[i].isLocalComment()) {
-						m_humdrum_text << "!";
-					} else if (infile[i].isBarline()) {
-						m_humdrum_text << infile[i].token(0);
-					} else if (infile[i].isData()) {
-				       m_humdrum_text << ".";
-					    // interpretations handled in dealWithSpineManipulators()
-					    // [obviously not, so adding a blank one here
-					} else if (infile[i].isInterpretation()) {
-					    m_humdrum_text << "*";
-					 }
-				}
-			} else {
-				for (int j=0; j<infile[i].getFieldCount(); j++) {
-					 if (infile[i].token(j)->getTrack() != target) {
-					    continue;
-					 }
-					 switch (subtarget) {
-					 case 'a':
-					    getSearchPat(spat, target, "a");
-					    if (hre.search(infile.token(i,j)->getSpineInfo(), spat) ||
-					          !hre.search(infile.token(i, j)->getSpineInfo(), "\\(")) {
-					       if (start != 0) {
-					          m_humdrum_text << '\t';
-					       }
-					       start = 1;
-					       m_humdrum_text << infile.token(i, j);
-					    }
-					    break;
-					 case 'b':
-					    getSearchPat(spat, target, "b");
-					    if (hre.search(infile.token(i, j)->getSpineInfo(), spat)) {
-					       if (start != 0) {
-					          m_humdrum_text << '\t';
-					       }
-					       start = 1;
-					       m_humdrum_text << infile.token(i, j);
-					    } else if (!hre.search(infile.token(i, j)->getSpineInfo(),
-					          "\\(")) {
-					       if (start != 0) {
-					          m_humdrum_text << '\t';
-					       }
-					       start = 1;
-					       dealWithSecondarySubspine(field, subfield, model, t,
-					             infile, i, j, modeltarget);
-					    }
-					    break;
-					 case 'c':
-					    if (start != 0) {
-					       m_humdrum_text << '\t';
-					    }
-					    start = 1;
-					    dealWithCospine(field, subfield, model, t, infile, i, j,
-					       modeltarget, modeltarget, cointerp);
-					    break;
-					 default:
-					    if (start != 0) {
-					       m_humdrum_text << '\t';
-					    }
-					    start = 1;
-					    m_humdrum_text << infile.token(i, j);
-					 }
-				}
+	if (remapQ) {
+		fieldmapQ = makeFieldMap(line, field, subfield);
+		remapQ = 0;
+	}
+	if (fieldmapQ) {
+		printFieldMap(line);
+		return;
+	}
+
+	for (int t=0; t<(int)field.size(); t++) {
+		target = field[t];
+		subtarget = subfield[t];
+		modeltarget = model[t];
+		if (modeltarget == 0) {
+			switch (subtarget) {
+				 case 'a':
+				 case 'b':
+				    modeltarget = submodel;
+				    break;
+				 case 'c':
+				    modeltarget = comodel;
 			}
 		}
-		if (start != 0) {
-			m_humdrum_text << endl;
+		if (target == 0) {
+			if (start != 0) {
+				 m_humdrum_text << '\t';
+			}
+			start = 1;
+			if (!line.isManipulator()) {
+				if (line.isLocalComment()) {
+					m_humdrum_text << "!";
+				} else if (line.isBarline()) {
+					m_humdrum_text << line.token(0);
+				} else if (line.isData()) {
+			       m_humdrum_text << ".";
+				    // interpretations handled in dealWithSpineManipulators()
+				    // [obviously not, so adding a blank one here
+				} else if (line.isInterpretation()) {
+				    m_humdrum_text << "*";
+				 }
+			}
+		} else {
+			for (int j=0; j<line.getFieldCount(); j++) {
+				 if (line.token(j)->getTrack() != target) {
+				    continue;
+				 }
+				 switch (subtarget) {
+				 case 'a':
+				    getSearchPat(spat, target, "a");
+				    if (hre.search(line.token(j)->getSpineInfo(), spat) ||
+				          !hre.search(line.token(j)->getSpineInfo(), "\\(")) {
+				       if (start != 0) {
+				          m_humdrum_text << '\t';
+				       }
+				       start = 1;
+				       m_humdrum_text << line.token(j);
+				    }
+				    break;
+				 case 'b':
+				    getSearchPat(spat, target, "b");
+				    if (hre.search(line.token(j)->getSpineInfo(), spat)) {
+				       if (start != 0) {
+				          m_humdrum_text << '\t';
+				       }
+				       start = 1;
+				       m_humdrum_text << line.token(j);
+				    } else if (!hre.search(line.token(j)->getSpineInfo(),
+				          "\\(")) {
+				       if (start != 0) {
+				          m_humdrum_text << '\t';
+				       }
+				       start = 1;
+				       dealWithSecondarySubspine(field, subfield, model, t,
+				             *line.getOwner(), line.getLineIndex(), j, modeltarget);
+				    }
+				    break;
+				 case 'c':
+				    if (start != 0) {
+				       m_humdrum_text << '\t';
+				    }
+				    start = 1;
+				    dealWithCospine(field, subfield, model, t, *line.getOwner(),
+				       line.getLineIndex(), j, modeltarget, modeltarget, cointerp);
+				    break;
+				 default:
+				    if (start != 0) {
+				       m_humdrum_text << '\t';
+				    }
+				    start = 1;
+				    m_humdrum_text << line.token(j);
+				 }
+			}
 		}
 	}
+	if (start != 0) {
+		m_humdrum_text << endl;
+	}
 }
 
 
@@ -1247,24 +1497,24 @@ void Tool_extract::getSearchPat(string& spat, int target, const string& modifier
 //     spine manipulators (**, *-, *x, *v, *^) when creating the output.
 //
 
-void Tool_extract::dealWithSpineManipulators(HumdrumFile& infile, int line,
+void Tool_extract::dealWithSpineManipulators(HumdrumLine& line, int maxtrack,
 		vector<int>& field, vector<int>& subfield, vector<int>& model) {
 
 	vector<int> vmanip;  // counter for *v records on line
-	vmanip.resize(infile[line].getFieldCount());
+	vmanip.resize(line.getFieldCount());
 	fill(vmanip.begin(), vmanip.end(), 0);
 
 	vector<int> xmanip; // counter for *x record on line
-	xmanip.resize(infile[line].getFieldCount());
+	xmanip.resize(line.getFieldCount());
 	fill(xmanip.begin(), xmanip.end(), 0);
 
 	int i = 0;
 	int j;
 	for (j=0; j<(int)vmanip.size(); j++) {
-		if (*infile.token(line, j) == "*v") {
+		if (*line.token(j) == "*v") {
 			vmanip[j] = 1;
 		}
-		if (*infile.token(line, j) == "*x") {
+		if (*line.token(j) == "*x") {
 			xmanip[j] = 1;
 		}
 	}
@@ -1296,7 +1546,7 @@ void Tool_extract::dealWithSpineManipulators(HumdrumFile& infile, int line,
 	fill(fieldoccur.begin(), fieldoccur.end(), 0);
 
 	vector<int> trackcounter; // counter of input spines occurances in output
-	trackcounter.resize(infile.getMaxTrack()+1);
+	trackcounter.resize(maxtrack+1);
 	fill(trackcounter.begin(), trackcounter.end(), 0);
 
 	for (i=0; i<(int)field.size(); i++) {
@@ -1349,13 +1599,13 @@ void Tool_extract::dealWithSpineManipulators(HumdrumFile& infile, int line,
 		}
 		suppress = 0;
 		if (target == 0) {
-			if (infile.token(line, 0)->compare(0, 2, "**") == 0) {
+			if (line.token(0)->compare(0, 2, "**") == 0) {
 				storeToken(tempout, blankName);
 				tval = 0;
 				vserial.push_back(tval);
 				xserial.push_back(tval);
 				fpos.push_back(tval);
-			} else if (*infile.token(line, 0) == "*-") {
+			} else if (*line.token(0) == "*-") {
 				storeToken(tempout, "*-");
 				tval = 0;
 				vserial.push_back(tval);
@@ -1369,19 +1619,19 @@ void Tool_extract::dealWithSpineManipulators(HumdrumFile& infile, int line,
 				fpos.push_back(tval);
 			}
 		} else {
-			for (j=0; j<infile[line].getFieldCount(); j++) {
-				if (infile[line].token(j)->getTrack() != target) {
+			for (j=0; j<line.getFieldCount(); j++) {
+				if (line.token(j)->getTrack() != target) {
 					continue;
 				}
 		 // filter by subfield
 		 if (subtarget == 'a') {
 					getSearchPat(spat, target, "b");
-			 if (hre.search(infile.token(line, j)->getSpineInfo(), spat)) {
+			 if (hre.search(line.token(j)->getSpineInfo(), spat)) {
 						continue;
 			 }
 		 } else if (subtarget == 'b') {
 					getSearchPat(spat, target, "a");
-			 if (hre.search(infile.token(line, j)->getSpineInfo(), spat)) {
+			 if (hre.search(line.token(j)->getSpineInfo(), spat)) {
 						continue;
 					}
 				}
@@ -1389,29 +1639,29 @@ void Tool_extract::dealWithSpineManipulators(HumdrumFile& infile, int line,
 				switch (subtarget) {
 				case 'a':
 
-					if (!hre.search(infile.token(line, j)->getSpineInfo(), "\\(")) {
-						if (*infile.token(line, j)  == "*^") {
+					if (!hre.search(line.token(j)->getSpineInfo(), "\\(")) {
+						if (*line.token(j)  == "*^") {
 							 storeToken(tempout, "*");
 						} else {
-							 storeToken(tempout, *infile.token(line, j));
+							 storeToken(tempout, *line.token(j));
 						}
 					} else {
 						getSearchPat(spat, target, "a");
-						spinepat =  infile.token(line, j)->getSpineInfo();
+						spinepat =  line.token(j)->getSpineInfo();
 						hre.replaceDestructive(spinepat, "\\(", "\\(", "g");
 						hre.replaceDestructive(spinepat, "\\)", "\\)", "g");
 
-						if ((*infile.token(line, j) == "*v") &&
+						if ((*line.token(j) == "*v") &&
 							    (spinepat == spat)) {
 							 storeToken(tempout, "*");
 						} else {
 							 getSearchPat(spat, target, "b");
 							 if ((spinepat == spat) &&
-							       (*infile.token(line, j) ==  "*v")) {
+							       (*line.token(j) ==  "*v")) {
 							    // do nothing
 							    suppress = 1;
 							 } else {
-							    storeToken(tempout, *infile.token(line, j));
+							    storeToken(tempout, *line.token(j));
 							 }
 						}
 					}
@@ -1419,29 +1669,29 @@ void Tool_extract::dealWithSpineManipulators(HumdrumFile& infile, int line,
 					break;
 				case 'b':
 
-					if (!hre.search(infile.token(line, j)->getSpineInfo(), "\\(")) {
-						if (*infile.token(line, j) == "*^") {
+					if (!hre.search(line.token(j)->getSpineInfo(), "\\(")) {
+						if (*line.token(j) == "*^") {
 							 storeToken(tempout, "*");
 						} else {
-							 storeToken(tempout, *infile.token(line, j));
+							 storeToken(tempout, *line.token(j));
 						}
 					} else {
 						getSearchPat(spat, target, "b");
-						spinepat = infile.token(line, j)->getSpineInfo();
+						spinepat = line.token(j)->getSpineInfo();
 						hre.replaceDestructive(spinepat, "\\(", "\\(", "g");
 						hre.replaceDestructive(spinepat, "\\)", "\\)", "g");
 
-						if ((*infile.token(line, j) ==  "*v") &&
+						if ((*line.token(j) ==  "*v") &&
 							    (spinepat == spat)) {
 							 storeToken(tempout, "*");
 						} else {
 							 getSearchPat(spat, target, "a");
 							 if ((spinepat == spat) &&
-							       (*infile.token(line, j) == "*v")) {
+							       (*line.token(j) == "*v")) {
 							    // do nothing
 							    suppress = 1;
 							 } else {
-							    storeToken(tempout, *infile.token(line, j));
+							    storeToken(tempout, *line.token(j));
 							 }
 						}
 					}
@@ -1449,10 +1699,10 @@ void Tool_extract::dealWithSpineManipulators(HumdrumFile& infile, int line,
 					break;
 				case 'c':
 					// work on later
-					storeToken(tempout, *infile.token(line, j));
+					storeToken(tempout, *line.token(j));
 					break;
 				default:
-					storeToken(tempout, *infile.token(line, j));
+					storeToken(tempout, *line.token(j));
 				}
 
 				if (suppress) {
@@ -1492,7 +1742,7 @@ void Tool_extract::dealWithSpineManipulators(HumdrumFile& infile, int line,
 	}
 
 	if (debugQ && vdebug) {
-		m_humdrum_text << "!!LINE: " << infile[line] << endl;
+		m_humdrum_text << "!!LINE: " << line << endl;
 		m_humdrum_text << "!! *v serials = ";
 		for (int ii=0; ii<(int)vserial.size(); ii++) {
 			m_humdrum_text << vserial[ii] << " ";
@@ -1694,25 +1944,6 @@ void storeToken(vector<string>& storage, int index, const string& string) {
 
 
 
-//////////////////////////////
-//
-// Tool_extract::isInList -- returns true if first number found in list of numbers.
-//     returns the matching index plus one.
-//
-
-int Tool_extract::isInList(int number, vector<int>& listofnum) {
-	int i;
-	for (i=0; i<(int)listofnum.size(); i++) {
-		if (listofnum[i] == number) {
-			return i+1;
-		}
-	}
-	return 0;
-
-}
-
-
-
 //////////////////////////////
 //
 // Tool_extract::getTraceData --
@@ -1760,7 +1991,7 @@ void Tool_extract::getTraceData(vector<int>& startline, vector<vector<int> >& fi
 		}
 		startline.push_back(linenum);
 		string ttemp = temps;
-		fillFieldData(field, subfield, model, ttemp, infile);
+		fillFieldData(field, subfield, model, ttemp, infile.getMaxTrack(), &infile);
 		fields.push_back(field);
 		input.getline(buffer, 1024);
 	}
@@ -1888,7 +2119,7 @@ void Tool_extract::usage(const string& command) {
 // Tool_extract::initialize --
 //
 
-void Tool_extract::initialize(HumdrumFile& infile) {
+void Tool_extract::initialize(void) {
 	// handle basic options:
 	if (getBoolean("author")) {
 		m_free_text << "Written by Craig Stuart Sapp, "
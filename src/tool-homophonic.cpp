@@ -2,6 +2,7 @@
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Fri Aug  9 17:58:05 EDT 2019
 // Last Modified: Fri Aug  9 17:58:08 EDT 2019
+// Last Modified: Sun Oct 18 17:24:10 PDT 2026 Store results in analysis columns
 // Filename:      tool-homophonic.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/tool-homophonic.cpp
 // Syntax:        C++11; humlib
@@ -35,6 +36,7 @@ Tool_homophonic::Tool_homophonic(void) {
 	define("f|fraction=b", "calculate fraction of music that is homophonic");
 	define("v|voice=b", "display voice information or fraction results");
 	define("F|filename=b", "show filename for f option");
+	define("csv=b", "print analysis as CSV data rather than adding spines");
 	define("n|t|threshold=d:4.0", "Threshold score sum required for homophonic texture detection");
 	define("s|score=d:1.0", "Score assigned to a sonority with three or more attacks");
 	define("m|intermediate-score=d:0.5", "Score to give sonority between two adjacent attack sonoroties");
@@ -85,6 +87,13 @@ bool Tool_homophonic::run(HumdrumFile& infile) {
 	infile.analyzeStructure();
 	m_voice_count = getExtantVoiceCount(infile);
 	processFile(infile);
+	if (getBoolean("csv")) {
+		if (infile.getAnalysisColumnCount() > 0) {
+			infile.printAnalysisCsv(m_free_text);
+		}
+	} else {
+		infile.renderAnalysisColumns();
+	}
 	infile.createLinesFromTokens();
 	return true;
 }
@@ -231,7 +240,7 @@ void Tool_homophonic::processFile(HumdrumFile& infile) {
 				m_homophonic[data[i]] = "black";
 			}
 		}
-		infile.appendDataSpine(m_homophonic, "", "**color");
+		infile.addAnalysisColumn(m_homophonic, "", "**color");
 	}
 }
 
@@ -243,7 +252,7 @@ void Tool_homophonic::processFile(HumdrumFile& infile) {
 //
 
 void Tool_homophonic::printAccumulatedScores(HumdrumFile& infile, vector<double>& score) {
-	infile.appendDataSpine(score, "", "**score");
+	infile.addAnalysisColumn(score, "", "**score");
 }
 
 
@@ -254,7 +263,7 @@ void Tool_homophonic::printAccumulatedScores(HumdrumFile& infile, vector<double>
 //
 
 void Tool_homophonic::printRawAnalysis(HumdrumFile& infile, vector<double>& raw) {
-	infile.appendDataSpine(raw, "", "**raw");
+	infile.addAnalysisColumn(raw, "", "**raw");
 }
 
 
@@ -265,7 +274,7 @@ void Tool_homophonic::printRawAnalysis(HumdrumFile& infile, vector<double>& raw)
 //
 
 void Tool_homophonic::printAttacks(HumdrumFile& infile, vector<int>& attacks) {
-	infile.appendDataSpine(attacks, "", "**atks");
+	infile.addAnalysisColumn(attacks, "", "**atks");
 }
 
 
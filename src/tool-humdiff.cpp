@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Mon Jul 29 11:38:01 CEST 2019
-// Last Modified: Sat Aug  3 17:48:04 EDT 2019
+// Last Modified: Mon Oct 19 05:41:12 PDT 2026
 // Filename:      humdiff.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/cli/humdiff.cpp
 // Syntax:        C++11
@@ -11,9 +11,14 @@
 //
 
 #include "tool-humdiff.h"
+#include "HumParallel.h"
 #include "HumRegex.h"
 #include "Convert.h"
+
+#include <algorithm>
 #include <iostream>
+#include <limits>
+#include <unordered_map>
 
 using namespace std;
 
@@ -33,6 +38,9 @@ Tool_humdiff::Tool_humdiff(void) {
 	define("time-points|times=b", "display timepoint lists for each file");
 	define("note-points|notes=b", "display notepoint lists for each file");
 	define("c|color=s:red",       "color for markers");
+	define("delta=b",             "display tab-separated list of note differences");
+	define("g|group-size=i:0",    "number of files in each comparison group (0 = all)");
+	define("j|threads=i:0",       "number of threads for comparisons (0 = all cores)");
 }
 
 
@@ -43,13 +51,11 @@ Tool_humdiff::Tool_humdiff(void) {
 //
 
 bool Tool_humdiff::run(HumdrumFileSet& infiles) {
-	bool status = true;
-	if (infiles.getCount() >= 2) {
-		status = run(infiles[0], infiles[1]);
-	} else {
-		status = false;
+	if (infiles.getCount() < 2) {
+		return false;
 	}
-	return status;
+	processFileSet(infiles);
+	return true;
 }
 
 
@@ -106,155 +112,472 @@ bool Tool_humdiff::run(HumdrumFile& infile1, HumdrumFile& infile2) {
 
 //////////////////////////////
 //
-// Tool_humdiff::processFile
+// Tool_humdiff::processFile --
 //
 
 void Tool_humdiff::processFile(HumdrumFile& infile1, HumdrumFile& infile2) {
 	HumdrumFileSet humset;
 	humset.readAppendHumdrum(infile1);
 	humset.readAppendHumdrum(infile2);
+	processFileSet(humset);
+}
+
+
+
+//////////////////////////////
+//
+// Tool_humdiff::processFileSet -- Compare the files in the set.  By default
+//     all files form a single group, and the reference file of the group
+//     (the first file, or the one given by -r) is compared to each of the
+//     other files.  With -g, consecutive files are split into groups of
+//     the given size, each group having its own reference file.
+//
+
+void Tool_humdiff::processFileSet(HumdrumFileSet& infiles) {
+	if (infiles.getSize() == 0) {
+		m_warning_text << "Usage: " << getCommand() << " files" << endl;
+		return;
+	}
+	int groupsize = getInteger("group-size");
+	if (groupsize <= 0) {
+		groupsize = infiles.getSize();
+	}
+
+	vector<vector<HumdrumFile*>> groups;
+	for (int i=0; i<infiles.getSize(); i++) {
+		if (i % groupsize == 0) {
+			groups.resize(groups.size() + 1);
+		}
+		groups.back().push_back(&infiles[i]);
+	}
+
+	vector<vector<HumdrumFile*>> validgroups;
+	validgroups.reserve(groups.size());
+	for (int i=0; i<(int)groups.size(); i++) {
+		if (prepareGroup(groups[i])) {
+			validgroups.push_back(groups[i]);
+		}
+	}
+	compareGroups(validgroups);
+}
+
+
+
+//////////////////////////////
+//
+// Tool_humdiff::prepareGroup -- Move the reference file to the start of the
+//     group and check that the group can be compared.  Returns false
+//     (with a warning message) if the group cannot be compared.
+//
+
+bool Tool_humdiff::prepareGroup(vector<HumdrumFile*>& group) {
 	int reference = getInteger("reference");
 	if (reference > 1) {
-		if (reference > humset.getCount()) {
-			cerr << "Error: work number is too large: " << reference << endl;
-			cerr << "Maximum is " << humset.getCount() << endl;
-			return;
+		if (reference > (int)group.size()) {
+			m_warning_text << "Error: work number is too large: " << reference << endl;
+			m_warning_text << "Maximum is " << group.size() << endl;
+			return false;
 		}
 		reference--;
-		humset.swap(0, reference);
+		std::swap(group[0], group[reference]);
 	}
 
-	if (humset.getSize() == 0) {
-		cerr << "Usage: " << getCommand() << " files" << endl;
-		return;
-	} else if (humset.getSize() < 2) {
-		cerr << "Error: requires two or more files" << endl;
-		cerr << "Usage: " << getCommand() << " files" << endl;
-		return;
-	} else {
-		HumNum targetdur = humset[0].getScoreDuration();
-		for (int i=1; i<humset.getSize(); i++) {
-			HumNum dur = humset[i].getScoreDuration();
-			if (dur != targetdur) {
-				cerr << "Error: all files must have the same duration" << endl;
-				return;
+	if (group.size() < 2) {
+		m_warning_text << "Error: requires two or more files" << endl;
+		m_warning_text << "Usage: " << getCommand() << " files" << endl;
+		return false;
+	}
+
+	HumNum targetdur = group[0]->getScoreDuration();
+	for (int i=1; i<(int)group.size(); i++) {
+		HumNum dur = group[i]->getScoreDuration();
+		if (dur != targetdur) {
+			m_warning_text << "Error: all files must have the same duration";
+			if (!group[0]->getFilename().empty()) {
+				m_warning_text << " (" << group[0]->getFilename() << ")";
 			}
+			m_warning_text << endl;
+			return false;
 		}
-		compareFiles(humset);
 	}
 
-	if (!getBoolean("report")) {
-		humset[0].createLinesFromTokens();
-		m_humdrum_text << humset[0];
-		if (m_marked) {
-			m_humdrum_text << "!!!RDF**kern: @ = marked note";
-			if (getBoolean("color")) {
-				m_humdrum_text << "color=\"" << getString("color") << "\"";
+	vector<long long> tickscales;
+	return getTickScales(group, tickscales);
+}
+
+
+
+//////////////////////////////
+//
+// Tool_humdiff::getTickScales -- Calculate the factor for each file in a
+//     group which converts its ticks into ticks of the least common
+//     multiple of the ticks-per-quarter values of the group.  Returns
+//     false (with a warning message) if the group ticks do not fit into
+//     a 64-bit integer, which can happen with many different tuplets.
+//
+
+bool Tool_humdiff::getTickScales(vector<HumdrumFile*>& group,
+		vector<long long>& tickscales) {
+	const long long maxticks = std::numeric_limits<long long>::max();
+	tickscales.clear();
+	long long lcm = 1;
+	bool overflowQ = false;
+	for (int i=0; i<(int)group.size(); i++) {
+		long long tpq = std::max(group[i]->tpq(), 1);
+		long long a = lcm;
+		long long b = tpq;
+		while (b != 0) {
+			long long c = a % b;
+			a = b;
+			b = c;
+		}
+		long long factor = tpq / a;
+		if (lcm > maxticks / factor) {
+			overflowQ = true;
+			break;
+		}
+		lcm *= factor;
+	}
+	if (!overflowQ) {
+		for (int i=0; i<(int)group.size(); i++) {
+			long long scale = lcm / std::max(group[i]->tpq(), 1);
+			long long ticks = group[i]->timeToTick(group[i]->getScoreDuration());
+			if ((ticks > 0) && (scale > maxticks / ticks)) {
+				overflowQ = true;
+				break;
 			}
-			m_humdrum_text << endl;
+			tickscales.push_back(scale);
+		}
+	}
+	if (overflowQ) {
+		tickscales.clear();
+		m_warning_text << "Error: the rhythms of the files are too complex to compare";
+		if (!group[0]->getFilename().empty()) {
+			m_warning_text << " (" << group[0]->getFilename() << ")";
 		}
+		m_warning_text << endl;
+		return false;
 	}
+	return true;
 }
 
 
 
 //////////////////////////////
 //
-// Tool_humdiff::compareFiles --
-//
-
-void Tool_humdiff::compareFiles(HumdrumFileSet& humset) {
-	vector<vector<TimePoint>> timepoints(humset.getSize());;
-	for (int i=0; i<humset.getSize(); i++) {
-		extractTimePoints(timepoints.at(i), humset[i]);
+// Tool_humdiff::compareGroups -- Extract the notes of every file and then
+//     align the reference file of each group with each of the other files
+//     in the group.  The extractions and comparison pairs are independent,
+//     so they are run in parallel.  Note start times and durations are
+//     converted into integer ticks that are shared by all files in a group,
+//     and notes are aligned with a hash table keyed by start time and pitch,
+//     so each comparison is linear in the number of notes.
+//
+
+void Tool_humdiff::compareGroups(vector<vector<HumdrumFile*>>& groups) {
+	int threads = getInteger("threads");
+
+	// Flatten the list of files and calculate the tick scaling for each
+	// file so that each group uses a common ticks-per-quarter value.
+	vector<HumdrumFile*> files;
+	vector<long long> tickscales;
+	vector<int> groupstarts;
+	for (int i=0; i<(int)groups.size(); i++) {
+		vector<long long> scales;
+		getTickScales(groups[i], scales);
+		groupstarts.push_back((int)files.size());
+		for (int j=0; j<(int)groups[i].size(); j++) {
+			files.push_back(groups[i][j]);
+			tickscales.push_back(scales[j]);
+		}
 	}
 
 	if (getBoolean("time-points")) {
-		for (int i=0; i<(int)timepoints.size(); i++) {
-	 		printTimePoints(cout, timepoints[i]);
+		for (int i=0; i<(int)files.size(); i++) {
+			vector<TimePoint> timepoints;
+			extractTimePoints(timepoints, *files[i]);
+			printTimePoints(cout, timepoints);
+		}
+	}
+
+	vector<vector<NotePoint>> notes(files.size());
+	HumParallel::run((int)files.size(), threads, [&](int i) {
+		int sourceindex = i;
+		auto it = std::upper_bound(groupstarts.begin(), groupstarts.end(), i);
+		sourceindex -= *(it - 1);
+		extractNotePoints(notes[i], *files[i], sourceindex, tickscales[i]);
+	});
+
+	if (getBoolean("notes")) {
+		for (int i=0; i<(int)notes.size(); i++) {
+			cerr << "========== NOTES FOR I=" << i << endl;
+			printNotePoints(notes[i]);
+			cerr << endl;
+		}
+	}
+
+	// Prepare the list of (reference, source) comparisons:
+	vector<pair<int, int>> pairs;
+	for (int i=0; i<(int)groups.size(); i++) {
+		for (int j=1; j<(int)groups[i].size(); j++) {
+			pairs.emplace_back(groupstarts[i], groupstarts[i] + j);
+		}
+	}
+
+	vector<vector<int>> matches(pairs.size());
+	vector<vector<int>> extras(pairs.size());
+	HumParallel::run((int)pairs.size(), threads, [&](int i) {
+		alignNotePoints(notes[pairs[i].first], notes[pairs[i].second],
+				matches[i], extras[i]);
+	});
+
+	// Store the matches in the reference notes:
+	for (int i=0; i<(int)pairs.size(); i++) {
+		vector<NotePoint>& reference = notes[pairs[i].first];
+		int sourceindex = pairs[i].second - pairs[i].first;
+		for (int j=0; j<(int)reference.size(); j++) {
+			if ((int)reference[j].matched.size() <= sourceindex) {
+				reference[j].matched.resize(sourceindex + 1, -1);
+				reference[j].matched[0] = j;
+			}
+			reference[j].matched[sourceindex] = matches[i][j];
 		}
 	}
 
-	compareTimePoints(cout, timepoints, humset);
+	bool reportQ = getBoolean("report");
+	bool deltaQ = getBoolean("delta");
+	int pairindex = 0;
+	for (int i=0; i<(int)groups.size(); i++) {
+		vector<NotePoint>& reference = notes[groupstarts[i]];
+		int paircount = (int)groups[i].size() - 1;
+		if (deltaQ) {
+			vector<vector<NotePoint>> groupnotes;
+			groupnotes.reserve(groups[i].size());
+			for (int j=0; j<(int)groups[i].size(); j++) {
+				groupnotes.push_back(notes[groupstarts[i] + j]);
+			}
+			vector<vector<int>> groupextras(extras.begin() + pairindex,
+					extras.begin() + pairindex + paircount);
+			printDelta(i, groups[i], groupnotes, groupextras);
+		} else if (reportQ) {
+			printReport(groups[i], reference);
+		} else {
+			m_marked = 0;
+			for (int j=0; j<(int)reference.size(); j++) {
+				for (int k=1; k<(int)reference[j].matched.size(); k++) {
+					if (reference[j].matched[k] < 0) {
+						markNote(reference[j]);
+						break;
+					}
+				}
+			}
+			HumdrumFile& infile = *groups[i][0];
+			infile.createLinesFromTokens();
+			m_humdrum_text << infile;
+			if (m_marked) {
+				m_humdrum_text << "!!!RDF**kern: @ = marked note";
+				if (getBoolean("color")) {
+					m_humdrum_text << "color=\"" << getString("color") << "\"";
+				}
+				m_humdrum_text << endl;
+			}
+		}
+		pairindex += paircount;
+	}
 }
 
 
 
 //////////////////////////////
 //
-// Tool_humdiff::printTimePoints --
-//
+// Tool_humdiff::alignNotePoints -- Find an equivalent note in the source
+//     for each note in the reference.  Notes are equivalent if they start
+//     at the same time, have the same pitch and the same (tied) duration.
+//     Each source note can be matched only once.  The matches list gives
+//     the index of the matching source note for each reference note (or -1
+//     if there is no match), and the extras list gives the indexes of
+//     source notes which do not have a match in the reference.
+//
+
+void Tool_humdiff::alignNotePoints(vector<NotePoint>& reference,
+		vector<NotePoint>& source, vector<int>& matches, vector<int>& extras) {
+	matches.assign(reference.size(), -1);
+	extras.clear();
+
+	// Hash the source notes by start time and pitch.  Notes with the same
+	// time and pitch but different durations share a bucket, which are
+	// then checked one at a time.
+	std::unordered_map<unsigned long long, vector<int>> table;
+	table.reserve(source.size());
+	for (int i=(int)source.size()-1; i>=0; i--) {
+		unsigned long long key = ((unsigned long long)(unsigned int)source[i].tick << 32)
+				| (unsigned int)source[i].b40;
+		table[key].push_back(i);
+	}
 
-ostream& Tool_humdiff::printTimePoints(ostream& out, vector<TimePoint>& timepoints) {
-	for (int i=0; i<(int)timepoints.size(); i++) {
-		out << "TIMEPOINT " << i << ":" << endl;
-		out << timepoints[i] << endl;
+	vector<char> used(source.size(), 0);
+	for (int i=0; i<(int)reference.size(); i++) {
+		unsigned long long key = ((unsigned long long)(unsigned int)reference[i].tick << 32)
+				| (unsigned int)reference[i].b40;
+		auto it = table.find(key);
+		if (it == table.end()) {
+			continue;
+		}
+		vector<int>& bucket = it->second;
+		for (int j=(int)bucket.size()-1; j>=0; j--) {
+			NotePoint& note = source[bucket[j]];
+			if ((note.tick != reference[i].tick) || (note.b40 != reference[i].b40) ||
+					(note.durticks != reference[i].durticks)) {
+				continue;
+			}
+			matches[i] = bucket[j];
+			used[bucket[j]] = 1;
+			bucket.erase(bucket.begin() + j);
+			break;
+		}
+	}
+
+	for (int i=0; i<(int)used.size(); i++) {
+		if (!used[i]) {
+			extras.push_back(i);
+		}
 	}
-	return out;
 }
 
 
 
 //////////////////////////////
 //
-// Tool_humdiff::compareTimePoints --
+// Tool_humdiff::extractNotePoints -- Extract a list of the note attacks
+//     in a file.  Lines that contain only grace notes are ignored.
+//     Times and durations are stored in ticks scaled by tickscale, so that
+//     files with different tpq() values can be compared.
 //
 
-ostream& Tool_humdiff::compareTimePoints(ostream& out, vector<vector<TimePoint>>& timepoints, HumdrumFileSet& humset) {
-	vector<int> indexes(timepoints.size(), 0);
-	HumNum minval;
-	HumNum value;
-	int found;
-
-	vector<int> increment(timepoints.size(), 0);
-
-	while ((1)) {
-		if (indexes.at(0) >= (int)timepoints.at(0).size()) {
-			// at the end of the list of notes for the first file.
-			// break from the comparison for now and figure out how
-			// to report differences of added notes in the other file(s)
-			// later.
-			break;
+void Tool_humdiff::extractNotePoints(vector<NotePoint>& notelist,
+		HumdrumFile& infile, int sourceindex, long long tickscale) {
+	notelist.clear();
+	HumRegex hre;
+	int measure = -1;
+	int tpindex = 0;
+	for (int i=0; i<infile.getLineCount(); i++) {
+		if (infile[i].isBarline()) {
+			if (hre.search(infile.token(i, 0), "(\\d+)")) {
+				measure = hre.getMatchInt(1);
+			}
 		}
-		timepoints.at(0).at(indexes.at(0)).index.resize(timepoints.size());
-		for (int i=1; i<(int)timepoints.size(); i++) {
-			timepoints.at(0).at(indexes.at(0)).index.at(i) = -1;
+		if (!infile[i].isData()) {
+			continue;
 		}
-		minval = timepoints.at(0).at(indexes.at(0)).timestamp;
-		for (int i=1; i<(int)timepoints.size(); i++) {
-			if (indexes.at(i) >= (int)timepoints.at(i).size()) {
-				continue;
-			}
-			value = timepoints.at(i).at(indexes.at(i)).timestamp;
-			if (value < minval) {
-				minval = value;
-			}
+		if (infile[i].getDuration() == 0) {
+			// ignore grace notes for now
+			continue;
 		}
-		found = 0;
-		fill(increment.begin(), increment.end(), 0);
-		
-		for (int i=0; i<(int)timepoints.size(); i++) {
-			if (indexes.at(i) >= (int)timepoints.at(i).size()) {
-				// index is too large for file, so skip checking it.
+		getNoteList(notelist, infile, i, measure, sourceindex, tpindex++, tickscale);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// Tool_humdiff::printReport -- Print a description of the reference notes
+//     that do not have a match in the other files of a group.
+//
+
+void Tool_humdiff::printReport(vector<HumdrumFile*>& group,
+		vector<NotePoint>& reference) {
+	HumdrumFile& infile = *group[0];
+	for (int i=0; i<(int)reference.size(); i++) {
+		for (int j=1; j<(int)reference[i].matched.size(); j++) {
+			if (reference[i].matched[j] >= 0) {
 				continue;
 			}
-			found = 1;
-			value = timepoints.at(i).at(indexes.at(i)).timestamp;
+			m_free_text << "NOTE " << reference[i].subtoken
+			     << " DOES NOT HAVE EXACT MATCH IN SOURCE " << j << endl;
+			int humindex = reference[i].token->getLineIndex();
+			m_free_text << "\tREFERENCE MEASURE\t: " << reference[i].measure << endl;
+			m_free_text << "\tREFERENCE LINE NO.\t: " << humindex+1 << endl;
+			m_free_text << "\tREFERENCE LINE TEXT\t: " << infile[humindex] << endl;
+
+			m_free_text << "\tTARGET  " << j << " LINE NO. ";
+			if (j < 10) {
+				m_free_text << " ";
+			}
+			m_free_text << ":\t" << "X" << endl;
 
-			if (value == minval) {
-				timepoints.at(0).at(indexes.at(0)).index.at(i) = timepoints.at(i).at(indexes.at(i)).index.at(0);
-				increment.at(i)++;
+			m_free_text << "\tTARGET  " << j << " LINE TEXT";
+			if (j < 10) {
+				m_free_text << " ";
 			}
+			m_free_text << ":\t" << "X" << endl;
+
+			m_free_text << endl;
 		}
-		if (!found) {
-			break;
-		} else {
-			compareLines(minval, indexes, timepoints, humset);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// Tool_humdiff::printDelta -- Print a tab-separated list of the note
+//     differences between the reference file of a group and the other
+//     files in the group.  Each group starts with a list of the files in
+//     the group, followed by one line for each difference:
+//        group, source, op, measure, line, field, subtoken, time, duration, b40
+//     Where op is "-" for a reference note which is not in the source (line
+//     and field are for the reference file), and "+" for a source note which
+//     is not in the reference (line and field are for the source file).
+//     Line and field numbers are 1-indexed, times and durations are in
+//     quarter notes.
+//
+
+void Tool_humdiff::printDelta(int groupindex, vector<HumdrumFile*>& group,
+		vector<vector<NotePoint>>& notes, vector<vector<int>>& extras) {
+	if (groupindex == 0) {
+		m_free_text << "#group\tsource\top\tmeasure\tline\tfield\tnote\ttime\tduration\tb40\n";
+	}
+	for (int i=0; i<(int)group.size(); i++) {
+		m_free_text << "#file\t" << groupindex << "\t" << i << "\t" << group[i]->getFilename() << "\n";
+	}
+
+	auto printNote = [&](int source, char op, NotePoint& np) {
+		m_free_text << groupindex << "\t" << source << "\t" << op;
+		m_free_text << "\t" << np.measure;
+		m_free_text << "\t" << np.token->getLineNumber();
+		m_free_text << "\t" << np.token->getFieldNumber();
+		m_free_text << "\t" << np.subtoken;
+		m_free_text << "\t" << np.token->getDurationFromStart();
+		m_free_text << "\t" << np.duration;
+		m_free_text << "\t" << np.b40 << "\n";
+	};
+
+	vector<NotePoint>& reference = notes[0];
+	for (int j=1; j<(int)group.size(); j++) {
+		for (int i=0; i<(int)reference.size(); i++) {
+			if (reference[i].matched.at(j) < 0) {
+				printNote(j, '-', reference[i]);
+			}
 		}
-		for (int i=0; i<(int)increment.size(); i++) {
-			indexes.at(i) += increment.at(i);
+		for (int i=0; i<(int)extras[j-1].size(); i++) {
+			printNote(j, '+', notes[j][extras[j-1][i]]);
 		}
 	}
+}
+
+
+
+//////////////////////////////
+//
+// Tool_humdiff::printTimePoints --
+//
+
+ostream& Tool_humdiff::printTimePoints(ostream& out, vector<TimePoint>& timepoints) {
+	for (int i=0; i<(int)timepoints.size(); i++) {
+		out << "TIMEPOINT " << i << ":" << endl;
+		out << timepoints[i] << endl;
+	}
 	return out;
 }
 
@@ -306,122 +629,14 @@ void Tool_humdiff::markNote(NotePoint& np) {
 
 
 
-//////////////////////////////
-//
-// Tool_humdiff::compareLines --
-//
-
-void Tool_humdiff::compareLines(HumNum minval, vector<int>& indexes,
-		vector<vector<TimePoint>>& timepoints, HumdrumFileSet& humset) {
-
-	bool reportQ = getBoolean("report");
-
-	// cerr << "COMPARING LINES ====================================" << endl;
-	vector<vector<NotePoint>> notelist(indexes.size());
-	for (int i=0; i<(int)timepoints.size(); i++) {
-		if (indexes.at(i) >= (int)timepoints.at(i).size()) {
-			continue;
-		}
-		if (timepoints.at(i).at(indexes.at(i)).timestamp != minval) {
-			// not at the same time
-			continue;
-		}
-
-		getNoteList(notelist.at(i), humset[i], 
-			timepoints.at(i).at(indexes.at(i)).index[0], 
-			timepoints.at(i).at(indexes.at(i)).measure, i, indexes.at(i));
-
-
-	}
-	for (int i=0; i<(int)notelist.at(0).size(); i++) {
-		notelist.at(0).at(i).matched.resize(notelist.size());
-		fill(notelist.at(0).at(i).matched.begin(), notelist.at(0).at(i).matched.end(), -1);
-		notelist.at(0).at(i).matched.at(0) = i;
-		for (int j=1; j<(int)notelist.size(); j++) {
-			int status = findNoteInList(notelist.at(0).at(i), notelist.at(j));
-			notelist.at(0).at(i).matched.at(j) = status;
-			if ((status < 0) && !reportQ) {
-				markNote(notelist.at(0).at(i));
-			}
-		}
-	}
-
-	if (getBoolean("notes")) {
-		for (int i=0; i<(int)notelist.size(); i++) {
-			cerr << "========== NOTES FOR I=" << i << endl;
-			printNotePoints(notelist.at(i));
-			cerr << endl;
-		}
-	}
-
-	if (!reportQ) {
-		return;
-	}
-
-	// report
-	for (int i=0; i<(int)notelist.at(0).size(); i++) {
-		for (int j=1; j<(int)notelist.at(0).at(i).matched.size(); j++) {
-			if (notelist.at(0).at(i).matched.at(j) < 0) {
-				cout << "NOTE " << notelist.at(0).at(i).subtoken 
-				     << " DOES NOT HAVE EXACT MATCH IN SOURCE " << j << endl;
-				int humindex = notelist.at(0).at(i).token->getLineIndex();
-				cout << "\tREFERENCE MEASURE\t: " << notelist.at(0).at(i).measure << endl;
-				cout << "\tREFERENCE LINE NO.\t: " << humindex+1 << endl;
-				cout << "\tREFERENCE LINE TEXT\t: " << humset[0][humindex] << endl;
-
-				cout << "\tTARGET  " << j << " LINE NO. ";
-				if (j < 10) {
-					cout << " ";
-				}
-				cout << ":\t" << "X" << endl;
-
-				cout << "\tTARGET  " << j << " LINE TEXT";
-				if (j < 10) {
-					cout << " ";
-				}
-				cout << ":\t" << "X" << endl;
-
-				cout << endl;
-			}
-		}
-	}
-
-}
-
-
-
-//////////////////////////////
-//
-// Tool_humdiff::findNoteInList --
-//
-
-int Tool_humdiff::findNoteInList(NotePoint& np, vector<NotePoint>& nps) {
-	for (int i=0; i<(int)nps.size(); i++) {
-		// cerr << "COMPARING " << np.token << " (" << np.b40 << ") TO " << nps.at(i).token << " (" << nps.at(i).b40 << ") " << endl;
-		if (nps.at(i).processed) {
-			continue;
-		}
-		if (nps.at(i).b40 != np.b40) {
-			continue;
-		}
-		if (nps.at(i).duration != np.duration) {
-			continue;
-		}
-		return i;
-	}
-	// cerr << "\tCannot find note " << np.token << " on line " << np.token->getLineIndex() << " in other work" << endl;
-	return -1;
-}
-
-
-
-
 //////////////////////////////
 //
 // Tool_humdiff::getNoteList --
 //
 
-void Tool_humdiff::getNoteList(vector<NotePoint>& notelist, HumdrumFile& infile, int line, int measure, int sourceindex, int tpindex) {
+void Tool_humdiff::getNoteList(vector<NotePoint>& notelist, HumdrumFile& infile,
+		int line, int measure, int sourceindex, int tpindex, long long tickscale) {
+	long long tick = infile.getLineTick(line) * tickscale;
 	for (int i=0; i<infile[line].getFieldCount(); i++) {
 		HTp token = infile.token(line, i);
 		if (!token->isKern()) {
@@ -450,13 +665,16 @@ void Tool_humdiff::getNoteList(vector<NotePoint>& notelist, HumdrumFile& infile,
 			notelist.back().subtoken = subtok;
 			notelist.back().subindex = j;
 			notelist.back().measurequarter = token->getDurationFromBarline();
-			notelist.back().measure = 
+			notelist.back().measure = measure;
 			notelist.back().track = track;
 			notelist.back().layer = layer;
 			notelist.back().sourceindex = sourceindex;
 			notelist.back().tpindex = tpindex;
 			notelist.back().duration = token->getTiedDuration();
 			notelist.back().b40 = Convert::kernToBase40(subtok);
+			notelist.back().tick = tick;
+			notelist.back().durticks = infile.timeToTick(notelist.back().duration)
+					* tickscale;
 		}
 	}
 }
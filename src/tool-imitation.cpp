@@ -2,6 +2,7 @@
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sat Jun 17 15:24:23 CEST 2017
 // Last Modified: Fri Aug 11 18:25:50 EDT 2017
+// Last Modified: Sun Oct 18 17:24:10 PDT 2026 Store results in analysis columns
 // Filename:      tool-imitation.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/tool-imitation.cpp
 // Syntax:        C++11; humlib
@@ -53,6 +54,7 @@ Tool_imitation::Tool_imitation(void) {
 	define("R|rest2=b",           "require match target to also follow a rest");
 	define("i|intervals=s",       "require given interval sequence in imitation");
 	define("M|no-mark=b",         "do not mark matched sequences");
+	define("csv=b",               "print analysis as CSV data rather than adding spines");
 }
 
 
@@ -141,11 +143,19 @@ bool Tool_imitation::run(HumdrumFile& infile) {
 
 	string exinterp = getString("exinterp");
 	vector<HTp> kernspines = infile.getKernSpineStartList();
-	infile.appendDataSpine(results.back(), "", exinterp);
+	HumAnalysisColumn* column;
+	column = &infile.addAnalysisColumn(results.back(), "", exinterp);
+	column->setName(column->getName() + "-" + to_string(kernspines.back()->getTrack()));
 	for (int i = (int)results.size()-1; i>0; i--) {
 		int track = kernspines[i]->getTrack();
-		infile.insertDataSpineBefore(track, results[i-1], "", exinterp);
+		column = &infile.addAnalysisColumn(results[i-1], "", exinterp, track);
+		column->setName(column->getName() + "-" + to_string(kernspines[i-1]->getTrack()));
 	}
+	if (getBoolean("csv")) {
+		infile.printAnalysisCsv(m_free_text);
+		return true;
+	}
+	infile.renderAnalysisColumns();
 	infile.createLinesFromTokens();
 	if (m_mark && Enumerator) {
 		string rdfline = "!!!RDF**kern: ";
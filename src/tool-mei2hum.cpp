@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Wed Sep 13 14:58:26 PDT 2017
-// Last Modified: Thu Sep 21 13:10:56 PDT 2017
+// Last Modified: Sun Oct 18 23:44:12 PDT 2026 Added batch conversion
 // Filename:      mei2hum.cpp
 // URL:           https://github.com/craigsapp/mei2hum/blob/master/src/mei2hum.cpp
 // Syntax:        C++11; humlib
@@ -14,12 +14,17 @@
 #include "HumGrid.h"
 #include "HumRegex.h"
 #include "Convert.h"
+#include "HumParallel.h"
 
 #include <string.h>
 #include <stdlib.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cctype>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
 
 using namespace std;
 using namespace pugi;
@@ -62,21 +67,50 @@ Tool_mei2hum::Tool_mei2hum(void) {
 	define("r|recip=b", "output **recip spine");
 	define("s|stems=b", "include stems in output");
 	define("P|no-place=b", "Do not convert placement attribute");
+	define("j|threads=i:0", "number of files to convert at the same time (0 = all cores)");
+	define("outdir=s", "write each converted file into this directory");
+	define("report=b", "print conversion time and status of each file");
+
+	clear();
+}
+
 
-	m_maxverse.resize(m_maxstaff);
-	fill(m_maxverse.begin(), m_maxverse.end(), 0);
 
-	m_measureDuration.resize(m_maxstaff);
-	fill(m_measureDuration.begin(), m_measureDuration.end(), 0);
+//////////////////////////////
+//
+// Tool_mei2hum::clear -- Reset the information stored about the score
+//     being converted, so that the same tool object can be used to
+//     convert another file.
+//
 
-	m_currentMeterUnit.resize(m_maxstaff);
-	fill(m_currentMeterUnit.begin(), m_currentMeterUnit.end(), 4);
+void Tool_mei2hum::clear(void) {
+	m_scoreDef.clear();
+	m_staffcount = 0;
+	m_tupletfactor = 1;
+	m_outdata.clear();
+	m_currentLayer = 0;
+	m_currentStaff = 0;
+	m_maxStaffInFile = 0;
+	m_currentMeasure = -1;
+	m_currentMeterUnit.assign(m_maxstaff, 4);
+	m_beamPrefix.clear();
+	m_beamPostfix.clear();
+	m_aboveQ = false;
+	m_belowQ = false;
+	m_editorialAccidentalQ = false;
+	m_systemDecoration.clear();
 
-	m_hasDynamics.resize(m_maxstaff);
-	fill(m_hasDynamics.begin(), m_hasDynamics.end(), false);
+	m_maxverse.assign(m_maxstaff, 0);
+	m_measureDuration.assign(m_maxstaff, 0);
+	m_hasDynamics.assign(m_maxstaff, false);
+	m_hasHarm.assign(m_maxstaff, false);
 
-	m_hasHarm.resize(m_maxstaff);
-	fill(m_hasHarm.begin(), m_hasHarm.end(), false);
+	m_fermata = false;
+	m_gracenotes.clear();
+	m_gracetime = 0;
+	m_hairpins.clear();
+	m_startlinks.clear();
+	m_stoplinks.clear();
 }
 
 
@@ -84,19 +118,16 @@ Tool_mei2hum::Tool_mei2hum(void) {
 //////////////////////////////
 //
 // Tool_mei2hum::convert -- Convert an MEI file into
-//     Humdrum content.
+//     Humdrum content.  Returns false if the file cannot be read or
+//     converted (with the reason stored in the error text).
 //
 
 bool Tool_mei2hum::convertFile(ostream& out, const char* filename) {
 	xml_document doc;
-	auto result = doc.load_file(filename);
-	if (!result) {
-		cerr << "\nXML file [" << filename << "] has syntax errors\n";
-		cerr << "Error description:\t" << result.description() << "\n";
-		cerr << "Error offset:\t" << result.offset << "\n\n";
-		exit(1);
+	vector<char> buffer;
+	if (!loadFile(doc, buffer, filename)) {
+		return false;
 	}
-
 	return convert(out, doc);
 }
 
@@ -111,10 +142,10 @@ bool Tool_mei2hum::convert(ostream& out, const char* input) {
 	xml_document doc;
 	auto result = doc.load_string(input);
 	if (!result) {
-		cout << "\nXML content has syntax errors\n";
-		cout << "Error description:\t" << result.description() << "\n";
-		cout << "Error offset:\t" << result.offset << "\n\n";
-		exit(1);
+		m_error_text << "XML content has syntax errors\n";
+		m_error_text << "Error description:\t" << result.description() << "\n";
+		m_error_text << "Error offset:\t" << result.offset << "\n";
+		return false;
 	}
 
 	return convert(out, doc);
@@ -124,6 +155,7 @@ bool Tool_mei2hum::convert(ostream& out, const char* input) {
 
 bool Tool_mei2hum::convert(ostream& out, xml_document& doc) {
 	initialize();
+	clear();
 
 	bool status = true; // for keeping track of problems in conversion process.
 
@@ -132,10 +164,10 @@ bool Tool_mei2hum::convert(ostream& out, xml_document& doc) {
 	auto score = doc.select_node("/mei/music/body/mdiv/score").node();
 
 	if (!score) {
-		cerr << "Cannot find score, so cannot convert MEI file to Humdrum";
-		cerr << endl;
-		cerr << "Perhaps there is a problem in the XML structure of the file.";
-		cerr << endl;
+		m_error_text << "Cannot find score, so cannot convert MEI file to Humdrum";
+		m_error_text << endl;
+		m_error_text << "Perhaps there is a problem in the XML structure of the file.";
+		m_error_text << endl;
 		return false;
 	}
 
@@ -210,6 +242,223 @@ bool Tool_mei2hum::convert(ostream& out, xml_document& doc) {
 
 
 
+//////////////////////////////
+//
+// Tool_mei2hum::convertFiles -- Convert a list of MEI files, several at
+//     a time if more than one thread is used.  Each thread has its own
+//     copy of the tool, as well as an XML document and input buffer which
+//     are reused for each file that it converts.  With the --outdir option,
+//     each file is written to that directory; otherwise, the files are
+//     written to the output in their input order (with a !!!!SEGMENT:
+//     line before each file when there is more than one file).  Errors
+//     for a file do not stop the conversion of the other files, and files
+//     which could not be converted are left out of the output.  Returns
+//     false if any file could not be converted.  The --report table is
+//     stored in the free text of the tool.
+//
+
+bool Tool_mei2hum::convertFiles(ostream& out, const vector<string>& filenames) {
+	initialize();
+	int filecount = (int)filenames.size();
+	if (filecount == 0) {
+		return true;
+	}
+	int threads = std::min(m_threads, filecount);
+	bool directQ = !m_outdir.empty();
+	bool segmentQ = !directQ && (filecount > 1);
+	int batchsize = directQ ? filecount : threads * 8;
+
+	vector<double> times(filecount, 0.0);
+	vector<size_t> sizes(filecount, 0);
+	vector<string> errors(filecount);
+	vector<string> warnings(filecount);
+
+	vector<Tool_mei2hum> workers(threads);
+	vector<xml_document> docs(threads);
+	vector<vector<char>> buffers(threads);
+	for (int w=0; w<threads; w++) {
+		static_cast<Options&>(workers[w]) = *this;
+	}
+
+	auto wallstart = std::chrono::steady_clock::now();
+	for (int start=0; start<filecount; start+=batchsize) {
+		int count = std::min(batchsize, filecount - start);
+		vector<string> outputs(directQ ? 0 : count);
+		std::atomic<int> next(start);
+		HumParallel::run(threads, threads, [&](int w) {
+			Tool_mei2hum& worker = workers[w];
+			int i;
+			while ((i = next++) < start + count) {
+				auto starttime = std::chrono::steady_clock::now();
+				worker.m_error_text.str("");
+				worker.m_warning_text.str("");
+				stringstream output;
+				bool status = false;
+				try {
+					if (worker.loadFile(docs[w], buffers[w], filenames[i])) {
+						sizes[i] = buffers[w].size();
+						status = worker.convert(output, docs[w]);
+					}
+				} catch (std::exception& e) {
+					worker.m_error_text << "Error: " << e.what() << endl;
+					status = false;
+				}
+				docs[w].reset();
+				if (!status && (worker.m_error_text.tellp() == 0)) {
+					worker.m_error_text << "Error: cannot convert file" << endl;
+				}
+				if (status && directQ) {
+					string filename = getOutputFilename(filenames[i]);
+					ofstream outfile(filename);
+					outfile << output.str();
+					if (!outfile) {
+						worker.m_error_text << "Error: cannot write to file: "
+						                    << filename << endl;
+					}
+				} else if (!directQ) {
+					outputs[i - start] = output.str();
+				}
+				errors[i] = worker.m_error_text.str();
+				warnings[i] = worker.m_warning_text.str();
+				times[i] = std::chrono::duration<double, std::milli>(
+						std::chrono::steady_clock::now() - starttime).count();
+			}
+		});
+		for (int k=0; k<(int)outputs.size(); k++) {
+			if (!errors[start + k].empty()) {
+				// The file is left out of the output (the error is reported
+				// separately).
+				continue;
+			}
+			if (segmentQ) {
+				out << "!!!!SEGMENT: " << filenames[start + k] << "\n";
+			}
+			out << outputs[k];
+		}
+	}
+	double wallclock = std::chrono::duration<double, std::milli>(
+			std::chrono::steady_clock::now() - wallstart).count();
+
+	bool status = true;
+	for (int i=0; i<filecount; i++) {
+		if (!warnings[i].empty()) {
+			m_warning_text << "File " << filenames[i] << ":\n" << warnings[i];
+		}
+		if (!errors[i].empty()) {
+			status = false;
+			m_error_text << "Error converting file " << filenames[i] << ":\n"
+			             << errors[i];
+		}
+	}
+	if (m_reportQ) {
+		printReport(m_free_text, filenames, times, sizes, errors, wallclock);
+	}
+	return status;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_mei2hum::loadFile -- Read an MEI file into the buffer and parse
+//     it in place, so that the buffer memory (and the memory of the XML
+//     document) can be reused for the next file.  The buffer must not be
+//     changed while the document is in use.
+//
+
+bool Tool_mei2hum::loadFile(xml_document& doc, vector<char>& buffer,
+		const string& filename) {
+	ifstream input(filename, ios::binary);
+	if (!input.is_open()) {
+		m_error_text << "Error: cannot read file: " << filename << endl;
+		return false;
+	}
+	input.seekg(0, ios::end);
+	std::streamoff size = input.tellg();
+	input.seekg(0, ios::beg);
+	buffer.resize(size > 0 ? (size_t)size : 0);
+	if ((size > 0) && !input.read(buffer.data(), size)) {
+		m_error_text << "Error: cannot read file: " << filename << endl;
+		return false;
+	}
+	auto result = doc.load_buffer_inplace(buffer.data(), buffer.size());
+	if (!result) {
+		m_error_text << "XML file [" << filename << "] has syntax errors\n";
+		m_error_text << "Error description:\t" << result.description() << "\n";
+		m_error_text << "Error offset:\t" << result.offset << "\n";
+		return false;
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_mei2hum::getOutputFilename -- Return the name of the file for
+//     the conversion of an MEI file when using the --outdir option: the
+//     directory and extension of the input filename are replaced.
+//
+
+string Tool_mei2hum::getOutputFilename(const string& filename) {
+	string base = filename;
+	auto slash = base.find_last_of("/\\");
+	if (slash != string::npos) {
+		base = base.substr(slash + 1);
+	}
+	auto dot = base.rfind('.');
+	if ((dot != string::npos) && (dot > 0)) {
+		base.resize(dot);
+	}
+	string output = m_outdir;
+	if (!output.empty() && (output.back() != '/')) {
+		output += '/';
+	}
+	return output + base + ".krn";
+}
+
+
+
+//////////////////////////////
+//
+// Tool_mei2hum::printReport -- Print the conversion time, input size and
+//     status of each file, followed by a summary line with the throughput
+//     for the elapsed time of the whole conversion.
+//
+
+void Tool_mei2hum::printReport(ostream& out, const vector<string>& filenames,
+		vector<double>& times, vector<size_t>& sizes, vector<string>& errors,
+		double wallclock) {
+	double total = 0.0;
+	double bytes = 0.0;
+	int failures = 0;
+	out << "!!file\tmsec\tbytes\tstatus\n";
+	for (int i=0; i<(int)filenames.size(); i++) {
+		total += times[i];
+		bytes += sizes[i];
+		if (!errors[i].empty()) {
+			failures++;
+		}
+		out << filenames[i] << "\t"
+		    << std::fixed << std::setprecision(3) << times[i] << "\t"
+		    << sizes[i] << "\t"
+		    << (errors[i].empty() ? "ok" : "error") << "\n";
+	}
+	double seconds = wallclock / 1000.0;
+	out << "!!files: " << filenames.size() << ", errors: " << failures
+	    << ", total msec: " << std::fixed << std::setprecision(3) << total
+	    << ", elapsed msec: " << wallclock;
+	if (seconds > 0.0) {
+		out << ", files/sec: " << std::setprecision(1)
+		    << filenames.size() / seconds
+		    << ", MB/sec: " << std::setprecision(3)
+		    << bytes / 1000000.0 / seconds;
+	}
+	out << "\n";
+}
+
+
+
 //////////////////////////////
 //
 // Tool_mei2hum::processHairpins --
@@ -240,7 +489,7 @@ void Tool_mei2hum::processHairpin(hairpin_info& info) {
 	string form    = hairpin.attribute("form").value();
 	string staff   = hairpin.attribute("staff").value();
 	if (staff == "") {
-		cerr << "Error: hairpin requires a staff number" << endl;
+		m_warning_text << "Error: hairpin requires a staff number" << endl;
 		return;
 	}
 
@@ -504,7 +753,7 @@ HumNum Tool_mei2hum::parseScore(xml_node score, HumNum starttime) {
 		} else if (nodename == "section") {
 			starttime = parseSection(item, starttime);
 		} else {
-			cerr << DKHTP << score.name() << "/" << nodename << CURRLOC << endl;
+			m_warning_text << DKHTP << score.name() << "/" << nodename << CURRLOC << endl;
 		}
 	}
 
@@ -540,7 +789,7 @@ void Tool_mei2hum::parseScoreDef(xml_node scoreDef, HumNum starttime) {
 		} else if (nodename == "pgFoot") {
 		    processPgFoot(item, starttime);
 		} else {
-			cerr << DKHTP << scoreDef.name() << "/" << nodename << CURRLOC << endl;
+			m_warning_text << DKHTP << scoreDef.name() << "/" << nodename << CURRLOC << endl;
 		}
 	}
 
@@ -608,12 +857,12 @@ void Tool_mei2hum::getRecursiveSDString(string& output, xml_node current) {
 	if (name == "staffDef") {
 		xml_attribute natt = current.attribute("n");
 		if (!natt) {
-			cerr << "Error: unknown staff number for staffDef" << endl;
+			m_warning_text << "Error: unknown staff number for staffDef" << endl;
 			return;
 		}
 		int n = natt.as_int();
 		if (n < 1) {
-			cerr << "Staff number " << n << " must be positive" << endl;
+			m_warning_text << "Staff number " << n << " must be positive" << endl;
 			return;
 		}
 		output += "s" + to_string(n);
@@ -661,7 +910,7 @@ void Tool_mei2hum::getRecursiveSDString(string& output, xml_node current) {
 	} else if (name == "pgFoot") {
 		return;
 	} else {
-		cerr << "Unknown element in scoreDef descendant: " << name << endl;
+		m_warning_text << "Unknown element in scoreDef descendant: " << name << endl;
 	}
 }
 
@@ -707,7 +956,7 @@ void Tool_mei2hum::parseStaffGrp(xml_node staffGrp, HumNum starttime) {
 		} else if (nodename == "staffDef") {
 		    parseStaffDef(item, starttime);
 		} else {
-			cerr << DKHTP << staffGrp.name() << "/" << nodename << CURRLOC << endl;
+			m_warning_text << DKHTP << staffGrp.name() << "/" << nodename << CURRLOC << endl;
 		}
 	}
 
@@ -979,7 +1228,7 @@ void Tool_mei2hum::fillWithStaffDefAttributes(mei_staffDef& staffinfo, xml_node
 				m_currentMeterUnit.at(nnum-1) = stoi(meterunit);
 			}
 		} else {
-			cerr << DKHTP << element.name() << "@meter.count/@meter.unit" << CURRLOC << endl;
+			m_warning_text << DKHTP << element.name() << "@meter.count/@meter.unit" << CURRLOC << endl;
 		}
 
 		staffinfo.timesig = "*M" + metercount + "/" + meterunit;
@@ -1065,7 +1314,7 @@ HumNum Tool_mei2hum::parseSection(xml_node section, HumNum starttime) {
 		} else if (nodename == "staffDef") {   // will this have any useful info?
 		   // ignore for now
 		} else {
-			cerr << DKHTP << section.name() << "/" << nodename << CURRLOC << endl;
+			m_warning_text << DKHTP << section.name() << "/" << nodename << CURRLOC << endl;
 		}
 	}
 
@@ -1090,7 +1339,7 @@ void Tool_mei2hum::parseSectionScoreDef(xml_node scoreDef, HumNum starttime) {
 
 	for (int i=0; i<(int)children.size(); i++) {
 		string nodename = children[i].name();
-		cerr << DKHTP << scoreDef.name() << "/" << nodename << CURRLOC << endl;
+		m_warning_text << DKHTP << scoreDef.name() << "/" << nodename << CURRLOC << endl;
 	}
 }
 
@@ -1109,7 +1358,7 @@ void Tool_mei2hum::parsePb(xml_node pb, HumNum starttime) {
 	// There should be no children of pb (at least any that are currently known)
 	for (int i=0; i<(int)children.size(); i++) {
 		string nodename = children[i].name();
-		cerr << DKHTP << pb.name() << "/" << nodename << CURRLOC << endl;
+		m_warning_text << DKHTP << pb.name() << "/" << nodename << CURRLOC << endl;
 	}
 
 	m_outdata.back()->appendGlobalLayout("!!LO:LB", starttime QUARTER_CONVERT);
@@ -1129,7 +1378,7 @@ void Tool_mei2hum::parseSb(xml_node sb, HumNum starttime) {
 	// There should be no children of sb (at least any that are currently known)
 	for (int i=0; i<(int)children.size(); i++) {
 		string nodename = children[i].name();
-		cerr << DKHTP << sb.name() << "/" << nodename << CURRLOC << endl;
+		m_warning_text << DKHTP << sb.name() << "/" << nodename << CURRLOC << endl;
 	}
 
 	m_outdata.back()->appendGlobalLayout("!!LO:LB", starttime QUARTER_CONVERT);
@@ -1169,7 +1418,7 @@ HumNum Tool_mei2hum::parseApp(xml_node app, HumNum starttime) {
 	} else if (nodename == "rdg") {
 		starttime = parseRdg(target, starttime);
 	} else {
-		cerr << DKHTP << app.name() << "/" << nodename << CURRLOC << endl;
+		m_warning_text << DKHTP << app.name() << "/" << nodename << CURRLOC << endl;
 	}
 
 	return starttime;
@@ -1193,7 +1442,7 @@ HumNum Tool_mei2hum::parseLem(xml_node lem, HumNum starttime) {
 		} else if (nodename == "measure") {
 			starttime = parseMeasure(children[i], starttime);
 		} else {
-			cerr << DKHTP << lem.name() << "/" << nodename << CURRLOC << endl;
+			m_warning_text << DKHTP << lem.name() << "/" << nodename << CURRLOC << endl;
 		}
 	}
 
@@ -1218,7 +1467,7 @@ HumNum Tool_mei2hum::parseRdg(xml_node rdg, HumNum starttime) {
 		} else if (nodename == "measure") {
 			starttime = parseMeasure(children[i], starttime);
 		} else {
-			cerr << DKHTP << rdg.name() << "/" << nodename << CURRLOC << endl;
+			m_warning_text << DKHTP << rdg.name() << "/" << nodename << CURRLOC << endl;
 		}
 	}
 
@@ -1244,7 +1493,7 @@ HumNum Tool_mei2hum::parseMeasure(xml_node measure, HumNum starttime) {
 		nnum = stoi(n);
 	}
 	if (nnum < 0) {
-		cerr << "Error: invalid measure number: " << nnum << endl;
+		m_warning_text << "Error: invalid measure number: " << nnum << endl;
 	}
 	m_currentMeasure = nnum;
 
@@ -1282,7 +1531,7 @@ HumNum Tool_mei2hum::parseMeasure(xml_node measure, HumNum starttime) {
 		} else if (nodename == "reh") {
 			parseReh(children[i], starttime);
 		} else {
-			cerr << DKHTP << measure.name() << "/" << nodename << CURRLOC << endl;
+			m_warning_text << DKHTP << measure.name() << "/" << nodename << CURRLOC << endl;
 		}
 	}
 
@@ -1324,7 +1573,7 @@ HumNum Tool_mei2hum::parseMeasure(xml_node measure, HumNum starttime) {
 				message << ", staff " << i+1 << " is underfilled: ";
 				message << "adding token " << spacer;
 				message << " at end of measure to complete its duration.";
-				cerr << message.str() << endl;
+				m_warning_text << message.str() << endl;
 
 				// Add an invisible rest to fill in the problem spot.
 				// staff with multiple layers will have to be addressed as well...
@@ -1341,7 +1590,7 @@ HumNum Tool_mei2hum::parseMeasure(xml_node measure, HumNum starttime) {
 				message << (durations[i] QUARTER_CONVERT).getFloat();
 				message << " quarter notes instead of ";
 				message << targetDur.getFloat() * 4 << ".";
-				cerr << message.str() << endl;
+				m_warning_text << message.str() << endl;
 				m_outdata.back()->addGlobalComment("!!" + message.str(), starttime QUARTER_CONVERT);
 
 				overfilledQ = true;
@@ -1413,7 +1662,7 @@ void Tool_mei2hum::parseHairpin(xml_node hairpin, HumNum starttime) {
 
 	for (int i=0; i<(int)children.size(); i++) {
 		string nodename = children[i].name();
-		cerr << DKHTP << hairpin.name() << "/" << nodename << CURRLOC << endl;
+		m_warning_text << DKHTP << hairpin.name() << "/" << nodename << CURRLOC << endl;
 	}
 
 	// Store the hairpin for later parsing when more of the
@@ -1444,7 +1693,7 @@ void Tool_mei2hum::parseReh(xml_node reh, HumNum starttime) {
 		if (nodename == "rend") {
 			// deal with reh/rend here.
 		} else {
-			cerr << DKHTP << reh.name() << "/" << nodename << CURRLOC << endl;
+			m_warning_text << DKHTP << reh.name() << "/" << nodename << CURRLOC << endl;
 		}
 	}
 
@@ -1464,12 +1713,12 @@ HumNum Tool_mei2hum::parseStaff(xml_node staff, HumNum starttime) {
 	string n = staff.attribute("n").value();
 	int nnum = 0;
 	if (n.empty()) {
-		cerr << "Warning: no staff number on staff element in measure " << m_currentMeasure << endl;
+		m_warning_text << "Warning: no staff number on staff element in measure " << m_currentMeasure << endl;
 	} else {
 		nnum = stoi(n);
 	}
 	if (nnum < 1) {
-		cerr << "Error: invalid staff number: " << nnum << endl;
+		m_warning_text << "Error: invalid staff number: " << nnum << endl;
 		m_currentStaff++;
 	} else {
 		m_currentStaff = nnum;
@@ -1487,7 +1736,7 @@ HumNum Tool_mei2hum::parseStaff(xml_node staff, HumNum starttime) {
 		if (nodename == "layer") {
 			durations.push_back(parseLayer(children[i], starttime, layerPresent) - starttime);
 		} else {
-			cerr << DKHTP << staff.name() << "/" << nodename << CURRLOC << endl;
+			m_warning_text << DKHTP << staff.name() << "/" << nodename << CURRLOC << endl;
 		}
 	}
 
@@ -1506,7 +1755,7 @@ HumNum Tool_mei2hum::parseStaff(xml_node staff, HumNum starttime) {
 	}
 	if (!complete) {
 		// need to add invisible rests in un-specified layers.
-		cerr << "INCOMPLETE LAYERS IN STAFF" << endl;
+		m_warning_text << "INCOMPLETE LAYERS IN STAFF" << endl;
 	}
 
 	// Check that the duration of each layer is the same here.
@@ -1550,13 +1799,13 @@ HumNum Tool_mei2hum::parseLayer(xml_node layer, HumNum starttime, vector<bool>&
 		nnum = nattr.as_int();
 	}
 	if (nnum < 1) {
-		cerr << "Error: Ignoring layer with invalid number: " << nnum
+		m_warning_text << "Error: Ignoring layer with invalid number: " << nnum
 		     << " in measure " << m_currentMeasure
 		     << ", staff " << m_currentStaff << endl;
 		return starttime;
 	}
 	if (nnum > 8) {
-		cerr << "Error: Ignoring layer with ridiculous number: " << nnum
+		m_warning_text << "Error: Ignoring layer with ridiculous number: " << nnum
 		     << " in measure " << m_currentMeasure
 		     << ", staff " << m_currentStaff << endl;
 		return starttime;
@@ -1583,7 +1832,7 @@ HumNum Tool_mei2hum::parseLayer(xml_node layer, HumNum starttime, vector<bool>&
 
 
 	if (layerPresent.at(m_currentLayer - 1)) {
-		cerr << "Error: measure " << m_currentMeasure
+		m_warning_text << "Error: measure " << m_currentMeasure
 		     << ", staff " << m_currentStaff
 		     << ": layer " << m_currentLayer << " is duplicated on staff: "
 		     << m_currentStaff << ". Ignoring duplicate layer." << endl;
@@ -1614,7 +1863,7 @@ HumNum Tool_mei2hum::parseLayer(xml_node layer, HumNum starttime, vector<bool>&
 		} else if (nodename == "clef") {
 			parseClef(children[i], starttime);
 		} else {
-			cerr << DKHTP << layer.name() << "/" << nodename << CURRLOC << endl;
+			m_warning_text << DKHTP << layer.name() << "/" << nodename << CURRLOC << endl;
 		}
 	}
 
@@ -1642,13 +1891,13 @@ HumNum Tool_mei2hum::parseTuplet(xml_node tuplet, HumNum starttime) {
 	HumNum newfactor = 1;
 
 	if (numbase == "") {
-		cerr << "Warning: tuplet@numbase is empty" << endl;
+		m_warning_text << "Warning: tuplet@numbase is empty" << endl;
 	} else {
 		newfactor = stoi(numbase);
 	}
 
 	if (num == "") {
-		cerr << "Warning: tuplet@num is empty" << endl;
+		m_warning_text << "Warning: tuplet@num is empty" << endl;
 	} else {
 		newfactor /= stoi(num);
 	}
@@ -1691,7 +1940,7 @@ HumNum Tool_mei2hum::parseTuplet(xml_node tuplet, HumNum starttime) {
 		} else if (nodename == "beam") {
 			starttime = parseBeam(children[i], starttime);
 		} else {
-			cerr << DKHTP << tuplet.name() << "/" << nodename << CURRLOC << endl;
+			m_warning_text << DKHTP << tuplet.name() << "/" << nodename << CURRLOC << endl;
 		}
 	}
 
@@ -1753,7 +2002,7 @@ HumNum Tool_mei2hum::parseBeam(xml_node beam, HumNum starttime) {
 		} else if (nodename == "tuplet") {
 			starttime = parseTuplet(children[i], starttime);
 		} else {
-			cerr << DKHTP << beam.name() << "/" << nodename << CURRLOC << endl;
+			m_warning_text << DKHTP << beam.name() << "/" << nodename << CURRLOC << endl;
 		}
 	}
 
@@ -1840,7 +2089,7 @@ void Tool_mei2hum::processGraceNotes(HumNum timestamp) {
 			m_beamPostfix = m_gracenotes[i].beampostfix;
 			parseChord(m_gracenotes[i].node, m_gracetime, counter);
 		} else {
-			cerr << "STRANGE THING HAPPENED HERE, node name is " << nodename << endl;
+			m_warning_text << "STRANGE THING HAPPENED HERE, node name is " << nodename << endl;
 		}
 		counter++;
 	}
@@ -1873,9 +2122,9 @@ HumNum Tool_mei2hum::parseNote(xml_node note, xml_node chord, string& output,
 					// Grace notes at end of previous measure which
 					// should have been processed before coming into the
 					// next measure.
-					cerr << "STRANGE ERROR IN GRACE NOTE PARSING" << endl;
-					cerr << "\tSTARTTIME: " << starttime << endl;
-					cerr << "\tGRACETIME: " << m_gracetime << endl;
+					m_warning_text << "STRANGE ERROR IN GRACE NOTE PARSING" << endl;
+					m_warning_text << "\tSTARTTIME: " << starttime << endl;
+					m_warning_text << "\tGRACETIME: " << m_gracetime << endl;
 				}
 			} else {
 				m_gracetime = starttime;
@@ -1988,7 +2237,7 @@ HumNum Tool_mei2hum::parseNote(xml_node note, xml_node chord, string& output,
 		} else if (nodename == "accid") {
 			// handled elsewhere: don't do anything
 		} else {
-			cerr << DKHTP << note.name() << "/" << nodename << CURRLOC << endl;
+			m_warning_text << DKHTP << note.name() << "/" << nodename << CURRLOC << endl;
 		}
 	}
 
@@ -2478,7 +2727,7 @@ void Tool_mei2hum::processNodeStartLinks(string& output, xml_node node,
 		} else if (nodename == "tupletSpan") {
 			// handled in processNodeStartLinks2
 		} else {
-			cerr << DKHTP << nodename
+			m_warning_text << DKHTP << nodename
 			     << " element in processNodeStartLinks()" << endl;
 		}
 	}
@@ -2518,14 +2767,14 @@ void Tool_mei2hum::parseTupletSpanStart(xml_node node,
 	NODE_VERIFY(tupletSpan, )
 
 	if (strcmp(tupletSpan.attribute("endid").value(), "") == 0) {
-		cerr << "Warning: <tupletSpan> requires endid attribute (at least ";
-		cerr << "for this parser)" << endl;
+		m_warning_text << "Warning: <tupletSpan> requires endid attribute (at least ";
+		m_warning_text << "for this parser)" << endl;
 		return;
 	}
 
 	if (strcmp(tupletSpan.attribute("startid").value(), "") == 0) {
-		cerr << "Warning: <tupletSpan> requires startid attribute (at least ";
-		cerr << "for this parser)" << endl;
+		m_warning_text << "Warning: <tupletSpan> requires startid attribute (at least ";
+		m_warning_text << "for this parser)" << endl;
 		return;
 	}
 
@@ -2535,13 +2784,13 @@ void Tool_mei2hum::parseTupletSpanStart(xml_node node,
 	HumNum newfactor = 1;
 
 	if (numbase == "") {
-		cerr << "Warning: tuplet@numbase is empty" << endl;
+		m_warning_text << "Warning: tuplet@numbase is empty" << endl;
 	} else {
 		newfactor = stoi(numbase);
 	}
 
 	if (num == "") {
-		cerr << "Warning: tuplet@num is empty" << endl;
+		m_warning_text << "Warning: tuplet@num is empty" << endl;
 	} else {
 		newfactor /= stoi(num);
 	}
@@ -2578,13 +2827,13 @@ void Tool_mei2hum::parseTupletSpanStop(string& output, xml_node node,
 	HumNum newfactor = 1;
 
 	if (numbase == "") {
-		cerr << "Warning: tuplet@numbase is empty" << endl;
+		m_warning_text << "Warning: tuplet@numbase is empty" << endl;
 	} else {
 		newfactor = stoi(numbase);
 	}
 
 	if (num == "") {
-		cerr << "Warning: tuplet@num is empty" << endl;
+		m_warning_text << "Warning: tuplet@num is empty" << endl;
 	} else {
 		newfactor /= stoi(num);
 	}
@@ -2606,7 +2855,7 @@ void Tool_mei2hum::parseArpeg(string& output, xml_node node, xml_node arpeg) {
 	NODE_VERIFY(arpeg, )
 
 	if (strcmp(arpeg.attribute("endid").value(), "") != 0) {
-		cerr << "Warning: multi-note arpeggios are not yet handled in the converter." << endl;
+		m_warning_text << "Warning: multi-note arpeggios are not yet handled in the converter." << endl;
 	}
 
 	string nodename = node.name();
@@ -2624,7 +2873,7 @@ void Tool_mei2hum::parseArpeg(string& output, xml_node node, xml_node arpeg) {
 		}
 		output += ':';
 	} else {
-		cerr << DKHTP << "an arpeggio attached to a "
+		m_warning_text << DKHTP << "an arpeggio attached to a "
 		     << nodename << " element" << endl;
 		return;
 	}
@@ -2649,7 +2898,7 @@ void Tool_mei2hum::processNodeStopLinks(string& output, xml_node node,
 		} else if (nodename == "tupletSpan") {
 			parseTupletSpanStop(output, node, nodelist[i]);
 		} else {
-			cerr << DKHTP << nodename
+			m_warning_text << DKHTP << nodename
 			     << " element in processNodeStopLinks()" << endl;
 		}
 	}
@@ -2670,7 +2919,7 @@ void Tool_mei2hum::parseSlurStart(string& output, xml_node node, xml_node slur)
 	} else if (nodename == "chord") {
 		output = "(" + setPlacement(slur.attribute("curvedir").value()) + output;
 	} else {
-		cerr << DKHTP << "a slur start attached to a "
+		m_warning_text << DKHTP << "a slur start attached to a "
 		     << nodename << " element" << endl;
 		return;
 	}
@@ -2692,7 +2941,7 @@ void Tool_mei2hum::parseSlurStop(string& output, xml_node node, xml_node slur) {
 	} else if (nodename == "chord") {
 		output += ")";
 	} else {
-		cerr << DKHTP << "a tie end attached to a "
+		m_warning_text << DKHTP << "a tie end attached to a "
 		     << nodename << " element" << endl;
 		return;
 	}
@@ -2725,7 +2974,7 @@ void Tool_mei2hum::parseTieStart(string& output, xml_node node, xml_node tie) {
 	if (nodename == "note") {
 		output = "[" + output;
 	} else {
-		cerr << DKHTP << "a tie start attached to a "
+		m_warning_text << DKHTP << "a tie start attached to a "
 		     << nodename << " element" << endl;
 		return;
 	}
@@ -2785,7 +3034,7 @@ void Tool_mei2hum::parseTieStop(string& output, xml_node node, xml_node tie) {
 	if (nodename == "note") {
 		output += "]";
 	} else {
-		cerr << DKHTP << "a tie end attached to a "
+		m_warning_text << DKHTP << "a tie end attached to a "
 		     << nodename << " element" << endl;
 		return;
 	}
@@ -2810,7 +3059,7 @@ void Tool_mei2hum::parseFermata(string& output, xml_node node, xml_node fermata)
 	} else if (nodename == "rest") {
 		output += ';';
 	} else {
-		cerr << DKHTP << "a fermata attached to a "
+		m_warning_text << DKHTP << "a fermata attached to a "
 		     << nodename << " element" << endl;
 		return;
 	}
@@ -2934,15 +3183,15 @@ string Tool_mei2hum::getHumdrumPitch(xml_node note, vector<xml_node>& children)
 	int octnum = 4;
 	string oct = note.attribute("oct").value();
 	if (oct == "") {
-		cerr << "Empty octave" << endl;
+		m_warning_text << "Empty octave" << endl;
 	} else if (isdigit(oct[0])) {
 		octnum = stoi(oct);
 	} else {
-		cerr << "Unknown octave value: " << oct << endl;
+		m_warning_text << "Unknown octave value: " << oct << endl;
 	}
 
 	if (pname == "") {
-		cerr << "Empty pname" << endl;
+		m_warning_text << "Empty pname" << endl;
 		return "x";
 	}
 
@@ -3040,12 +3289,12 @@ HumNum Tool_mei2hum::getDuration(xml_node element) {
 		output = 1;
 		output /= stoi(dur);
 	} else {
-		cerr << "Unknown " << element.name() << "@dur: " << dur << endl;
+		m_warning_text << "Unknown " << element.name() << "@dur: " << dur << endl;
 		return 0;
 	}
 
 	if (output == 0) {
-		cerr << "Error: zero duration for note" << endl;
+		m_warning_text << "Error: zero duration for note" << endl;
 	}
 
 	int dotcount;
@@ -3055,7 +3304,7 @@ HumNum Tool_mei2hum::getDuration(xml_node element) {
 	} else if (isdigit(dots[0])) {
 		dotcount = stoi(dots);
 	} else {
-		cerr << "Unknown " << element.name() << "@dotcount: " << dur << endl;
+		m_warning_text << "Unknown " << element.name() << "@dotcount: " << dur << endl;
 		return 0;
 	}
 
@@ -3088,13 +3337,13 @@ void Tool_mei2hum::parseVerse(xml_node verse, GridStaff* staff) {
 	string n = verse.attribute("n").value();
 	int nnum = 1;
 	if (n.empty()) {
-		cerr << "Warning: no layer number on layer element" << endl;
+		m_warning_text << "Warning: no layer number on layer element" << endl;
 	} else {
 		nnum = stoi(n);
 	}
 	if (nnum < 1) {
-		cerr << "Warning: invalid layer number: " << nnum << endl;
-		cerr << "Setting it to 1." << endl;
+		m_warning_text << "Warning: invalid layer number: " << nnum << endl;
+		m_warning_text << "Setting it to 1." << endl;
 		nnum = 1;
 	}
 
@@ -3110,7 +3359,7 @@ void Tool_mei2hum::parseVerse(xml_node verse, GridStaff* staff) {
 			sylcount++;
 			versetext += parseSyl(children[i]);
 		} else {
-			cerr << DKHTP << verse.name() << "/" << nodename << CURRLOC << endl;
+			m_warning_text << DKHTP << verse.name() << "/" << nodename << CURRLOC << endl;
 		}
 	}
 
@@ -3143,8 +3392,8 @@ void Tool_mei2hum::parseBareSyl(xml_node syl, GridStaff* staff) {
 	}
 
 	if (nnum < 1) {
-		cerr << "Warning: invalid layer number: " << nnum << endl;
-		cerr << "Setting it to 1." << endl;
+		m_warning_text << "Warning: invalid layer number: " << nnum << endl;
+		m_warning_text << "Setting it to 1." << endl;
 		nnum = 1;
 	}
 
@@ -3296,7 +3545,7 @@ HumNum Tool_mei2hum::parseChord(xml_node chord, HumNum starttime, int gracenumbe
 		} else if (nodename == "artic") {
 			// This is handled within parseNote();
 		} else {
-			cerr << DKHTP << chord.name() << "/" << nodename << CURRLOC << endl;
+			m_warning_text << DKHTP << chord.name() << "/" << nodename << CURRLOC << endl;
 		}
 	}
 
@@ -3342,6 +3591,9 @@ void Tool_mei2hum::initialize(void) {
 	m_stemsQ   =  getBoolean("stems");
 	m_appLabel =  getString("app-label");
 	m_placeQ   = !getBoolean("no-place");
+	m_threads  =  HumParallel::getThreadCount(getInteger("threads"));
+	m_outdir   =  getString("outdir");
+	m_reportQ  =  getBoolean("report");
 }
 
 
@@ -3461,7 +3713,7 @@ void Tool_mei2hum::parseDir(xml_node dir, HumNum starttime) {
 				count++;
 				text += children[i].value();
 			} else {
-				cerr << DKHTP << dir.name() << "/" << nodename << CURRLOC << endl;
+				m_warning_text << DKHTP << dir.name() << "/" << nodename << CURRLOC << endl;
 			}
 		}
 	}
@@ -3479,20 +3731,20 @@ void Tool_mei2hum::parseDir(xml_node dir, HumNum starttime) {
 
 	string ts = dir.attribute("tstamp").value();
 	if (ts.empty()) {
-		cerr << "Error: no timestamp on dir element and can't currently processes with @startid." << endl;
+		m_warning_text << "Error: no timestamp on dir element and can't currently processes with @startid." << endl;
 		return;
 	}
 
 	xml_attribute atstaffnum = dir.attribute("staff");
 	if (!atstaffnum) {
-		cerr << "Error: staff number required on dir element in measure "
+		m_warning_text << "Error: staff number required on dir element in measure "
 		     << m_currentMeasure  << " (ignoring text: " << cleanWhiteSpace(text) << ")" << endl;
 		return;
 	}
 	int staffnum = dir.attribute("staff").as_int();
 	if (staffnum <= 0) {
-		cerr << "Error: staff number on dir element in measure should be positive.\n";
-		cerr << "Instead the staff number is: " << m_currentMeasure  << " (ignoring text: " <<  cleanWhiteSpace(text) << ")" << endl;
+		m_warning_text << "Error: staff number on dir element in measure should be positive.\n";
+		m_warning_text << "Instead the staff number is: " << m_currentMeasure  << " (ignoring text: " <<  cleanWhiteSpace(text) << ")" << endl;
 		return;
 	}
 
@@ -3556,7 +3808,7 @@ void Tool_mei2hum::parseDir(xml_node dir, HumNum starttime) {
 		break;
 	}
 	if (!foundslice) {
-		cerr << "Warning: dir elements not occuring at note/rest times are not yet supported" << endl;
+		m_warning_text << "Warning: dir elements not occuring at note/rest times are not yet supported" << endl;
 	}
 }
 
@@ -3907,7 +4159,7 @@ void Tool_mei2hum::parseHarm(xml_node harm, HumNum starttime) {
 				count++;
 				text += children[i].value();
 			} else {
-				cerr << DKHTP << harm.name() << "/" << nodename << CURRLOC << endl;
+				m_warning_text << DKHTP << harm.name() << "/" << nodename << CURRLOC << endl;
 			}
 		}
 	}
@@ -3924,7 +4176,7 @@ void Tool_mei2hum::parseHarm(xml_node harm, HumNum starttime) {
 
 	int staffnum = harm.attribute("staff").as_int();
 	if (staffnum == 0) {
-		cerr << "Error: staff number required on harm element" << endl;
+		m_warning_text << "Error: staff number required on harm element" << endl;
 		return;
 	}
 	double meterunit = m_currentMeterUnit[staffnum - 1];
@@ -3932,13 +4184,13 @@ void Tool_mei2hum::parseHarm(xml_node harm, HumNum starttime) {
 	if (!startid.empty()) {
 		// Harmony is (or at least should) be attached directly
 		// do a note, so it is handled elsewhere.
-		cerr << "Warning DYNAMIC " << text << " is not yet processed." << endl;
+		m_warning_text << "Warning DYNAMIC " << text << " is not yet processed." << endl;
 		return;
 	}
 
 	string ts = harm.attribute("tstamp").value();
 	if (ts.empty()) {
-		cerr << "Error: no timestamp on harm element" << endl;
+		m_warning_text << "Error: no timestamp on harm element" << endl;
 		return;
 	}
 	double tsd = (stof(ts)-1) * 4.0 / meterunit;
@@ -3972,7 +4224,7 @@ void Tool_mei2hum::parseHarm(xml_node harm, HumNum starttime) {
 	}
 	if (!foundslice) {
 		if (nextgs == NULL) {
-			cerr << "Warning: harmony not attched to system events "
+			m_warning_text << "Warning: harmony not attched to system events "
 					<< "are not yet supported in measure " << m_currentMeasure << endl;
 		} else {
 			GridPart* part = nextgs->at(staffnum-1);
@@ -4025,7 +4277,7 @@ void Tool_mei2hum::parseDynam(xml_node dynam, HumNum starttime) {
 				count++;
 				text += children[i].value();
 			} else {
-				cerr << DKHTP << dynam.name() << "/" << nodename << CURRLOC << endl;
+				m_warning_text << DKHTP << dynam.name() << "/" << nodename << CURRLOC << endl;
 			}
 		}
 	}
@@ -4038,7 +4290,7 @@ void Tool_mei2hum::parseDynam(xml_node dynam, HumNum starttime) {
 
 	int staffnum = dynam.attribute("staff").as_int();
 	if (staffnum == 0) {
-		cerr << "Error: staff number required on dynam element" << endl;
+		m_warning_text << "Error: staff number required on dynam element" << endl;
 		return;
 	}
 	double meterunit = m_currentMeterUnit[staffnum - 1];
@@ -4046,13 +4298,13 @@ void Tool_mei2hum::parseDynam(xml_node dynam, HumNum starttime) {
 	if (!startid.empty()) {
 		// Dynamic is (or at least should) be attached directly
 		// do a note, so it is handled elsewhere.
-		cerr << "Warning DYNAMIC " << text << " is not yet processed." << endl;
+		m_warning_text << "Warning DYNAMIC " << text << " is not yet processed." << endl;
 		return;
 	}
 
 	string ts = dynam.attribute("tstamp").value();
 	if (ts.empty()) {
-		cerr << "Error: no timestamp on dynam element" << endl;
+		m_warning_text << "Error: no timestamp on dynam element" << endl;
 		return;
 	}
 	double tsd = (stof(ts)-1) * 4.0 / meterunit;
@@ -4085,7 +4337,7 @@ void Tool_mei2hum::parseDynam(xml_node dynam, HumNum starttime) {
 	}
 	if (!foundslice) {
 		if (nextgs == NULL) {
-			cerr << "Warning: dynamics not attched to system events "
+			m_warning_text << "Warning: dynamics not attched to system events "
 					<< "are not yet supported in measure " << m_currentMeasure << endl;
 		} else {
 			GridPart* part = nextgs->at(staffnum-1);
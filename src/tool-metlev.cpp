@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sat Aug  8 12:24:49 PDT 2015
-// Last Modified: Tue Nov 29 01:03:06 PST 2016
+// Last Modified: Sun Oct 18 18:20:41 PDT 2026 Buffer Humdrum output
 // Filename:      tool-metlev.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/tool-metlev.cpp
 // Syntax:        C++11; humlib
@@ -41,6 +41,10 @@ Tool_metlev::Tool_metlev(void) {
 	define("G|no-grace-notes=b",  "do not mark grace note lines");
 	define("k|kern-spine=i:1",    "analyze only given kern spine");
 	define("e|exinterp=s:blev",   "exclusive interpretation type for output");
+
+	// The Humdrum output is read back in when adding the analysis
+	// to the input data:
+	m_buffer_humdrum = true;
 }
 
 
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Sat Aug  6 10:53:40 CEST 2016
-// Last Modified: Sun Sep 18 14:16:18 PDT 2016
+// Last Modified: Sun Oct 18 23:31:52 PDT 2026 Integer tick timeline
 // Filename:      musicxml2hum.cpp
 // URL:           https://github.com/craigsapp/hum2ly/blob/master/src/musicxml2hum.cpp
 // Syntax:        C++11; humlib
@@ -127,6 +127,9 @@ bool Tool_musicxml2hum::convert(ostream& out, xml_document& doc) {
 	// re-index voices to disallow empty intermediate voices.
 	reindexVoices(partdata);
 
+	// place all parts on a common integer timeline for alignment:
+	setTimelineTpq(partdata);
+
 	HumGrid outdata;
 	status &= stitchParts(outdata, partids, partinfo, partcontent, partdata);
 
@@ -853,6 +856,27 @@ void Tool_musicxml2hum::insertPartNames(HumGrid& outdata, vector<MxmlPart>& part
 
 
 
+//////////////////////////////
+//
+// Tool_musicxml2hum::setTimelineTpq -- Convert the event times of all
+//     parts into integer ticks using a common number of ticks per quarter
+//     note, so that events in different parts (which may have different
+//     <divisions>) can be aligned with integer comparisons.
+//
+
+void Tool_musicxml2hum::setTimelineTpq(vector<MxmlPart>& partdata) {
+	vector<int> tpqs;
+	for (int i=0; i<(int)partdata.size(); i++) {
+		tpqs.push_back(partdata[i].getMinimumTimelineTpq());
+	}
+	int tpq = tpqs.empty() ? 1 : Convert::getLcm(tpqs);
+	for (int i=0; i<(int)partdata.size(); i++) {
+		partdata[i].setTimelineTpq(tpq);
+	}
+}
+
+
+
 //////////////////////////////
 //
 // Tool_musicxml2hum::stitchParts -- Merge individual parts into a
@@ -1000,15 +1024,19 @@ bool Tool_musicxml2hum::insertMeasure(HumGrid& outdata, int mnum,
 		}
 	}
 
+	// Event times are compared as integer ticks on the common timeline
+	// of the parts, and the quarter-note times are passed to the grid.
+	int tpq = partdata[0].getTimelineTpq();
+	vector<long> curtick(partdata.size());
 	vector<HumNum> curtime(partdata.size());
-	vector<HumNum> measuredurs(partdata.size());
 	vector<int> curindex(partdata.size(), 0); // assuming data in a measure...
+	long nexttick = -1;
 	HumNum nexttime = -1;
 
 	vector<vector<MxmlEvent*>> endingDirections(partdata.size());
 
 	HumNum tsdur;
-	for (i=0; i<(int)curtime.size(); i++) {
+	for (i=0; i<(int)curtick.size(); i++) {
 		tsdur = measuredata[i]->getTimeSigDur();
 		if ((tsdur == 0) && (i > 0)) {
 			tsdur = measuredata[i-1]->getTimeSigDur();
@@ -1055,16 +1083,16 @@ bool Tool_musicxml2hum::insertMeasure(HumGrid& outdata, int mnum,
 			cerr << "======================================" << endl;
 		}
 		if (!(*sevents[i]).empty()) {
+			curtick[i] = (*sevents[i])[curindex[i]].tickstart;
 			curtime[i] = (*sevents[i])[curindex[i]].starttime;
 		} else {
+			curtick[i] = MxmlEvent::timeToTicks(tsdur, tpq);
 			curtime[i] = tsdur;
 		}
-		if (nexttime < 0) {
-			nexttime = curtime[i];
-		} else if (curtime[i] < nexttime) {
+		if ((nexttick < 0) || (curtick[i] < nexttick)) {
+			nexttick = curtick[i];
 			nexttime = curtime[i];
 		}
-		measuredurs[i] = measuredata[i]->getDuration();
 	}
 
 	bool allend = false;
@@ -1073,18 +1101,21 @@ bool Tool_musicxml2hum::insertMeasure(HumGrid& outdata, int mnum,
 	bool status = true;
 
 	HumNum processtime = nexttime;
+	long processtick = nexttick;
 	while (!allend) {
 		nowevents.resize(0);
 		nowparts.resize(0);
 		allend = true;
 		processtime = nexttime;
+		processtick = nexttick;
 		nexttime = -1;
+		nexttick = -1;
 		for (i = (int)partdata.size()-1; i >= 0; i--) {
 			if (curindex[i] >= (int)(*sevents[i]).size()) {
 				continue;
 			}
 
-			if ((*sevents[i])[curindex[i]].starttime == processtime) {
+			if ((*sevents[i])[curindex[i]].tickstart == processtick) {
 				SimultaneousEvents* thing = &(*sevents[i])[curindex[i]];
 				nowevents.push_back(thing);
 				nowparts.push_back(i);
@@ -1093,8 +1124,9 @@ bool Tool_musicxml2hum::insertMeasure(HumGrid& outdata, int mnum,
 
 			if (curindex[i] < (int)(*sevents[i]).size()) {
 				allend = false;
-				if ((nexttime < 0) ||
-						((*sevents[i])[curindex[i]].starttime < nexttime)) {
+				if ((nexttick < 0) ||
+						((*sevents[i])[curindex[i]].tickstart < nexttick)) {
+					nexttick = (*sevents[i])[curindex[i]].tickstart;
 					nexttime = (*sevents[i])[curindex[i]].starttime;
 				}
 			}
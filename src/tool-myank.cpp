@@ -6,6 +6,9 @@
 // Last Modified: Mon Apr  1 00:28:01 PDT 2013 Enabled multiple segment input
 // Last Modified: Tue Feb 23 04:40:04 PST 2016 Added --section option
 // Last Modifed:  Sun Dec 18 23:25:32 PST 2016 Ported to humlib
+// Last Modified: Sun Oct 18 15:02:17 PDT 2026 Added indexed extraction
+// Last Modified: Sun Oct 18 16:20:05 PDT 2026 Reconcile ending with first printed line
+// Last Modified: Mon Oct 19 04:41:52 PDT 2026 Added runString()
 // Filename:      ...sig/examples/all/myank.cpp
 // Filename:      tool-myank.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/tool-myank.cpp
@@ -18,6 +21,8 @@
 #include "tool-myank.h"
 #include "HumRegex.h"
 
+#include <algorithm>
+
 using namespace std;
 
 namespace hum {
@@ -70,13 +75,44 @@ bool Tool_myank::run(HumdrumFileSet& infiles) {
 
 bool Tool_myank::run(const string& indata, ostream& out) {
 	HumdrumFile infile(indata);
-	bool status = run(infile);
-	if (hasAnyText()) {
-		getAllText(out);
-	} else {
-		out << infile;
+	return run(infile, out);
+}
+
+//
+// Extract measures from the text of a score.  The score is indexed
+// rather than parsed if a single range of measures is requested.
+//
+
+bool Tool_myank::runString(const string& data, ostream& out) {
+	if (isIndexable()) {
+		MyankIndex index;
+		index.build(data);
+		return run(index, out);
 	}
-	return status;
+	HumdrumFile infile;
+	infile.readString(data);
+	return run(infile, out);
+}
+
+//
+// Extract measures from an indexed score.  If a single range of measures
+// is requested, only the lines of the score needed for the range are
+// parsed; otherwise the entire score is parsed.
+//
+
+bool Tool_myank::run(const MyankIndex& index, ostream& out) {
+	int startmeasure;
+	int endmeasure;
+	string data;
+	if (getSimpleMeasureRange(startmeasure, endmeasure)
+			&& index.extract(data, startmeasure, endmeasure)) {
+		HumdrumFile infile;
+		infile.readString(data);
+		return run(infile, out);
+	}
+	HumdrumFile infile;
+	infile.readString(index.getData());
+	return run(infile, out);
 }
 
 
@@ -261,6 +297,7 @@ void Tool_myank::processFile(HumdrumFile& infile) {
 	}
 
 	// expand to multiple measures later.
+	MeasureOutList.clear();
 	expandMeasureOutList(MeasureOutList, MeasureInList, infile,
 			measurestring);
 
@@ -287,6 +324,60 @@ void Tool_myank::processFile(HumdrumFile& infile) {
 
 
 
+//////////////////////////////
+//
+// Tool_myank::isIndexable -- Returns true if the options can be processed
+//     with a MyankIndex (see runString()), so that the input does not
+//     need to be parsed before running the tool.
+//
+
+bool Tool_myank::isIndexable(void) {
+	int startmeasure;
+	int endmeasure;
+	return getSimpleMeasureRange(startmeasure, endmeasure);
+}
+
+
+
+//////////////////////////////
+//
+// Tool_myank::getSimpleMeasureRange -- Returns true if the options request
+//     a single ascending range of numbered measures (such as "-m 120-130")
+//     which can be extracted with a MyankIndex.
+//
+
+bool Tool_myank::getSimpleMeasureRange(int& startmeasure, int& endmeasure) {
+	startmeasure = -1;
+	endmeasure = -1;
+	if (!getBoolean("measures")) {
+		return false;
+	}
+	if (getBoolean("author") || getBoolean("version") || getBoolean("help")
+			|| getBoolean("example") || getBoolean("debug")
+			|| getBoolean("inlist") || getBoolean("outlist")
+			|| getBoolean("max") || getBoolean("min") || getBoolean("mark")
+			|| getBoolean("section-count") || getInteger("section")) {
+		return false;
+	}
+	HumRegex hre;
+	if (!hre.search(getString("measures"), "^\\s*(\\d+)\\s*(-+\\s*(\\d+))?\\s*$")) {
+		return false;
+	}
+	startmeasure = hre.getMatchInt(1);
+	if (hre.getMatch(3).empty()) {
+		endmeasure = startmeasure;
+	} else {
+		endmeasure = hre.getMatchInt(3);
+	}
+	// Measure 0 (pickup) requires analysis of the start of the score.
+	if ((startmeasure <= 0) || (endmeasure < startmeasure)) {
+		return false;
+	}
+	return true;
+}
+
+
+
 ////////////////////////
 //
 // Tool_myank::getMetStates --  Store the current *met for every token
@@ -1379,10 +1470,6 @@ void Tool_myank::printEnding(HumdrumFile& infile, int lastline, int adjlin) {
 		}
 	}
 
-	if (ending >= 0) {
-		reconcileSpineBoundary(infile, adjlin, ending);
-	}
-
 	int startline  = ending;
 	if (marker >= 0) {
 		// capture any comment which occur after the last measure
@@ -1390,6 +1477,23 @@ void Tool_myank::printEnding(HumdrumFile& infile, int lastline, int adjlin) {
 		startline = marker;
 	}
 
+	// Lines from startline to the end are printed verbatim, so reconcile
+	// with the first spined line which is printed rather than with the
+	// final "*-" line (otherwise any manipulators in between will be
+	// applied twice).
+	int reconcileline = ending;
+	if (startline >= 0) {
+		for (i=startline; i<infile.getLineCount(); i++) {
+			if (infile[i].hasSpines()) {
+				reconcileline = i;
+				break;
+			}
+		}
+	}
+	if (reconcileline >= 0) {
+		reconcileSpineBoundary(infile, adjlin, reconcileline);
+	}
+
 	// reconcileSpineBoundary(infile, lastline, startline);
 
 	if (startline >= 0) {
@@ -2286,6 +2390,367 @@ void Tool_myank::removeDollarsFromString(string& buffer, int maxx) {
 
 
 
+//////////////////////////////
+//
+// MyankIndex::clear -- Remove the contents of the index.
+//
+
+void MyankIndex::clear(void) {
+	m_data = NULL;
+	m_valid = false;
+	m_kern.clear();
+	m_headerend = 0;
+	m_tailstart = 0;
+	m_barnum.clear();
+	m_baroffset.clear();
+	m_stateoffset.clear();
+}
+
+
+
+//////////////////////////////
+//
+// MyankIndex::build -- Index the numbered barlines and the lines containing
+//     clef, key signature, key, time signature, mensuration and tempo
+//     interpretations in the given Humdrum data.  Only the first character
+//     of most lines is examined.  Returns false if the data cannot be used
+//     for indexed extraction: spine manipulators (other than the final
+//     terminators), multiple segments, or barline numbers which are not
+//     strictly increasing.  In that case the data has to be processed by
+//     parsing the entire score.
+//
+
+bool MyankIndex::build(const string& data) {
+	clear();
+	m_data = &data;
+
+	bool exinterp = false;
+	bool terminated = false;
+	size_t tailstart = string::npos;
+	size_t size = data.size();
+	size_t pos = 0;
+	vector<string> tokens;
+
+	while (pos < size) {
+		size_t end = getLineEnd(pos);
+		size_t next = (end < size) ? end + 1 : size;
+		if ((pos == end) || (data[pos] == '!')) {
+			pos = next;
+			continue;
+		}
+		if (terminated) {
+			// Multiple segments or data after the spine terminators.
+			return false;
+		}
+
+		if (data[pos] == '*') {
+			string line = data.substr(pos, end - pos);
+			if (!line.empty() && (line.back() == '\r')) {
+				line.pop_back();
+			}
+			tokens.clear();
+			size_t tstart = 0;
+			while (true) {
+				size_t tend = line.find('\t', tstart);
+				tokens.push_back(line.substr(tstart, tend - tstart));
+				if (tend == string::npos) {
+					break;
+				}
+				tstart = tend + 1;
+			}
+			if (line.compare(0, 2, "**") == 0) {
+				if (exinterp) {
+					return false;
+				}
+				exinterp = true;
+				m_kern.resize(tokens.size());
+				for (int i=0; i<(int)tokens.size(); i++) {
+					m_kern[i] = (tokens[i] == "**kern");
+				}
+				pos = next;
+				continue;
+			}
+			if ((!exinterp) || (tokens.size() != m_kern.size())) {
+				return false;
+			}
+			int terminators = 0;
+			bool state = false;
+			for (int i=0; i<(int)tokens.size(); i++) {
+				const string& token = tokens[i];
+				if (token == "*-") {
+					terminators++;
+				} else if ((token == "*^") || (token == "*v") || (token == "*+")
+						|| (token == "*x")) {
+					return false;
+				} else if (m_kern[i] && (getStateType(token) >= 0)) {
+					state = true;
+				}
+			}
+			if (terminators) {
+				if (terminators != (int)tokens.size()) {
+					return false;
+				}
+				terminated = true;
+			} else if (state) {
+				m_stateoffset.push_back(pos);
+			}
+			pos = next;
+			continue;
+		}
+
+		if (!exinterp) {
+			return false;
+		}
+		tailstart = next;
+		if (data[pos] == '=') {
+			// Measures start at barlines in the form "=%d" (see
+			// Tool_myank::getMeasureStartStop()), so other barlines
+			// with numbers cannot be indexed.
+			size_t tend = data.find_first_of("\t\r\n", pos);
+			if ((tend == string::npos) || (tend > end)) {
+				tend = end;
+			}
+			bool hasdigit = false;
+			for (size_t i=pos+1; i<tend; i++) {
+				if (isdigit(data[i])) {
+					hasdigit = true;
+					break;
+				}
+			}
+			if (hasdigit) {
+				if (!isdigit(data[pos+1])) {
+					return false;
+				}
+				int number = atoi(data.c_str() + pos + 1);
+				if ((!m_barnum.empty()) && (number <= m_barnum.back())) {
+					return false;
+				}
+				m_barnum.push_back(number);
+				m_baroffset.push_back(pos);
+			}
+		}
+		pos = next;
+	}
+
+	if ((!terminated) || m_barnum.empty()) {
+		return false;
+	}
+	m_headerend = m_baroffset[0];
+	m_tailstart = tailstart;
+	m_valid = true;
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// MyankIndex::getData -- Return the indexed text.
+//
+
+const string& MyankIndex::getData(void) const {
+	static const string empty;
+	if (m_data == NULL) {
+		return empty;
+	}
+	return *m_data;
+}
+
+
+
+//////////////////////////////
+//
+// MyankIndex::hasMeasure -- Returns true if the given measure number
+//     has been indexed.
+//
+
+bool MyankIndex::hasMeasure(int number) const {
+	if (!m_valid) {
+		return false;
+	}
+	return std::binary_search(m_barnum.begin(), m_barnum.end(), number);
+}
+
+
+
+//////////////////////////////
+//
+// MyankIndex::extract -- Create a reduced Humdrum score which contains the
+//     header of the indexed data, the barline before the start of the
+//     measure range followed by interpretation lines giving the clef, key
+//     and meter state in effect at that point, the lines of the measure
+//     range and the end of the data.  Running myank on the reduced score
+//     with the same measure range produces the same output as running it
+//     on the complete score.  Returns false if the range cannot be
+//     extracted from the index.
+//
+
+bool MyankIndex::extract(string& output, int startmeasure, int endmeasure) const {
+	output.clear();
+	if ((!m_valid) || (startmeasure > endmeasure)) {
+		return false;
+	}
+	auto first = std::lower_bound(m_barnum.begin(), m_barnum.end(), startmeasure);
+	if ((first == m_barnum.end()) || (*first != startmeasure)) {
+		return false;
+	}
+	auto last = std::lower_bound(first, m_barnum.end(), endmeasure);
+	if ((last == m_barnum.end()) || (*last != endmeasure)) {
+		return false;
+	}
+	int b1 = (int)(first - m_barnum.begin());
+	int b2 = (int)(last - m_barnum.begin());
+	const string& data = *m_data;
+
+	output.append(data, 0, m_headerend);
+
+	if (b1 > 0) {
+		appendLine(output, m_baroffset[b1-1]);
+
+		// Search backwards for the last clef, key signature, key, time
+		// signature, mensuration and tempo in each **kern spine.  States
+		// set in the header are already present in the output.
+		int fields = (int)m_kern.size();
+		vector<vector<string>> state(6);
+		for (int i=0; i<(int)state.size(); i++) {
+			state[i].resize(fields);
+		}
+		int unresolved = 0;
+		for (int i=0; i<fields; i++) {
+			if (m_kern[i]) {
+				unresolved += (int)state.size();
+			}
+		}
+		auto it = std::lower_bound(m_stateoffset.begin(), m_stateoffset.end(),
+				m_baroffset[b1]);
+		while ((unresolved > 0) && (it != m_stateoffset.begin())) {
+			--it;
+			if (*it < m_headerend) {
+				break;
+			}
+			string line = data.substr(*it, getLineEnd(*it) - *it);
+			if (!line.empty() && (line.back() == '\r')) {
+				line.pop_back();
+			}
+			size_t tstart = 0;
+			for (int i=0; i<fields; i++) {
+				size_t tend = line.find('\t', tstart);
+				if (m_kern[i]) {
+					string token = line.substr(tstart, tend - tstart);
+					int type = getStateType(token);
+					if ((type >= 0) && state[type][i].empty()) {
+						state[type][i] = token;
+						unresolved--;
+					}
+				}
+				if (tend == string::npos) {
+					break;
+				}
+				tstart = tend + 1;
+			}
+		}
+		for (int i=0; i<(int)state.size(); i++) {
+			bool found = false;
+			for (int j=0; j<fields; j++) {
+				if (!state[i][j].empty()) {
+					found = true;
+					break;
+				}
+			}
+			if (!found) {
+				continue;
+			}
+			for (int j=0; j<fields; j++) {
+				output += state[i][j].empty() ? "*" : state[i][j];
+				output += (j < fields - 1) ? '\t' : '\n';
+			}
+		}
+	}
+
+	if (b2 + 1 < (int)m_baroffset.size()) {
+		// Copy up to the barline ending the range, then the spine
+		// terminators and any comments after the last measure.
+		size_t stop = getLineEnd(m_baroffset[b2+1]);
+		output.append(data, m_baroffset[b1], stop - m_baroffset[b1]);
+		output += '\n';
+		if (m_tailstart < data.size()) {
+			output.append(data, m_tailstart, string::npos);
+		}
+	} else {
+		output.append(data, m_baroffset[b1], string::npos);
+	}
+
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// MyankIndex::getStateType -- Return the type of state interpretation, in
+//     the same order of precedence as Tool_myank::fillGlobalDefaults():
+//     0 = clef, 1 = key signature, 2 = key, 3 = time signature,
+//     4 = mensuration, 5 = tempo.  Returns -1 for other tokens.
+//
+
+int MyankIndex::getStateType(const string& token) const {
+	if ((token.size() < 3) || (token[0] != '*')) {
+		return -1;
+	}
+	if (token.compare(0, 5, "*clef") == 0) {
+		return 0;
+	}
+	HumRegex hre;
+	if (hre.search(token, R"(^\*k\[.*\])")) {
+		return 1;
+	}
+	if (hre.search(token, "^\\*[A-G][#-]?:", "i")) {
+		return 2;
+	}
+	if (hre.search(token, R"(^\*M\d+/\d+)")) {
+		return 3;
+	}
+	if (hre.search(token, R"(^\*met\(.*\))")) {
+		return 4;
+	}
+	if (hre.search(token, R"(^\*MM[\d.]+)")) {
+		return 5;
+	}
+	return -1;
+}
+
+
+
+//////////////////////////////
+//
+// MyankIndex::appendLine -- Append the line starting at the given offset
+//     in the indexed text to the output.
+//
+
+void MyankIndex::appendLine(string& output, size_t offset) const {
+	output.append(*m_data, offset, getLineEnd(offset) - offset);
+	output += '\n';
+}
+
+
+
+//////////////////////////////
+//
+// MyankIndex::getLineEnd -- Return the offset of the newline at the end
+//     of the line starting at the given offset (or the size of the text
+//     if the last line has no newline).
+//
+
+size_t MyankIndex::getLineEnd(size_t offset) const {
+	size_t end = m_data->find('\n', offset);
+	if (end == string::npos) {
+		return m_data->size();
+	}
+	return end;
+}
+
+
+
 //////////////////////////////
 //
 // Tool_myank::example -- example function calls to the program.
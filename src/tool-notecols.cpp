@@ -0,0 +1,443 @@
+//
+// Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
+// Creation Date: Sun Oct 18 21:40:12 PDT 2026
+// Last Modified: Mon Oct 19 06:58:40 PDT 2026
+// Filename:      tool-notecols.cpp
+// URL:           https://github.com/craigsapp/humlib/blob/master/src/tool-notecols.cpp
+// Syntax:        C++11; humlib
+// vim:           ts=3 noexpandtab
+//
+// Description:   Export note attacks as columns of binary data.  There is
+//                one row for each note attack in **kern spines (each note
+//                of a chord is a separate row).  Output format (all numbers
+//                are little-endian):
+//
+//                Header:
+//                   8 bytes:  "HUMNOTES"
+//                   uint16:   format version (1)
+//                   uint16:   column count
+//                   for each column:
+//                      char:  data type ('d' = float64, 'f' = float32,
+//                             'i' = int32, 'h' = int16)
+//                      uint8: length of column name
+//                      name of column
+//                Followed by a block for each input file:
+//                   uint32:   length of filename
+//                   filename
+//                   uint64:   row count
+//                   for each column: the values for all rows
+//
+
+#include "tool-notecols.h"
+#include "Convert.h"
+#include "HumParallel.h"
+
+#include <cmath>
+#include <cstring>
+#include <sstream>
+
+using namespace std;
+
+namespace hum {
+
+// START_MERGE
+
+
+/////////////////////////////////
+//
+// Tool_notecols::Tool_notecols -- Set the recognized options for the tool.
+//
+
+Tool_notecols::Tool_notecols(void) {
+	define("t|text=b", "print columns as tab-separated text");
+	define("j|threads=i:0", "number of files to analyze at the same time (0 = all cores)");
+	define("b|batch=i:64", "number of input files to read before analyzing them");
+}
+
+
+
+/////////////////////////////////
+//
+// Tool_notecols::run -- Do the main work of the tool.  The output for
+//     all files processed by the same tool object is stored in a single
+//     table with one header.
+//
+
+bool Tool_notecols::run(HumdrumFileSet& infiles) {
+	if (!initialize()) {
+		return false;
+	}
+	printHeader(m_free_text);
+	return processFiles(infiles, m_free_text);
+}
+
+
+bool Tool_notecols::run(const string& indata, ostream& out) {
+	HumdrumFile infile(indata);
+	bool status = run(infile);
+	if (hasAnyText()) {
+		getAllText(out);
+	} else {
+		out << infile;
+	}
+	return status;
+}
+
+
+bool Tool_notecols::run(HumdrumFile& infile, ostream& out) {
+	bool status = run(infile);
+	if (hasAnyText()) {
+		getAllText(out);
+	} else {
+		out << infile;
+	}
+	return status;
+}
+
+
+bool Tool_notecols::run(HumdrumFile& infile) {
+	if (!initialize()) {
+		return false;
+	}
+	printHeader(m_free_text);
+	printBlock(infile, m_free_text);
+	return true;
+}
+
+
+//
+// Streaming interface: the text of the input files is read in batches
+// (-b option), and the files of each batch are parsed and analyzed in
+// parallel and printed in their input order before the next batch is read.
+//
+
+bool Tool_notecols::run(HumdrumFileStream& instream, ostream& out) {
+	if (!initialize()) {
+		return false;
+	}
+	printHeader(out);
+	bool status = true;
+	bool doneQ = false;
+	stringstream buffer;
+	HumdrumFile fileinfo;
+	while (!doneQ) {
+		vector<string> contents;
+		vector<string> filenames;
+		while ((int)contents.size() < m_batch) {
+			if (!instream.getFileContents(buffer, fileinfo)) {
+				doneQ = true;
+				break;
+			}
+			contents.push_back(buffer.str());
+			filenames.push_back(fileinfo.getFilename());
+		}
+		status &= processContents(contents, filenames, out);
+	}
+	return status;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_notecols::initialize -- Process the command-line options.
+//
+
+bool Tool_notecols::initialize(void) {
+	m_textQ   = getBoolean("text");
+	m_threads = HumParallel::getThreadCount(getInteger("threads"));
+	m_batch   = getInteger("batch");
+	if (m_batch < 1) {
+		m_batch = 1;
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_notecols::processFiles -- Analyze the files in parallel, and
+//     then print them in order.
+//
+
+bool Tool_notecols::processFiles(HumdrumFileSet& infiles, ostream& out) {
+	int count = infiles.getCount();
+	vector<string> blocks(count);
+	HumParallel::run(count, m_threads, [&](int i) {
+		int analysisthreads = infiles[i].getAnalysisThreadCount();
+		infiles[i].setAnalysisThreadCount(1);
+		stringstream block;
+		printBlock(infiles[i], block);
+		infiles[i].setAnalysisThreadCount(analysisthreads);
+		blocks[i] = block.str();
+	});
+	for (int i=0; i<count; i++) {
+		out << blocks[i];
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_notecols::processContents -- Parse and analyze the text of the
+//     files in parallel, and then print them in order.  Parse errors are
+//     stored as warnings in the input order.
+//
+
+bool Tool_notecols::processContents(vector<string>& contents,
+		vector<string>& filenames, ostream& out) {
+	int count = (int)contents.size();
+	vector<string> blocks(count);
+	vector<string> errors(count);
+	HumParallel::run(count, m_threads, [&](int i) {
+		HumdrumFile infile;
+		// The files are already parsed in parallel, so do not also
+		// analyze the tracks of each file in parallel.
+		infile.setAnalysisThreadCount(1);
+		infile.setQuietParsing();
+		stringstream input(contents[i]);
+		contents[i].clear();
+		infile.read(input);
+		if (!filenames[i].empty()) {
+			infile.setFilename(filenames[i]);
+		}
+		errors[i] = infile.getParseError();
+		stringstream block;
+		printBlock(infile, block);
+		blocks[i] = block.str();
+	});
+	for (int i=0; i<count; i++) {
+		if (!errors[i].empty()) {
+			m_warning_text << errors[i] << endl;
+		}
+		out << blocks[i];
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_notecols::printHeader -- Print the column descriptions (only
+//     once for each tool object).
+//
+
+void Tool_notecols::printHeader(ostream& out) {
+	if (m_headerQ) {
+		return;
+	}
+	m_headerQ = true;
+
+	if (m_textQ) {
+		out << "file\tonset\tduration\tmidi\tb40\ttrack\tlayer\tmeasure\tmetlev\n";
+		return;
+	}
+
+	vector<pair<char, string>> columns = {
+		{ 'd', "onset"    },
+		{ 'd', "duration" },
+		{ 'h', "midi"     },
+		{ 'h', "b40"      },
+		{ 'h', "track"    },
+		{ 'h', "layer"    },
+		{ 'i', "measure"  },
+		{ 'f', "metlev"   }
+	};
+	string buffer = "HUMNOTES";
+	appendLittleEndian(buffer, 1, 2);
+	appendLittleEndian(buffer, columns.size(), 2);
+	for (int i=0; i<(int)columns.size(); i++) {
+		buffer += columns[i].first;
+		buffer += (char)columns[i].second.size();
+		buffer += columns[i].second;
+	}
+	out.write(buffer.data(), buffer.size());
+}
+
+
+
+//////////////////////////////
+//
+// Tool_notecols::printBlock -- Print the notes of a file.  This function
+//     only uses the file and the tool options, so it can be called for
+//     different files at the same time.
+//
+
+void Tool_notecols::printBlock(HumdrumFile& infile, ostream& out) {
+	NoteColumns columns;
+	fillColumns(infile, columns);
+	if (m_textQ) {
+		printTextBlock(infile.getFilename(), columns, out);
+	} else {
+		printBinaryBlock(infile.getFilename(), columns, out);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// Tool_notecols::fillColumns -- Extract the note attacks in a file.
+//
+
+void Tool_notecols::fillColumns(HumdrumFile& infile, NoteColumns& columns) {
+	columns.clear();
+	if (!infile.isRhythmAnalyzed()) {
+		infile.analyzeRhythmStructure();
+	}
+	vector<double> metlevs;
+	infile.getMetricLevels(metlevs);
+
+	vector<string> pitches;
+	int measure = 0;
+	for (int i=0; i<infile.getLineCount(); i++) {
+		if (infile[i].isBarline()) {
+			int number = infile.getMeasureNumber(i);
+			if (number >= 0) {
+				measure = number;
+			}
+			continue;
+		}
+		if (!infile[i].isData()) {
+			continue;
+		}
+		for (int j=0; j<infile[i].getFieldCount(); j++) {
+			HTp token = infile.token(i, j);
+			if (!token->isKern()) {
+				continue;
+			}
+			if (token->isNull() || token->isRest() || token->isSecondaryTiedNote()) {
+				continue;
+			}
+			double onset = token->getDurationFromStart().getFloat();
+			double duration = token->getTiedDuration().getFloat();
+			int scount = token->getSubtokenCount();
+			for (int k=0; k<scount; k++) {
+				string subtok = (scount == 1) ? (string)*token : token->getSubtoken(k);
+				if (subtok.find('r') != string::npos) {
+					continue;
+				}
+				if ((scount > 1) && ((subtok.find('_') != string::npos) ||
+						(subtok.find(']') != string::npos))) {
+					// secondary tied note in a chord
+					continue;
+				}
+				pitches.push_back(subtok);
+				columns.onset.push_back(onset);
+				columns.duration.push_back(duration);
+				columns.track.push_back((int16_t)token->getTrack());
+				columns.layer.push_back((int16_t)(token->getSubtrack() > 0 ? token->getSubtrack() : 1));
+				columns.measure.push_back(measure);
+				columns.metlev.push_back((float)metlevs[i]);
+			}
+		}
+	}
+
+	vector<int> b40;
+	vector<int> midi;
+	Convert::kernToPitchNumbers(pitches, &b40, NULL, NULL, &midi);
+	columns.b40.assign(b40.begin(), b40.end());
+	columns.midi.assign(midi.begin(), midi.end());
+}
+
+
+
+//////////////////////////////
+//
+// Tool_notecols::printBinaryBlock -- Print the notes of a file in the
+//     binary format described at the top of this file.
+//
+
+void Tool_notecols::printBinaryBlock(const string& filename,
+		NoteColumns& columns, ostream& out) {
+	int rows = columns.getRowCount();
+	string buffer;
+	buffer.reserve(filename.size() + 12 + rows * 32);
+	appendLittleEndian(buffer, filename.size(), 4);
+	buffer += filename;
+	appendLittleEndian(buffer, rows, 8);
+
+	uint64_t bits64;
+	uint32_t bits32;
+	for (int i=0; i<rows; i++) {
+		memcpy(&bits64, &columns.onset[i], sizeof(bits64));
+		appendLittleEndian(buffer, bits64, 8);
+	}
+	for (int i=0; i<rows; i++) {
+		memcpy(&bits64, &columns.duration[i], sizeof(bits64));
+		appendLittleEndian(buffer, bits64, 8);
+	}
+	for (int i=0; i<rows; i++) {
+		appendLittleEndian(buffer, (uint16_t)columns.midi[i], 2);
+	}
+	for (int i=0; i<rows; i++) {
+		appendLittleEndian(buffer, (uint16_t)columns.b40[i], 2);
+	}
+	for (int i=0; i<rows; i++) {
+		appendLittleEndian(buffer, (uint16_t)columns.track[i], 2);
+	}
+	for (int i=0; i<rows; i++) {
+		appendLittleEndian(buffer, (uint16_t)columns.layer[i], 2);
+	}
+	for (int i=0; i<rows; i++) {
+		appendLittleEndian(buffer, (uint32_t)columns.measure[i], 4);
+	}
+	for (int i=0; i<rows; i++) {
+		memcpy(&bits32, &columns.metlev[i], sizeof(bits32));
+		appendLittleEndian(buffer, bits32, 4);
+	}
+	out.write(buffer.data(), buffer.size());
+}
+
+
+
+//////////////////////////////
+//
+// Tool_notecols::printTextBlock -- Print the notes of a file with one
+//     line for each row.
+//
+
+void Tool_notecols::printTextBlock(const string& filename,
+		NoteColumns& columns, ostream& out) {
+	for (int i=0; i<columns.getRowCount(); i++) {
+		out << filename;
+		out << '\t' << columns.onset[i];
+		out << '\t' << columns.duration[i];
+		out << '\t' << columns.midi[i];
+		out << '\t' << columns.b40[i];
+		out << '\t' << columns.track[i];
+		out << '\t' << columns.layer[i];
+		out << '\t' << columns.measure[i];
+		out << '\t' << columns.metlev[i];
+		out << '\n';
+	}
+}
+
+
+
+//////////////////////////////
+//
+// Tool_notecols::appendLittleEndian -- Add an integer to the buffer with
+//     the lowest byte first.
+//
+
+void Tool_notecols::appendLittleEndian(string& buffer, uint64_t value,
+		int bytecount) {
+	for (int i=0; i<bytecount; i++) {
+		buffer += (char)(value & 0xff);
+		value >>= 8;
+	}
+}
+
+
+
+// END_MERGE
+
+} // end namespace hum
+
+
+
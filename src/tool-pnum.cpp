@@ -1,7 +1,8 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Wed Apr 10 08:59:49 EDT 2019
-// Last Modified: Wed Apr 10 10:21:32 EDT 2019
+// Last Modified: Sun Oct 18 21:10:44 PDT 2026 Batch pitch conversion
+// Last Modified: Mon Oct 19 01:12:40 PDT 2026 Added line-at-a-time processing
 // Filename:      tool-pnum.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/tool-pnum.cpp
 // Syntax:        C++11; humlib
@@ -70,20 +71,74 @@ bool Tool_pnum::run(HumdrumFile& infile, ostream& out) {
 
 
 bool Tool_pnum::run(HumdrumFile& infile) {
-   initialize(infile);
+	initialize();
 	processFile(infile);
 	infile.createLinesFromTokens();
 	return true;
 }
 
 
+//
+// Line-at-a-time interface: each line is converted and printed before
+// the next line is read.
+//
+
+bool Tool_pnum::run(HumdrumLineStream& instream) {
+	initialize();
+	vector<HTp> notes;
+	HLp line;
+	while ((line = instream.getLine())) {
+		if (line->hasSpines()) {
+			notes.clear();
+			for (int j=0; j<line->getFieldCount(); j++) {
+				if (instream.getDataType(j) != "**kern") {
+					continue;
+				}
+				HTp token = line->token(j);
+				if (*token == "**kern") {
+					token->setText(m_exinterp);
+					continue;
+				}
+				if (!token->isData()) {
+					continue;
+				}
+				if (token->isNull()) {
+					continue;
+				}
+				notes.push_back(token);
+			}
+			convertTokensToBase(notes);
+		}
+		line->createLineFromTokens();
+		m_humdrum_text << line << '\n';
+	}
+	if (instream.hasError()) {
+		m_error_text << instream.getError();
+		return false;
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_pnum::isLineStreamable -- The conversion only needs the current
+//    line, so the input can always be processed one line at a time.
+//
+
+bool Tool_pnum::isLineStreamable(void) {
+	return true;
+}
+
+
 
 //////////////////////////////
 //
 // Tool_pnum::initialize --
 //
 
-void Tool_pnum::initialize(HumdrumFile& infile) {
+void Tool_pnum::initialize(void) {
 	m_midiQ = false;
 	if (getString("base") == "midi") {
 		m_base = 12;
@@ -99,6 +154,12 @@ void Tool_pnum::initialize(HumdrumFile& infile) {
 	m_attacksQ  =  getBoolean("attacks-only");
 	m_rest      =  getString("rest");
 	m_restQ     = !getBoolean("no-rests");
+
+	if (m_midiQ) {
+		m_exinterp = "**pmid";
+	} else {
+		m_exinterp = "**b" + to_string(m_base);
+	}
 }
 
 
@@ -110,6 +171,7 @@ void Tool_pnum::initialize(HumdrumFile& infile) {
 
 void Tool_pnum::processFile(HumdrumFile& infile) {
 	vector<HTp> kex;
+	vector<HTp> notes;
 
 	for (int i=0; i<infile.getLineCount(); i++) {
 		if (!infile[i].hasSpines()) {
@@ -130,18 +192,13 @@ void Tool_pnum::processFile(HumdrumFile& infile) {
 			if (token->isNull()) {
 				continue;
 			}
-			convertTokenToBase(token);
+			notes.push_back(token);
 		}
 	}
+	convertTokensToBase(notes);
 
-	string newex;
 	for (int i=0; i<(int)kex.size(); i++) {
-		if (m_midiQ) {
-			newex = "**pmid";
-		} else {
-			newex = "**b" + to_string(m_base);
-		}
-		kex[i]->setText(newex);
+		kex[i]->setText(m_exinterp);
 	}
 }
 
@@ -149,44 +206,69 @@ void Tool_pnum::processFile(HumdrumFile& infile) {
 
 //////////////////////////////
 //
-// Tool_pnum::convertTokenToBase --
+// Tool_pnum::convertTokensToBase -- Convert the pitches of all
+//     subtokens in a list of tokens at once, then replace the text
+//     of each token.
 //
 
-void Tool_pnum::convertTokenToBase(HTp token) {
+void Tool_pnum::convertTokensToBase(vector<HTp>& tokens) {
+	vector<string> subtokens;
+	vector<int> counts(tokens.size(), 0);
+	for (int i=0; i<(int)tokens.size(); i++) {
+		const string& text = *tokens[i];
+		string::size_type start = 0;
+		while (true) {
+			string::size_type loc = text.find(' ', start);
+			subtokens.push_back(text.substr(start, loc - start));
+			counts[i]++;
+			if (loc == string::npos) {
+				break;
+			}
+			start = loc + 1;
+		}
+	}
+
+	vector<int> pitches;
+	switch (m_base) {
+		case 7:
+			Convert::kernToBase7(subtokens, pitches);
+			break;
+		case 40:
+			Convert::kernToBase40(subtokens, pitches);
+			break;
+		default:
+			Convert::kernToBase12(subtokens, pitches);
+	}
+
+	int index = 0;
 	string output;
-	int scount = token->getSubtokenCount();
-	for (int i=0; i<scount; i++) {
-		string subtok = token->getSubtoken(i);
-		output += convertSubtokenToBase(subtok);
-		if (i < scount - 1) {
-			output += " ";
+	for (int i=0; i<(int)tokens.size(); i++) {
+		output.clear();
+		for (int j=0; j<counts[i]; j++) {
+			output += convertSubtokenToBase(subtokens[index], pitches[index]);
+			index++;
+			if (j < counts[i] - 1) {
+				output += " ";
+			}
 		}
+		tokens[i]->setText(output);
 	}
-	token->setText(output);
 }
 
 
 
 //////////////////////////////
 //
-// Tool_pnum::convertSubtokenToBase --
+// Tool_pnum::convertSubtokenToBase -- The pitch is the base-7, base-12
+//     or base-40 value of the subtoken.
 //
 
-string Tool_pnum::convertSubtokenToBase(const string& text) {
-	int pitch = 0;
-	if (text.find("r") == string::npos) {
-		switch (m_base) {
-			case 7:
-				pitch = Convert::kernToBase7(text);
-				break;
-			case 40:
-				pitch = Convert::kernToBase40(text);
-				break;
-			default:
-				pitch = Convert::kernToBase12(text);
+string Tool_pnum::convertSubtokenToBase(const string& text, int pitch) {
+	if (text.find("r") != string::npos) {
+		if (!m_restQ) {
+			return ".";
 		}
-	} else if (!m_restQ) {
-		return ".";
+		pitch = 0;
 	}
 	string recip;
 	if (m_durationQ) {
@@ -1,7 +1,8 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Wed Dec  7 08:01:07 PST 2016
-// Last Modified: Wed Dec  7 12:40:28 PST 2016
+// Last Modified: Sun Oct 18 18:20:41 PDT 2026 Buffer Humdrum output
+// Last Modified: Mon Oct 19 01:12:40 PDT 2026 Added line-at-a-time processing
 // Filename:      tool-recip.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/include/tool-recip.cpp
 // Syntax:        C++11; humlib
@@ -75,7 +76,8 @@ bool Tool_recip::run(HumdrumFile& infile, ostream& out) {
 
 
 bool Tool_recip::run(HumdrumFile& infile) {
-   initialize(infile);
+	initialize();
+	m_kernspines = infile.getKernSpineStartList();
 
 	int lineCount = infile.getLineCount();
 	if (lineCount == 0) {
@@ -103,6 +105,51 @@ bool Tool_recip::run(HumdrumFile& infile) {
 }
 
 
+//
+// Line-at-a-time interface: each line is converted and printed before
+// the next line is read.
+//
+
+bool Tool_recip::run(HumdrumLineStream& instream) {
+	initialize();
+	bool replaceQ = getBoolean("replace");
+	HumRegex hre;
+	HLp line;
+	while ((line = instream.getLine())) {
+		if (line->hasSpines()) {
+			if (replaceQ) {
+				replaceKernWithRecip(*line, instream, hre);
+			} else {
+				insertAnalysisSpines(*line, instream, hre);
+			}
+		}
+		line->createLineFromTokens();
+		m_humdrum_text << line << '\n';
+	}
+	if (instream.hasError()) {
+		m_error_text << instream.getError();
+		return false;
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_recip::isLineStreamable -- The composite analysis needs the
+//    durations of the lines, so only the spine replacement and insertion
+//    modes can process the input one line at a time.
+//
+
+bool Tool_recip::isLineStreamable(void) {
+	if (getBoolean("composite") || getBoolean("append") || getBoolean("prepend")) {
+		return false;
+	}
+	return true;
+}
+
+
 
 //////////////////////////////
 //
@@ -138,6 +185,50 @@ void Tool_recip::insertAnalysisSpines(HumdrumFile& infile, HumdrumFile& cfile) {
 }
 
 
+//
+// Line-at-a-time version: a **recip spine is inserted after the
+// last field of each **kern track on the line.
+//
+
+void Tool_recip::insertAnalysisSpines(HumdrumLine& line,
+		HumdrumLineStream& instream, HumRegex& hre) {
+	int fcount = line.getFieldCount();
+	vector<string> recips(fcount);
+	vector<int> lastfield(instream.getMaxTrack() + 1, -1);
+	for (int j=0; j<fcount; j++) {
+		if (instream.getDataType(j) != "**kern") {
+			continue;
+		}
+		HTp token = line.token(j);
+		recips[j] = getRecipText(token, hre);
+		int track = token->getTrack();
+		if ((track >= 0) && (track < (int)lastfield.size())) {
+			lastfield[track] = j;
+		}
+	}
+	// Insert from right to left so that the indexes of the fields which
+	// are still to be processed do not change:
+	for (int j=fcount-1; j>=0; j--) {
+		if (instream.getDataType(j) != "**kern") {
+			continue;
+		}
+		int track = line.token(j)->getTrack();
+		if ((track < 0) || (track >= (int)lastfield.size()) || (lastfield[track] != j)) {
+			continue;
+		}
+		for (int k=j; k>=0; k--) {
+			if (instream.getDataType(k) != "**kern") {
+				continue;
+			}
+			if (line.token(k)->getTrack() != track) {
+				continue;
+			}
+			line.appendToken(j, recips[k]);
+		}
+	}
+}
+
+
 
 //////////////////////////////
 //
@@ -180,9 +271,10 @@ void Tool_recip::doCompositeAnalysis(HumdrumFile& infile) {
 		return;
 	} else {
 		infile.prependDataSpine(recips, "", m_exinterp);
-		infile.printFieldIndex(0, m_humdrum_text);
+		stringstream analysis;
+		infile.printFieldIndex(0, analysis);
 		infile.clear();
-		infile.readString(m_humdrum_text.str());
+		infile.readString(analysis.str());
 	}
 }
 
@@ -220,7 +312,9 @@ void Tool_recip::replaceKernWithRecip(HumdrumFile& infile) {
 					tok->setText(".");
 				}
 			} else {
-				hre.replaceDestructive(*tok, "", expression, "g");
+				string text = *tok;
+				hre.replaceDestructive(text, "", expression, "g");
+				tok->setText(text);
 			}
 			tok = tok->getNextToken();
 		}
@@ -233,6 +327,49 @@ void Tool_recip::replaceKernWithRecip(HumdrumFile& infile) {
 }
 
 
+//
+// Line-at-a-time version: **kern tokens on the line are replaced
+// by their **recip equivalents.
+//
+
+void Tool_recip::replaceKernWithRecip(HumdrumLine& line,
+		HumdrumLineStream& instream, HumRegex& hre) {
+	for (int j=0; j<line.getFieldCount(); j++) {
+		if (instream.getDataType(j) != "**kern") {
+			continue;
+		}
+		HTp token = line.token(j);
+		token->setText(getRecipText(token, hre));
+	}
+}
+
+
+
+//////////////////////////////
+//
+// Tool_recip::getRecipText -- Return the **recip version of a **kern
+//     token (see replaceKernWithRecip()).
+//
+
+string Tool_recip::getRecipText(HTp token, HumRegex& hre) {
+	if (*token == "**kern") {
+		return m_exinterp;
+	}
+	if (!token->isData()) {
+		return *token;
+	}
+	if (token->isNull()) {
+		return *token;
+	}
+	if (token->find('q') != string::npos) {
+		return m_graceQ ? "q" : ".";
+	}
+	string output = *token;
+	hre.replaceDestructive(output, "", "[^q\\d.%\\]\\[]+", "g");
+	return output;
+}
+
+
 
 
 //////////////////////////////
@@ -240,8 +377,7 @@ void Tool_recip::replaceKernWithRecip(HumdrumFile& infile) {
 // Tool_recip::initialize --
 //
 
-void Tool_recip::initialize(HumdrumFile& infile) {
-	m_kernspines = infile.getKernSpineStartList();
+void Tool_recip::initialize(void) {
 	m_graceQ = !getBoolean("ignore-grace-notes");
 
 	m_exinterp = getString("exinterp");
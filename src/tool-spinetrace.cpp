@@ -2,6 +2,7 @@
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Mon Oct 16 21:44:03 PDT 2000
 // Last Modified: Fri Jun 14 11:45:17 CEST 2019 Updated for humlib.
+// Last Modified: Mon Oct 19 01:12:40 PDT 2026 Added line-at-a-time processing
 // Filename:      src/tool-spinetrace.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/tool-spinetrace.cpp
 // Syntax:        C++11; humlib
@@ -57,20 +58,52 @@ bool Tool_spinetrace::run(HumdrumFile& infile, ostream& out) {
 
 
 bool Tool_spinetrace::run(HumdrumFile& infile) {
-   initialize(infile);
+	initialize();
 	processFile(infile);
 	return true;
 }
 
 
+//
+// Line-at-a-time interface: the analysis only needs the spine info of the
+// current line, so the input is not stored.
+//
+
+bool Tool_spinetrace::run(HumdrumLineStream& instream) {
+	initialize();
+	HLp line;
+	while ((line = instream.getLine())) {
+		processLine(*line);
+	}
+	if (instream.hasError()) {
+		m_error_text << instream.getError();
+		return false;
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_spinetrace::isLineStreamable -- The input can always be processed
+//    one line at a time.
+//
+
+bool Tool_spinetrace::isLineStreamable(void) {
+	return true;
+}
+
+
 
 //////////////////////////////
 //
 // Tool_spinetrace::initialize --
 //
 
-void Tool_spinetrace::initialize(HumdrumFile& infile) {
-	// do nothing for now
+void Tool_spinetrace::initialize(void) {
+	m_appendQ  = getBoolean("append");
+	m_prependQ = getBoolean("prepend");
 }
 
 
@@ -81,51 +114,59 @@ void Tool_spinetrace::initialize(HumdrumFile& infile) {
 //
 
 void Tool_spinetrace::processFile(HumdrumFile& infile) {
-	bool appendQ = getBoolean("append");
-	bool prependQ = getBoolean("prepend");
-
 	int linecount = infile.getLineCount();
 	for (int i=0; i<linecount; i++) {
-		if (!infile[i].hasSpines()) {
-			m_humdrum_text << infile[i] << endl;
-			continue;
-		}
-		if (appendQ) {
-			m_humdrum_text << infile[i] << "\t";
-		}
+		processLine(infile[i]);
+	}
+}
 
-		if (!infile[i].isData()) {
-			if (infile[i].isInterpretation()) {
-				int fieldcount = infile[i].getFieldCount();
-				for (int j=0; j<fieldcount; j++) {
-					HTp token = infile.token(i, j);
-					if (token->compare(0, 2, "**") == 0) {
-						m_humdrum_text << "**spine";
-					} else {
-						m_humdrum_text << token;
-					}
-					if (j < fieldcount - 1) {
-						m_humdrum_text << "\t";
-					}
-				}
-			} else {
-				m_humdrum_text << infile[i];
-			}
-		} else {
-			int fieldcount = infile[i].getFieldCount();
+
+
+//////////////////////////////
+//
+// Tool_spinetrace::processLine --
+//
+
+void Tool_spinetrace::processLine(HumdrumLine& line) {
+	if (!line.hasSpines()) {
+		m_humdrum_text << line << endl;
+		return;
+	}
+	if (m_appendQ) {
+		m_humdrum_text << line << "\t";
+	}
+
+	if (!line.isData()) {
+		if (line.isInterpretation()) {
+			int fieldcount = line.getFieldCount();
 			for (int j=0; j<fieldcount; j++) {
-				m_humdrum_text << infile[i].token(j)->getSpineInfo();
+				HTp token = line.token(j);
+				if (token->compare(0, 2, "**") == 0) {
+					m_humdrum_text << "**spine";
+				} else {
+					m_humdrum_text << token;
+				}
 				if (j < fieldcount - 1) {
-					m_humdrum_text << '\t';
+					m_humdrum_text << "\t";
 				}
 			}
+		} else {
+			m_humdrum_text << line;
 		}
-
-		if (prependQ) {
-			m_humdrum_text << "\t" << infile[i];
+	} else {
+		int fieldcount = line.getFieldCount();
+		for (int j=0; j<fieldcount; j++) {
+			m_humdrum_text << line.token(j)->getSpineInfo();
+			if (j < fieldcount - 1) {
+				m_humdrum_text << '\t';
+			}
 		}
-		m_humdrum_text << "\n";
 	}
+
+	if (m_prependQ) {
+		m_humdrum_text << "\t" << line;
+	}
+	m_humdrum_text << "\n";
 }
 
 
@@ -1,7 +1,7 @@
 //
 // Programmer:    Craig Stuart Sapp <craig@ccrma.stanford.edu>
 // Creation Date: Wed Jun 12 12:08:10 CEST 2019
-// Last Modified: Wed Jun 12 12:08:13 CEST 2019
+// Last Modified: Mon Oct 19 01:12:40 PDT 2026
 // Filename:      tool-tabber.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/tool-tabber.cpp
 // Syntax:        C++11; humlib
@@ -66,6 +66,37 @@ bool Tool_tabber::run(HumdrumFile& infile) {
 }
 
 
+//
+// Line-at-a-time interface for removing tabs (see isLineStreamable()).
+//
+
+bool Tool_tabber::run(HumdrumLineStream& instream) {
+	HLp line;
+	while ((line = instream.getLine())) {
+		line->removeExtraTabs();
+		line->createLineFromTokens();
+		m_humdrum_text << line << '\n';
+	}
+	if (instream.hasError()) {
+		m_error_text << instream.getError();
+		return false;
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// Tool_tabber::isLineStreamable -- Extra tabs can be removed one line
+//    at a time, but adding tabs needs the track widths of the entire file.
+//
+
+bool Tool_tabber::isLineStreamable(void) {
+	return getBoolean("remove");
+}
+
+
 
 //////////////////////////////
 //
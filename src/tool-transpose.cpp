@@ -11,6 +11,7 @@
 // Last Modified: Mon Dec  5 23:28:50 PST 2016 Ported to humlib from humextras
 // Last Modified: Wed May 16 22:47:11 PDT 2018 Added **mxhm transposition
 // Last Modified: Thu Jun 14 15:30:53 PDT 2018 Added rest position transposition
+// Last Modified: Sun Oct 18 22:20:47 PDT 2026 Use HumKeyFinder for --auto analysis
 // Filename:      tool-transpose.cpp
 // URL:           https://github.com/craigsapp/humlib/blob/master/src/tool-transpose.cpp
 // Syntax:        C++11; humlib; humlib
@@ -21,6 +22,7 @@
 
 #include "tool-transpose.h"
 #include "Convert.h"
+#include "HumKeyFinder.h"
 #include "HumRegex.h"
 #include <cstring>
 #include <ctype.h>
@@ -48,6 +50,7 @@ Tool_transpose::Tool_transpose(void) {
 	define("t|transpose=s",   "musical interval transposition value");
 	define("k|settonic=s",    "transpose to the given key/tonic (mode will not change)");
 	define("auto=b",          "auto. trans. inst. parts to concert pitch");
+	define("profile=s:kostka-payne", "key profiles for --auto: kostka-payne, krumhansl-kessler or aarden-essen");
 	define("debug=b",         "print debugging statements");
 	define("s|spines=s:",     "transpose only specified spines");
 	// quiet reversed with -T option (actively need to request transposition code now)
@@ -1048,15 +1051,9 @@ void Tool_transpose::usage(const string& command) {
 
 void Tool_transpose::doAutoTransposeAnalysis(HumdrumFile& infile) {
 	vector<int> ktracks(infile.getMaxTrack()+1, 0);
-
-	vector<HTp> tracks;
-	infile.getTrackStartList(tracks);
-	int i;
-	for (i=0; i<(int)tracks.size(); i++) {
-		if (tracks[i]->isKern()) {
-			ktracks[i] = tracks[i]->getTrack();
-		} else {
-			ktracks[i] = 0;
+	for (int t=1; t<=infile.getMaxTrack(); t++) {
+		if (infile.getTrackStart(t)->isKern()) {
+			ktracks[t] = t;
 		}
 	}
 
@@ -1066,13 +1063,7 @@ void Tool_transpose::doAutoTransposeAnalysis(HumdrumFile& infile) {
 	}
 
 	vector<vector<vector<double> > > trackhist;
-	trackhist.resize(ktracks.size());
-
-	for (i=1; i<(int)trackhist.size(); i++) {
-		if (ktracks[i]) {
-			storeHistogramForTrack(trackhist[i], infile, i, segments);
-		}
-	}
+	HumKeyFinder::getTrackHistograms(infile, segments, trackhist);
 
 	if (debugQ) {
 		m_free_text << "Segment pitch histograms: " << endl;
@@ -1125,8 +1116,8 @@ void Tool_transpose::doTranspositionAnalysis(vector<vector<vector<double> > >& a
 	int value;
 
 	for (i=0; i<1; i++) {
-		for (j=2; j<3; j++) {
-			for (k=0; k<(int)analysis[i].size(); k++) {
+		for (j=2; j<3 && j<(int)analysis.size(); j++) {
+			for (k=0; k<(int)analysis[i].size() && k<(int)analysis[j].size(); k++) {
 				if (analysis[i][k][24] >= 0 && analysis[j][k][24] >= 0) {
 					value1 = (int)analysis[i][k][25];
 	 				if (value1 >= 12) {
@@ -1162,24 +1153,22 @@ void Tool_transpose::printRawTrackAnalysis(vector<vector<vector<double> > >& ana
 
 	int i, j;
 	int value;
-	int value2;
 
+	if (analysis.empty()) {
+		return;
+	}
 	for (i=0; i<(int)analysis[0].size(); i++) {
 		m_free_text << "Frame\t" << i << ":";
 		for (j=0; j<(int)analysis.size(); j++) {
 			m_free_text << "\t";
+			if (i >= (int)analysis[j].size()) {
+				continue;
+			}
 	 		value = (int)analysis[j][i][24];
 	 		if (value >= 12) {
 				value = value - 12;
 			}
-	 		value2 = (int)analysis[j][i][25];
-	 		if (value2 >= 12) {
-				value2 = value2 - 12;
-			}
 			m_free_text << value;
-	 		// if (value != value2) {
-	 		//    m_free_text << "," << value2;
-			// }
 		}
 		m_free_text << "\n";
 	}
@@ -1189,237 +1178,46 @@ void Tool_transpose::printRawTrackAnalysis(vector<vector<vector<double> > >& ana
 
 //////////////////////////////
 //
-// doAutoKeyAnalysis --
+// doAutoKeyAnalysis -- Key analysis of windows of level segments,
+//     starting every hop segments, in each **kern track.
 //
 
 void Tool_transpose::doAutoKeyAnalysis(vector<vector<vector<double> > >& analysis, int level,
 		int hop, int count, int segments, vector<int>& ktracks,
 		vector<vector<vector<double> > >& trackhist) {
 
-	vector<double> majorweights;
-	vector<double> minorweights;
-	fillWeightsWithKostkaPayne(majorweights, minorweights);
-
-	int size = 0;
-	int i;
-	for (i=1; i<(int)ktracks.size(); i++) {
-		if (ktracks[i]) {
-			size++;
-		}
-	}
-
-	analysis.resize(size);
-	for (i=0; i<(int)analysis.size(); i++) {
-		analysis[i].reserve(count);
-	}
+	HumKeyFinder finder;
+	finder.setProfile(getString("profile"));
 
-	int aindex = 0;
-	for (i=1; i<(int)ktracks.size(); i++) {
+	analysis.clear();
+	for (int i=1; i<(int)ktracks.size(); i++) {
 		if (!ktracks[i]) {
 			continue;
 		}
-		doTrackKeyAnalysis(analysis[aindex++], level, hop, count,
-				trackhist[i], majorweights, minorweights);
+		analysis.resize(analysis.size() + 1);
+		finder.setHistograms(trackhist[i]);
+		finder.analyzeWindows(level, hop, count, analysis.back());
 	}
 }
 
 
 
-//////////////////////////////
-//
-// Tool_transpose::doTrackKeyAnalysis -- Do individual key analyses of sections of the
-//   given track.
-//
-
-void Tool_transpose::doTrackKeyAnalysis(vector<vector<double> >& analysis, int level, int hop,
-		int count, vector<vector<double> >& trackhist,
-		vector<double>& majorweights, vector<double>& minorweights) {
-
-	int i;
-	for (i=0; i<count; i++) {
-		if (i * hop + level > (int)trackhist.size()) {
-			break;
-		}
-		analysis.resize(i+1);
-		doSingleAnalysis(analysis[analysis.size()-1], i*hop+level, level,
-				trackhist, majorweights, minorweights);
-	}
-}
-
-
-
-//////////////////////////////
-//
-// Tool_transpose::doSingleAnalysis --
-//
-
-void Tool_transpose::doSingleAnalysis(vector<double>& analysis, int startindex, int length,
-		vector<vector<double> >& trackhist, vector<double>& majorweights,
-		vector<double>& minorweights) {
-	vector<double> histsum(12, 0);
-
-	for (int i=0; (i<length) && (startindex+i+length<(int)trackhist.size()); i++) {
-		for (int k=0; k<12; k++) {
-			histsum[k] += trackhist[i+startindex][k];
-		}
-	}
-
-	identifyKey(analysis, histsum, majorweights, minorweights);
-}
-
-
-
-///////////////////////////////
-//
-// Tool_transpose::fillWeightsWithKostkaPayne --
-//
-
-void Tool_transpose::fillWeightsWithKostkaPayne(vector<double>& maj, vector<double>& min) {
-	maj.resize(12);
-	min.resize(12);
-
-	// found in David Temperley: Music and Probability 2006
-	maj[0]  = 0.748;	// C major weights
-	maj[1]  = 0.060;	// C#
-	maj[2]  = 0.488;	// D
-	maj[3]  = 0.082;	// D#
-	maj[4]  = 0.670;	// E
-	maj[5]  = 0.460;	// F
-	maj[6]  = 0.096;	// F#
-	maj[7]  = 0.715;	// G
-	maj[8]  = 0.104;	// G#
-	maj[9]  = 0.366;	// A
-	maj[10] = 0.057;	// A#
-	maj[11] = 0.400;	// B
-	min[0]  = 0.712;	// c minor weights
-	min[1]  = 0.084;	// c#
-	min[2]  = 0.474;	// d
-	min[3]  = 0.618;	// d#
-	min[4]  = 0.049;	// e
-	min[5]  = 0.460;	// f
-	min[6]  = 0.105;	// f#
-	min[7]  = 0.747;	// g
-	min[8]  = 0.404;	// g#
-	min[9]  = 0.067;	// a
-	min[10] = 0.133;	// a#
-	min[11] = 0.330;	// b
-}
-
-
-
-////////////////////////////////////////
-//
-// identifyKey -- correls contains the 12 major key correlation
-//      values, then the 12 minor key correlation values, then two
-//      more values: index=24 is the best key, and index=25 is the
-//      second best key.  If [24] or [25] is -1, then that means that
-//      all entries in the original histogram were zero (all rests).
-//
-
-void Tool_transpose::identifyKey(vector<double>& correls,
-		vector<double>& histogram, vector<double>& majorweights,
-		vector<double>& minorweights) {
-
-	correls.clear();
-	correls.reserve(26);
-
-	double testsum = 0.0;
-	for (int i=0; i<12; i++) {
-		testsum += histogram[i];
-	}
-	if (testsum == 0.0) {
-		correls.resize(26);
-		fill(correls.begin(), correls.end(), -1);
-		correls[24] = -1;
-		correls[25] = -1;
-		return;
-	}
-
-	vector<double> majorcorrels;
-	vector<double> minorcorrels;
-	for (int i=0; i<12; i++) {
-		majorcorrels[i] = Convert::pearsonCorrelation(majorweights, histogram);
-		minorcorrels[i] = Convert::pearsonCorrelation(minorweights, histogram);
-	}
-
-	// find max value
-	int besti;
-	int majorbesti = 0;
-	int minorbesti = 0;
-	for (int i=1; i<12; i++) {
-		if (majorcorrels[i] > majorcorrels[majorbesti]) {
-			majorbesti = i;
-		}
-		if (minorcorrels[i] > minorcorrels[minorbesti]) {
-			minorbesti = i;
-		}
-	}
-	besti = majorbesti;
-	if (majorcorrels[majorbesti] < minorcorrels[minorbesti]) {
-		besti = minorbesti + 12;
-	}
-
-	// find second best major key
-	int majorsecondbesti = 0;
-	if (majorbesti == 0) {
-		majorsecondbesti = 1;
-	}
-	for (int i=1; i<12; i++) {
-		if (i == majorbesti) {
-			continue;
-		}
-		if (majorcorrels[i] > majorcorrels[majorsecondbesti]) {
-			majorsecondbesti = i;
-		}
-	}
-
-	// find second best minor key
-	int minorsecondbesti = 0;
-	if (minorbesti == 0) {
-		minorsecondbesti = 1;
-	}
-	for (int i=1; i<12; i++) {
-		if (i == minorbesti) {
-			continue;
-		}
-		if (minorcorrels[i] > minorcorrels[minorsecondbesti]) {
-			minorsecondbesti = i;
-		}
-	}
-
-	int secondbesti = majorsecondbesti;
-	if (majorcorrels[majorsecondbesti] < minorcorrels[minorsecondbesti]) {
-		secondbesti = minorsecondbesti;
-	}
-	secondbesti += 12;
-
-	correls = majorcorrels;
-	correls.insert(correls.end(), minorcorrels.begin(), minorcorrels.end());
-	correls.push_back(besti);
-	correls.push_back(secondbesti);
-}
-
-
-
 //////////////////////////////
 //
 // Tool_transpose::printHistograms --
 //
 
 void Tool_transpose::printHistograms(int segments, vector<int> ktracks,
-vector<vector<vector<double> > >& trackhist) {
+		vector<vector<vector<double> > >& trackhist) {
 	int i, j, k;
 	int start;
 
 	for (i=0; i<segments; i++) {
-//m_free_text << "i=" << i << endl;
 		m_free_text << "segment " << i
 				<< " ==========================================\n";
 		for (j=0; j<12; j++) {
 			start = 0;
-//m_free_text << "j=" << i << endl;
 			for (k=1; k<(int)ktracks.size(); k++) {
-//m_free_text << "k=" << i << endl;
 				if (!ktracks[k]) {
 					continue;
 				}
@@ -1430,7 +1228,7 @@ vector<vector<vector<double> > >& trackhist) {
 				m_free_text << "\t";
 				m_free_text << trackhist[k][i][j];
 			}
-	 if (start) {
+			if (start) {
 				m_free_text << "\n";
 			}
 		}
@@ -1440,115 +1238,6 @@ vector<vector<vector<double> > >& trackhist) {
 
 
 
-//////////////////////////////
-//
-// Tool_transpose::storeHistogramForTrack --
-//
-
-double Tool_transpose::storeHistogramForTrack(vector<vector<double> >& histogram,
-		HumdrumFile& infile, int track, int segments) {
-
-	histogram.clear();
-	histogram.reserve(segments);
-
-	int i;
-	int j;
-	int k;
-
-	for (i=0; i<(int)histogram.size(); i++) {
-		histogram[i].resize(12);
-		fill(histogram[i].begin(), histogram[i].end(), 0);
-	}
-
-	double totalduration = infile.getScoreDuration().getFloat();
-
-	double duration;
-	string buffer;
-	int pitch;
-	double start;
-	int tokencount;
-	for (i=0; i<infile.getLineCount(); i++) {
-		if (!infile[i].isData()) {
-			continue;
-		}
-		start = infile[i].getDurationFromStart().getFloat();
-		for (j=0; j<infile[i].getFieldCount(); j++) {
-			if (!infile.token(i, j)->isKern()) {
-				continue;
-			}
-	 		if (infile.token(i, j)->getTrack() != track) {
-				continue;
-			}
-			if (!infile.token(i, j)->isKern()) {
-				continue;
-			}
-			if (!infile.token(i, j)->isNull()) {
-				continue;
-			}
-			tokencount = infile.token(i, j)->getSubtokenCount();
-			for (k=0; k<tokencount; k++) {
-				buffer = *infile.token(j, k);
-				if (buffer == ".") {
-					continue;  // ignore illegal inline null tokens
-				}
-				pitch = Convert::kernToMidiNoteNumber(buffer);
-				if (pitch < 0) {
-					continue;  // ignore rests or strange objects
-				}
-				pitch = pitch % 12;  // convert to chromatic pitch-class
-				duration = Convert::recipToDuration(buffer).getFloat();
-				if (duration <= 0.0) {
-					continue;   // ignore grace notes and strange objects
-				}
-				addToHistogramDouble(histogram, pitch,
-						  start, duration, totalduration, segments);
-			}
-		}
-	}
-
-	return totalduration;
-}
-
-
-
-//////////////////////////////
-//
-// Tool_transpose::addToHistogramDouble -- fill the pitch histogram in the right spots.
-//
-
-void Tool_transpose::addToHistogramDouble(vector<vector<double> >& histogram, int pc,
-		double start, double dur, double tdur, int segments) {
-
-	pc = (pc + 12) % 12;
-
-	double startseg = start / tdur * segments;
-	double startfrac = startseg - (int)startseg;
-
-	double segdur = dur / tdur * segments;
-
-	if (segdur <= 1.0 - startfrac) {
-		histogram[(int)startseg][pc] += segdur;
-		return;
-	} else if (1.0 - startfrac > 0.0) {
-		histogram[(int)startseg][pc] += (1.0 - startfrac);
-		segdur -= (1.0 - startfrac);
-	}
-
-	int i = (int)(startseg + 1);
-	while (segdur > 0.0 && i < (int)histogram.size()) {
-		if (segdur < 1.0) {
-			histogram[i][pc] += segdur;
-			segdur = 0.0;
-		} else {
-			histogram[i][pc] += 1.0;
-			segdur -= 1.0;
-		}
-		i++;
-	}
-}
-
-
-
 //////////////////////////////
 //
 // Tool_transpose::initialize --
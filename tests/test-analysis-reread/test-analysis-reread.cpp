@@ -0,0 +1,104 @@
+// Description: Check that the analysis columns of a HumdrumFile are
+//              removed when the object is read again, assigned from
+//              another file or cleared, so that they are not reported
+//              for the new contents.
+//
+// Usage:       test-analysis-reread file1.krn file2.krn
+
+#include "humlib.h"
+
+using namespace hum;
+
+//////////////////////////////
+//
+// addColumn -- Add an analysis column with the line number of each line.
+//
+
+void addColumn(HumdrumFile& infile, const string& exinterp) {
+   vector<int> data(infile.getLineCount());
+   for (int i=0; i<(int)data.size(); i++) {
+      data[i] = i + 1;
+   }
+   infile.addAnalysisColumn(data, "", exinterp);
+}
+
+
+
+//////////////////////////////
+//
+// check -- Print an error if the file does not have the expected number
+//     of analysis columns.
+//
+
+int check(HumdrumFile& infile, const string& step, int expected) {
+   int errors = 0;
+   if (infile.getAnalysisColumnCount() != expected) {
+      cout << step << ": " << infile.getAnalysisColumnCount()
+           << " columns, should be " << expected << endl;
+      errors++;
+   }
+   if ((expected == 0) && (infile.getAnalysisColumn(0) != NULL)) {
+      cout << step << ": getAnalysisColumn(0) is not NULL" << endl;
+      errors++;
+   }
+   if ((expected == 0) && (infile.getAnalysisColumn("**first") != NULL)) {
+      cout << step << ": getAnalysisColumn(\"**first\") is not NULL" << endl;
+      errors++;
+   }
+   stringstream csv;
+   infile.printAnalysisCsv(csv);
+   string header;
+   getline(csv, header);
+   int columns = (int)std::count(header.begin(), header.end(), ',');
+   if (columns != expected) {
+      cout << step << ": CSV header \"" << header << "\" has " << columns
+           << " columns, should be " << expected << endl;
+      errors++;
+   }
+   return errors;
+}
+
+
+
+int main(int argc, char** argv) {
+   if (argc != 3) {
+      return 1;
+   }
+   int errors = 0;
+
+   HumdrumFile infile;
+   if (!infile.read(argv[1])) {
+      return 1;
+   }
+   addColumn(infile, "**first");
+   errors += check(infile, "first read", 1);
+
+   // A second file read into the same object:
+   if (!infile.read(argv[2])) {
+      return 1;
+   }
+   errors += check(infile, "second read", 0);
+   addColumn(infile, "**second");
+   errors += check(infile, "column after second read", 1);
+   HumAnalysisColumn* column = infile.getAnalysisColumn("**second");
+   if (!column || (column->getLineCount() != infile.getLineCount())) {
+      cout << "column after second read: wrong line count" << endl;
+      errors++;
+   }
+
+   // Assignment from another file:
+   HumdrumFile other(argv[1]);
+   infile = other;
+   errors += check(infile, "assignment", 0);
+
+   // Clearing the file:
+   addColumn(infile, "**third");
+   infile.clear();
+   errors += check(infile, "clear", 0);
+
+   cout << "Errors: " << errors << endl;
+   return errors ? 1 : 0;
+}
+
+
+
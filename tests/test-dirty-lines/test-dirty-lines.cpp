@@ -0,0 +1,117 @@
+// Description: Transpose all **kern notes up an octave by editing the
+//              tokens with setText() without calling createLinesFromTokens(),
+//              and check that only the changed lines are marked as dirty,
+//              that they are regenerated when printed or read with
+//              getText(), and that a changed reference record can be
+//              read from the line string immediately.
+//
+// Usage:       test-dirty-lines file.krn
+
+#include "humlib.h"
+
+using namespace hum;
+
+//////////////////////////////
+//
+// joinTokens -- The expected text of a line, made from its tokens.
+//
+
+string joinTokens(HumdrumLine& line) {
+   string output;
+   for (int j=0; j<line.getFieldCount(); j++) {
+      if (j > 0) {
+         output += '\t';
+      }
+      output += *line.token(j);
+   }
+   return output;
+}
+
+
+
+int main(int argc, char** argv) {
+   if (argc != 2) {
+      return 1;
+   }
+   HumdrumFile infile;
+   if (!infile.read(argv[1])) {
+      return 1;
+   }
+   int errors = 0;
+   vector<string> original(infile.getLineCount());
+   for (int i=0; i<infile.getLineCount(); i++) {
+      original[i] = infile[i];
+   }
+
+   HumRegex hre;
+   vector<bool> changed(infile.getLineCount(), false);
+   for (int i=0; i<infile.getLineCount(); i++) {
+      if (!infile[i].isData()) {
+         continue;
+      }
+      for (int j=0; j<infile[i].getFieldCount(); j++) {
+         HTp token = infile.token(i, j);
+         if (!token->isKern() || token->isNull() || token->isRest()) {
+            continue;
+         }
+         string text = *token;
+         hre.replaceDestructive(text, "$1$1", "([a-g])", "g");
+         token->setText(text);
+         changed[i] = true;
+      }
+   }
+
+   for (int i=0; i<infile.getLineCount(); i++) {
+      HumdrumLine& line = infile[i];
+      if (line.isTextDirty() != changed[i]) {
+         cout << "Line " << i + 1 << ": dirty flag is " << line.isTextDirty()
+              << ", should be " << changed[i] << endl;
+         errors++;
+      }
+      if (!changed[i] && ((string)line != original[i])) {
+         cout << "Line " << i + 1 << ": unchanged line has new text" << endl;
+         errors++;
+      }
+      string expected = changed[i] ? joinTokens(line) : original[i];
+      stringstream printed;
+      printed << line;
+      if (printed.str() != expected) {
+         cout << "Line " << i + 1 << ": printed as \"" << printed.str()
+              << "\", should be \"" << expected << "\"" << endl;
+         errors++;
+      }
+      if ((line.getText() != expected) || ((string)line != expected)) {
+         cout << "Line " << i + 1 << ": text was not regenerated" << endl;
+         errors++;
+      }
+      if (line.isTextDirty()) {
+         cout << "Line " << i + 1 << ": still dirty after printing" << endl;
+         errors++;
+      }
+   }
+
+   // Global lines are updated when their token is changed:
+   for (int i=0; i<infile.getLineCount(); i++) {
+      if (!infile[i].isCommentGlobal()) {
+         continue;
+      }
+      infile.token(i, 0)->setText("!!!XYZ: changed");
+      if (infile[i].isTextDirty() || ((string)infile[i] != "!!!XYZ: changed")) {
+         cout << "Line " << i + 1 << ": global line text was not updated"
+              << endl;
+         errors++;
+      }
+      if (!infile[i].isReference() || (infile[i].getReferenceKey() != "XYZ")) {
+         cout << "Line " << i + 1 << ": changed reference record not found"
+              << endl;
+         errors++;
+      }
+      break;
+   }
+
+   cout << "Errors: " << errors << endl;
+   return errors ? 1 : 0;
+}
+
+
+
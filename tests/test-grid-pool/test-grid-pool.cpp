@@ -0,0 +1,91 @@
+// Description: Check that the memory pools of the HumGrid classes are
+//              only freed when no objects are allocated from them, and
+//              that they can be used again after being freed, including
+//              by objects created on other threads.
+//
+// Usage:       test-grid-pool
+
+#include "humlib.h"
+
+#include <thread>
+
+using namespace hum;
+
+//////////////////////////////
+//
+// makeVoices -- Allocate the given number of voices.
+//
+
+void makeVoices(vector<GridVoice*>& voices, int count) {
+   for (int i=0; i<count; i++) {
+      voices.push_back(new GridVoice("4c", 1));
+   }
+}
+
+
+
+//////////////////////////////
+//
+// deleteVoices -- Delete voices and check their contents.
+//
+
+int deleteVoices(vector<GridVoice*>& voices) {
+   int errors = 0;
+   for (int i=0; i<(int)voices.size(); i++) {
+      if (*voices[i]->getToken() != "4c") {
+         errors++;
+      }
+      delete voices[i];
+   }
+   voices.clear();
+   return errors;
+}
+
+
+
+int main(int argc, char** argv) {
+   int errors = 0;
+   vector<GridVoice*> voices;
+
+   makeVoices(voices, 1000);
+   if (HumPool<GridVoice>::getObjectCount() != 1000) {
+      cout << "object count is " << HumPool<GridVoice>::getObjectCount()
+           << ", should be 1000" << endl;
+      errors++;
+   }
+   if (HumGrid::freePoolMemory()) {
+      cout << "pools were freed while voices exist" << endl;
+      errors++;
+   }
+   errors += deleteVoices(voices);
+   if (!HumGrid::freePoolMemory()) {
+      cout << "pools were not freed after the voices were deleted" << endl;
+      errors++;
+   }
+
+   // Reuse the pool on another thread after it has been freed, and then
+   // again on this thread after that thread has ended:
+   std::thread worker([&]() {
+      vector<GridVoice*> list;
+      makeVoices(list, 1000);
+      errors += deleteVoices(list);
+   });
+   worker.join();
+   makeVoices(voices, 1000);
+   errors += deleteVoices(voices);
+   if (!HumPool<GridVoice>::clear()) {
+      cout << "pool was not freed after reuse" << endl;
+      errors++;
+   }
+   if (HumPool<GridVoice>::getObjectCount() != 0) {
+      cout << "object count is " << HumPool<GridVoice>::getObjectCount()
+           << ", should be 0" << endl;
+      errors++;
+   }
+
+   cout << "Errors: " << errors << endl;
+   return errors ? 1 : 0;
+}
+
+
+
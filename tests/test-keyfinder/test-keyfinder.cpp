@@ -0,0 +1,72 @@
+// Description: Check the sliding-window key analysis of HumKeyFinder
+//              against histograms summed for each window and correlations
+//              calculated with Convert::pearsonCorrelation().  The best
+//              key of each window in each track is printed.
+//
+// Usage:       test-keyfinder file.krn [window-length] [hop]
+
+#include "humlib.h"
+
+#include <cmath>
+
+using namespace hum;
+
+int main(int argc, char** argv) {
+   if (argc < 2) {
+      return 1;
+   }
+   int length = argc > 2 ? atoi(argv[2]) : 8;
+   int hop = argc > 3 ? atoi(argv[3]) : 4;
+   HumdrumFile infile;
+   if (!infile.read(argv[1])) {
+      return 1;
+   }
+
+   vector<double> major = { 0.748, 0.060, 0.488, 0.082, 0.670, 0.460,
+                            0.096, 0.715, 0.104, 0.366, 0.057, 0.400 };
+   vector<double> minor = { 0.712, 0.084, 0.474, 0.618, 0.049, 0.460,
+                            0.105, 0.747, 0.404, 0.067, 0.133, 0.330 };
+
+   int segments = (int)(infile.getScoreDuration().getFloat() + 0.5);
+   vector<vector<vector<double>>> trackhist;
+   HumKeyFinder::getTrackHistograms(infile, segments, trackhist);
+
+   HumKeyFinder finder;
+   int errors = 0;
+   for (int t=1; t<(int)trackhist.size(); t++) {
+      if (trackhist[t].empty()) {
+         continue;
+      }
+      finder.setHistograms(trackhist[t]);
+      vector<vector<double>> analysis;
+      finder.analyzeWindows(length, hop, 0, analysis);
+      cout << "track " << t << ":";
+      for (int w=0; w<(int)analysis.size(); w++) {
+         vector<double> histogram(12, 0.0);
+         for (int s=w*hop; s<w*hop+length; s++) {
+            for (int k=0; k<12; k++) {
+               histogram[k] += trackhist[t][s][k];
+            }
+         }
+         double sum = 0.0;
+         for (int k=0; k<12; k++) {
+            sum += histogram[k];
+         }
+         for (int key=0; (sum > 0.0) && (key<24); key++) {
+            vector<double> profile(12);
+            for (int k=0; k<12; k++) {
+               profile[k] = (key < 12 ? major : minor)[(k - key % 12 + 12) % 12];
+            }
+            double expected = Convert::pearsonCorrelation(profile, histogram);
+            if (std::isfinite(expected) && (fabs(expected - analysis[w][key]) > 1e-9)) {
+               errors++;
+            }
+         }
+         cout << " " << analysis[w][24];
+      }
+      cout << endl;
+   }
+   cout << "Errors: " << errors << endl;
+   return errors ? 1 : 0;
+}
+
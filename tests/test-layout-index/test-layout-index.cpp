@@ -0,0 +1,217 @@
+// Description: Check the indexed layout parameter queries of HumdrumToken
+//              against searches through the linked parameter sets of each
+//              token.  Every key of every LO category linked to a token is
+//              tested for the whole token and for the first few notes of
+//              a chord.
+//
+// Usage:       test-layout-index file.krn
+
+#include "humlib.h"
+
+using namespace hum;
+
+//////////////////////////////
+//
+// searchParameter -- getLayoutParameter() on the linked parameters.
+//
+
+string searchParameter(HTp token, const string& category,
+      const string& keyname, int subtokenindex) {
+   string output;
+   string nparam;
+   for (int p=0; p<token->getLinkedParameterCount(); p++) {
+      HumParamSet* hps = token->getLinkedParameter(p);
+      if (!hps || (hps->getNamespace1() != "LO") ||
+            (hps->getNamespace2() != category)) {
+         continue;
+      }
+      output = "";
+      for (int q=0; q<hps->getCount(); q++) {
+         if (hps->getParameterName(q) == keyname) {
+            output = hps->getParameterValue(q);
+            if (subtokenindex < 0) {
+               return output;
+            }
+         }
+         if (hps->getParameterName(q) == "n") {
+            nparam = hps->getParameterValue(q);
+         }
+      }
+      if (nparam.empty() || (subtokenindex < 0)) {
+         if (!output.empty()) {
+            return output;
+         }
+      } else if (stoi(nparam) == subtokenindex + 1) {
+         return output;
+      } else {
+         output = "";
+      }
+   }
+   return output;
+}
+
+
+
+//////////////////////////////
+//
+// searchLast -- The last value of a key in the linked parameters of a
+//     category (used by getLayoutParameterChord/Note and
+//     getSlurLayoutParameter).
+//
+
+string searchLast(HTp token, const string& category, const string& keyname) {
+   string output;
+   for (int p=0; p<token->getLinkedParameterCount(); p++) {
+      HumParamSet* hps = token->getLinkedParameter(p);
+      if (!hps || (hps->getNamespace1() != "LO") ||
+            (hps->getNamespace2() != category)) {
+         continue;
+      }
+      for (int q=0; q<hps->getCount(); q++) {
+         if (hps->getParameterName(q) == keyname) {
+            output = hps->getParameterValue(q);
+         }
+      }
+   }
+   return output;
+}
+
+
+
+//////////////////////////////
+//
+// searchChord -- getLayoutParameterChord() on the linked parameters.
+//
+
+string searchChord(HTp token, const string& category, const string& keyname) {
+   if (!searchLast(token, category, "n").empty()) {
+      return "";
+   }
+   return searchLast(token, category, keyname);
+}
+
+
+
+//////////////////////////////
+//
+// searchNote -- getLayoutParameterNote() on the linked parameters.
+//
+
+string searchNote(HTp token, const string& category, const string& keyname,
+      int subtokenindex) {
+   string nparam = searchLast(token, category, "n");
+   string output = searchLast(token, category, keyname);
+   if (!nparam.empty()) {
+      return stoi(nparam) == subtokenindex + 1 ? output : "";
+   }
+   if ((subtokenindex < 0) && token->isChord()) {
+      return "";
+   }
+   return output;
+}
+
+
+
+//////////////////////////////
+//
+// searchSlur -- getSlurLayoutParameter() on the linked parameters.
+//
+
+string searchSlur(HTp token, const string& keyname, int subtokenindex) {
+   string sparam = searchLast(token, "S", "s");
+   string output = searchLast(token, "S", keyname);
+   if ((subtokenindex < 0) || sparam.empty()) {
+      return output;
+   }
+   return stoi(sparam) == subtokenindex + 1 ? output : "";
+}
+
+
+
+//////////////////////////////
+//
+// check -- Print a difference between an indexed query and a search.
+//
+
+int check(HTp token, const string& query, const string& found,
+      const string& expected) {
+   if (found == expected) {
+      return 0;
+   }
+   cout << "line " << token->getLineNumber() << " field "
+        << token->getFieldIndex() + 1 << " " << query << ": \""
+        << found << "\" should be \"" << expected << "\"" << endl;
+   return 1;
+}
+
+
+
+int main(int argc, char** argv) {
+   if (argc != 2) {
+      return 1;
+   }
+   HumdrumFile infile;
+   if (!infile.read(argv[1])) {
+      return 1;
+   }
+
+   int tokens = 0;
+   int queries = 0;
+   int errors = 0;
+   for (int i=0; i<infile.getLineCount(); i++) {
+      for (int j=0; j<infile[i].getFieldCount(); j++) {
+         HTp token = infile.token(i, j);
+         if (token->getLinkedParameterCount() == 0) {
+            continue;
+         }
+         tokens++;
+         for (int p=0; p<token->getLinkedParameterCount(); p++) {
+            HumParamSet* hps = token->getLinkedParameter(p);
+            if (!hps || (hps->getNamespace1() != "LO")) {
+               continue;
+            }
+            const string& category = hps->getNamespace2();
+            for (int q=0; q<hps->getCount(); q++) {
+               const string& key = hps->getParameterName(q);
+               if (!token->getValue("LO", category, key).empty()) {
+                  // local parameters are not linked
+                  continue;
+               }
+               string query = category + ":" + key;
+               for (int s=-1; s<4; s++) {
+                  string sub = "(" + to_string(s) + ")";
+                  // The searches stop at an @n which is not a number.
+                  try {
+                     string expected = searchParameter(token, category, key, s);
+                     errors += check(token, "getLayoutParameter " + query + sub,
+                           token->getLayoutParameter(category, key, s), expected);
+                  } catch (invalid_argument&) { }
+                  try {
+                     string expected = searchNote(token, category, key, s);
+                     errors += check(token, "getLayoutParameterNote " + query + sub,
+                           token->getLayoutParameterNote(category, key, s), expected);
+                  } catch (invalid_argument&) { }
+                  if (category == "S") {
+                     try {
+                        string expected = searchSlur(token, key, s);
+                        errors += check(token, "getSlurLayoutParameter " + key + sub,
+                              token->getSlurLayoutParameter(key, s), expected);
+                     } catch (invalid_argument&) { }
+                  }
+                  queries++;
+               }
+               errors += check(token, "getLayoutParameterChord " + query,
+                     token->getLayoutParameterChord(category, key),
+                     searchChord(token, category, key));
+            }
+         }
+      }
+   }
+
+   cout << "Tokens: " << tokens << endl;
+   cout << "Queries: " << queries << endl;
+   cout << "Errors: " << errors << endl;
+   return errors ? 1 : 0;
+}
+
+
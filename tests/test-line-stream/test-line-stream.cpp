@@ -0,0 +1,73 @@
+// Description: Compare the lines read with HumdrumLineStream with the
+//              lines of the files read by HumdrumFileStream.  The text,
+//              spine info, track and subtrack of each token and the data
+//              type of each field must match.
+//
+// Usage:       test-line-stream file1.krn file2.krn ...
+
+#include "humlib.h"
+
+using namespace hum;
+
+string getLineInfo(HumdrumLine& line, const vector<string>& datatypes) {
+   stringstream info;
+   info << line.getLineIndex() << ":" << line;
+   if (line.hasSpines()) {
+      for (int j=0; j<line.getFieldCount(); j++) {
+         HTp token = line.token(j);
+         info << "\t" << token->getSpineInfo() << "/" << token->getTrack()
+              << "." << token->getSubtrack() << "/" << datatypes.at(j);
+      }
+   }
+   return info.str();
+}
+
+int main(int argc, char** argv) {
+   Options options;
+   options.process(argc, argv);
+   vector<string> filenames;
+   options.getArgList(filenames);
+
+   vector<string> expected;
+   HumdrumFileStream filestream(filenames);
+   HumdrumFile infile;
+   while (filestream.getFile(infile)) {
+      for (int i=0; i<infile.getLineCount(); i++) {
+         vector<string> datatypes;
+         for (int j=0; j<infile[i].getFieldCount(); j++) {
+            datatypes.push_back(infile[i].hasSpines() ?
+                  infile.token(i, j)->getDataType() : "");
+         }
+         expected.push_back(getLineInfo(infile[i], datatypes));
+      }
+   }
+
+   HumdrumLineStream linestream(filenames);
+   int count = 0;
+   int errors = 0;
+   HLp line;
+   while ((line = linestream.getLine())) {
+      vector<string> datatypes;
+      for (int j=0; j<line->getFieldCount(); j++) {
+         datatypes.push_back(line->hasSpines() ? linestream.getDataType(j) : "");
+      }
+      string info = getLineInfo(*line, datatypes);
+      if ((count >= (int)expected.size()) || (info != expected[count])) {
+         cout << "Line " << count + 1 << " differs: " << info << endl;
+         errors++;
+      }
+      count++;
+   }
+   if (linestream.hasError()) {
+      cout << linestream.getError();
+      errors++;
+   }
+   if (count != (int)expected.size()) {
+      cout << "Line counts differ: " << expected.size() << " and "
+           << count << endl;
+      errors++;
+   }
+   cout << "Lines: " << count << ", errors: " << errors << endl;
+   return errors ? 1 : 0;
+}
+
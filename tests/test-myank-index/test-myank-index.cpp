@@ -0,0 +1,73 @@
+// Description: Compare measure ranges extracted with a MyankIndex against
+//              myank processing of the complete score.  Usage:
+//                 test-myank-index file.krn [options...]
+//              where the options are passed to myank along with each
+//              range of up to four measures in the score.
+
+#include "humlib.h"
+
+#include <fstream>
+#include <sstream>
+
+using namespace hum;
+
+int main(int argc, char** argv) {
+   if (argc < 2) {
+      return 1;
+   }
+   ifstream input(argv[1]);
+   if (!input.is_open()) {
+      return 1;
+   }
+   stringstream buffer;
+   buffer << input.rdbuf();
+   string data = buffer.str();
+
+   string options;
+   for (int i=2; i<argc; i++) {
+      options += " ";
+      options += argv[i];
+   }
+
+   MyankIndex index;
+   cout << "!!indexed:\t" << (index.build(data) ? "yes" : "no") << endl;
+
+   vector<int> measures;
+   HumdrumFile infile;
+   infile.readString(data);
+   for (int i=0; i<infile.getLineCount(); i++) {
+      int number;
+      if (infile[i].isBarline()
+            && (sscanf(infile.token(i, 0)->c_str(), "=%d", &number) == 1)) {
+         measures.push_back(number);
+      }
+   }
+
+   int errors = 0;
+   int count = 0;
+   for (int i=0; i<(int)measures.size(); i++) {
+      for (int j=i; (j<(int)measures.size()) && (j<i+4); j++) {
+         string range = "-m " + to_string(measures[i]) + "-" + to_string(measures[j]);
+         Tool_myank fulltool;
+         fulltool.process("myank " + range + options);
+         HumdrumFile full;
+         full.readString(data);
+         stringstream fullout;
+         fulltool.run(full, fullout);
+
+         Tool_myank fasttool;
+         fasttool.process("myank " + range + options);
+         stringstream fastout;
+         fasttool.run(index, fastout);
+
+         count++;
+         if (fullout.str() != fastout.str()) {
+            cout << "!!mismatch:\t" << range << endl;
+            errors++;
+         }
+      }
+   }
+   cout << "!!ranges:\t" << count << endl;
+   cout << "!!errors:\t" << errors << endl;
+   return errors ? 1 : 0;
+}
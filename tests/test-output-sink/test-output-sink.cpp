@@ -0,0 +1,34 @@
+// Description: Run the cint tool on a file, sending the Humdrum output
+//              directly to a writer function.  The output is printed
+//              in chunks marked with the number of bytes in each chunk,
+//              followed by the same output when buffered by the tool.
+
+#include "humlib.h"
+
+using namespace hum;
+
+int main(int argc, char** argv) {
+   if (argc != 2) {
+      return 1;
+   }
+   HumdrumFile infile;
+   if (!infile.read(argv[1])) {
+      return 1;
+   }
+
+   Tool_cint streamed;
+   streamed.setHumdrumOutput([](const char* data, size_t size) {
+      cout << "!!chunk: " << size << " bytes" << endl;
+      cout.write(data, size);
+   });
+   streamed.run(infile);
+   cout << "!!has text: " << streamed.hasAnyText() << endl;
+   streamed.clearOutput();
+   cout << "!!has text after clear: " << streamed.hasAnyText() << endl;
+
+   Tool_cint buffered;
+   buffered.run(infile);
+   cout << "!!buffered: " << buffered.getHumdrumText().size() << " bytes" << endl;
+   buffered.getAllText(cout);
+   return 0;
+}
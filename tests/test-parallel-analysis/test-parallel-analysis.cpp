@@ -0,0 +1,60 @@
+// Description: Compare the rhythm, strand and layout-parameter analyses
+//              of a file parsed serially with the same file parsed with
+//              parallel track/strand analysis.
+//
+// Usage:       test-parallel-analysis file.krn [threads]
+
+#include "humlib.h"
+
+using namespace hum;
+
+int main(int argc, char** argv) {
+   if (argc < 2) {
+      return 1;
+   }
+   int threads = argc > 2 ? atoi(argv[2]) : 4;
+   HumdrumFile serial;
+   HumdrumFile parallel;
+   serial.setAnalysisThreadCount(1);
+   parallel.setAnalysisThreadCount(threads);
+   bool status1 = serial.read(argv[1]);
+   bool status2 = parallel.read(argv[1]);
+   if (status1 != status2) {
+      cout << "Parse status differs" << endl;
+      return 1;
+   }
+   if (!status1) {
+      bool same = serial.getParseError() == parallel.getParseError();
+      cout << "Parse errors " << (same ? "match" : "differ") << endl;
+      return same ? 0 : 1;
+   }
+
+   int errors = 0;
+   for (int i=0; i<serial.getLineCount(); i++) {
+      if ((serial[i].getDurationFromStart() != parallel[i].getDurationFromStart()) ||
+            (serial[i].getDuration() != parallel[i].getDuration()) ||
+            (serial[i].getDurationFromBarline() != parallel[i].getDurationFromBarline())) {
+         cout << "Line " << i+1 << " durations differ" << endl;
+         errors++;
+      }
+      for (int j=0; j<serial[i].getTokenCount(); j++) {
+         HTp token1 = serial.token(i, j);
+         HTp token2 = parallel.token(i, j);
+         if ((token1->getStrandIndex() != token2->getStrandIndex()) ||
+               (token1->getLinkedParameterCount() != token2->getLinkedParameterCount()) ||
+               (token1->getDurationFromStart() != token2->getDurationFromStart())) {
+            cout << "Token " << i+1 << ":" << j+1 << " differs" << endl;
+            errors++;
+         }
+      }
+   }
+   if (serial.getStrandCount() != parallel.getStrandCount()) {
+      cout << "Strand counts differ" << endl;
+      errors++;
+   }
+   cout << "Lines: " << serial.getLineCount() << endl;
+   cout << "Strands: " << serial.getStrandCount() << endl;
+   cout << "Errors: " << errors << endl;
+   return errors ? 1 : 0;
+}
+
@@ -0,0 +1,49 @@
+// Description: Compare a set of files read one after another with the
+//              same files read with HumdrumFileSet::readParallel().  The
+//              filenames, parse errors and contents of each file must
+//              match.
+//
+// Usage:       test-parallel-set [-j threads] file1.krn file2.krn ...
+
+#include "humlib.h"
+
+using namespace hum;
+
+int main(int argc, char** argv) {
+   Options options;
+   options.define("j|threads=i:4", "number of threads for parallel reading");
+   options.process(argc, argv);
+   vector<string> filenames;
+   options.getArgList(filenames);
+
+   HumdrumFileStream serialstream(filenames);
+   HumdrumFileSet serial;
+   serial.read(serialstream);
+
+   HumdrumFileStream parallelstream(filenames);
+   HumdrumFileSet parallel;
+   parallel.readParallel(parallelstream, options.getInteger("threads"));
+
+   if (serial.getCount() != parallel.getCount()) {
+      cout << "File counts differ: " << serial.getCount() << " and "
+           << parallel.getCount() << endl;
+      return 1;
+   }
+   int errors = 0;
+   for (int i=0; i<serial.getCount(); i++) {
+      stringstream text1;
+      stringstream text2;
+      text1 << serial[i];
+      text2 << parallel[i];
+      if ((serial[i].getFilename() != parallel[i].getFilename()) ||
+            (serial[i].getParseError() != parallel[i].getParseError()) ||
+            (text1.str() != text2.str())) {
+         cout << "File " << i + 1 << " (" << serial[i].getFilename()
+              << ") differs" << endl;
+         errors++;
+      }
+   }
+   cout << "Files: " << serial.getCount() << ", errors: " << errors << endl;
+   return errors ? 1 : 0;
+}
+
@@ -0,0 +1,186 @@
+// Description: Check the batch and single-token pitch conversions in
+//              Convert against a separate reference parser for all **kern
+//              subtokens in a file (and against fixed values for a few
+//              tokens), and print the time taken by each method.
+//
+// Usage:       test-pitch-batch file.krn [repeat-count]
+
+#include "humlib.h"
+
+#include <chrono>
+
+using namespace hum;
+
+//////////////////////////////
+//
+// Reference pitch parser, which does not use the Convert functions.  Only
+// the first subtoken is considered.  A rest or a token without a pitch
+// gives -1000 or -2000 for the pitch class and -1000 for the octave.
+//
+
+void referencePitch(const string& token, int& diatonic, int& accid,
+      int& octave) {
+   diatonic = -2000;
+   accid = 0;
+   int uc = 0;
+   int lc = 0;
+   bool restQ = false;
+   for (int i=0; i<(int)token.size(); i++) {
+      char ch = token[i];
+      if (ch == ' ') {
+         break;
+      }
+      if (ch == 'r') {
+         restQ = true;
+         break;
+      }
+      if (ch == '#') {
+         accid++;
+      } else if (ch == '-') {
+         accid--;
+      }
+      if ((ch >= 'A') && (ch <= 'G')) {
+         uc++;
+      } else if ((ch >= 'a') && (ch <= 'g')) {
+         lc++;
+      } else {
+         continue;
+      }
+      if (diatonic < 0) {
+         // C=0, D=1, E=2, F=3, G=4, A=5, B=6
+         diatonic = (tolower(ch) - 'a' + 5) % 7;
+      }
+   }
+   if (restQ) {
+      if (diatonic < 0) {
+         diatonic = -1000;
+      }
+      octave = -1000;
+      return;
+   }
+   if ((token == ".") || (uc && lc) || (!uc && !lc)) {
+      octave = -1000;
+   } else {
+      octave = uc ? 4 - uc : 3 + lc;
+   }
+}
+
+
+void referenceNumbers(const string& token, int& b40, int& b12, int& b7,
+      int& midi) {
+   int diatonic, accid, octave;
+   referencePitch(token, diatonic, accid, octave);
+   if (diatonic < 0) {
+      b40 = diatonic;
+      b7 = diatonic;
+      b12 = diatonic + 12 * octave;
+      midi = diatonic + 12 * (octave + 1);
+      return;
+   }
+   int b40pc[7] = { 2, 8, 14, 19, 25, 31, 37 };
+   int b12pc[7] = { 0, 2, 4, 5, 7, 9, 11 };
+   b40 = b40pc[diatonic] + accid + 40 * octave;
+   b12 = b12pc[diatonic] + accid + 12 * octave;
+   b7 = diatonic + 7 * octave;
+   midi = b12pc[diatonic] + accid + 12 * (octave + 1);
+}
+
+
+
+int main(int argc, char** argv) {
+   if (argc < 2) {
+      return 1;
+   }
+   int repeat = argc > 2 ? atoi(argv[2]) : 100;
+   HumdrumFile infile;
+   if (!infile.read(argv[1])) {
+      return 1;
+   }
+
+   vector<string> tokens = { ".", "r", "4r", "4cr", "cC", "", " ", "4c# d",
+         "8B--", "CCC#", "ccc-", "=", "*", "4.aa#J" };
+   for (int i=0; i<infile.getLineCount(); i++) {
+      if (!infile[i].isData()) {
+         continue;
+      }
+      for (int j=0; j<infile[i].getFieldCount(); j++) {
+         HTp token = infile.token(i, j);
+         if (!token->isKern()) {
+            continue;
+         }
+         for (int k=0; k<token->getSubtokenCount(); k++) {
+            tokens.push_back(token->getSubtoken(k));
+         }
+      }
+   }
+
+   int errors = 0;
+
+   // Fixed values: token, base-40, base-12, base-7, MIDI.
+   vector<pair<string, vector<int>>> fixed = {
+      { "4c",     { 162,  48,  28,  60 } },
+      { "8B--",   { 155,  45,  27,  57 } },
+      { "CCC#",   {  43,  13,   7,  25 } },
+      { "ccc-",   { 241,  71,  42,  83 } },
+      { "4.aa#J", { 232,  70,  40,  82 } },
+      { "4c# d",  { 163,  49,  28,  61 } },
+      { "4r",     { -1000, -13000, -1000, -12988 } },
+      { ".",      { -2000, -14000, -2000, -13988 } }
+   };
+   for (int i=0; i<(int)fixed.size(); i++) {
+      int b40, b12, b7, midi;
+      referenceNumbers(fixed[i].first, b40, b12, b7, midi);
+      if (vector<int>({ b40, b12, b7, midi }) != fixed[i].second) {
+         cout << "Reference mismatch for \"" << fixed[i].first << "\"" << endl;
+         errors++;
+      }
+   }
+
+   vector<int> b40, b12, b7, midi;
+   Convert::kernToPitchNumbers(tokens, &b40, &b12, &b7, &midi);
+   for (int i=0; i<(int)tokens.size(); i++) {
+      int rb40, rb12, rb7, rmidi;
+      referenceNumbers(tokens[i], rb40, rb12, rb7, rmidi);
+      if ((b40[i] != rb40) || (b12[i] != rb12) || (b7[i] != rb7) ||
+            (midi[i] != rmidi)) {
+         cout << "Batch mismatch for \"" << tokens[i] << "\"" << endl;
+         errors++;
+      }
+      if ((Convert::kernToBase40(tokens[i]) != rb40) ||
+            (Convert::kernToBase12(tokens[i]) != rb12) ||
+            (Convert::kernToBase7(tokens[i]) != rb7) ||
+            (Convert::kernToMidiNoteNumber(tokens[i]) != rmidi)) {
+         cout << "Single-token mismatch for \"" << tokens[i] << "\"" << endl;
+         errors++;
+      }
+   }
+
+   auto start = std::chrono::steady_clock::now();
+   long long sum = 0;
+   for (int r=0; r<repeat; r++) {
+      for (int i=0; i<(int)tokens.size(); i++) {
+         sum += Convert::kernToBase40PC(tokens[i]) + 40 *
+               Convert::kernToOctaveNumber(tokens[i]);
+         sum += Convert::kernToBase12PC(tokens[i]) + 12 *
+               (Convert::kernToOctaveNumber(tokens[i]) + 1);
+      }
+   }
+   auto middle = std::chrono::steady_clock::now();
+   for (int r=0; r<repeat; r++) {
+      Convert::kernToPitchNumbers(tokens, &b40, NULL, NULL, &midi);
+      for (int i=0; i<(int)tokens.size(); i++) {
+         sum += b40[i] + midi[i];
+      }
+   }
+   auto end = std::chrono::steady_clock::now();
+
+   double scalar = std::chrono::duration<double, std::milli>(middle - start).count();
+   double batch = std::chrono::duration<double, std::milli>(end - middle).count();
+   cout << "Subtokens:\t" << tokens.size() << endl;
+   cout << "Mismatches:\t" << errors << endl;
+   cout << "Scan per value:\t" << scalar << " ms" << endl;
+   cout << "Batch:\t" << batch << " ms" << endl;
+   cout << "Checksum:\t" << sum << endl;
+   return errors ? 1 : 0;
+}
+
@@ -0,0 +1,45 @@
+// Description: Print the tick position of each line, and then the note
+//              attacks and sounding notes at each tick in the score.
+
+#include "humlib.h"
+
+using namespace hum;
+
+int main(int argc, char** argv) {
+   if (argc != 2) {
+      return 1;
+   }
+   HumdrumFile infile;
+   if (!infile.read(argv[1])) {
+      return 1;
+   }
+   int tpq = infile.tpq();
+   cout << "!!tpq:\t" << tpq << endl;
+   for (int i=0; i<infile.getLineCount(); i++) {
+      cout << infile.getLineTick(i) << "\t";
+      cout << infile[i].getDurationFromStart() << "\t";
+      cout << "::\t" << infile[i] << endl;
+   }
+
+   vector<HTp> notes;
+   for (int tick=0; tick<infile.getScoreTickDuration(); tick++) {
+      cout << "tick " << tick << " (" << infile.tickToTime(tick) << ")";
+      cout << "\tline " << infile.getDataLineAtTick(tick);
+      cout << "\tbarline " << infile.getBarlineIndexAtTick(tick);
+      infile.getAttacksInTickRange(notes, tick, tick + 1);
+      cout << "\tattacks:";
+      for (int i=0; i<(int)notes.size(); i++) {
+         cout << " " << notes[i];
+      }
+      infile.getSoundingNotesAtTick(notes, tick);
+      cout << "\tsounding:";
+      for (int i=0; i<(int)notes.size(); i++) {
+         cout << " " << notes[i];
+      }
+      cout << endl;
+   }
+   return 0;
+}
+
+
+